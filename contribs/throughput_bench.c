@@ -0,0 +1,406 @@
+/*****************************************************************************\
+ *  throughput_bench.c - Controller job throughput benchmark harness.
+ *
+ *  Drives a configurable submit/cancel/query mix against slurmctld from a
+ *  pool of worker threads and reports the sustained RPC rate, per-class
+ *  latency percentiles and the change in scheduler cycle statistics
+ *  (as reported by sdiag) over the run. Intended for use against a test
+ *  cluster built with the multiple-slurmd support (slurmd -N, with
+ *  NodeName/Port blocks in slurm.conf), so controller behavior can be
+ *  measured for node counts far beyond the available hardware.
+ *
+ *  Build with:
+ *    gcc -o throughput_bench throughput_bench.c -I<prefix>/include \
+ *        -L<prefix>/lib -lslurm -lpthread
+ *  Example, 8 threads submitting 10000 jobs with 20% cancels and
+ *  10% queue queries mixed in:
+ *    ./throughput_bench -n 10000 -t 8 -m 70:20:10 -p debug
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+\*****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <slurm/slurm.h>
+#include <slurm/slurm_errno.h>
+
+/* Exported from libslurm, but not declared in the public headers */
+extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg);
+
+#define OP_SUBMIT	0
+#define OP_CANCEL	1
+#define OP_QUERY	2
+#define OP_CLASSES	3
+
+#define MAX_THREADS	64
+
+static const char *op_names[OP_CLASSES] = { "submit", "cancel", "query" };
+
+/* Options */
+static int  total_ops   = 1000;
+static int  thread_cnt  = 4;
+static int  op_mix[OP_CLASSES] = { 80, 10, 10 };	/* percent */
+static char *partition  = NULL;
+static char *script     = "#!/bin/sh\nsleep 30\n";
+static int  verbose     = 0;
+
+/* Shared state */
+static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int  next_op    = 0;		/* operations issued so far */
+static uint32_t *job_ids = NULL;	/* jobs submitted and not canceled */
+static int  job_id_cnt = 0;
+
+/* Per-class latency samples in microseconds, merged across threads */
+static pthread_mutex_t sample_mutex = PTHREAD_MUTEX_INITIALIZER;
+static long *samples[OP_CLASSES];
+static int  sample_cnt[OP_CLASSES];
+static int  error_cnt[OP_CLASSES];
+
+static long _delta_usec(struct timeval *tv1, struct timeval *tv2)
+{
+	return (tv2->tv_sec  - tv1->tv_sec) * 1000000L +
+	       (tv2->tv_usec - tv1->tv_usec);
+}
+
+/* Select the class of the next operation per the configured mix,
+ * falling back to submit when there is no job available to cancel */
+static int _next_op_class(uint32_t *cancel_job_id)
+{
+	int op, pick;
+
+	pthread_mutex_lock(&state_mutex);
+	if (next_op >= total_ops) {
+		pthread_mutex_unlock(&state_mutex);
+		return -1;
+	}
+	pick = (next_op++ * 37) % 100;	/* deterministic spread */
+	if (pick < op_mix[OP_SUBMIT])
+		op = OP_SUBMIT;
+	else if (pick < (op_mix[OP_SUBMIT] + op_mix[OP_CANCEL]))
+		op = OP_CANCEL;
+	else
+		op = OP_QUERY;
+	if (op == OP_CANCEL) {
+		if (job_id_cnt > 0)
+			*cancel_job_id = job_ids[--job_id_cnt];
+		else
+			op = OP_SUBMIT;
+	}
+	pthread_mutex_unlock(&state_mutex);
+	return op;
+}
+
+static void _record_job_id(uint32_t job_id)
+{
+	pthread_mutex_lock(&state_mutex);
+	job_ids[job_id_cnt++] = job_id;
+	pthread_mutex_unlock(&state_mutex);
+}
+
+static void _record_sample(int op, long usec, int rc)
+{
+	pthread_mutex_lock(&sample_mutex);
+	if (rc != SLURM_SUCCESS)
+		error_cnt[op]++;
+	else
+		samples[op][sample_cnt[op]++] = usec;
+	pthread_mutex_unlock(&sample_mutex);
+}
+
+static int _do_submit(void)
+{
+	job_desc_msg_t job_req;
+	submit_response_msg_t *job_resp = NULL;
+	char *env[1] = { "PATH=/bin:/usr/bin" };
+	int rc;
+
+	slurm_init_job_desc_msg(&job_req);
+	job_req.name		= "throughput_bench";
+	job_req.partition	= partition;
+	job_req.min_nodes	= 1;
+	job_req.user_id		= getuid();
+	job_req.group_id	= getgid();
+	job_req.script		= script;
+	job_req.work_dir	= "/tmp";
+	job_req.environment	= env;
+	job_req.env_size	= 1;
+	job_req.time_limit	= 5;
+	job_req.priority	= 0;	/* held, so queue depth builds */
+
+	rc = slurm_submit_batch_job(&job_req, &job_resp);
+	if (rc == SLURM_SUCCESS) {
+		_record_job_id(job_resp->job_id);
+		slurm_free_submit_response_response_msg(job_resp);
+	}
+	return rc;
+}
+
+static int _do_cancel(uint32_t job_id)
+{
+	if (slurm_kill_job(job_id, SIGKILL, 0) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+	return SLURM_SUCCESS;
+}
+
+static int _do_query(void)
+{
+	job_info_msg_t *job_info = NULL;
+	int rc;
+
+	rc = slurm_load_jobs((time_t) 0, &job_info, SHOW_ALL);
+	if (rc == SLURM_SUCCESS)
+		slurm_free_job_info_msg(job_info);
+	return rc;
+}
+
+static void *_worker(void *arg)
+{
+	struct timeval tv1, tv2;
+	uint32_t cancel_job_id = 0;
+	int op, rc;
+
+	while ((op = _next_op_class(&cancel_job_id)) >= 0) {
+		gettimeofday(&tv1, NULL);
+		switch (op) {
+		case OP_SUBMIT:
+			rc = _do_submit();
+			break;
+		case OP_CANCEL:
+			rc = _do_cancel(cancel_job_id);
+			break;
+		default:
+			rc = _do_query();
+			break;
+		}
+		gettimeofday(&tv2, NULL);
+		_record_sample(op, _delta_usec(&tv1, &tv2), rc);
+		if (verbose && (rc != SLURM_SUCCESS)) {
+			fprintf(stderr, "%s: %s\n", op_names[op],
+				slurm_strerror(slurm_get_errno()));
+		}
+	}
+	return NULL;
+}
+
+static int _cmp_long(const void *x, const void *y)
+{
+	long lx = *(const long *) x, ly = *(const long *) y;
+
+	if (lx < ly)
+		return -1;
+	if (lx > ly)
+		return 1;
+	return 0;
+}
+
+static long _percentile(long *sorted, int cnt, int pct)
+{
+	int inx = (cnt * pct) / 100;
+
+	if (inx >= cnt)
+		inx = cnt - 1;
+	return sorted[inx];
+}
+
+static stats_info_response_msg_t *_get_stats(void)
+{
+	stats_info_request_msg_t stats_req;
+	stats_info_response_msg_t *stats_resp = NULL;
+
+	stats_req.command_id = STAT_COMMAND_GET;
+	if (slurm_get_statistics(&stats_resp, &stats_req) != SLURM_SUCCESS) {
+		fprintf(stderr, "Can not get controller statistics: %s\n",
+			slurm_strerror(slurm_get_errno()));
+		return NULL;
+	}
+	return stats_resp;
+}
+
+static void _report_sched_stats(stats_info_response_msg_t *stats1,
+				stats_info_response_msg_t *stats2)
+{
+	uint32_t cycles, bf_cycles;
+
+	if (!stats1 || !stats2)
+		return;
+	printf("\nScheduler statistics over the run (from sdiag):\n");
+	cycles = stats2->schedule_cycle_counter -
+		 stats1->schedule_cycle_counter;
+	printf("  main: %u cycles, last %u usec, max %u usec", cycles,
+	       stats2->schedule_cycle_last, stats2->schedule_cycle_max);
+	if (cycles) {
+		printf(", mean %u usec",
+		       (stats2->schedule_cycle_sum -
+			stats1->schedule_cycle_sum) / cycles);
+	}
+	printf("\n");
+	bf_cycles = stats2->bf_cycle_counter - stats1->bf_cycle_counter;
+	printf("  backfill: %u cycles, last %u usec, max %u usec", bf_cycles,
+	       stats2->bf_cycle_last, stats2->bf_cycle_max);
+	if (bf_cycles) {
+		printf(", mean %"PRIu64" usec",
+		       (stats2->bf_cycle_sum - stats1->bf_cycle_sum) /
+		       bf_cycles);
+	}
+	printf("\n  jobs submitted %u, started %u, canceled %u\n",
+	       stats2->jobs_submitted - stats1->jobs_submitted,
+	       stats2->jobs_started - stats1->jobs_started,
+	       stats2->jobs_canceled - stats1->jobs_canceled);
+}
+
+static void _usage(char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-n ops] [-t threads] [-m sub:can:qry] "
+		"[-p partition] [-s script_file] [-v]\n"
+		"  -n ops        total operations to issue (default 1000)\n"
+		"  -t threads    worker thread count (default 4, max %d)\n"
+		"  -m mix        operation mix in percent (default 80:10:10)\n"
+		"  -p partition  partition for submitted jobs\n"
+		"  -s script     batch script file (default: sleep 30)\n"
+		"  -v            log individual operation failures\n",
+		prog, MAX_THREADS);
+	exit(1);
+}
+
+static char *_load_script(char *fname)
+{
+	FILE *fp = fopen(fname, "r");
+	char *buf;
+	long size;
+
+	if (!fp) {
+		fprintf(stderr, "Can not open %s: %s\n", fname,
+			strerror(errno));
+		exit(1);
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = calloc(1, size + 1);
+	if (!buf || (fread(buf, 1, size, fp) != (size_t) size)) {
+		fprintf(stderr, "Can not read %s\n", fname);
+		exit(1);
+	}
+	fclose(fp);
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t threads[MAX_THREADS];
+	struct timeval tv1, tv2;
+	stats_info_response_msg_t *stats1, *stats2;
+	double elapsed;
+	long *sorted;
+	int i, op, total_done = 0;
+
+	while ((i = getopt(argc, argv, "m:n:p:s:t:v")) != EOF) {
+		switch (i) {
+		case 'm':
+			if (sscanf(optarg, "%d:%d:%d", &op_mix[OP_SUBMIT],
+				   &op_mix[OP_CANCEL],
+				   &op_mix[OP_QUERY]) != 3 ||
+			    (op_mix[OP_SUBMIT] + op_mix[OP_CANCEL] +
+			     op_mix[OP_QUERY]) != 100)
+				_usage(argv[0]);
+			break;
+		case 'n':
+			total_ops = atoi(optarg);
+			break;
+		case 'p':
+			partition = optarg;
+			break;
+		case 's':
+			script = _load_script(optarg);
+			break;
+		case 't':
+			thread_cnt = atoi(optarg);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			_usage(argv[0]);
+		}
+	}
+	if ((total_ops < 1) || (thread_cnt < 1) || (thread_cnt > MAX_THREADS))
+		_usage(argv[0]);
+
+	job_ids = calloc(total_ops, sizeof(uint32_t));
+	for (op = 0; op < OP_CLASSES; op++)
+		samples[op] = calloc(total_ops, sizeof(long));
+
+	stats1 = _get_stats();
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < thread_cnt; i++) {
+		if (pthread_create(&threads[i], NULL, _worker, NULL)) {
+			fprintf(stderr, "pthread_create: %s\n",
+				strerror(errno));
+			exit(1);
+		}
+	}
+	for (i = 0; i < thread_cnt; i++)
+		pthread_join(threads[i], NULL);
+	gettimeofday(&tv2, NULL);
+	stats2 = _get_stats();
+
+	elapsed = _delta_usec(&tv1, &tv2) / 1000000.0;
+	for (op = 0; op < OP_CLASSES; op++)
+		total_done += sample_cnt[op] + error_cnt[op];
+	printf("%d operations in %.2f sec: %.1f RPC/sec sustained\n",
+	       total_done, elapsed, total_done / elapsed);
+
+	for (op = 0; op < OP_CLASSES; op++) {
+		if ((sample_cnt[op] + error_cnt[op]) == 0)
+			continue;
+		printf("%-6s: %6d ok %4d err", op_names[op],
+		       sample_cnt[op], error_cnt[op]);
+		if (sample_cnt[op]) {
+			sorted = samples[op];
+			qsort(sorted, sample_cnt[op], sizeof(long),
+			      _cmp_long);
+			printf("  latency usec p50/%ld p90/%ld p99/%ld "
+			       "max/%ld",
+			       _percentile(sorted, sample_cnt[op], 50),
+			       _percentile(sorted, sample_cnt[op], 90),
+			       _percentile(sorted, sample_cnt[op], 99),
+			       sorted[sample_cnt[op] - 1]);
+		}
+		printf("\n");
+	}
+
+	_report_sched_stats(stats1, stats2);
+	if (stats1)
+		slurm_free_stats_response_msg(stats1);
+	if (stats2)
+		slurm_free_stats_response_msg(stats2);
+
+	/* Cancel any jobs still pending from the run */
+	pthread_mutex_lock(&state_mutex);
+	for (i = 0; i < job_id_cnt; i++)
+		(void) slurm_kill_job(job_ids[i], SIGKILL, 0);
+	pthread_mutex_unlock(&state_mutex);
+
+	return 0;
+}
@@ -189,6 +189,7 @@ enum {
 	ESLURM_INVALID_POWERCAP,
 	ESLURM_INVALID_MCS_LABEL,
 	ESLURM_BURST_BUFFER_WAIT =			2100,
+	ESLURM_NODE_REG_DIGEST_MISMATCH,
 
 	/* switch specific error codes, specific values defined in plugin module */
 	ESLURM_SWITCH_MIN = 3000,
@@ -230,6 +231,7 @@ enum {
 	ESLURMD_JOB_NOTRUNNING,
 	ESLURMD_STEP_SUSPENDED,
 	ESLURMD_STEP_NOTSUSPENDED,
+	ESLURMD_BCAST_FILE_ALREADY_CACHED,
 
 	/* slurmd errors in user batch job */
 	ESCRIPT_CHDIR_FAILED =			4100,
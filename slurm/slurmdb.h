@@ -261,6 +261,11 @@ typedef struct {
 typedef struct {
 	List acct_list;		/* list of char * */
 	List associd_list;	/* list of char */
+	uint64_t chunk_db_inx;  /* only return jobs past this database
+				 * index, the cursor for chunked
+				 * fetches */
+	uint32_t chunk_size;    /* maximum jobs scanned for one fetch,
+				 * 0 returns everything at once */
 	List cluster_list;	/* list of char * */
 	uint32_t cpus_max;      /* number of cpus high range */
 	uint32_t cpus_min;      /* number of cpus low range */
@@ -703,6 +708,7 @@ typedef struct {
 	uint32_t associd;
 	char	*blockid;
 	char    *cluster;
+	uint64_t db_index; /* index of this job in the job table */
 	uint32_t derived_ec;
 	char	*derived_es; /* aka "comment" */
 	uint32_t elapsed;
@@ -75,6 +75,27 @@ static struct io_operations message_socket_ops = {
 	.handle_msg = &_handle_msg
 };
 
+/* Multiplexed mode (SLURM_ALLOC_MSG_MUX environment variable): all of
+ * the allocations pending in this process that register the same
+ * callbacks share one listening socket and message thread instead of
+ * one per allocation. The controller then sees one destination per
+ * process and can batch its notifications (see srun_ping() in
+ * src/slurmctld/srun_comm.c). The shared thread is reference counted
+ * and torn down by the last slurm_allocation_msg_thr_destroy() call. */
+static pthread_mutex_t mux_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct allocation_msg_thread *mux_msg_thr = NULL;
+static uint16_t mux_port = 0;
+static int mux_ref_cnt = 0;
+
+static bool _mux_enabled(void)
+{
+	static int enabled = -1;
+
+	if (enabled == -1)
+		enabled = (getenv("SLURM_ALLOC_MSG_MUX") != NULL);
+	return enabled;
+}
+
 static void *_msg_thr_internal(void *arg)
 {
 	int signals[] = {SIGHUP, SIGINT, SIGQUIT, SIGPIPE, SIGTERM,
@@ -105,6 +126,28 @@ extern allocation_msg_thread_t *slurm_allocation_msg_thr_create(
 
 	debug("Entering slurm_allocation_msg_thr_create()");
 
+	if (_mux_enabled()) {
+		slurm_allocation_callbacks_t null_callbacks;
+
+		memset(&null_callbacks, 0, sizeof(null_callbacks));
+		if (callbacks == NULL)
+			callbacks = &null_callbacks;
+		slurm_mutex_lock(&mux_lock);
+		if (mux_msg_thr &&
+		    (memcmp(&mux_msg_thr->callback, callbacks,
+			    sizeof(slurm_allocation_callbacks_t)) == 0)) {
+			mux_ref_cnt++;
+			*port = mux_port;
+			slurm_mutex_unlock(&mux_lock);
+			debug("reusing multiplexed allocation message "
+			      "thread on port %hu", *port);
+			return (allocation_msg_thread_t *)mux_msg_thr;
+		}
+		slurm_mutex_unlock(&mux_lock);
+		if (callbacks == &null_callbacks)
+			callbacks = NULL;
+	}
+
 	slurm_uid = (uid_t) slurm_get_slurm_user_id();
 	msg_thr = (struct allocation_msg_thread *)xmalloc(
 		sizeof(struct allocation_msg_thread));
@@ -158,6 +201,16 @@ extern allocation_msg_thread_t *slurm_allocation_msg_thr_create(
 	slurm_cond_wait(&msg_thr_start_cond, &msg_thr_start_lock);
 	slurm_mutex_unlock(&msg_thr_start_lock);
 
+	if (_mux_enabled()) {
+		slurm_mutex_lock(&mux_lock);
+		if (mux_msg_thr == NULL) {
+			mux_msg_thr = msg_thr;
+			mux_port = *port;
+			mux_ref_cnt = 1;
+		}
+		slurm_mutex_unlock(&mux_lock);
+	}
+
 	return (allocation_msg_thread_t *)msg_thr;
 }
 
@@ -169,6 +222,19 @@ extern void slurm_allocation_msg_thr_destroy(
 	if (msg_thr == NULL)
 		return;
 
+	slurm_mutex_lock(&mux_lock);
+	if (msg_thr == mux_msg_thr) {
+		if (--mux_ref_cnt > 0) {
+			slurm_mutex_unlock(&mux_lock);
+			debug2("%s: multiplexed message thread still has "
+			       "%d users", __func__, mux_ref_cnt);
+			return;
+		}
+		mux_msg_thr = NULL;
+		mux_port = 0;
+	}
+	slurm_mutex_unlock(&mux_lock);
+
 	debug2("slurm_allocation_msg_thr_destroy: clearing up message thread");
 	eio_signal_shutdown(msg_thr->handle);
 	pthread_join(msg_thr->id, NULL);
@@ -152,3 +152,37 @@ slurm_kill_job2(const char *job_id, uint16_t signal, uint16_t flags)
 
 	return SLURM_SUCCESS;
 }
+
+/* slurm_kill_jobs()
+ */
+int
+slurm_kill_jobs(char **job_ids, uint32_t job_cnt, uint16_t signal,
+		uint16_t flags)
+{
+	int cc;
+	slurm_msg_t msg;
+	kill_jobs_msg_t req;
+
+	if ((job_ids == NULL) || (job_cnt == 0)) {
+		errno = EINVAL;
+		return SLURM_FAILURE;
+	}
+
+	slurm_msg_t_init(&msg);
+
+	memset(&req, 0, sizeof(kill_jobs_msg_t));
+	req.job_ids     = job_ids;
+	req.job_cnt     = job_cnt;
+	req.signal      = signal;
+	req.flags	= flags;
+	msg.msg_type    = REQUEST_KILL_JOBS;
+	msg.data        = &req;
+
+	if (slurm_send_recv_controller_rc_msg(&msg, &cc) < 0)
+		return SLURM_FAILURE;
+
+	if (cc)
+		slurm_seterrno_ret(cc);
+
+	return SLURM_SUCCESS;
+}
@@ -995,6 +995,7 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	slurm_msg_t_init(&req_msg);
 	slurm_msg_t_init(&resp_msg);
 
+	memset(&req, 0, sizeof(req));
 	req.last_update  = update_time;
 	req.show_flags   = show_flags;
 	req_msg.msg_type = REQUEST_JOB_INFO;
@@ -1021,6 +1022,184 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	return SLURM_PROTOCOL_SUCCESS;
 }
 
+/*
+ * slurm_load_jobs_filtered - issue RPC to get slurm all job configuration
+ *	information if changed since update_time, with the controller only
+ *	packing the jobs matching the given filters
+ * IN update_time - time of current configuration data
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN show_flags - job filtering options
+ * IN job_ids/job_id_count - only get jobs with these job or array job ids
+ * IN partitions - comma separated partition names
+ * IN states/state_count - only get jobs in these states
+ * IN user_ids/user_count - only get jobs of these users
+ * Any filter left NULL (or 0) does not restrict on that field.
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_jobs_filtered(time_t update_time,
+				    job_info_msg_t **job_info_msg_pptr,
+				    uint16_t show_flags,
+				    uint32_t *job_ids, uint32_t job_id_count,
+				    char *partitions,
+				    uint32_t *states, uint32_t state_count,
+				    uint32_t *user_ids, uint32_t user_count)
+{
+	int rc;
+	slurm_msg_t resp_msg;
+	slurm_msg_t req_msg;
+	job_info_request_msg_t req;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+
+	memset(&req, 0, sizeof(req));
+	req.last_update  = update_time;
+	req.show_flags   = show_flags;
+	req.job_ids      = job_ids;
+	req.job_id_count = job_id_count;
+	req.partitions   = partitions;
+	req.states       = states;
+	req.state_count  = state_count;
+	req.user_ids     = user_ids;
+	req.user_count   = user_count;
+	req_msg.msg_type = REQUEST_JOB_INFO;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_JOB_INFO:
+		*job_info_msg_pptr = (job_info_msg_t *)resp_msg.data;
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		break;
+	}
+
+	return SLURM_PROTOCOL_SUCCESS;
+}
+
+static int _uint32_cmp(const void *x, const void *y)
+{
+	uint32_t a = *(uint32_t *) x, b = *(uint32_t *) y;
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static bool _id_in_array(uint32_t id, uint32_t *ids, uint32_t cnt)
+{
+	if (!cnt)
+		return false;
+	return bsearch(&id, ids, cnt, sizeof(uint32_t), _uint32_cmp) != NULL;
+}
+
+static void _merge_free_buf(void *x)
+{
+	free_buf((Buf) x);
+}
+
+/*
+ * slurm_job_info_msg_merge - merge a diff response into the previously
+ *	loaded job information
+ *
+ * Pollers may pass their last seen update time plus the SHOW_DIFF flag
+ * to slurm_load_jobs() and get back only the records changed since
+ * then, plus the ids of purged jobs.  This helper folds such a
+ * response into the previous one and returns the merged message; both
+ * inputs are consumed.  A full (non diff) new message simply replaces
+ * the old one.
+ * RET the merged message, to be freed with slurm_free_job_info_msg()
+ */
+extern job_info_msg_t *slurm_job_info_msg_merge(job_info_msg_t *old_msg,
+						job_info_msg_t *new_msg)
+{
+	job_info_msg_t *merged;
+	uint32_t *new_ids = NULL;
+	uint32_t i;
+
+	if (!old_msg)
+		return new_msg;
+	if (!new_msg)
+		return old_msg;
+	if (!new_msg->diff_mode) {
+		/* a full response replaces everything */
+		slurm_free_job_info_msg(old_msg);
+		return new_msg;
+	}
+
+	merged = xmalloc(sizeof(job_info_msg_t));
+	merged->last_update = new_msg->last_update;
+	merged->job_array = xmalloc(sizeof(job_info_t) *
+				    (old_msg->record_count +
+				     new_msg->record_count));
+
+	if (new_msg->record_count) {
+		new_ids = xmalloc(sizeof(uint32_t) * new_msg->record_count);
+		for (i = 0; i < new_msg->record_count; i++)
+			new_ids[i] = new_msg->job_array[i].job_id;
+		qsort(new_ids, new_msg->record_count, sizeof(uint32_t),
+		      _uint32_cmp);
+	}
+	if (new_msg->deleted_job_count) {
+		qsort(new_msg->deleted_job_ids, new_msg->deleted_job_count,
+		      sizeof(uint32_t), _uint32_cmp);
+	}
+
+	for (i = 0; i < old_msg->record_count; i++) {
+		job_info_t *job = &old_msg->job_array[i];
+
+		if (_id_in_array(job->job_id, new_ids,
+				 new_msg->record_count) ||
+		    _id_in_array(job->job_id, new_msg->deleted_job_ids,
+				 new_msg->deleted_job_count)) {
+			/* replaced or purged; everything else in the
+			 * record is borrowed from the retained buffer */
+			slurm_free_job_info_borrowed_members(job);
+			continue;
+		}
+		merged->job_array[merged->record_count++] = *job;
+	}
+	for (i = 0; i < new_msg->record_count; i++)
+		merged->job_array[merged->record_count++] =
+			new_msg->job_array[i];
+	xfree(new_ids);
+
+	/* The surviving records still point into the buffers the two
+	 * messages were unpacked from, so keep all of them alive */
+	merged->unpack_buf_list = list_create(_merge_free_buf);
+	if (old_msg->unpack_buf)
+		list_append(merged->unpack_buf_list, old_msg->unpack_buf);
+	if (old_msg->unpack_buf_list)
+		list_transfer(merged->unpack_buf_list,
+			      old_msg->unpack_buf_list);
+	if (new_msg->unpack_buf)
+		list_append(merged->unpack_buf_list, new_msg->unpack_buf);
+	old_msg->unpack_buf = NULL;
+	new_msg->unpack_buf = NULL;
+	FREE_NULL_LIST(old_msg->unpack_buf_list);
+
+	xfree(old_msg->job_array);
+	xfree(old_msg->deleted_job_ids);
+	xfree(old_msg);
+	xfree(new_msg->job_array);
+	xfree(new_msg->deleted_job_ids);
+	xfree(new_msg);
+
+	return merged;
+}
+
 /*
  * slurm_load_job_user - issue RPC to get slurm information about all jobs
  *	to be run as the specified user
@@ -1554,3 +1733,38 @@ slurm_network_callerid (network_callerid_msg_t req, uint32_t *job_id,
 	slurm_free_network_callerid_msg(resp_msg.data);
 	return SLURM_PROTOCOL_SUCCESS;
 }
+
+/*
+ * slurm_job_state_subscribe - register interest in the given job's state
+ *	transitions; the controller will push a job complete notification
+ *	to the given port at this host, as delivered to the message thread
+ *	created with slurm_allocation_msg_thr_create()
+ * IN job_id - slurm job_id to watch
+ * IN port - port number listening for the notifications
+ * RET 0 or -1 on error (ESLURM_ALREADY_DONE if the job already finished)
+ */
+extern int slurm_job_state_subscribe(uint32_t job_id, uint16_t port)
+{
+	int rc;
+	slurm_msg_t msg;
+	job_state_subscribe_msg_t req;
+
+	slurm_msg_t_init(&msg);
+	/*
+	 * Request message:
+	 */
+	req.job_id   = job_id;
+	req.port     = port;
+	msg.msg_type = REQUEST_JOB_STATE_SUBSCRIBE;
+	msg.data     = &req;
+
+	if (slurm_send_recv_controller_rc_msg(&msg, &rc) < 0)
+		return SLURM_FAILURE;
+
+	if (rc) {
+		slurm_seterrno_ret(rc);
+		return SLURM_FAILURE;
+	}
+
+	return SLURM_SUCCESS;
+}
@@ -105,6 +105,7 @@
 #define KVS_KEY_STATE_GLOBAL    0
 #define KVS_KEY_STATE_LOCAL     1
 #define KVS_KEY_STATE_DISABLED  2
+#define KVS_KEY_STATE_SENT      3
 
 /* default key names form is jobid.stepid[.taskid.sequence] */
 struct kvs_rec {
@@ -1258,8 +1259,8 @@ int PMI_KVS_Commit( const char kvsname[] )
 			continue;
 		local_pairs = 0;
 		for (j=0; j<kvs_recs[i].kvs_cnt; j++) {
-			if (kvs_recs[i].kvs_key_states[j] ==
-					KVS_KEY_STATE_GLOBAL)
+			if (kvs_recs[i].kvs_key_states[j] !=
+					KVS_KEY_STATE_LOCAL)
 				continue;
 			if (local_pairs != j)
 				_kvs_swap(&kvs_recs[i], j, local_pairs);
@@ -1292,10 +1293,34 @@ int PMI_KVS_Commit( const char kvsname[] )
 		kvs_set.kvs_comm_recs++;
 	}
 
+	/* If no key-pairs have been set locally since the last commit,
+	 * skip the RPC entirely. Otherwise every PMI_Barrier() preceded
+	 * by an empty commit generates useless traffic from every task
+	 * to the srun, which dominates barrier time at large scale. */
+	if (kvs_set.kvs_comm_recs == 0) {
+		pthread_mutex_unlock(&kvs_mutex);
+		free(kvs_set.kvs_host_ptr);
+		return rc;
+	}
+
 	/* Send the RPC */
 	if (slurm_send_kvs_comm_set(&kvs_set, pmi_rank, pmi_size)
 			!= SLURM_SUCCESS) {
 		rc = PMI_FAIL;
+	} else {
+		/* Remember which key-pairs have been transmitted so
+		 * later commits do not send them all over again. They
+		 * remain readable locally until the global copies
+		 * arrive with the next barrier. */
+		for (i=0; i<kvs_rec_cnt; i++) {
+			for (j=0; j<kvs_recs[i].kvs_cnt; j++) {
+				if (kvs_recs[i].kvs_key_states[j] ==
+						KVS_KEY_STATE_LOCAL) {
+					kvs_recs[i].kvs_key_states[j] =
+						KVS_KEY_STATE_SENT;
+				}
+			}
+		}
 	}
 	pthread_mutex_unlock(&kvs_mutex); /* DO NOT use slurm_mutex_un/lock */
 
@@ -1981,7 +2006,10 @@ _kvs_disable_local_keys(void)
 
 	for (i = 0; i < kvs_rec_cnt; i++) {
 		for (j = 0; j < kvs_recs[i].kvs_cnt; j++)
-			if (kvs_recs[i].kvs_key_states[j] == KVS_KEY_STATE_LOCAL)
+			if ((kvs_recs[i].kvs_key_states[j] ==
+			     KVS_KEY_STATE_LOCAL) ||
+			    (kvs_recs[i].kvs_key_states[j] ==
+			     KVS_KEY_STATE_SENT))
 				kvs_recs[i].kvs_key_states[j] = KVS_KEY_STATE_DISABLED;
 	}
 }
@@ -313,9 +313,12 @@ struct kvs_comm **_kvs_comm_dup(void)
 		rc_kvs[i]->kvs_values =
 				xmalloc(sizeof(char *) * rc_kvs[i]->kvs_cnt);
 		if (kvs_comm_ptr[i]->kvs_key_sent == NULL) {
+			/* size to the allocated array length so later
+			 * appends keep all three arrays in step */
 			kvs_comm_ptr[i]->kvs_key_sent =
 				xmalloc(sizeof(uint16_t) *
-				kvs_comm_ptr[i]->kvs_cnt);
+				MAX(kvs_comm_ptr[i]->kvs_cnt,
+				    kvs_comm_ptr[i]->kvs_alloc_cnt));
 		}
 		cnt = 0;
 		for (j=0; j<rc_kvs[i]->kvs_cnt; j++) {
@@ -351,6 +354,11 @@ static void _merge_named_kvs(struct kvs_comm *kvs_orig,
 {
 	int i, j;
 
+	/* The capacity field is zero for a structure which came off
+	 * the wire, so adopt the current count before growing */
+	if (kvs_orig->kvs_alloc_cnt < kvs_orig->kvs_cnt)
+		kvs_orig->kvs_alloc_cnt = kvs_orig->kvs_cnt;
+
 	for (i=0; i<kvs_new->kvs_cnt; i++) {
 		if (pmi_kvs_no_dup_keys)
 			goto no_dup;
@@ -367,22 +375,29 @@ static void _merge_named_kvs(struct kvs_comm *kvs_orig,
 		if (j < kvs_orig->kvs_cnt)
 			continue;	/* already recorded, update */
 no_dup:
-		/* append it */
+		/* append it, growing the arrays geometrically so that a
+		 * stream of appends from many tasks does not realloc
+		 * and copy the arrays once per key */
+		if (kvs_orig->kvs_cnt >= kvs_orig->kvs_alloc_cnt) {
+			kvs_orig->kvs_alloc_cnt =
+				MAX((kvs_orig->kvs_alloc_cnt * 2), 64);
+			xrealloc(kvs_orig->kvs_keys,
+				 (sizeof(char *) * kvs_orig->kvs_alloc_cnt));
+			xrealloc(kvs_orig->kvs_values,
+				 (sizeof(char *) * kvs_orig->kvs_alloc_cnt));
+			if (kvs_orig->kvs_key_sent) {
+				xrealloc(kvs_orig->kvs_key_sent,
+					 (sizeof(uint16_t) *
+					  kvs_orig->kvs_alloc_cnt));
+			}
+		}
 		kvs_orig->kvs_cnt++;
-		xrealloc(kvs_orig->kvs_keys,
-				(sizeof(char *) * kvs_orig->kvs_cnt));
-		xrealloc(kvs_orig->kvs_values,
-				(sizeof(char *) * kvs_orig->kvs_cnt));
 		kvs_orig->kvs_keys[kvs_orig->kvs_cnt-1] = kvs_new->kvs_keys[i];
 		kvs_orig->kvs_values[kvs_orig->kvs_cnt-1] =
 				kvs_new->kvs_values[i];
 		kvs_new->kvs_keys[i] = NULL;
 		kvs_new->kvs_values[i] = NULL;
 	}
-	if (kvs_orig->kvs_key_sent) {
-		xrealloc(kvs_orig->kvs_key_sent,
-			 (sizeof(uint16_t) * kvs_orig->kvs_cnt));
-	}
 }
 
 static void _move_kvs(struct kvs_comm *kvs_new)
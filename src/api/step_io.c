@@ -61,11 +61,27 @@
 #define MAX_RETRIES 3
 #define STDIO_MAX_FREE_BUF 1024
 
+/* One stdio event loop can decode the output of roughly this many node
+ * streams before it saturates a core and backpressures task output. */
+#define STDIO_NODES_PER_IO_THREAD 256
+#define STDIO_MAX_IO_THREADS 8
+
+/* Flow control window for each node stream: the number of output
+ * payload bytes a stepd may have in flight before it must pause
+ * reading from its task pipes and wait for us to drain.  Grants are
+ * batched until they are worth a control message. */
+#define STDIO_CREDIT_WINDOW (256 * 1024)
+#define STDIO_CREDIT_GRANT_MIN (STDIO_CREDIT_WINDOW / 4)
+
+struct server_io_info;
+
 struct io_buf {
 	int ref_count;
 	uint32_t length;
 	void *data;
 	io_hdr_t header;
+	struct server_io_info *source;	/* stream an outgoing message was
+					 * read from, for credit grants */
 };
 
 typedef struct kill_thread {
@@ -73,14 +89,23 @@ typedef struct kill_thread {
 	int       secs;
 } kill_thread_t;
 
+/* One stdio event loop.  Each loop owns a subset of the listen sockets
+ * and every node stream accepted on them, so the cost of decoding task
+ * output is spread over num_io_threads cores. */
+struct io_shard {
+	client_io_t *cio;
+	int id;			/* index into cio->eio and cio->ioid */
+};
+
 static struct io_buf *_alloc_io_buf(void);
 #if 0
 static void     _free_io_buf(struct io_buf *buf);
 #endif
 static void	_init_stdio_eio_objs(slurm_step_io_fds_t fds,
 				     client_io_t *cio);
-static void	_handle_io_init_msg(int fd, client_io_t *cio);
-static int      _read_io_init_msg(int fd, client_io_t *cio, char *host);
+static void	_handle_io_init_msg(int fd, client_io_t *cio, int shard);
+static int      _read_io_init_msg(int fd, client_io_t *cio, int shard,
+				  char *host);
 static int      _wid(int n);
 static bool     _incoming_buf_free(client_io_t *cio);
 static bool     _outgoing_buf_free(client_io_t *cio);
@@ -114,6 +139,7 @@ struct io_operations server_ops = {
 struct server_io_info {
 	client_io_t *cio;
 	int node_id;
+	int shard;		/* event loop polling this stream */
 	bool testing_connection;
 
 	/* incoming variables */
@@ -129,8 +155,13 @@ struct server_io_info {
 	struct io_buf *out_msg;
 	int32_t out_remaining;
 	bool out_eof;
+
+	uint32_t pending_credit; /* payload bytes drained but not yet
+				  * granted back to the stepd */
 };
 
+static void _server_grant_credit(struct server_io_info *s, uint32_t length);
+
 /**********************************************************************
  * File write declarations
  **********************************************************************/
@@ -199,19 +230,19 @@ _listening_socket_readable(eio_obj_t *obj)
 static int
 _listening_socket_read(eio_obj_t *obj, List objs)
 {
-	client_io_t *cio = (client_io_t *)obj->arg;
+	struct io_shard *shard = (struct io_shard *)obj->arg;
 
 	debug3("Called _listening_socket_read");
-	_handle_io_init_msg(obj->fd, cio);
+	_handle_io_init_msg(obj->fd, shard->cio, shard->id);
 
 	return (0);
 }
 
 static void
-_set_listensocks_nonblocking(client_io_t *cio)
+_set_listensocks_nonblocking(client_io_t *cio, int shard)
 {
 	int i;
-	for (i = 0; i < cio->num_listen; i++)
+	for (i = shard; i < cio->num_listen; i += cio->num_io_threads)
 		fd_set_nonblocking(cio->listensock[i]);
 }
 
@@ -219,7 +250,7 @@ _set_listensocks_nonblocking(client_io_t *cio)
  * IO server socket functions
  **********************************************************************/
 static eio_obj_t *
-_create_server_eio_obj(int fd, client_io_t *cio, int nodeid,
+_create_server_eio_obj(int fd, client_io_t *cio, int nodeid, int shard,
 		       int stdout_objs, int stderr_objs)
 {
 	struct server_io_info *info = NULL;
@@ -228,6 +259,7 @@ _create_server_eio_obj(int fd, client_io_t *cio, int nodeid,
 	info = (struct server_io_info *)xmalloc(sizeof(struct server_io_info));
 	info->cio = cio;
 	info->node_id = nodeid;
+	info->shard = shard;
 	info->testing_connection = false;
 	info->in_msg = NULL;
 	info->in_remaining = 0;
@@ -238,6 +270,7 @@ _create_server_eio_obj(int fd, client_io_t *cio, int nodeid,
 	info->out_msg = NULL;
 	info->out_remaining = 0;
 	info->out_eof = false;
+	info->pending_credit = 0;
 
 	eio = eio_obj_create(fd, &server_ops, (void *)info);
 
@@ -251,10 +284,13 @@ _server_readable(eio_obj_t *obj)
 
 	debug4("Called _server_readable");
 
+	slurm_mutex_lock(&s->cio->ioservers_lock);
 	if (!_outgoing_buf_free(s->cio)) {
+		slurm_mutex_unlock(&s->cio->ioservers_lock);
 		debug4("  false, free_io_buf is empty");
 		return false;
 	}
+	slurm_mutex_unlock(&s->cio->ioservers_lock);
 
 	if (s->in_eof) {
 		debug4("  false, eof");
@@ -292,9 +328,12 @@ _server_read(eio_obj_t *obj, List objs)
 
 	debug4("Entering _server_read");
 	if (s->in_msg == NULL) {
+		slurm_mutex_lock(&s->cio->ioservers_lock);
 		if (_outgoing_buf_free(s->cio)) {
 			s->in_msg = list_dequeue(s->cio->free_outgoing);
+			slurm_mutex_unlock(&s->cio->ioservers_lock);
 		} else {
+			slurm_mutex_unlock(&s->cio->ioservers_lock);
 			debug("List free_outgoing is empty!");
 			return SLURM_ERROR;
 		}
@@ -416,11 +455,20 @@ _server_read(eio_obj_t *obj, List objs)
 		else
 			obj = s->cio->stderr_obj;
 		info = (struct file_write_info *) obj->arg;
-		if (info->eof)
-			/* this output is closed, discard message */
+		if (info->eof) {
+			/* this output is closed, discard message, but
+			 * still return the credit it consumed */
+			_server_grant_credit(s, s->in_msg->header.length);
 			list_enqueue(s->cio->free_outgoing, s->in_msg);
-		else
+		} else {
+			s->in_msg->source = s;
 			list_enqueue(info->msg_queue, s->in_msg);
+			/* The file objects are polled by the first event
+			 * loop; kick it if the message arrived on
+			 * another one. */
+			if (s->shard != 0)
+				eio_signal_wakeup(s->cio->eio[0]);
+		}
 
 		s->in_msg = NULL;
 	}
@@ -443,6 +491,9 @@ _server_writable(eio_obj_t *obj)
 		debug4("  false, shutdown");
 		return false;
 	}
+	/* Retry a credit grant that could not get a buffer earlier */
+	if (s->pending_credit >= STDIO_CREDIT_GRANT_MIN)
+		_server_grant_credit(s, 0);
 	if (s->out_msg != NULL
 	    || !list_is_empty(s->msg_queue)) {
 		debug4("  true, s->msg_queue length = %d",
@@ -508,20 +559,67 @@ again:
 		return SLURM_SUCCESS;
 
 	/*
-	 * Free the message and prepare to send the next one.
+	 * Free the message and prepare to send the next one.  Stdin
+	 * broadcast messages are shared by streams on several event
+	 * loops, so the reference count is adjusted under the lock.
 	 */
+	slurm_mutex_lock(&s->cio->ioservers_lock);
 	s->out_msg->ref_count--;
-	if (s->out_msg->ref_count == 0) {
-		slurm_mutex_lock(&s->cio->ioservers_lock);
+	if (s->out_msg->ref_count == 0)
 		list_enqueue(s->cio->free_incoming, s->out_msg);
-		slurm_mutex_unlock(&s->cio->ioservers_lock);
-	} else
+	else
 		debug3("  Could not free msg!!");
+	slurm_mutex_unlock(&s->cio->ioservers_lock);
 	s->out_msg = NULL;
 
 	return SLURM_SUCCESS;
 }
 
+/* Return drained payload bytes to a node stream as a SLURM_IO_CREDIT
+ * grant so the stepd can resume reading from its task pipes.  Grants
+ * accumulate in pending_credit until they are worth a control message;
+ * a zero length just retries sending what has accumulated. */
+static void
+_server_grant_credit(struct server_io_info *s, uint32_t length)
+{
+	client_io_t *cio = s->cio;
+	struct io_buf *msg;
+	io_hdr_t header;
+	Buf packbuf;
+
+	slurm_mutex_lock(&cio->ioservers_lock);
+	s->pending_credit += length;
+	if ((s->pending_credit < STDIO_CREDIT_GRANT_MIN) ||
+	    s->out_eof || s->in_eof || !_incoming_buf_free(cio)) {
+		/* not worth a message yet, the stream is gone, or no
+		 * buffer is free; retry on a later grant */
+		slurm_mutex_unlock(&cio->ioservers_lock);
+		return;
+	}
+	msg = list_dequeue(cio->free_incoming);
+
+	header.type = SLURM_IO_CREDIT;
+	header.gtaskid = 0;	/* Unused */
+	header.ltaskid = 0;	/* Unused */
+	header.length = s->pending_credit;
+
+	msg->length = io_hdr_packed_size();
+	msg->ref_count = 1;
+	msg->header = header;
+
+	packbuf = create_buf(msg->data, io_hdr_packed_size());
+	io_hdr_pack(&header, packbuf);
+	/* free the Buf packbuf, but not the memory to which it points */
+	packbuf->head = NULL;
+	free_buf(packbuf);
+
+	list_enqueue(s->msg_queue, msg);
+	s->pending_credit = 0;
+	slurm_mutex_unlock(&cio->ioservers_lock);
+
+	eio_signal_wakeup(cio->eio[s->shard]);
+}
+
 /**********************************************************************
  * File write functions
  **********************************************************************/
@@ -596,6 +694,10 @@ static int _file_write(eio_obj_t *obj, List objs)
 					        info->out_msg->header.gtaskid,
 					        info->cio->label,
 					        info->cio->label_width)) < 0) {
+			if (info->out_msg->source)
+				_server_grant_credit(
+					info->out_msg->source,
+					info->out_msg->header.length);
 			list_enqueue(info->cio->free_outgoing, info->out_msg);
 			info->eof = true;
 			return SLURM_ERROR;
@@ -607,11 +709,16 @@ static int _file_write(eio_obj_t *obj, List objs)
 	}
 
 	/*
-	 * Free the message.
+	 * Free the message, returning its flow control credit to the
+	 * stream it was read from.
 	 */
 	info->out_msg->ref_count--;
-	if (info->out_msg->ref_count == 0)
+	if (info->out_msg->ref_count == 0) {
+		if (info->out_msg->source)
+			_server_grant_credit(info->out_msg->source,
+					     info->out_msg->header.length);
 		list_enqueue(info->cio->free_outgoing, info->out_msg);
+	}
 	info->out_msg = NULL;
 	debug2("Leaving  _file_write");
 
@@ -741,25 +848,41 @@ again:
 	debug3("  msg->length = %d", msg->length);
 
 	/*
-	 * Route the message to the correct IO servers
+	 * Route the message to the correct IO servers.  The streams may
+	 * be polled by other event loops, so set the full reference
+	 * count before the first enqueue makes the message visible to
+	 * them, and wake any loop other than our own afterwards.
 	 */
 	if (header.type == SLURM_IO_ALLSTDIN) {
 		int i;
 		struct server_io_info *server;
+		slurm_mutex_lock(&info->cio->ioservers_lock);
 		for (i = 0; i < info->cio->num_nodes; i++) {
-			msg->ref_count++;
 			if (info->cio->ioserver[i] == NULL)
 				/* client_io_handler_abort() or
 				 * client_io_handler_downnodes() called */
 				verbose("ioserver stream of node %d not yet "
 					"initialized", i);
-			else {
+			else
+				msg->ref_count++;
+		}
+		if (msg->ref_count == 0) {
+			/* no streams to write to, recycle the buffer */
+			list_enqueue(info->cio->free_incoming, msg);
+		} else {
+			for (i = 0; i < info->cio->num_nodes; i++) {
+				if (info->cio->ioserver[i] == NULL)
+					continue;
 				server = info->cio->ioserver[i]->arg;
 				list_enqueue(server->msg_queue, msg);
 			}
 		}
+		slurm_mutex_unlock(&info->cio->ioservers_lock);
+		for (i = 1; i < info->cio->num_io_threads; i++)
+			eio_signal_wakeup(info->cio->eio[i]);
 	} else if (header.type == SLURM_IO_STDIN) {
 		uint32_t nodeid;
+		int shard = 0;
 		struct server_io_info *server;
 		debug("SLURM_IO_STDIN");
 		msg->ref_count = 1;
@@ -769,8 +892,13 @@ again:
 			error("A valid node id must be specified"
 			      " for SLURM_IO_STDIN");
 		} else {
+			slurm_mutex_lock(&info->cio->ioservers_lock);
 			server = info->cio->ioserver[nodeid]->arg;
 			list_enqueue(server->msg_queue, msg);
+			shard = info->cio->ioserver_shard[nodeid];
+			slurm_mutex_unlock(&info->cio->ioservers_lock);
+			if (shard != 0)
+				eio_signal_wakeup(info->cio->eio[shard]);
 		}
 	} else {
 		fatal("Unsupported header.type");
@@ -785,14 +913,15 @@ again:
  **********************************************************************/
 
 static void *
-_io_thr_internal(void *cio_arg)
+_io_thr_internal(void *shard_arg)
 {
-	client_io_t *cio  = (client_io_t *) cio_arg;
+	struct io_shard *shard = (struct io_shard *) shard_arg;
+	client_io_t *cio = shard->cio;
 	sigset_t set;
 
 	xassert(cio != NULL);
 
-	debug3("IO thread pid = %lu", (unsigned long) getpid());
+	debug3("IO thread %d pid = %lu", shard->id, (unsigned long) getpid());
 
 	/* Block SIGHUP because it is interrupting file stream functions
 	 * (fprintf, fflush, etc.) and causing data loss on stdout.
@@ -801,28 +930,28 @@ _io_thr_internal(void *cio_arg)
 	sigaddset(&set, SIGHUP);
  	pthread_sigmask(SIG_BLOCK, &set, NULL);
 
-	_set_listensocks_nonblocking(cio);
+	_set_listensocks_nonblocking(cio, shard->id);
 
 	/* start the eio engine */
-	eio_handle_mainloop(cio->eio);
+	eio_handle_mainloop(cio->eio[shard->id]);
 
-	debug("IO thread exiting");
+	debug("IO thread %d exiting", shard->id);
 
 	return NULL;
 }
 
 static eio_obj_t *
-_create_listensock_eio(int fd, client_io_t *cio)
+_create_listensock_eio(int fd, struct io_shard *shard)
 {
 	eio_obj_t *eio = NULL;
 
-	eio = eio_obj_create(fd, &listening_socket_ops, (void *)cio);
+	eio = eio_obj_create(fd, &listening_socket_ops, (void *)shard);
 
 	return eio;
 }
 
 static int
-_read_io_init_msg(int fd, client_io_t *cio, char *host)
+_read_io_init_msg(int fd, client_io_t *cio, int shard, char *host)
 {
 	struct slurm_io_init_msg msg;
 
@@ -850,19 +979,27 @@ _read_io_init_msg(int fd, client_io_t *cio, char *host)
 		error("IO: Hey, you told me node %d was down!", msg.nodeid);
 	}
 
+	slurm_mutex_lock(&cio->ioservers_lock);
 	cio->ioserver[msg.nodeid] = _create_server_eio_obj(fd, cio, msg.nodeid,
+							   shard,
 							   msg.stdout_objs,
 							   msg.stderr_objs);
-	slurm_mutex_lock(&cio->ioservers_lock);
+	cio->ioserver_shard[msg.nodeid] = shard;
 	bit_set(cio->ioservers_ready_bits, msg.nodeid);
 	cio->ioservers_ready = bit_set_count(cio->ioservers_ready_bits);
 	/* Normally using eio_new_initial_obj while the eio mainloop
 	 * is running is not safe, but since this code is running
-	 * inside of the eio mainloop there should be no problem.
+	 * inside of the mainloop of the same eio handle there should
+	 * be no problem.
 	 */
-	eio_new_initial_obj(cio->eio, cio->ioserver[msg.nodeid]);
+	eio_new_initial_obj(cio->eio[shard], cio->ioserver[msg.nodeid]);
 	slurm_mutex_unlock(&cio->ioservers_lock);
 
+	/* Open the flow control window for this stream */
+	_server_grant_credit((struct server_io_info *)
+			     cio->ioserver[msg.nodeid]->arg,
+			     STDIO_CREDIT_WINDOW);
+
 	if (cio->sls)
 		step_launch_clear_questionable_state(cio->sls, msg.nodeid);
 
@@ -890,7 +1027,7 @@ _is_fd_ready(int fd)
 
 
 static void
-_handle_io_init_msg(int fd, client_io_t *cio)
+_handle_io_init_msg(int fd, client_io_t *cio, int shard)
 {
 	int j;
 	debug2("Activity on IO listening socket %d", fd);
@@ -938,7 +1075,7 @@ _handle_io_init_msg(int fd, client_io_t *cio)
 		/*
 		 * Read IO header and update cio structure appropriately
 		 */
-		if (_read_io_init_msg(sd, cio, buf) < 0)
+		if (_read_io_init_msg(sd, cio, shard, buf) < 0)
 			continue;
 
 		fd_set_nonblocking(sd);
@@ -998,7 +1135,7 @@ _init_stdio_eio_objs(slurm_step_io_fds_t fds, client_io_t *cio)
 		fd_set_close_on_exec(fds.input.fd);
 		cio->stdin_obj = create_file_read_eio_obj(
 			fds.input.fd, fds.input.taskid, fds.input.nodeid, cio);
-		eio_new_initial_obj(cio->eio, cio->stdin_obj);
+		eio_new_initial_obj(cio->eio[0], cio->stdin_obj);
 	}
 
 	/*
@@ -1007,7 +1144,7 @@ _init_stdio_eio_objs(slurm_step_io_fds_t fds, client_io_t *cio)
 	if (fds.out.fd > -1) {
 		cio->stdout_obj = create_file_write_eio_obj(
 			fds.out.fd, fds.out.taskid, fds.out.nodeid, cio);
-		eio_new_initial_obj(cio->eio, cio->stdout_obj);
+		eio_new_initial_obj(cio->eio[0], cio->stdout_obj);
 	}
 
 	/*
@@ -1024,7 +1161,7 @@ _init_stdio_eio_objs(slurm_step_io_fds_t fds, client_io_t *cio)
 			cio->stderr_obj = create_file_write_eio_obj(
 				fds.err.fd, fds.err.taskid,
 				fds.err.nodeid, cio);
-			eio_new_initial_obj(cio->eio, cio->stderr_obj);
+			eio_new_initial_obj(cio->eio[0], cio->stderr_obj);
 		}
 	}
 }
@@ -1086,6 +1223,7 @@ client_io_handler_create(slurm_step_io_fds_t fds,
 	int i;
 	uint32_t siglen;
 	char *sig;
+	char *tmp;
 	uint16_t *ports;
 	uint16_t eio_timeout;
 
@@ -1111,7 +1249,6 @@ client_io_handler_create(slurm_step_io_fds_t fds,
 	/* no need to free "sig", it is just a pointer into the credential */
 
 	eio_timeout = slurm_get_srun_eio_timeout();
-	cio->eio = eio_handle_create(eio_timeout);
 
 	/* Compute number of listening sockets needed to allow
 	 * all of the slurmds to establish IO streams with srun, without
@@ -1121,7 +1258,32 @@ client_io_handler_create(slurm_step_io_fds_t fds,
 	cio->listensock = (int *)xmalloc(cio->num_listen * sizeof(int));
 	cio->listenport = (uint16_t *)xmalloc(cio->num_listen*sizeof(uint16_t));
 
+	/* Shard the listen sockets, and the node streams accepted on
+	 * them, over several event loops so decoding task output can
+	 * use more than one core on large steps
+	 */
+	cio->num_io_threads = _estimate_nports(num_nodes,
+					       STDIO_NODES_PER_IO_THREAD);
+	if ((tmp = getenv("SLURM_IO_THREADS")))
+		cio->num_io_threads = atoi(tmp);
+	cio->num_io_threads = MAX(cio->num_io_threads, 1);
+	cio->num_io_threads = MIN(cio->num_io_threads, STDIO_MAX_IO_THREADS);
+	cio->num_io_threads = MIN(cio->num_io_threads, cio->num_listen);
+
+	cio->eio = (eio_handle_t **)xmalloc(cio->num_io_threads *
+					    sizeof(eio_handle_t *));
+	cio->shards = (struct io_shard *)xmalloc(cio->num_io_threads *
+						 sizeof(struct io_shard));
+	cio->ioid = (pthread_t *)xmalloc(cio->num_io_threads *
+					 sizeof(pthread_t));
+	for (i = 0; i < cio->num_io_threads; i++) {
+		cio->eio[i] = eio_handle_create(eio_timeout);
+		cio->shards[i].cio = cio;
+		cio->shards[i].id = i;
+	}
+
 	cio->ioserver = (eio_obj_t **)xmalloc(num_nodes*sizeof(eio_obj_t *));
+	cio->ioserver_shard = (int *)xmalloc(num_nodes*sizeof(int));
 	cio->ioservers_ready_bits = bit_alloc(num_nodes);
 	cio->ioservers_ready = 0;
 	slurm_mutex_init(&cio->ioservers_lock);
@@ -1146,8 +1308,10 @@ client_io_handler_create(slurm_step_io_fds_t fds,
 		debug("initialized stdio listening socket, port %d",
 		      cio->listenport[i]);
 		/*net_set_low_water(cio->listensock[i], 140);*/
-		obj = _create_listensock_eio(cio->listensock[i], cio);
-		eio_new_initial_obj(cio->eio, obj);
+		obj = _create_listensock_eio(
+			cio->listensock[i],
+			&cio->shards[i % cio->num_io_threads]);
+		eio_new_initial_obj(cio->eio[i % cio->num_io_threads], obj);
 	}
 
 	cio->free_incoming = list_create(NULL); /* FIXME! Needs destructor */
@@ -1168,24 +1332,30 @@ client_io_handler_create(slurm_step_io_fds_t fds,
 int
 client_io_handler_start(client_io_t *cio)
 {
-	int retries = 0;
+	int retries;
+	int i;
 	pthread_attr_t attr;
 
 	xsignal(SIGTTIN, SIG_IGN);
 
 	slurm_attr_init(&attr);
-	while ((errno = pthread_create(&cio->ioid, &attr,
-				      &_io_thr_internal, (void *) cio))) {
-		if (++retries > MAX_RETRIES) {
-			error ("pthread_create error %m");
-			cio->ioid = 0;
-			slurm_attr_destroy(&attr);
-			return SLURM_ERROR;
+	for (i = 0; i < cio->num_io_threads; i++) {
+		retries = 0;
+		while ((errno = pthread_create(&cio->ioid[i], &attr,
+					       &_io_thr_internal,
+					       (void *) &cio->shards[i]))) {
+			if (++retries > MAX_RETRIES) {
+				error ("pthread_create error %m");
+				cio->ioid[i] = 0;
+				slurm_attr_destroy(&attr);
+				return SLURM_ERROR;
+			}
+			sleep(1);	/* sleep and try again */
 		}
-		sleep(1);	/* sleep and try again */
+		debug("Started IO server thread (%lu)",
+		      (unsigned long) cio->ioid[i]);
 	}
 	slurm_attr_destroy(&attr);
-	debug("Started IO server thread (%lu)", (unsigned long) cio->ioid);
 
 	return SLURM_SUCCESS;
 }
@@ -1227,25 +1397,35 @@ static void _delay_kill_thread(pthread_t thread_id, int secs)
 int
 client_io_handler_finish(client_io_t *cio)
 {
+	int i;
+	int rc = SLURM_SUCCESS;
+
 	if (cio == NULL)
 		return SLURM_SUCCESS;
 
-	eio_signal_shutdown(cio->eio);
+	for (i = 0; i < cio->num_io_threads; i++)
+		eio_signal_shutdown(cio->eio[i]);
 	/* Make the thread timeout consistent with
 	 * EIO_SHUTDOWN_WAIT
 	 */
-	_delay_kill_thread(cio->ioid, 180);
-	if (pthread_join(cio->ioid, NULL) < 0) {
-		error("Waiting for client io pthread: %m");
-		return SLURM_ERROR;
+	for (i = 0; i < cio->num_io_threads; i++) {
+		if (cio->ioid[i] == 0)
+			continue;
+		_delay_kill_thread(cio->ioid[i], 180);
+		if (pthread_join(cio->ioid[i], NULL) < 0) {
+			error("Waiting for client io pthread: %m");
+			rc = SLURM_ERROR;
+		}
 	}
 
-	return SLURM_SUCCESS;
+	return rc;
 }
 
 void
 client_io_handler_destroy(client_io_t *cio)
 {
+	int i;
+
 	if (cio == NULL)
 		return;
 
@@ -1255,9 +1435,14 @@ client_io_handler_destroy(client_io_t *cio)
 	slurm_mutex_destroy(&cio->ioservers_lock);
 	FREE_NULL_BITMAP(cio->ioservers_ready_bits);
 	xfree(cio->ioserver); /* need to destroy the obj first? */
+	xfree(cio->ioserver_shard);
 	xfree(cio->listenport);
 	xfree(cio->listensock);
-	eio_handle_destroy(cio->eio);
+	for (i = 0; i < cio->num_io_threads; i++)
+		eio_handle_destroy(cio->eio[i]);
+	xfree(cio->eio);
+	xfree(cio->shards);
+	xfree(cio->ioid);
 	xfree(cio->io_key);
 	xfree(cio);
 }
@@ -1295,7 +1480,8 @@ client_io_handler_downnodes(client_io_t *cio,
 	}
 	slurm_mutex_unlock(&cio->ioservers_lock);
 
-	eio_signal_wakeup(cio->eio);
+	for (i = 0; i < cio->num_io_threads; i++)
+		eio_signal_wakeup(cio->eio[i]);
 }
 
 
@@ -1379,7 +1565,8 @@ int client_io_handler_send_test_message(client_io_t *cio, int node_id,
 
 		list_enqueue( server->msg_queue, msg );
 
-		if (eio_signal_wakeup(cio->eio) != SLURM_SUCCESS) {
+		if (eio_signal_wakeup(cio->eio[cio->ioserver_shard[node_id]])
+		    != SLURM_SUCCESS) {
 			rc = SLURM_ERROR;
 			goto done;
 		}
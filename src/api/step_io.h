@@ -37,6 +37,7 @@
 #include "src/common/bitstring.h"
 #include "src/common/slurm_step_layout.h"
 struct step_launch_state;
+struct io_shard;	/* defined in step_io.c */
 
 
 struct client_io {
@@ -48,23 +49,35 @@ struct client_io {
 	char *io_key;
 
 	/* internal variables */
-	pthread_t ioid;		/* stdio thread id 		  */
+	int num_io_threads;	/* Number of stdio event loops (threads) */
+	pthread_t *ioid;	/* Array of stdio thread ids, one per loop */
+	struct io_shard *shards; /* Per-loop descriptors, passed to threads
+				  * and listen sockets to identify their
+				  * event loop */
 	int num_listen;		/* Number of stdio listen sockets */
 	int *listensock;	/* Array of stdio listen sockets  */
 	uint16_t *listenport;	/* Array of stdio listen port numbers */
 
-	eio_handle_t *eio;      /* Event IO handle for stdio traffic */
+	eio_handle_t **eio;     /* Event IO handles for stdio traffic, one
+				 * per thread.  The listen sockets and the
+				 * node streams accepted on them are spread
+				 * across the handles; the stdin/stdout/
+				 * stderr file objects always live on the
+				 * first one. */
 	pthread_mutex_t ioservers_lock; /* This lock protects
 				   ioservers_ready_bits, ioservers_ready,
-				   pointers in ioserver, all the msg_queues
-				   in each ioserver's server_io_info, and
-				   the free_incoming list.  The queues
-				   are used both for normal writes
-				   and writes that verify a connection to
-				   a remote host. */
+				   pointers in ioserver, ioserver_shard,
+				   all the msg_queues in each ioserver's
+				   server_io_info, io_buf reference counts,
+				   and the free_incoming and free_outgoing
+				   lists.  The queues are used both for
+				   normal writes and writes that verify a
+				   connection to a remote host. */
 	bitstr_t *ioservers_ready_bits; /* length "num_nodes" */
 	int ioservers_ready;    /* Number of servers that established contact */
 	eio_obj_t **ioserver;	/* Array of nhosts pointers to eio_obj_t */
+	int *ioserver_shard;	/* Array of nhosts indexes of the event loop
+				 * polling each node's stream */
 	eio_obj_t *stdin_obj;
 	eio_obj_t *stdout_obj;
 	eio_obj_t *stderr_obj;
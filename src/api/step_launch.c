@@ -604,7 +604,7 @@ void slurm_step_launch_wait_finish(slurm_step_ctx_t *ctx)
 	struct step_launch_state *sls;
 	struct timespec ts = {0, 0};
 	bool time_set = false;
-	int errnum;
+	int i, errnum;
 
 	if (! ctx || ctx->magic != STEP_CTX_MAGIC)
 		return;
@@ -689,12 +689,18 @@ void slurm_step_launch_wait_finish(slurm_step_ctx_t *ctx)
 		client_io_handler_abort(sls->io.normal);
 	}
 
-	/* Then shutdown the message handler thread */
+	/* Then shutdown the message handler threads */
 	eio_signal_shutdown(sls->msg_handle);
+	for (i = 0; i < sls->num_msg_aux_threads; i++)
+		eio_signal_shutdown(sls->msg_aux_handles[i]);
 
 	slurm_mutex_unlock(&sls->lock);
 	if (sls->msg_thread)
 		pthread_join(sls->msg_thread, NULL);
+	for (i = 0; i < sls->num_msg_aux_threads; i++) {
+		if (sls->msg_aux_threads[i])
+			pthread_join(sls->msg_aux_threads[i], NULL);
+	}
 	slurm_mutex_lock(&sls->lock);
 	pmi_kvs_free();
 
@@ -702,6 +708,13 @@ void slurm_step_launch_wait_finish(slurm_step_ctx_t *ctx)
 		eio_handle_destroy(sls->msg_handle);
 		sls->msg_handle = NULL;
 	}
+	for (i = 0; i < sls->num_msg_aux_threads; i++) {
+		if (sls->msg_aux_handles[i])
+			eio_handle_destroy(sls->msg_aux_handles[i]);
+	}
+	xfree(sls->msg_aux_handles);
+	xfree(sls->msg_aux_threads);
+	sls->num_msg_aux_threads = 0;
 
 	/* Shutdown the io timeout thread, if one exists */
 	if (sls->io_timeout_thread_created) {
@@ -885,6 +898,9 @@ struct step_launch_state *step_launch_state_create(slurm_step_ctx_t *ctx)
 	sls->halt_io_test = false;
 	sls->layout = layout;
 	sls->resp_port = NULL;
+	sls->msg_aux_handles = NULL;
+	sls->msg_aux_threads = NULL;
+	sls->num_msg_aux_threads = 0;
 	sls->abort = false;
 	sls->abort_action_taken = false;
 	sls->mpi_info->jobid = ctx->step_req->job_id;
@@ -1053,6 +1069,16 @@ _estimate_nports(int nclients, int cli_per_port)
 	return d.rem > 0 ? d.quot + 1 : d.quot;
 }
 
+/* Upper limit on the number of threads processing launch responses */
+#define STEP_MSG_THREADS_MAX 8
+
+static void *_msg_aux_thr_internal(void *arg)
+{
+	eio_handle_mainloop((eio_handle_t *) arg);
+
+	return NULL;
+}
+
 static int _msg_thr_create(struct step_launch_state *sls, int num_nodes)
 {
 	int sock = -1;
@@ -1071,6 +1097,20 @@ static int _msg_thr_create(struct step_launch_state *sls, int num_nodes)
 	sls->num_resp_port = _estimate_nports(num_nodes, 48);
 	sls->resp_port = xmalloc(sizeof(uint16_t) * sls->num_resp_port);
 
+	/* For large steps, shard the response ports over additional
+	 * message threads so responses are processed concurrently
+	 * rather than serialized on a single eio loop. */
+	if (sls->num_resp_port > 1) {
+		sls->num_msg_aux_threads =
+			MIN(sls->num_resp_port, STEP_MSG_THREADS_MAX) - 1;
+		sls->msg_aux_handles = xmalloc(sizeof(eio_handle_t *) *
+					       sls->num_msg_aux_threads);
+		sls->msg_aux_threads = xmalloc(sizeof(pthread_t) *
+					       sls->num_msg_aux_threads);
+		for (i = 0; i < sls->num_msg_aux_threads; i++)
+			sls->msg_aux_handles[i] = eio_handle_create(eio_timeout);
+	}
+
 	/* multiple jobs (easily induced via no_alloc) and highly
 	 * parallel jobs using PMI sometimes result in slow message
 	 * responses and timeouts. Raise the default timeout for srun. */
@@ -1079,7 +1119,7 @@ static int _msg_thr_create(struct step_launch_state *sls, int num_nodes)
 
 	ports = slurm_get_srun_port_range();
 	for (i = 0; i < sls->num_resp_port; i++) {
-		int cc;
+		int cc, shard;
 
 		if (ports)
 			cc = net_stream_listen_ports(&sock, &port, ports);
@@ -1092,7 +1132,12 @@ static int _msg_thr_create(struct step_launch_state *sls, int num_nodes)
 		}
 		sls->resp_port[i] = port;
 		obj = eio_obj_create(sock, &message_socket_ops, (void *)sls);
-		eio_new_initial_obj(sls->msg_handle, obj);
+		shard = i % (sls->num_msg_aux_threads + 1);
+		if (shard)
+			eio_new_initial_obj(sls->msg_aux_handles[shard - 1],
+					    obj);
+		else
+			eio_new_initial_obj(sls->msg_handle, obj);
 	}
 	/* finally, add the listening port that we told the slurmctld about
 	 * eariler in the step context creation phase */
@@ -1110,6 +1155,16 @@ static int _msg_thr_create(struct step_launch_state *sls, int num_nodes)
 		sls->msg_thread = 0;
 		rc = SLURM_ERROR;
 	}
+	for (i = 0; i < sls->num_msg_aux_threads; i++) {
+		if (pthread_create(&sls->msg_aux_threads[i], &attr,
+				   _msg_aux_thr_internal,
+				   (void *)sls->msg_aux_handles[i]) != 0) {
+			error("pthread_create of message thread: %m");
+			/* make sure the thread is 0 so we don't wait on it */
+			sls->msg_aux_threads[i] = 0;
+			rc = SLURM_ERROR;
+		}
+	}
 	slurm_attr_destroy(&attr);
 	return rc;
 }
@@ -83,6 +83,12 @@ struct step_launch_state {
 	/* message thread variables */
 	eio_handle_t *msg_handle;
 	pthread_t msg_thread;
+	/* auxiliary message threads, each running its own eio loop over
+	   a shard of the response ports so that launch response
+	   processing for large steps is not serialized on one thread */
+	eio_handle_t **msg_aux_handles;
+	pthread_t *msg_aux_threads;
+	uint16_t num_msg_aux_threads;
 	/* set to -1 if step launch message handler should not attempt
 	   to handle */
 	int slurmctld_socket_fd;
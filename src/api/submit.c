@@ -49,6 +49,7 @@ extern pid_t getsid(pid_t pid);		/* missing from <unistd.h> */
 
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
 
 /*
  * slurm_submit_batch_job - issue RPC to submit a job for later execution
@@ -114,3 +115,79 @@ slurm_submit_batch_job (job_desc_msg_t *req,
 
 	return SLURM_PROTOCOL_SUCCESS;
 }
+
+/*
+ * slurm_submit_batch_jobs - issue a single RPC to submit multiple jobs
+ *	for later execution
+ * NOTE: free the response using slurm_free_submit_response_list_msg
+ * IN req - descriptions of the batch job requests
+ * OUT resp - response to request, one entry per descriptor
+ * RET 0 on success, otherwise return -1 and set errno to indicate the error
+ */
+int
+slurm_submit_batch_jobs (job_desc_list_msg_t *req,
+			 submit_response_list_msg_t **resp)
+{
+	int rc;
+	uint32_t i;
+	slurm_msg_t req_msg;
+	slurm_msg_t resp_msg;
+	bool *host_set = NULL;
+	char host[64];
+	bool have_host = false;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+
+	if (gethostname_short(host, sizeof(host)) == 0)
+		have_host = true;
+	host_set = xmalloc(req->job_count * sizeof(bool));
+
+	/*
+	 * set Node and session id for each request
+	 */
+	for (i = 0; i < req->job_count; i++) {
+		job_desc_msg_t *desc = req->job_descs[i];
+
+		if (desc->alloc_sid == NO_VAL)
+			desc->alloc_sid = getsid(0);
+		if ((desc->alloc_node == NULL) && have_host) {
+			desc->alloc_node = host;
+			host_set[i] = true;
+		}
+	}
+
+	req_msg.msg_type = REQUEST_SUBMIT_BATCH_JOBS;
+	req_msg.data     = req;
+
+	rc = slurm_send_recv_controller_msg(&req_msg, &resp_msg);
+
+	/*
+	 *  Clear the hostnames set internally to this function
+	 *    (memory is on the stack)
+	 */
+	for (i = 0; i < req->job_count; i++) {
+		if (host_set[i])
+			req->job_descs[i]->alloc_node = NULL;
+	}
+	xfree(host_set);
+
+	if (rc == SLURM_SOCKET_ERROR)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		if (rc)
+			slurm_seterrno_ret(rc);
+		*resp = NULL;
+		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		*resp = (submit_response_list_msg_t *) resp_msg.data;
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+	}
+
+	return SLURM_PROTOCOL_SUCCESS;
+}
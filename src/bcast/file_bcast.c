@@ -77,6 +77,8 @@
 
 #define MAX_THREADS      8	/* These can be huge messages, so
 				 * only run MAX_THREADS at one time */
+#define FILE_BCAST_WINDOW 4	/* Default number of blocks kept in flight
+				 * through the forward tree */
 
 int block_len;				/* block size */
 int fd;					/* source file descriptor */
@@ -84,6 +86,12 @@ void *src;				/* source mmap'd address */
 struct stat f_stat;			/* source file stats */
 job_sbcast_cred_msg_t *sbcast_cred;	/* job alloc info and sbcast cred */
 
+static int remaining = -1;	/* bytes of the current file left to read */
+static void *position;		/* read cursor within the mmap'd file */
+static int max_out;		/* zlib worst case compressed block size */
+static uint64_t src_digest;	/* hash of the complete source file */
+static uint32_t cache_hit_cnt;	/* nodes reporting a cached copy */
+
 static int   _bcast_file(struct bcast_parameters *params);
 static int   _file_bcast(struct bcast_parameters *params,
 			 file_bcast_msg_t *bcast_msg,
@@ -91,6 +99,28 @@ static int   _file_bcast(struct bcast_parameters *params,
 static int   _file_state(struct bcast_parameters *params);
 static int  _get_job_info(struct bcast_parameters *params);
 
+/* FNV-1a starting value, see bcast_hash_update() */
+extern uint64_t bcast_hash_init(void)
+{
+	return 0xcbf29ce484222325ULL;
+}
+
+/* Fold a buffer into a running FNV-1a hash. The same function runs on
+ * both ends of the transfer: the sender hashes the source file and the
+ * receiving slurmd hashes its cached copy to decide if the transfer can
+ * be skipped, so the two must never diverge. */
+extern uint64_t bcast_hash_update(uint64_t digest, const void *data,
+				  uint64_t len)
+{
+	const unsigned char *ptr = data;
+	uint64_t i;
+
+	for (i = 0; i < len; i++) {
+		digest ^= ptr[i];
+		digest *= 0x100000001b3ULL;
+	}
+	return digest;
+}
 
 static int _file_state(struct bcast_parameters *params)
 {
@@ -123,6 +153,8 @@ static int _file_state(struct bcast_parameters *params)
 		error("Can't mmap file `%s`, %m.", params->src_fname);
 		return SLURM_ERROR;
 	}
+	src_digest = bcast_hash_update(bcast_hash_init(), src,
+				       f_stat.st_size);
 
 	return SLURM_SUCCESS;
 }
@@ -134,6 +166,12 @@ static int _get_job_info(struct bcast_parameters *params)
 
 	xassert(params->job_id != NO_VAL);
 
+	/* A single process may stage several files to the same job
+	 * (e.g. srun --bcast with a library list), reuse the credential
+	 * from the first lookup */
+	if (sbcast_cred)
+		return SLURM_SUCCESS;
+
 	rc = slurm_sbcast_lookup(params->job_id, params->step_id, &sbcast_cred);
 	if (rc != SLURM_SUCCESS) {
 		if (params->step_id == NO_VAL) {
@@ -192,6 +230,14 @@ static int _file_bcast(struct bcast_parameters *params,
 					       ret_data_info->data);
 		if (msg_rc == SLURM_SUCCESS)
 			continue;
+		if (msg_rc == ESLURMD_BCAST_FILE_ALREADY_CACHED) {
+			/* node already holds identical file contents,
+			 * not an error */
+			debug("REQUEST_FILE_BCAST(%s): cached copy",
+			      ret_data_info->node_name);
+			cache_hit_cnt++;
+			continue;
+		}
 
 		error("REQUEST_FILE_BCAST(%s): %s",
 		      ret_data_info->node_name,
@@ -208,15 +254,14 @@ static int _file_bcast(struct bcast_parameters *params,
  * return number of bytes read, zero on end of file */
 static int _get_block_none(char **buffer, int *orig_len, bool *more)
 {
-	static int remaining = -1;
-	static void *position;
 	int size;
 
 	if (remaining < 0) {
-		*buffer = xmalloc(block_len);
 		remaining = f_stat.st_size;
 		position = src;
 	}
+	if (!*buffer)	/* caller may hand off each buffer to the window */
+		*buffer = xmalloc(block_len);
 
 	size = MIN(block_len, remaining);
 	memcpy(*buffer, position, size);
@@ -238,9 +283,6 @@ static int _get_block_zlib(struct bcast_parameters *params,
 	int chunk = (256 * 1024);
 	int flush = Z_NO_FLUSH;
 
-	static int remaining = -1;
-	static int max_out;
-	static void *position;
 	int chunk_remaining, out_remaining, chunk_bite, size = 0;
 
 	/* allocate deflate state, compress each block independently */
@@ -260,9 +302,10 @@ static int _get_block_zlib(struct bcast_parameters *params,
 	if (remaining < 0) {
 		remaining = f_stat.st_size;
 		max_out = deflateBound(&strm, block_len);
-		*buffer = xmalloc(max_out);
 		position = src;
 	}
+	if (!*buffer)
+		*buffer = xmalloc(max_out);
 
 	chunk_remaining = MIN(block_len, remaining);
 	out_remaining = max_out;
@@ -305,8 +348,6 @@ static int _get_block_lz4(struct bcast_parameters *params,
 {
 #if HAVE_LZ4
 	int size_out;
-	static int remaining = -1;
-	static void *position;
 	int size;
 
 	if (!f_stat.st_size) {
@@ -317,8 +358,9 @@ static int _get_block_lz4(struct bcast_parameters *params,
 	if (remaining < 0) {
 		position = src;
 		remaining = f_stat.st_size;
-		*buffer = xmalloc(block_len);
 	}
+	if (!*buffer)
+		*buffer = xmalloc(block_len);
 
 	/* intentionally limit decompressed size to 10x compressed
 	 * to avoid problems on receive size when decompressed */
@@ -363,6 +405,100 @@ static int _next_block(struct bcast_parameters *params,
 	return _get_block_none(buffer, orig_len, more);
 }
 
+/* Sliding window of blocks kept in flight through the forward tree.
+ * Each worker owns a private copy of the message and its data block.
+ * Block 1 and the last block are always sent synchronously: the first
+ * registers the file and caches the sbcast credential on every node,
+ * the last triggers chmod/chown/utime and must trail all other data. */
+typedef struct window_send {
+	struct bcast_parameters *params;
+	file_bcast_msg_t msg;
+} window_send_t;
+
+static pthread_mutex_t window_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  window_cond  = PTHREAD_COND_INITIALIZER;
+static uint32_t window_inflight = 0;
+static int window_rc = SLURM_SUCCESS;
+
+static void *_window_send(void *x)
+{
+	window_send_t *ws = (window_send_t *) x;
+	int rc;
+
+	rc = _file_bcast(ws->params, &ws->msg, sbcast_cred);
+
+	slurm_mutex_lock(&window_mutex);
+	window_rc = MAX(window_rc, rc);
+	window_inflight--;
+	slurm_cond_broadcast(&window_cond);
+	slurm_mutex_unlock(&window_mutex);
+
+	xfree(ws->msg.block);
+	xfree(ws);
+	return NULL;
+}
+
+/* Hand one block to a worker thread, blocking while the window is full.
+ * Takes ownership of the data block. Returns the first error seen by any
+ * worker so the caller can stop issuing new blocks. */
+static int _window_dispatch(struct bcast_parameters *params,
+			    file_bcast_msg_t *bcast_msg)
+{
+	window_send_t *ws;
+	pthread_attr_t attr;
+	pthread_t tid;
+	int rc;
+
+	slurm_mutex_lock(&window_mutex);
+	while ((window_rc == SLURM_SUCCESS) &&
+	       (window_inflight >= params->window))
+		slurm_cond_wait(&window_cond, &window_mutex);
+	rc = window_rc;
+	if (rc != SLURM_SUCCESS) {
+		slurm_mutex_unlock(&window_mutex);
+		xfree(bcast_msg->block);
+		return rc;
+	}
+	window_inflight++;
+	slurm_mutex_unlock(&window_mutex);
+
+	ws = xmalloc(sizeof(window_send_t));
+	ws->params = params;
+	ws->msg = *bcast_msg;	/* worker now owns msg.block */
+
+	slurm_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if (pthread_create(&tid, &attr, _window_send, ws)) {
+		/* fall back to sending this block in-line */
+		error("pthread_create: %m");
+		rc = _file_bcast(params, &ws->msg, sbcast_cred);
+		slurm_mutex_lock(&window_mutex);
+		window_rc = MAX(window_rc, rc);
+		window_inflight--;
+		slurm_cond_broadcast(&window_cond);
+		slurm_mutex_unlock(&window_mutex);
+		xfree(ws->msg.block);
+		xfree(ws);
+	}
+	slurm_attr_destroy(&attr);
+
+	return rc;
+}
+
+/* wait for all in-flight blocks, return the worst return code seen */
+static int _window_drain(void)
+{
+	int rc;
+
+	slurm_mutex_lock(&window_mutex);
+	while (window_inflight)
+		slurm_cond_wait(&window_cond, &window_mutex);
+	rc = window_rc;
+	slurm_mutex_unlock(&window_mutex);
+
+	return rc;
+}
+
 /* read and broadcast the file */
 static int _bcast_file(struct bcast_parameters *params)
 {
@@ -389,6 +525,7 @@ static int _bcast_file(struct bcast_parameters *params)
 	bcast_msg.user_name	= uid_to_string(f_stat.st_uid);
 	bcast_msg.gid		= f_stat.st_gid;
 	bcast_msg.file_size	= f_stat.st_size;
+	bcast_msg.digest	= src_digest;
 	bcast_msg.cred          = sbcast_cred->sbcast_cred;
 
 	if (params->preserve) {
@@ -400,6 +537,9 @@ static int _bcast_file(struct bcast_parameters *params)
 		params->fanout = MAX_THREADS;
 	slurm_set_tree_width(MIN(MAX_THREADS, params->fanout));
 
+	if (!params->window)
+		params->window = FILE_BCAST_WINDOW;
+
 	while (more) {
 		START_TIMER;
 		bcast_msg.block_len = _next_block(params, &buffer, &orig_len,
@@ -416,14 +556,56 @@ static int _bcast_file(struct bcast_parameters *params)
 		if (!more)
 			bcast_msg.last_block = 1;
 
-		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
+		if ((params->window > 1) && (bcast_msg.block_no > 1) &&
+		    !bcast_msg.last_block) {
+			/* middle blocks ride the window, the receiving
+			 * slurmd positions each write by block_offset */
+			rc = _window_dispatch(params, &bcast_msg);
+			buffer = NULL;	/* block handed to a worker */
+		} else {
+			if (bcast_msg.last_block)
+				rc = _window_drain();
+			if (rc == SLURM_SUCCESS)
+				rc = _file_bcast(params, &bcast_msg,
+						 sbcast_cred);
+		}
 		if (rc != SLURM_SUCCESS)
 			break;
+		if (bcast_msg.block_no == 1) {
+			/* the first block carries the file digest, nodes
+			 * holding an identical cached copy answer without
+			 * registering the transfer */
+			if (cache_hit_cnt &&
+			    (cache_hit_cnt >= sbcast_cred->node_cnt)) {
+				verbose("File `%s` already cached on all "
+					"%u nodes, transfer skipped",
+					params->dst_fname,
+					sbcast_cred->node_cnt);
+				break;
+			}
+			if (cache_hit_cnt) {
+				/* Cache hit on only some nodes. Resend the
+				 * first block without a digest so that every
+				 * node registers the transfer and rewrites
+				 * the file. */
+				debug("File `%s` cached on %u of %u nodes, "
+				      "resending to all",
+				      params->dst_fname, cache_hit_cnt,
+				      sbcast_cred->node_cnt);
+				cache_hit_cnt = 0;
+				bcast_msg.digest = 0;
+				rc = _file_bcast(params, &bcast_msg,
+						 sbcast_cred);
+				if (rc != SLURM_SUCCESS)
+					break;
+			}
+		}
 		if (bcast_msg.last_block)
 			break;	/* end of file */
 		bcast_msg.block_no++;
 		bcast_msg.block_offset += orig_len;
 	}
+	rc = MAX(rc, _window_drain());
 	xfree(bcast_msg.user_name);
 	xfree(buffer);
 
@@ -530,12 +712,22 @@ extern int bcast_file(struct bcast_parameters *params)
 {
 	int rc;
 
+	/* reset per-file state, a single process may stage several files */
+	remaining = -1;
+	src_digest = 0;
+	cache_hit_cnt = 0;
+	window_rc = SLURM_SUCCESS;
+
 	if ((rc = _file_state(params)) != SLURM_SUCCESS)
 		return rc;
 	if ((rc = _get_job_info(params)) != SLURM_SUCCESS)
 		return rc;
-	if ((rc = _bcast_file(params)) != SLURM_SUCCESS)
-		return rc;
+	rc = _bcast_file(params);
+
+	if (f_stat.st_size && src)
+		(void) munmap(src, f_stat.st_size);
+	src = NULL;
+	close(fd);
 
 /*	slurm_free_sbcast_cred_msg(sbcast_cred); */
 	return rc;
@@ -52,6 +52,7 @@ struct bcast_parameters {
 	uint32_t step_id;
 	int  timeout;
 	int  verbose;
+	uint32_t window;
 };
 
 typedef struct file_bcast_info {
@@ -72,4 +73,10 @@ extern int bcast_file(struct bcast_parameters *params);
 
 extern int bcast_decompress_data(file_bcast_msg_t *req);
 
+/* incremental FNV-1a content hash, shared by the bcast sender and the
+ * receiving slurmd's file cache */
+extern uint64_t bcast_hash_init(void);
+extern uint64_t bcast_hash_update(uint64_t digest, const void *data,
+				  uint64_t len);
+
 #endif
@@ -69,13 +69,26 @@ List assoc_mgr_wckey_list = NULL;
 
 static char *assoc_mgr_cluster_name = NULL;
 static int setup_children = 0;
-static assoc_mgr_lock_flags_t assoc_mgr_locks;
+static void _free_usage_cache(void);
 static assoc_init_args_t init_setup;
 static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
 
-static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
+/* One rwlock per data type. Statically initialized since locks may be
+ * taken before assoc_mgr_init() is called. Where available preserve the
+ * writer preference of the old condition variable based implementation,
+ * a steady stream of read locks from job submission and the acct policy
+ * checks must not starve slurmdbd updates. */
+#ifdef PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP
+#  define ASSOC_MGR_RWLOCK_INIT PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP
+#else
+#  define ASSOC_MGR_RWLOCK_INIT PTHREAD_RWLOCK_INITIALIZER
+#endif
+static pthread_rwlock_t assoc_mgr_rwlocks[ASSOC_MGR_ENTITY_COUNT] = {
+	ASSOC_MGR_RWLOCK_INIT, ASSOC_MGR_RWLOCK_INIT, ASSOC_MGR_RWLOCK_INIT,
+	ASSOC_MGR_RWLOCK_INIT, ASSOC_MGR_RWLOCK_INIT, ASSOC_MGR_RWLOCK_INIT,
+	ASSOC_MGR_RWLOCK_INIT
+};
 
 static int _get_str_inx(char *name)
 {
@@ -1850,65 +1863,29 @@ static int _refresh_assoc_wckey_list(void *db_conn, int enforce)
 /* _wr_rdlock - Issue a read lock on the specified data type */
 static void _wr_rdlock(assoc_mgr_lock_datatype_t datatype)
 {
-	//info("going to read lock on %d", datatype);
-	slurm_mutex_lock(&locks_mutex);
-	//info("read lock on %d", datatype);
-	while (1) {
-		if ((assoc_mgr_locks.entity[write_wait_lock(datatype)] ==
-		     0)
-		    && (assoc_mgr_locks.entity[write_lock(datatype)] ==
-			0)) {
-			assoc_mgr_locks.entity[read_lock(datatype)]++;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-		}
-	}
-	slurm_mutex_unlock(&locks_mutex);
+	if (pthread_rwlock_rdlock(&assoc_mgr_rwlocks[datatype]))
+		fatal("pthread_rwlock_rdlock: %m");
 }
 
 /* _wr_rdunlock - Issue a read unlock on the specified data type */
 static void _wr_rdunlock(assoc_mgr_lock_datatype_t datatype)
 {
-	//info("going to read unlock on %d", datatype);
-	slurm_mutex_lock(&locks_mutex);
-	//info("read unlock on %d", datatype);
-	assoc_mgr_locks.entity[read_lock(datatype)]--;
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	if (pthread_rwlock_unlock(&assoc_mgr_rwlocks[datatype]))
+		fatal("pthread_rwlock_unlock: %m");
 }
 
 /* _wr_wrlock - Issue a write lock on the specified data type */
 static void _wr_wrlock(assoc_mgr_lock_datatype_t datatype)
 {
-	//info("going to write lock on %d", datatype);
-	slurm_mutex_lock(&locks_mutex);
-	assoc_mgr_locks.entity[write_wait_lock(datatype)]++;
-
-	//info("write lock on %d", datatype);
-	while (1) {
-		if ((assoc_mgr_locks.entity[read_lock(datatype)] == 0) &&
-		    (assoc_mgr_locks.entity[write_lock(datatype)] == 0)) {
-			assoc_mgr_locks.entity[write_lock(datatype)]++;
-			assoc_mgr_locks.
-				entity[write_wait_lock(datatype)]--;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-		}
-	}
-	slurm_mutex_unlock(&locks_mutex);
+	if (pthread_rwlock_wrlock(&assoc_mgr_rwlocks[datatype]))
+		fatal("pthread_rwlock_wrlock: %m");
 }
 
 /* _wr_wrunlock - Issue a write unlock on the specified data type */
 static void _wr_wrunlock(assoc_mgr_lock_datatype_t datatype)
 {
-	//info("going to write unlock on %d", datatype);
-	slurm_mutex_lock(&locks_mutex);
-	//info("write unlock on %d", datatype);
-	assoc_mgr_locks.entity[write_lock(datatype)]--;
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	if (pthread_rwlock_unlock(&assoc_mgr_rwlocks[datatype]))
+		fatal("pthread_rwlock_unlock: %m");
 }
 
 extern int assoc_mgr_init(void *db_conn, assoc_init_args_t *args,
@@ -1923,7 +1900,6 @@ extern int assoc_mgr_init(void *db_conn, assoc_init_args_t *args,
 
 		xfree(prio);
 		checked_prio = 1;
-		memset(&assoc_mgr_locks, 0, sizeof(assoc_mgr_locks));
 		memset(&init_setup, 0, sizeof(assoc_init_args_t));
 		init_setup.cache_level = ASSOC_MGR_CACHE_ALL;
 	}
@@ -2017,6 +1993,7 @@ extern int assoc_mgr_fini(char *state_save_location)
 	FREE_NULL_LIST(assoc_mgr_qos_list);
 	FREE_NULL_LIST(assoc_mgr_user_list);
 	FREE_NULL_LIST(assoc_mgr_wckey_list);
+	_free_usage_cache();
 	if (assoc_mgr_tres_name_array) {
 		int i;
 		for (i=0; i<g_tres_count; i++)
@@ -5073,10 +5050,114 @@ extern void assoc_mgr_remove_qos_usage(slurmdb_qos_rec_t *qos)
 	}
 }
 
+/* Incremental association usage saves: rather than rewriting the full
+ * assoc_usage file every save period, associations whose usage is
+ * unchanged since the previous save are skipped and only the dirty ones
+ * are appended to an assoc_usage.journal file. A full snapshot (which
+ * truncates the journal) is taken every USAGE_SNAPSHOT_PERIOD saves, or
+ * whenever the association or TRES lists change shape. The cache below
+ * holds the last-saved usage per user association, in association list
+ * order so the save-time comparison is a single linear walk. */
+#define USAGE_SNAPSHOT_PERIOD	20
+
+typedef struct {
+	uint32_t id;
+	long double usage_raw;
+	double grp_used_wall;
+	long double *tres_raw;
+} usage_cache_t;
+
+static usage_cache_t *usage_cache = NULL;
+static int usage_cache_cnt = 0;
+static int usage_cache_tres_cnt = 0;
+static int usage_save_cnt = 0;	/* saves since the last full snapshot */
+
+static void _free_usage_cache(void)
+{
+	int i;
+
+	for (i = 0; i < usage_cache_cnt; i++)
+		xfree(usage_cache[i].tres_raw);
+	xfree(usage_cache);
+	usage_cache_cnt = 0;
+	usage_save_cnt = 0;
+}
+
+/* Record assoc's current usage in usage cache entry inx */
+static void _set_usage_cache(int inx, slurmdb_assoc_rec_t *assoc)
+{
+	usage_cache[inx].id = assoc->id;
+	usage_cache[inx].usage_raw = assoc->usage->usage_raw;
+	usage_cache[inx].grp_used_wall = assoc->usage->grp_used_wall;
+	if (!usage_cache[inx].tres_raw)
+		usage_cache[inx].tres_raw = xmalloc(g_tres_count *
+						    sizeof(long double));
+	memcpy(usage_cache[inx].tres_raw, assoc->usage->usage_tres_raw,
+	       g_tres_count * sizeof(long double));
+}
+
+/* Write nwrite bytes from data to an open state file, returns errno */
+static int _write_state_data(int log_fd, char *file_name, char *data,
+			     int nwrite)
+{
+	int pos = 0, amount;
+
+	while (nwrite > 0) {
+		amount = write(log_fd, &data[pos], nwrite);
+		if ((amount < 0) && (errno != EINTR)) {
+			error("Error writing file %s, %m", file_name);
+			return errno;
+		}
+		nwrite -= amount;
+		pos    += amount;
+	}
+	return 0;
+}
+
+/* Append the usage records in buffer to the assoc_usage journal file,
+ * writing the standard state header first when the journal is empty */
+static int _append_usage_journal(char *state_save_location, Buf buffer)
+{
+	int error_code = 0, log_fd;
+	char *journal_file;
+	struct stat stat_buf;
+
+	journal_file = xstrdup_printf("%s/assoc_usage.journal",
+				      state_save_location);
+	log_fd = open(journal_file, O_CREAT | O_WRONLY | O_APPEND, 0600);
+	if (log_fd < 0) {
+		error("Can't save state, open file %s error %m",
+		      journal_file);
+		error_code = errno;
+	} else {
+		if ((fstat(log_fd, &stat_buf) == 0) &&
+		    (stat_buf.st_size == 0)) {
+			Buf header = init_buf(BUF_SIZE);
+			pack16(SLURM_PROTOCOL_VERSION, header);
+			pack_time(time(NULL), header);
+			error_code = _write_state_data(
+				log_fd, journal_file,
+				(char *)get_buf_data(header),
+				get_buf_offset(header));
+			free_buf(header);
+		}
+		if (!error_code)
+			error_code = _write_state_data(
+				log_fd, journal_file,
+				(char *)get_buf_data(buffer),
+				get_buf_offset(buffer));
+		fsync(log_fd);
+		close(log_fd);
+	}
+	xfree(journal_file);
+	return error_code;
+}
+
 extern int dump_assoc_mgr_state(char *state_save_location)
 {
 	static int high_buffer_size = (1024 * 1024);
-	int error_code = 0, log_fd;
+	int error_code = 0, log_fd, rc;
+	bool full_snapshot;
 	char *old_file = NULL, *new_file = NULL, *reg_file = NULL,
 		*tmp_char = NULL;
 	dbd_list_msg_t msg;
@@ -5194,18 +5275,36 @@ extern int dump_assoc_mgr_state(char *state_save_location)
 	/* now make a file for assoc_usage */
 
 	buffer = init_buf(high_buffer_size);
-	/* write header: version, time */
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
 
-	if (assoc_mgr_assoc_list) {
+	full_snapshot = (!usage_cache || !assoc_mgr_assoc_list ||
+			 (usage_cache_tres_cnt != g_tres_count) ||
+			 (++usage_save_cnt >= USAGE_SNAPSHOT_PERIOD));
+
+	if (!full_snapshot) {
+		/* journal only the associations whose usage changed */
 		ListIterator itr = NULL;
 		slurmdb_assoc_rec_t *assoc = NULL;
+		int inx = 0;
 		itr = list_iterator_create(assoc_mgr_assoc_list);
 		while ((assoc = list_next(itr))) {
 			if (!assoc->user)
 				continue;
-
+			if ((inx >= usage_cache_cnt) ||
+			    (usage_cache[inx].id != assoc->id)) {
+				/* the association list changed shape */
+				full_snapshot = true;
+				break;
+			}
+			if ((usage_cache[inx].usage_raw ==
+			     assoc->usage->usage_raw) &&
+			    (usage_cache[inx].grp_used_wall ==
+			     assoc->usage->grp_used_wall) &&
+			    !memcmp(usage_cache[inx].tres_raw,
+				    assoc->usage->usage_tres_raw,
+				    g_tres_count * sizeof(long double))) {
+				inx++;
+				continue;
+			}
 			pack32(assoc->id, buffer);
 			packlongdouble(assoc->usage->usage_raw, buffer);
 			tmp_char = _make_usage_tres_raw_str(
@@ -5213,52 +5312,92 @@ extern int dump_assoc_mgr_state(char *state_save_location)
 			packstr(tmp_char, buffer);
 			xfree(tmp_char);
 			pack32(assoc->usage->grp_used_wall, buffer);
+			_set_usage_cache(inx, assoc);
+			inx++;
 		}
 		list_iterator_destroy(itr);
+		if (inx != usage_cache_cnt)	/* associations removed */
+			full_snapshot = true;
 	}
 
-	reg_file = xstrdup_printf("%s/assoc_usage", state_save_location);
-	old_file = xstrdup_printf("%s.old", reg_file);
-	new_file = xstrdup_printf("%s.new", reg_file);
-
-	log_fd = creat(new_file, 0600);
-	if (log_fd < 0) {
-		error("Can't save state, create file %s error %m",
-		      new_file);
-		error_code = errno;
+	if (!full_snapshot) {
+		if (get_buf_offset(buffer) &&
+		    (rc = _append_usage_journal(state_save_location, buffer)))
+			error_code = rc;
 	} else {
-		int pos = 0, nwrite = get_buf_offset(buffer), amount;
-		char *data = (char *)get_buf_data(buffer);
-		high_buffer_size = MAX(nwrite, high_buffer_size);
-		while (nwrite > 0) {
-			amount = write(log_fd, &data[pos], nwrite);
-			if ((amount < 0) && (errno != EINTR)) {
-				error("Error writing file %s, %m", new_file);
-				error_code = errno;
-				break;
+		set_buf_offset(buffer, 0);
+		/* write header: version, time */
+		pack16(SLURM_PROTOCOL_VERSION, buffer);
+		pack_time(time(NULL), buffer);
+
+		_free_usage_cache();
+		usage_cache_tres_cnt = g_tres_count;
+		if (assoc_mgr_assoc_list) {
+			ListIterator itr = NULL;
+			slurmdb_assoc_rec_t *assoc = NULL;
+			usage_cache = xmalloc(
+				list_count(assoc_mgr_assoc_list) *
+				sizeof(usage_cache_t));
+			itr = list_iterator_create(assoc_mgr_assoc_list);
+			while ((assoc = list_next(itr))) {
+				if (!assoc->user)
+					continue;
+
+				pack32(assoc->id, buffer);
+				packlongdouble(assoc->usage->usage_raw,
+					       buffer);
+				tmp_char = _make_usage_tres_raw_str(
+					assoc->usage->usage_tres_raw);
+				packstr(tmp_char, buffer);
+				xfree(tmp_char);
+				pack32(assoc->usage->grp_used_wall, buffer);
+				_set_usage_cache(usage_cache_cnt++, assoc);
 			}
-			nwrite -= amount;
-			pos    += amount;
+			list_iterator_destroy(itr);
 		}
-		fsync(log_fd);
-		close(log_fd);
-	}
-	if (error_code)
-		(void) unlink(new_file);
-	else {			/* file shuffle */
-		(void) unlink(old_file);
-		if (link(reg_file, old_file))
-			debug4("unable to create link for %s -> %s: %m",
-			       reg_file, old_file);
-		(void) unlink(reg_file);
-		if (link(new_file, reg_file))
-			debug4("unable to create link for %s -> %s: %m",
-			       new_file, reg_file);
-		(void) unlink(new_file);
+
+		reg_file = xstrdup_printf("%s/assoc_usage",
+					  state_save_location);
+		old_file = xstrdup_printf("%s.old", reg_file);
+		new_file = xstrdup_printf("%s.new", reg_file);
+
+		log_fd = creat(new_file, 0600);
+		if (log_fd < 0) {
+			error("Can't save state, create file %s error %m",
+			      new_file);
+			error_code = errno;
+		} else {
+			int nwrite = get_buf_offset(buffer);
+			high_buffer_size = MAX(nwrite, high_buffer_size);
+			if ((rc = _write_state_data(
+				     log_fd, new_file,
+				     (char *)get_buf_data(buffer), nwrite)))
+				error_code = rc;
+			fsync(log_fd);
+			close(log_fd);
+		}
+		if (error_code)
+			(void) unlink(new_file);
+		else {			/* file shuffle */
+			(void) unlink(old_file);
+			if (link(reg_file, old_file))
+				debug4("unable to create link for %s -> %s: %m",
+				       reg_file, old_file);
+			(void) unlink(reg_file);
+			if (link(new_file, reg_file))
+				debug4("unable to create link for %s -> %s: %m",
+				       new_file, reg_file);
+			(void) unlink(new_file);
+			/* the snapshot subsumes any journal */
+			tmp_char = xstrdup_printf("%s/assoc_usage.journal",
+						  state_save_location);
+			(void) unlink(tmp_char);
+			xfree(tmp_char);
+		}
+		xfree(old_file);
+		xfree(reg_file);
+		xfree(new_file);
 	}
-	xfree(old_file);
-	xfree(reg_file);
-	xfree(new_file);
 
 	free_buf(buffer);
 	/* now make a file for qos_usage */
@@ -5334,6 +5473,118 @@ extern int dump_assoc_mgr_state(char *state_save_location)
 
 }
 
+/* Replay the assoc_usage journal over usage recovered from the last full
+ * snapshot. Journal records carry absolute values, and one association
+ * may appear several times (once per save it was dirty in), so each
+ * record is applied as a delta against the association's current usage
+ * and propagated up the parental chain. A truncated trailing record
+ * (e.g. crash mid append) ends the replay without error.
+ * NOTE: Caller must hold the assoc_mgr locks held by load_assoc_usage() */
+static void _load_assoc_usage_journal(char *state_save_location)
+{
+	int data_allocated, data_read = 0, i;
+	uint32_t data_size = 0;
+	uint16_t ver = 0;
+	int state_fd;
+	char *data = NULL, *state_file;
+	Buf buffer = NULL;
+	time_t buf_time;
+
+	state_file = xstrdup_printf("%s/assoc_usage.journal",
+				    state_save_location);
+	state_fd = open(state_file, O_RDONLY);
+	if (state_fd < 0) {
+		debug2("No assoc_usage journal file (%s) to recover",
+		       state_file);
+		xfree(state_file);
+		return;
+	}
+	data_allocated = BUF_SIZE;
+	data = xmalloc(data_allocated);
+	while (1) {
+		data_read = read(state_fd, &data[data_size], BUF_SIZE);
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Read error on %s: %m", state_file);
+			break;
+		} else if (data_read == 0)	/* eof */
+			break;
+		data_size      += data_read;
+		data_allocated += data_read;
+		xrealloc(data, data_allocated);
+	}
+	close(state_fd);
+
+	buffer = create_buf(data, data_size);
+
+	safe_unpack16(&ver, buffer);
+	debug3("Version in assoc_usage journal header is %u", ver);
+	if (ver > SLURM_PROTOCOL_VERSION) {
+		error("Can not recover assoc_usage journal, "
+		      "incompatible version, got %u need <= %u", ver,
+		      SLURM_PROTOCOL_VERSION);
+		goto unpack_error;
+	}
+
+	safe_unpack_time(&buf_time, buffer);
+
+	while (remaining_buf(buffer) > 0) {
+		uint32_t assoc_id = 0;
+		uint32_t grp_used_wall = 0;
+		long double usage_raw = 0;
+		slurmdb_assoc_rec_t *assoc = NULL;
+		char *tmp_str = NULL;
+		uint32_t tmp32;
+
+		safe_unpack32(&assoc_id, buffer);
+		safe_unpacklongdouble(&usage_raw, buffer);
+		safe_unpackstr_xmalloc(&tmp_str, &tmp32, buffer);
+		safe_unpack32(&grp_used_wall, buffer);
+
+		assoc = _find_assoc_rec_id(assoc_id);
+
+		if (assoc) {
+			long double usage_tres_raw[g_tres_count];
+			long double delta_raw = usage_raw -
+				assoc->usage->usage_raw;
+			double delta_wall = (double) grp_used_wall -
+				assoc->usage->grp_used_wall;
+
+			memset(usage_tres_raw, 0, sizeof(usage_tres_raw));
+			_set_usage_tres_raw(usage_tres_raw, tmp_str);
+			for (i = 0; i < g_tres_count; i++)
+				usage_tres_raw[i] -=
+					assoc->usage->usage_tres_raw[i];
+
+			while (assoc) {
+				assoc->usage->grp_used_wall += delta_wall;
+				assoc->usage->usage_raw += delta_raw;
+				for (i = 0; i < g_tres_count; i++)
+					assoc->usage->usage_tres_raw[i] +=
+						usage_tres_raw[i];
+				assoc = assoc->usage->parent_assoc_ptr;
+			}
+		}
+
+		xfree(tmp_str);
+	}
+
+	xfree(state_file);
+	free_buf(buffer);
+	return;
+
+unpack_error:
+	/* Journal likely truncated by a crash mid append, keep what
+	 * replayed cleanly */
+	debug("Incomplete record at end of assoc_usage journal %s",
+	      state_file);
+	xfree(state_file);
+	if (buffer)
+		free_buf(buffer);
+	return;
+}
+
 extern int load_assoc_usage(char *state_save_location)
 {
 	int data_allocated, data_read = 0, i;
@@ -5441,6 +5692,7 @@ extern int load_assoc_usage(char *state_save_location)
 
 		xfree(tmp_str);
 	}
+	_load_assoc_usage_journal(state_save_location);
 	assoc_mgr_unlock(&locks);
 
 	free_buf(buffer);
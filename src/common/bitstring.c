@@ -96,6 +96,174 @@
 	assert((bit) <= 0x40000000); 	\
 } while (0)
 
+/* words of payload (excluding overhead) covering all bits in a bitstr */
+#define _bitstr_whole_words(name) \
+	((_bitstr_bits(name) + BITSTR_MAXPOS) >> BITSTR_SHIFT)
+
+/*
+ * Vectorized kernels for the word loops in bit_and(), bit_or() and
+ * bit_set_count().  The scheduler (cons_res job_test and backfill) calls
+ * these on every node bitmap for every scheduling pass, so on large
+ * clusters they dominate slurmctld cycles.  CPU support is probed once at
+ * run time and we fall back to the portable word loops on other hardware.
+ *
+ * The kernels need __builtin_cpu_supports() (gcc >= 4.8), the target
+ * function attribute (gcc >= 4.9) and the AVX2 intrinsics, so probe the
+ * gcc version rather than just __GNUC__, which older gcc and other
+ * compilers impersonating gcc also define.  clang is tested through its
+ * feature test macros instead of the gcc version it reports.
+ */
+#ifndef __has_builtin
+#  define __has_builtin(x) 0
+#endif
+#ifndef __has_attribute
+#  define __has_attribute(x) 0
+#endif
+
+#if defined(__x86_64__) && !defined(SLURM_BIGENDIAN) &&			\
+	((defined(__clang__) &&						\
+	  __has_builtin(__builtin_cpu_supports) &&			\
+	  __has_attribute(target)) ||					\
+	 (!defined(__clang__) && defined(__GNUC__) &&			\
+	  ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#define BITSTR_USE_X86_INTRIN 1
+#include <immintrin.h>
+
+static int cpu_has_avx2 = -1;
+static int cpu_has_popcnt = -1;
+
+static inline int _bitstr_use_avx2(void)
+{
+	/* Benign race: all writers store the same value */
+	if (cpu_has_avx2 == -1)
+		cpu_has_avx2 = __builtin_cpu_supports("avx2");
+	return cpu_has_avx2;
+}
+
+static inline int _bitstr_use_popcnt(void)
+{
+	if (cpu_has_popcnt == -1)
+		cpu_has_popcnt = __builtin_cpu_supports("popcnt");
+	return cpu_has_popcnt;
+}
+
+__attribute__((target("avx2")))
+static void _bit_and_avx2(bitstr_t *w1, bitstr_t *w2, int32_t nwords)
+{
+	const int32_t vwords = sizeof(__m256i) / sizeof(bitstr_t);
+	int32_t i = 0;
+
+	for ( ; (i + vwords) <= nwords; i += vwords) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) (w1 + i));
+		__m256i v2 = _mm256_loadu_si256((__m256i *) (w2 + i));
+		_mm256_storeu_si256((__m256i *) (w1 + i),
+				    _mm256_and_si256(v1, v2));
+	}
+	for ( ; i < nwords; i++)
+		w1[i] &= w2[i];
+}
+
+__attribute__((target("avx2")))
+static void _bit_or_avx2(bitstr_t *w1, bitstr_t *w2, int32_t nwords)
+{
+	const int32_t vwords = sizeof(__m256i) / sizeof(bitstr_t);
+	int32_t i = 0;
+
+	for ( ; (i + vwords) <= nwords; i += vwords) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) (w1 + i));
+		__m256i v2 = _mm256_loadu_si256((__m256i *) (w2 + i));
+		_mm256_storeu_si256((__m256i *) (w1 + i),
+				    _mm256_or_si256(v1, v2));
+	}
+	for ( ; i < nwords; i++)
+		w1[i] |= w2[i];
+}
+
+__attribute__((target("popcnt")))
+static int32_t _bit_set_count_popcnt(bitstr_t *words, int32_t nwords)
+{
+	int32_t count = 0, i;
+
+	for (i = 0; i < nwords; i++) {
+#ifdef USE_64BIT_BITSTR
+		count += __builtin_popcountll((uint64_t) words[i]);
+#else
+		count += __builtin_popcount((uint32_t) words[i]);
+#endif
+	}
+	return count;
+}
+
+/* return 1 if every word of w1 is a subset of the matching word of w2 */
+__attribute__((target("avx2")))
+static int _bit_super_set_avx2(bitstr_t *w1, bitstr_t *w2, int32_t nwords)
+{
+	const int32_t vwords = sizeof(__m256i) / sizeof(bitstr_t);
+	int32_t i = 0;
+
+	for ( ; (i + vwords) <= nwords; i += vwords) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) (w1 + i));
+		__m256i v2 = _mm256_loadu_si256((__m256i *) (w2 + i));
+		/* testc is 1 iff (~v2 & v1) == 0, i.e. v1 subset of v2 */
+		if (!_mm256_testc_si256(v2, v1))
+			return 0;
+	}
+	for ( ; i < nwords; i++) {
+		if (w1[i] != (w1[i] & w2[i]))
+			return 0;
+	}
+	return 1;
+}
+
+/* return 1 if all nwords of the two word arrays are identical */
+__attribute__((target("avx2")))
+static int _bit_equal_avx2(bitstr_t *w1, bitstr_t *w2, int32_t nwords)
+{
+	const int32_t vwords = sizeof(__m256i) / sizeof(bitstr_t);
+	int32_t i = 0;
+
+	for ( ; (i + vwords) <= nwords; i += vwords) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) (w1 + i));
+		__m256i v2 = _mm256_loadu_si256((__m256i *) (w2 + i));
+		__m256i vx = _mm256_xor_si256(v1, v2);
+		if (!_mm256_testz_si256(vx, vx))
+			return 0;
+	}
+	for ( ; i < nwords; i++) {
+		if (w1[i] != w2[i])
+			return 0;
+	}
+	return 1;
+}
+
+__attribute__((target("popcnt")))
+static int32_t _bit_overlap_popcnt(bitstr_t *w1, bitstr_t *w2, int32_t nwords)
+{
+	int32_t count = 0, i;
+
+	for (i = 0; i < nwords; i++) {
+#ifdef USE_64BIT_BITSTR
+		count += __builtin_popcountll((uint64_t) (w1[i] & w2[i]));
+#else
+		count += __builtin_popcount((uint32_t) (w1[i] & w2[i]));
+#endif
+	}
+	return count;
+}
+#endif /* BITSTR_USE_X86_INTRIN conditions */
+
+#if defined(__GNUC__) && !defined(SLURM_BIGENDIAN)
+/* position of the least significant set bit in a non-zero word */
+static inline int32_t _bit_ctz(bitstr_t word)
+{
+#ifdef USE_64BIT_BITSTR
+	return __builtin_ctzll((uint64_t) word);
+#else
+	return __builtin_ctz((uint32_t) word);
+#endif
+}
+#endif
+
 /*
  * external macros
  */
@@ -119,6 +287,7 @@ strong_alias(bit_set_all,	slurm_bit_set_all);
 strong_alias(bit_clear_all,	slurm_bit_clear_all);
 strong_alias(bit_ffc,		slurm_bit_ffc);
 strong_alias(bit_ffs,		slurm_bit_ffs);
+strong_alias(bit_ffs_from,	slurm_bit_ffs_from);
 strong_alias(bit_free,		slurm_bit_free);
 strong_alias(bit_realloc,	slurm_bit_realloc);
 strong_alias(bit_size,		slurm_bit_size);
@@ -152,6 +321,11 @@ strong_alias(bit_nffs,		slurm_bit_nffs);
 strong_alias(bit_copybits,	slurm_bit_copybits);
 strong_alias(bit_get_bit_num,	slurm_bit_get_bit_num);
 strong_alias(bit_get_pos_num,	slurm_bit_get_pos_num);
+strong_alias(bit_cow_create,	slurm_bit_cow_create);
+strong_alias(bit_cow_ref,	slurm_bit_cow_ref);
+strong_alias(bit_cow_free,	slurm_bit_cow_free);
+strong_alias(bit_cow_get,	slurm_bit_cow_get);
+strong_alias(bit_cow_modify,	slurm_bit_cow_modify);
 
 /*
  * Allocate a bitstring.
@@ -483,6 +657,25 @@ bit_ffs(bitstr_t *b)
 
 	_assert_bitstr_valid(b);
 
+#if defined(__GNUC__) && !defined(SLURM_BIGENDIAN)
+	{
+		int32_t nwords = _bitstr_whole_words(b);
+		int32_t i;
+
+		for (i = 0; i < nwords; i++) {
+			if (b[i + BITSTR_OVERHEAD] == 0)
+				continue;
+			bit = ((bitoff_t) i * sizeof(bitstr_t) * 8) +
+			      _bit_ctz(b[i + BITSTR_OVERHEAD]);
+			/* bits past _bitstr_bits() in the last word
+			 * may be set (e.g. by bit_not()), ignore them */
+			if (bit < _bitstr_bits(b))
+				value = bit;
+			break;
+		}
+		return value;
+	}
+#endif
 	while (bit < _bitstr_bits(b) && value == -1) {
 		int32_t word = _bit_word(bit);
 
@@ -501,6 +694,71 @@ bit_ffs(bitstr_t *b)
 	return value;
 }
 
+/*
+ * Find first bit set in b at or after position start.
+ *   b (IN)		bitstring to search
+ *   start (IN)		first bit position considered
+ *   RETURN 		resulting bit position (-1 if none found)
+ */
+bitoff_t
+bit_ffs_from(bitstr_t *b, bitoff_t start)
+{
+	bitoff_t bit, value = -1;
+
+	_assert_bitstr_valid(b);
+
+	if (start < 0)
+		start = 0;
+	if (start >= _bitstr_bits(b))
+		return -1;
+
+#if defined(__GNUC__) && !defined(SLURM_BIGENDIAN)
+	{
+		int32_t nwords = _bitstr_whole_words(b);
+		int32_t start_word = start >> BITSTR_SHIFT;
+		int32_t i;
+		bitstr_t word;
+
+		for (i = start_word; i < nwords; i++) {
+			word = b[i + BITSTR_OVERHEAD];
+			if (i == start_word) {
+				/* ignore bits before start */
+				word &= (~((bitstr_t) 0)) <<
+					(start & BITSTR_MAXPOS);
+			}
+			if (word == 0)
+				continue;
+			bit = ((bitoff_t) i * sizeof(bitstr_t) * 8) +
+			      _bit_ctz(word);
+			/* bits past _bitstr_bits() in the last word
+			 * may be set (e.g. by bit_not()), ignore them */
+			if (bit < _bitstr_bits(b))
+				value = bit;
+			break;
+		}
+		return value;
+	}
+#endif
+	bit = start;
+	while (bit < _bitstr_bits(b) && value == -1) {
+		int32_t word = _bit_word(bit);
+
+		if (b[word] == 0) {
+			/* advance to the start of the next word */
+			bit = ((bit >> BITSTR_SHIFT) + 1) << BITSTR_SHIFT;
+			continue;
+		}
+		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
+			if (bit_test(b, bit)) {
+				value = bit;
+				break;
+			}
+			bit++;
+		}
+	}
+	return value;
+}
+
 /*
  * Find last bit set in b.
  *   b (IN)		bitstring to search
@@ -577,6 +835,13 @@ bit_super_set(bitstr_t *b1, bitstr_t *b2)
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_avx2()) {
+		return _bit_super_set_avx2(b1 + BITSTR_OVERHEAD,
+					   b2 + BITSTR_OVERHEAD,
+					   _bitstr_whole_words(b1));
+	}
+#endif
 	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
 		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
 		                           b2[_bit_word(bit)]))
@@ -600,6 +865,13 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 	if (_bitstr_bits(b1) != _bitstr_bits(b2))
 		return 0;
 
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_avx2()) {
+		return _bit_equal_avx2(b1 + BITSTR_OVERHEAD,
+				       b2 + BITSTR_OVERHEAD,
+				       _bitstr_whole_words(b1));
+	}
+#endif
 	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
 		if (b1[_bit_word(bit)] != b2[_bit_word(bit)])
 			return 0;
@@ -624,6 +896,13 @@ bit_and(bitstr_t *b1, bitstr_t *b2)
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_avx2()) {
+		_bit_and_avx2(b1 + BITSTR_OVERHEAD, b2 + BITSTR_OVERHEAD,
+			      _bitstr_whole_words(b1));
+		return;
+	}
+#endif
 	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
 		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
 }
@@ -657,6 +936,13 @@ bit_or(bitstr_t *b1, bitstr_t *b2)
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_avx2()) {
+		_bit_or_avx2(b1 + BITSTR_OVERHEAD, b2 + BITSTR_OVERHEAD,
+			     _bitstr_whole_words(b1));
+		return;
+	}
+#endif
 	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
 		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
 }
@@ -677,6 +963,12 @@ bit_copy(bitstr_t *b)
 
 	newsize_bits  = bit_size(b);
 	len = (_bitstr_words(newsize_bits) - BITSTR_OVERHEAD)*sizeof(bitstr_t);
+	/* bit_alloc() returns cleared memory, so trailing zero words (common
+	 * with sparse allocation bitmaps on large systems) need not be
+	 * copied at all */
+	while ((len >= sizeof(bitstr_t)) &&
+	       (b[BITSTR_OVERHEAD + (len / sizeof(bitstr_t)) - 1] == 0))
+		len -= sizeof(bitstr_t);
 	new = bit_alloc(newsize_bits);
 	if (new)
 		memcpy(&new[BITSTR_OVERHEAD], &b[BITSTR_OVERHEAD], len);
@@ -750,6 +1042,18 @@ bit_set_count(bitstr_t *b)
 	_assert_bitstr_valid(b);
 
 	bit_cnt = _bitstr_bits(b);
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_popcnt()) {
+		int32_t nwords = bit_cnt >> BITSTR_SHIFT;
+		count = _bit_set_count_popcnt(b + BITSTR_OVERHEAD, nwords);
+		bit = (bitoff_t) nwords * word_size;
+		for ( ; bit < bit_cnt; bit++) {
+			if (bit_test(b, bit))
+				count++;
+		}
+		return count;
+	}
+#endif
 	for (bit = 0; (bit + word_size) <= bit_cnt; bit += word_size) {
 		count += hweight(b[_bit_word(bit)]);
 	}
@@ -809,6 +1113,19 @@ bit_overlap(bitstr_t *b1, bitstr_t *b2)
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
 	bit_cnt = _bitstr_bits(b1);
+#ifdef BITSTR_USE_X86_INTRIN
+	if (_bitstr_use_popcnt()) {
+		int32_t nwords = bit_cnt >> BITSTR_SHIFT;
+		count = _bit_overlap_popcnt(b1 + BITSTR_OVERHEAD,
+					    b2 + BITSTR_OVERHEAD, nwords);
+		bit = (bitoff_t) nwords * word_size;
+		for ( ; bit < bit_cnt; bit++) {
+			if (bit_test(b1, bit) && bit_test(b2, bit))
+				count++;
+		}
+		return count;
+	}
+#endif
 	for (bit = 0; bit < bit_cnt; bit += word_size) {
 		if ((bit + word_size - 1) >= bit_cnt)
 			break;
@@ -1249,6 +1566,84 @@ char * bit_fmt_hexmask(bitstr_t * bitmap)
 	return retstr;
 }
 
+#ifdef SLURM_BIGENDIAN
+/* Reverse the bit order within one byte of a raw bitmap image.  The
+ * canonical image keeps bit (8 * i + j) in bit [j] of byte [i], which
+ * is the in-memory layout of little-endian builds; _bit_mask() places
+ * bits MSB first on big-endian builds, so each byte must be reversed
+ * on export and import to keep the image portable across hosts. */
+static inline uint8_t _bit_rev_byte(uint8_t byte)
+{
+	byte = ((byte & 0xf0) >> 4) | ((byte & 0x0f) << 4);
+	byte = ((byte & 0xcc) >> 2) | ((byte & 0x33) << 2);
+	byte = ((byte & 0xaa) >> 1) | ((byte & 0x55) << 1);
+	return byte;
+}
+#endif
+
+/* bit_fmt_raw
+ *
+ * Return the byte image of the bitmap's payload in an xmalloc'd
+ * buffer, for state save files and other dense encodings where the
+ * ASCII range and hex mask formats are too slow to generate.  The image
+ * uses a fixed, endian independent bit order (bit (8 * i + j) in bit
+ * [j] of byte [i]), so it can be exchanged between hosts of different
+ * endianness; see _bit_rev_byte() above.
+ *   b (IN)	   bitmap to export
+ *   len_ptr (OUT) image length in bytes
+ *   RET: xmalloc'd byte image, caller must xfree
+ */
+char *bit_fmt_raw(bitstr_t *b, uint32_t *len_ptr)
+{
+	char *retbuf;
+	uint32_t nbytes;
+#ifdef SLURM_BIGENDIAN
+	uint32_t i;
+#endif
+
+	_assert_bitstr_valid(b);
+	nbytes = (_bitstr_bits(b) + 7) / 8;
+	retbuf = xmalloc(nbytes);
+	memcpy(retbuf, (char *) (b + BITSTR_OVERHEAD), nbytes);
+#ifdef SLURM_BIGENDIAN
+	for (i = 0; i < nbytes; i++)
+		retbuf[i] = (char) _bit_rev_byte((uint8_t) retbuf[i]);
+#endif
+	*len_ptr = nbytes;
+	return retbuf;
+}
+
+/* bit_unfmt_raw
+ *
+ * Restore a bitmap from a byte image built by bit_fmt_raw().  The
+ * bitmap must already be allocated with the same bit count the image
+ * was exported with.
+ *   b (OUT)	bitmap to update
+ *   data (IN)	byte image to import
+ *   len (IN)	image length in bytes
+ *   RET: 0 on success, -1 on length mismatch
+ */
+int bit_unfmt_raw(bitstr_t *b, const char *data, uint32_t len)
+{
+	uint32_t nbytes;
+#ifdef SLURM_BIGENDIAN
+	uint32_t i;
+	char *payload;
+#endif
+
+	_assert_bitstr_valid(b);
+	nbytes = (_bitstr_bits(b) + 7) / 8;
+	if (len != nbytes)
+		return -1;
+	memcpy((char *) (b + BITSTR_OVERHEAD), data, nbytes);
+#ifdef SLURM_BIGENDIAN
+	payload = (char *) (b + BITSTR_OVERHEAD);
+	for (i = 0; i < nbytes; i++)
+		payload[i] = (char) _bit_rev_byte((uint8_t) payload[i]);
+#endif
+	return 0;
+}
+
 /* bit_unfmt_hexmask
  *
  * Given a hex mask string "0x0123ABC\0", convert to a bitstr_t *
@@ -1429,3 +1824,89 @@ bit_get_pos_num(bitstr_t *b, bitoff_t pos)
 	return cnt;
 }
 
+
+/*
+ * Create a copy-on-write reference to bitstring b, taking ownership of it.
+ *   b (IN)		bitstring to manage, caller must not use it directly
+ *   RET		new reference with a count of one
+ */
+bit_cow_t *bit_cow_create(bitstr_t *b)
+{
+	bit_cow_t *cow;
+
+	_assert_bitstr_valid(b);
+	cow = xmalloc(sizeof(bit_cow_t));
+	cow->ref_cnt = 1;
+	cow->bits = b;
+
+	return cow;
+}
+
+/*
+ * Take another reference to a shared bitstring, an O(1) logical copy.
+ *   cow (IN)		existing reference
+ *   RET		the same reference with its count incremented
+ */
+bit_cow_t *bit_cow_ref(bit_cow_t *cow)
+{
+	assert(cow != NULL);
+	assert(cow->ref_cnt > 0);
+	cow->ref_cnt++;
+
+	return cow;
+}
+
+/*
+ * Release a reference, freeing the bitstring when the last one is dropped.
+ *   cow_pptr (IN/OUT)	reference to release, set to NULL
+ */
+void bit_cow_free(bit_cow_t **cow_pptr)
+{
+	bit_cow_t *cow;
+
+	assert(cow_pptr != NULL);
+	if ((cow = *cow_pptr)) {
+		assert(cow->ref_cnt > 0);
+		if (--cow->ref_cnt == 0) {
+			FREE_NULL_BITMAP(cow->bits);
+			xfree(cow);
+		}
+		*cow_pptr = NULL;
+	}
+}
+
+/*
+ * Return the shared bitstring for read-only use.
+ *   cow (IN)		reference to read
+ *   RET		bitstring, which the caller must not modify
+ */
+bitstr_t *bit_cow_get(bit_cow_t *cow)
+{
+	assert(cow != NULL);
+	assert(cow->ref_cnt > 0);
+
+	return cow->bits;
+}
+
+/*
+ * Return a bitstring the caller may modify, duplicating the shared one
+ * first if any other holder still references it (clone-on-modify).
+ *   cow_pptr (IN/OUT)	reference, repointed to a private copy as needed
+ *   RET		writable bitstring owned solely by this reference
+ */
+bitstr_t *bit_cow_modify(bit_cow_t **cow_pptr)
+{
+	bit_cow_t *cow;
+
+	assert(cow_pptr != NULL);
+	cow = *cow_pptr;
+	assert(cow != NULL);
+	assert(cow->ref_cnt > 0);
+	if (cow->ref_cnt == 1)
+		return cow->bits;
+
+	cow->ref_cnt--;
+	*cow_pptr = bit_cow_create(bit_copy(cow->bits));
+
+	return (*cow_pptr)->bits;
+}
@@ -105,6 +105,7 @@ void bit_clear_all(bitstr_t *b);
 /* changed interface from Vixie macros */
 bitoff_t bit_ffc(bitstr_t *b);
 bitoff_t bit_ffs(bitstr_t *b);
+bitoff_t bit_ffs_from(bitstr_t *b, bitoff_t start);
 
 /* new */
 bitoff_t bit_nffs(bitstr_t *b, int32_t n);
@@ -130,6 +131,8 @@ char *  inx2bitfmt (int32_t *inx);
 int     inx2bitstr(bitstr_t *b, int32_t *inx);
 char	*bit_fmt_hexmask(bitstr_t *b);
 int 	bit_unfmt_hexmask(bitstr_t *b, const char *str);
+char	*bit_fmt_raw(bitstr_t *b, uint32_t *len_ptr);
+int 	bit_unfmt_raw(bitstr_t *b, const char *data, uint32_t len);
 char	*bit_fmt_binmask(bitstr_t *b);
 void 	bit_unfmt_binmask(bitstr_t *b, const char *str);
 bitoff_t bit_fls(bitstr_t *b);
@@ -143,6 +146,21 @@ bitstr_t *bit_pick_cnt(bitstr_t *b, bitoff_t nbits);
 bitoff_t bit_get_bit_num(bitstr_t *b, int32_t pos);
 int32_t	bit_get_pos_num(bitstr_t *b, bitoff_t pos);
 
+/* Copy-on-write bitstring references. A bit_cow_t shares one underlying
+ * bitstring among any number of holders. Taking another reference is O(1)
+ * and the string is only duplicated when some holder modifies it through
+ * bit_cow_modify(). Not thread safe, like the rest of this module. */
+typedef struct bit_cow {
+	uint32_t  ref_cnt;
+	bitstr_t *bits;
+} bit_cow_t;
+
+bit_cow_t *bit_cow_create(bitstr_t *b);
+bit_cow_t *bit_cow_ref(bit_cow_t *cow);
+void	bit_cow_free(bit_cow_t **cow_pptr);
+bitstr_t *bit_cow_get(bit_cow_t *cow);
+bitstr_t *bit_cow_modify(bit_cow_t **cow_pptr);
+
 #define FREE_NULL_BITMAP(_X)		\
 	do {				\
 		if (_X) bit_free (_X);	\
@@ -85,6 +85,12 @@ static struct cpu_freq_data {
 	uint32_t new_min_freq;
 	uint32_t org_max_freq;
 	uint32_t new_max_freq;
+	/* Cached copy of the last values read from or written to sysfs,
+	 * used to skip writes which would not change anything */
+	char     cur_governor[GOV_NAME_LEN];
+	uint32_t cur_frequency;
+	uint32_t cur_min_freq;
+	uint32_t cur_max_freq;
 } * cpufreq = NULL;
 static char *slurmd_spooldir = NULL;
 
@@ -653,31 +659,32 @@ _cpu_freq_get_cur_gov(int cpuidx)
 
 /*
  * set cpu governor
+ * -- the write is skipped when the cached current value already matches --
+ * -- the caller is expected to hold the CPU owner lock --
  */
 static int
-_cpu_freq_set_gov(stepd_step_rec_t *job, int cpuidx, char* gov )
+_cpu_freq_set_gov(int cpuidx, char* gov )
 {
 	char path[PATH_MAX];
 	FILE *fp;
-	int fd, rc;
 
-	rc = SLURM_SUCCESS;
+	if (xstrcmp(cpufreq[cpuidx].cur_governor, gov) == 0) {
+		debug2("%s: cpu=%d governor already %s, write skipped",
+		       __func__, cpuidx, gov);
+		return SLURM_SUCCESS;
+	}
 	snprintf(path, sizeof(path), PATH_TO_CPU
 		 "cpu%u/cpufreq/scaling_governor", cpuidx);
-	fd = _set_cpu_owner_lock(cpuidx, job->jobid);
 	if ((fp = fopen(path, "w"))) {
 		fputs(gov, fp);
 		fputc('\n', fp);
 		fclose(fp);
 	} else {
 		error("%s: Can not set CPU governor: %m", __func__);
-		rc = SLURM_FAILURE;
-	}
-	if (fd >= 0) {
-		(void) fd_release_lock(fd);
-		(void) close(fd);
+		return SLURM_FAILURE;
 	}
-	return rc;
+	strcpy(cpufreq[cpuidx].cur_governor, gov);
+	return SLURM_SUCCESS;
 }
 
 /*
@@ -710,32 +717,39 @@ _cpu_freq_get_scaling_freq(int cpuidx, char* option)
 /*
  * set one of scalling_min_freq, scaling_max_freq, scaling_setspeed
  * -- assume governor already set to userspace ---
- *
+ * -- the write is skipped when the cached current value already matches --
+ * -- the caller is expected to hold the CPU owner lock --
  */
 static int
-_cpu_freq_set_scaling_freq(stepd_step_rec_t *job, int cpx, uint32_t freq,
-		char* option)
+_cpu_freq_set_scaling_freq(int cpx, uint32_t freq, char* option)
 {
 	char path[PATH_MAX];
 	FILE *fp;
-	int fd, rc;
 	uint32_t newfreq;
-
-	rc = SLURM_SUCCESS;
+	uint32_t *cur = NULL;
+
+	if (xstrcmp(option, "scaling_setspeed") == 0)
+		cur = &cpufreq[cpx].cur_frequency;
+	else if (xstrcmp(option, "scaling_min_freq") == 0)
+		cur = &cpufreq[cpx].cur_min_freq;
+	else if (xstrcmp(option, "scaling_max_freq") == 0)
+		cur = &cpufreq[cpx].cur_max_freq;
+	if (cur && (*cur == freq)) {
+		debug2("%s: cpu=%d %s already %u, write skipped",
+		       __func__, cpx, option, freq);
+		return SLURM_SUCCESS;
+	}
 	snprintf(path, sizeof(path), PATH_TO_CPU
 		 "cpu%u/cpufreq/%s", cpx, option);
-	fd = _set_cpu_owner_lock(cpx, job->jobid);
 	if ((fp = fopen(path, "w"))) {
 		fprintf(fp, "%u\n", freq);
 		fclose(fp);
 	} else {
 		error("%s: Can not set %s: %m", __func__, option);
-		rc = SLURM_FAILURE;
-	}
-	if (fd >= 0) {
-		(void) fd_release_lock(fd);
-		(void) close(fd);
+		return SLURM_FAILURE;
 	}
+	if (cur)
+		*cur = freq;
 	if (debug_flags & DEBUG_FLAG_CPU_FREQ) {
 		newfreq = _cpu_freq_get_scaling_freq(cpx, option);
 		if (newfreq != freq) {
@@ -743,8 +757,7 @@ _cpu_freq_set_scaling_freq(stepd_step_rec_t *job, int cpx, uint32_t freq,
 			      option, freq, newfreq);
 		}
 	}
-	return rc;
-
+	return SLURM_SUCCESS;
 }
 
 /*
@@ -782,16 +795,21 @@ _cpu_freq_current_state(int cpuidx)
 	if (freq == 0)
 		return SLURM_FAILURE;
 	cpufreq[cpuidx].org_frequency = freq;
+	cpufreq[cpuidx].cur_frequency = freq;
 	freq = _cpu_freq_get_scaling_freq(cpuidx, "scaling_min_freq");
 	if (freq == 0)
 		return SLURM_FAILURE;
 	cpufreq[cpuidx].org_min_freq = freq;
+	cpufreq[cpuidx].cur_min_freq = freq;
 	freq = _cpu_freq_get_scaling_freq(cpuidx, "scaling_max_freq");
 	if (freq == 0)
 		return SLURM_FAILURE;
 	cpufreq[cpuidx].org_max_freq = freq;
+	cpufreq[cpuidx].cur_max_freq = freq;
 
 	if (_cpu_freq_get_cur_gov(cpuidx) == SLURM_SUCCESS) {
+		strcpy(cpufreq[cpuidx].cur_governor,
+		       cpufreq[cpuidx].org_governor);
 		cpufreq[cpuidx].org_set = true;
 		return SLURM_SUCCESS;
 	} else {
@@ -905,6 +923,10 @@ _cpu_freq_init_data(int cpx)
 	cpufreq[cpx].new_min_freq = NO_VAL;
 	cpufreq[cpx].org_max_freq = NO_VAL;
 	cpufreq[cpx].new_max_freq = NO_VAL;
+	cpufreq[cpx].cur_governor[0] = '\0';
+	cpufreq[cpx].cur_frequency = NO_VAL;
+	cpufreq[cpx].cur_min_freq = NO_VAL;
+	cpufreq[cpx].cur_max_freq = NO_VAL;
 	cpufreq[cpx].org_set = false;
 }
 /*
@@ -1034,15 +1056,114 @@ _cpu_freq_check_freq(const char* arg)
 	return 0;
 }
 
+/*
+ * Apply the precomputed frequency/governor plan to one cpu.  The
+ * caller holds the CPU owner lock, so the individual sysfs writes
+ * do not take it themselves.
+ *
+ * RET SLURM_FAILURE when the governor can not be changed at all (in
+ *     which case the caller gives up on the remaining CPUs as well),
+ *     SLURM_SUCCESS otherwise, even if some write on this cpu failed.
+ */
+static int
+_cpu_freq_set_cpu(int i)
+{
+	char freq_detail[100];
+	uint32_t freq;
+	int rc;
+
+	/* Max must be set before min, per
+	 * www.kernel.org/doc/Documentation/cpu-freq/user-guide.txt
+	 */
+	if (cpufreq[i].new_max_freq != NO_VAL ) {
+		freq = cpufreq[i].new_max_freq;
+		if (cpufreq[i].org_frequency > freq) {
+			/* The current frequency is > requested max,
+			 * Set it so it is in range
+			 * have to go to UserSpace to do it. */
+			rc = _cpu_freq_set_gov(i, "userspace");
+			if (rc == SLURM_FAILURE)
+				return SLURM_FAILURE;
+			rc = _cpu_freq_set_scaling_freq(i, freq,
+					         "scaling_setspeed");
+			if (rc == SLURM_FAILURE)
+				return SLURM_SUCCESS;
+			if (cpufreq[i].new_governor[0] == '\0') {
+				/* Not requesting new gov, so restore */
+				rc = _cpu_freq_set_gov(i,
+					cpufreq[i].org_governor);
+				if (rc == SLURM_FAILURE)
+					return SLURM_SUCCESS;
+			}
+		}
+		rc = _cpu_freq_set_scaling_freq(i, freq, "scaling_max_freq");
+		if (rc == SLURM_FAILURE)
+			return SLURM_SUCCESS;
+	}
+	if (cpufreq[i].new_min_freq != NO_VAL) {
+		freq = cpufreq[i].new_min_freq;
+		if (cpufreq[i].org_frequency < freq) {
+			/* The current frequency is < requested min,
+			 * Set it so it is in range
+			 * have to go to UserSpace to do it. */
+			rc = _cpu_freq_set_gov(i, "userspace");
+			if (rc == SLURM_FAILURE)
+				return SLURM_SUCCESS;
+			rc = _cpu_freq_set_scaling_freq(i, freq,
+					         "scaling_setspeed");
+			if (rc == SLURM_FAILURE)
+				return SLURM_SUCCESS;
+			if (cpufreq[i].new_governor[0] == '\0') {
+				/* Not requesting new gov, so restore */
+				rc= _cpu_freq_set_gov(i,
+					cpufreq[i].org_governor);
+				if (rc == SLURM_FAILURE)
+					return SLURM_SUCCESS;
+			}
+		}
+		rc= _cpu_freq_set_scaling_freq(i, freq, "scaling_min_freq");
+		if (rc == SLURM_FAILURE)
+			return SLURM_SUCCESS;
+	}
+	if (cpufreq[i].new_frequency != NO_VAL) {
+		rc = _cpu_freq_set_gov(i, "userspace");
+		if (rc == SLURM_FAILURE)
+			return SLURM_SUCCESS;
+		rc = _cpu_freq_set_scaling_freq(i,
+				cpufreq[i].new_frequency,
+				"scaling_setspeed");
+		if (rc == SLURM_FAILURE)
+			return SLURM_SUCCESS;
+	}
+	if (cpufreq[i].new_governor[0] != '\0') {
+		rc = _cpu_freq_set_gov(i, cpufreq[i].new_governor);
+		if (rc == SLURM_FAILURE)
+			return SLURM_SUCCESS;
+	}
+	if (debug_flags & DEBUG_FLAG_CPU_FREQ) {
+		cpu_freq_debug(NULL, NULL,
+				freq_detail, sizeof(freq_detail),
+				NO_VAL, cpufreq[i].new_min_freq,
+				cpufreq[i].new_max_freq,
+				cpufreq[i].new_frequency);
+		if (cpufreq[i].new_governor[0] != '\0') {
+			info("cpu_freq: set cpu=%d %s Governor=%s",
+			     i, freq_detail, cpufreq[i].new_governor);
+		} else {
+			info("cpu_freq: reset cpu=%d %s", i,
+			     freq_detail);
+		}
+	}
+	return SLURM_SUCCESS;
+}
+
 /*
  * set cpu frequency if possible for each cpu of the job step
  */
 extern void
 cpu_freq_set(stepd_step_rec_t *job)
 {
-	char freq_detail[100];
-	uint32_t freq;
-	int i, rc;
+	int i, fd, rc;
 
 	if ((!cpu_freq_count) || (!cpufreq))
 		return;
@@ -1062,91 +1183,99 @@ cpu_freq_set(stepd_step_rec_t *job)
 			     cpufreq[i].org_governor);
 		}
 
-		/* Max must be set before min, per
-		 * www.kernel.org/doc/Documentation/cpu-freq/user-guide.txt
-		 */
-		if (cpufreq[i].new_max_freq != NO_VAL ) {
-			freq = cpufreq[i].new_max_freq;
-			if (cpufreq[i].org_frequency > freq) {
-				/* The current frequency is > requested max,
-				 * Set it so it is in range
-				 * have to go to UserSpace to do it. */
-				rc = _cpu_freq_set_gov(job, i, "userspace");
-				if (rc == SLURM_FAILURE)
-					return;
-				rc = _cpu_freq_set_scaling_freq(job, i, freq,
-						         "scaling_setspeed");
-				if (rc == SLURM_FAILURE)
-					continue;
-				if (cpufreq[i].new_governor[0] == '\0') {
-					/* Not requesting new gov, so restore */
-					rc = _cpu_freq_set_gov(job, i,
-						cpufreq[i].org_governor);
-					if (rc == SLURM_FAILURE)
-						continue;
-				}
-			}
-			rc = _cpu_freq_set_scaling_freq(job, i, freq,
-							"scaling_max_freq");
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-		if (cpufreq[i].new_min_freq != NO_VAL) {
-			freq = cpufreq[i].new_min_freq;
-			if (cpufreq[i].org_frequency < freq) {
-				/* The current frequency is < requested min,
-				 * Set it so it is in range
-				 * have to go to UserSpace to do it. */
-				rc = _cpu_freq_set_gov(job, i, "userspace");
-				if (rc == SLURM_FAILURE)
-					continue;
-				rc = _cpu_freq_set_scaling_freq(job, i, freq,
-						         "scaling_setspeed");
-				if (rc == SLURM_FAILURE)
-					continue;
-				if (cpufreq[i].new_governor[0] == '\0') {
-					/* Not requesting new gov, so restore */
-					rc= _cpu_freq_set_gov(job, i,
-						cpufreq[i].org_governor);
-					if (rc == SLURM_FAILURE)
-						continue;
-				}
-			}
-			rc= _cpu_freq_set_scaling_freq(job, i, freq,
-						       "scaling_min_freq");
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-		if (cpufreq[i].new_frequency != NO_VAL) {
-			if (xstrcmp(cpufreq[i].org_governor,"userspace")) {
-				rc = _cpu_freq_set_gov(job, i, "userspace");
-				if (rc == SLURM_FAILURE)
-					continue;
-			}
-			rc = _cpu_freq_set_scaling_freq(job, i,
-					cpufreq[i].new_frequency,
-					"scaling_setspeed");
-			if (rc == SLURM_FAILURE)
-				continue;
+		/* Take the CPU owner lock once per CPU, covering every
+		 * sysfs write planned for it, rather than once per
+		 * file written. */
+		fd = _set_cpu_owner_lock(i, job->jobid);
+		rc = _cpu_freq_set_cpu(i);
+		if (fd >= 0) {
+			(void) fd_release_lock(fd);
+			(void) close(fd);
 		}
+		if (rc == SLURM_FAILURE)
+			return;
+	}
+}
+
+/*
+ * Test whether any value changed for this step still differs from its
+ * original setting, based on the cached copy of the sysfs state.  When
+ * nothing differs (the writes were all skipped, or a requested value
+ * matched the original one) the reset can be skipped entirely.
+ */
+static bool
+_cpu_freq_reset_needed(int i)
+{
+	if ((cpufreq[i].new_frequency != NO_VAL) &&
+	    (cpufreq[i].cur_frequency != cpufreq[i].org_frequency))
+		return true;
+	if ((cpufreq[i].new_min_freq != NO_VAL) &&
+	    (cpufreq[i].cur_min_freq != cpufreq[i].org_min_freq))
+		return true;
+	if ((cpufreq[i].new_max_freq != NO_VAL) &&
+	    (cpufreq[i].cur_max_freq != cpufreq[i].org_max_freq))
+		return true;
+	if (xstrcmp(cpufreq[i].cur_governor, cpufreq[i].org_governor))
+		return true;
+	return false;
+}
+
+/*
+ * Restore the original frequency/governor values on one cpu.  The
+ * caller holds the CPU owner lock.
+ */
+static void
+_cpu_freq_reset_cpu(int i)
+{
+	char freq_detail[100];
+	int rc;
+
+	if (cpufreq[i].new_frequency != NO_VAL) {
+		rc = _cpu_freq_set_gov(i, "userspace");
+		if (rc == SLURM_FAILURE)
+			return;
+		rc = _cpu_freq_set_scaling_freq(i,
+				cpufreq[i].org_frequency,
+				"scaling_setspeed");
+		if (rc == SLURM_FAILURE)
+			return;
+		cpufreq[i].new_governor[0] = 'u'; /* force gov reset */
+	}
+	/* Max must be set before min, per
+	 * www.kernel.org/doc/Documentation/cpu-freq/user-guide.txt
+	 */
+	if (cpufreq[i].new_max_freq != NO_VAL) {
+		rc = _cpu_freq_set_scaling_freq(i,
+				cpufreq[i].org_max_freq,
+				"scaling_max_freq");
+		if (rc == SLURM_FAILURE)
+			return;
+	}
+	if (cpufreq[i].new_min_freq != NO_VAL) {
+		rc = _cpu_freq_set_scaling_freq(i,
+				cpufreq[i].org_min_freq,
+				"scaling_min_freq");
+		if (rc == SLURM_FAILURE)
+			return;
+	}
+	if (cpufreq[i].new_governor[0] != '\0') {
+		rc = _cpu_freq_set_gov(i, cpufreq[i].org_governor);
+		if (rc == SLURM_FAILURE)
+			return;
+	}
+
+	if (debug_flags & DEBUG_FLAG_CPU_FREQ) {
+		cpu_freq_debug(NULL, NULL,
+				freq_detail, sizeof(freq_detail),
+				NO_VAL, cpufreq[i].org_min_freq,
+				cpufreq[i].org_max_freq,
+				cpufreq[i].org_frequency);
 		if (cpufreq[i].new_governor[0] != '\0') {
-			rc = _cpu_freq_set_gov(job, i, cpufreq[i].new_governor);
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-		if (debug_flags & DEBUG_FLAG_CPU_FREQ) {
-			cpu_freq_debug(NULL, NULL,
-					freq_detail, sizeof(freq_detail),
-					NO_VAL, cpufreq[i].new_min_freq,
-					cpufreq[i].new_max_freq,
-					cpufreq[i].new_frequency);
-			if (cpufreq[i].new_governor[0] != '\0') {
-				info("cpu_freq: set cpu=%d %s Governor=%s",
-				     i, freq_detail, cpufreq[i].new_governor);
-			} else {
-				info("cpu_freq: reset cpu=%d %s", i,
-				     freq_detail);
-			}
+			info("cpu_freq: reset cpu=%d %s Governor=%s",
+			     i, freq_detail, cpufreq[i].org_governor);
+		} else {
+			info("cpu_freq: reset cpu=%d %s", i,
+			     freq_detail);
 		}
 	}
 }
@@ -1158,8 +1287,7 @@ cpu_freq_set(stepd_step_rec_t *job)
 extern void
 cpu_freq_reset(stepd_step_rec_t *job)
 {
-	int i, rc, fd;
-	char freq_detail[100];
+	int i, fd;
 
 	if ((!cpu_freq_count) || (!cpufreq))
 		return;
@@ -1171,57 +1299,21 @@ cpu_freq_reset(stepd_step_rec_t *job)
 		    && cpufreq[i].new_governor[0] == '\0')
 			continue; /* Nothing to reset on this CPU */
 
+		if (!_cpu_freq_reset_needed(i)) {
+			debug2("%s: cpu=%d already at original values, "
+			       "reset skipped", __func__, i);
+			continue;
+		}
+
 		fd = _test_cpu_owner_lock(i, job->jobid);
 		if (fd < 0)
 			continue;
 
-		if (cpufreq[i].new_frequency != NO_VAL) {
-			rc = _cpu_freq_set_gov(job, i, "userspace");
-			if (rc == SLURM_FAILURE)
-				continue;
-			rc = _cpu_freq_set_scaling_freq(job, i,
-					cpufreq[i].org_frequency,
-					"scaling_setspeed");
-			if (rc == SLURM_FAILURE)
-				continue;
-			cpufreq[i].new_governor[0] = 'u'; /* force gov reset */
-		}
-		/* Max must be set before min, per
-		 * www.kernel.org/doc/Documentation/cpu-freq/user-guide.txt
-		 */
-		if (cpufreq[i].new_max_freq != NO_VAL) {
-			rc = _cpu_freq_set_scaling_freq(job, i,
-					cpufreq[i].org_max_freq,
-					"scaling_max_freq");
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-		if (cpufreq[i].new_min_freq != NO_VAL) {
-			rc = _cpu_freq_set_scaling_freq(job, i,
-					cpufreq[i].org_min_freq,
-					"scaling_min_freq");
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-		if (cpufreq[i].new_governor[0] != '\0') {
-			rc = _cpu_freq_set_gov(job, i, cpufreq[i].org_governor);
-			if (rc == SLURM_FAILURE)
-				continue;
-		}
-
-		if (debug_flags & DEBUG_FLAG_CPU_FREQ) {
-			cpu_freq_debug(NULL, NULL,
-					freq_detail, sizeof(freq_detail),
-					NO_VAL, cpufreq[i].org_min_freq,
-					cpufreq[i].org_max_freq,
-					cpufreq[i].org_frequency);
-			if (cpufreq[i].new_governor[0] != '\0') {
-				info("cpu_freq: reset cpu=%d %s Governor=%s",
-				     i, freq_detail, cpufreq[i].org_governor);
-			} else {
-				info("cpu_freq: reset cpu=%d %s", i,
-				     freq_detail);
-			}
+		fd = _set_cpu_owner_lock(i, job->jobid);
+		_cpu_freq_reset_cpu(i);
+		if (fd >= 0) {
+			(void) fd_release_lock(fd);
+			(void) close(fd);
 		}
 	}
 }
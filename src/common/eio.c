@@ -40,6 +40,10 @@
 
 #include <errno.h>
 #include <poll.h>
+#if defined(__linux__)
+#  include <sys/epoll.h>
+#  define EIO_USE_EPOLL 1
+#endif
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -86,6 +90,11 @@ struct eio_handle_components {
 	uint16_t shutdown_wait;
 	List obj_list;
 	List new_objs;
+#ifdef EIO_USE_EPOLL
+	int epfd;			/* epoll instance, -1 to use poll() */
+	struct epoll_event *ep_events;	/* epoll_wait() output array */
+	unsigned int ep_events_size;	/* allocated entries in ep_events */
+#endif
 };
 
 
@@ -99,6 +108,12 @@ static void         _poll_dispatch(struct pollfd *, unsigned int, eio_obj_t **,
 		                   List objList);
 static void         _poll_handle_event(short revents, eio_obj_t *obj,
 		                       List objList);
+static int          _poll_mainloop(eio_handle_t *eio);
+static bool         _is_readable(eio_obj_t *obj);
+static bool         _is_writable(eio_obj_t *obj);
+#ifdef EIO_USE_EPOLL
+static int          _epoll_mainloop(eio_handle_t *eio);
+#endif
 
 
 eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
@@ -125,6 +140,13 @@ eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
 	if (shutdown_wait > 0)
 		eio->shutdown_wait = shutdown_wait;
 
+#ifdef EIO_USE_EPOLL
+	if ((eio->epfd = epoll_create(16)) < 0)
+		debug("eio_create: epoll_create: %m, using poll");
+	else
+		fd_set_close_on_exec(eio->epfd);
+#endif
+
 	return eio;
 }
 
@@ -136,6 +158,11 @@ void eio_handle_destroy(eio_handle_t *eio)
 	close(eio->fds[1]);
 	FREE_NULL_LIST(eio->obj_list);
 	FREE_NULL_LIST(eio->new_objs);
+#ifdef EIO_USE_EPOLL
+	if (eio->epfd >= 0)
+		close(eio->epfd);
+	xfree(eio->ep_events);
+#endif
 	slurm_mutex_destroy(&eio->shutdown_mutex);
 
 	xassert(eio->magic = ~EIO_MAGIC);
@@ -279,6 +306,208 @@ static int _eio_wakeup_handler(eio_handle_t *eio)
 }
 
 int eio_handle_mainloop(eio_handle_t *eio)
+{
+	xassert (eio != NULL);
+	xassert (eio->magic == EIO_MAGIC);
+
+#ifdef EIO_USE_EPOLL
+	if (eio->epfd >= 0) {
+		int rc = _epoll_mainloop(eio);
+		/* rc of 1 means the epoll set could not be maintained,
+		 * fall back to the poll() based loop */
+		if (rc != 1)
+			return rc;
+	}
+#endif
+	return _poll_mainloop(eio);
+}
+
+#ifdef EIO_USE_EPOLL
+/* Remove an object's descriptor from the epoll set. Failures are
+ * ignored, closing a descriptor removes it implicitly. */
+static void _epoll_obj_del(eio_handle_t *eio, eio_obj_t *obj)
+{
+	if (eio->epfd >= 0)
+		(void) epoll_ctl(eio->epfd, EPOLL_CTL_DEL,
+				 obj->registered_fd, NULL);
+	obj->registered_fd = -1;
+	obj->registered_events = 0;
+}
+
+/* Walk the object list and register, re-arm or remove descriptors whose
+ * readable/writable state changed since the last iteration. Unchanged
+ * descriptors cost no system call.
+ * OUT nfds - number of objects with events armed
+ * RET 0 on success, -1 if the epoll set could not be maintained */
+static int _epoll_setup(eio_handle_t *eio, unsigned int *nfds)
+{
+	ListIterator  i = list_iterator_create(eio->obj_list);
+	eio_obj_t    *obj;
+	struct epoll_event ev;
+	unsigned int  n = 0;
+	int rc = 0, op;
+
+	while ((obj = list_next(i))) {
+		uint32_t want = 0;
+
+		if (_is_readable(obj))
+			want |= EPOLLIN | EPOLLRDHUP;
+		if (_is_writable(obj))
+			want |= EPOLLOUT;
+
+		if (want == 0) {
+			if (obj->registered_fd >= 0)
+				_epoll_obj_del(eio, obj);
+			continue;
+		}
+		n++;
+		if ((obj->registered_fd == obj->fd) &&
+		    (obj->registered_events == (short) want))
+			continue;	/* no state change */
+
+		if (obj->registered_fd == obj->fd) {
+			op = EPOLL_CTL_MOD;
+		} else {
+			if (obj->registered_fd >= 0)
+				_epoll_obj_del(eio, obj);
+			op = EPOLL_CTL_ADD;
+		}
+		memset(&ev, 0, sizeof(ev));
+		ev.events = want;
+		ev.data.ptr = obj;
+		if (epoll_ctl(eio->epfd, op, obj->fd, &ev) < 0) {
+			error("eio: epoll_ctl(%d): %m", obj->fd);
+			rc = -1;
+			break;
+		}
+		obj->eio_handle = eio;
+		obj->registered_fd = obj->fd;
+		obj->registered_events = (short) want;
+	}
+	list_iterator_destroy(i);
+	*nfds = n;
+	return rc;
+}
+
+static int _epoll_internal(eio_handle_t *eio, unsigned int nfds,
+			   time_t shutdown_time)
+{
+	int n, timeout;
+
+	if ((nfds + 1) > eio->ep_events_size) {
+		eio->ep_events_size = nfds + 1;
+		xrealloc_nz(eio->ep_events,
+			    eio->ep_events_size * sizeof(struct epoll_event));
+	}
+
+	if (shutdown_time)
+		timeout = 1000;	/* Return every 1000 msec during shutdown */
+	else
+		timeout = -1;
+	while ((n = epoll_wait(eio->epfd, eio->ep_events,
+			       eio->ep_events_size, timeout)) < 0) {
+		switch (errno) {
+		case EINTR :
+			return 0;
+		case EAGAIN:
+			continue;
+		default:
+			error("epoll_wait: %m");
+			return -1;
+		}
+	}
+
+	return n;
+}
+
+/* Translate epoll_wait() events to their poll() equivalents so that
+ * _poll_handle_event() can be shared by both backends */
+static short _epoll_xlate_events(uint32_t events)
+{
+	short revents = 0;
+
+	if (events & EPOLLIN)
+		revents |= POLLIN;
+	if (events & EPOLLOUT)
+		revents |= POLLOUT;
+	if (events & EPOLLHUP)
+		revents |= POLLHUP;
+	if (events & EPOLLERR)
+		revents |= POLLERR;
+#ifdef POLLRDHUP
+	if (events & EPOLLRDHUP)
+		revents |= POLLRDHUP;
+#endif
+	return revents;
+}
+
+/* Event loop which maintains a persistent epoll set across iterations
+ * rather than passing every descriptor to the kernel on each wakeup.
+ * RET 0 on normal shutdown, -1 on error, 1 to fall back to poll() */
+static int _epoll_mainloop(eio_handle_t *eio)
+{
+	struct epoll_event ev;
+	unsigned int nfds;
+	time_t shutdown_time;
+	int i, n;
+
+	/* The signalling fd stays armed for the life of the loop, a NULL
+	 * data pointer identifies it upon wakeup */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if (epoll_ctl(eio->epfd, EPOLL_CTL_ADD, eio->fds[0], &ev) < 0) {
+		error("eio: epoll_ctl(signal fd): %m");
+		goto fallback;
+	}
+
+	for (;;) {
+		if (_epoll_setup(eio, &nfds) < 0)
+			goto fallback;
+
+		debug4("eio: handling events for %d objects",
+		       list_count(eio->obj_list));
+		if (nfds == 0)
+			return 0;
+
+		slurm_mutex_lock(&eio->shutdown_mutex);
+		shutdown_time = eio->shutdown_time;
+		slurm_mutex_unlock(&eio->shutdown_mutex);
+		if ((n = _epoll_internal(eio, nfds, shutdown_time)) < 0)
+			return -1;
+
+		for (i = 0; i < n; i++) {
+			eio_obj_t *obj = eio->ep_events[i].data.ptr;
+
+			if (obj == NULL)	/* signalling fd */
+				_eio_wakeup_handler(eio);
+			else
+				_poll_handle_event(
+					_epoll_xlate_events(
+						eio->ep_events[i].events),
+					obj, eio->obj_list);
+		}
+
+		slurm_mutex_lock(&eio->shutdown_mutex);
+		shutdown_time = eio->shutdown_time;
+		slurm_mutex_unlock(&eio->shutdown_mutex);
+		if (shutdown_time &&
+		    (difftime(time(NULL), shutdown_time)>=eio->shutdown_wait)) {
+			error("%s: Abandoning IO %d secs after job shutdown "
+			      "initiated", __func__, eio->shutdown_wait);
+			return -1;
+		}
+	}
+
+fallback:
+	debug("eio: falling back to the poll() based event loop");
+	close(eio->epfd);
+	eio->epfd = -1;
+	return 1;
+}
+#endif /* EIO_USE_EPOLL */
+
+static int _poll_mainloop(eio_handle_t *eio)
 {
 	int            retval  = 0;
 	struct pollfd *pollfds = NULL;
@@ -287,9 +516,6 @@ int eio_handle_mainloop(eio_handle_t *eio)
 	unsigned int   n       = 0;
 	time_t shutdown_time;
 
-	xassert (eio != NULL);
-	xassert (eio->magic == EIO_MAGIC);
-
 	for (;;) {
 
 		/* Alloc memory for pfds and map if needed */
@@ -526,6 +752,7 @@ eio_obj_create(int fd, struct io_operations *ops, void *arg)
 	obj->arg = arg;
 	obj->ops = _ops_copy(ops);
 	obj->shutdown = false;
+	obj->registered_fd = -1;
 	return obj;
 }
 
@@ -533,6 +760,12 @@ void eio_obj_destroy(void *arg)
 {
 	eio_obj_t *obj = (eio_obj_t *)arg;
 	if (obj) {
+#ifdef EIO_USE_EPOLL
+		/* The fd may outlive the object, make sure no stale
+		   registration remains in the epoll set */
+		if (obj->eio_handle && (obj->registered_fd >= 0))
+			_epoll_obj_del(obj->eio_handle, obj);
+#endif
 		/* If the obj->fd is still open we need it to be to be
 		   sure we get the possible extra output that may be
 		   on the port.  see test7.11.
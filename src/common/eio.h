@@ -67,6 +67,12 @@ struct eio_obj {
 	void *arg;                        /* application-specific data       */
 	struct io_operations *ops;        /* pointer to ops struct for obj   */
 	bool shutdown;
+
+	/* fields below are managed by the eio engine, do not modify */
+	eio_handle_t *eio_handle;         /* handle polling this object      */
+	int registered_fd;                /* fd present in the epoll set     */
+	short registered_events;          /* events the epoll set is armed
+	                                   * for on registered_fd            */
 };
 
 eio_handle_t *eio_handle_create(uint16_t);
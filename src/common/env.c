@@ -1670,6 +1670,118 @@ void env_unset_environment(void)
 	xfree(value);
 }
 
+/*
+ * Hash indexed environment array builder. Merging one environment array
+ * into another with env_array_overwrite() linear-searches the destination
+ * for every variable, which is O(n^2) for the large environments seen with
+ * heavy use of modules. The builder indexes the destination names in a
+ * hash table once, so each merged variable costs one hash lookup, and the
+ * array is extended with amortized reallocations instead of one xrealloc
+ * per appended variable.
+ */
+#define ENV_HASH_BUCKETS 256
+#define ENV_HASH_HEADROOM 64
+
+typedef struct env_builder {
+	char **array;	/* environment strings, entries [0, count) */
+	int *chain;	/* per entry, index of next entry in its bucket */
+	int heads[ENV_HASH_BUCKETS]; /* first entry per bucket or -1 */
+	int count;	/* number of variables currently stored */
+	int size;	/* allocated entry slots in array/chain */
+} env_builder_t;
+
+/* Hash the name part (up to '=' or NUL) of an environment entry */
+static unsigned int _env_hash_name(const char *entry)
+{
+	unsigned int hash = 5381;
+
+	while (*entry && (*entry != '='))
+		hash = hash * 33 + (unsigned char) *entry++;
+	return hash % ENV_HASH_BUCKETS;
+}
+
+/*
+ * Take over the environment array of array_ptr and index its variable
+ * names. The array must not be used through array_ptr until given back
+ * by _env_builder_fini().
+ */
+static void _env_builder_init(env_builder_t *b, char ***array_ptr)
+{
+	unsigned int h;
+	char **ep;
+	int i;
+
+	if (*array_ptr == NULL)
+		*array_ptr = env_array_create();
+
+	b->count = 0;
+	for (ep = *array_ptr; *ep != NULL; ep++)
+		b->count++;
+	b->size = b->count + ENV_HASH_HEADROOM;
+	b->array = xrealloc(*array_ptr, (b->size + 1) * sizeof(char *));
+	b->chain = xmalloc(b->size * sizeof(int));
+	for (i = 0; i < ENV_HASH_BUCKETS; i++)
+		b->heads[i] = -1;
+	for (i = 0; i < b->count; i++) {
+		h = _env_hash_name(b->array[i]);
+		b->chain[i] = b->heads[h];
+		b->heads[h] = i;
+	}
+}
+
+/*
+ * Store a copy of the "name=value" string entry, overwriting any variable
+ * of the same name if over_write is set, ignoring the entry otherwise.
+ * Return 1 if the entry was stored, 0 if not.
+ */
+static int _env_builder_set(env_builder_t *b, const char *entry,
+			    bool over_write)
+{
+	unsigned int h = _env_hash_name(entry);
+	char *sep = strchr(entry, '=');
+	int len, i;
+
+	if (sep == NULL)	/* Bad parsing, no '=' found */
+		return 0;
+	len = sep - entry;
+
+	for (i = b->heads[h]; i != -1; i = b->chain[i]) {
+		if ((xstrncmp(b->array[i], entry, len) == 0) &&
+		    (b->array[i][len] == '=')) {
+			if (!over_write)
+				return 0;
+			xfree(b->array[i]);
+			b->array[i] = xstrdup(entry);
+			return 1;
+		}
+	}
+
+	if (b->count >= b->size) {
+		b->size *= 2;
+		b->array = xrealloc(b->array,
+				    (b->size + 1) * sizeof(char *));
+		b->chain = xrealloc(b->chain, b->size * sizeof(int));
+	}
+	b->array[b->count] = xstrdup(entry);
+	b->chain[b->count] = b->heads[h];
+	b->heads[h] = b->count;
+	b->count++;
+
+	return 1;
+}
+
+/*
+ * Release the hash index, pack the environment array down to its final
+ * NULL terminated size and give it back to array_ptr.
+ */
+static void _env_builder_fini(env_builder_t *b, char ***array_ptr)
+{
+	b->array = xrealloc(b->array, (b->count + 1) * sizeof(char *));
+	b->array[b->count] = NULL;
+	xfree(b->chain);
+	*array_ptr = b->array;
+}
+
 /*
  * Merge all of the environment variables in src_array into the
  * array dest_array.  Any variables already found in dest_array
@@ -1677,19 +1789,16 @@ void env_unset_environment(void)
  */
 void env_array_merge(char ***dest_array, const char **src_array)
 {
+	env_builder_t builder;
 	char **ptr;
-	char name[256], *value;
 
 	if (src_array == NULL)
 		return;
 
-	value = xmalloc(ENV_BUFSIZE);
-	for (ptr = (char **)src_array; *ptr != NULL; ptr++) {
-		if (_env_array_entry_splitter(*ptr, name, sizeof(name),
-					      value, ENV_BUFSIZE))
-			env_array_overwrite(dest_array, name, value);
-	}
-	xfree(value);
+	_env_builder_init(&builder, dest_array);
+	for (ptr = (char **)src_array; *ptr != NULL; ptr++)
+		_env_builder_set(&builder, *ptr, true);
+	_env_builder_fini(&builder, dest_array);
 }
 
 /*
@@ -1699,20 +1808,18 @@ void env_array_merge(char ***dest_array, const char **src_array)
  */
 void env_array_merge_slurm(char ***dest_array, const char **src_array)
 {
+	env_builder_t builder;
 	char **ptr;
-	char name[256], *value;
 
 	if (src_array == NULL)
 		return;
 
-	value = xmalloc(ENV_BUFSIZE);
+	_env_builder_init(&builder, dest_array);
 	for (ptr = (char **)src_array; *ptr != NULL; ptr++) {
-		if (_env_array_entry_splitter(*ptr, name, sizeof(name),
-					      value, ENV_BUFSIZE) &&
-		    (xstrncmp(name, "SLURM", 5) == 0))
-			env_array_overwrite(dest_array, name, value);
+		if (xstrncmp(*ptr, "SLURM", 5) == 0)
+			_env_builder_set(&builder, *ptr, true);
 	}
-	xfree(value);
+	_env_builder_fini(&builder, dest_array);
 }
 
 /*
@@ -1722,23 +1829,20 @@ void env_array_merge_slurm(char ***dest_array, const char **src_array)
  */
 void env_array_merge_spank(char ***dest_array, const char **src_array)
 {
+	env_builder_t builder;
 	char **ptr;
-	char name[256], *value;
 
 	if (src_array == NULL)
 		return;
 
-	value = xmalloc(ENV_BUFSIZE);
+	_env_builder_init(&builder, dest_array);
 	for (ptr = (char **)src_array; *ptr != NULL; ptr++) {
-		if (_env_array_entry_splitter(*ptr, name, sizeof(name),
-					      value, ENV_BUFSIZE)) {
-			if (xstrncmp(name, "SPANK_" ,6))
-				env_array_overwrite(dest_array, name, value);
-			else
-				env_array_overwrite(dest_array, name+6, value);
-		}
+		if (xstrncmp(*ptr, "SPANK_", 6))
+			_env_builder_set(&builder, *ptr, true);
+		else
+			_env_builder_set(&builder, *ptr + 6, true);
 	}
-	xfree(value);
+	_env_builder_fini(&builder, dest_array);
 }
 
 /*
@@ -267,6 +267,15 @@ void *_forward_thread(void *arg)
 				slurm_mutex_unlock(&fwd_struct->forward_mutex);
 				slurm_close(fd);
 				fd = -1;
+				/* Abandon tree. A node which accepted the
+				 * message but never answered is probably
+				 * hung, so fan the remainder of the span
+				 * out across new threads rather than time
+				 * out on each remaining node serially.
+				 */
+				_forward_msg_internal(hl, NULL, fwd_struct,
+						      &fwd_msg->header, 0,
+						      hostlist_count(hl));
 				continue;
 			}
 			goto cleanup;
@@ -278,7 +287,7 @@ void *_forward_thread(void *arg)
 			   never have to worry about a locked
 			   mutex */
 			ListIterator itr = NULL;
-			char *tmp = NULL;
+			char tmp[HOSTLIST_NAME_LEN];
 			int first_node_found = 0;
 			hostlist_iterator_t host_itr
 				= hostlist_iterator_create(hl);
@@ -286,7 +295,8 @@ void *_forward_thread(void *arg)
 			      "but only got %d back",
 			      (fwd_msg->header.forward.cnt+1),
 			      list_count(ret_list));
-			while ((tmp = hostlist_next(host_itr))) {
+			while (hostlist_next_buf(host_itr, tmp,
+						 sizeof(tmp)) >= 0) {
 				int node_found = 0;
 				itr = list_iterator_create(ret_list);
 				while ((ret_data_info = list_next(itr))) {
@@ -308,7 +318,6 @@ void *_forward_thread(void *arg)
 						tmp,
 						SLURM_COMMUNICATIONS_CONNECTION_ERROR);
 				}
-				free(tmp);
 			}
 			hostlist_iterator_destroy(host_itr);
 			if (!first_node_found) {
@@ -3569,7 +3569,7 @@ extern void gres_plugin_job_core_filter(List job_gres_list, List node_gres_list,
 					char *node_name)
 {
 	int i;
-	ListIterator  job_gres_iter, node_gres_iter;
+	ListIterator  job_gres_iter;
 	gres_state_t *job_gres_ptr, *node_gres_ptr;
 
 	if ((job_gres_list == NULL) || (cpu_bitmap == NULL))
@@ -3584,13 +3584,9 @@ extern void gres_plugin_job_core_filter(List job_gres_list, List node_gres_list,
 	slurm_mutex_lock(&gres_context_lock);
 	job_gres_iter = list_iterator_create(job_gres_list);
 	while ((job_gres_ptr = (gres_state_t *) list_next(job_gres_iter))) {
-		node_gres_iter = list_iterator_create(node_gres_list);
-		while ((node_gres_ptr = (gres_state_t *)
-				list_next(node_gres_iter))) {
-			if (job_gres_ptr->plugin_id == node_gres_ptr->plugin_id)
-				break;
-		}
-		list_iterator_destroy(node_gres_iter);
+		node_gres_ptr = (gres_state_t *)
+			list_find_first(node_gres_list, _gres_find_id,
+					&job_gres_ptr->plugin_id);
 		if (node_gres_ptr == NULL) {
 			/* node lack resources required by the job */
 			bit_nclear(cpu_bitmap, cpu_start_bit, cpu_end_bit);
@@ -3636,7 +3632,7 @@ extern uint32_t gres_plugin_job_test(List job_gres_list, List node_gres_list,
 {
 	int i;
 	uint32_t cpu_cnt, tmp_cnt;
-	ListIterator job_gres_iter,  node_gres_iter;
+	ListIterator job_gres_iter;
 	gres_state_t *job_gres_ptr, *node_gres_ptr;
 	bool topo_set = false;
 
@@ -3651,13 +3647,9 @@ extern uint32_t gres_plugin_job_test(List job_gres_list, List node_gres_list,
 	slurm_mutex_lock(&gres_context_lock);
 	job_gres_iter = list_iterator_create(job_gres_list);
 	while ((job_gres_ptr = (gres_state_t *) list_next(job_gres_iter))) {
-		node_gres_iter = list_iterator_create(node_gres_list);
-		while ((node_gres_ptr = (gres_state_t *)
-				list_next(node_gres_iter))) {
-			if (job_gres_ptr->plugin_id == node_gres_ptr->plugin_id)
-				break;
-		}
-		list_iterator_destroy(node_gres_iter);
+		node_gres_ptr = (gres_state_t *)
+			list_find_first(node_gres_list, _gres_find_id,
+					&job_gres_ptr->plugin_id);
 		if (node_gres_ptr == NULL) {
 			/* node lack resources required by the job */
 			cpu_cnt = 0;
@@ -3691,6 +3683,83 @@ extern uint32_t gres_plugin_job_test(List job_gres_list, List node_gres_list,
 	return cpu_cnt;
 }
 
+/*
+ * Determine how many CPUs on each node in a set can be used by this job,
+ *	ignoring specific core placement. The context lock is taken once for
+ *	the whole pass rather than once per node, intended as a fast filter
+ *	ahead of the per node gres_plugin_job_test() calls.
+ * IN job_gres_list   - job's gres_list built by
+ *		        gres_plugin_job_state_validate()
+ * IN node_gres_lists - array of per node gres_list, built by
+ *		        gres_plugin_node_config_validate()
+ * IN node_bitmap     - nodes to test, size no larger than node_cnt
+ * IN node_cnt        - size of the node_gres_lists and cpu_cnt arrays
+ * IN use_total_gres  - if set then consider all gres resources as available,
+ *		        and none are commited to running jobs
+ * IN job_id          - job's ID (for logging)
+ * OUT cpu_cnt        - per node count of usable CPUs, NO_VAL if no limit
+ */
+extern void gres_plugin_job_test_batch(List job_gres_list,
+				       List *node_gres_lists,
+				       bitstr_t *node_bitmap, int node_cnt,
+				       bool use_total_gres, uint32_t job_id,
+				       uint32_t *cpu_cnt)
+{
+	int i, n;
+	uint32_t tmp_cnt;
+	ListIterator job_gres_iter;
+	gres_state_t *job_gres_ptr, *node_gres_ptr;
+	bool topo_set;
+
+	for (n = 0; n < node_cnt; n++)
+		cpu_cnt[n] = NO_VAL;
+	if (job_gres_list == NULL)
+		return;
+
+	(void) gres_plugin_init();
+
+	slurm_mutex_lock(&gres_context_lock);
+	for (n = 0; n < node_cnt; n++) {
+		if (!bit_test(node_bitmap, n))
+			continue;
+		if (node_gres_lists[n] == NULL) {
+			cpu_cnt[n] = 0;
+			continue;
+		}
+		topo_set = false;
+		job_gres_iter = list_iterator_create(job_gres_list);
+		while ((job_gres_ptr = (gres_state_t *)
+				list_next(job_gres_iter))) {
+			node_gres_ptr = (gres_state_t *)
+				list_find_first(node_gres_lists[n],
+						_gres_find_id,
+						&job_gres_ptr->plugin_id);
+			if (node_gres_ptr == NULL) {
+				/* node lack resources required by the job */
+				cpu_cnt[n] = 0;
+				break;
+			}
+			for (i = 0; i < gres_context_cnt; i++) {
+				if (job_gres_ptr->plugin_id !=
+				    gres_context[i].plugin_id)
+					continue;
+				tmp_cnt = _job_test(job_gres_ptr->gres_data,
+						    node_gres_ptr->gres_data,
+						    use_total_gres, NULL, 0, 0,
+						    &topo_set, job_id, NULL,
+						    gres_context[i].gres_name);
+				if (tmp_cnt != NO_VAL)
+					cpu_cnt[n] = MIN(tmp_cnt, cpu_cnt[n]);
+				break;
+			}
+			if (cpu_cnt[n] == 0)
+				break;
+		}
+		list_iterator_destroy(job_gres_iter);
+	}
+	slurm_mutex_unlock(&gres_context_lock);
+}
+
 /*
  * Determine if specific GRES index on node is available to a job's allocated
  *	cores
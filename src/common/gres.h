@@ -500,6 +500,28 @@ extern uint32_t gres_plugin_job_test(List job_gres_list, List node_gres_list,
 				     int cpu_start_bit, int cpu_end_bit,
 				     uint32_t job_id, char *node_name);
 
+/*
+ * Determine how many CPUs on each node in a set can be used by this job,
+ *	ignoring specific core placement. The context lock is taken once for
+ *	the whole pass rather than once per node, intended as a fast filter
+ *	ahead of the per node gres_plugin_job_test() calls.
+ * IN job_gres_list   - job's gres_list built by
+ *		        gres_plugin_job_state_validate()
+ * IN node_gres_lists - array of per node gres_list, built by
+ *		        gres_plugin_node_config_validate()
+ * IN node_bitmap     - nodes to test, size no larger than node_cnt
+ * IN node_cnt        - size of the node_gres_lists and cpu_cnt arrays
+ * IN use_total_gres  - if set then consider all gres resources as available,
+ *		        and none are commited to running jobs
+ * IN job_id          - job's ID (for logging)
+ * OUT cpu_cnt        - per node count of usable CPUs, NO_VAL if no limit
+ */
+extern void gres_plugin_job_test_batch(List job_gres_list,
+				       List *node_gres_lists,
+				       bitstr_t *node_bitmap, int node_cnt,
+				       bool use_total_gres, uint32_t job_id,
+				       uint32_t *cpu_cnt);
+
 /*
  * Allocate resource to a job and update node and job gres information
  * IN job_gres_list - job's gres_list built by gres_plugin_job_state_validate()
@@ -88,6 +88,8 @@ strong_alias(hostlist_iterator_create,	slurm_hostlist_iterator_create);
 strong_alias(hostlist_iterator_destroy,	slurm_hostlist_iterator_destroy);
 strong_alias(hostlist_iterator_reset,	slurm_hostlist_iterator_reset);
 strong_alias(hostlist_next,		slurm_hostlist_next);
+strong_alias(hostlist_next_buf,		slurm_hostlist_next_buf);
+strong_alias(hostlist_next_parts,	slurm_hostlist_next_parts);
 strong_alias(hostlist_next_range,	slurm_hostlist_next_range);
 strong_alias(hostlist_nth,		slurm_hostlist_nth);
 strong_alias(hostlist_pop,		slurm_hostlist_pop);
@@ -213,6 +215,13 @@ struct hostrange_components {
 
 	/* If singlehost is 1, `lo' and `hi' are invalid */
 	unsigned singlehost:1;
+
+	/* If key_complete is 1, pfx_key encodes the entire prefix */
+	unsigned key_complete:1;
+
+	/* Cached sort key: leading non-digit bytes of the prefix packed
+	 * big-endian, see _hostrange_set_key() */
+	uint64_t pfx_key;
 };
 
 typedef struct hostrange_components *hostrange_t;
@@ -240,6 +249,10 @@ struct hostlist {
 	/* list of iterators */
 	struct hostlist_iterator *ilist;
 
+	/* memoized result of hostlist_ranged_string_xmalloc_dims(),
+	 * cleared by any modification of the list */
+	char *ranged_cache;
+	int ranged_cache_dims;
 };
 
 
@@ -670,6 +683,32 @@ static hostrange_t hostrange_new(void)
 	return new;
 }
 
+/* Compute the cached prefix sort key for hr. The key packs the leading
+ * non-digit, non-space characters of the prefix (at most 8) big-endian,
+ * so that integer comparison of two keys matches strnatcmp() order
+ * whenever the encoded regions suffice to decide (strnatcmp compares
+ * such characters by plain value). key_complete is set when the whole
+ * prefix fit in the key.
+ */
+static void _hostrange_set_key(hostrange_t hr)
+{
+	const unsigned char *p = (const unsigned char *) hr->prefix;
+	uint64_t key = 0;
+	int i;
+
+	hr->key_complete = 0;
+	for (i = 0; i < 8; i++) {
+		if (p[i] == '\0') {
+			hr->key_complete = 1;
+			break;
+		}
+		if (isdigit(p[i]) || isspace(p[i]))
+			break;
+		key |= ((uint64_t) p[i]) << (56 - (8 * i));
+	}
+	hr->pfx_key = key;
+}
+
 /* Create a hostrange_t containing a single host without a valid suffix
  * hr->prefix will represent the entire hostname.
  */
@@ -689,6 +728,7 @@ static hostrange_t hostrange_create_single(const char *prefix)
 	new->lo = 0L;
 	new->hi = 0L;
 	new->width = 0;
+	_hostrange_set_key(new);
 
 	return new;
 
@@ -719,6 +759,7 @@ hostrange_create(char *prefix, unsigned long lo, unsigned long hi, int width)
 	new->width = width;
 
 	new->singlehost = 0;
+	_hostrange_set_key(new);
 
 	return new;
 
@@ -825,11 +866,34 @@ static int hostrange_cmp(hostrange_t h1, hostrange_t h2)
 static int hostrange_prefix_cmp(hostrange_t h1, hostrange_t h2)
 {
 	int retval;
+	uint64_t xor;
+
 	if (h1 == NULL)
 		return 1;
 	if (h2 == NULL)
 		return -1;
 
+	/* Try to decide with the cached keys first. Zero padding in a
+	 * key is trustworthy only if the key encodes the whole prefix
+	 * (the padding could otherwise hide a digit, which strnatcmp
+	 * orders differently). */
+	xor = h1->pfx_key ^ h2->pfx_key;
+	if (xor) {
+		int shift;
+		unsigned char c1 = 0, c2 = 0;
+
+		for (shift = 56; shift >= 0; shift -= 8) {
+			c1 = (h1->pfx_key >> shift) & 0xff;
+			c2 = (h2->pfx_key >> shift) & 0xff;
+			if (c1 != c2)
+				break;
+		}
+		if ((c1 && c2) ||
+		    (c1 ? h2->key_complete : h1->key_complete))
+			return (c1 < c2) ? -1 : 1;
+	} else if (h1->key_complete && h2->key_complete)
+		return h2->singlehost - h1->singlehost;
+
 	retval = strnatcmp(h1->prefix, h2->prefix);
 	return retval == 0 ? h2->singlehost - h1->singlehost : retval;
 }
@@ -1275,6 +1339,8 @@ static hostlist_t hostlist_new(void)
 	new->nranges = 0;
 	new->nhosts = 0;
 	new->ilist = NULL;
+	new->ranged_cache = NULL;
+	new->ranged_cache_dims = 0;
 	return new;
 
 fail2:
@@ -1324,6 +1390,16 @@ static int hostlist_expand(hostlist_t hl)
  * Returns the number of hosts successfully pushed onto hl
  * or -1 if there was an error allocating memory
  */
+/* Invalidate the memoized ranged string form of the hostlist.
+ * It is assumed that the caller has the hostlist hl locked */
+static void hostlist_dirty(hostlist_t hl)
+{
+	if (hl->ranged_cache) {
+		free(hl->ranged_cache);
+		hl->ranged_cache = NULL;
+	}
+}
+
 static int hostlist_push_range(hostlist_t hl, hostrange_t hr)
 {
 	hostrange_t tail;
@@ -1331,6 +1407,7 @@ static int hostlist_push_range(hostlist_t hl, hostrange_t hr)
 
 	assert(hr != NULL);
 	LOCK_HOSTLIST(hl);
+	hostlist_dirty(hl);
 
 	tail = (hl->nranges > 0) ? hl->hr[hl->nranges-1] : hl->hr[0];
 
@@ -1927,11 +2004,82 @@ error:
 
 
 
+/* Cache of recently parsed ranged host expressions. The same strings
+ * (e.g. partition node lists, the node record table) are parsed over and
+ * over each scheduling cycle, and copying a parsed hostlist is far
+ * cheaper than re-parsing the expression. */
+#define HOSTLIST_CACHE_RECS	8
+#define HOSTLIST_CACHE_MIN_LEN	16
+static struct hl_cache_rec {
+	char *str;
+	int dims;
+	hostlist_t hl;
+	uint64_t last_used;
+} hl_cache[HOSTLIST_CACHE_RECS];
+static uint64_t hl_cache_clock = 0;
+static pthread_mutex_t hl_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* If the expression was recently parsed, return a copy of the cached
+ * hostlist, otherwise NULL */
+static hostlist_t _hostlist_cache_lookup(const char *str, int dims)
+{
+	hostlist_t hl = NULL;
+	int i;
+
+	if (!str || (strlen(str) < HOSTLIST_CACHE_MIN_LEN))
+		return NULL;
+
+	slurm_mutex_lock(&hl_cache_mutex);
+	for (i = 0; i < HOSTLIST_CACHE_RECS; i++) {
+		if (hl_cache[i].str && (hl_cache[i].dims == dims) &&
+		    (strcmp(hl_cache[i].str, str) == 0)) {
+			hl_cache[i].last_used = ++hl_cache_clock;
+			hl = hostlist_copy(hl_cache[i].hl);
+			break;
+		}
+	}
+	slurm_mutex_unlock(&hl_cache_mutex);
+	return hl;
+}
+
+/* Add a copy of a freshly parsed hostlist to the cache, replacing the
+ * least recently used entry */
+static void _hostlist_cache_insert(const char *str, int dims, hostlist_t hl)
+{
+	int i, replace_inx = 0;
+	uint64_t replace_used;
+
+	if (!hl || !str || (strlen(str) < HOSTLIST_CACHE_MIN_LEN))
+		return;
+
+	slurm_mutex_lock(&hl_cache_mutex);
+	replace_used = hl_cache[0].last_used;
+	for (i = 1; i < HOSTLIST_CACHE_RECS; i++) {
+		if (hl_cache[i].last_used < replace_used) {
+			replace_used = hl_cache[i].last_used;
+			replace_inx = i;
+		}
+	}
+	free(hl_cache[replace_inx].str);
+	hostlist_destroy(hl_cache[replace_inx].hl);
+	hl_cache[replace_inx].str = strdup(str);
+	hl_cache[replace_inx].dims = dims;
+	hl_cache[replace_inx].hl = hostlist_copy(hl);
+	hl_cache[replace_inx].last_used = ++hl_cache_clock;
+	slurm_mutex_unlock(&hl_cache_mutex);
+}
+
 hostlist_t hostlist_create_dims(const char *str, int dims)
 {
+	hostlist_t hl;
+
 	if (!dims)
 		dims = slurmdb_setup_cluster_name_dims();
-	return _hostlist_create(str, "\t, ", "-", dims);
+	if ((hl = _hostlist_cache_lookup(str, dims)))
+		return hl;
+	hl = _hostlist_create(str, "\t, ", "-", dims);
+	_hostlist_cache_insert(str, dims, hl);
+	return hl;
 }
 
 hostlist_t hostlist_create(const char *str)
@@ -1960,6 +2108,10 @@ hostlist_t hostlist_copy(const hostlist_t hl)
 
 	for (i = 0; i < hl->nranges; i++)
 		new->hr[i] = hostrange_copy(hl->hr[i]);
+	if (hl->ranged_cache) {
+		new->ranged_cache = strdup(hl->ranged_cache);
+		new->ranged_cache_dims = hl->ranged_cache_dims;
+	}
 
 done:
 	UNLOCK_HOSTLIST(hl);
@@ -1981,6 +2133,7 @@ void hostlist_destroy(hostlist_t hl)
 	for (i = 0; i < hl->nranges; i++)
 		hostrange_destroy(hl->hr[i]);
 	free(hl->hr);
+	hostlist_dirty(hl);
 	assert(hl->magic = 0x1);
 	UNLOCK_HOSTLIST(hl);
 	slurm_mutex_destroy(&hl->mutex);
@@ -2067,6 +2220,7 @@ char *hostlist_pop(hostlist_t hl)
 	LOCK_HOSTLIST(hl);
 	if (hl->nhosts > 0) {
 		hostrange_t hr = hl->hr[hl->nranges - 1];
+		hostlist_dirty(hl);
 		host = hostrange_pop(hr);
 		hl->nhosts--;
 		if (hostrange_empty(hr)) {
@@ -2120,6 +2274,7 @@ char *hostlist_shift_dims(hostlist_t hl, int dims)
 	if (hl->nhosts > 0) {
 		hostrange_t hr = hl->hr[0];
 
+		hostlist_dirty(hl);
 		host = hostrange_shift(hr, dims);
 		hl->nhosts--;
 
@@ -2156,6 +2311,7 @@ char *hostlist_pop_range(hostlist_t hl)
 		return NULL;
 	}
 
+	hostlist_dirty(hl);
 	i = hl->nranges - 2;
 	tail = hl->hr[hl->nranges - 1];
 	while (i >= 0 && hostrange_within_range(tail, hl->hr[i]))
@@ -2196,6 +2352,7 @@ int hostlist_pop_range_values(
 	tail = hl->hr[i];
 
 	if (tail && i < hl->nranges) {
+		hostlist_dirty(hl);
 		*lo = tail->lo;
 		*hi = tail->hi;
 		hl->nhosts -= hostrange_count(tail);
@@ -2228,6 +2385,7 @@ char *hostlist_shift_range(hostlist_t hl)
 		return NULL;
 	}
 
+	hostlist_dirty(hl);
 	i = 0;
 	do {
 		hostlist_push_range(hltmp, hl->hr[i]);
@@ -2356,6 +2514,7 @@ int hostlist_delete_nth(hostlist_t hl, int n)
 	LOCK_HOSTLIST(hl);
 	assert(n >= 0 && n <= hl->nhosts);
 
+	hostlist_dirty(hl);
 	count = 0;
 
 	for (i = 0; i < hl->nranges; i++) {
@@ -2448,6 +2607,7 @@ void hostlist_sort(hostlist_t hl)
 		return;
 	}
 
+	hostlist_dirty(hl);
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
 
 	/* reset all iterators */
@@ -2564,6 +2724,7 @@ void hostlist_uniq(hostlist_t hl)
 		UNLOCK_HOSTLIST(hl);
 		return;
 	}
+	hostlist_dirty(hl);
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
 
 	while (i < hl->nranges) {
@@ -3129,12 +3290,33 @@ char *hostlist_ranged_string_malloc(hostlist_t hl)
 char *hostlist_ranged_string_xmalloc_dims(hostlist_t hl, int dims, int brackets)
 {
 	int buf_size = 8192;
-	char *buf = xmalloc_nz(buf_size);
+	char *buf;
+
+	/* re-use the memoized form if the list is unmodified */
+	LOCK_HOSTLIST(hl);
+	if (hl->ranged_cache && brackets &&
+	    (hl->ranged_cache_dims == dims)) {
+		buf_size = strlen(hl->ranged_cache) + 1;
+		buf = xmalloc_nz(buf_size);
+		memcpy(buf, hl->ranged_cache, buf_size);
+		UNLOCK_HOSTLIST(hl);
+		return buf;
+	}
+	UNLOCK_HOSTLIST(hl);
+
+	buf = xmalloc_nz(buf_size);
 	while (hostlist_ranged_string_dims(
 		       hl, buf_size, buf, dims, brackets) < 0) {
 		buf_size *= 2;
 		xrealloc_nz(buf, buf_size);
 	}
+	if (brackets) {
+		LOCK_HOSTLIST(hl);
+		hostlist_dirty(hl);
+		hl->ranged_cache = strdup(buf);
+		hl->ranged_cache_dims = dims;
+		UNLOCK_HOSTLIST(hl);
+	}
 	return buf;
 }
 
@@ -3399,26 +3581,24 @@ static void _iterator_advance_range(hostlist_iterator_t i)
 	}
 }
 
-char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+/* Format the host now under iterator "i" into the caller's buffer.
+ * The caller must hold the hostlist lock and have already advanced
+ * the iterator. Returns the name length or -1 if the iterator is
+ * exhausted or the buffer is too small. */
+static int _iterator_host_str(hostlist_iterator_t i, char *buf, int size,
+			      int dims)
 {
-	char buf[MAXHOSTNAMELEN + 16];
-	const int size = sizeof(buf);
-	int len = 0;
-
-	assert(i != NULL);
-	assert(i->magic == HOSTLIST_MAGIC);
-	LOCK_HOSTLIST(i->hl);
-	_iterator_advance(i);
+	int len, len2;
 
 	if (!dims)
 		dims = slurmdb_setup_cluster_name_dims();
 
 	if (i->idx > i->hl->nranges - 1)
-		goto no_next;
+		return -1;
 
 	len = snprintf(buf, size, "%s", i->hr->prefix);
 	if (len < 0 || len + dims >= size)
-		goto no_next;
+		return -1;
 
 	if (!i->hr->singlehost) {
 		if ((dims > 1) && (i->hr->width == dims)) {
@@ -3431,17 +3611,31 @@ char *hostlist_next_dims(hostlist_iterator_t i, int dims)
 				buf[len++] = alpha_num[coord[i2++]];
 			buf[len] = '\0';
 		} else {
-			len = snprintf(buf + len, size - len, "%0*lu",
-				       i->hr->width, i->hr->lo + i->depth);
-			if (len < 0 || len >= size)
-				goto no_next;
+			len2 = snprintf(buf + len, size - len, "%0*lu",
+					i->hr->width, i->hr->lo + i->depth);
+			if (len2 < 0 || len2 >= (size - len))
+				return -1;
+			len += len2;
 		}
 	}
+	return len;
+}
+
+char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+{
+	char buf[MAXHOSTNAMELEN + 16];
+	int len;
+
+	assert(i != NULL);
+	assert(i->magic == HOSTLIST_MAGIC);
+	LOCK_HOSTLIST(i->hl);
+	_iterator_advance(i);
+	len = _iterator_host_str(i, buf, sizeof(buf), dims);
 	UNLOCK_HOSTLIST(i->hl);
+
+	if (len < 0)
+		return NULL;
 	return strdup(buf);
-no_next:
-	UNLOCK_HOSTLIST(i->hl);
-	return NULL;
 }
 
 char *hostlist_next(hostlist_iterator_t i)
@@ -3451,6 +3645,48 @@ char *hostlist_next(hostlist_iterator_t i)
 	return hostlist_next_dims(i, dims);
 }
 
+int hostlist_next_buf(hostlist_iterator_t i, char *buf, int buf_size)
+{
+	int len;
+
+	assert(i != NULL);
+	assert(i->magic == HOSTLIST_MAGIC);
+	LOCK_HOSTLIST(i->hl);
+	_iterator_advance(i);
+	len = _iterator_host_str(i, buf, buf_size, 0);
+	UNLOCK_HOSTLIST(i->hl);
+
+	return len;
+}
+
+int hostlist_next_parts(hostlist_iterator_t i, char **prefix,
+			unsigned long *suffix)
+{
+	int width;
+
+	assert(i != NULL);
+	assert(i->magic == HOSTLIST_MAGIC);
+	LOCK_HOSTLIST(i->hl);
+	_iterator_advance(i);
+
+	if (i->idx > i->hl->nranges - 1) {
+		UNLOCK_HOSTLIST(i->hl);
+		return -1;
+	}
+
+	*prefix = i->hr->prefix;
+	if (i->hr->singlehost) {
+		*suffix = 0;
+		width = 0;
+	} else {
+		*suffix = i->hr->lo + i->depth;
+		width = i->hr->width;
+	}
+	UNLOCK_HOSTLIST(i->hl);
+
+	return width;
+}
+
 char *hostlist_next_range(hostlist_iterator_t i)
 {
 	int j, buf_size;
@@ -3488,6 +3724,7 @@ int hostlist_remove(hostlist_iterator_t i)
 	assert(i != NULL);
 	assert(i->magic == HOSTLIST_MAGIC);
 	LOCK_HOSTLIST(i->hl);
+	hostlist_dirty(i->hl);
 	new = hostrange_delete_host(i->hr, i->hr->lo + i->depth);
 	if (new) {
 		hostlist_insert_range(i->hl, new, i->idx + 1);
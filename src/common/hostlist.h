@@ -453,6 +453,28 @@ void hostlist_iterator_reset(hostlist_iterator_t i);
 char * hostlist_next_dims(hostlist_iterator_t i, int dims);
 char * hostlist_next(hostlist_iterator_t i);
 
+/* Buffer size sufficient to hold any host name filled in by
+ * hostlist_next_buf() */
+#define HOSTLIST_NAME_LEN 80
+
+/* hostlist_next_buf():
+ *
+ * As hostlist_next(), but fills the caller supplied buffer instead of
+ * allocating memory. Returns the name length, or -1 if the iterator is
+ * at the end of the list or buf_size is too small.
+ */
+int hostlist_next_buf(hostlist_iterator_t i, char *buf, int buf_size);
+
+/* hostlist_next_parts():
+ *
+ * Advance the iterator and return the parsed parts of the next host
+ * directly: the prefix string and the numeric suffix value. Returns the
+ * zero-padded width of the suffix (0 for a host with no numeric suffix)
+ * or -1 at the end of the list. The prefix pointer references hostlist
+ * internal storage and is only valid until the hostlist is modified.
+ */
+int hostlist_next_parts(hostlist_iterator_t i, char **prefix,
+			unsigned long *suffix);
 
 /* hostlist_next_range():
  *
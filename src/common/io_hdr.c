@@ -40,7 +40,8 @@
 #include "src/common/io_hdr.h"
 #include "src/common/slurm_protocol_defs.h"
 
-#define IO_PROTOCOL_VERSION 0xb001
+/* 0xb002 added SLURM_IO_CREDIT flow control messages */
+#define IO_PROTOCOL_VERSION 0xb002
 
 /*
 static void
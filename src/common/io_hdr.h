@@ -54,6 +54,10 @@
 #define SLURM_IO_STDERR 2
 #define SLURM_IO_ALLSTDIN 3
 #define SLURM_IO_CONNECTION_TEST 4
+/* Flow control grant from the client.  No message body follows the
+ * header; the length field carries the number of additional payload
+ * bytes the sender of the grant is prepared to accept. */
+#define SLURM_IO_CREDIT 5
 
 struct slurm_io_init_msg {
 	uint16_t      version;
@@ -530,12 +530,183 @@ extern void log_job_resources(uint32_t job_id,
 	info("====================");
 }
 
+/*
+ * Run length encoded array packing. The per-node cpu and memory arrays
+ * of a job are highly repetitive (every node of a homogeneous allocation
+ * carries the same values), so they are packed as (count, then runs of
+ * (repetitions, value)) from SLURM_17_02_PROTOCOL_VERSION on, rather
+ * than one element per node. A zero count stands for a NULL array, as
+ * with the plain array packing.
+ */
+static void _pack16_array_rle(uint16_t *array, uint32_t cnt, Buf buffer)
+{
+	uint32_t i = 0, reps;
+
+	pack32(cnt, buffer);
+	while (i < cnt) {
+		reps = 1;
+		while (((i + reps) < cnt) && (array[i + reps] == array[i]))
+			reps++;
+		pack32(reps, buffer);
+		pack16(array[i], buffer);
+		i += reps;
+	}
+}
+
+static int _unpack16_array_rle(uint16_t **valp, uint32_t *size_val,
+			       Buf buffer)
+{
+	uint32_t cnt, filled = 0, reps, i;
+	uint16_t value;
+
+	*valp = NULL;
+	safe_unpack32(&cnt, buffer);
+	*size_val = cnt;
+	if (cnt == 0)
+		return SLURM_SUCCESS;
+	*valp = xmalloc(cnt * sizeof(uint16_t));
+	while (filled < cnt) {
+		safe_unpack32(&reps, buffer);
+		safe_unpack16(&value, buffer);
+		if ((reps == 0) || (reps > (cnt - filled)))
+			goto unpack_error;
+		for (i = 0; i < reps; i++)
+			(*valp)[filled++] = value;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(*valp);
+	return SLURM_ERROR;
+}
+
+static void _pack32_array_rle(uint32_t *array, uint32_t cnt, Buf buffer)
+{
+	uint32_t i = 0, reps;
+
+	pack32(cnt, buffer);
+	while (i < cnt) {
+		reps = 1;
+		while (((i + reps) < cnt) && (array[i + reps] == array[i]))
+			reps++;
+		pack32(reps, buffer);
+		pack32(array[i], buffer);
+		i += reps;
+	}
+}
+
+static int _unpack32_array_rle(uint32_t **valp, uint32_t *size_val,
+			       Buf buffer)
+{
+	uint32_t cnt, filled = 0, reps, i;
+	uint32_t value;
+
+	*valp = NULL;
+	safe_unpack32(&cnt, buffer);
+	*size_val = cnt;
+	if (cnt == 0)
+		return SLURM_SUCCESS;
+	*valp = xmalloc(cnt * sizeof(uint32_t));
+	while (filled < cnt) {
+		safe_unpack32(&reps, buffer);
+		safe_unpack32(&value, buffer);
+		if ((reps == 0) || (reps > (cnt - filled)))
+			goto unpack_error;
+		for (i = 0; i < reps; i++)
+			(*valp)[filled++] = value;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(*valp);
+	return SLURM_ERROR;
+}
+
 extern void pack_job_resources(job_resources_t *job_resrcs_ptr, Buf buffer,
 			       uint16_t protocol_version)
 {
 	uint32_t cluster_flags = slurmdb_setup_cluster_flags();
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		if (job_resrcs_ptr == NULL) {
+			uint32_t empty = NO_VAL;
+			pack32(empty, buffer);
+			return;
+		}
+
+		pack32(job_resrcs_ptr->nhosts, buffer);
+		pack32(job_resrcs_ptr->ncpus, buffer);
+		pack32(job_resrcs_ptr->node_req, buffer);
+		packstr(job_resrcs_ptr->nodes, buffer);
+		pack8(job_resrcs_ptr->whole_node, buffer);
+
+		if (job_resrcs_ptr->cpu_array_reps)
+			pack32_array(job_resrcs_ptr->cpu_array_reps,
+				     job_resrcs_ptr->cpu_array_cnt, buffer);
+		else
+			pack32_array(job_resrcs_ptr->cpu_array_reps, 0, buffer);
+
+		if (job_resrcs_ptr->cpu_array_value)
+			pack16_array(job_resrcs_ptr->cpu_array_value,
+				     job_resrcs_ptr->cpu_array_cnt, buffer);
+		else
+			pack16_array(job_resrcs_ptr->cpu_array_value,
+				     0, buffer);
+
+		if (job_resrcs_ptr->cpus)
+			_pack16_array_rle(job_resrcs_ptr->cpus,
+					  job_resrcs_ptr->nhosts, buffer);
+		else
+			_pack16_array_rle(NULL, 0, buffer);
+
+		if (job_resrcs_ptr->cpus_used)
+			_pack16_array_rle(job_resrcs_ptr->cpus_used,
+					  job_resrcs_ptr->nhosts, buffer);
+		else
+			_pack16_array_rle(NULL, 0, buffer);
+
+		if (job_resrcs_ptr->memory_allocated)
+			_pack32_array_rle(job_resrcs_ptr->memory_allocated,
+					  job_resrcs_ptr->nhosts, buffer);
+		else
+			_pack32_array_rle(NULL, 0, buffer);
+
+		if (job_resrcs_ptr->memory_used)
+			_pack32_array_rle(job_resrcs_ptr->memory_used,
+					  job_resrcs_ptr->nhosts, buffer);
+		else
+			_pack32_array_rle(NULL, 0, buffer);
+		if (!(cluster_flags & CLUSTER_FLAG_BG)) {
+			int i;
+			uint32_t core_cnt = 0, sock_recs = 0;
+			xassert(job_resrcs_ptr->cores_per_socket);
+			xassert(job_resrcs_ptr->sock_core_rep_count);
+			xassert(job_resrcs_ptr->sockets_per_node);
+
+			for (i=0; i<job_resrcs_ptr->nhosts; i++) {
+				core_cnt += job_resrcs_ptr->sockets_per_node[i]
+					* job_resrcs_ptr->cores_per_socket[i] *
+					job_resrcs_ptr->sock_core_rep_count[i];
+				sock_recs += job_resrcs_ptr->
+					     sock_core_rep_count[i];
+				if (sock_recs >= job_resrcs_ptr->nhosts)
+					break;
+			}
+			i++;
+			pack16_array(job_resrcs_ptr->sockets_per_node,
+				     (uint32_t) i, buffer);
+			pack16_array(job_resrcs_ptr->cores_per_socket,
+				     (uint32_t) i, buffer);
+			pack32_array(job_resrcs_ptr->sock_core_rep_count,
+				     (uint32_t) i, buffer);
+
+			xassert(job_resrcs_ptr->core_bitmap);
+			xassert(job_resrcs_ptr->core_bitmap_used);
+			pack_bit_str_raw(job_resrcs_ptr->core_bitmap, buffer);
+			pack_bit_str_raw(job_resrcs_ptr->core_bitmap_used,
+					 buffer);
+		}
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		if (job_resrcs_ptr == NULL) {
 			uint32_t empty = NO_VAL;
 			pack32(empty, buffer);
@@ -630,7 +801,68 @@ extern int unpack_job_resources(job_resources_t **job_resrcs_pptr,
 	uint32_t cluster_flags = slurmdb_setup_cluster_flags();
 
 	xassert(job_resrcs_pptr);
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		safe_unpack32(&empty, buffer);
+		if (empty == NO_VAL) {
+			*job_resrcs_pptr = NULL;
+			return SLURM_SUCCESS;
+		}
+
+		job_resrcs = xmalloc(sizeof(struct job_resources));
+		job_resrcs->nhosts = empty;
+		safe_unpack32(&job_resrcs->ncpus, buffer);
+		safe_unpack32(&job_resrcs->node_req, buffer);
+		safe_unpackstr_xmalloc(&job_resrcs->nodes, &tmp32, buffer);
+		safe_unpack8(&job_resrcs->whole_node, buffer);
+
+		safe_unpack32_array(&job_resrcs->cpu_array_reps,
+				    &tmp32, buffer);
+		if (tmp32 == 0)
+			xfree(job_resrcs->cpu_array_reps);
+		job_resrcs->cpu_array_cnt = tmp32;
+
+		safe_unpack16_array(&job_resrcs->cpu_array_value,
+				    &tmp32, buffer);
+		if (tmp32 == 0)
+			xfree(job_resrcs->cpu_array_value);
+
+		if (tmp32 != job_resrcs->cpu_array_cnt)
+			goto unpack_error;
+
+		if (_unpack16_array_rle(&job_resrcs->cpus, &tmp32, buffer))
+			goto unpack_error;
+		if (tmp32 != job_resrcs->nhosts)
+			goto unpack_error;
+		if (_unpack16_array_rle(&job_resrcs->cpus_used, &tmp32,
+					buffer))
+			goto unpack_error;
+
+		if (_unpack32_array_rle(&job_resrcs->memory_allocated,
+					&tmp32, buffer))
+			goto unpack_error;
+		if (_unpack32_array_rle(&job_resrcs->memory_used, &tmp32,
+					buffer))
+			goto unpack_error;
+
+		if (!(cluster_flags & CLUSTER_FLAG_BG)) {
+			safe_unpack16_array(&job_resrcs->sockets_per_node,
+					    &tmp32, buffer);
+			if (tmp32 == 0)
+				xfree(job_resrcs->sockets_per_node);
+			safe_unpack16_array(&job_resrcs->cores_per_socket,
+					    &tmp32, buffer);
+			if (tmp32 == 0)
+				xfree(job_resrcs->cores_per_socket);
+			safe_unpack32_array(&job_resrcs->sock_core_rep_count,
+					    &tmp32, buffer);
+			if (tmp32 == 0)
+				xfree(job_resrcs->sock_core_rep_count);
+
+			unpack_bit_str_raw(&job_resrcs->core_bitmap, buffer);
+			unpack_bit_str_raw(&job_resrcs->core_bitmap_used,
+					   buffer);
+		}
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		safe_unpack32(&empty, buffer);
 		if (empty == NO_VAL) {
 			*job_resrcs_pptr = NULL;
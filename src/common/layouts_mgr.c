@@ -772,6 +772,82 @@ int _layouts_entity_pullget_kv_ref(layout_t* l, entity_t* e,
 	return rc;
 }
 
+int _layouts_entities_get_kv(layout_t* l, char** entities, int count,
+			     char* key, void* value,
+			     layouts_keydef_types_t key_type)
+{
+	layouts_keydef_t* keydef;
+	char key_keydef[PATHLEN];
+	size_t elt_size;
+	entity_t* e;
+	void* data;
+	void* slot;
+	char** pstr;
+	int i, rc = 0;
+
+	if (l == NULL || entities == NULL || key == NULL || value == NULL)
+		return count;
+
+	/* normalize the key and resolve the keyspec only once for the
+	 * full entity set, each entity lookup then being a single hash
+	 * table access plus the data retrieval. */
+	_normalize_keydef_key(key_keydef, PATHLEN, key, l->type);
+	keydef = xhash_get(mgr->keydefs, key_keydef);
+	if (keydef == NULL)
+		return count;
+	if (key_type > 0 && keydef->type != key_type)
+		return count;
+
+	switch(keydef->type) {
+	case L_T_ERROR:
+	case L_T_CUSTOM:
+		return count;
+	case L_T_STRING:
+		elt_size = sizeof(char*);
+		break;
+	case L_T_LONG:
+		elt_size = sizeof(long);
+		break;
+	case L_T_UINT16:
+		elt_size = sizeof(uint16_t);
+		break;
+	case L_T_UINT32:
+		elt_size = sizeof(uint32_t);
+		break;
+	case L_T_BOOLEAN:
+		elt_size = sizeof(bool);
+		break;
+	case L_T_FLOAT:
+		elt_size = sizeof(float);
+		break;
+	case L_T_DOUBLE:
+		elt_size = sizeof(double);
+		break;
+	case L_T_LONG_DOUBLE:
+		elt_size = sizeof(long double);
+		break;
+	}
+
+	for (i = 0; i < count; i++) {
+		slot = value + (elt_size * i);
+		e = xhash_get(mgr->entities, entities[i]);
+		data = (e) ? entity_get_data_ref(e, key_keydef) : NULL;
+		if (data == NULL) {
+			/* keep the buffer aligned with the input set */
+			memset(slot, 0, elt_size);
+			rc++;
+			continue;
+		}
+		if (keydef->type == L_T_STRING) {
+			pstr = (char**) slot;
+			*pstr = xstrdup(data);
+		} else
+			memcpy(slot, data, elt_size);
+	}
+
+	return rc;
+}
+
 /*****************************************************************************\
  *                                MANAGER INIT                               *
 \*****************************************************************************/
@@ -2821,3 +2897,16 @@ int layouts_entity_pullget_kv_ref(char* l, char* e, char* key, void** value,
 	_layouts_entity_wrapper(_layouts_entity_pullget_kv_ref, l, e,
 				key, value, key_type);
 }
+
+int layouts_entities_get_kv(char* l, char** entities, int count, char* key,
+			    void* value, layouts_keydef_types_t key_type)
+{
+	layout_t* layout;
+	int rc;
+	slurm_mutex_lock(&mgr->lock);
+	layout = layouts_get_layout_nolock(l);
+	rc = _layouts_entities_get_kv(layout, entities, count, key,
+				      value, key_type);
+	slurm_mutex_unlock(&mgr->lock);
+	return rc;
+}
@@ -495,4 +495,30 @@ int layouts_entity_get_mkv_ref(char* layout, char* entity,
 			       char* keys, void* buffer, size_t length,
 			       layouts_keydef_types_t key_type);
 
+/*
+ * layouts_entities_get_kv - get the value associated with a single key for a
+ *        whole set of entities of a particular layout in one call.
+ *
+ * The manager lock is taken once and the keyspec associated with the key is
+ * resolved once for the full set, so fetching the same key for a large group
+ * of entities (e.g. one value per node of the cluster) avoids the per-call
+ * locking and key normalization cost of iterated layouts_entity_get_kv calls.
+ *
+ * The input key_type will force the call to check types consistency between
+ * the requester and the underlying keyspec associated with the key. To skip
+ * that check the caller will have to pass a 0 value.
+ *
+ * Note : the destination buffer is filled with one element per input entity,
+ * in the input order, so it must be able to store count elements of the key
+ * type. The slots of entities for which the value could not be retrieved are
+ * zeroed and counted in the return value, keeping the buffer aligned with
+ * the input set. See layouts_entity_get_kv for the handling of L_T_STRING
+ * values, L_T_CUSTOM is not supported by this call.
+ *
+ * Return SLURM_SUCCES or the count of missed entities
+ */
+int layouts_entities_get_kv(char* layout, char** entities, int count,
+			    char* key, void* value,
+			    layouts_keydef_types_t key_type);
+
 #endif /* end of include guard: __LAYOUTS_MGR_1NRINRSD__INC__ */
@@ -54,6 +54,7 @@
 ** for details.
 */
 strong_alias(list_create,	slurm_list_create);
+strong_alias(list_create_sized,	slurm_list_create_sized);
 strong_alias(list_destroy,	slurm_list_destroy);
 strong_alias(list_is_empty,	slurm_list_is_empty);
 strong_alias(list_count,	slurm_list_count);
@@ -66,6 +67,7 @@ strong_alias(list_delete_all,	slurm_list_delete_all);
 strong_alias(list_for_each,	slurm_list_for_each);
 strong_alias(list_flush,	slurm_list_flush);
 strong_alias(list_sort,		slurm_list_sort);
+strong_alias(list_insert_sorted, slurm_list_insert_sorted);
 strong_alias(list_push,		slurm_list_push);
 strong_alias(list_pop,		slurm_list_pop);
 strong_alias(list_peek,		slurm_list_peek);
@@ -118,6 +120,11 @@ struct listNode {
 	struct listNode      *next;         /* next node in list                 */
 };
 
+struct listNodeBlock {
+	struct listNodeBlock *next;         /* block chain for bulk free         */
+	struct listNode       nodes[1];     /* variable length node array        */
+};
+
 struct listIterator {
 	struct list          *list;         /* the list being iterated           */
 	struct listNode      *pos;          /* the next node to be iterated      */
@@ -134,6 +141,9 @@ struct list {
 	struct listIterator  *iNext;        /* iterator chain for list_destroy() */
 	ListDelF              fDel;         /* function to delete node data      */
 	int                   count;        /* number of nodes in list           */
+	struct listNode      *nodeFree;     /* per-list free node chain          */
+	struct listNodeBlock *nodeBlocks;   /* node block chain for bulk free    */
+	int                   nodeHint;     /* size hint for first node block    */
 	pthread_mutex_t       mutex;        /* mutex to protect access to list   */
 #ifndef NDEBUG
 	unsigned int          magic;        /* sentinel for asserting validity   */
@@ -151,8 +161,8 @@ static void * list_node_create (List l, ListNode *pp, void *x);
 static void * list_node_destroy (List l, ListNode *pp);
 static List list_alloc (void);
 static void list_free (List l);
-static ListNode list_node_alloc (void);
-static void list_node_free (ListNode p);
+static ListNode list_node_alloc (List l);
+static void list_node_free (List l, ListNode p);
 static ListIterator list_iterator_alloc (void);
 static void list_iterator_free (ListIterator i);
 static void * list_alloc_aux (int size, void *pfreelist);
@@ -169,7 +179,6 @@ static int _list_mutex_is_locked (pthread_mutex_t *mutex);
  ***************/
 
 static List list_free_lists = NULL;
-static ListNode list_free_nodes = NULL;
 static ListIterator list_free_iterators = NULL;
 
 static pthread_mutex_t list_free_lock = PTHREAD_MUTEX_INITIALIZER;
@@ -190,12 +199,28 @@ list_create (ListDelF f)
 	l->iNext = NULL;
 	l->fDel = f;
 	l->count = 0;
+	l->nodeFree = NULL;
+	l->nodeBlocks = NULL;
+	l->nodeHint = 0;
 	slurm_mutex_init(&l->mutex);
 	assert(l->magic = LIST_MAGIC);      /* set magic via assert abuse */
 
 	return l;
 }
 
+/* list_create_sized()
+ */
+List
+list_create_sized (ListDelF f, int size_hint)
+{
+	List l = list_create(f);
+
+	if (size_hint > 0)
+		l->nodeHint = size_hint;
+
+	return l;
+}
+
 /* list_destroy()
  */
 void
@@ -203,6 +228,7 @@ list_destroy (List l)
 {
 	ListIterator i, iTmp;
 	ListNode p, pTmp;
+	struct listNodeBlock *b, *bTmp;
 
 	assert(l != NULL);
 	slurm_mutex_lock(&l->mutex);
@@ -221,9 +247,15 @@ list_destroy (List l)
 		pTmp = p->next;
 		if (p->data && l->fDel)
 			l->fDel(p->data);
-		list_node_free(p);
 		p = pTmp;
 	}
+	/* All nodes live in the per-list blocks, free them in bulk */
+	b = l->nodeBlocks;
+	while (b) {
+		bTmp = b->next;
+		xfree(b);
+		b = bTmp;
+	}
 	assert(l->magic = ~LIST_MAGIC);     /* clear magic via assert abuse */
 	slurm_mutex_unlock(&l->mutex);
 	slurm_mutex_destroy(&l->mutex);
@@ -476,14 +508,36 @@ list_push (List l, void *x)
  * This function uses the libC qsort().
  *
  */
+/* Merge two sorted node chains into a single sorted chain, ordered by
+ * [f]. Stable: on ties, nodes from [a] precede nodes from [b].
+ * NOTE: [f] receives pointers to the data pointers, as with qsort(),
+ * since every existing comparator dereferences its arguments. */
+static ListNode _list_merge(ListNode a, ListNode b, ListCmpF f)
+{
+	struct listNode head;
+	ListNode tail = &head;
+
+	while (a && b) {
+		if (f(&a->data, &b->data) <= 0) {
+			tail->next = a;
+			a = a->next;
+		} else {
+			tail->next = b;
+			b = b->next;
+		}
+		tail = tail->next;
+	}
+	tail->next = a ? a : b;
+	return head.next;
+}
+
 void
 list_sort(List l, ListCmpF f)
 {
-	char **v;
-	int n;
-	int lsize;
-	void *e;
+	ListNode bin[32], run, next;
+	ListNode *pp;
 	ListIterator i;
+	int n;
 
 	assert(l != NULL);
 	assert(f != NULL);
@@ -495,22 +549,31 @@ list_sort(List l, ListCmpF f)
 		return;
 	}
 
-	lsize = l->count;
-	v = xmalloc(lsize * sizeof(char *));
-
-	n = 0;
-	while ((e = _list_pop_locked(l))) {
-		v[n] = e;
-		++n;
+	/* Bottom-up merge sort directly over the linked nodes, no
+	 * auxiliary array. bin[n] holds a sorted run of 2^n nodes (or
+	 * NULL); each node pulled off the list is merged up the bins
+	 * like a carry propagating through a binary counter. */
+	memset(bin, 0, sizeof(bin));
+	run = l->head;
+	while (run) {
+		next = run->next;
+		run->next = NULL;
+		for (n = 0; (n < 31) && bin[n]; n++) {
+			run = _list_merge(bin[n], run, f);
+			bin[n] = NULL;
+		}
+		bin[n] = run;
+		run = next;
 	}
-
-	qsort(v, n, sizeof(char *), (__compar_fn_t)f);
-
-	for (n = 0; n < lsize; n++) {
-		_list_append_locked(l, v[n]);
+	run = NULL;
+	for (n = 0; n < 32; n++) {
+		if (!bin[n])
+			continue;
+		run = run ? _list_merge(bin[n], run, f) : bin[n];
 	}
-
-	xfree(v);
+	l->head = run;
+	for (pp = &l->head; *pp; pp = &(*pp)->next) {;}
+	l->tail = pp;
 
 	/* Reset all iterators on the list to point
 	 * to the head of the list.
@@ -524,6 +587,29 @@ list_sort(List l, ListCmpF f)
 	slurm_mutex_unlock(&l->mutex);
 }
 
+/* list_insert_sorted()
+ */
+void *
+list_insert_sorted(List l, void *x, ListCmpF f)
+{
+	void *v;
+	ListNode *pp;
+
+	assert(l != NULL);
+	assert(x != NULL);
+	assert(f != NULL);
+	slurm_mutex_lock(&l->mutex);
+	assert(l->magic == LIST_MAGIC);
+
+	pp = &l->head;
+	while (*pp && (f(&x, &(*pp)->data) >= 0))
+		pp = &(*pp)->next;
+	v = list_node_create(l, pp, x);
+
+	slurm_mutex_unlock(&l->mutex);
+	return v;
+}
+
 /* list_pop()
  */
 void *
@@ -793,7 +879,7 @@ list_node_create (List l, ListNode *pp, void *x)
 	assert(pp != NULL);
 	assert(x != NULL);
 
-	p = list_node_alloc();
+	p = list_node_alloc(l);
 
 	p->data = x;
 	if (!(p->next = *pp))
@@ -851,7 +937,7 @@ list_node_destroy (List l, ListNode *pp)
 		assert((i->pos == *i->prev) ||
 		       ((*i->prev) && (i->pos == (*i->prev)->next)));
 	}
-	list_node_free(p);
+	list_node_free(l, p);
 
 	return v;
 }
@@ -873,19 +959,45 @@ list_free (List l)
 }
 
 /* list_node_alloc()
+ *
+ * Allocates a node from the per-list pool, growing it by a block when
+ * empty. The caller must hold the list mutex, so unlike the shared
+ * freelists no extra lock is needed on this path. Nodes are returned
+ * to the pool by list_node_free() and the blocks are freed in bulk by
+ * list_destroy().
  */
 static ListNode
-list_node_alloc (void)
+list_node_alloc (List l)
 {
-	return(list_alloc_aux(sizeof(struct listNode), &list_free_nodes));
+	ListNode p;
+	struct listNodeBlock *b;
+	int i, block_nodes;
+
+	if (!l->nodeFree) {
+		block_nodes = (l->nodeHint > 0) ? l->nodeHint : LIST_ALLOC;
+		l->nodeHint = 0;	/* hint applies to first block only */
+		b = xmalloc(sizeof(struct listNodeBlock) +
+			    ((block_nodes - 1) * sizeof(struct listNode)));
+		b->next = l->nodeBlocks;
+		l->nodeBlocks = b;
+		for (i = 0; i < (block_nodes - 1); i++)
+			b->nodes[i].next = &b->nodes[i + 1];
+		b->nodes[block_nodes - 1].next = NULL;
+		l->nodeFree = &b->nodes[0];
+	}
+	p = l->nodeFree;
+	l->nodeFree = p->next;
+
+	return p;
 }
 
 /* list_node_free()
  */
 static void
-list_node_free (ListNode p)
+list_node_free (List l, ListNode p)
 {
-	list_free_aux(p, &list_free_nodes);
+	p->next = l->nodeFree;
+	l->nodeFree = p;
 }
 
 /* list_iterator_alloc()
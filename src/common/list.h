@@ -109,6 +109,13 @@ List list_create (ListDelF f);
  *    in a memory leak.
  */
 
+List list_create_sized (ListDelF f, int size_hint);
+/*
+ *  Equivalent to list_create(), but [size_hint] gives the expected number
+ *    of items so the first list node block can be allocated to size,
+ *    avoiding incremental pool growth for large lists.
+ */
+
 void list_destroy (List l);
 /*
  *  Destroys list [l], freeing memory used for list iterators and the
@@ -197,7 +204,17 @@ void list_sort (List l, ListCmpF f);
 /*
  *  Sorts list [l] into ascending order according to the function [f].
  *  Note: Sorting a list resets all iterators associated with the list.
- *  This function uses the libC qsort() algorithm.
+ *  The sort is performed in-place over the linked nodes (stable
+ *    merge sort, no auxiliary array).
+ */
+
+void * list_insert_sorted (List l, void *x, ListCmpF f);
+/*
+ *  Inserts data [x] into list [l] before the first item that compares
+ *    greater according to [f], keeping a list that is sorted by [f]
+ *    sorted without a full re-sort.
+ *  As with list_sort(), [f] receives pointers to the item pointers.
+ *  Returns the data's ptr, or lsd_nomem_error() if insertion failed.
  */
 
 /****************************
@@ -100,6 +100,7 @@ strong_alias(log_fatal,		slurm_log_fatal);
 strong_alias(log_oom,		slurm_log_oom);
 strong_alias(log_has_data,	slurm_log_has_data);
 strong_alias(log_flush,		slurm_log_flush);
+strong_alias(log_set_async,	slurm_log_set_async);
 strong_alias(dump_cleanup_list,	slurm_dump_cleanup_list);
 strong_alias(fatal_add_cleanup,	slurm_fatal_add_cleanup);
 strong_alias(fatal_add_cleanup_job,	slurm_fatal_add_cleanup_job);
@@ -474,6 +475,7 @@ void log_fini(void)
 	if (!log)
 		return;
 
+	log_set_async(false);
 	slurm_mutex_lock(&log_lock);
 	_log_flush(log);
 	xfree(log->argv0);
@@ -953,6 +955,149 @@ _log_printf(log_t *log, cbuf_t cb, FILE *stream, const char *fmt, ...)
 
 }
 
+/*
+ * Asynchronous logging: when enabled, fully formatted log file lines are
+ * queued on a fixed depth ring and a dedicated writer thread drains them,
+ * so callers never block on log file I/O (_log_printf() may poll the
+ * descriptor for several seconds). Lines arriving while the ring is full
+ * are dropped and counted, the writer reports the count once it catches
+ * up. Lock order: log_lock before async_mutex, the writer never holds
+ * both at once.
+ */
+#define LOG_ASYNC_DEPTH 4096
+
+static char     *async_lines[LOG_ASYNC_DEPTH];
+static int       async_head = 0;	/* next slot to fill  */
+static int       async_tail = 0;	/* next slot to drain */
+static int       async_count = 0;	/* lines in the ring  */
+static uint32_t  async_dropped = 0;	/* lines lost to overflow */
+static bool      async_active = false;
+static bool      async_shutdown = false;
+static pid_t     async_pid = 0;		/* process owning the writer */
+static pthread_t async_writer = 0;
+static pthread_mutex_t async_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  async_cond    = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  async_drained = PTHREAD_COND_INITIALIZER;
+
+/* Queue a formatted log file line for the writer thread, taking ownership
+ * of it (dropped lines are freed here). Returns false if asynchronous
+ * logging is not active in this process and the caller must write the
+ * line itself, e.g. in a forked child which did not inherit the writer. */
+static bool _log_async_enqueue(char *line)
+{
+	bool queued = false;
+
+	slurm_mutex_lock(&async_mutex);
+	if (async_active && (async_pid == getpid())) {
+		if (async_count < LOG_ASYNC_DEPTH) {
+			async_lines[async_head] = line;
+			async_head = (async_head + 1) % LOG_ASYNC_DEPTH;
+			async_count++;
+			slurm_cond_signal(&async_cond);
+		} else {
+			async_dropped++;
+			xfree(line);
+		}
+		queued = true;
+	}
+	slurm_mutex_unlock(&async_mutex);
+	return queued;
+}
+
+/* Wait for the writer thread to empty the ring. No-op off the owning
+ * process or on the writer thread itself. */
+static void _log_async_drain(void)
+{
+	slurm_mutex_lock(&async_mutex);
+	if (async_active && (async_pid == getpid()) &&
+	    !pthread_equal(async_writer, pthread_self())) {
+		while (async_count) {
+			slurm_cond_signal(&async_cond);
+			slurm_cond_wait(&async_drained, &async_mutex);
+		}
+	}
+	slurm_mutex_unlock(&async_mutex);
+}
+
+static void *_log_async_writer(void *arg)
+{
+	char *line;
+	uint32_t dropped;
+
+	slurm_mutex_lock(&async_mutex);
+	while (!async_shutdown || async_count) {
+		if (!async_count) {
+			slurm_cond_broadcast(&async_drained);
+			slurm_cond_wait(&async_cond, &async_mutex);
+			continue;
+		}
+		line = async_lines[async_tail];
+		async_tail = (async_tail + 1) % LOG_ASYNC_DEPTH;
+		async_count--;
+		dropped = 0;
+		if (async_dropped && (async_count == 0)) {
+			/* caught up, report the overflow */
+			dropped = async_dropped;
+			async_dropped = 0;
+		}
+		slurm_mutex_unlock(&async_mutex);
+
+		slurm_mutex_lock(&log_lock);
+		if (LOG_INITIALIZED && log->logfp) {
+			_log_printf(log, log->fbuf, log->logfp, "%s\n", line);
+			if (dropped)
+				_log_printf(log, log->fbuf, log->logfp,
+					    "%s: error: %u log messages "
+					    "dropped on ring overflow\n",
+					    log->argv0, dropped);
+			fflush(log->logfp);
+		}
+		slurm_mutex_unlock(&log_lock);
+		xfree(line);
+
+		slurm_mutex_lock(&async_mutex);
+	}
+	slurm_cond_broadcast(&async_drained);
+	slurm_mutex_unlock(&async_mutex);
+	return NULL;
+}
+
+/* see log.h for documentation */
+void log_set_async(bool enable)
+{
+	slurm_mutex_lock(&async_mutex);
+	if (enable && !async_active) {
+		pthread_attr_t attr;
+
+		async_shutdown = false;
+		async_head = async_tail = async_count = 0;
+		async_dropped = 0;
+		slurm_attr_init(&attr);
+		if (pthread_create(&async_writer, &attr,
+				   _log_async_writer, NULL)) {
+			slurm_attr_destroy(&attr);
+			slurm_mutex_unlock(&async_mutex);
+			error("%s: pthread_create: %m", __func__);
+			return;
+		}
+		slurm_attr_destroy(&attr);
+		async_pid = getpid();
+		async_active = true;
+		slurm_mutex_unlock(&async_mutex);
+	} else if (!enable && async_active) {
+		pthread_t writer = async_writer;
+		bool join = (async_pid == getpid());
+
+		async_active = false;	/* new messages go inline */
+		async_shutdown = true;
+		slurm_cond_signal(&async_cond);
+		slurm_mutex_unlock(&async_mutex);
+		if (join)
+			pthread_join(writer, NULL);
+	} else
+		slurm_mutex_unlock(&async_mutex);
+}
+
 /*
  * log a message at the specified level to facilities that have been
  * configured to receive messages at that level
@@ -1064,10 +1209,16 @@ static void log_msg(log_level_t level, const char *fmt, va_list args)
 	if ((level <= log->opt.logfile_level) && (log->logfp != NULL)) {
 
 		xlogfmtcat(&msgbuf, "[%M] %s%s%s", log->fpfx, pfx, buf);
-		_log_printf(log, log->fbuf, log->logfp, "%s\n", msgbuf);
-		fflush(log->logfp);
-
-		xfree(msgbuf);
+		/* fatal() messages are written synchronously since the
+		 * process is about to exit */
+		if ((level == LOG_LEVEL_FATAL) ||
+		    !_log_async_enqueue(msgbuf)) {
+			_log_printf(log, log->fbuf, log->logfp, "%s\n",
+				    msgbuf);
+			fflush(log->logfp);
+			xfree(msgbuf);
+		}
+		msgbuf = NULL;
 	}
 
 	if (level <=  log->opt.syslog_level) {
@@ -1111,6 +1262,7 @@ _log_flush(log_t *log)
 void
 log_flush()
 {
+	_log_async_drain();
 	slurm_mutex_lock(&log_lock);
 	_log_flush(log);
 	slurm_mutex_unlock(&log_lock);
@@ -226,6 +226,18 @@ bool log_has_data(void);
  */
 void log_flush(void);
 
+/*
+ * Enable or disable asynchronous logging to the log file. When enabled,
+ * formatted messages are queued on a fixed depth ring and drained to the
+ * log file by a dedicated writer thread, so logging threads never block
+ * on log file I/O. Messages arriving while the ring is full are dropped
+ * and counted, the count is reported once the writer catches up. fatal()
+ * messages are always written synchronously and log_flush() waits for
+ * the ring to empty. Intended for the daemons, forked children fall back
+ * to synchronous writes automatically.
+ */
+void log_set_async(bool enable);
+
 /* log_set_debug_flags()
  * Set or reset the debug flags based on the configuration
  * file or the scontrol command.
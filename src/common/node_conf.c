@@ -79,6 +79,12 @@ time_t last_node_update = (time_t) 0;	/* time of last update */
 struct node_record *node_record_table_ptr = NULL;	/* node records */
 xhash_t* node_hash_table = NULL;
 int node_record_count = 0;		/* count in node_record_table_ptr */
+
+/* Auxiliary lookup hashes over NodeAddr and NodeHostName, built lazily
+ * on first use and discarded by reset_node_addr_hashes() whenever an
+ * address or hostname changes */
+static xhash_t *node_addr_hash_table = NULL;
+static xhash_t *node_hostname_hash_table = NULL;
 uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 
@@ -735,6 +741,111 @@ extern struct node_record *find_node_record_no_alias (char *name)
 	return _find_node_record(name, false, true);
 }
 
+/*
+ * xhash helper to index node_record per NodeAddr, falling back to the
+ * node name when no distinct address was configured
+ */
+static const char *_node_addr_hash_identity (void* item)
+{
+	struct node_record *node_ptr = (struct node_record *) item;
+
+	if (node_ptr->comm_name && node_ptr->comm_name[0])
+		return node_ptr->comm_name;
+	return node_ptr->name;
+}
+
+/*
+ * xhash helper to index node_record per NodeHostName, falling back to
+ * the node name when no distinct hostname was configured
+ */
+static const char *_node_hostname_hash_identity (void* item)
+{
+	struct node_record *node_ptr = (struct node_record *) item;
+
+	if (node_ptr->node_hostname && node_ptr->node_hostname[0])
+		return node_ptr->node_hostname;
+	return node_ptr->name;
+}
+
+/* Build an auxiliary hash table over the node records using the
+ * supplied identity function */
+static xhash_t *_build_node_aux_hash (xhash_idfunc_t idfunc)
+{
+	int i;
+	struct node_record *node_ptr = node_record_table_ptr;
+	xhash_t *new_table;
+
+	new_table = xhash_init(idfunc, NULL, NULL, node_record_count);
+	for (i = 0; i < node_record_count; i++, node_ptr++) {
+		if ((node_ptr->name == NULL) ||
+		    (node_ptr->name[0] == '\0'))
+			continue;	/* vestigial record */
+		xhash_add(new_table, node_ptr);
+	}
+	return new_table;
+}
+
+/*
+ * find_node_record_by_addr - find a record for node with specified
+ *	communication address (NodeAddr)
+ * IN: addr - communication address of the desired node
+ * RET: pointer to node record or NULL if not found
+ */
+extern struct node_record *find_node_record_by_addr (char *addr)
+{
+	struct node_record *node_ptr;
+
+	if ((addr == NULL) || (addr[0] == '\0'))
+		return NULL;
+
+	if (!node_addr_hash_table) {
+		node_addr_hash_table =
+			_build_node_aux_hash(_node_addr_hash_identity);
+	}
+
+	node_ptr = (struct node_record *) xhash_get(node_addr_hash_table,
+						    addr);
+	if (node_ptr)
+		xassert(node_ptr->magic == NODE_MAGIC);
+	return node_ptr;
+}
+
+/*
+ * find_node_record_by_hostname - find a record for node with specified
+ *	hostname (NodeHostName)
+ * IN: hostname - hostname of the desired node
+ * RET: pointer to node record or NULL if not found
+ */
+extern struct node_record *find_node_record_by_hostname (char *hostname)
+{
+	struct node_record *node_ptr;
+
+	if ((hostname == NULL) || (hostname[0] == '\0'))
+		return NULL;
+
+	if (!node_hostname_hash_table) {
+		node_hostname_hash_table =
+			_build_node_aux_hash(_node_hostname_hash_identity);
+	}
+
+	node_ptr = (struct node_record *) xhash_get(node_hostname_hash_table,
+						    hostname);
+	if (node_ptr)
+		xassert(node_ptr->magic == NODE_MAGIC);
+	return node_ptr;
+}
+
+/*
+ * reset_node_addr_hashes - discard the NodeAddr and NodeHostName lookup
+ *	hashes. Must be called whenever a node's address or hostname
+ *	changes; the hashes are rebuilt on next use.
+ */
+extern void reset_node_addr_hashes (void)
+{
+	xhash_free(node_addr_hash_table);
+	xhash_free(node_hostname_hash_table);
+}
+
 /*
  * _find_node_record - find a record for node with specified name
  * IN: name - name of the desired node
@@ -779,6 +890,12 @@ static struct node_record *_find_node_record (char *name, bool test_alias,
 	}
 
 	if (test_alias) {
+		/* the name may be the NodeHostName of a node rather than
+		 * its NodeName */
+		node_ptr = find_node_record_by_hostname(name);
+		if (node_ptr)
+			return node_ptr;
+
 		/* look for the alias node record if the user put this in
 	 	 * instead of what slurm sees the node name as */
 		return _find_alias_node_record(name, log_missing);
@@ -814,6 +931,7 @@ extern int init_node_conf (void)
 	node_record_count = 0;
 	xfree(node_record_table_ptr);
 	xhash_free(node_hash_table);
+	reset_node_addr_hashes();
 
 	if (config_list)	/* delete defunct configuration entries */
 		(void) _delete_config_record ();
@@ -838,6 +956,7 @@ extern void node_fini2 (void)
 	}
 
 	xhash_free(node_hash_table);
+	reset_node_addr_hashes();
 	node_ptr = node_record_table_ptr;
 	for (i = 0; i < node_record_count; i++, node_ptr++)
 		purge_node_rec(node_ptr);
@@ -910,7 +1029,7 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 {
 	int rc = SLURM_SUCCESS;
 	bitstr_t *my_bitmap;
-	char *name;
+	char name[HOSTLIST_NAME_LEN];
 	hostlist_iterator_t hi;
 
 	FREE_NULL_BITMAP(*bitmap);
@@ -918,7 +1037,7 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 	*bitmap = my_bitmap;
 
 	hi = hostlist_iterator_create(hl);
-	while ((name = hostlist_next(hi)) != NULL) {
+	while (hostlist_next_buf(hi, name, sizeof(name)) >= 0) {
 		struct node_record *node_ptr;
 		node_ptr = _find_node_record(name, best_effort, true);
 		if (node_ptr) {
@@ -930,7 +1049,6 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 			if (!best_effort)
 				rc = EINVAL;
 		}
-		free (name);
 	}
 
 	hostlist_iterator_destroy(hi);
@@ -974,8 +1092,11 @@ extern void rehash_node (void)
 	struct node_record *node_ptr = node_record_table_ptr;
 
 	xhash_free (node_hash_table);
+	/* the node table may have been rebuilt or reordered, so any
+	 * auxiliary indexes over it are stale as well */
+	reset_node_addr_hashes();
 	node_hash_table = xhash_init(node_record_hash_identity,
-				     NULL, NULL, 0);
+				     NULL, NULL, node_record_count);
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if ((node_ptr->name == NULL) ||
 		    (node_ptr->name[0] == '\0'))
@@ -93,6 +93,9 @@ struct node_record {
 					 * computed from up_time */
 	time_t slurmd_start_time;	/* Time of slurmd startup */
 	time_t last_response;		/* last response from the node */
+	uint16_t ping_streak;		/* consecutive ping cycles with timely
+					 * responses, used to stretch the
+					 * node's ping interval */
 	time_t last_idle;		/* time node last become idle */
 	uint16_t cpus;			/* count of processors on the node */
 	uint16_t boards; 		/* count of boards configured */
@@ -105,6 +108,9 @@ struct node_record {
 	uint32_t mem_spec_limit;	/* MB memory limit for specialization */
 	uint32_t tmp_disk;		/* MB total disk in TMP_FS */
 	uint32_t up_time;		/* seconds since node boot */
+	uint32_t config_digest;		/* digest of the static configuration
+					 * from the node's last full
+					 * registration */
 	struct config_record *config_ptr;  /* configuration spec ptr */
 	uint16_t part_cnt;		/* number of associated partitions */
 	struct part_record **part_pptr;	/* array of pointers to partitions
@@ -270,6 +276,29 @@ extern struct node_record *find_node_record2 (char *name);
  */
 extern struct node_record *find_node_record_no_alias (char *name);
 
+/*
+ * find_node_record_by_addr - find a record for node with specified
+ *	communication address (NodeAddr)
+ * IN: addr - communication address of the desired node
+ * RET: pointer to node record or NULL if not found
+ */
+extern struct node_record *find_node_record_by_addr (char *addr);
+
+/*
+ * find_node_record_by_hostname - find a record for node with specified
+ *	hostname (NodeHostName)
+ * IN: hostname - hostname of the desired node
+ * RET: pointer to node record or NULL if not found
+ */
+extern struct node_record *find_node_record_by_hostname (char *hostname);
+
+/*
+ * reset_node_addr_hashes - discard the NodeAddr and NodeHostName lookup
+ *	hashes. Must be called whenever a node's address or hostname
+ *	changes; the hashes are rebuilt on next use.
+ */
+extern void reset_node_addr_hashes (void);
+
 /*
  * hostlist2bitmap - given a hostlist, build a bitmap representation
  * IN hl          - hostlist
@@ -40,11 +40,15 @@
 \****************************************************************************/
 
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <netinet/in.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "slurm/slurm_errno.h"
 
@@ -58,9 +62,11 @@
  * for details.
  */
 strong_alias(create_buf,	slurm_create_buf);
+strong_alias(create_mmap_buf,	slurm_create_mmap_buf);
 strong_alias(free_buf,		slurm_free_buf);
 strong_alias(grow_buf,		slurm_grow_buf);
 strong_alias(init_buf,		slurm_init_buf);
+strong_alias(retain_buf,	slurm_retain_buf);
 strong_alias(xfer_buf_data,	slurm_xfer_buf_data);
 strong_alias(pack_time,		slurm_pack_time);
 strong_alias(unpack_time,	slurm_unpack_time);
@@ -90,6 +96,31 @@ strong_alias(unpackstr_array,	slurm_unpackstr_array);
 strong_alias(packmem_array,	slurm_packmem_array);
 strong_alias(unpackmem_array,	slurm_unpackmem_array);
 
+/* Ensure that at least "size" bytes of space remain in the buffer for
+ * packing, growing geometrically so that building a multi-MB dump costs
+ * a logarithmic number of realloc() calls rather than one per BUF_SIZE.
+ * RET true if the space is available */
+static bool _grow_pack_buf(Buf buffer, uint32_t size)
+{
+	uint64_t new_size;
+
+	if (buffer->mmaped) {
+		error("%s: mmap()'d buffers are fixed size", __func__);
+		return false;
+	}
+	new_size = MAX(((uint64_t) buffer->size) + size + BUF_SIZE,
+		       ((uint64_t) buffer->size) + (buffer->size / 2));
+	new_size = MIN(new_size, MAX_BUF_SIZE);
+	if ((new_size - buffer->processed) < size) {
+		error("%s: Buffer size limit exceeded (%u > %u)",
+		      __func__, (buffer->size + size), MAX_BUF_SIZE);
+		return false;
+	}
+	buffer->size = new_size;
+	xrealloc_nz(buffer->head, buffer->size);
+	return true;
+}
+
 /* Basic buffer management routines */
 /* create_buf - create a buffer with the supplied contents, contents must
  * be xalloc'ed */
@@ -108,6 +139,54 @@ Buf create_buf(char *data, int size)
 	my_buf->size = size;
 	my_buf->processed = 0;
 	my_buf->head = data;
+	my_buf->ref_cnt = 1;
+	my_buf->mmaped = 0;
+
+	return my_buf;
+}
+
+/* create_mmap_buf - create a read-only buffer backed by a mmap()'d file.
+ * The file contents are paged in by the kernel as the buffer is unpacked
+ * rather than copied up front. The buffer may not be grown or packed into.
+ * RET the buffer or NULL on error */
+Buf create_mmap_buf(char *file)
+{
+	Buf my_buf;
+	int fd;
+	struct stat f_stat;
+	void *data;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0) {
+		debug2("%s: Failed to open file %s: %m", __func__, file);
+		return NULL;
+	}
+	if (fstat(fd, &f_stat)) {
+		debug2("%s: Failed to stat file %s: %m", __func__, file);
+		(void) close(fd);
+		return NULL;
+	}
+	if (f_stat.st_size > MAX_BUF_SIZE) {
+		error("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
+		      __func__, (uint64_t) f_stat.st_size, MAX_BUF_SIZE);
+		(void) close(fd);
+		return NULL;
+	}
+
+	data = mmap(NULL, f_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	(void) close(fd);
+	if (data == MAP_FAILED) {
+		debug2("%s: Failed to mmap file %s: %m", __func__, file);
+		return NULL;
+	}
+
+	my_buf = xmalloc_nz(sizeof(struct slurm_buf));
+	my_buf->magic = BUF_MAGIC;
+	my_buf->size = f_stat.st_size;
+	my_buf->processed = 0;
+	my_buf->head = data;
+	my_buf->ref_cnt = 1;
+	my_buf->mmaped = 1;
 
 	return my_buf;
 }
@@ -116,13 +195,24 @@ Buf create_buf(char *data, int size)
 void free_buf(Buf my_buf)
 {
 	assert(my_buf->magic == BUF_MAGIC);
-	xfree(my_buf->head);
+	if (my_buf->ref_cnt > 1) {
+		my_buf->ref_cnt--;
+		return;
+	}
+	if (my_buf->mmaped)
+		(void) munmap(my_buf->head, my_buf->size);
+	else
+		xfree(my_buf->head);
 	xfree(my_buf);
 }
 
 /* Grow a buffer by the specified amount */
 void grow_buf (Buf buffer, int size)
 {
+	if (buffer->mmaped) {
+		error("%s: mmap()'d buffers are fixed size", __func__);
+		return;
+	}
 	if ((buffer->size + size) > MAX_BUF_SIZE) {
 		error("%s: Buffer size limit exceeded (%u > %u)",
 		      __func__, (buffer->size + size), MAX_BUF_SIZE);
@@ -150,9 +240,19 @@ Buf init_buf(int size)
 	my_buf->size = size;
 	my_buf->processed = 0;
 	my_buf->head = xmalloc(sizeof(char)*size);
+	my_buf->ref_cnt = 1;
+	my_buf->mmaped = 0;
 	return my_buf;
 }
 
+/* retain_buf - take an additional reference upon a buffer, each reference
+ * must be released with its own free_buf() call */
+void retain_buf(Buf my_buf)
+{
+	assert(my_buf->magic == BUF_MAGIC);
+	my_buf->ref_cnt++;
+}
+
 /* xfer_buf_data - return a pointer to the buffer's data and release the
  * buffer's structure */
 void *xfer_buf_data(Buf my_buf)
@@ -160,6 +260,8 @@ void *xfer_buf_data(Buf my_buf)
 	void *data_ptr;
 
 	assert(my_buf->magic == BUF_MAGIC);
+	assert(my_buf->ref_cnt == 1);
+	assert(!my_buf->mmaped);
 	data_ptr = (void *) my_buf->head;
 	xfree(my_buf);
 	return data_ptr;
@@ -174,14 +276,8 @@ void pack_time(time_t val, Buf buffer)
 	int64_t n64 = HTON_int64((int64_t) val);
 
 	if (remaining_buf(buffer) < sizeof(n64)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(n64)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &n64, sizeof(n64));
@@ -221,14 +317,8 @@ void 	packdouble(double val, Buf buffer)
 	uval.d =  (val * FLOAT_MULT);
 	nl =  HTON_uint64(uval.u);
 	if (remaining_buf(buffer) < sizeof(nl)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(nl)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &nl, sizeof(nl));
@@ -302,14 +392,8 @@ void pack64(uint64_t val, Buf buffer)
 	uint64_t nl =  HTON_uint64(val);
 
 	if (remaining_buf(buffer) < sizeof(nl)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(nl)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &nl, sizeof(nl));
@@ -341,14 +425,8 @@ void pack32(uint32_t val, Buf buffer)
 	uint32_t nl = htonl(val);
 
 	if (remaining_buf(buffer) < sizeof(nl)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(nl)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &nl, sizeof(nl));
@@ -521,14 +599,8 @@ void pack16(uint16_t val, Buf buffer)
 	uint16_t ns = htons(val);
 
 	if (remaining_buf(buffer) < sizeof(ns)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(ns)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &ns, sizeof(ns));
@@ -559,14 +631,8 @@ int unpack16(uint16_t * valp, Buf buffer)
 void pack8(uint8_t val, Buf buffer)
 {
 	if (remaining_buf(buffer) < sizeof(uint8_t)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(uint8_t)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &val, sizeof(uint8_t));
@@ -602,14 +668,8 @@ void packmem(char *valp, uint32_t size_val, Buf buffer)
 		return;
 	}
 	if (remaining_buf(buffer) < (sizeof(ns) + size_val)) {
-		if ((buffer->size + size_val + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + size_val + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, (sizeof(ns) + size_val)))
 			return;
-		}
-		buffer->size += (size_val + BUF_SIZE);
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &ns, sizeof(ns));
@@ -779,14 +839,8 @@ void packstr_array(char **valp, uint32_t size_val, Buf buffer)
 	uint32_t ns = htonl(size_val);
 
 	if (remaining_buf(buffer) < sizeof(ns)) {
-		if ((buffer->size + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, sizeof(ns)))
 			return;
-		}
-		buffer->size += BUF_SIZE;
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], &ns, sizeof(ns));
@@ -844,14 +898,8 @@ int unpackstr_array(char ***valp, uint32_t * size_valp, Buf buffer)
 void packmem_array(char *valp, uint32_t size_val, Buf buffer)
 {
 	if (remaining_buf(buffer) < size_val) {
-		if ((buffer->size + size_val + BUF_SIZE) > MAX_BUF_SIZE) {
-			error("%s: Buffer size limit exceeded (%u > %u)",
-			      __func__, (buffer->size + size_val + BUF_SIZE),
-			      MAX_BUF_SIZE);
+		if (!_grow_pack_buf(buffer, size_val))
 			return;
-		}
-		buffer->size += (size_val + BUF_SIZE);
-		xrealloc_nz(buffer->head, buffer->size);
 	}
 
 	memcpy(&buffer->head[buffer->processed], valp, size_val);
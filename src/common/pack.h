@@ -63,6 +63,11 @@ struct slurm_buf {
 	char *head;
 	uint32_t size;
 	uint32_t processed;
+	uint32_t ref_cnt;	/* free_buf() releases the buffer only when
+				 * this drops to zero, see retain_buf() */
+	uint16_t mmaped;	/* non-zero if head is a read-only mmap()'d
+				 * file rather than xmalloc()'d memory,
+				 * see create_mmap_buf() */
 };
 
 typedef struct slurm_buf * Buf;
@@ -74,9 +79,11 @@ typedef struct slurm_buf * Buf;
 #define size_buf(__buf)			(__buf->size)
 
 Buf	create_buf (char *data, int size);
+Buf	create_mmap_buf(char *file);
 void	free_buf(Buf my_buf);
 Buf	init_buf(int size);
 void    grow_buf (Buf my_buf, int size);
+void	retain_buf(Buf my_buf);
 void	*xfer_buf_data(Buf my_buf);
 
 void	pack_time(time_t val, Buf buffer);
@@ -413,9 +420,50 @@ int	unpackmem_array(char *valp, uint32_t size_valp, Buf buffer);
 		*bitmap = NULL;						\
 } while (0)
 
+/* NOTE: un/pack_bit_str_raw() stores the byte image of the bitmap,
+ * which is faster still than un/pack_bit_str_hex() on wide, dense
+ * bitmaps (no string to format or parse). The image uses a fixed bit
+ * order (see bit_fmt_raw()), so like the hex encoding it is portable
+ * between hosts of different endianness; both encodings remain version
+ * negotiated like any other field. */
+#define pack_bit_str_raw(bitmap,buf) do {		\
+	assert(buf->magic == BUF_MAGIC);		\
+	if (bitmap) {					\
+		char *_tmp_data;			\
+		uint32_t _size, _len;			\
+		_size = bit_size(bitmap);               \
+		pack32(_size, buf);              	\
+		_tmp_data = bit_fmt_raw(bitmap, &_len);	\
+		packmem(_tmp_data,_len,buf);	        \
+		xfree(_tmp_data);			\
+	} else						\
+		pack32(NO_VAL, buf);                 	\
+} while (0)
+
+#define unpack_bit_str_raw(bitmap,buf) do {				\
+	char *tmp_data = NULL;						\
+	uint32_t _size = NO_VAL, _len = 0;				\
+	assert(*bitmap == NULL);					\
+	assert(buf->magic == BUF_MAGIC);				\
+	safe_unpack32(&_size, buf);					\
+	if (_size != NO_VAL) {						\
+		*bitmap = bit_alloc(_size);				\
+		safe_unpackmem_xmalloc(&tmp_data, &_len, buf);		\
+		if (bit_unfmt_raw(*bitmap, tmp_data, _len)) {		\
+			xfree(tmp_data);				\
+			goto unpack_error;				\
+		}							\
+		xfree(tmp_data);					\
+	} else								\
+		*bitmap = NULL;						\
+} while (0)
+
 #define unpackstr_ptr		                        \
         unpackmem_ptr
 
+#define safe_unpackstr_ptr	                        \
+        safe_unpackmem_ptr
+
 #define unpackstr_malloc	                        \
         unpackmem_malloc
 
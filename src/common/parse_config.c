@@ -67,6 +67,7 @@ strong_alias(s_p_hashtbl_create,	slurm_s_p_hashtbl_create);
 strong_alias(s_p_hashtbl_destroy,	slurm_s_p_hashtbl_destroy);
 strong_alias(s_p_parse_buffer,		slurm_s_p_parse_buffer);
 strong_alias(s_p_parse_file,		slurm_s_p_parse_file);
+strong_alias(s_p_hash_file,		slurm_s_p_hash_file);
 strong_alias(s_p_parse_pair,		slurm_s_p_parse_pair);
 strong_alias(s_p_parse_line,		slurm_s_p_parse_line);
 strong_alias(s_p_hashtbl_merge, 	slurm_s_p_hashtbl_merge);
@@ -1170,6 +1171,66 @@ static int _parse_include_directive(s_p_hashtbl_t *hashtbl, uint32_t *hash_val,
 	}
 }
 
+int s_p_hash_file(uint32_t *hash_val, char *filename)
+{
+	FILE *f;
+	char *fn_start, *fn_stop, *file_name, *path_name, *ptr;
+	int merged_lines, rc = SLURM_SUCCESS;
+	struct stat stat_buf;
+	char *line = NULL;
+
+	if (!filename) {
+		error("s_p_hash_file: No filename given.");
+		return SLURM_ERROR;
+	}
+	if (stat(filename, &stat_buf) < 0) {
+		debug("s_p_hash_file: unable to status file %s: %m", filename);
+		return SLURM_ERROR;
+	}
+	if (stat_buf.st_size == 0)
+		return SLURM_SUCCESS;
+	f = fopen(filename, "r");
+	if (f == NULL) {
+		debug("s_p_hash_file: unable to read \"%s\": %m", filename);
+		return SLURM_ERROR;
+	}
+
+	/* Buffer needs one extra byte for trailing '\0' */
+	line = xmalloc(sizeof(char) * stat_buf.st_size + 1);
+	while ((merged_lines = _get_next_line(
+			line, stat_buf.st_size + 1, hash_val, f)) > 0) {
+		if (rc != SLURM_SUCCESS)
+			continue;	/* Just drain the hash computation */
+		if (strncasecmp("include", line, strlen("include")) ||
+		    !isspace((int) line[strlen("include")]))
+			continue;
+		/* Hash the included file as s_p_parse_file() would */
+		ptr = line + strlen("include");
+		while (isspace((int) *ptr))
+			ptr++;
+		fn_start = ptr;
+		while (*ptr && !isspace((int) *ptr))
+			ptr++;
+		fn_stop = ptr;
+		file_name = xstrndup(fn_start, fn_stop - fn_start);
+		if (strchr(file_name, '%')) {
+			/* "%" format specifiers require a full parse to
+			 * expand, the caller must not use this hash */
+			xfree(file_name);
+			rc = SLURM_ERROR;
+			continue;
+		}
+		path_name = _add_full_path(file_name, filename);
+		xfree(file_name);
+		rc = s_p_hash_file(hash_val, path_name);
+		xfree(path_name);
+	}
+
+	xfree(line);
+	fclose(f);
+	return rc;
+}
+
 int s_p_parse_file(s_p_hashtbl_t *hashtbl, uint32_t *hash_val, char *filename,
 		   bool ignore_new)
 {
@@ -307,6 +307,18 @@ void s_p_hashtbl_destroy(s_p_hashtbl_t *hashtbl);
 int s_p_parse_file(s_p_hashtbl_t *hashtbl, uint32_t *hash_val, char *filename,
 		   bool ignore_new);
 
+/* Compute the hash of a configuration file without parsing its contents,
+ * following "Include" directives as s_p_parse_file() does. Comparing the
+ * result with the hash accumulated by a prior s_p_parse_file() call detects
+ * any content change without the cost of a parse.
+ * OUT hash_val - cyclic redundancy check (CRC) character-wise value
+ *                of file, the caller must initialize it to zero
+ * Returns SLURM_SUCCESS if the file (and any included files) could be read
+ * and none of the include file names require "%" format expansion, in which
+ * case hash_val is not usable and a full parse is required.
+ */
+int s_p_hash_file(uint32_t *hash_val, char *filename);
+
 /* Returns SLURM_SUCCESS if buffer was opened and parse correctly.
  * buffer must be a valid Buf bufferonly containing strings.The parsing
  * stops at the first non string content extracted.
@@ -716,9 +716,16 @@ static char *_relative_date_fmt(const struct tm *when)
 extern void
 slurm_make_time_str (time_t *time, char *string, int size)
 {
+	/* localtime_r() takes a timezone lock on every call, which shows
+	 * up when formatting per record. Records tend to arrive in time
+	 * order, so keep the last broken-down minute and only derive the
+	 * seconds for hits; the offset can not change inside a minute. */
+	static time_t cached_minute = (time_t) -1;
+	static struct tm cached_tm;
+	static pthread_mutex_t tm_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 	struct tm time_tm;
+	time_t minute;
 
-	slurm_localtime_r(time, &time_tm);
 	if ((*time == (time_t) 0) || (*time == (time_t) INFINITE)) {
 		snprintf(string, size, "Unknown");
 	} else {
@@ -726,6 +733,22 @@ slurm_make_time_str (time_t *time, char *string, int size)
 		static const char *display_fmt;
 		static bool use_relative_format;
 
+		minute = *time - (*time % 60);
+		slurm_mutex_lock(&tm_cache_lock);
+		if (minute == cached_minute) {
+			time_tm = cached_tm;
+			time_tm.tm_sec = (int) (*time % 60);
+			slurm_mutex_unlock(&tm_cache_lock);
+		} else {
+			slurm_mutex_unlock(&tm_cache_lock);
+			slurm_localtime_r(time, &time_tm);
+			slurm_mutex_lock(&tm_cache_lock);
+			cached_tm = time_tm;
+			cached_tm.tm_sec = 0;
+			cached_minute = minute;
+			slurm_mutex_unlock(&tm_cache_lock);
+		}
+
 		if (!display_fmt) {
 			char *fmt = getenv("SLURM_TIME_FORMAT");
 
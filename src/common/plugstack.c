@@ -44,6 +44,7 @@
 #include <libgen.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include "src/common/plugin.h"
 #include "src/common/xmalloc.h"
@@ -192,11 +193,56 @@ struct spank_stack {
  */
 static struct spank_stack *global_spank_stack = NULL;
 
+/*
+ *  Registry of loaded plugin handles, keyed by plugin path and kept
+ *   for the lifetime of the process. A process which builds more than
+ *   one spank stack (e.g. srun's allocator and local contexts) pays
+ *   the cold dlopen/symbol resolution cost only once per plugin.
+ *   Handles are never dlclosed, the registry owns them until exit.
+ */
+struct spank_plugin_handle {
+	char *fq_path;
+	plugin_handle_t plugin;
+};
+
+static List spank_handle_registry = NULL;
+static pthread_mutex_t spank_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ *  Cache of the parsed plugstack.conf contents (resolved plugin paths
+ *   with their arguments, in stack order). Re-building a spank stack
+ *   in the same process replays these records instead of re-reading,
+ *   globbing and re-parsing the config files. The cache is validated
+ *   against the mtime of every file it was built from.
+ */
+struct spank_conf_file {
+	char *path;
+	time_t mtime;		/* 0 if the file did not exist */
+};
+
+struct spank_conf_line {
+	char *file;		/* config file the line came from */
+	int line;
+	char *path;		/* resolved plugin path */
+	int ac;
+	char **argv;
+	bool required;
+};
+
+static char *spank_conf_cache_path = NULL;
+static List spank_conf_cache_files = NULL; /* struct spank_conf_file */
+static List spank_conf_cache_lines = NULL; /* struct spank_conf_line */
+static pthread_mutex_t spank_conf_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  *  Forward declarations
  */
 static int _spank_plugin_options_cache(struct spank_plugin *p);
 static int _spank_stack_load (struct spank_stack *stack, const char *file);
+static int _spank_stack_build (struct spank_stack *stack, const char *file);
+static int _spank_stack_load_plugin (struct spank_stack *stack,
+		const char *file, int line, const char *path,
+		int ac, char **av, bool required);
 static void _spank_plugin_destroy (struct spank_plugin *);
 static void _spank_plugin_opt_destroy (struct spank_plugin_opt *);
 static int spank_stack_get_remote_options(struct spank_stack *, job_options_t);
@@ -204,6 +250,137 @@ static int spank_stack_get_remote_options_env (struct spank_stack *, char **);
 static int spank_stack_set_remote_options_env (struct spank_stack * stack);
 static int dyn_spank_set_job_env (const char *var, const char *val, int ovwt);
 
+/* Look up an already loaded plugin handle. Returns
+ * PLUGIN_INVALID_HANDLE if the plugin was not loaded before. */
+static plugin_handle_t _spank_registry_get (const char *fq_path)
+{
+	ListIterator i;
+	struct spank_plugin_handle *ph;
+	plugin_handle_t p = PLUGIN_INVALID_HANDLE;
+
+	slurm_mutex_lock (&spank_registry_mutex);
+	if (spank_handle_registry) {
+		i = list_iterator_create (spank_handle_registry);
+		while ((ph = list_next (i))) {
+			if (xstrcmp (ph->fq_path, fq_path) == 0) {
+				p = ph->plugin;
+				break;
+			}
+		}
+		list_iterator_destroy (i);
+	}
+	slurm_mutex_unlock (&spank_registry_mutex);
+	return (p);
+}
+
+static void _spank_registry_handle_del (void *x)
+{
+	struct spank_plugin_handle *ph = x;
+
+	if (ph) {
+		xfree (ph->fq_path);
+		xfree (ph);
+	}
+}
+
+static void _spank_registry_put (const char *fq_path, plugin_handle_t p)
+{
+	struct spank_plugin_handle *ph;
+
+	ph = xmalloc (sizeof (*ph));
+	ph->fq_path = xstrdup (fq_path);
+	ph->plugin = p;
+
+	slurm_mutex_lock (&spank_registry_mutex);
+	if (spank_handle_registry == NULL)
+		spank_handle_registry =
+			list_create (_spank_registry_handle_del);
+	list_append (spank_handle_registry, ph);
+	slurm_mutex_unlock (&spank_registry_mutex);
+}
+
+static void _spank_conf_file_del (void *x)
+{
+	struct spank_conf_file *f = x;
+
+	if (f) {
+		xfree (f->path);
+		xfree (f);
+	}
+}
+
+static void _spank_conf_line_del (void *x)
+{
+	struct spank_conf_line *l = x;
+	int i;
+
+	if (l == NULL)
+		return;
+	xfree (l->file);
+	xfree (l->path);
+	if (l->argv) {
+		for (i = 0; i < l->ac; i++)
+			xfree (l->argv[i]);
+		xfree (l->argv);
+	}
+	xfree (l);
+}
+
+/* Drop the cached config. Call with spank_conf_mutex held. */
+static void _spank_conf_cache_clear (void)
+{
+	xfree (spank_conf_cache_path);
+	FREE_NULL_LIST (spank_conf_cache_files);
+	FREE_NULL_LIST (spank_conf_cache_lines);
+}
+
+/* Test that the cached config matches path and that none of the
+ * files it was built from changed. Call with spank_conf_mutex held. */
+static bool _spank_conf_cache_valid (const char *path)
+{
+	ListIterator i;
+	struct spank_conf_file *f;
+	struct stat st;
+	bool valid = true;
+
+	if (!spank_conf_cache_files ||
+	    xstrcmp (spank_conf_cache_path, path))
+		return (false);
+
+	i = list_iterator_create (spank_conf_cache_files);
+	while (valid && (f = list_next (i))) {
+		if (stat (f->path, &st) < 0) {
+			if (!((errno == ENOENT) && (f->mtime == 0)))
+				valid = false;
+		} else if (st.st_mtime != f->mtime)
+			valid = false;
+	}
+	list_iterator_destroy (i);
+	return (valid);
+}
+
+/* Remember that file (with mtime, 0 = missing) contributed to the
+ * cached config. Call with spank_conf_mutex held. */
+static void _spank_conf_cache_add_file (const char *path, time_t mtime)
+{
+	struct spank_conf_file *f = xmalloc (sizeof (*f));
+
+	f->path = xstrdup (path);
+	f->mtime = mtime;
+	list_append (spank_conf_cache_files, f);
+}
+
+static char **_spank_argv_copy (int ac, char **av)
+{
+	char **copy = xmalloc ((ac + 1) * sizeof (char *));
+	int i;
+
+	for (i = 0; i < ac; i++)
+		copy[i] = xstrdup (av[i]);
+	copy[ac] = NULL;
+	return (copy);
+}
+
 static void spank_stack_destroy (struct spank_stack *stack)
 {
 	FREE_NULL_LIST (stack->plugin_list);
@@ -229,7 +406,7 @@ spank_stack_create (const char *file, enum spank_context_type type)
 	stack->option_cache =
 		list_create ((ListDelF) _spank_plugin_opt_destroy);
 
-	if (_spank_stack_load (stack, file) < 0) {
+	if (_spank_stack_build (stack, file) < 0) {
 		spank_stack_destroy (stack);
 		return (NULL);
 	}
@@ -344,9 +521,18 @@ static struct spank_plugin *_spank_plugin_create(struct spank_stack *stack,
 	plugin_err_t e;
 	struct spank_plugin_operations ops;
 
-	if ((e = plugin_load_from_file(&p, path)) != EPLUGIN_SUCCESS) {
-		error ("spank: %s: %s", path, plugin_strerror(e));
-		return NULL;
+	/*
+	 *  Reuse an already resolved handle when this plugin was
+	 *   loaded before in this process (another context's stack).
+	 */
+	p = _spank_registry_get (path);
+	if (p == PLUGIN_INVALID_HANDLE) {
+		if ((e = plugin_load_from_file(&p, path))
+		    != EPLUGIN_SUCCESS) {
+			error ("spank: %s: %s", path, plugin_strerror(e));
+			return NULL;
+		}
+		_spank_registry_put (path, p);
 	}
 
 	if (plugin_get_syms(p, n_spank_syms, spank_syms, (void **)&ops) == 0) {
@@ -384,7 +570,8 @@ void _spank_plugin_destroy(struct spank_plugin *sp)
 	/* No need to free "name" it was defined within plugin */
 	sp->name = NULL;
 
-	plugin_unload(sp->plugin);
+	/* The plugin handle is owned by the process wide registry and
+	 * stays loaded, a later stack re-create skips the dlopen. */
 	sp->plugin = NULL;
 	if (sp->argv) {
 		int i;
@@ -465,43 +652,22 @@ spank_stack_plugin_valid_for_context (struct spank_stack *stack,
 	return (0);
 }
 
+/*
+ *  Load one plugin into the stack. The path and argument vector are
+ *   copied, the caller (or the config cache) keeps ownership of the
+ *   passed values.
+ */
 static int
-_spank_stack_process_line(struct spank_stack *stack,
-	const char *file, int line, char *buf)
+_spank_stack_load_plugin(struct spank_stack *stack,
+	const char *file, int line, const char *path,
+	int ac, char **av, bool required)
 {
-	char **argv;
-	int ac;
-	char *path;
-	cf_line_t type = CF_REQUIRED;
-	bool required;
-
 	struct spank_plugin *p;
+	char *path_copy = xstrdup (path);
+	char **argv = _spank_argv_copy (ac, av);
 
-	if (_plugin_stack_parse_line(buf, &path, &ac, &argv, &type) < 0) {
-		error("spank: %s:%d: Invalid line. Ignoring.", file, line);
-		return (0);
-	}
-
-       if (type == CF_INCLUDE) {
-	       int rc = _spank_conf_include (stack, file, line, path);
-	       xfree (path);
-	       return (rc);
-       }
-
-	if (path == NULL)	/* No plugin listed on this line */
-		return (0);
-
-	if (path[0] != '/') {
-		char *f;
-
-		if ((f = _spank_plugin_find (stack->plugin_path, path))) {
-			xfree (path);
-			path = f;
-		}
-	}
-
-	required = (type == CF_REQUIRED);
-	if (!(p = _spank_plugin_create(stack, path, ac, argv, required))) {
+	if (!(p = _spank_plugin_create(stack, path_copy, ac, argv,
+				       required))) {
 		if (required)
 			error ("spank: %s:%d:"
 			       " Failed to load plugin %s. Aborting.",
@@ -510,6 +676,10 @@ _spank_stack_process_line(struct spank_stack *stack,
 			verbose ("spank: %s:%d:"
 				 "Failed to load optional plugin %s. Ignored.",
 				 file, line, path);
+		xfree (path_copy);
+		for (ac = 0; argv[ac]; ac++)
+			xfree (argv[ac]);
+		xfree (argv);
 		return (required ? -1 : 0);
 	}
 
@@ -535,12 +705,63 @@ _spank_stack_process_line(struct spank_stack *stack,
 	return (0);
 }
 
+static int
+_spank_stack_process_line(struct spank_stack *stack,
+	const char *file, int line, char *buf)
+{
+	char **argv;
+	int ac;
+	char *path;
+	cf_line_t type = CF_REQUIRED;
+	struct spank_conf_line *rec;
+
+	if (_plugin_stack_parse_line(buf, &path, &ac, &argv, &type) < 0) {
+		error("spank: %s:%d: Invalid line. Ignoring.", file, line);
+		return (0);
+	}
+
+       if (type == CF_INCLUDE) {
+	       int rc = _spank_conf_include (stack, file, line, path);
+	       xfree (path);
+	       return (rc);
+       }
+
+	if (path == NULL)	/* No plugin listed on this line */
+		return (0);
+
+	if (path[0] != '/') {
+		char *f;
+
+		if ((f = _spank_plugin_find (stack->plugin_path, path))) {
+			xfree (path);
+			path = f;
+		}
+	}
+
+	/*
+	 *  Record the resolved line in the config cache (which takes
+	 *   ownership of path and argv), then load from the record.
+	 */
+	rec = xmalloc (sizeof (*rec));
+	rec->file = xstrdup (file);
+	rec->line = line;
+	rec->path = path;
+	rec->ac = ac;
+	rec->argv = argv;
+	rec->required = (type == CF_REQUIRED);
+	list_append (spank_conf_cache_lines, rec);
+
+	return (_spank_stack_load_plugin (stack, file, line, rec->path,
+					  rec->ac, rec->argv, rec->required));
+}
+
 
 static int _spank_stack_load(struct spank_stack *stack, const char *path)
 {
 	int rc = 0;
 	int line;
 	char buf[4096];
+	struct stat st;
 	FILE *fp;
 
 	debug ("spank: opening plugin stack %s", path);
@@ -550,12 +771,17 @@ static int _spank_stack_load(struct spank_stack *stack, const char *path)
 	 *   error, but is equivalent to an empty file.
 	 */
 	if (!(fp = safeopen(path, "r", SAFEOPEN_NOCREATE|SAFEOPEN_LINK_OK))) {
-		if (errno == ENOENT)
+		if (errno == ENOENT) {
+			_spank_conf_cache_add_file (path, 0);
 			return (0);
+		}
 		error("spank: Failed to open %s: %m", path);
 		return (-1);
 	}
 
+	if (fstat (fileno (fp), &st) == 0)
+		_spank_conf_cache_add_file (path, st.st_mtime);
+
 	line = 1;
 	while (fgets(buf, sizeof(buf), fp)) {
 		rc = _spank_stack_process_line(stack, path, line, buf);
@@ -622,6 +848,58 @@ static int _spank_conf_include (struct spank_stack *stack,
 	return (rc);
 }
 
+/* Rebuild a stack from the cached, already resolved config records
+ * without touching the config files. Call with spank_conf_mutex
+ * held. */
+static int _spank_stack_replay (struct spank_stack *stack)
+{
+	ListIterator i;
+	struct spank_conf_line *rec;
+	int rc = 0;
+
+	debug ("spank: replaying cached plugin stack %s",
+	       spank_conf_cache_path);
+
+	i = list_iterator_create (spank_conf_cache_lines);
+	while ((rec = list_next (i))) {
+		rc = _spank_stack_load_plugin (stack, rec->file, rec->line,
+					       rec->path, rec->ac, rec->argv,
+					       rec->required);
+		if (rc < 0)
+			break;
+	}
+	list_iterator_destroy (i);
+	return (rc);
+}
+
+/*
+ *  Build the plugin stack, from the parsed config cache when it is
+ *   still current, otherwise by (re)reading the config files while
+ *   refreshing the cache.
+ */
+static int _spank_stack_build (struct spank_stack *stack, const char *path)
+{
+	int rc;
+
+	slurm_mutex_lock (&spank_conf_mutex);
+	if (_spank_conf_cache_valid (path)) {
+		rc = _spank_stack_replay (stack);
+		slurm_mutex_unlock (&spank_conf_mutex);
+		return (rc);
+	}
+
+	_spank_conf_cache_clear ();
+	spank_conf_cache_path = xstrdup (path);
+	spank_conf_cache_files = list_create (_spank_conf_file_del);
+	spank_conf_cache_lines = list_create (_spank_conf_line_del);
+
+	rc = _spank_stack_load (stack, path);
+	if (rc < 0)	/* don't cache a partial or failed parse */
+		_spank_conf_cache_clear ();
+	slurm_mutex_unlock (&spank_conf_mutex);
+	return (rc);
+}
+
 static int
 _spank_handle_init(struct spank_handle *spank, struct spank_stack *stack,
 		void * arg, int taskid, step_fn_t fn)
@@ -44,6 +44,19 @@ int print_fields_parsable_print = 0;
 int print_fields_have_header = 1;
 char *fields_delimiter = NULL;
 
+#define PRINT_FIELDS_BUF_SIZE (64 * 1024)
+
+extern void print_fields_block_output(void)
+{
+	static char *buf = NULL;
+
+	if (buf)
+		return;
+	buf = xmalloc(PRINT_FIELDS_BUF_SIZE);
+	if (setvbuf(stdout, buf, _IOFBF, PRINT_FIELDS_BUF_SIZE))
+		xfree(buf);	/* keep the default stdio buffer */
+}
+
 extern void destroy_print_field(void *object)
 {
 	print_field_t *field = (print_field_t *)object;
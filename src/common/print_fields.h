@@ -72,6 +72,12 @@ extern int print_fields_have_header;
 extern char *fields_delimiter;
 
 extern void destroy_print_field(void *object);
+
+/* Replace the stdout stdio buffer with one large fully buffered block
+ * so bulk dumps are written in big sequential chunks. Call once before
+ * any output is produced. */
+extern void print_fields_block_output(void);
+
 extern void print_fields_header(List print_fields_list);
 extern void print_fields_date(print_field_t *field, time_t value, int last);
 extern void print_fields_str(print_field_t *field, char *value, int last);
@@ -129,9 +129,14 @@ typedef struct names_ll_s {
 	uint32_t mem_spec_limit;
 	slurm_addr_t addr;
 	bool addr_initialized;
+	time_t addr_fail_time;	/* last failed resolution, 0 if none */
 	struct names_ll_s *next_alias;
 	struct names_ll_s *next_hostname;
 } names_ll_t;
+
+/* Do not retry a failed node address resolution more often than this,
+ * so a dead DNS server can not stall every outgoing message */
+#define ADDR_RETRY_SECS 2
 static bool nodehash_initialized = false;
 static names_ll_t *host_to_node_hashtbl[NAME_HASH_LEN] = {NULL};
 static names_ll_t *node_to_host_hashtbl[NAME_HASH_LEN] = {NULL};
@@ -1588,6 +1593,7 @@ static void _push_to_hashtbls(char *alias, char *hostname,
 	new->cores	= cores;
 	new->threads	= threads;
 	new->addr_initialized = false;
+	new->addr_fail_time = (time_t) 0;
 	new->cpu_spec_list = xstrdup(cpu_spec_list);
 	new->core_spec_cnt = core_spec_cnt;
 	new->mem_spec_limit = mem_spec_limit;
@@ -2133,6 +2139,7 @@ extern void slurm_reset_alias(char *node_name, char *node_addr,
 				xfree(p->address);
 				p->address = xstrdup(node_addr);
 				p->addr_initialized = false;
+				p->addr_fail_time = (time_t) 0;
 			}
 			if (node_hostname) {
 				xfree(p->hostname);
@@ -2155,6 +2162,9 @@ extern int slurm_conf_get_addr(const char *node_name, slurm_addr_t *address)
 {
 	int idx;
 	names_ll_t *p;
+	uint16_t port;
+	char *node_addr;
+	slurm_addr_t addr;
 
 	slurm_conf_lock();
 	_init_slurmd_nodehash();
@@ -2162,27 +2172,68 @@ extern int slurm_conf_get_addr(const char *node_name, slurm_addr_t *address)
 	idx = _get_hash_idx(node_name);
 	p = node_to_host_hashtbl[idx];
 	while (p) {
-		if (xstrcmp(p->alias, node_name) == 0) {
-			if (!p->port)
-				p->port = (uint16_t) conf_ptr->slurmd_port;
-			if (!p->addr_initialized) {
-				slurm_set_addr(&p->addr, p->port, p->address);
-				if (p->addr.sin_family == 0 &&
-				    p->addr.sin_port == 0) {
-					slurm_conf_unlock();
-					return SLURM_FAILURE;
-				}
-				p->addr_initialized = true;
-			}
-			*address = p->addr;
-			slurm_conf_unlock();
-			return SLURM_SUCCESS;
-		}
+		if (xstrcmp(p->alias, node_name) == 0)
+			break;
+		p = p->next_alias;
+	}
+	if (!p) {
+		slurm_conf_unlock();
+		return SLURM_FAILURE;
+	}
+
+	if (!p->port)
+		p->port = (uint16_t) conf_ptr->slurmd_port;
+	if (p->addr_initialized) {
+		*address = p->addr;
+		slurm_conf_unlock();
+		return SLURM_SUCCESS;
+	}
+	if (p->addr_fail_time &&
+	    (time(NULL) < (p->addr_fail_time + ADDR_RETRY_SECS))) {
+		/* resolution just failed, don't hammer the resolver */
+		slurm_conf_unlock();
+		return SLURM_FAILURE;
+	}
+
+	/* Resolve with the config lock released so a slow or dead DNS
+	 * server only delays messages for this node instead of every
+	 * reader of the config. The hash can be rebuilt or the address
+	 * reset meanwhile, so work on copies and look the node up again
+	 * before storing the result. */
+	port = p->port;
+	node_addr = xstrdup(p->address);
+	slurm_conf_unlock();
+
+	slurm_set_addr(&addr, port, node_addr);
+
+	slurm_conf_lock();
+	_init_slurmd_nodehash();
+	idx = _get_hash_idx(node_name);
+	p = node_to_host_hashtbl[idx];
+	while (p) {
+		if (xstrcmp(p->alias, node_name) == 0)
+			break;
 		p = p->next_alias;
 	}
+
+	if (addr.sin_family == 0 && addr.sin_port == 0) {
+		if (p && !xstrcmp(p->address, node_addr))
+			p->addr_fail_time = time(NULL);
+		slurm_conf_unlock();
+		xfree(node_addr);
+		return SLURM_FAILURE;
+	}
+
+	if (p && !p->addr_initialized && !xstrcmp(p->address, node_addr)) {
+		p->addr = addr;
+		p->addr_initialized = true;
+		p->addr_fail_time = (time_t) 0;
+	}
 	slurm_conf_unlock();
+	xfree(node_addr);
 
-	return SLURM_FAILURE;
+	*address = addr;
+	return SLURM_SUCCESS;
 }
 
 /*
@@ -2766,7 +2817,19 @@ static int _internal_reinit(const char *file_name)
 	}
 
 	if (conf_initialized) {
-		/* could check modified time on slurm.conf here */
+		uint32_t hash_val = 0;
+		/* If the configuration file contents are unchanged, keep
+		 * using the previously compiled configuration structures
+		 * rather than re-parsing the file and expanding every
+		 * node name range again */
+		if (conf_ptr->hash_val &&
+		    !xstrcmp(name, conf_ptr->slurm_conf) &&
+		    (s_p_hash_file(&hash_val, name) == SLURM_SUCCESS) &&
+		    (hash_val == conf_ptr->hash_val)) {
+			debug("%s: %s unchanged, reusing compiled config",
+			      __func__, name);
+			return rc;
+		}
 		_destroy_slurm_conf();
 	}
 
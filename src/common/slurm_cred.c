@@ -226,12 +226,24 @@ struct sbcast_cache {
 	uint32_t     value;	/* SLURM job id for this credential	*/
 };
 
+struct cred_verify_cache {
+	time_t       expire;	/* Time the verified signature goes stale */
+	char        *sig;	/* credential signature			*/
+	unsigned int siglen;	/* signature length in bytes		*/
+	char        *data;	/* packed credential body the signature
+				 * covers, rechecked so a cached signature
+				 * can not be paired with altered contents */
+	unsigned int datalen;	/* packed credential body length	*/
+};
+
 static slurm_crypto_ops_t ops;
 static plugin_context_t *g_context = NULL;
 static pthread_mutex_t g_context_lock = PTHREAD_MUTEX_INITIALIZER;
 static bool init_run = false;
 static time_t crypto_restart_time = (time_t) 0;
 static List sbcast_cache_list = NULL;
+static List cred_verify_cache = NULL;
+static pthread_mutex_t cred_verify_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int cred_expire = DEFAULT_EXPIRATION_WINDOW;
 
 /*
@@ -285,6 +297,11 @@ static void _cred_state_pack_one(cred_state_t *s, Buf buffer);
 static void _sbast_cache_add(sbcast_cred_t *sbcast_cred);
 static void _sbcast_cache_del(void *x);
 
+static bool _cred_verify_cache_find(slurm_cred_t *cred, Buf buffer);
+static void _cred_verify_cache_add(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+				   Buf buffer);
+static void _cred_verify_cache_del(void *x);
+
 static int _slurm_crypto_init(void)
 {
 	char	*auth_info, *tok;
@@ -323,6 +340,7 @@ static int _slurm_crypto_init(void)
 		goto done;
 	}
 	sbcast_cache_list = list_create(_sbcast_cache_del);
+	cred_verify_cache = list_create(_cred_verify_cache_del);
 	init_run = true;
 
 done:
@@ -351,6 +369,10 @@ static int _slurm_crypto_fini(void)
 	init_run = false;
 	FREE_NULL_LIST(sbcast_cache_list);
 	sbcast_cache_list = NULL;
+	slurm_mutex_lock(&cred_verify_cache_mutex);
+	FREE_NULL_LIST(cred_verify_cache);
+	cred_verify_cache = NULL;
+	slurm_mutex_unlock(&cred_verify_cache_mutex);
 	rc = plugin_context_destroy(g_context);
 	g_context = NULL;
 	return rc;
@@ -1629,6 +1651,76 @@ _slurm_cred_sign(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 	return SLURM_SUCCESS;
 }
 
+/* Return true if this credential's signature was recently verified and
+ * the signed contents are unchanged. Expired records are purged as a
+ * side effect of the scan. */
+static bool
+_cred_verify_cache_find(slurm_cred_t *cred, Buf buffer)
+{
+	struct cred_verify_cache *cache_rec;
+	ListIterator iter;
+	bool found = false;
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&cred_verify_cache_mutex);
+	if (!cred_verify_cache) {
+		slurm_mutex_unlock(&cred_verify_cache_mutex);
+		return false;
+	}
+	iter = list_iterator_create(cred_verify_cache);
+	while ((cache_rec = list_next(iter))) {
+		if (cache_rec->expire <= now) {
+			list_delete_item(iter);
+			continue;
+		}
+		if ((cache_rec->siglen  == cred->siglen) &&
+		    (cache_rec->datalen == get_buf_offset(buffer)) &&
+		    !memcmp(cache_rec->sig, cred->signature, cred->siglen) &&
+		    !memcmp(cache_rec->data, get_buf_data(buffer),
+			    cache_rec->datalen)) {
+			found = true;
+			break;
+		}
+	}
+	list_iterator_destroy(iter);
+	slurm_mutex_unlock(&cred_verify_cache_mutex);
+
+	return found;
+}
+
+static void
+_cred_verify_cache_add(slurm_cred_ctx_t ctx, slurm_cred_t *cred, Buf buffer)
+{
+	struct cred_verify_cache *cache_rec;
+
+	cache_rec = xmalloc(sizeof(struct cred_verify_cache));
+	cache_rec->expire  = cred->ctime + ctx->expiry_window;
+	cache_rec->siglen  = cred->siglen;
+	cache_rec->sig     = xmalloc(cred->siglen);
+	memcpy(cache_rec->sig, cred->signature, cred->siglen);
+	cache_rec->datalen = get_buf_offset(buffer);
+	cache_rec->data    = xmalloc(cache_rec->datalen);
+	memcpy(cache_rec->data, get_buf_data(buffer), cache_rec->datalen);
+
+	slurm_mutex_lock(&cred_verify_cache_mutex);
+	if (cred_verify_cache)
+		list_append(cred_verify_cache, cache_rec);
+	else
+		_cred_verify_cache_del(cache_rec);
+	slurm_mutex_unlock(&cred_verify_cache_mutex);
+}
+
+static void _cred_verify_cache_del(void *x)
+{
+	struct cred_verify_cache *cache_rec = x;
+
+	if (cache_rec) {
+		xfree(cache_rec->sig);
+		xfree(cache_rec->data);
+		xfree(cache_rec);
+	}
+}
+
 static int
 _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 			     uint16_t protocol_version)
@@ -1636,10 +1728,20 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 	Buf            buffer;
 	int            rc;
 
-	debug("Checking credential with %u bytes of sig data", cred->siglen);
 	buffer = init_buf(4096);
 	_pack_cred(cred, buffer, protocol_version);
 
+	/* A credential is verified once per task launch. Repeated launches
+	 * under the same job credential skip the crypto/munge round trip as
+	 * long as the cached signature has not passed the expiry window. */
+	if (_cred_verify_cache_find(cred, buffer)) {
+		debug2("Credential signature for job %u previously verified",
+		       cred->jobid);
+		free_buf(buffer);
+		return SLURM_SUCCESS;
+	}
+
+	debug("Checking credential with %u bytes of sig data", cred->siglen);
 	rc = (*(ops.crypto_verify_sign))(ctx->key,
 					 get_buf_data(buffer),
 					 get_buf_offset(buffer),
@@ -1652,13 +1754,16 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 						 cred->signature,
 						 cred->siglen);
 	}
-	free_buf(buffer);
 
 	if (rc) {
+		free_buf(buffer);
 		error("Credential signature check: %s",
 		      (*(ops.crypto_str_error))(rc));
 		return SLURM_ERROR;
 	}
+
+	_cred_verify_cache_add(ctx, cred, buffer);
+	free_buf(buffer);
 	return SLURM_SUCCESS;
 }
 
@@ -325,6 +325,8 @@ static slurm_errtab_t slurm_errtab[] = {
 	  "Invalid mcs_label specified"				},
 	{ ESLURM_BURST_BUFFER_WAIT,
 	  "Waiting for burst buffer"				},
+	{ ESLURM_NODE_REG_DIGEST_MISMATCH,
+	  "Node configuration digest mismatch, full registration required" },
 
 	/* slurmd error codes */
 	{ ESLRUMD_PIPE_ERROR_ON_TASK_SPAWN,
@@ -385,6 +387,8 @@ static slurm_errtab_t slurm_errtab[] = {
 	  "Job step is suspended"                               },
  	{ ESLURMD_STEP_NOTSUSPENDED,
 	  "Job step is not currently suspended"                 },
+	{ ESLURMD_BCAST_FILE_ALREADY_CACHED,
+	  "Destination file already cached with matching hash"  },
 
 	/* slurmd errors in user batch job */
 	{ ESCRIPT_CHDIR_FAILED,
@@ -189,13 +189,31 @@ static bool _jobacct_shutdown_test(void)
 	return rc;
 }
 
+static time_t last_poll_time = 0;
+static void (*poll_cb)(void) = NULL;
+
 static void _poll_data(bool profile)
 {
 	/* Update the data */
 	slurm_mutex_lock(&task_list_lock);
 	if (task_list)
 		(*(ops.poll_data))(task_list, pgid_plugin, cont_id, profile);
+	last_poll_time = time(NULL);
 	slurm_mutex_unlock(&task_list_lock);
+
+	/* Called without the lock so the callback may use
+	 * jobacct_gather_stat_task() and friends */
+	if (poll_cb)
+		(*poll_cb)();
+}
+
+/*
+ * Register a function to be called after every poll of the tasks, e.g. to
+ * publish fresh statistics.  Pass NULL to remove the callback.
+ */
+extern void jobacct_gather_set_poll_cb(void (*cb)(void))
+{
+	poll_cb = cb;
 }
 
 static void _task_sleep(int rem)
@@ -456,7 +474,11 @@ extern jobacctinfo_t *jobacct_gather_stat_task(pid_t pid)
 		struct jobacctinfo *ret_jobacct = NULL;
 		ListIterator itr = NULL;
 
-		_poll_data(0);
+		/* Serve stat requests (e.g. sstat) from the last sample
+		 * when it is fresh, rather than walking /proc again for
+		 * every query. */
+		if ((time(NULL) - last_poll_time) >= 1)
+			_poll_data(0);
 
 		slurm_mutex_lock(&task_list_lock);
 		if (!task_list) {
@@ -138,6 +138,8 @@ extern int  jobacct_gather_startpoll(uint16_t frequency);
 extern int  jobacct_gather_endpoll(void);
 extern void jobacct_gather_suspend_poll(void);
 extern void jobacct_gather_resume_poll(void);
+/* called after every poll of the tasks, NULL removes the callback */
+extern void jobacct_gather_set_poll_cb(void (*cb)(void));
 
 extern int jobacct_gather_add_task(pid_t pid, jobacct_id_t *jobacct_id,
 				   int poll);
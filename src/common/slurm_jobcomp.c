@@ -38,20 +38,29 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
 
+#include "src/common/list.h"
 #include "src/common/macros.h"
 #include "src/common/plugin.h"
 #include "src/common/plugrack.h"
 #include "src/common/slurm_jobcomp.h"
 #include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_defs.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xassert.h"
 #include "src/common/xstring.h"
 #include "src/slurmctld/slurmctld.h"
 
+#define JOBCOMP_BUF_MAX_RECS	64	/* group commit batch size */
+#define JOBCOMP_BUF_MAX_WAIT	100	/* group commit window, msec */
+
 /*
  * WARNING:  Do not change the order of these fields or add additional
  * fields at the beginning of the structure.  If you do, job completion
@@ -85,6 +94,217 @@ static plugin_context_t *g_context = NULL;
 static pthread_mutex_t context_lock = PTHREAD_MUTEX_INITIALIZER;
 static bool init_run = false;
 
+/* State of the buffered asynchronous record writer */
+static pthread_mutex_t	buf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	buf_cond = PTHREAD_COND_INITIALIZER;
+static List		buf_rec_list = NULL;
+static pthread_t	buf_thread = 0;
+static bool		buf_thread_created = false;
+static bool		buf_shutdown = false;
+static bool		buf_writing = false;
+static bool		buf_flush_request = false;
+static int		buf_fd = -1;
+static int		buf_errno = SLURM_SUCCESS;
+
+/* Append all records on work_list to buf_fd with a single write call.
+ * Called without buf_lock held, buf_fd can not change while
+ * buf_writing is set. */
+static void _buf_write_batch(List work_list)
+{
+	xstrbuf_t sb = XSTRBUF_INITIALIZER;
+	ListIterator iter;
+	size_t offset = 0, tot_size;
+	ssize_t wrote;
+	char *rec;
+
+	iter = list_iterator_create(work_list);
+	while ((rec = list_next(iter)))
+		xstrbuf_cat(&sb, rec);
+	list_iterator_destroy(iter);
+
+	tot_size = sb.len;
+	while (offset < tot_size) {
+		wrote = write(buf_fd, sb.buf + offset, tot_size - offset);
+		if (wrote == -1) {
+			if (errno == EAGAIN)
+				continue;
+			error("jobcomp record write: %m");
+			buf_errno = errno;
+			break;
+		}
+		offset += wrote;
+	}
+	xstrbuf_free(&sb);
+}
+
+/* Background thread batching queued completion records into single
+ * writes.  The first record of a batch is held back for up to
+ * JOBCOMP_BUF_MAX_WAIT msec so completion bursts are committed as a
+ * group rather than one write per job. */
+static void *_buf_writer(void *arg)
+{
+	struct timespec ts = {0, 0};
+	struct timeval now;
+	List work_list;
+
+	slurm_mutex_lock(&buf_lock);
+	while (!buf_shutdown || !list_is_empty(buf_rec_list)) {
+		if (list_is_empty(buf_rec_list)) {
+			slurm_cond_wait(&buf_cond, &buf_lock);
+			continue;
+		}
+		if (!buf_shutdown && !buf_flush_request &&
+		    (list_count(buf_rec_list) < JOBCOMP_BUF_MAX_RECS)) {
+			gettimeofday(&now, NULL);
+			now.tv_usec += JOBCOMP_BUF_MAX_WAIT * 1000;
+			ts.tv_sec  = now.tv_sec  + (now.tv_usec / 1000000);
+			ts.tv_nsec = (now.tv_usec % 1000000) * 1000;
+			slurm_cond_timedwait(&buf_cond, &buf_lock, &ts);
+		}
+
+		/* Swap the queue so records are written and freed
+		 * without holding buf_lock */
+		work_list = buf_rec_list;
+		buf_rec_list = list_create(slurm_destroy_char);
+		buf_writing = true;
+		slurm_mutex_unlock(&buf_lock);
+
+		_buf_write_batch(work_list);
+		FREE_NULL_LIST(work_list);
+
+		slurm_mutex_lock(&buf_lock);
+		buf_writing = false;
+		if (list_is_empty(buf_rec_list))
+			buf_flush_request = false;
+		slurm_cond_broadcast(&buf_cond);
+	}
+	slurm_mutex_unlock(&buf_lock);
+	return NULL;
+}
+
+/* Wait for all queued records to reach the file, buf_lock held */
+static void _buf_flush_locked(void)
+{
+	if (!buf_thread_created)
+		return;
+	buf_flush_request = true;
+	slurm_cond_broadcast(&buf_cond);
+	while (!list_is_empty(buf_rec_list) || buf_writing)
+		slurm_cond_wait(&buf_cond, &buf_lock);
+}
+
+extern int jobcomp_buf_open(char *location)
+{
+	pthread_attr_t attr;
+	int fd;
+
+	fd = open(location, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (fd < 0)
+		return -1;
+	(void) fchmod(fd, 0644);
+
+	slurm_mutex_lock(&buf_lock);
+	if (!buf_rec_list)
+		buf_rec_list = list_create(slurm_destroy_char);
+	if (buf_fd >= 0) {
+		/* drain records bound for the old file before swapping */
+		_buf_flush_locked();
+		close(buf_fd);
+	}
+	buf_fd = fd;
+	if (!buf_thread_created) {
+		buf_shutdown = false;
+		slurm_attr_init(&attr);
+		if (pthread_create(&buf_thread, &attr, _buf_writer, NULL)) {
+			error("pthread_create of jobcomp writer: %m");
+			slurm_attr_destroy(&attr);
+			slurm_mutex_unlock(&buf_lock);
+			return fd;	/* records written synchronously */
+		}
+		slurm_attr_destroy(&attr);
+		buf_thread_created = true;
+	}
+	slurm_mutex_unlock(&buf_lock);
+	return fd;
+}
+
+extern int jobcomp_buf_write(char *record)
+{
+	size_t offset = 0, tot_size;
+	ssize_t wrote;
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&buf_lock);
+	if (buf_fd < 0) {
+		slurm_mutex_unlock(&buf_lock);
+		xfree(record);
+		return SLURM_ERROR;
+	}
+	if (!buf_thread_created) {
+		/* no writer thread, fall back to a synchronous write */
+		tot_size = strlen(record);
+		while (offset < tot_size) {
+			wrote = write(buf_fd, record + offset,
+				      tot_size - offset);
+			if (wrote == -1) {
+				if (errno == EAGAIN)
+					continue;
+				buf_errno = errno;
+				rc = SLURM_ERROR;
+				break;
+			}
+			offset += wrote;
+		}
+		slurm_mutex_unlock(&buf_lock);
+		xfree(record);
+		return rc;
+	}
+	list_append(buf_rec_list, record);
+	slurm_cond_signal(&buf_cond);
+	slurm_mutex_unlock(&buf_lock);
+	return SLURM_SUCCESS;
+}
+
+extern int jobcomp_buf_flush(void)
+{
+	int rc;
+
+	slurm_mutex_lock(&buf_lock);
+	_buf_flush_locked();
+	rc = buf_errno;
+	slurm_mutex_unlock(&buf_lock);
+	return rc;
+}
+
+extern int jobcomp_buf_close(void)
+{
+	bool join_thread = false;
+	int rc;
+
+	slurm_mutex_lock(&buf_lock);
+	if (buf_thread_created) {
+		buf_shutdown = true;
+		slurm_cond_broadcast(&buf_cond);
+		join_thread = true;
+	}
+	slurm_mutex_unlock(&buf_lock);
+
+	if (join_thread)
+		pthread_join(buf_thread, NULL);
+
+	slurm_mutex_lock(&buf_lock);
+	buf_thread_created = false;
+	buf_shutdown = false;
+	if (buf_fd >= 0) {
+		close(buf_fd);
+		buf_fd = -1;
+	}
+	FREE_NULL_LIST(buf_rec_list);
+	rc = buf_errno;
+	slurm_mutex_unlock(&buf_lock);
+	return rc;
+}
+
 extern void
 jobcomp_destroy_job(void *object)
 {
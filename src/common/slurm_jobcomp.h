@@ -105,5 +105,28 @@ extern List g_slurm_jobcomp_get_jobs(slurmdb_job_cond_t *job_cond);
  */
 extern int g_slurm_jobcomp_archive(slurmdb_archive_cond_t *arch_cond);
 
+/*
+ * Buffered asynchronous record writer shared by file based jobcomp
+ * plugins.  Records queued with jobcomp_buf_write() are appended to the
+ * completion file by a background thread which batches multiple
+ * completions into a single write (group commit), so the job completion
+ * path does not block on file system latency.
+ */
+
+/* open (or re-open) the completion file and start the writer thread,
+ * returns the file descriptor or -1 on error */
+extern int jobcomp_buf_open(char *location);
+
+/* queue one completion record for writing, takes ownership of the
+ * xmalloc'd string "record" */
+extern int jobcomp_buf_write(char *record);
+
+/* write out all queued records, returns SLURM_SUCCESS or the error
+ * code of the last failed write */
+extern int jobcomp_buf_flush(void);
+
+/* flush queued records, stop the writer thread and close the file */
+extern int jobcomp_buf_close(void);
+
 #endif /*__SLURM_JOBCOMP_H__*/
 
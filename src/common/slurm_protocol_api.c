@@ -44,6 +44,9 @@
 /* GLOBAL INCLUDES */
 
 #include <ctype.h>
+#if HAVE_LIBZ
+#  include <zlib.h>
+#endif
 #include <errno.h>
 #include <pthread.h>
 #include <stdio.h>
@@ -2873,6 +2876,22 @@ int slurm_init_msg_engine_addrname_port(char *addr_name, uint16_t port)
 	return slurm_init_msg_engine(&addr);
 }
 
+/* slurm_init_msg_engine_shard
+ * as slurm_init_msg_engine_addrname_port(), but the listener is opened
+ * with SO_REUSEPORT so several shards can accept on the same port
+ * IN  addr_name - address to bind the msg server to (NULL means any)
+ * IN  port      - port to bind the msg server to
+ * RET int       - file descriptor of the connection created
+ */
+int slurm_init_msg_engine_shard(char *addr_name, uint16_t port)
+{
+	slurm_addr_t addr;
+
+	slurm_setup_sockaddr(&addr, port);
+
+	return slurm_init_msg_engine_reuseport(&addr);
+}
+
 /*
  *  Close an established message engine.
  *    Returns SLURM_SUCCESS or SLURM_FAILURE.
@@ -3045,6 +3064,90 @@ int slurm_open_controller_conn_spec(enum controller_id dest)
 	return rc;
 }
 
+/* Compress message bodies larger than this before sending; below it
+ * the deflate overhead outweighs the savings */
+#define COMPRESS_THRESHOLD (64 * 1024)
+
+#if HAVE_LIBZ
+/* Deflate the packed message body sitting at [body_offset] in [buffer]
+ * (the header and auth credential precede it).  On success the body is
+ * replaced by its uncompressed length and the deflated image, the
+ * compress flag is set and the header repacked in place.  The body is
+ * left alone if it does not shrink or deflate fails. */
+static void _compress_msg_body(Buf buffer, uint32_t body_offset,
+			       header_t *header)
+{
+	uint32_t body_len = get_buf_offset(buffer) - body_offset;
+	uLongf comp_len = compressBound(body_len);
+	Bytef *comp_buf = xmalloc(comp_len);
+	unsigned int tmplen;
+
+	if (compress2(comp_buf, &comp_len,
+		      (Bytef *) (get_buf_data(buffer) + body_offset),
+		      body_len, Z_DEFAULT_COMPRESSION) != Z_OK) {
+		error("%s: compress2 failed, sending uncompressed", __func__);
+		xfree(comp_buf);
+		return;
+	}
+	if ((comp_len + (2 * sizeof(uint32_t))) >= body_len) {
+		/* incompressible body */
+		xfree(comp_buf);
+		return;
+	}
+
+	set_buf_offset(buffer, body_offset);
+	pack32(body_len, buffer);
+	packmem((char *) comp_buf, comp_len, buffer);
+	xfree(comp_buf);
+
+	header->flags |= SLURM_MSG_ZLIB_COMPRESS;
+	update_header(header, get_buf_offset(buffer) - body_offset);
+	tmplen = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack_header(header, buffer);
+	set_buf_offset(buffer, tmplen);
+}
+#endif
+
+/* Inflate a message body compressed by _compress_msg_body().  On
+ * success [buffer] is replaced by one holding just the uncompressed
+ * body and the compress flag and body length in [header] are reset. */
+static int _decompress_msg_body(Buf *buffer, header_t *header)
+{
+#if HAVE_LIBZ
+	uint32_t body_len = 0, comp_len = 0;
+	char *comp_data = NULL, *body_data = NULL;
+	uLongf dst_len;
+	Buf buf = *buffer, new_buf;
+
+	safe_unpack32(&body_len, buf);
+	safe_unpackmem_xmalloc(&comp_data, &comp_len, buf);
+	dst_len = body_len;
+	body_data = xmalloc(body_len);
+	if ((uncompress((Bytef *) body_data, &dst_len, (Bytef *) comp_data,
+			comp_len) != Z_OK) || (dst_len != body_len)) {
+		error("%s: uncompress failed", __func__);
+		goto unpack_error;
+	}
+	xfree(comp_data);
+
+	new_buf = create_buf(body_data, body_len);
+	free_buf(buf);
+	*buffer = new_buf;
+	header->flags &= ~SLURM_MSG_ZLIB_COMPRESS;
+	header->body_length = body_len;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(comp_data);
+	xfree(body_data);
+#else
+	error("%s: compressed message received but zlib support is not built",
+	      __func__);
+#endif
+	return SLURM_ERROR;
+}
+
 /**********************************************************************\
  * receive message functions
 \**********************************************************************/
@@ -3165,6 +3268,14 @@ int slurm_receive_msg(int fd, slurm_msg_t *msg, int timeout)
 		goto total_return;
 	}
 
+	if ((header.flags & SLURM_MSG_ZLIB_COMPRESS) &&
+	    (_decompress_msg_body(&buffer, &header) != SLURM_SUCCESS)) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3343,6 +3454,14 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 		goto total_return;
 	}
 
+	if ((header.flags & SLURM_MSG_ZLIB_COMPRESS) &&
+	    (_decompress_msg_body(&buffer, &header) != SLURM_SUCCESS)) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3578,6 +3697,14 @@ int slurm_receive_msg_and_forward(int fd, slurm_addr_t *orig_addr,
 		goto total_return;
 	}
 
+	if ((header.flags & SLURM_MSG_ZLIB_COMPRESS) &&
+	    (_decompress_msg_body(&buffer, &header) != SLURM_SUCCESS)) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3647,6 +3774,67 @@ _pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer)
 	set_buf_offset(buffer, tmplen);
 }
 
+/*
+ *  Pack a complete on-wire message image (header, auth credential and
+ *    message body) for transmission with slurm_msg_sendto(). The same
+ *    image may be sent to many peers, avoiding repeated packing and
+ *    credential creation when fanning one message out to many nodes.
+ *    Returns a buffer the caller must free, or NULL on error.
+ */
+extern Buf slurm_pack_msg_buf(slurm_msg_t *msg)
+{
+	header_t header;
+	Buf      buffer;
+	int      rc;
+	void *   auth_cred;
+	unsigned int body_offset;
+
+	if (msg->flags & SLURM_GLOBAL_AUTH_KEY) {
+		auth_cred = g_slurm_auth_create(NULL, 2, _global_auth_key());
+	} else {
+		char *auth_info = slurm_get_auth_info();
+		auth_cred = g_slurm_auth_create(NULL, 2, auth_info);
+		xfree(auth_info);
+	}
+	if (auth_cred == NULL) {
+		error("authentication: %s",
+		      g_slurm_auth_errstr(g_slurm_auth_errno(NULL)) );
+		slurm_seterrno(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
+		return NULL;
+	}
+
+	if (msg->forward.init != FORWARD_INIT) {
+		forward_init(&msg->forward, NULL);
+		msg->ret_list = NULL;
+	}
+
+	init_header(&header, msg, msg->flags);
+
+	buffer = init_buf(BUF_SIZE);
+	pack_header(&header, buffer);
+
+	rc = g_slurm_auth_pack(auth_cred, buffer);
+	(void) g_slurm_auth_destroy(auth_cred);
+	if (rc) {
+		error("authentication: %s",
+		      g_slurm_auth_errstr(g_slurm_auth_errno(auth_cred)));
+		free_buf(buffer);
+		slurm_seterrno(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
+		return NULL;
+	}
+
+	body_offset = get_buf_offset(buffer);
+	_pack_msg(msg, &header, buffer);
+
+#if HAVE_LIBZ
+	if ((header.version >= SLURM_17_02_PROTOCOL_VERSION) &&
+	    ((get_buf_offset(buffer) - body_offset) >= COMPRESS_THRESHOLD))
+		_compress_msg_body(buffer, body_offset, &header);
+#endif
+
+	return buffer;
+}
+
 /*
  *  Send a slurm message over an open file descriptor `fd'
  *    Returns the size of the message sent in bytes, or -1 on failure.
@@ -3721,20 +3909,54 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 		slurm_seterrno_ret(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
 	}
 
-	/*
-	 * Pack message into buffer
-	 */
-	_pack_msg(msg, &header, buffer);
+	if (slurm_msg_body_prepacked(msg->msg_type) &&
+	    (msg->forward.cnt == 0)) {
+		/*
+		 * The body is already a packed image (possibly shared with
+		 * a response cache). Update the header with the body length
+		 * and scatter-gather send header and body without copying
+		 * the body into the send buffer.
+		 */
+		struct iovec iov[2];
+		unsigned int tmplen;
+
+		update_header(&header, msg->data_size);
+		tmplen = get_buf_offset(buffer);
+		set_buf_offset(buffer, 0);
+		pack_header(&header, buffer);
+		set_buf_offset(buffer, tmplen);
+
+		iov[0].iov_base = get_buf_data(buffer);
+		iov[0].iov_len  = get_buf_offset(buffer);
+		iov[1].iov_base = msg->data;
+		iov[1].iov_len  = msg->data_size;
+		rc = slurm_msg_sendv(fd, iov, 2,
+				     SLURM_PROTOCOL_NO_SEND_RECV_FLAGS);
+	} else {
+		unsigned int body_offset = get_buf_offset(buffer);
+
+		/*
+		 * Pack message into buffer
+		 */
+		_pack_msg(msg, &header, buffer);
+
+#if HAVE_LIBZ
+		if ((header.version >= SLURM_17_02_PROTOCOL_VERSION) &&
+		    ((get_buf_offset(buffer) - body_offset) >=
+		     COMPRESS_THRESHOLD))
+			_compress_msg_body(buffer, body_offset, &header);
+#endif
 
 #if	_DEBUG
-	_print_data (get_buf_data(buffer),get_buf_offset(buffer));
+		_print_data (get_buf_data(buffer),get_buf_offset(buffer));
 #endif
-	/*
-	 * Send message
-	 */
-	rc = slurm_msg_sendto( fd, get_buf_data(buffer),
-			       get_buf_offset(buffer),
-			       SLURM_PROTOCOL_NO_SEND_RECV_FLAGS );
+		/*
+		 * Send message
+		 */
+		rc = slurm_msg_sendto( fd, get_buf_data(buffer),
+				       get_buf_offset(buffer),
+				       SLURM_PROTOCOL_NO_SEND_RECV_FLAGS );
+	}
 
 	if ((rc < 0) && (errno == ENOTCONN)) {
 		debug3("slurm_msg_sendto: peer has disappeared for msg_type=%u",
@@ -4198,6 +4420,251 @@ _send_and_recv_msgs(int fd, slurm_msg_t *req, int timeout)
 }
 
 
+/* Opt-in per-process pool of persistent controller connections, enabled
+ * by setting SLURM_PERSIST_CONNECTIONS to the desired pool size. Clients
+ * issuing many sequential requests (e.g. workflow engines polling with
+ * squeue/scontrol) then reuse TCP connections across calls rather than
+ * paying connection setup per RPC. Concurrent threads each reserve their
+ * own pooled connection since the protocol allows only one outstanding
+ * request per connection. */
+#define PERSIST_POOL_SIZE_MAX	8
+
+static pthread_mutex_t persist_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int   persist_pool_fd[PERSIST_POOL_SIZE_MAX];
+static bool  persist_pool_busy[PERSIST_POOL_SIZE_MAX];
+static int   persist_pool_size = -1;	/* -1 = not yet configured */
+static pid_t persist_pool_pid = 0;
+
+/* Return the configured pool size, 0 when disabled.
+ * The pool is reinitialized after a fork, abandoning any descriptors
+ * inherited from the parent process.
+ * NOTE: Caller must hold persist_pool_mutex */
+static int _persist_pool_setup(void)
+{
+	char *env_val;
+	int i;
+
+	if ((persist_pool_size != -1) && (persist_pool_pid == getpid()))
+		return persist_pool_size;
+
+	persist_pool_pid = getpid();
+	persist_pool_size = 0;
+	for (i = 0; i < PERSIST_POOL_SIZE_MAX; i++) {
+		persist_pool_fd[i] = -1;
+		persist_pool_busy[i] = false;
+	}
+	if ((env_val = getenv("SLURM_PERSIST_CONNECTIONS"))) {
+		persist_pool_size = atoi(env_val);
+		persist_pool_size = MIN(persist_pool_size,
+					PERSIST_POOL_SIZE_MAX);
+		persist_pool_size = MAX(persist_pool_size, 0);
+	}
+	return persist_pool_size;
+}
+
+/* Reserve a pooled persistent connection to the primary controller,
+ * opening a new one as needed. Returns the pool slot index or -1. */
+static int _persist_pool_get(void)
+{
+	slurm_ctl_conf_t *conf;
+	char *host;
+	uint32_t port;
+	int i;
+
+	slurm_mutex_lock(&persist_pool_mutex);
+	if (_persist_pool_setup() == 0) {
+		slurm_mutex_unlock(&persist_pool_mutex);
+		return -1;
+	}
+	for (i = 0; i < persist_pool_size; i++) {
+		if (!persist_pool_busy[i] && (persist_pool_fd[i] >= 0)) {
+			persist_pool_busy[i] = true;
+			slurm_mutex_unlock(&persist_pool_mutex);
+			return i;
+		}
+	}
+	for (i = 0; i < persist_pool_size; i++) {
+		if (!persist_pool_busy[i])
+			break;
+	}
+	if (i >= persist_pool_size) {	/* every connection in use */
+		slurm_mutex_unlock(&persist_pool_mutex);
+		return -1;
+	}
+	persist_pool_busy[i] = true;
+	slurm_mutex_unlock(&persist_pool_mutex);
+
+	conf = slurm_conf_lock();
+	host = xstrdup(conf->control_addr);
+	port = conf->slurmctld_port;
+	slurm_conf_unlock();
+	persist_pool_fd[i] = slurm_open_persist_controller_conn(host, port);
+	xfree(host);
+	if (persist_pool_fd[i] < 0) {
+		slurm_mutex_lock(&persist_pool_mutex);
+		persist_pool_busy[i] = false;
+		slurm_mutex_unlock(&persist_pool_mutex);
+		return -1;
+	}
+	return i;
+}
+
+/* Release a pooled persistent connection, dropping it on failure so the
+ * next request opens a fresh connection */
+static void _persist_pool_put(int inx, bool keep)
+{
+	slurm_mutex_lock(&persist_pool_mutex);
+	if (!keep && (persist_pool_fd[inx] >= 0)) {
+		(void) slurm_shutdown_msg_conn(persist_pool_fd[inx]);
+		persist_pool_fd[inx] = -1;
+	}
+	persist_pool_busy[inx] = false;
+	slurm_mutex_unlock(&persist_pool_mutex);
+}
+
+/* Opt-in cache of persistent connections to individual nodes, enabled by
+ * setting SLURM_PERSIST_NODE_CHANNELS to the maximum number of channels
+ * to keep open. slurm_send_addr_recv_msgs() then reuses one authenticated
+ * connection per destination for single-node messages without a forwarding
+ * tree (the slurmctld agent fan-out path), which removes TCP and
+ * credential setup from every small RPC and the connection storms of mass
+ * job teardown. Channels are reopened transparently when the remote end
+ * restarts or drops an idle connection. */
+#define NODE_CHAN_CACHE_MAX	1024
+
+typedef struct {
+	slurm_addr_t addr;
+	int fd;
+	bool busy;
+} node_chan_t;
+
+static pthread_mutex_t node_chan_mutex = PTHREAD_MUTEX_INITIALIZER;
+static node_chan_t *node_chan_tab = NULL;
+static int   node_chan_cnt = 0;
+static int   node_chan_max = -1;	/* -1 = not yet configured */
+static pid_t node_chan_pid = 0;
+
+/* Return the configured cache size, 0 when disabled.
+ * The cache is reinitialized after a fork, abandoning any descriptors
+ * inherited from the parent process.
+ * NOTE: Caller must hold node_chan_mutex */
+static int _node_chan_setup(void)
+{
+	char *env_val;
+
+	if ((node_chan_max != -1) && (node_chan_pid == getpid()))
+		return node_chan_max;
+
+	node_chan_pid = getpid();
+	node_chan_max = 0;
+	xfree(node_chan_tab);
+	node_chan_cnt = 0;
+	if ((env_val = getenv("SLURM_PERSIST_NODE_CHANNELS"))) {
+		node_chan_max = atoi(env_val);
+		node_chan_max = MIN(node_chan_max, NODE_CHAN_CACHE_MAX);
+		node_chan_max = MAX(node_chan_max, 0);
+	}
+	if (node_chan_max > 0)
+		node_chan_tab = xmalloc(node_chan_max *
+					sizeof(node_chan_t));
+	return node_chan_max;
+}
+
+/* Open a persistent connection to the node at addr, identifying it as
+ * such with a REQUEST_PERSIST_INIT handshake so the remote end keeps the
+ * connection open across RPCs. Returns an open fd or -1. */
+static int _node_chan_open(slurm_addr_t *addr)
+{
+	int fd = -1;
+	int rc;
+	slurm_msg_t *req_msg;
+	slurm_msg_t *resp_msg;
+
+	if ((fd = slurm_open_msg_conn(addr)) < 0)
+		return -1;
+
+	req_msg  = xmalloc(sizeof(slurm_msg_t));
+	resp_msg = xmalloc(sizeof(slurm_msg_t));
+
+	slurm_msg_t_init(req_msg);
+	slurm_msg_t_init(resp_msg);
+
+	req_msg->msg_type = REQUEST_PERSIST_INIT;
+	if ((rc = slurm_send_recv_msg(fd, req_msg, resp_msg, 0)) ||
+	    (rc = slurm_get_return_code(resp_msg->msg_type,
+					resp_msg->data))) {
+		/* Remote end predates persistent connection support */
+		debug2("%s: persistent connection handshake failed: %m",
+		       __func__);
+		(void) slurm_shutdown_msg_conn(fd);
+		fd = -1;
+	}
+
+	slurm_free_msg(req_msg);
+	slurm_free_msg(resp_msg);
+
+	return fd;
+}
+
+/* Reserve the persistent channel for the node at addr, opening one as
+ * needed. Returns the cache slot index or -1 (cache disabled or full, or
+ * the channel is reserved by another thread). */
+static int _node_chan_get(slurm_addr_t *addr)
+{
+	int i;
+
+	slurm_mutex_lock(&node_chan_mutex);
+	if (_node_chan_setup() == 0) {
+		slurm_mutex_unlock(&node_chan_mutex);
+		return -1;
+	}
+	for (i = 0; i < node_chan_cnt; i++) {
+		if (memcmp(&node_chan_tab[i].addr, addr,
+			   sizeof(slurm_addr_t)))
+			continue;
+		if (node_chan_tab[i].busy) {
+			/* One outstanding request per connection */
+			slurm_mutex_unlock(&node_chan_mutex);
+			return -1;
+		}
+		break;
+	}
+	if (i >= node_chan_cnt) {
+		if (node_chan_cnt >= node_chan_max) {
+			slurm_mutex_unlock(&node_chan_mutex);
+			return -1;
+		}
+		i = node_chan_cnt++;
+		node_chan_tab[i].addr = *addr;
+		node_chan_tab[i].fd = -1;
+	}
+	node_chan_tab[i].busy = true;
+	slurm_mutex_unlock(&node_chan_mutex);
+
+	if (node_chan_tab[i].fd < 0)
+		node_chan_tab[i].fd = _node_chan_open(addr);
+	if (node_chan_tab[i].fd < 0) {
+		slurm_mutex_lock(&node_chan_mutex);
+		node_chan_tab[i].busy = false;
+		slurm_mutex_unlock(&node_chan_mutex);
+		return -1;
+	}
+	return i;
+}
+
+/* Release the persistent channel in cache slot inx, dropping the
+ * connection on failure so the next request opens a fresh one */
+static void _node_chan_put(int inx, bool keep)
+{
+	slurm_mutex_lock(&node_chan_mutex);
+	if (!keep && (node_chan_tab[inx].fd >= 0)) {
+		(void) slurm_shutdown_msg_conn(node_chan_tab[inx].fd);
+		node_chan_tab[inx].fd = -1;
+	}
+	node_chan_tab[inx].busy = false;
+	slurm_mutex_unlock(&node_chan_mutex);
+}
+
 /*
  * slurm_send_recv_controller_msg
  * opens a connection to the controller, sends the controller a message,
@@ -4210,6 +4677,7 @@ int slurm_send_recv_controller_msg(slurm_msg_t *req, slurm_msg_t *resp)
 {
 	int fd = -1;
 	int rc = 0;
+	int pool_inx;
 	time_t start_time = time(NULL);
 	int retry = 1;
 	slurm_ctl_conf_t *conf;
@@ -4229,6 +4697,29 @@ int slurm_send_recv_controller_msg(slurm_msg_t *req, slurm_msg_t *resp)
 	if (working_cluster_rec)
 		req->flags |= SLURM_GLOBAL_AUTH_KEY;
 
+	if (!working_cluster_rec && ((pool_inx = _persist_pool_get()) >= 0)) {
+		rc = slurm_send_recv_msg(persist_pool_fd[pool_inx], req,
+					 resp, 0);
+		if (resp->auth_cred)
+			g_slurm_auth_destroy(resp->auth_cred);
+		else
+			rc = -1;
+		if ((rc == 0) && (resp->msg_type == RESPONSE_SLURM_RC) &&
+		    ((((return_code_msg_t *) resp->data)->return_code)
+		     == ESLURM_IN_STANDBY_MODE)) {
+			/* Leave fail-over handling to the one-shot path */
+			slurm_free_return_code_msg(resp->data);
+			resp->data = NULL;
+			rc = -1;
+		}
+		_persist_pool_put(pool_inx, (rc == 0));
+		if (rc == 0)
+			return rc;
+		/* The pooled connection may have gone stale (e.g. on a
+		 * controller restart), fall back to a new connection */
+		rc = 0;
+	}
+
 	if ((fd = slurm_open_controller_conn(&ctrl_addr, &use_backup)) < 0) {
 		rc = -1;
 		goto cleanup;
@@ -4432,13 +4923,44 @@ List slurm_send_addr_recv_msgs(slurm_msg_t *msg, char *name, int timeout)
 	int fd = -1;
 	ret_data_info_t *ret_data_info = NULL;
 	ListIterator itr;
-	int i;
+	int i, chan_inx;
 
 	slurm_mutex_lock(&conn_lock);
 	if (conn_timeout == (uint16_t) NO_VAL)
 		conn_timeout = MIN(slurm_get_msg_timeout(), 10);
 	slurm_mutex_unlock(&conn_lock);
 
+	if ((msg->forward.cnt == 0) &&
+	    ((chan_inx = _node_chan_get(&msg->address)) >= 0)) {
+		/* Reuse the node's cached persistent channel */
+		slurm_msg_t resp;
+		int chan_rc;
+
+		slurm_msg_t_init(&resp);
+		msg->ret_list = NULL;
+		msg->forward_struct = NULL;
+		chan_rc = slurm_send_recv_msg(node_chan_tab[chan_inx].fd,
+					      msg, &resp, timeout);
+		if (resp.auth_cred)
+			g_slurm_auth_destroy(resp.auth_cred);
+		else
+			chan_rc = -1;
+		if (chan_rc == 0) {
+			ret_list = list_create(destroy_data_info);
+			ret_data_info = xmalloc(sizeof(ret_data_info_t));
+			ret_data_info->err = SLURM_SUCCESS;
+			ret_data_info->node_name = xstrdup(name);
+			ret_data_info->type = resp.msg_type;
+			ret_data_info->data = resp.data;
+			list_push(ret_list, ret_data_info);
+		}
+		_node_chan_put(chan_inx, (chan_rc == 0));
+		if (chan_rc == 0)
+			return ret_list;
+		/* The channel may have gone stale (e.g. on a slurmd
+		 * restart), fall back to a fresh one-shot connection */
+	}
+
 	/* This connect retry logic permits Slurm hierarchical communications
 	 * to better survive slurmd restarts */
 	for (i = 0; i <= conn_timeout; i++) {
@@ -933,6 +933,12 @@ extern int sock_bind_range(int, uint16_t *);
 extern int slurm_init_msg_engine_addrname_port(char *addr_name,
 						    uint16_t port);
 
+/* slurm_init_msg_engine_shard
+ * as slurm_init_msg_engine_addrname_port() with SO_REUSEPORT set, so
+ * several shards can accept on the same port
+ */
+extern int slurm_init_msg_engine_shard(char *addr_name, uint16_t port);
+
 /* In the socket implementation it creates a socket, binds to it, and
  *	listens for connections.
  * IN slurm_address 	- slurm_addr_t to bind the msg server to
@@ -1022,6 +1028,16 @@ int slurm_receive_msg_and_forward(int fd, slurm_addr_t *orig_addr,
  */
 int slurm_send_node_msg(int open_fd, slurm_msg_t *msg);
 
+/* pack a complete on-wire message image (header, auth credential and
+ *	message body) into a buffer suitable for transmission with
+ *	slurm_msg_sendto(). Permits sending one packed image to many
+ *	peers without repacking and re-authenticating per destination.
+ *
+ * IN msg		- a slurm msg struct to be packed
+ * RET Buf		- packed message, caller must free, NULL on error
+ */
+extern Buf slurm_pack_msg_buf(slurm_msg_t *msg);
+
 /**********************************************************************\
  * msg connection establishment functions used by msg clients
 \**********************************************************************/
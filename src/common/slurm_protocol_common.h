@@ -101,6 +101,9 @@
 /* used to set flags to empty */
 #define SLURM_PROTOCOL_NO_FLAGS 0
 #define SLURM_GLOBAL_AUTH_KEY   0x0001
+/* message body is zlib deflated, preceded by its uncompressed length.
+ * Only sent to peers speaking SLURM_17_02_PROTOCOL_VERSION or newer. */
+#define SLURM_MSG_ZLIB_COMPRESS 0x0002
 
 #include "src/common/slurm_protocol_socket_common.h"
 
@@ -635,6 +635,15 @@ extern void slurm_free_shutdown_msg(shutdown_msg_t * msg)
 	xfree(msg);
 }
 
+extern void slurm_free_ctld_state_stream_msg(ctld_state_stream_msg_t * msg)
+{
+	if (msg) {
+		xfree(msg->file_name);
+		xfree(msg->data);
+		xfree(msg);
+	}
+}
+
 extern void slurm_free_job_alloc_info_msg(job_alloc_info_msg_t * msg)
 {
 	xfree(msg);
@@ -690,9 +699,27 @@ extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg)
 	xfree(msg);
 }
 
+extern void slurm_free_kill_jobs_msg(kill_jobs_msg_t * msg)
+{
+	uint32_t i;
+
+	if (msg) {
+		for (i = 0; i < msg->job_cnt; i++)
+			xfree(msg->job_ids[i]);
+		xfree(msg->job_ids);
+		xfree(msg);
+	}
+}
+
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg)
 {
-	xfree(msg);
+	if (msg) {
+		xfree(msg->job_ids);
+		xfree(msg->partitions);
+		xfree(msg->states);
+		xfree(msg->user_ids);
+		xfree(msg);
+	}
 }
 
 extern void slurm_free_job_step_info_request_msg(job_step_info_request_msg_t *msg)
@@ -923,6 +950,26 @@ extern void slurm_free_job_info_members(job_info_t * job)
 	}
 }
 
+/* Free only the members of a job info record which the unpack logic
+ * allocated. The string members are not freed, they reference the retained
+ * message buffer (job_info_msg_t->unpack_buf) directly. */
+extern void slurm_free_job_info_borrowed_members(job_info_t * job)
+{
+	if (job) {
+		if (job->array_bitmap) {
+			bit_free((bitstr_t *) job->array_bitmap);
+			job->array_bitmap = NULL;
+		}
+		xfree(job->array_task_str);
+		xfree(job->exc_node_inx);
+		xfree(job->node_inx);
+		xfree(job->req_node_inx);
+		select_g_select_jobinfo_free(job->select_jobinfo);
+		job->select_jobinfo = NULL;
+		free_job_resources(&job->job_resrcs);
+	}
+}
+
 
 extern void slurm_free_acct_gather_node_resp_msg(
 	acct_gather_node_resp_msg_t *msg)
@@ -1384,6 +1431,26 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 		xfree(msg->rpc_user_id);
 		xfree(msg->rpc_user_cnt);
 		xfree(msg->rpc_user_time);
+		xfree(msg->rpc_type_hist);
+		xfree(msg->lock_read_cnt);
+		xfree(msg->lock_read_wait);
+		xfree(msg->lock_write_cnt);
+		xfree(msg->lock_write_wait);
+		xfree(msg->lock_write_hold);
+		xfree(msg->rec_pool_occupancy);
+		xfree(msg->rec_pool_allocs);
+		xfree(msg->rec_pool_reuses);
+		if (msg->prof_region_names) {
+			uint32_t i;
+			for (i = 0; i < msg->prof_region_size; i++)
+				xfree(msg->prof_region_names[i]);
+			xfree(msg->prof_region_names);
+		}
+		xfree(msg->prof_region_counts);
+		xfree(msg->prof_region_time);
+		xfree(msg->prof_region_time_min);
+		xfree(msg->prof_region_time_max);
+		xfree(msg->prof_region_time_p99);
 		xfree(msg);
 	}
 }
@@ -2222,144 +2289,87 @@ extern char *trigger_type(uint32_t trig_type)
 		return "unknown";
 }
 
+/* Append a flag name to a builder, comma separated */
+static void _add_flag_str(xstrbuf_t *sb, const char *name)
+{
+	if (sb->len)
+		xstrbuf_catchar(sb, ',');
+	xstrbuf_cat(sb, name);
+}
+
 /* user needs to xfree return value */
 extern char *reservation_flags_string(uint32_t flags)
 {
-	char *flag_str = xstrdup("");
+	xstrbuf_t sb = XSTRBUF_INITIALIZER;
+	char *flag_str;
 
 	if (flags & RESERVE_FLAG_MAINT)
-		xstrcat(flag_str, "MAINT");
-	if (flags & RESERVE_FLAG_NO_MAINT) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_MAINT");
-	}
-	if (flags & RESERVE_FLAG_OVERLAP) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "OVERLAP");
-	}
-	if (flags & RESERVE_FLAG_IGN_JOBS) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "IGNORE_JOBS");
-	}
-	if (flags & RESERVE_FLAG_DAILY) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "DAILY");
-	}
-	if (flags & RESERVE_FLAG_NO_DAILY) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_DAILY");
-	}
-	if (flags & RESERVE_FLAG_WEEKLY) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "WEEKLY");
-	}
-	if (flags & RESERVE_FLAG_NO_WEEKLY) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_WEEKLY");
-	}
-	if (flags & RESERVE_FLAG_SPEC_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "SPEC_NODES");
-	}
-	if (flags & RESERVE_FLAG_ALL_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "ALL_NODES");
-	}
-	if (flags & RESERVE_FLAG_ANY_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "ANY_NODES");
-	}
-	if (flags & RESERVE_FLAG_NO_ANY_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_ANY_NODES");
-	}
-	if (flags & RESERVE_FLAG_STATIC) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "STATIC");
-	}
-	if (flags & RESERVE_FLAG_NO_STATIC) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_STATIC");
-	}
-	if (flags & RESERVE_FLAG_PART_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "PART_NODES");
-	}
-	if (flags & RESERVE_FLAG_NO_PART_NODES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "NO_PART_NODES");
-	}
-	if (flags & RESERVE_FLAG_FIRST_CORES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "FIRST_CORES");
-	}
-	if (flags & RESERVE_FLAG_TIME_FLOAT) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "TIME_FLOAT");
-	}
-	if (flags & RESERVE_FLAG_REPLACE) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "REPLACE");
-	}
-	if (flags & RESERVE_FLAG_PURGE_COMP) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "PURGE_COMP");
-	}
+		_add_flag_str(&sb, "MAINT");
+	if (flags & RESERVE_FLAG_NO_MAINT)
+		_add_flag_str(&sb, "NO_MAINT");
+	if (flags & RESERVE_FLAG_OVERLAP)
+		_add_flag_str(&sb, "OVERLAP");
+	if (flags & RESERVE_FLAG_IGN_JOBS)
+		_add_flag_str(&sb, "IGNORE_JOBS");
+	if (flags & RESERVE_FLAG_DAILY)
+		_add_flag_str(&sb, "DAILY");
+	if (flags & RESERVE_FLAG_NO_DAILY)
+		_add_flag_str(&sb, "NO_DAILY");
+	if (flags & RESERVE_FLAG_WEEKLY)
+		_add_flag_str(&sb, "WEEKLY");
+	if (flags & RESERVE_FLAG_NO_WEEKLY)
+		_add_flag_str(&sb, "NO_WEEKLY");
+	if (flags & RESERVE_FLAG_SPEC_NODES)
+		_add_flag_str(&sb, "SPEC_NODES");
+	if (flags & RESERVE_FLAG_ALL_NODES)
+		_add_flag_str(&sb, "ALL_NODES");
+	if (flags & RESERVE_FLAG_ANY_NODES)
+		_add_flag_str(&sb, "ANY_NODES");
+	if (flags & RESERVE_FLAG_NO_ANY_NODES)
+		_add_flag_str(&sb, "NO_ANY_NODES");
+	if (flags & RESERVE_FLAG_STATIC)
+		_add_flag_str(&sb, "STATIC");
+	if (flags & RESERVE_FLAG_NO_STATIC)
+		_add_flag_str(&sb, "NO_STATIC");
+	if (flags & RESERVE_FLAG_PART_NODES)
+		_add_flag_str(&sb, "PART_NODES");
+	if (flags & RESERVE_FLAG_NO_PART_NODES)
+		_add_flag_str(&sb, "NO_PART_NODES");
+	if (flags & RESERVE_FLAG_FIRST_CORES)
+		_add_flag_str(&sb, "FIRST_CORES");
+	if (flags & RESERVE_FLAG_TIME_FLOAT)
+		_add_flag_str(&sb, "TIME_FLOAT");
+	if (flags & RESERVE_FLAG_REPLACE)
+		_add_flag_str(&sb, "REPLACE");
+	if (flags & RESERVE_FLAG_PURGE_COMP)
+		_add_flag_str(&sb, "PURGE_COMP");
+
+	if (!(flag_str = xstrbuf_release(&sb)))
+		flag_str = xstrdup("");
 	return flag_str;
 }
 
 /* user needs to xfree return value */
 extern char *priority_flags_string(uint16_t priority_flags)
 {
-	char *flag_str = xstrdup("");
+	xstrbuf_t sb = XSTRBUF_INITIALIZER;
+	char *flag_str;
 
 	if (priority_flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
-		xstrcat(flag_str, "ACCRUE_ALWAYS");
-	if (priority_flags & PRIORITY_FLAGS_SIZE_RELATIVE) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "SMALL_RELATIVE_TO_TIME");
-	}
-	if (priority_flags & PRIORITY_FLAGS_CALCULATE_RUNNING) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "CALCULATE_RUNNING");
-	}
-	if (priority_flags & PRIORITY_FLAGS_DEPTH_OBLIVIOUS) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "DEPTH_OBLIVIOUS");
-	}
-	if (priority_flags & PRIORITY_FLAGS_FAIR_TREE) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "FAIR_TREE");
-	}
-	if (priority_flags & PRIORITY_FLAGS_MAX_TRES) {
-		if (flag_str[0])
-			xstrcat(flag_str, ",");
-		xstrcat(flag_str, "MAX_TRES");
-	}
-
+		_add_flag_str(&sb, "ACCRUE_ALWAYS");
+	if (priority_flags & PRIORITY_FLAGS_SIZE_RELATIVE)
+		_add_flag_str(&sb, "SMALL_RELATIVE_TO_TIME");
+	if (priority_flags & PRIORITY_FLAGS_CALCULATE_RUNNING)
+		_add_flag_str(&sb, "CALCULATE_RUNNING");
+	if (priority_flags & PRIORITY_FLAGS_DEPTH_OBLIVIOUS)
+		_add_flag_str(&sb, "DEPTH_OBLIVIOUS");
+	if (priority_flags & PRIORITY_FLAGS_FAIR_TREE)
+		_add_flag_str(&sb, "FAIR_TREE");
+	if (priority_flags & PRIORITY_FLAGS_MAX_TRES)
+		_add_flag_str(&sb, "MAX_TRES");
+
+	if (!(flag_str = xstrbuf_release(&sb)))
+		flag_str = xstrdup("");
 	return flag_str;
 }
 
@@ -3097,6 +3107,27 @@ extern void slurm_free_submit_response_response_msg(submit_response_msg_t * msg)
 	xfree(msg);
 }
 
+extern void slurm_free_job_desc_list_msg(job_desc_list_msg_t * msg)
+{
+	int i;
+
+	if (msg) {
+		for (i = 0; i < msg->job_count; i++)
+			slurm_free_job_desc_msg(msg->job_descs[i]);
+		xfree(msg->job_descs);
+		xfree(msg);
+	}
+}
+
+extern void slurm_free_submit_response_list_msg(
+	submit_response_list_msg_t * msg)
+{
+	if (msg) {
+		xfree(msg->resps);
+		xfree(msg);
+	}
+}
+
 
 /*
  * slurm_free_ctl_conf - free slurm control information response message
@@ -3139,6 +3170,10 @@ extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr)
 			_free_all_job_info(job_buffer_ptr);
 			xfree(job_buffer_ptr->job_array);
 		}
+		if (job_buffer_ptr->unpack_buf)
+			free_buf((Buf) job_buffer_ptr->unpack_buf);
+		FREE_NULL_LIST(job_buffer_ptr->unpack_buf_list);
+		xfree(job_buffer_ptr->deleted_job_ids);
 		xfree(job_buffer_ptr);
 	}
 }
@@ -3151,8 +3186,13 @@ static void _free_all_job_info(job_info_msg_t *msg)
 	    (msg->job_array == NULL))
 		return;
 
-	for (i = 0; i < msg->record_count; i++)
-		slurm_free_job_info_members (&msg->job_array[i]);
+	for (i = 0; i < msg->record_count; i++) {
+		if (msg->unpack_buf || msg->unpack_buf_list) {
+			slurm_free_job_info_borrowed_members(
+				&msg->job_array[i]);
+		} else
+			slurm_free_job_info_members (&msg->job_array[i]);
+	}
 }
 
 /*
@@ -3773,6 +3813,9 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case SRUN_STEP_SIGNAL:
 		slurm_free_job_step_kill_msg(data);
 		break;
+	case REQUEST_KILL_JOBS:
+		slurm_free_kill_jobs_msg(data);
+		break;
 	case REQUEST_COMPLETE_JOB_ALLOCATION:
 		slurm_free_complete_job_allocation_msg(data);
 		break;
@@ -3801,6 +3844,12 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_UPDATE_JOB:
 		slurm_free_job_desc_msg(data);
 		break;
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		slurm_free_job_desc_list_msg(data);
+		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		slurm_free_submit_response_list_msg(data);
+		break;
 	case RESPONSE_ACCT_GATHER_UPDATE:
 		slurm_free_acct_gather_node_resp_msg(data);
 		break;
@@ -4029,12 +4078,18 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_JOB_NOTIFY:
 		slurm_free_job_notify_msg(data);
 		break;
+	case REQUEST_JOB_STATE_SUBSCRIBE:
+		slurm_free_job_state_subscribe_msg(data);
+		break;
 	case REQUEST_STATS_INFO:
 		slurm_free_stats_info_request_msg(data);
 		break;
 	case REQUEST_LICENSE_INFO:
 		slurm_free_license_info_request_msg(data);
 		break;
+	case REQUEST_CTLD_STATE_STREAM:
+		slurm_free_ctld_state_stream_msg(data);
+		break;
 	case REQUEST_ACCT_GATHER_ENERGY:
 		slurm_free_acct_gather_energy_req_msg(data);
 		break;
@@ -4138,6 +4193,11 @@ extern void slurm_free_job_notify_msg(job_notify_msg_t * msg)
 	}
 }
 
+extern void slurm_free_job_state_subscribe_msg(job_state_subscribe_msg_t *msg)
+{
+	xfree(msg);
+}
+
 /*
  *  Sanitize spank_job_env by prepending "SPANK_" to all entries,
  *   thus rendering them harmless in environment of scripts and
@@ -4240,6 +4300,8 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_LICENSE_INFO";
 	case RESPONSE_LICENSE_INFO:
 		return "RESPONSE_LICENSE_INFO";
+	case REQUEST_CTLD_STATE_STREAM:
+		return "REQUEST_CTLD_STATE_STREAM";
 
 	case REQUEST_BUILD_INFO:				/* 2001 */
 		return "REQUEST_BUILD_INFO";
@@ -4412,10 +4474,16 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_JOB_END_TIME";
 	case REQUEST_JOB_NOTIFY:
 		return "REQUEST_JOB_NOTIFY";
+	case REQUEST_JOB_STATE_SUBSCRIBE:
+		return "REQUEST_JOB_STATE_SUBSCRIBE";
 	case REQUEST_JOB_SBCAST_CRED:
 		return "REQUEST_JOB_SBCAST_CRED";
 	case RESPONSE_JOB_SBCAST_CRED:
 		return "RESPONSE_JOB_SBCAST_CRED";
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		return "REQUEST_SUBMIT_BATCH_JOBS";
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		return "RESPONSE_SUBMIT_BATCH_JOBS";
 
 	case REQUEST_JOB_STEP_CREATE:				/* 5001 */
 		return "REQUEST_JOB_STEP_CREATE";
@@ -4480,6 +4548,8 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_SUSPEND_INT";
 	case REQUEST_KILL_JOB:
 		return "REQUEST_KILL_JOB";
+	case REQUEST_KILL_JOBS:
+		return "REQUEST_KILL_JOBS";
 	case REQUEST_KILL_JOBSTEP:
 		return "REQUEST_KILL_JOBSTEP";
 	case RESPONSE_JOB_ARRAY_ERRORS:
@@ -194,6 +194,7 @@ typedef enum {
 	RESPONSE_ACCT_GATHER_ENERGY,	/* 1020 */
 	REQUEST_LICENSE_INFO,
 	RESPONSE_LICENSE_INFO,
+	REQUEST_CTLD_STATE_STREAM,
 
 	REQUEST_BUILD_INFO	= 2001,
 	RESPONSE_BUILD_INFO,
@@ -284,6 +285,8 @@ typedef enum {
 	REQUEST_JOB_NOTIFY,
 	REQUEST_JOB_SBCAST_CRED,
 	RESPONSE_JOB_SBCAST_CRED,
+	REQUEST_SUBMIT_BATCH_JOBS,
+	RESPONSE_SUBMIT_BATCH_JOBS,
 
 	REQUEST_JOB_STEP_CREATE = 5001,
 	RESPONSE_JOB_STEP_CREATE,
@@ -323,6 +326,8 @@ typedef enum {
 	RESPONSE_NETWORK_CALLERID,
 	REQUEST_STEP_COMPLETE_AGGR,
 	REQUEST_TOP_JOB,		/* 5038 */
+	REQUEST_KILL_JOBS,
+	REQUEST_JOB_STATE_SUBSCRIBE,	/* 5040 */
 
 	REQUEST_LAUNCH_TASKS = 6001,
 	RESPONSE_LAUNCH_TASKS,
@@ -473,6 +478,9 @@ struct kvs_comm {
 	char **		kvs_keys;
 	char **		kvs_values;
 	uint16_t *	kvs_key_sent;
+	uint32_t	kvs_alloc_cnt;	/* allocated size of the arrays,
+					 * used by the PMI server only,
+					 * not sent over the wire */
 };
 typedef struct kvs_comm_set {
 
@@ -556,12 +564,27 @@ typedef struct job_step_kill_msg {
 	uint16_t flags;
 } job_step_kill_msg_t;
 
+/* Bulk job cancellation. Each job id string may contain a job array
+ * expression, all of them are processed by the controller in a single
+ * lock window. */
+typedef struct kill_jobs_msg {
+	uint32_t job_cnt;	/* count of entries in job_ids */
+	char **job_ids;		/* job id strings, may include array exprs */
+	uint16_t signal;
+	uint16_t flags;
+} kill_jobs_msg_t;
+
 typedef struct job_notify_msg {
 	uint32_t job_id;
 	uint32_t job_step_id;	/* currently not used */
 	char *   message;
 } job_notify_msg_t;
 
+typedef struct job_state_subscribe_msg {
+	uint32_t job_id;	/* job to watch for state transitions */
+	uint16_t port;		/* client port for push notifications */
+} job_state_subscribe_msg_t;
+
 typedef struct job_id_msg {
 	uint32_t job_id;
 	uint16_t show_flags;
@@ -580,6 +603,15 @@ typedef struct job_step_id_msg {
 typedef struct job_info_request_msg {
 	time_t last_update;
 	uint16_t show_flags;
+	uint32_t job_id_count;	/* filter entry counts, 0 means do not
+				 * restrict on that field */
+	uint32_t *job_ids;	/* only pack jobs with these job or
+				 * array job ids */
+	char *partitions;	/* comma separated partition names */
+	uint32_t state_count;
+	uint32_t *states;	/* only pack jobs in these states */
+	uint32_t user_count;
+	uint32_t *user_ids;	/* only pack jobs of these users */
 } job_info_request_msg_t;
 
 typedef struct job_step_info_request_msg {
@@ -682,6 +714,14 @@ typedef struct shutdown_msg {
 	uint16_t options;
 } shutdown_msg_t;
 
+/* State save buffer streamed from the primary controller to the backup
+ * controller so the backup can maintain a hot replica of the state files */
+typedef struct ctld_state_stream_msg {
+	char *file_name;	/* state file base name, e.g. "job_state" */
+	uint32_t data_size;	/* size of serialized state buffer */
+	char *data;		/* serialized state buffer */
+} ctld_state_stream_msg_t;
+
 typedef struct last_update_msg {
 	time_t last_update;
 } last_update_msg_t;
@@ -1075,10 +1115,13 @@ typedef struct file_bcast_msg {
 	time_t mtime;		/* last modification time for dest file */
 	sbcast_cred_t *cred;	/* credential for the RPC */
 	uint32_t block_len;	/* length of this data block */
-	uint32_t block_offset;	/* offset for this data block */
+	uint64_t block_offset;	/* offset for this data block */
 	uint32_t uncomp_len;	/* uncompressed length of this data block */
 	char *block;		/* data for this block */
 	uint64_t file_size;	/* file size */
+	uint64_t digest;	/* hash of the complete file contents,
+				 * zero if not computed; lets slurmd skip
+				 * the transfer if a cached copy matches */
 } file_bcast_msg_t;
 
 typedef struct multi_core_data {
@@ -1134,6 +1177,9 @@ typedef struct slurm_node_registration_status_msg {
 	uint32_t cpu_load;	/* CPU load * 100 */
 	uint32_t free_mem;	/* Free memory in MiB */
 	char *cpu_spec_list;	/* list of specialized CPUs */
+	uint32_t config_digest;	/* digest of the static node configuration */
+	uint16_t delta;		/* static configuration omitted, digest
+				 * matches the last full registration */
 	acct_gather_energy_t *energy;
 	char *features_active;	/* Currently active node features */
 	char *features_avail;	/* Available node features */
@@ -1260,8 +1306,10 @@ extern void slurm_free_ping_slurmd_resp(ping_slurmd_resp_msg_t *msg);
 extern void slurm_free_reboot_msg(reboot_msg_t * msg);
 
 extern void slurm_free_shutdown_msg(shutdown_msg_t * msg);
+extern void slurm_free_ctld_state_stream_msg(ctld_state_stream_msg_t * msg);
 
 extern void slurm_free_job_desc_msg(job_desc_msg_t * msg);
+extern void slurm_free_job_desc_list_msg(job_desc_list_msg_t * msg);
 extern void slurm_free_event_log_msg(slurm_event_log_msg_t * msg);
 
 extern void
@@ -1270,6 +1318,7 @@ slurm_free_node_registration_status_msg(slurm_node_registration_status_msg_t *
 
 extern void slurm_free_job_info(job_info_t * job);
 extern void slurm_free_job_info_members(job_info_t * job);
+extern void slurm_free_job_info_borrowed_members(job_info_t * job);
 
 extern void slurm_free_job_id_msg(job_id_msg_t * msg);
 extern void slurm_free_job_user_id_msg(job_user_id_msg_t * msg);
@@ -1315,6 +1364,7 @@ extern void slurm_free_kill_job_msg(kill_job_msg_t * msg);
 extern void slurm_free_signal_job_msg(signal_job_msg_t * msg);
 extern void slurm_free_update_job_time_msg(job_time_msg_t * msg);
 extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg);
+extern void slurm_free_kill_jobs_msg(kill_jobs_msg_t * msg);
 extern void slurm_free_epilog_complete_msg(epilog_complete_msg_t * msg);
 extern void slurm_free_srun_job_complete_msg(srun_job_complete_msg_t * msg);
 extern void slurm_free_srun_exec_msg(srun_exec_msg_t *msg);
@@ -1375,6 +1425,7 @@ extern void slurm_free_acct_gather_node_resp_msg(
 extern void slurm_free_acct_gather_energy_req_msg(
 	acct_gather_energy_req_msg_t *msg);
 extern void slurm_free_job_notify_msg(job_notify_msg_t * msg);
+extern void slurm_free_job_state_subscribe_msg(job_state_subscribe_msg_t *msg);
 
 extern void slurm_free_accounting_update_msg(accounting_update_msg_t *msg);
 extern void slurm_free_spank_env_request_msg(spank_env_request_msg_t *msg);
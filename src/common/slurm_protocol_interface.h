@@ -48,6 +48,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "src/common/macros.h"
@@ -107,6 +108,28 @@ extern ssize_t slurm_msg_sendto_timeout(int open_fd,
 					uint32_t flags,
 					int timeout);
 
+/* slurm_msg_sendv
+ * Scatter-gather equivalent of slurm_msg_sendto(): send the message
+ * length word followed by each of the supplied segments with writev(),
+ * without coalescing them into one buffer first.
+ * IN open_fd - an open file descriptor
+ * IN iov - data segments to transmit, modified as segments are consumed
+ * IN iovcnt - number of segments
+ * IN flags - communication specific flags
+ * RET number of message bytes written (excluding the length word)
+ */
+extern ssize_t slurm_msg_sendv(int open_fd,
+			       struct iovec *iov,
+			       int iovcnt,
+			       uint32_t flags);
+/* slurm_msg_sendv_timeout is identical to slurm_msg_sendv except
+ * IN timeout - maximum time to wait for a message in milliseconds */
+extern ssize_t slurm_msg_sendv_timeout(int open_fd,
+				       struct iovec *iov,
+				       int iovcnt,
+				       uint32_t flags,
+				       int timeout);
+
 /********************/
 /* stream functions */
 /********************/
@@ -118,6 +141,12 @@ extern ssize_t slurm_msg_sendto_timeout(int open_fd,
  */
 extern int slurm_init_msg_engine(slurm_addr_t *slurm_address);
 
+/* slurm_init_msg_engine_reuseport
+ * as slurm_init_msg_engine(), but with SO_REUSEPORT set so multiple
+ * listeners can shard the same port
+ */
+extern int slurm_init_msg_engine_reuseport(slurm_addr_t *slurm_address);
+
 /* slurm_accept_msg_conn
  * accepts a incoming stream connection on a stream server slurm_fd
  * IN open_fd		- file descriptor to accept connection on
@@ -144,6 +173,8 @@ extern int slurm_get_stream_addr(int open_fd, slurm_addr_t *address);
 
 extern int slurm_send_timeout(int open_fd, char *buffer, size_t size,
 			      uint32_t flags, int timeout);
+extern int slurm_writev_timeout(int open_fd, struct iovec *iov, int iovcnt,
+				uint32_t flags, int timeout);
 extern int slurm_recv_timeout(int open_fd, char *buffer, size_t size,
 			      uint32_t flags, int timeout);
 
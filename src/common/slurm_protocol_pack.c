@@ -68,6 +68,9 @@
 #include "src/common/xassert.h"
 
 
+/* sanity cap on the job count in a REQUEST_SUBMIT_BATCH_JOBS message */
+#define MAX_BATCH_JOB_COUNT	0x10000
+
 #define _pack_job_info_msg(msg,buf)		_pack_buffer_msg(msg,buf)
 #define _pack_job_step_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_block_info_resp_msg(msg,buf)	_pack_buffer_msg(msg,buf)
@@ -164,6 +167,18 @@ static int _unpack_submit_response_msg(submit_response_msg_t ** msg,
 				       Buf buffer,
 				       uint16_t protocol_version);
 
+static void _pack_job_desc_list_msg(job_desc_list_msg_t * msg, Buf buffer,
+				    uint16_t protocol_version);
+static int _unpack_job_desc_list_msg(job_desc_list_msg_t ** msg, Buf buffer,
+				     uint16_t protocol_version);
+
+static void _pack_submit_response_list_msg(submit_response_list_msg_t * msg,
+					   Buf buffer,
+					   uint16_t protocol_version);
+static int _unpack_submit_response_list_msg(submit_response_list_msg_t ** msg,
+					    Buf buffer,
+					    uint16_t protocol_version);
+
 static void _pack_node_info_request_msg(
 	node_info_request_msg_t * msg, Buf buffer,
 	uint16_t protocol_version);
@@ -317,6 +332,13 @@ static void _pack_shutdown_msg(shutdown_msg_t * msg, Buf buffer,
 static int _unpack_shutdown_msg(shutdown_msg_t ** msg_ptr, Buf buffer,
 				uint16_t protocol_version);
 
+static void _pack_ctld_state_stream_msg(ctld_state_stream_msg_t * msg,
+					Buf buffer,
+					uint16_t protocol_version);
+static int _unpack_ctld_state_stream_msg(ctld_state_stream_msg_t ** msg_ptr,
+					 Buf buffer,
+					 uint16_t protocol_version);
+
 static void _pack_reattach_tasks_request_msg(reattach_tasks_request_msg_t *,
 					     Buf, uint16_t);
 static int _unpack_reattach_tasks_request_msg(reattach_tasks_request_msg_t **,
@@ -495,6 +517,11 @@ static int  _unpack_job_step_kill_msg(job_step_kill_msg_t ** msg_ptr,
 				      Buf buffer,
 				      uint16_t protocol_version);
 
+static void _pack_kill_jobs_msg(kill_jobs_msg_t * msg, Buf buffer,
+				uint16_t protocol_version);
+static int  _unpack_kill_jobs_msg(kill_jobs_msg_t ** msg_ptr, Buf buffer,
+				  uint16_t protocol_version);
+
 static void _pack_srun_exec_msg(srun_exec_msg_t * msg, Buf buffer,
 				uint16_t protocol_version);
 static int  _unpack_srun_exec_msg(srun_exec_msg_t ** msg_ptr, Buf buffer,
@@ -610,6 +637,13 @@ static void _pack_job_notify(job_notify_msg_t *msg, Buf buffer,
 static int  _unpack_job_notify(job_notify_msg_t **msg_ptr, Buf buffer,
 			       uint16_t protocol_version);
 
+static void _pack_job_state_subscribe_msg(job_state_subscribe_msg_t *msg,
+					  Buf buffer,
+					  uint16_t protocol_version);
+static int  _unpack_job_state_subscribe_msg(
+	job_state_subscribe_msg_t **msg_ptr, Buf buffer,
+	uint16_t protocol_version);
+
 static void _pack_set_debug_flags_msg(set_debug_flags_msg_t * msg, Buf buffer,
 				      uint16_t protocol_version);
 static int _unpack_set_debug_flags_msg(set_debug_flags_msg_t ** msg_ptr,
@@ -1003,6 +1037,33 @@ unpack_error:
 }
 
 
+/* slurm_msg_body_prepacked
+ * Return true if the message body is already a packed image
+ * (msg->data/msg->data_size) that pack_msg() would copy verbatim via
+ * _pack_buffer_msg(). Such bodies can be transmitted directly with
+ * slurm_msg_sendv() instead of being coalesced into the send buffer.
+ */
+extern bool slurm_msg_body_prepacked(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_BLOCK_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_FRONT_END_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_STATS_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_LAYOUT_INFO:
+	case RESPONSE_LICENSE_INFO:
+	case RESPONSE_ASSOC_MGR_INFO:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /* pack_msg
  * packs a generic slurm protocol message body
  * IN msg - the body structure to pack (note: includes message type)
@@ -1079,6 +1140,16 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 				   msg->data, buffer,
 				   msg->protocol_version);
 		break;
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		_pack_job_desc_list_msg((job_desc_list_msg_t *)
+					msg->data, buffer,
+					msg->protocol_version);
+		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		_pack_submit_response_list_msg((submit_response_list_msg_t *)
+					       msg->data, buffer,
+					       msg->protocol_version);
+		break;
 	case REQUEST_UPDATE_JOB_STEP:
 		_pack_update_job_step_msg((step_update_request_msg_t *)
 					  msg->data, buffer,
@@ -1128,6 +1199,11 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		_pack_shutdown_msg((shutdown_msg_t *) msg->data, buffer,
 				   msg->protocol_version);
 		break;
+	case REQUEST_CTLD_STATE_STREAM:
+		_pack_ctld_state_stream_msg((ctld_state_stream_msg_t *)
+					    msg->data, buffer,
+					    msg->protocol_version);
+		break;
 	case RESPONSE_SUBMIT_BATCH_JOB:
 		_pack_submit_response_msg((submit_response_msg_t *)
 					  msg->data, buffer,
@@ -1257,6 +1333,10 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					msg->data, buffer,
 					msg->protocol_version);
 		break;
+	case REQUEST_KILL_JOBS:
+		_pack_kill_jobs_msg((kill_jobs_msg_t *) msg->data, buffer,
+				    msg->protocol_version);
+		break;
 	case REQUEST_COMPLETE_JOB_ALLOCATION:
 		_pack_complete_job_allocation_msg(
 			(complete_job_allocation_msg_t *)msg->data, buffer,
@@ -1533,6 +1613,11 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		_pack_job_notify((job_notify_msg_t *) msg->data, buffer,
 				 msg->protocol_version);
 		break;
+	case REQUEST_JOB_STATE_SUBSCRIBE:
+		_pack_job_state_subscribe_msg(
+			(job_state_subscribe_msg_t *) msg->data, buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_SET_DEBUG_FLAGS:
 		_pack_set_debug_flags_msg(
 			(set_debug_flags_msg_t *)msg->data, buffer,
@@ -1742,6 +1827,16 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					  buffer,
 					  msg->protocol_version);
 		break;
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		rc = _unpack_job_desc_list_msg(
+			(job_desc_list_msg_t **) & (msg->data),
+			buffer, msg->protocol_version);
+		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		rc = _unpack_submit_response_list_msg(
+			(submit_response_list_msg_t **) & (msg->data),
+			buffer, msg->protocol_version);
+		break;
 	case REQUEST_UPDATE_JOB_STEP:
 		rc = _unpack_update_job_step_msg(
 			(step_update_request_msg_t **) & (msg->data),
@@ -1792,6 +1887,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					  buffer,
 					  msg->protocol_version);
 		break;
+	case REQUEST_CTLD_STATE_STREAM:
+		rc = _unpack_ctld_state_stream_msg(
+			(ctld_state_stream_msg_t **) & (msg->data),
+			buffer, msg->protocol_version);
+		break;
 	case RESPONSE_SUBMIT_BATCH_JOB:
 		rc = _unpack_submit_response_msg((submit_response_msg_t **)
 						 & (msg->data), buffer,
@@ -1932,6 +2032,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					       & (msg->data), buffer,
 					       msg->protocol_version);
 		break;
+	case REQUEST_KILL_JOBS:
+		rc = _unpack_kill_jobs_msg((kill_jobs_msg_t **)
+					   & (msg->data), buffer,
+					   msg->protocol_version);
+		break;
 	case REQUEST_COMPLETE_JOB_ALLOCATION:
 		rc = _unpack_complete_job_allocation_msg(
 			(complete_job_allocation_msg_t **)&msg->data, buffer,
@@ -2239,6 +2344,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					 &msg->data, buffer,
 					 msg->protocol_version);
 		break;
+	case REQUEST_JOB_STATE_SUBSCRIBE:
+		rc = _unpack_job_state_subscribe_msg(
+			(job_state_subscribe_msg_t **)
+			&msg->data, buffer, msg->protocol_version);
+		break;
 	case REQUEST_SET_DEBUG_FLAGS:
 		rc = _unpack_set_debug_flags_msg(
 			(set_debug_flags_msg_t **)&(msg->data), buffer,
@@ -3335,7 +3445,51 @@ _pack_node_registration_status_msg(slurm_node_registration_status_msg_t *
 	uint32_t gres_info_size = 0;
 	xassert(msg != NULL);
 
-	if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		pack_time(msg->timestamp, buffer);
+		pack_time(msg->slurmd_start_time, buffer);
+		pack32(msg->status, buffer);
+		packstr(msg->features_active, buffer);
+		packstr(msg->features_avail, buffer);
+		packstr(msg->node_name, buffer);
+		packstr(msg->arch, buffer);
+		packstr(msg->cpu_spec_list, buffer);
+		packstr(msg->os, buffer);
+		pack16(msg->cpus, buffer);
+		pack16(msg->boards, buffer);
+		pack16(msg->sockets, buffer);
+		pack16(msg->cores, buffer);
+		pack16(msg->threads, buffer);
+		pack32(msg->real_memory, buffer);
+		pack32(msg->tmp_disk, buffer);
+		pack32(msg->up_time, buffer);
+		pack32(msg->hash_val, buffer);
+		pack32(msg->config_digest, buffer);
+		pack16(msg->delta, buffer);
+		pack32(msg->cpu_load, buffer);
+		pack32(msg->free_mem, buffer);
+
+		pack32(msg->job_count, buffer);
+		for (i = 0; i < msg->job_count; i++) {
+			pack32(msg->job_id[i], buffer);
+		}
+		for (i = 0; i < msg->job_count; i++) {
+			pack32(msg->step_id[i], buffer);
+		}
+		pack16(msg->startup, buffer);
+		if (msg->startup)
+			switch_g_pack_node_info(msg->switch_nodeinfo, buffer,
+						protocol_version);
+		if (msg->gres_info)
+			gres_info_size = get_buf_offset(msg->gres_info);
+		pack32(gres_info_size, buffer);
+		if (gres_info_size) {
+			packmem(get_buf_data(msg->gres_info), gres_info_size,
+				buffer);
+		}
+		acct_gather_energy_pack(msg->energy, buffer, protocol_version);
+		packstr(msg->version, buffer);
+	} else if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
 		pack_time(msg->timestamp, buffer);
 		pack_time(msg->slurmd_start_time, buffer);
 		pack32(msg->status, buffer);
@@ -3438,7 +3592,71 @@ _unpack_node_registration_status_msg(slurm_node_registration_status_msg_t
 	node_reg_ptr = xmalloc(sizeof(slurm_node_registration_status_msg_t));
 	*msg = node_reg_ptr;
 
-	if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		/* unpack timestamp of snapshot */
+		safe_unpack_time(&node_reg_ptr->timestamp, buffer);
+		safe_unpack_time(&node_reg_ptr->slurmd_start_time, buffer);
+		/* load the data values */
+		safe_unpack32(&node_reg_ptr->status, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->features_active,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->features_avail,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->node_name,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->arch,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->cpu_spec_list,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&node_reg_ptr->os, &uint32_tmp, buffer);
+		safe_unpack16(&node_reg_ptr->cpus, buffer);
+		safe_unpack16(&node_reg_ptr->boards, buffer);
+		safe_unpack16(&node_reg_ptr->sockets, buffer);
+		safe_unpack16(&node_reg_ptr->cores, buffer);
+		safe_unpack16(&node_reg_ptr->threads, buffer);
+		safe_unpack32(&node_reg_ptr->real_memory, buffer);
+		safe_unpack32(&node_reg_ptr->tmp_disk, buffer);
+		safe_unpack32(&node_reg_ptr->up_time, buffer);
+		safe_unpack32(&node_reg_ptr->hash_val, buffer);
+		safe_unpack32(&node_reg_ptr->config_digest, buffer);
+		safe_unpack16(&node_reg_ptr->delta, buffer);
+		safe_unpack32(&node_reg_ptr->cpu_load, buffer);
+		safe_unpack32(&node_reg_ptr->free_mem, buffer);
+
+		safe_unpack32(&node_reg_ptr->job_count, buffer);
+		node_reg_ptr->job_id =
+			xmalloc(sizeof(uint32_t) * node_reg_ptr->job_count);
+		for (i = 0; i < node_reg_ptr->job_count; i++) {
+			safe_unpack32(&node_reg_ptr->job_id[i], buffer);
+		}
+		node_reg_ptr->step_id =
+			xmalloc(sizeof(uint32_t) * node_reg_ptr->job_count);
+		for (i = 0; i < node_reg_ptr->job_count; i++) {
+			safe_unpack32(&node_reg_ptr->step_id[i], buffer);
+		}
+
+		safe_unpack16(&node_reg_ptr->startup, buffer);
+		if (node_reg_ptr->startup
+		    &&  (switch_g_unpack_node_info(
+				 &node_reg_ptr->switch_nodeinfo, buffer,
+				 protocol_version)))
+			goto unpack_error;
+
+		safe_unpack32(&gres_info_size, buffer);
+		if (gres_info_size) {
+			safe_unpackmem_xmalloc(&gres_info, &uint32_tmp, buffer);
+			if (gres_info_size != uint32_tmp)
+				goto unpack_error;
+			node_reg_ptr->gres_info = create_buf(gres_info,
+							     gres_info_size);
+		}
+		if (acct_gather_energy_unpack(&node_reg_ptr->energy, buffer,
+					      protocol_version, 1)
+		    != SLURM_SUCCESS)
+			goto unpack_error;
+		safe_unpackstr_xmalloc(&node_reg_ptr->version,
+				       &uint32_tmp, buffer);
+	} else if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
 		/* unpack timestamp of snapshot */
 		safe_unpack_time(&node_reg_ptr->timestamp, buffer);
 		safe_unpack_time(&node_reg_ptr->slurmd_start_time, buffer);
@@ -3922,6 +4140,96 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void
+_pack_job_desc_list_msg(job_desc_list_msg_t * msg, Buf buffer,
+			uint16_t protocol_version)
+{
+	uint32_t i;
+
+	xassert(msg != NULL);
+
+	pack32(msg->job_count, buffer);
+	for (i = 0; i < msg->job_count; i++)
+		_pack_job_desc_msg(msg->job_descs[i], buffer,
+				   protocol_version);
+}
+
+static int
+_unpack_job_desc_list_msg(job_desc_list_msg_t ** msg, Buf buffer,
+			  uint16_t protocol_version)
+{
+	job_desc_list_msg_t *tmp_ptr;
+	uint32_t i, job_count;
+
+	xassert(msg != NULL);
+	tmp_ptr = xmalloc(sizeof(job_desc_list_msg_t));
+	*msg = tmp_ptr;
+
+	safe_unpack32(&job_count, buffer);
+	if (job_count > MAX_BATCH_JOB_COUNT)
+		goto unpack_error;
+	tmp_ptr->job_descs = xmalloc(job_count *
+				     sizeof(job_desc_msg_t *));
+	for (i = 0; i < job_count; i++) {
+		if (_unpack_job_desc_msg(&tmp_ptr->job_descs[i], buffer,
+					 protocol_version) != SLURM_SUCCESS)
+			goto unpack_error;
+		/* set as we go so a failure only frees what we have */
+		tmp_ptr->job_count = i + 1;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_desc_list_msg(tmp_ptr);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
+static void
+_pack_submit_response_list_msg(submit_response_list_msg_t * msg, Buf buffer,
+			       uint16_t protocol_version)
+{
+	uint32_t i;
+
+	xassert(msg != NULL);
+
+	pack32(msg->resp_count, buffer);
+	for (i = 0; i < msg->resp_count; i++) {
+		pack32(msg->resps[i].job_id, buffer);
+		pack32(msg->resps[i].step_id, buffer);
+		pack32(msg->resps[i].error_code, buffer);
+	}
+}
+
+static int
+_unpack_submit_response_list_msg(submit_response_list_msg_t ** msg, Buf buffer,
+				 uint16_t protocol_version)
+{
+	submit_response_list_msg_t *tmp_ptr;
+	uint32_t i;
+
+	xassert(msg != NULL);
+	tmp_ptr = xmalloc(sizeof(submit_response_list_msg_t));
+	*msg = tmp_ptr;
+
+	safe_unpack32(&tmp_ptr->resp_count, buffer);
+	if (tmp_ptr->resp_count > MAX_BATCH_JOB_COUNT)
+		goto unpack_error;
+	tmp_ptr->resps = xmalloc(tmp_ptr->resp_count *
+				 sizeof(submit_response_msg_t));
+	for (i = 0; i < tmp_ptr->resp_count; i++) {
+		safe_unpack32(&tmp_ptr->resps[i].job_id, buffer);
+		safe_unpack32(&tmp_ptr->resps[i].step_id, buffer);
+		safe_unpack32(&tmp_ptr->resps[i].error_code, buffer);
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_submit_response_list_msg(tmp_ptr);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static int
 _unpack_node_info_msg(node_info_msg_t ** msg, Buf buffer,
 		      uint16_t protocol_version)
@@ -5414,6 +5722,19 @@ _unpack_job_info_msg(job_info_msg_t ** msg, Buf buffer,
 		safe_unpack32(&((*msg)->record_count), buffer);
 		safe_unpack_time(&((*msg)->last_update), buffer);
 
+		if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+			safe_unpack16(&((*msg)->diff_mode), buffer);
+			safe_unpack32_array(&((*msg)->deleted_job_ids),
+					    &((*msg)->deleted_job_count),
+					    buffer);
+
+			/* Job strings are unpacked by reference, retain the
+			 * buffer they point into until the response message
+			 * is freed, see slurm_free_job_info_msg() */
+			retain_buf(buffer);
+			(*msg)->unpack_buf = buffer;
+		}
+
 		if ((*msg)->record_count)
 			job = (*msg)->job_array = xmalloc(sizeof(job_info_t) *
 							  (*msg)->record_count);
@@ -5582,34 +5903,34 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 		safe_unpack_time(&job->preempt_time, buffer);
 		safe_unpack32(&job->priority, buffer);
 		safe_unpackdouble(&job->billable_tres, buffer);
-		safe_unpackstr_xmalloc(&job->nodes, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->sched_nodes, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->partition, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->account, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->admin_comment, &uint32_tmp,buffer);
-		safe_unpackstr_xmalloc(&job->network, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->comment, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->gres, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->batch_host, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->batch_script, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->burst_buffer, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->qos, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->licenses, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->state_desc, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->resv_name,  &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->mcs_label,  &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->nodes, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->sched_nodes, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->partition, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->account, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->admin_comment, &uint32_tmp,buffer);
+		safe_unpackstr_ptr(&job->network, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->comment, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->gres, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->batch_host, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->batch_script, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->burst_buffer, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->qos, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->licenses, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->state_desc, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->resv_name,  &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->mcs_label,  &uint32_tmp, buffer);
 
 		safe_unpack32(&job->exit_code, buffer);
 		safe_unpack32(&job->derived_ec, buffer);
 		unpack_job_resources(&job->job_resrcs, buffer,
 				     protocol_version);
 
-		safe_unpackstr_xmalloc(&job->name, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->wckey, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->name, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->wckey, &uint32_tmp, buffer);
 		safe_unpack32(&job->req_switch, buffer);
 		safe_unpack32(&job->wait4switch, buffer);
 
-		safe_unpackstr_xmalloc(&job->alloc_node, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->alloc_node, &uint32_tmp, buffer);
 		safe_unpackstr_xmalloc(&node_inx_str, &uint32_tmp, buffer);
 		if (node_inx_str == NULL)
 			job->node_inx = bitfmt2int("");
@@ -5623,10 +5944,10 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 			goto unpack_error;
 
 		/*** unpack default job details ***/
-		safe_unpackstr_xmalloc(&job->features,   &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->work_dir,   &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->dependency, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->command,    &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->features,   &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->work_dir,   &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->dependency, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->command,    &uint32_tmp, buffer);
 
 		safe_unpack32(&job->num_cpus, buffer);
 		safe_unpack32(&job->max_cpus, buffer);
@@ -5650,7 +5971,7 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 		safe_unpack32(&job->pn_min_memory, buffer);
 		safe_unpack32(&job->pn_min_tmp_disk, buffer);
 
-		safe_unpackstr_xmalloc(&job->req_nodes, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->req_nodes, &uint32_tmp, buffer);
 		safe_unpackstr_xmalloc(&node_inx_str, &uint32_tmp, buffer);
 		if (node_inx_str == NULL)
 			job->req_node_inx = bitfmt2int("");
@@ -5658,7 +5979,7 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 			job->req_node_inx = bitfmt2int(node_inx_str);
 			xfree(node_inx_str);
 		}
-		safe_unpackstr_xmalloc(&job->exc_nodes, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->exc_nodes, &uint32_tmp, buffer);
 		safe_unpackstr_xmalloc(&node_inx_str, &uint32_tmp, buffer);
 		if (node_inx_str == NULL)
 			job->exc_node_inx = bitfmt2int("");
@@ -5667,9 +5988,9 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 			xfree(node_inx_str);
 		}
 
-		safe_unpackstr_xmalloc(&job->std_err, &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->std_in,  &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->std_out, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->std_err, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->std_in,  &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->std_out, &uint32_tmp, buffer);
 
 		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
 			goto unpack_error;
@@ -5685,10 +6006,8 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 			xfree(mc_ptr);
 		}
 		safe_unpack32(&job->bitflags, buffer);
-		safe_unpackstr_xmalloc(&job->tres_alloc_str,
-				       &uint32_tmp, buffer);
-		safe_unpackstr_xmalloc(&job->tres_req_str,
-				       &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->tres_alloc_str, &uint32_tmp, buffer);
+		safe_unpackstr_ptr(&job->tres_req_str, &uint32_tmp, buffer);
 		safe_unpack16(&job->start_protocol_ver, buffer);
 	} else if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
 		safe_unpack32(&job->array_job_id, buffer);
@@ -5995,7 +6314,11 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 	return SLURM_SUCCESS;
 
 unpack_error:
-	slurm_free_job_info_members(job);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		/* String members reference the unpack buffer */
+		slurm_free_job_info_borrowed_members(job);
+	} else
+		slurm_free_job_info_members(job);
 	return SLURM_ERROR;
 }
 
@@ -9336,6 +9659,45 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void
+_pack_ctld_state_stream_msg(ctld_state_stream_msg_t * msg, Buf buffer,
+			    uint16_t protocol_version)
+{
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		packstr(msg->file_name, buffer);
+		packmem(msg->data, msg->data_size, buffer);
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+	}
+}
+
+static int
+_unpack_ctld_state_stream_msg(ctld_state_stream_msg_t ** msg_ptr, Buf buffer,
+			      uint16_t protocol_version)
+{
+	uint32_t uint32_tmp;
+	ctld_state_stream_msg_t *msg;
+
+	msg = xmalloc(sizeof(ctld_state_stream_msg_t));
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		safe_unpackstr_xmalloc(&msg->file_name, &uint32_tmp, buffer);
+		safe_unpackmem_xmalloc(&msg->data, &msg->data_size, buffer);
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+		goto unpack_error;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_ctld_state_stream_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 /* _pack_job_step_kill_msg
  * packs a slurm job step signal message
  * IN msg - pointer to the job step signal message
@@ -9387,6 +9749,67 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* _pack_kill_jobs_msg
+ * packs a bulk job cancellation message
+ * IN msg - pointer to the bulk job cancellation message
+ * IN/OUT buffer - destination of the pack, contains pointers that are
+ *			automatically updated
+ */
+static void
+_pack_kill_jobs_msg(kill_jobs_msg_t * msg, Buf buffer,
+		    uint16_t protocol_version)
+{
+	uint32_t i;
+
+	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		pack32(msg->job_cnt, buffer);
+		for (i = 0; i < msg->job_cnt; i++)
+			packstr(msg->job_ids[i], buffer);
+		pack16((uint16_t)msg->signal, buffer);
+		pack16((uint16_t)msg->flags, buffer);
+	}
+}
+
+/* _unpack_kill_jobs_msg
+ * unpacks a bulk job cancellation message
+ * OUT msg_ptr - pointer to the bulk job cancellation message buffer
+ * IN/OUT buffer - source of the unpack, contains pointers that are
+ *			automatically updated
+ */
+static int
+_unpack_kill_jobs_msg(kill_jobs_msg_t ** msg_ptr, Buf buffer,
+		      uint16_t protocol_version)
+{
+	kill_jobs_msg_t *msg;
+	uint32_t i, cc;
+
+	msg = xmalloc(sizeof(kill_jobs_msg_t));
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->job_cnt, buffer);
+		if (msg->job_cnt > (16 * 1024 * 1024))	/* sanity check */
+			goto unpack_error;
+		if (msg->job_cnt) {
+			msg->job_ids = xmalloc(msg->job_cnt *
+					       sizeof(char *));
+			for (i = 0; i < msg->job_cnt; i++) {
+				safe_unpackstr_xmalloc(&msg->job_ids[i],
+						       &cc, buffer);
+			}
+		}
+		safe_unpack16(&msg->signal, buffer);
+		safe_unpack16(&msg->flags, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_kill_jobs_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 static void
 _pack_update_job_step_msg(step_update_request_msg_t * msg, Buf buffer,
 			  uint16_t protocol_version)
@@ -9820,8 +10243,17 @@ static void
 _pack_job_info_request_msg(job_info_request_msg_t * msg, Buf buffer,
 			   uint16_t protocol_version)
 {
-	pack_time(msg->last_update, buffer);
-	pack16((uint16_t)msg->show_flags, buffer);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		pack_time(msg->last_update, buffer);
+		pack16((uint16_t)msg->show_flags, buffer);
+		pack32_array(msg->job_ids, msg->job_id_count, buffer);
+		packstr(msg->partitions, buffer);
+		pack32_array(msg->states, msg->state_count, buffer);
+		pack32_array(msg->user_ids, msg->user_count, buffer);
+	} else {
+		pack_time(msg->last_update, buffer);
+		pack16((uint16_t)msg->show_flags, buffer);
+	}
 }
 
 static int
@@ -9831,11 +10263,25 @@ _unpack_job_info_request_msg(job_info_request_msg_t** msg,
 {
 	job_info_request_msg_t*job_info;
 
-	job_info = xmalloc(sizeof(job_step_info_request_msg_t));
+	job_info = xmalloc(sizeof(job_info_request_msg_t));
 	*msg = job_info;
 
-	safe_unpack_time(&job_info->last_update, buffer);
-	safe_unpack16(&job_info->show_flags, buffer);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		uint32_t uint32_tmp;
+		safe_unpack_time(&job_info->last_update, buffer);
+		safe_unpack16(&job_info->show_flags, buffer);
+		safe_unpack32_array(&job_info->job_ids,
+				    &job_info->job_id_count, buffer);
+		safe_unpackstr_xmalloc(&job_info->partitions, &uint32_tmp,
+				       buffer);
+		safe_unpack32_array(&job_info->states,
+				    &job_info->state_count, buffer);
+		safe_unpack32_array(&job_info->user_ids,
+				    &job_info->user_count, buffer);
+	} else {
+		safe_unpack_time(&job_info->last_update, buffer);
+		safe_unpack16(&job_info->show_flags, buffer);
+	}
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -11740,7 +12186,7 @@ static void _pack_file_bcast(file_bcast_msg_t * msg , Buf buffer,
 
 	grow_buf(buffer,  msg->block_len);
 
-	if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
 		pack16 ( msg->block_no, buffer );
 		pack16 ( msg->compress, buffer );
 		pack16 ( msg->last_block, buffer );
@@ -11757,7 +12203,29 @@ static void _pack_file_bcast(file_bcast_msg_t * msg , Buf buffer,
 		packstr ( msg->fname, buffer );
 		pack32 ( msg->block_len, buffer );
 		pack32(msg->uncomp_len, buffer);
-		pack32(msg->block_offset, buffer);
+		pack64(msg->block_offset, buffer);
+		pack64(msg->file_size, buffer);
+		pack64(msg->digest, buffer);
+		packmem ( msg->block, msg->block_len, buffer );
+		pack_sbcast_cred( msg->cred, buffer );
+	} else if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+		pack16 ( msg->block_no, buffer );
+		pack16 ( msg->compress, buffer );
+		pack16 ( msg->last_block, buffer );
+		pack16 ( msg->force, buffer );
+		pack16 ( msg->modes, buffer );
+
+		pack32 ( msg->uid, buffer );
+		packstr ( msg->user_name, buffer );
+		pack32 ( msg->gid, buffer );
+
+		pack_time ( msg->atime, buffer );
+		pack_time ( msg->mtime, buffer );
+
+		packstr ( msg->fname, buffer );
+		pack32 ( msg->block_len, buffer );
+		pack32(msg->uncomp_len, buffer);
+		pack32((uint32_t) msg->block_offset, buffer);
 		pack64(msg->file_size, buffer);
 		packmem ( msg->block, msg->block_len, buffer );
 		pack_sbcast_cred( msg->cred, buffer );
@@ -11792,7 +12260,34 @@ static int _unpack_file_bcast(file_bcast_msg_t ** msg_ptr , Buf buffer,
 	msg = xmalloc ( sizeof (file_bcast_msg_t) ) ;
 	*msg_ptr = msg;
 
-	if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		safe_unpack16 ( & msg->block_no, buffer );
+		safe_unpack16 ( & msg->compress, buffer );
+		safe_unpack16 ( & msg->last_block, buffer );
+		safe_unpack16 ( & msg->force, buffer );
+		safe_unpack16 ( & msg->modes, buffer );
+
+		safe_unpack32 ( & msg->uid, buffer );
+		safe_unpackstr_xmalloc ( &msg->user_name, &uint32_tmp, buffer );
+		safe_unpack32 ( & msg->gid, buffer );
+
+		safe_unpack_time ( & msg->atime, buffer );
+		safe_unpack_time ( & msg->mtime, buffer );
+
+		safe_unpackstr_xmalloc ( & msg->fname, &uint32_tmp, buffer );
+		safe_unpack32 ( & msg->block_len, buffer );
+		safe_unpack32(&msg->uncomp_len, buffer);
+		safe_unpack64(&msg->block_offset, buffer);
+		safe_unpack64(&msg->file_size, buffer);
+		safe_unpack64(&msg->digest, buffer);
+		safe_unpackmem_xmalloc ( & msg->block, &uint32_tmp , buffer ) ;
+		if ( uint32_tmp != msg->block_len )
+			goto unpack_error;
+
+		msg->cred = unpack_sbcast_cred( buffer );
+		if (msg->cred == NULL)
+			goto unpack_error;
+	} else if (protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
 		safe_unpack16 ( & msg->block_no, buffer );
 		safe_unpack16 ( & msg->compress, buffer );
 		safe_unpack16 ( & msg->last_block, buffer );
@@ -11809,7 +12304,8 @@ static int _unpack_file_bcast(file_bcast_msg_t ** msg_ptr , Buf buffer,
 		safe_unpackstr_xmalloc ( & msg->fname, &uint32_tmp, buffer );
 		safe_unpack32 ( & msg->block_len, buffer );
 		safe_unpack32(&msg->uncomp_len, buffer);
-		safe_unpack32(&msg->block_offset, buffer);
+		safe_unpack32(&uint32_tmp, buffer);
+		msg->block_offset = uint32_tmp;
 		safe_unpack64(&msg->file_size, buffer);
 		safe_unpackmem_xmalloc ( & msg->block, &uint32_tmp , buffer ) ;
 		if ( uint32_tmp != msg->block_len )
@@ -12242,6 +12738,38 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_job_state_subscribe_msg(job_state_subscribe_msg_t *msg,
+					  Buf buffer,
+					  uint16_t protocol_version)
+{
+	xassert(msg);
+
+	pack32(msg->job_id, buffer);
+	pack16(msg->port,   buffer);
+}
+
+static int  _unpack_job_state_subscribe_msg(
+	job_state_subscribe_msg_t **msg_ptr, Buf buffer,
+	uint16_t protocol_version)
+{
+	job_state_subscribe_msg_t *msg;
+
+	xassert(msg_ptr);
+
+	msg = xmalloc(sizeof(job_state_subscribe_msg_t));
+
+	safe_unpack32(&msg->job_id, buffer);
+	safe_unpack16(&msg->port,   buffer);
+
+	*msg_ptr = msg;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_state_subscribe_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 static void
 _pack_set_debug_flags_msg(set_debug_flags_msg_t * msg, Buf buffer,
 			  uint16_t protocol_version)
@@ -12647,6 +13175,43 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 		safe_unpack32_array(&msg->rpc_user_id,   &uint32_tmp, buffer);
 		safe_unpack32_array(&msg->rpc_user_cnt,  &uint32_tmp, buffer);
 		safe_unpack64_array(&msg->rpc_user_time, &uint32_tmp, buffer);
+
+		if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+			safe_unpack32(&msg->rpc_hist_buckets,	buffer);
+			safe_unpack64_array(&msg->rpc_type_hist,
+					    &uint32_tmp, buffer);
+			safe_unpack32(&msg->lock_stats_size,	buffer);
+			safe_unpack64_array(&msg->lock_read_cnt,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->lock_read_wait,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->lock_write_cnt,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->lock_write_wait,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->lock_write_hold,
+					    &uint32_tmp, buffer);
+			safe_unpack32(&msg->rec_pool_size,	buffer);
+			safe_unpack32_array(&msg->rec_pool_occupancy,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->rec_pool_allocs,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->rec_pool_reuses,
+					    &uint32_tmp, buffer);
+			safe_unpack32(&msg->prof_region_size,	buffer);
+			safe_unpackstr_array(&msg->prof_region_names,
+					     &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->prof_region_counts,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->prof_region_time,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->prof_region_time_min,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->prof_region_time_max,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->prof_region_time_p99,
+					    &uint32_tmp, buffer);
+		}
 	} else {
 		error("_unpack_stats_response_msg: protocol_version "
 		      "%hu not supported", protocol_version);
@@ -71,6 +71,12 @@ extern int unpack_header ( header_t * header , Buf buffer );
 /* generic case statement Pack / Unpack methods for slurm protocol bodies */
 /**************************************************************************/
 
+/* slurm_msg_body_prepacked
+ * Return true if messages of this type carry an already packed body
+ * image in msg->data/msg->data_size, copied verbatim by pack_msg()
+ */
+extern bool slurm_msg_body_prepacked(uint16_t msg_type);
+
 /* pack_msg
  * packs a generic slurm protocol message body
  * IN msg - the body structure to pack (note: includes message type)
@@ -42,6 +42,7 @@
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <poll.h>
@@ -54,6 +55,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "slurm/slurm_errno.h"
@@ -66,6 +68,10 @@
 #include "src/common/xmalloc.h"
 #include "src/common/util-net.h"
 
+#ifndef IOV_MAX
+#  define IOV_MAX	1024	/* POSIX guarantees at least _XOPEN_IOV_MAX */
+#endif
+
 #define PORT_RETRIES    3
 #define MIN_USER_PORT   (IPPORT_RESERVED + 1)
 #define MAX_USER_PORT   0xffff
@@ -208,6 +214,51 @@ ssize_t slurm_msg_sendto_timeout(int fd, char *buffer, size_t size,
 	return len;
 }
 
+extern ssize_t slurm_msg_sendv(int fd, struct iovec *iov, int iovcnt,
+			       uint32_t flags)
+{
+	return slurm_msg_sendv_timeout(fd, iov, iovcnt, flags,
+				(slurm_get_msg_timeout() * 1000));
+}
+
+ssize_t slurm_msg_sendv_timeout(int fd, struct iovec *iov, int iovcnt,
+				uint32_t flags, int timeout)
+{
+	int   len, i;
+	size_t size = 0;
+	uint32_t usize;
+	struct iovec siov[IOV_MAX];
+	SigFunc *ohandler;
+
+	if ((iovcnt + 1) > IOV_MAX) {
+		slurm_seterrno(EINVAL);
+		return SLURM_ERROR;
+	}
+
+	/* Prepend the message length word, then transmit all segments
+	 * with a single scatter-gather path */
+	for (i = 0; i < iovcnt; i++) {
+		size += iov[i].iov_len;
+		siov[i + 1] = iov[i];
+	}
+	usize = htonl(size);
+	siov[0].iov_base = &usize;
+	siov[0].iov_len  = sizeof(usize);
+
+	/*
+	 *  Ignore SIGPIPE so that send can return a error code if the
+	 *    other side closes the socket
+	 */
+	ohandler = xsignal(SIGPIPE, SIG_IGN);
+
+	len = slurm_writev_timeout(fd, siov, iovcnt + 1, 0, timeout);
+	if (len >= 0)
+		len -= sizeof(usize);
+
+	xsignal(SIGPIPE, ohandler);
+	return len;
+}
+
 /* Send slurm message with timeout
  * RET message size (as specified in argument) or SLURM_ERROR on error */
 extern int slurm_send_timeout(int fd, char *buf, size_t size,
@@ -315,6 +366,128 @@ extern int slurm_send_timeout(int fd, char *buf, size_t size,
 
 }
 
+/* Send a vector of buffers with timeout, without coalescing them first.
+ * The iovec array is modified as segments are consumed.
+ * RET total bytes sent or SLURM_ERROR on error */
+extern int slurm_writev_timeout(int fd, struct iovec *iov, int iovcnt,
+				uint32_t flags, int timeout)
+{
+	ssize_t rc;
+	int sent = 0;
+	int fd_flags;
+	size_t size = 0;
+	struct pollfd ufds;
+	struct timeval tstart;
+	int timeleft = timeout;
+	int inx = 0, i;
+	char temp[2];
+
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+
+	ufds.fd     = fd;
+	ufds.events = POLLOUT;
+
+	fd_flags = _slurm_fcntl(fd, F_GETFL);
+	fd_set_nonblocking(fd);
+
+	gettimeofday(&tstart, NULL);
+
+	while (inx < iovcnt) {
+		timeleft = timeout - _tot_wait(&tstart);
+		if (timeleft <= 0) {
+			debug("slurm_writev_timeout at %d of %zd, timeout",
+			      sent, size);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		if ((rc = poll(&ufds, 1, timeleft)) <= 0) {
+			if ((rc == 0) || (errno == EINTR) || (errno == EAGAIN))
+				continue;
+			else {
+				debug("slurm_writev_timeout at %d of %zd, "
+				      "poll error: %s",
+				      sent, size, strerror(errno));
+				slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+				sent = SLURM_ERROR;
+				goto done;
+			}
+		}
+
+		/*
+		 * Check here to make sure the socket really is there.
+		 * If not then exit out and notify the sender.  This
+		 * is here since a write doesn't always tell you the
+		 * socket is gone, but getting 0 back from a
+		 * nonblocking read means just that.
+		 */
+		if (ufds.revents & POLLERR) {
+			debug("slurm_writev_timeout: Socket POLLERR");
+			slurm_seterrno(ENOTCONN);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+		if ((ufds.revents & POLLHUP) || (ufds.revents & POLLNVAL) ||
+		    (_slurm_recv(fd, &temp, 1, flags) == 0)) {
+			debug2("slurm_writev_timeout: Socket no longer there");
+			slurm_seterrno(ENOTCONN);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+		if ((ufds.revents & POLLOUT) != POLLOUT) {
+			error("slurm_writev_timeout: Poll failure, revents:%d",
+			      ufds.revents);
+		}
+
+		rc = writev(fd, &iov[inx], iovcnt - inx);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			debug("slurm_writev_timeout at %d of %zd, "
+			      "send error: %s",
+			      sent, size, strerror(errno));
+			if (errno == EAGAIN) {	/* poll() lied to us */
+				usleep(10000);
+				continue;
+			}
+			slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+		if (rc == 0) {
+			debug("slurm_writev_timeout at %d of %zd, "
+			      "sent zero bytes", sent, size);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_ZERO_BYTES_SENT);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		sent += rc;
+		/* Advance past fully transmitted segments, adjust any
+		 * partially transmitted one */
+		while ((inx < iovcnt) && (rc >= iov[inx].iov_len)) {
+			rc -= iov[inx].iov_len;
+			inx++;
+		}
+		if ((inx < iovcnt) && rc) {
+			iov[inx].iov_base = ((char *) iov[inx].iov_base) + rc;
+			iov[inx].iov_len -= rc;
+		}
+	}
+
+    done:
+	/* Reset fd flags to prior state, preserve errno */
+	if (fd_flags != SLURM_PROTOCOL_ERROR) {
+		int slurm_err = slurm_get_errno();
+		_slurm_fcntl(fd , F_SETFL , fd_flags);
+		slurm_seterrno(slurm_err);
+	}
+
+	return sent;
+}
+
 /* Get slurm message with timeout
  * RET message size (as specified in argument) or SLURM_ERROR on error */
 extern int slurm_recv_timeout(int fd, char *buffer, size_t size,
@@ -415,7 +588,7 @@ extern int slurm_recv_timeout(int fd, char *buffer, size_t size,
 	return recvlen;
 }
 
-extern int slurm_init_msg_engine(slurm_addr_t *addr)
+static int _init_msg_engine(slurm_addr_t *addr, bool reuseport)
 {
 	int rc;
 	int fd;
@@ -433,6 +606,18 @@ extern int slurm_init_msg_engine(slurm_addr_t *addr)
 		goto error;
 	}
 
+#ifdef SO_REUSEPORT
+	if (reuseport) {
+		rc = _slurm_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT,
+				       &one, sz1);
+		if (rc < 0) {
+			/* carry on; peer shards will fail to bind and
+			 * the caller can fall back to fewer listeners */
+			error("setsockopt SO_REUSEPORT failed: %m");
+		}
+	}
+#endif
+
 	rc = bind(fd, (struct sockaddr const *) addr, sizeof(*addr));
 	if (rc < 0) {
 		error("Error binding slurm stream socket: %m");
@@ -454,6 +639,19 @@ extern int slurm_init_msg_engine(slurm_addr_t *addr)
 
 }
 
+extern int slurm_init_msg_engine(slurm_addr_t *addr)
+{
+	return _init_msg_engine(addr, false);
+}
+
+/* As slurm_init_msg_engine(), but the socket is opened with
+ * SO_REUSEPORT so several listeners can shard one port, each accepting
+ * its own subset of the incoming connections. */
+extern int slurm_init_msg_engine_reuseport(slurm_addr_t *addr)
+{
+	return _init_msg_engine(addr, true);
+}
+
 /* Await a connection on socket FD.
  * When a connection arrives, open a new socket to communicate with it,
  * set *ADDR (which is *ADDR_LEN bytes long) to the address of the connecting
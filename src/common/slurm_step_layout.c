@@ -516,8 +516,8 @@ static int _task_layout_hostfile(slurm_step_layout_t *step_layout,
 {
 	int i=0, j, taskid = 0, task_cnt=0;
 	hostlist_iterator_t itr = NULL, itr_task = NULL;
-	char *host = NULL;
-	char *host_task = NULL;
+	char host[HOSTLIST_NAME_LEN];
+	char host_task[HOSTLIST_NAME_LEN];
 	hostlist_t job_alloc_hosts = NULL;
 	hostlist_t step_alloc_hosts = NULL;
 
@@ -540,14 +540,14 @@ static int _task_layout_hostfile(slurm_step_layout_t *step_layout,
 		return SLURM_ERROR;
 	}
 	itr_task = hostlist_iterator_create(step_alloc_hosts);
-	while((host = hostlist_next(itr))) {
+	while (hostlist_next_buf(itr, host, sizeof(host)) >= 0) {
 		step_layout->tasks[i] = 0;
-		while((host_task = hostlist_next(itr_task))) {
+		while (hostlist_next_buf(itr_task, host_task,
+					 sizeof(host_task)) >= 0) {
 			if (!xstrcmp(host, host_task)) {
 				step_layout->tasks[i]++;
 				task_cnt++;
 			}
-			free(host_task);
 			if (task_cnt >= step_layout->task_cnt)
 				break;
 		}
@@ -559,20 +559,19 @@ static int _task_layout_hostfile(slurm_step_layout_t *step_layout,
 		taskid = 0;
 		j = 0;
 		hostlist_iterator_reset(itr_task);
-		while((host_task = hostlist_next(itr_task))) {
+		while (hostlist_next_buf(itr_task, host_task,
+					 sizeof(host_task)) >= 0) {
 			if (!xstrcmp(host, host_task)) {
 				step_layout->tids[i][j] = taskid;
 				j++;
 			}
 			taskid++;
-			free(host_task);
 			if (j >= step_layout->tasks[i])
 				break;
 		}
 		i++;
 	reset_hosts:
 		hostlist_iterator_reset(itr_task);
-		free(host);
 		if (i > step_layout->task_cnt)
 			break;
 	}
@@ -52,12 +52,16 @@
 struct switch_record *switch_record_table = NULL;
 int switch_record_cnt = 0;
 int switch_levels = 0;               /* number of switch levels     */
+int *switch_node_leaf = NULL;        /* index of each node's leaf switch */
+bitstr_t **switch_desc_bitmap = NULL; /* per switch bitmap of descendant
+				      * switches, self included */
 
 /* defined here but is really hypercube plugin related */
 int hypercube_dimensions = 0; 
 struct hypercube_switch *hypercube_switch_table = NULL; 
 int hypercube_switch_cnt = 0;
 struct hypercube_switch ***hypercube_switches = NULL; 
+int *hypercube_node_table = NULL;
 
 /* ************************************************************************ */
 /*  TAG(                        slurm_topo_ops_t                         )  */
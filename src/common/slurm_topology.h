@@ -66,6 +66,16 @@ extern struct switch_record *switch_record_table;  /* ptr to switch records */
 extern int switch_record_cnt;		/* size of switch_record_table */
 extern int switch_levels;               /* number of switch levels     */
 
+/* Lookup tables precomputed by the tree plugin at topology load time so
+ * best-fit switch selection can use table lookups in place of repeated
+ * bitmap traversals. Both are NULL when no tree topology is loaded. */
+extern int *switch_node_leaf;		/* for each node, the index of its
+					 * leaf (level 0) switch in
+					 * switch_record_table or -1 */
+extern bitstr_t **switch_desc_bitmap;	/* for each switch, bitmap over
+					 * switch indexes of its subtree,
+					 * self included */
+
 /*****************************************************************************\
  *  Hypercube SWITCH topology data structures
  *  defined here but is really hypercube plugin related
@@ -93,6 +103,12 @@ extern int hypercube_switch_cnt; /* size of hypercube_switch_table */
  * with the sorting of the Hilbert curve. */
 extern struct hypercube_switch ***hypercube_switches; 
 
+/* Immutable node to switch lookup with node_record_count entries,
+ * built when the topology is loaded: for each node index, the index of
+ * its switch in the hypercube_switch_table, or -1 if the node is not
+ * connected to any switch. */
+extern int *hypercube_node_table;
+
 /*****************************************************************************\
  *  Slurm topology functions
 \*****************************************************************************/
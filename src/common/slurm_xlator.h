@@ -81,6 +81,7 @@
 #define	bit_clear_all		slurm_bit_clear_all
 #define	bit_ffc			slurm_bit_ffc
 #define	bit_ffs			slurm_bit_ffs
+#define	bit_ffs_from		slurm_bit_ffs_from
 #define	bit_free		slurm_bit_free
 #define	bit_realloc		slurm_bit_realloc
 #define	bit_size		slurm_bit_size
@@ -110,6 +111,11 @@
 #define bit_noc			slurm_bit_noc
 #define bit_nffs		slurm_bit_nffs
 #define bit_copybits		slurm_bit_copybits
+#define bit_cow_create		slurm_bit_cow_create
+#define bit_cow_ref		slurm_bit_cow_ref
+#define bit_cow_free		slurm_bit_cow_free
+#define bit_cow_get		slurm_bit_cow_get
+#define bit_cow_modify		slurm_bit_cow_modify
 
 /* fd.[ch] functions */
 #define fd_read_n		slurm_fd_read_n
@@ -135,6 +141,8 @@
 #define	hostlist_iterator_destroy slurm_hostlist_iterator_destroy
 #define	hostlist_iterator_reset	slurm_hostlist_iterator_reset
 #define	hostlist_next		slurm_hostlist_next
+#define	hostlist_next_buf	slurm_hostlist_next_buf
+#define	hostlist_next_parts	slurm_hostlist_next_parts
 #define	hostlist_next_range	slurm_hostlist_next_range
 #define	hostlist_nth		slurm_hostlist_nth
 #define	hostlist_pop            slurm_hostlist_pop
@@ -164,6 +172,7 @@
 
 /* list.[ch] functions */
 #define	list_create		slurm_list_create
+#define	list_create_sized	slurm_list_create_sized
 #define	list_destroy		slurm_list_destroy
 #define	list_is_empty		slurm_list_is_empty
 #define	list_count		slurm_list_count
@@ -173,6 +182,7 @@
 #define	list_delete_all		slurm_list_delete_all
 #define	list_for_each		slurm_list_for_each
 #define	list_sort		slurm_list_sort
+#define	list_insert_sorted	slurm_list_insert_sorted
 #define	list_push		slurm_list_push
 #define	list_pop		slurm_list_pop
 #define	list_peek		slurm_list_peek
@@ -198,6 +208,7 @@
 #define	log_fp			slurm_log_fp
 #define	log_has_data		slurm_log_has_data
 #define	log_flush		slurm_log_flush
+#define	log_set_async		slurm_log_set_async
 #define	dump_cleanup_list	slurm_dump_cleanup_list
 #define	fatal_add_cleanup	slurm_fatal_add_cleanup
 #define	fatal_add_cleanup_job	slurm_fatal_add_cleanup_job
@@ -225,9 +236,11 @@
 
 /* pack.[ch] functions */
 #define	create_buf		slurm_create_buf
+#define	create_mmap_buf		slurm_create_mmap_buf
 #define	free_buf		slurm_free_buf
 #define grow_buf		slurm_grow_buf
 #define	init_buf		slurm_init_buf
+#define	retain_buf		slurm_retain_buf
 #define	xfer_buf_data		slurm_xfer_buf_data
 #define	pack_time		slurm_pack_time
 #define	unpack_time		slurm_unpack_time
@@ -325,6 +338,13 @@
 #define xstrchr			slurm_xstrchr
 #define xstrcmp			slurm_xstrcmp
 #define xstrcasecmp		slurm_xstrcasecmp
+#define xstrbuf_init		slurm_xstrbuf_init
+#define xstrbuf_cat		slurm_xstrbuf_cat
+#define xstrbuf_ncat		slurm_xstrbuf_ncat
+#define xstrbuf_catchar		slurm_xstrbuf_catchar
+#define xstrbuf_fmtcat		slurm_xstrbuf_fmtcat
+#define xstrbuf_release		slurm_xstrbuf_release
+#define xstrbuf_free		slurm_xstrbuf_free
 
 /* slurm_protocol_api.[ch] functions */
 #define convert_num_unit2       slurm_convert_num_unit2
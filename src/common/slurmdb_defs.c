@@ -488,20 +488,62 @@ static int _set_qos_bit_from_string(bitstr_t *valid_qos, char *name)
 	return SLURM_SUCCESS;
 }
 
-static int _find_arch_in_list(void *x, void *key)
+/* Hash over association ids used while building the account hierarchy,
+ * replacing the linear list searches for each association's parent
+ * which made tree construction O(n^2) on large databases. */
+#define ARCH_HASH_SIZE 1024
+#define ARCH_HASH_INX(_id) ((_id) % ARCH_HASH_SIZE)
+
+typedef struct arch_hash_ent {
+	struct arch_hash_ent *next;
+	uint32_t id;
+	char *cluster;
+	void *data;
+} arch_hash_ent_t;
+
+static void _arch_hash_add(arch_hash_ent_t **hash, uint32_t id,
+			   char *cluster, void *data)
 {
-	slurmdb_hierarchical_rec_t *arch_rec = (slurmdb_hierarchical_rec_t *)x;
-	slurmdb_assoc_rec_t *assoc_rec = (slurmdb_assoc_rec_t *)key;
+	arch_hash_ent_t *ent = xmalloc(sizeof(arch_hash_ent_t));
+	int inx = ARCH_HASH_INX(id);
 
-	if ((assoc_rec->parent_id == arch_rec->assoc->id) &&
-	    !xstrcmp(assoc_rec->cluster, arch_rec->assoc->cluster))
-		return 1;
+	ent->id = id;
+	ent->cluster = cluster;
+	ent->data = data;
+	ent->next = hash[inx];
+	hash[inx] = ent;
+}
 
-	return 0;
+/* Find the entry for id. A NULL cluster matches any cluster. */
+static void *_arch_hash_find(arch_hash_ent_t **hash, uint32_t id,
+			     char *cluster)
+{
+	arch_hash_ent_t *ent;
+
+	for (ent = hash[ARCH_HASH_INX(id)]; ent; ent = ent->next) {
+		if ((ent->id == id) &&
+		    (!cluster || !xstrcmp(cluster, ent->cluster)))
+			return ent->data;
+	}
+	return NULL;
+}
+
+static void _arch_hash_free(arch_hash_ent_t **hash)
+{
+	arch_hash_ent_t *ent, *next;
+	int i;
+
+	for (i = 0; i < ARCH_HASH_SIZE; i++) {
+		for (ent = hash[i]; ent; ent = next) {
+			next = ent->next;
+			xfree(ent);
+		}
+	}
+	xfree(hash);
 }
 
 static void _add_arch_rec(slurmdb_assoc_rec_t *assoc_rec,
-			  List arch_rec_list, List total_arch_list)
+			  List arch_rec_list, arch_hash_ent_t **arch_hash)
 {
 	slurmdb_hierarchical_rec_t *arch_rec =
 		xmalloc(sizeof(slurmdb_hierarchical_rec_t));
@@ -519,50 +561,52 @@ static void _add_arch_rec(slurmdb_assoc_rec_t *assoc_rec,
 
 	assoc_rec->rgt = 0;
 	list_append(arch_rec_list, arch_rec);
-	list_append(total_arch_list, arch_rec);
+	_arch_hash_add(arch_hash, assoc_rec->id, assoc_rec->cluster,
+		       arch_rec);
 }
 
-static void _find_create_parent(slurmdb_assoc_rec_t *assoc_rec, List assoc_list,
-				List arch_rec_list, List total_arch_list)
+static void _find_create_parent(slurmdb_assoc_rec_t *assoc_rec,
+				arch_hash_ent_t **assoc_hash,
+				List arch_rec_list,
+				arch_hash_ent_t **arch_hash)
 {
 	slurmdb_assoc_rec_t *par_assoc_rec = NULL;
 	slurmdb_hierarchical_rec_t *par_arch_rec = NULL;
 
 	if (assoc_rec->parent_id) {
-		if ((par_arch_rec = list_find_first(
-			    total_arch_list, _find_arch_in_list,
-			    assoc_rec))) {
+		if ((par_arch_rec = _arch_hash_find(
+			    arch_hash, assoc_rec->parent_id,
+			    assoc_rec->cluster))) {
 
 			_add_arch_rec(assoc_rec, par_arch_rec->children,
-				      total_arch_list);
+				      arch_hash);
 			return;
 		}
 
-		if (!(par_assoc_rec = list_find_first(
-			      assoc_list, slurmdb_find_assoc_in_list,
-			      &assoc_rec->parent_id))) {
+		if (!(par_assoc_rec = _arch_hash_find(
+			      assoc_hash, assoc_rec->parent_id, NULL))) {
 
 			/* This means we weren't starting at root */
 			_add_arch_rec(assoc_rec, arch_rec_list,
-				      total_arch_list);
+				      arch_hash);
 			return;
 		}
 
-		_find_create_parent(par_assoc_rec, assoc_list, arch_rec_list,
-				    total_arch_list);
+		_find_create_parent(par_assoc_rec, assoc_hash, arch_rec_list,
+				    arch_hash);
 		/* Now that it has been added lets try again */
-		if ((par_arch_rec = list_find_first(
-			    total_arch_list, _find_arch_in_list,
-			    assoc_rec))) {
+		if ((par_arch_rec = _arch_hash_find(
+			    arch_hash, assoc_rec->parent_id,
+			    assoc_rec->cluster))) {
 
 			_add_arch_rec(assoc_rec, par_arch_rec->children,
-				      total_arch_list);
+				      arch_hash);
 			return;
 		}
 		error("%s: no parent found, this should never happen",
 		      __func__);
 	} else
-		_add_arch_rec(assoc_rec, arch_rec_list, total_arch_list);
+		_add_arch_rec(assoc_rec, arch_rec_list, arch_hash);
 
 	return;
 }
@@ -1990,24 +2034,33 @@ extern void slurmdb_sort_hierarchical_assoc_list(
 extern List slurmdb_get_acct_hierarchical_rec_list_no_lft(List assoc_list)
 {
 	slurmdb_assoc_rec_t *assoc = NULL;
-	List total_arch_list = list_create(NULL);
+	arch_hash_ent_t **assoc_hash, **arch_hash;
 	List arch_rec_list = list_create(slurmdb_destroy_hierarchical_rec);
 	ListIterator itr;
 	/* DEF_TIMERS; */
 	/* START_TIMER; */
 
+	/* Index the associations by id up front, so parent lookups
+	 * during tree construction are O(1) */
+	assoc_hash = xmalloc(sizeof(arch_hash_ent_t *) * ARCH_HASH_SIZE);
+	arch_hash = xmalloc(sizeof(arch_hash_ent_t *) * ARCH_HASH_SIZE);
 	itr = list_iterator_create(assoc_list);
+	while ((assoc = list_next(itr))) {
+		_arch_hash_add(assoc_hash, assoc->id, assoc->cluster, assoc);
+	}
+	list_iterator_reset(itr);
 	while ((assoc = list_next(itr))) {
 		if (assoc->rgt == 0) // already processed
 			continue;
 
-		_find_create_parent(assoc, assoc_list,
-				    arch_rec_list, total_arch_list);
+		_find_create_parent(assoc, assoc_hash,
+				    arch_rec_list, arch_hash);
 	}
 	list_iterator_destroy(itr);
 	/* END_TIMER; */
 	/* info("took %s", TIME_STR); */
-	FREE_NULL_LIST(total_arch_list);
+	_arch_hash_free(assoc_hash);
+	_arch_hash_free(arch_hash);
 //	info("got %d", list_count(arch_rec_list));
 	_sort_slurmdb_hierarchical_rec_list(arch_rec_list);
 
@@ -2021,16 +2074,16 @@ extern List slurmdb_get_acct_hierarchical_rec_list(List assoc_list)
 	slurmdb_hierarchical_rec_t *last_parent = NULL;
 	slurmdb_hierarchical_rec_t *arch_rec = NULL;
 	slurmdb_assoc_rec_t *assoc = NULL;
-	List total_assoc_list = list_create(NULL);
+	arch_hash_ent_t **arch_hash;
 	List arch_rec_list =
 		list_create(slurmdb_destroy_hierarchical_rec);
-	ListIterator itr, itr2;
+	ListIterator itr;
 
 	/* The list should already be sorted by lfts, do it anyway
 	 * just to make sure it is correct. */
 	list_sort(assoc_list, (ListCmpF)_sort_assoc_by_lft_dec);
+	arch_hash = xmalloc(sizeof(arch_hash_ent_t *) * ARCH_HASH_SIZE);
 	itr = list_iterator_create(assoc_list);
-	itr2 = list_iterator_create(total_assoc_list);
 
 	while((assoc = list_next(itr))) {
 		arch_rec = xmalloc(sizeof(slurmdb_hierarchical_rec_t));
@@ -2043,14 +2096,15 @@ extern List slurmdb_get_acct_hierarchical_rec_list(List assoc_list)
 		   if the last parent we had was what we are looking
 		   for.  Then if that isn't panning out look at the
 		   last account parent.  If still we don't have it we
-		   will look for it in the list.  If it isn't there we
+		   will look it up in the hash.  If it isn't there we
 		   will just add it to the parent and call it good
 		*/
 		if (!assoc->parent_id) {
 			arch_rec->sort_name = assoc->cluster;
 
 			list_append(arch_rec_list, arch_rec);
-			list_append(total_assoc_list, arch_rec);
+			_arch_hash_add(arch_hash, assoc->id,
+				       assoc->cluster, arch_rec);
 
 			continue;
 		}
@@ -2068,21 +2122,13 @@ extern List slurmdb_get_acct_hierarchical_rec_list(List assoc_list)
 			   && !xstrcmp(assoc->cluster,
 				       last_acct_parent->assoc->cluster)) {
 			par_arch_rec = last_acct_parent;
-		} else {
-			list_iterator_reset(itr2);
-			while((par_arch_rec = list_next(itr2))) {
-				if (assoc->parent_id == par_arch_rec->assoc->id
-				    && !xstrcmp(assoc->cluster,
-						par_arch_rec->assoc->cluster)) {
-					if (assoc->user)
-						last_parent = par_arch_rec;
-					else
-						last_parent
-							= last_acct_parent
-							= par_arch_rec;
-					break;
-				}
-			}
+		} else if ((par_arch_rec = _arch_hash_find(
+				    arch_hash, assoc->parent_id,
+				    assoc->cluster))) {
+			if (assoc->user)
+				last_parent = par_arch_rec;
+			else
+				last_parent = last_acct_parent = par_arch_rec;
 		}
 
 		if (!par_arch_rec) {
@@ -2091,12 +2137,12 @@ extern List slurmdb_get_acct_hierarchical_rec_list(List assoc_list)
 		} else
 			list_append(par_arch_rec->children, arch_rec);
 
-		list_append(total_assoc_list, arch_rec);
+		_arch_hash_add(arch_hash, assoc->id, assoc->cluster,
+			       arch_rec);
 	}
 	list_iterator_destroy(itr);
-	list_iterator_destroy(itr2);
 
-	FREE_NULL_LIST(total_assoc_list);
+	_arch_hash_free(arch_hash);
 //	info("got %d", list_count(arch_rec_list));
 	_sort_slurmdb_hierarchical_rec_list(arch_rec_list);
 
@@ -3029,16 +3075,20 @@ extern int slurmdb_get_first_avail_cluster(job_desc_msg_t *req,
 	if (working_cluster_rec)
 		*cluster_rec = working_cluster_rec;
 
+	/* Build the list sorted so the first spot is on top */
+	local_cluster_name = slurm_get_cluster_name();
 	ret_list = list_create(_destroy_local_cluster_rec);
 	itr = list_iterator_create(cluster_list);
 	while ((working_cluster_rec = list_next(itr))) {
 		if ((local_cluster = _job_will_run(req)))
-			list_append(ret_list, local_cluster);
+			list_insert_sorted(ret_list, local_cluster,
+					   (ListCmpF)_sort_local_cluster);
 		else
 			error("Problem with submit to cluster %s: %m",
 			      working_cluster_rec->name);
 	}
 	list_iterator_destroy(itr);
+	xfree(local_cluster_name);
 
 	/* restore working_cluster_rec in case it was already set */
 	if (*cluster_rec) {
@@ -3055,10 +3105,6 @@ extern int slurmdb_get_first_avail_cluster(job_desc_msg_t *req,
 		goto end_it;
 	}
 
-	/* sort the list so the first spot is on top */
-	local_cluster_name = slurm_get_cluster_name();
-	list_sort(ret_list, (ListCmpF)_sort_local_cluster);
-	xfree(local_cluster_name);
 	local_cluster = list_peek(ret_list);
 
 	/* prevent cluster_rec from being freed when cluster_list is destroyed */
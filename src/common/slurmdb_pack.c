@@ -44,6 +44,172 @@
 #include "list.h"
 #include "pack.h"
 
+/*
+ * Per-message string dictionary used when shipping bulk job/step lists
+ * to 17.02+ peers.  The same account/cluster/partition/user strings
+ * repeat in nearly every record of a large sacct response, so they are
+ * packed once up front and each record carries a 32 bit index instead
+ * of the string itself.
+ */
+#define STR_DICT_HASH_SIZE 1024
+
+typedef struct str_dict_ent {
+	struct str_dict_ent *next;	/* next on hash chain */
+	uint32_t inx;			/* index packed on the wire */
+	char *str;
+} str_dict_ent_t;
+
+struct slurmdb_str_dict {
+	str_dict_ent_t *hash[STR_DICT_HASH_SIZE];	/* pack side lookup */
+	char **strings;		/* entries in index order */
+	uint32_t count;
+	uint32_t size;
+};
+
+static void _pack_step_rec(slurmdb_step_rec_t *step, uint16_t protocol_version,
+			   slurmdb_str_dict_t *str_dict, Buf buffer);
+static int _unpack_step_rec(slurmdb_step_rec_t **step,
+			    uint16_t protocol_version,
+			    slurmdb_str_dict_t *str_dict, Buf buffer);
+
+static uint32_t _str_dict_hash(char *str)
+{
+	uint32_t hash = 5381;
+
+	while (*str)
+		hash = (hash * 33) + (unsigned char) *str++;
+	return hash % STR_DICT_HASH_SIZE;
+}
+
+extern slurmdb_str_dict_t *slurmdb_str_dict_create(void)
+{
+	slurmdb_str_dict_t *str_dict = xmalloc(sizeof(slurmdb_str_dict_t));
+
+	str_dict->size = 256;
+	str_dict->strings = xmalloc(sizeof(char *) * str_dict->size);
+
+	return str_dict;
+}
+
+extern void slurmdb_str_dict_destroy(slurmdb_str_dict_t *str_dict)
+{
+	str_dict_ent_t *ent;
+	uint32_t i;
+
+	if (!str_dict)
+		return;
+
+	for (i = 0; i < STR_DICT_HASH_SIZE; i++) {
+		while ((ent = str_dict->hash[i])) {
+			str_dict->hash[i] = ent->next;
+			xfree(ent);
+		}
+	}
+	for (i = 0; i < str_dict->count; i++)
+		xfree(str_dict->strings[i]);
+	xfree(str_dict->strings);
+	xfree(str_dict);
+}
+
+extern void slurmdb_str_dict_pack(slurmdb_str_dict_t *str_dict, Buf buffer)
+{
+	uint32_t i;
+
+	pack32(str_dict->count, buffer);
+	for (i = 0; i < str_dict->count; i++)
+		packstr(str_dict->strings[i], buffer);
+}
+
+extern int slurmdb_str_dict_unpack(slurmdb_str_dict_t **str_dict, Buf buffer)
+{
+	slurmdb_str_dict_t *dict = slurmdb_str_dict_create();
+	uint32_t i, uint32_tmp;
+
+	*str_dict = dict;
+
+	safe_unpack32(&dict->count, buffer);
+	if (dict->count > remaining_buf(buffer))
+		goto unpack_error;
+	if (dict->count > dict->size) {
+		dict->size = dict->count;
+		xrealloc(dict->strings, sizeof(char *) * dict->size);
+	}
+	for (i = 0; i < dict->count; i++)
+		safe_unpackstr_xmalloc(&dict->strings[i], &uint32_tmp, buffer);
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurmdb_str_dict_destroy(dict);
+	*str_dict = NULL;
+	return SLURM_ERROR;
+}
+
+/* Pack [str] as a dictionary index, interning it on first use.  With a
+ * NULL [str_dict] this is a plain packstr(). */
+static void _packstr_dict(char *str, slurmdb_str_dict_t *str_dict, Buf buffer)
+{
+	str_dict_ent_t *ent;
+	uint32_t inx;
+
+	if (!str_dict) {
+		packstr(str, buffer);
+		return;
+	}
+	if (!str) {
+		pack32(NO_VAL, buffer);
+		return;
+	}
+
+	inx = _str_dict_hash(str);
+	for (ent = str_dict->hash[inx]; ent; ent = ent->next) {
+		if (!xstrcmp(ent->str, str))
+			break;
+	}
+	if (!ent) {
+		if (str_dict->count >= str_dict->size) {
+			str_dict->size *= 2;
+			xrealloc(str_dict->strings,
+				 sizeof(char *) * str_dict->size);
+		}
+		ent = xmalloc(sizeof(str_dict_ent_t));
+		ent->inx = str_dict->count;
+		ent->str = xstrdup(str);
+		str_dict->strings[str_dict->count++] = ent->str;
+		ent->next = str_dict->hash[inx];
+		str_dict->hash[inx] = ent;
+	}
+	pack32(ent->inx, buffer);
+}
+
+static int _unpackstr_dict(char **valp, slurmdb_str_dict_t *str_dict,
+			   Buf buffer)
+{
+	uint32_t inx;
+
+	if (!str_dict) {
+		uint32_t uint32_tmp;
+		return unpackmem_xmalloc(valp, &uint32_tmp, buffer);
+	}
+
+	if (unpack32(&inx, buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+	if (inx == NO_VAL) {
+		*valp = NULL;
+		return SLURM_SUCCESS;
+	}
+	if (inx >= str_dict->count)
+		return SLURM_ERROR;
+	*valp = xstrdup(str_dict->strings[inx]);
+	return SLURM_SUCCESS;
+}
+
+#define safe_unpackstr_dict(valp, str_dict, buf) do {	\
+	if (_unpackstr_dict(valp, str_dict, buf)	\
+	    != SLURM_SUCCESS)				\
+		goto unpack_error;			\
+} while (0)
+
 static void _pack_slurmdb_stats(slurmdb_stats_t *stats,
 				uint16_t protocol_version, Buf buffer)
 {
@@ -3733,10 +3899,12 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 	ListIterator itr = NULL;
 	slurmdb_job_cond_t *object = (slurmdb_job_cond_t *)in;
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
 		if (!object) {
 			pack32(NO_VAL, buffer);	/* count(acct_list) */
 			pack32(NO_VAL, buffer);	/* count(associd_list) */
+			pack64(0, buffer);	/* chunk_db_inx */
+			pack32(0, buffer);	/* chunk_size */
 			pack32(NO_VAL, buffer);	/* count(cluster_list) */
 			pack32(0, buffer);	/* cpus_max */
 			pack32(0, buffer);	/* cpus_min */
@@ -3789,6 +3957,9 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 			}
 		}
 
+		pack64(object->chunk_db_inx, buffer);
+		pack32(object->chunk_size, buffer);
+
 		if (object->cluster_list)
 			count = list_count(object->cluster_list);
 		else
@@ -3950,118 +4121,516 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 
 		pack16(object->without_steps, buffer);
 		pack16(object->without_usage_truncation, buffer);
-	}
-}
-
-extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
-				   Buf buffer)
-{
-	uint32_t uint32_tmp;
-	int i;
-	uint32_t count;
-	slurmdb_job_cond_t *object_ptr = xmalloc(sizeof(slurmdb_job_cond_t));
-	char *tmp_info = NULL;
-	slurmdb_selected_step_t *job = NULL;
-
-	*object = object_ptr;
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		if (!object) {
+			pack32(NO_VAL, buffer);	/* count(acct_list) */
+			pack32(NO_VAL, buffer);	/* count(associd_list) */
+			pack32(NO_VAL, buffer);	/* count(cluster_list) */
+			pack32(0, buffer);	/* cpus_max */
+			pack32(0, buffer);	/* cpus_min */
+			pack16(0, buffer);	/* duplicates */
+			pack32(0, buffer);	/* exitcode */
+			pack32(NO_VAL, buffer);	/* count(groupid_list) */
+			pack32(NO_VAL, buffer);	/* count(jobname_list) */
+			pack32(0, buffer);	/* nodes_max */
+			pack32(0, buffer);	/* nodes_min */
+			pack32(NO_VAL, buffer);	/* count(partition_list) */
+			pack32(NO_VAL, buffer);	/* count(qos_list) */
+			pack32(NO_VAL, buffer);	/* count(resv_list) */
+			pack32(NO_VAL, buffer);	/* count(resvid_list) */
+			pack32(NO_VAL, buffer);	/* count(step_list) */
+			pack32(NO_VAL, buffer);	/* count(state_list) */
+			pack32(0, buffer);	/* timelimit_max */
+			pack32(0, buffer);	/* timelimit_min */
+			pack_time(0, buffer);	/* usage_end */
+			pack_time(0, buffer);	/* usage_start */
+			packnull(buffer);	/* used_nodes */
+			pack32(NO_VAL, buffer);	/* count(userid_list) */
+			pack32(NO_VAL, buffer);	/* count(wckey_list) */
+			pack16(0, buffer);	/* without_steps */
+			pack16(0, buffer);	/* without_usage_truncation */
+			return;
+		}
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->acct_list = list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
-						       buffer);
-				list_append(object_ptr->acct_list, tmp_info);
+		if (object->acct_list)
+			count = list_count(object->acct_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->acct_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->associd_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
-						       buffer);
-				list_append(object_ptr->associd_list, tmp_info);
+		if (object->associd_list)
+			count = list_count(object->associd_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->associd_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
 		}
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->cluster_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
-						       buffer);
-				list_append(object_ptr->cluster_list, tmp_info);
+		if (object->cluster_list)
+			count = list_count(object->cluster_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->cluster_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&object_ptr->cpus_max, buffer);
-		safe_unpack32(&object_ptr->cpus_min, buffer);
-		safe_unpack16(&object_ptr->duplicates, buffer);
-		safe_unpack32(&uint32_tmp, buffer);
-		object_ptr->exitcode = (int32_t)uint32_tmp;
+		pack32(object->cpus_max, buffer);
+		pack32(object->cpus_min, buffer);
+		pack16(object->duplicates, buffer);
+		pack32((uint32_t)object->exitcode, buffer);
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->groupid_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
-						       buffer);
-				list_append(object_ptr->groupid_list, tmp_info);
+		if (object->groupid_list)
+			count = list_count(object->groupid_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->groupid_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->jobname_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
-						       buffer);
-				list_append(object_ptr->jobname_list, tmp_info);
+		if (object->jobname_list)
+			count = list_count(object->jobname_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->jobname_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&object_ptr->nodes_max, buffer);
-		safe_unpack32(&object_ptr->nodes_min, buffer);
+		pack32(object->nodes_max, buffer);
+		pack32(object->nodes_min, buffer);
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->partition_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info,
-						       &uint32_tmp, buffer);
-				list_append(object_ptr->partition_list,
-					    tmp_info);
+		if (object->partition_list)
+			count = list_count(object->partition_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->partition_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->qos_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info,
-						       &uint32_tmp, buffer);
-				list_append(object_ptr->qos_list,
-					    tmp_info);
+		if (object->qos_list)
+			count = list_count(object->qos_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->qos_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
 			}
+			list_iterator_destroy(itr);
 		}
 
-		safe_unpack32(&count, buffer);
-		if (count != NO_VAL) {
-			object_ptr->resv_list =
-				list_create(slurm_destroy_char);
-			for (i=0; i<count; i++) {
-				safe_unpackstr_xmalloc(&tmp_info,
-						       &uint32_tmp, buffer);
-				list_append(object_ptr->resv_list,
-					    tmp_info);
+		if (object->resv_list)
+			count = list_count(object->resv_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->resv_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		if (object->resvid_list)
+			count = list_count(object->resvid_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->resvid_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		if (object->step_list)
+			count = list_count(object->step_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->step_list);
+			while ((job = list_next(itr))) {
+				slurmdb_pack_selected_step(job, protocol_version,
+							   buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		if (object->state_list)
+			count = list_count(object->state_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->state_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		pack32(object->timelimit_max, buffer);
+		pack32(object->timelimit_min, buffer);
+		pack_time(object->usage_end, buffer);
+		pack_time(object->usage_start, buffer);
+
+		packstr(object->used_nodes, buffer);
+
+		if (object->userid_list)
+			count = list_count(object->userid_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->userid_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		if (object->wckey_list)
+			count = list_count(object->wckey_list);
+		else
+			count = NO_VAL;
+		pack32(count, buffer);
+		if (count && count != NO_VAL) {
+			itr = list_iterator_create(object->wckey_list);
+			while ((tmp_info = list_next(itr))) {
+				packstr(tmp_info, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+
+		pack16(object->without_steps, buffer);
+		pack16(object->without_usage_truncation, buffer);
+	}
+}
+
+extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
+				   Buf buffer)
+{
+	uint32_t uint32_tmp;
+	int i;
+	uint32_t count;
+	slurmdb_job_cond_t *object_ptr = xmalloc(sizeof(slurmdb_job_cond_t));
+	char *tmp_info = NULL;
+	slurmdb_selected_step_t *job = NULL;
+
+	*object = object_ptr;
+
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->acct_list = list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->acct_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->associd_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->associd_list, tmp_info);
+			}
+		}
+
+		safe_unpack64(&object_ptr->chunk_db_inx, buffer);
+		safe_unpack32(&object_ptr->chunk_size, buffer);
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->cluster_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->cluster_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&object_ptr->cpus_max, buffer);
+		safe_unpack32(&object_ptr->cpus_min, buffer);
+		safe_unpack16(&object_ptr->duplicates, buffer);
+		safe_unpack32(&uint32_tmp, buffer);
+		object_ptr->exitcode = (int32_t)uint32_tmp;
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->groupid_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->groupid_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->jobname_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->jobname_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&object_ptr->nodes_max, buffer);
+		safe_unpack32(&object_ptr->nodes_min, buffer);
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->partition_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->partition_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->qos_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->qos_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->resv_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->resv_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->resvid_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->resvid_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->step_list =
+				list_create(slurmdb_destroy_selected_step);
+			for (i=0; i<count; i++) {
+				if (slurmdb_unpack_selected_step(
+					&job, protocol_version, buffer)
+				    != SLURM_SUCCESS) {
+					error("unpacking selected step");
+					goto unpack_error;
+				}
+				/* There is no such thing as jobid 0,
+				 * if we process it the database will
+				 * return all jobs. */
+				if (!job->jobid)
+					slurmdb_destroy_selected_step(job);
+				else
+					list_append(object_ptr->step_list, job);
+			}
+			if (!list_count(object_ptr->step_list))
+				FREE_NULL_LIST(object_ptr->step_list);
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->state_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->state_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&object_ptr->timelimit_max, buffer);
+		safe_unpack32(&object_ptr->timelimit_min, buffer);
+		safe_unpack_time(&object_ptr->usage_end, buffer);
+		safe_unpack_time(&object_ptr->usage_start, buffer);
+
+		safe_unpackstr_xmalloc(&object_ptr->used_nodes,
+				       &uint32_tmp, buffer);
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->userid_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->userid_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->wckey_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->wckey_list, tmp_info);
+			}
+		}
+
+		safe_unpack16(&object_ptr->without_steps, buffer);
+		safe_unpack16(&object_ptr->without_usage_truncation, buffer);
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->acct_list = list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->acct_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->associd_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->associd_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->cluster_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->cluster_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&object_ptr->cpus_max, buffer);
+		safe_unpack32(&object_ptr->cpus_min, buffer);
+		safe_unpack16(&object_ptr->duplicates, buffer);
+		safe_unpack32(&uint32_tmp, buffer);
+		object_ptr->exitcode = (int32_t)uint32_tmp;
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->groupid_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->groupid_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->jobname_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info, &uint32_tmp,
+						       buffer);
+				list_append(object_ptr->jobname_list, tmp_info);
+			}
+		}
+
+		safe_unpack32(&object_ptr->nodes_max, buffer);
+		safe_unpack32(&object_ptr->nodes_min, buffer);
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->partition_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->partition_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->qos_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->qos_list,
+					    tmp_info);
+			}
+		}
+
+		safe_unpack32(&count, buffer);
+		if (count != NO_VAL) {
+			object_ptr->resv_list =
+				list_create(slurm_destroy_char);
+			for (i=0; i<count; i++) {
+				safe_unpackstr_xmalloc(&tmp_info,
+						       &uint32_tmp, buffer);
+				list_append(object_ptr->resv_list,
+					    tmp_info);
 			}
 		}
 
@@ -4192,15 +4761,89 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
-extern void slurmdb_pack_job_rec(void *object, uint16_t protocol_version,
-				 Buf buffer)
+static void _pack_job_rec(void *object, uint16_t protocol_version,
+			  slurmdb_str_dict_t *str_dict, Buf buffer)
 {
 	slurmdb_job_rec_t *job = (slurmdb_job_rec_t *)object;
 	ListIterator itr = NULL;
 	slurmdb_step_rec_t *step = NULL;
 	uint32_t count = 0;
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		_packstr_dict(job->account, str_dict, buffer);
+		_packstr_dict(job->alloc_gres, str_dict, buffer);
+		pack32(job->alloc_nodes, buffer);
+		pack32(job->array_job_id, buffer);
+		pack32(job->array_max_tasks, buffer);
+		pack32(job->array_task_id, buffer);
+		packstr(job->array_task_str, buffer);
+
+		pack32(job->associd, buffer);
+		_packstr_dict(job->blockid, str_dict, buffer);
+		_packstr_dict(job->cluster, str_dict, buffer);
+		pack64(job->db_index, buffer);
+		pack32((uint32_t)job->derived_ec, buffer);
+		packstr(job->derived_es, buffer);
+		pack32(job->elapsed, buffer);
+		pack_time(job->eligible, buffer);
+		pack_time(job->end, buffer);
+		pack32((uint32_t)job->exitcode, buffer);
+		/* the first_step_ptr
+		   is set up on the client side so does
+		   not need to be packed */
+		pack32(job->gid, buffer);
+		pack32(job->jobid, buffer);
+		_packstr_dict(job->jobname, str_dict, buffer);
+		pack32(job->lft, buffer);
+		_packstr_dict(job->nodes, str_dict, buffer);
+		_packstr_dict(job->partition, str_dict, buffer);
+		pack32(job->priority, buffer);
+		pack32(job->qosid, buffer);
+		pack32(job->req_cpus, buffer);
+		_packstr_dict(job->req_gres, str_dict, buffer);
+		pack32(job->req_mem, buffer);
+		pack32(job->requid, buffer);
+		_packstr_dict(job->resv_name, str_dict, buffer);
+		pack32(job->resvid, buffer);
+		pack32(job->show_full, buffer);
+		pack_time(job->start, buffer);
+		pack32(job->state, buffer);
+		_pack_slurmdb_stats(&job->stats, protocol_version, buffer);
+
+		if (job->steps)
+			count = list_count(job->steps);
+		else
+			count = 0;
+
+		pack32(count, buffer);
+		if (count) {
+			itr = list_iterator_create(job->steps);
+			while ((step = list_next(itr))) {
+				_pack_step_rec(step, protocol_version,
+					       str_dict, buffer);
+			}
+			list_iterator_destroy(itr);
+		}
+		pack_time(job->submit, buffer);
+		pack32(job->suspended, buffer);
+		pack32(job->sys_cpu_sec, buffer);
+		pack32(job->sys_cpu_usec, buffer);
+		pack32(job->timelimit, buffer);
+		pack32(job->tot_cpu_sec, buffer);
+		pack32(job->tot_cpu_usec, buffer);
+		pack16(job->track_steps, buffer);
+
+		_packstr_dict(job->tres_alloc_str, str_dict, buffer);
+		_packstr_dict(job->tres_req_str, str_dict, buffer);
+
+		pack32(job->uid, buffer);
+		_packstr_dict(job->user, str_dict, buffer);
+		pack32(job->user_cpu_sec, buffer);
+		pack32(job->user_cpu_usec, buffer);
+		_packstr_dict(job->wckey, str_dict,
+			      buffer); /* added for protocol_version 4 */
+		pack32(job->wckeyid, buffer); /* added for protocol_version 4 */
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		packstr(job->account, buffer);
 		packstr(job->alloc_gres, buffer);
 		pack32(job->alloc_nodes, buffer);
@@ -4278,8 +4921,21 @@ extern void slurmdb_pack_job_rec(void *object, uint16_t protocol_version,
 	}
 }
 
-extern int slurmdb_unpack_job_rec(void **job, uint16_t protocol_version,
-				  Buf buffer)
+extern void slurmdb_pack_job_rec(void *object, uint16_t protocol_version,
+				 Buf buffer)
+{
+	_pack_job_rec(object, protocol_version, NULL, buffer);
+}
+
+extern void slurmdb_pack_job_rec_dict(void *object,
+				      slurmdb_str_dict_t *str_dict,
+				      uint16_t protocol_version, Buf buffer)
+{
+	_pack_job_rec(object, protocol_version, str_dict, buffer);
+}
+
+static int _unpack_job_rec(void **job, uint16_t protocol_version,
+			   slurmdb_str_dict_t *str_dict, Buf buffer)
 {
 	slurmdb_job_rec_t *job_ptr = xmalloc(sizeof(slurmdb_job_rec_t));
 	int i = 0;
@@ -4292,7 +4948,82 @@ extern int slurmdb_unpack_job_rec(void **job, uint16_t protocol_version,
 	job_ptr->array_job_id = 0;
 	job_ptr->array_task_id = NO_VAL;
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		safe_unpackstr_dict(&job_ptr->account, str_dict, buffer);
+		safe_unpackstr_dict(&job_ptr->alloc_gres, str_dict, buffer);
+		safe_unpack32(&job_ptr->alloc_nodes, buffer);
+		safe_unpack32(&job_ptr->array_job_id, buffer);
+		safe_unpack32(&job_ptr->array_max_tasks, buffer);
+		safe_unpack32(&job_ptr->array_task_id, buffer);
+		safe_unpackstr_xmalloc(&job_ptr->array_task_str,
+				       &uint32_tmp, buffer);
+		safe_unpack32(&job_ptr->associd, buffer);
+		safe_unpackstr_dict(&job_ptr->blockid, str_dict, buffer);
+		safe_unpackstr_dict(&job_ptr->cluster, str_dict, buffer);
+		safe_unpack64(&job_ptr->db_index, buffer);
+		safe_unpack32(&job_ptr->derived_ec, buffer);
+		safe_unpackstr_xmalloc(&job_ptr->derived_es, &uint32_tmp,
+				       buffer);
+		safe_unpack32(&job_ptr->elapsed, buffer);
+		safe_unpack_time(&job_ptr->eligible, buffer);
+		safe_unpack_time(&job_ptr->end, buffer);
+		safe_unpack32(&uint32_tmp, buffer);
+		job_ptr->exitcode = (int32_t)uint32_tmp;
+		safe_unpack32(&job_ptr->gid, buffer);
+		safe_unpack32(&job_ptr->jobid, buffer);
+		safe_unpackstr_dict(&job_ptr->jobname, str_dict, buffer);
+		safe_unpack32(&job_ptr->lft, buffer);
+		safe_unpackstr_dict(&job_ptr->nodes, str_dict, buffer);
+		safe_unpackstr_dict(&job_ptr->partition, str_dict, buffer);
+		safe_unpack32(&job_ptr->priority, buffer);
+		safe_unpack32(&job_ptr->qosid, buffer);
+		safe_unpack32(&job_ptr->req_cpus, buffer);
+		safe_unpackstr_dict(&job_ptr->req_gres, str_dict, buffer);
+		safe_unpack32(&job_ptr->req_mem, buffer);
+		safe_unpack32(&job_ptr->requid, buffer);
+		safe_unpackstr_dict(&job_ptr->resv_name, str_dict, buffer);
+		safe_unpack32(&job_ptr->resvid, buffer);
+		safe_unpack32(&job_ptr->show_full, buffer);
+		safe_unpack_time(&job_ptr->start, buffer);
+		safe_unpack32(&uint32_tmp, buffer);
+		job_ptr->state = uint32_tmp;
+		if (_unpack_slurmdb_stats(&job_ptr->stats, protocol_version,
+					  buffer)
+		    != SLURM_SUCCESS)
+			goto unpack_error;
+
+		safe_unpack32(&count, buffer);
+		job_ptr->steps = list_create(slurmdb_destroy_step_rec);
+		for (i=0; i<count; i++) {
+			if (_unpack_step_rec(&step, protocol_version,
+					     str_dict, buffer)
+			    == SLURM_ERROR)
+				goto unpack_error;
+
+			step->job_ptr = job_ptr;
+			if (!job_ptr->first_step_ptr)
+				job_ptr->first_step_ptr = step;
+			list_append(job_ptr->steps, step);
+		}
+
+		safe_unpack_time(&job_ptr->submit, buffer);
+		safe_unpack32(&job_ptr->suspended, buffer);
+		safe_unpack32(&job_ptr->sys_cpu_sec, buffer);
+		safe_unpack32(&job_ptr->sys_cpu_usec, buffer);
+		safe_unpack32(&job_ptr->timelimit, buffer);
+		safe_unpack32(&job_ptr->tot_cpu_sec, buffer);
+		safe_unpack32(&job_ptr->tot_cpu_usec, buffer);
+		safe_unpack16(&job_ptr->track_steps, buffer);
+		safe_unpackstr_dict(&job_ptr->tres_alloc_str, str_dict,
+				    buffer);
+		safe_unpackstr_dict(&job_ptr->tres_req_str, str_dict, buffer);
+		safe_unpack32(&job_ptr->uid, buffer);
+		safe_unpackstr_dict(&job_ptr->user, str_dict, buffer);
+		safe_unpack32(&job_ptr->user_cpu_sec, buffer);
+		safe_unpack32(&job_ptr->user_cpu_usec, buffer);
+		safe_unpackstr_dict(&job_ptr->wckey, str_dict, buffer);
+		safe_unpack32(&job_ptr->wckeyid, buffer);
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		safe_unpackstr_xmalloc(&job_ptr->account, &uint32_tmp, buffer);
 		safe_unpackstr_xmalloc(&job_ptr->alloc_gres, &uint32_tmp,
 				       buffer);
@@ -4384,6 +5115,19 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+extern int slurmdb_unpack_job_rec(void **job, uint16_t protocol_version,
+				  Buf buffer)
+{
+	return _unpack_job_rec(job, protocol_version, NULL, buffer);
+}
+
+extern int slurmdb_unpack_job_rec_dict(void **job,
+				       slurmdb_str_dict_t *str_dict,
+				       uint16_t protocol_version, Buf buffer)
+{
+	return _unpack_job_rec(job, protocol_version, str_dict, buffer);
+}
+
 extern void slurmdb_pack_qos_cond(void *in, uint16_t protocol_version,
 				  Buf buffer)
 {
@@ -4655,15 +5399,15 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
-extern void slurmdb_pack_step_rec(slurmdb_step_rec_t *step,
-				  uint16_t protocol_version, Buf buffer)
+static void _pack_step_rec(slurmdb_step_rec_t *step, uint16_t protocol_version,
+			   slurmdb_str_dict_t *str_dict, Buf buffer)
 {
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		pack32(step->elapsed, buffer);
 		pack_time(step->end, buffer);
 		pack32((uint32_t)step->exitcode, buffer);
 		pack32(step->nnodes, buffer);
-		packstr(step->nodes, buffer);
+		_packstr_dict(step->nodes, str_dict, buffer);
 		pack32(step->ntasks, buffer);
 		pack32(step->req_cpufreq_min, buffer);
 		pack32(step->req_cpufreq_max, buffer);
@@ -4673,14 +5417,14 @@ extern void slurmdb_pack_step_rec(slurmdb_step_rec_t *step,
 		pack_time(step->start, buffer);
 		pack16(step->state, buffer);
 		pack32(step->stepid, buffer);	/* job's step number */
-		packstr(step->stepname, buffer);
+		_packstr_dict(step->stepname, str_dict, buffer);
 		pack32(step->suspended, buffer);
 		pack32(step->sys_cpu_sec, buffer);
 		pack32(step->sys_cpu_usec, buffer);
 		pack32(step->task_dist, buffer);
 		pack32(step->tot_cpu_sec, buffer);
 		pack32(step->tot_cpu_usec, buffer);
-		packstr(step->tres_alloc_str, buffer);
+		_packstr_dict(step->tres_alloc_str, str_dict, buffer);
 		pack32(step->user_cpu_sec, buffer);
 		pack32(step->user_cpu_usec, buffer);
 	} else {
@@ -4689,8 +5433,15 @@ extern void slurmdb_pack_step_rec(slurmdb_step_rec_t *step,
 	}
 }
 
-extern int slurmdb_unpack_step_rec(slurmdb_step_rec_t **step,
-				   uint16_t protocol_version, Buf buffer)
+extern void slurmdb_pack_step_rec(slurmdb_step_rec_t *step,
+				  uint16_t protocol_version, Buf buffer)
+{
+	_pack_step_rec(step, protocol_version, NULL, buffer);
+}
+
+static int _unpack_step_rec(slurmdb_step_rec_t **step,
+			    uint16_t protocol_version,
+			    slurmdb_str_dict_t *str_dict, Buf buffer)
 {
 	uint32_t uint32_tmp;
 	uint16_t uint16_tmp;
@@ -4704,7 +5455,7 @@ extern int slurmdb_unpack_step_rec(slurmdb_step_rec_t **step,
 		safe_unpack32(&uint32_tmp, buffer);
 		step_ptr->exitcode = (int32_t)uint32_tmp;
 		safe_unpack32(&step_ptr->nnodes, buffer);
-		safe_unpackstr_xmalloc(&step_ptr->nodes, &uint32_tmp, buffer);
+		safe_unpackstr_dict(&step_ptr->nodes, str_dict, buffer);
 		safe_unpack32(&step_ptr->ntasks, buffer);
 		safe_unpack32(&step_ptr->req_cpufreq_min, buffer);
 		safe_unpack32(&step_ptr->req_cpufreq_max, buffer);
@@ -4718,16 +5469,15 @@ extern int slurmdb_unpack_step_rec(slurmdb_step_rec_t **step,
 		safe_unpack16(&uint16_tmp, buffer);
 		step_ptr->state = uint16_tmp;
 		safe_unpack32(&step_ptr->stepid, buffer);
-		safe_unpackstr_xmalloc(&step_ptr->stepname,
-				       &uint32_tmp, buffer);
+		safe_unpackstr_dict(&step_ptr->stepname, str_dict, buffer);
 		safe_unpack32(&step_ptr->suspended, buffer);
 		safe_unpack32(&step_ptr->sys_cpu_sec, buffer);
 		safe_unpack32(&step_ptr->sys_cpu_usec, buffer);
 		safe_unpack32(&step_ptr->task_dist, buffer);
 		safe_unpack32(&step_ptr->tot_cpu_sec, buffer);
 		safe_unpack32(&step_ptr->tot_cpu_usec, buffer);
-		safe_unpackstr_xmalloc(&step_ptr->tres_alloc_str,
-				       &uint32_tmp, buffer);
+		safe_unpackstr_dict(&step_ptr->tres_alloc_str, str_dict,
+				    buffer);
 		safe_unpack32(&step_ptr->user_cpu_sec, buffer);
 		safe_unpack32(&step_ptr->user_cpu_usec, buffer);
 	} else {
@@ -4744,6 +5494,12 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+extern int slurmdb_unpack_step_rec(slurmdb_step_rec_t **step,
+				   uint16_t protocol_version, Buf buffer)
+{
+	return _unpack_step_rec(step, protocol_version, NULL, buffer);
+}
+
 static uint32_t _list_count_null(List l)
 {
 	uint32_t count = NO_VAL;
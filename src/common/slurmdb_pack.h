@@ -186,6 +186,29 @@ extern void slurmdb_pack_job_rec(void *object,
 				 uint16_t protocol_version, Buf buffer);
 extern int slurmdb_unpack_job_rec(void **job, uint16_t protocol_version,
 				  Buf buffer);
+
+/*
+ * Per-message string dictionary for bulk job/step transfers.  Strings
+ * that repeat across records (account, cluster, partition, user, ...)
+ * are interned while the records are packed and shipped once; each
+ * record carries a 32 bit index in their place.  Only used with 17.02
+ * and newer peers.
+ */
+typedef struct slurmdb_str_dict slurmdb_str_dict_t;
+
+extern slurmdb_str_dict_t *slurmdb_str_dict_create(void);
+extern void slurmdb_str_dict_destroy(slurmdb_str_dict_t *str_dict);
+/* Pack the interned strings, in index order */
+extern void slurmdb_str_dict_pack(slurmdb_str_dict_t *str_dict, Buf buffer);
+extern int slurmdb_str_dict_unpack(slurmdb_str_dict_t **str_dict, Buf buffer);
+/* As slurmdb_(un)pack_job_rec, but dictionary coding the repeated
+ * strings of the job and its steps */
+extern void slurmdb_pack_job_rec_dict(void *object,
+				      slurmdb_str_dict_t *str_dict,
+				      uint16_t protocol_version, Buf buffer);
+extern int slurmdb_unpack_job_rec_dict(void **job,
+				       slurmdb_str_dict_t *str_dict,
+				       uint16_t protocol_version, Buf buffer);
 extern void slurmdb_pack_qos_cond(void *in,
 				  uint16_t protocol_version, Buf buffer);
 extern int slurmdb_unpack_qos_cond(void **object, uint16_t protocol_version,
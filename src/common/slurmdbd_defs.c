@@ -76,6 +76,7 @@ strong_alias(slurmdbd_free_id_rc_msg,	slurmdb_slurmdbd_free_id_rc_msg);
 
 
 #define DBD_MAGIC		0xDEAD3219
+#define DBD_MAX_INFLIGHT	4	/* Pipelined agent sends per cycle */
 #define MAX_AGENT_QUEUE		10000
 #define MAX_DBD_MSG_LEN		16384
 #define SLURMDBD_TIMEOUT	900	/* Seconds SlurmDBD for response */
@@ -2165,8 +2166,12 @@ unpack_error:
 
 static void *_agent(void *x)
 {
-	int cnt, rc;
+	int i, cnt, rc;
 	Buf buffer;
+	Buf single_buf;
+	Buf mult_bufs[DBD_MAX_INFLIGHT];
+	List mult_lists[DBD_MAX_INFLIGHT];
+	int in_flight, sent;
 	struct timespec abs_time;
 	static time_t fail_time = 0;
 	int sigarray[] = {SIGUSR1, 0};
@@ -2214,33 +2219,42 @@ static void *_agent(void *x)
 			continue;
 		} else if ((cnt > 0) && ((cnt % 100) == 0))
 			info("slurmdbd: agent queue size %u", cnt);
-		/* Leave item on the queue until processing complete */
-		if (agent_list) {
+		/* Leave items on the queue until processing complete.
+		 * With more than one message queued, build a window of
+		 * up to DBD_MAX_INFLIGHT mult-msg chunks to pipeline
+		 * over the connection. */
+		single_buf = NULL;
+		in_flight = 0;
+		if (agent_list && (cnt > 1)) {
 			int handle_agent_count = 1000;
-			if (cnt > handle_agent_count) {
-				int agent_count = 0;
-				ListIterator agent_itr =
-					list_iterator_create(agent_list);
-				list_msg.my_list = list_create(NULL);
+			int chunk_count;
+			ListIterator agent_itr =
+				list_iterator_create(agent_list);
+			while (in_flight < DBD_MAX_INFLIGHT) {
+				chunk_count = 0;
+				list_msg.my_list = NULL;
 				while ((buffer = list_next(agent_itr))) {
+					if (!list_msg.my_list)
+						list_msg.my_list =
+							list_create(NULL);
 					list_enqueue(list_msg.my_list, buffer);
-					agent_count++;
-					if (agent_count > handle_agent_count)
+					if (++chunk_count >=
+					    handle_agent_count)
 						break;
 				}
-				list_iterator_destroy(agent_itr);
-				buffer = pack_slurmdbd_msg(
-					&list_req, SLURM_PROTOCOL_VERSION);
-			} else if (cnt > 1) {
-				list_msg.my_list = agent_list;
-				buffer = pack_slurmdbd_msg(
+				if (!list_msg.my_list)
+					break;
+				mult_lists[in_flight] = list_msg.my_list;
+				mult_bufs[in_flight] = pack_slurmdbd_msg(
 					&list_req, SLURM_PROTOCOL_VERSION);
-			} else
-				buffer = (Buf) list_peek(agent_list);
-		} else
-			buffer = NULL;
+				in_flight++;
+			}
+			list_iterator_destroy(agent_itr);
+			list_msg.my_list = NULL;
+		} else if (agent_list)
+			single_buf = (Buf) list_peek(agent_list);
 		slurm_mutex_unlock(&agent_lock);
-		if (buffer == NULL) {
+		if ((single_buf == NULL) && (in_flight == 0)) {
 			slurm_mutex_unlock(&slurmdbd_lock);
 
 			slurm_mutex_lock(&assoc_cache_mutex);
@@ -2254,26 +2268,61 @@ static void *_agent(void *x)
 		/* NOTE: agent_lock is clear here, so we can add more
 		 * requests to the queue while waiting for this RPC to
 		 * complete. */
-		rc = _send_msg(buffer);
-		if (rc != SLURM_SUCCESS) {
-			if (agent_shutdown) {
-				slurm_mutex_unlock(&slurmdbd_lock);
-				break;
-			}
-			error("slurmdbd: Failure sending message: %d: %m", rc);
-		} else if (list_msg.my_list) {
-			rc = _handle_mult_rc_ret(SLURM_PROTOCOL_VERSION,
-						 read_timeout);
-		} else {
-			rc = _get_return_code(SLURM_PROTOCOL_VERSION,
-					      read_timeout);
-			if (rc == EAGAIN) {
+		if (single_buf) {
+			rc = _send_msg(single_buf);
+			if (rc != SLURM_SUCCESS) {
 				if (agent_shutdown) {
 					slurm_mutex_unlock(&slurmdbd_lock);
 					break;
 				}
-				error("slurmdbd: Failure with "
-				      "message need to resend: %d: %m", rc);
+				error("slurmdbd: Failure sending message: "
+				      "%d: %m", rc);
+			} else {
+				rc = _get_return_code(SLURM_PROTOCOL_VERSION,
+						      read_timeout);
+				if (rc == EAGAIN) {
+					if (agent_shutdown) {
+						slurm_mutex_unlock(
+							&slurmdbd_lock);
+						break;
+					}
+					error("slurmdbd: Failure with "
+					      "message need to resend: "
+					      "%d: %m", rc);
+				}
+			}
+		} else {
+			/* Pipelined sends with windowed acknowledgments:
+			 * write every chunk back-to-back, then collect
+			 * their responses in order. Slurmdbd processes
+			 * this connection sequentially, so each
+			 * DBD_GOT_MULT_MSG response dequeues exactly the
+			 * messages that chunk acknowledged. */
+			rc = SLURM_SUCCESS;
+			for (sent = 0; sent < in_flight; sent++) {
+				rc = _send_msg(mult_bufs[sent]);
+				if (rc != SLURM_SUCCESS)
+					break;
+			}
+			if ((rc != SLURM_SUCCESS) && !agent_shutdown) {
+				error("slurmdbd: Failure sending message: "
+				      "%d: %m", rc);
+			}
+			for (i = 0; i < sent; i++) {
+				int rc2 = _handle_mult_rc_ret(
+					SLURM_PROTOCOL_VERSION, read_timeout);
+				if (rc2 != SLURM_SUCCESS) {
+					rc = rc2;
+					break;
+				}
+			}
+			if ((rc != SLURM_SUCCESS) && agent_shutdown) {
+				for (i = 0; i < in_flight; i++) {
+					FREE_NULL_LIST(mult_lists[i]);
+					free_buf(mult_bufs[i]);
+				}
+				slurm_mutex_unlock(&slurmdbd_lock);
+				break;
 			}
 		}
 		slurm_mutex_unlock(&slurmdbd_lock);
@@ -2283,33 +2332,25 @@ static void *_agent(void *x)
 		slurm_mutex_unlock(&assoc_cache_mutex);
 
 		slurm_mutex_lock(&agent_lock);
-		if (agent_list && (rc == SLURM_SUCCESS)) {
-			/* If we sent a mult_msg we just need to free
-			   buffer, we don't need to requeue, just mark
-			   list_msg.my_list as NULL as that is the
-			   sign we sent a mult_msg.
-			*/
-			if (list_msg.my_list) {
-				if (list_msg.my_list != agent_list)
-					FREE_NULL_LIST(list_msg.my_list);
-				list_msg.my_list = NULL;
-			} else
+		if (single_buf) {
+			if (agent_list && (rc == SLURM_SUCCESS)) {
 				buffer = (Buf) list_dequeue(agent_list);
-
-			free_buf(buffer);
-			fail_time = 0;
-		} else {
-			/* We still need to free a mult_msg even if we
-			   got a failure.
-			*/
-			if (list_msg.my_list) {
-				if (list_msg.my_list != agent_list)
-					FREE_NULL_LIST(list_msg.my_list);
-				list_msg.my_list = NULL;
 				free_buf(buffer);
+				fail_time = 0;
+			} else
+				fail_time = time(NULL);
+		} else {
+			/* Acknowledged messages were dequeued from
+			 * agent_list by _handle_mult_rc_ret(), anything
+			 * unacknowledged remains queued for resend. */
+			for (i = 0; i < in_flight; i++) {
+				FREE_NULL_LIST(mult_lists[i]);
+				free_buf(mult_bufs[i]);
 			}
-
-			fail_time = time(NULL);
+			if (rc == SLURM_SUCCESS)
+				fail_time = 0;
+			else
+				fail_time = time(NULL);
 		}
 		slurm_mutex_unlock(&agent_lock);
 		/* END_TIMER; */
@@ -3664,6 +3705,97 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* Pack a job list with a per-message string dictionary.  The
+ * dictionary is only complete once every record has been packed, but
+ * must precede the records on the wire, so the records are staged in a
+ * separate buffer that is appended after it. */
+static void _pack_job_list_msg_dict(dbd_list_msg_t *msg, uint16_t rpc_version,
+				    Buf buffer)
+{
+	uint32_t count = 0;
+	ListIterator itr = NULL;
+	void *object = NULL;
+	slurmdb_str_dict_t *str_dict = slurmdb_str_dict_create();
+	Buf rec_buf = init_buf(1024);
+
+	if (msg->my_list) {
+		count = list_count(msg->my_list);
+		pack32(count, rec_buf);
+	} else {
+		// to let user know there wasn't a list (error)
+		pack32((uint32_t)-1, rec_buf);
+	}
+	if (count) {
+		itr = list_iterator_create(msg->my_list);
+		while ((object = list_next(itr))) {
+			slurmdb_pack_job_rec_dict(object, str_dict,
+						  rpc_version, rec_buf);
+		}
+		list_iterator_destroy(itr);
+	}
+
+	slurmdb_str_dict_pack(str_dict, buffer);
+	slurmdb_str_dict_destroy(str_dict);
+	packmem(get_buf_data(rec_buf), get_buf_offset(rec_buf), buffer);
+	free_buf(rec_buf);
+
+	pack32(msg->return_code, buffer);
+}
+
+static int _unpack_job_list_msg_dict(dbd_list_msg_t **msg,
+				     uint16_t rpc_version, Buf buffer)
+{
+	int i;
+	uint32_t count = 0;
+	uint32_t rec_len = 0;
+	char *rec_data = NULL;
+	void *object = NULL;
+	Buf rec_buf = NULL;
+	slurmdb_str_dict_t *str_dict = NULL;
+	dbd_list_msg_t *msg_ptr = xmalloc(sizeof(dbd_list_msg_t));
+
+	*msg = msg_ptr;
+
+	if (slurmdb_str_dict_unpack(&str_dict, buffer) != SLURM_SUCCESS)
+		goto unpack_error;
+	safe_unpackmem_xmalloc(&rec_data, &rec_len, buffer);
+	rec_buf = create_buf(rec_data, rec_len);
+	rec_data = NULL;	/* rec_buf owns the data now */
+
+	safe_unpack32(&count, rec_buf);
+	if ((int)count > -1) {
+		/* here we are looking to make the list if -1 or
+		   higher than 0.  If -1 we don't want to have the
+		   list be NULL meaning an error occured.
+		*/
+		msg_ptr->my_list = list_create(slurmdb_destroy_job_rec);
+		for (i = 0; i < count; i++) {
+			if (slurmdb_unpack_job_rec_dict(&object, str_dict,
+							rpc_version, rec_buf)
+			    == SLURM_ERROR)
+				goto unpack_error;
+			list_append(msg_ptr->my_list, object);
+		}
+	}
+	free_buf(rec_buf);
+	rec_buf = NULL;
+	slurmdb_str_dict_destroy(str_dict);
+	str_dict = NULL;
+
+	safe_unpack32(&msg_ptr->return_code, buffer);
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	if (rec_buf)
+		free_buf(rec_buf);
+	xfree(rec_data);
+	slurmdb_str_dict_destroy(str_dict);
+	slurmdbd_free_list_msg(msg_ptr);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 extern void slurmdbd_pack_list_msg(dbd_list_msg_t *msg,
 				   uint16_t rpc_version,
 				   slurmdbd_msg_type_t type,
@@ -3674,6 +3806,13 @@ extern void slurmdbd_pack_list_msg(dbd_list_msg_t *msg,
 	void *object = NULL;
 	void (*my_function) (void *object, uint16_t rpc_version, Buf buffer);
 
+	if (((type == DBD_GOT_JOBS) || (type == DBD_FIX_RUNAWAY_JOB)) &&
+	    (rpc_version >= SLURM_17_02_PROTOCOL_VERSION)) {
+		/* Dictionary code the repeated record strings */
+		_pack_job_list_msg_dict(msg, rpc_version, buffer);
+		return;
+	}
+
 	switch(type) {
 	case DBD_ADD_ACCOUNTS:
 	case DBD_GOT_ACCOUNTS:
@@ -3769,6 +3908,10 @@ extern int slurmdbd_unpack_list_msg(dbd_list_msg_t **msg, uint16_t rpc_version,
 				    slurmdbd_msg_type_t type, Buf buffer)
 {
 	int i;
+
+	if (((type == DBD_GOT_JOBS) || (type == DBD_FIX_RUNAWAY_JOB)) &&
+	    (rpc_version >= SLURM_17_02_PROTOCOL_VERSION))
+		return _unpack_job_list_msg_dict(msg, rpc_version, buffer);
 	uint32_t count;
 	dbd_list_msg_t *msg_ptr = NULL;
 	void *object = NULL;
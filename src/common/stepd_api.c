@@ -43,11 +43,14 @@
 #endif
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <regex.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/param.h>	/* MAXPATHLEN */
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -185,6 +188,146 @@ _step_connect(const char *directory, const char *nodename,
 	return fd;
 }
 
+static char *
+_stats_file_name(const char *directory, const char *nodename,
+		 uint32_t jobid, uint32_t stepid)
+{
+	return xstrdup_printf("%s/%s_%u.%u.stats",
+			      directory, nodename, jobid, stepid);
+}
+
+extern stepd_stats_t *
+stepd_stats_create(const char *directory, const char *nodename,
+		   uint32_t jobid, uint32_t stepid, uid_t uid)
+{
+	stepd_stats_t *stats;
+	char *name;
+	int fd;
+
+	xassert(sizeof(struct jobacctinfo) <= STEPD_STATS_JOBACCT_SIZE);
+
+	name = _stats_file_name(directory, nodename, jobid, stepid);
+	(void) unlink(name);
+	fd = open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		error("%s: open(%s): %m", __func__, name);
+		xfree(name);
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(stepd_stats_t)) < 0) {
+		error("%s: ftruncate(%s): %m", __func__, name);
+		close(fd);
+		(void) unlink(name);
+		xfree(name);
+		return NULL;
+	}
+	stats = mmap(NULL, sizeof(stepd_stats_t), PROT_READ | PROT_WRITE,
+		     MAP_SHARED, fd, 0);
+	close(fd);
+	if (stats == MAP_FAILED) {
+		error("%s: mmap(%s): %m", __func__, name);
+		(void) unlink(name);
+		xfree(name);
+		return NULL;
+	}
+	xfree(name);
+
+	memset(stats, 0, sizeof(stepd_stats_t));
+	stats->uid = uid;
+	/* set the magic last so readers never see a half built file */
+	__sync_synchronize();
+	stats->magic = STEPD_STATS_MAGIC;
+
+	return stats;
+}
+
+extern void
+stepd_stats_update(stepd_stats_t *stats, jobacctinfo_t *jobacct,
+		   uint32_t num_tasks, pid_t *pids, int pid_cnt)
+{
+	/* seqlock style update: readers retry while the generation is
+	 * odd or changes under them, so no lock is needed */
+	stats->generation++;
+	__sync_synchronize();
+
+	if (pid_cnt > STEPD_STATS_MAX_PIDS) {
+		debug2("%s: %d pids truncated to %d", __func__,
+		       pid_cnt, STEPD_STATS_MAX_PIDS);
+		pid_cnt = STEPD_STATS_MAX_PIDS;
+	}
+	stats->pid_cnt = pid_cnt;
+	if (pid_cnt > 0)
+		memcpy(stats->pid, pids, pid_cnt * sizeof(pid_t));
+	stats->num_tasks = num_tasks;
+	memcpy(stats->jobacct, jobacct, sizeof(struct jobacctinfo));
+
+	__sync_synchronize();
+	stats->generation++;
+}
+
+extern int
+stepd_stats_read(const char *directory, const char *nodename,
+		 uint32_t jobid, uint32_t stepid, stepd_stats_t *stats)
+{
+	stepd_stats_t *shm;
+	struct stat st;
+	char *name;
+	uint32_t generation;
+	int fd, i, rc = SLURM_ERROR;
+
+	name = _stats_file_name(directory, nodename, jobid, stepid);
+	fd = open(name, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		debug3("%s: open(%s): %m", __func__, name);
+		xfree(name);
+		return SLURM_ERROR;
+	}
+	if ((fstat(fd, &st) < 0) || (st.st_size < sizeof(stepd_stats_t))) {
+		close(fd);
+		xfree(name);
+		return SLURM_ERROR;
+	}
+	shm = mmap(NULL, sizeof(stepd_stats_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		debug3("%s: mmap(%s): %m", __func__, name);
+		xfree(name);
+		return SLURM_ERROR;
+	}
+	xfree(name);
+
+	for (i = 0; i < 100; i++) {
+		generation = shm->generation;
+		if (generation & 1) {	/* update in progress */
+			sched_yield();
+			continue;
+		}
+		__sync_synchronize();
+		memcpy(stats, shm, sizeof(stepd_stats_t));
+		__sync_synchronize();
+		if ((shm->generation == generation) &&
+		    (stats->magic == STEPD_STATS_MAGIC) &&
+		    (generation != 0)) {
+			rc = SLURM_SUCCESS;
+			break;
+		}
+	}
+	munmap(shm, sizeof(stepd_stats_t));
+
+	return rc;
+}
+
+extern void
+stepd_stats_destroy(stepd_stats_t *stats, const char *directory,
+		    const char *nodename, uint32_t jobid, uint32_t stepid)
+{
+	char *name;
+
+	munmap(stats, sizeof(stepd_stats_t));
+	name = _stats_file_name(directory, nodename, jobid, stepid);
+	(void) unlink(name);
+	xfree(name);
+}
 
 static char *
 _guess_nodename(void)
@@ -379,6 +522,27 @@ stepd_notify_job(int fd, uint16_t protocol_version, char *message)
 	return -1;
 }
 
+/*
+ * Notify a slurmstepd launched while the job prolog was still running
+ * of the prolog's return code so it can proceed with (or abort) the
+ * task launch.
+ */
+int
+stepd_prolog_fini(int fd, uint16_t protocol_version, int prolog_rc)
+{
+	int req = REQUEST_STEP_PROLOG_FINI;
+	int rc;
+
+	safe_write(fd, &req, sizeof(int));
+	safe_write(fd, &prolog_rc, sizeof(int));
+
+	/* Receive the return code */
+	safe_read(fd, &rc, sizeof(int));
+	return rc;
+ rwfail:
+	return -1;
+}
+
 /*
  * Send a checkpoint request to all tasks of a job step.
  */
@@ -698,6 +862,12 @@ stepd_cleanup_sockets(const char *directory, const char *nodename)
 				rc = SLURM_ERROR;
 			}
 			xfree(path);
+
+			/* remove the shared statistics file as well */
+			path = _stats_file_name(directory, nodename,
+						jobid, stepid);
+			(void) unlink(path);
+			xfree(path);
 		}
 	}
 
@@ -47,6 +47,12 @@
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/io_hdr.h"
 
+/* Define jobacctinfo_t below to avoid including extraneous slurm headers */
+#ifndef __jobacctinfo_t_defined
+#  define  __jobacctinfo_t_defined
+   typedef struct jobacctinfo jobacctinfo_t;     /* opaque data type */
+#endif
+
 typedef enum {
 	REQUEST_CONNECT = 0,
 	REQUEST_SIGNAL_PROCESS_GROUP, /* Defunct, See REQUEST_SIGNAL_CONTAINER */
@@ -70,7 +76,8 @@ typedef enum {
 	REQUEST_STEP_MEM_LIMITS,
 	REQUEST_STEP_UID,
 	REQUEST_STEP_NODEID,
-	REQUEST_ADD_EXTERN_PID
+	REQUEST_ADD_EXTERN_PID,
+	REQUEST_STEP_PROLOG_FINI
 } step_msg_t;
 
 typedef enum {
@@ -112,6 +119,60 @@ typedef struct step_location {
 	uint16_t protocol_version;
 } step_loc_t;
 
+#define STEPD_STATS_MAGIC	0x73746174
+#define STEPD_STATS_MAX_PIDS	128
+/* Opaque copy of a struct jobacctinfo, kept as raw bytes so this header
+ * does not need to drag in slurm_jobacct_gather.h (which includes us) */
+#define STEPD_STATS_JOBACCT_SIZE 512
+
+/*
+ * Current resource usage of a job step, exported by slurmstepd through a
+ * file mapped next to its domain socket.  The stepd refreshes the data on
+ * every jobacct poll; readers copy it out without contacting the stepd.
+ */
+typedef struct {
+	uint32_t magic;		/* STEPD_STATS_MAGIC */
+	uint32_t generation;	/* odd while an update is in progress */
+	uid_t uid;		/* user the step belongs to */
+	uint32_t num_tasks;	/* tasks aggregated into jobacct */
+	uint32_t pid_cnt;	/* pids in the step container */
+	pid_t pid[STEPD_STATS_MAX_PIDS];
+	uint8_t jobacct[STEPD_STATS_JOBACCT_SIZE];
+				/* aggregate struct jobacctinfo of all
+				 * tasks.  The embedded pointers are only
+				 * meaningful in the stepd itself */
+} stepd_stats_t;
+
+/*
+ * Create and map the shared statistics file for a job step (stepd only).
+ */
+extern stepd_stats_t *stepd_stats_create(const char *directory,
+					 const char *nodename,
+					 uint32_t jobid, uint32_t stepid,
+					 uid_t uid);
+
+/*
+ * Publish a new sample into the shared statistics file.
+ */
+extern void stepd_stats_update(stepd_stats_t *stats, jobacctinfo_t *jobacct,
+			       uint32_t num_tasks, pid_t *pids, int pid_cnt);
+
+/*
+ * Copy a consistent snapshot of a step's shared statistics into "stats"
+ * without contacting the stepd.  Returns SLURM_ERROR if the file does not
+ * exist (older stepd or step already gone) or no stable snapshot could be
+ * read, in which case the caller should fall back to the domain socket.
+ */
+extern int stepd_stats_read(const char *directory, const char *nodename,
+			    uint32_t jobid, uint32_t stepid,
+			    stepd_stats_t *stats);
+
+/*
+ * Unmap and unlink the shared statistics file (stepd only).
+ */
+extern void stepd_stats_destroy(stepd_stats_t *stats, const char *directory,
+				const char *nodename,
+				uint32_t jobid, uint32_t stepid);
 
 /*
  * Cleanup stale stepd domain sockets.
@@ -152,6 +213,13 @@ slurmstepd_info_t *stepd_get_info(int fd);
  */
 int stepd_notify_job(int fd, uint16_t protocol_version, char *message);
 
+/*
+ * Notify a slurmstepd launched while the job prolog was still running
+ * of the prolog's return code so it can proceed with (or abort) the
+ * task launch.
+ */
+int stepd_prolog_fini(int fd, uint16_t protocol_version, int prolog_rc);
+
 /*
  * Send a checkpoint request to all tasks of a job step.
  */
@@ -36,11 +36,17 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/time.h>
 #include "src/common/log.h"
+#include "src/common/macros.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
 
 /*
  * slurm_diff_tv_str - build a string showing the time difference between two
@@ -92,6 +98,194 @@ extern void slurm_diff_tv_str(struct timeval *tv1, struct timeval *tv2,
 	}
 }
 
+#define PROF_REGION_MAX		64	/* distinct region names */
+#define PROF_HIST_BUCKETS	28	/* bucket b: sample < 2^(b+1) usec */
+#define PROF_NEST_MAX		16	/* region nesting depth per thread */
+#define PROF_BUF_SAMPLES	64	/* samples buffered per thread */
+
+typedef struct {
+	char *name;
+	uint64_t count;
+	uint64_t total_usec;
+	uint64_t min_usec;
+	uint64_t max_usec;
+	uint64_t hist[PROF_HIST_BUCKETS];
+} prof_region_t;
+
+typedef struct {
+	int region_inx;
+	uint64_t usec;
+} prof_sample_t;
+
+static prof_region_t prof_regions[PROF_REGION_MAX];
+static int prof_region_cnt = 0;
+static pthread_mutex_t prof_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread struct {
+	const char *name;
+	int region_inx;
+	struct timeval begin;
+} prof_stack[PROF_NEST_MAX];
+static __thread int prof_depth = 0;
+
+static __thread prof_sample_t prof_buf[PROF_BUF_SAMPLES];
+static __thread int prof_buf_len = 0;
+
+/* Find or create the global aggregate slot for a region name */
+static int _prof_region_inx(const char *name)
+{
+	int i;
+
+	slurm_mutex_lock(&prof_mutex);
+	for (i = 0; i < prof_region_cnt; i++) {
+		if (!xstrcmp(prof_regions[i].name, name))
+			break;
+	}
+	if (i == prof_region_cnt) {
+		if (prof_region_cnt >= PROF_REGION_MAX) {
+			slurm_mutex_unlock(&prof_mutex);
+			return -1;
+		}
+		prof_regions[i].name = xstrdup(name);
+		prof_region_cnt++;
+	}
+	slurm_mutex_unlock(&prof_mutex);
+	return i;
+}
+
+/* Fold this thread's buffered samples into the global aggregates */
+static void _prof_flush(void)
+{
+	prof_region_t *region;
+	uint64_t usec;
+	int i, bucket;
+
+	if (prof_buf_len == 0)
+		return;
+	slurm_mutex_lock(&prof_mutex);
+	for (i = 0; i < prof_buf_len; i++) {
+		region = &prof_regions[prof_buf[i].region_inx];
+		usec = prof_buf[i].usec;
+		if ((region->count == 0) || (usec < region->min_usec))
+			region->min_usec = usec;
+		if (usec > region->max_usec)
+			region->max_usec = usec;
+		region->count++;
+		region->total_usec += usec;
+		bucket = 0;
+		while ((usec >> (bucket + 1)) &&
+		       (bucket < (PROF_HIST_BUCKETS - 1)))
+			bucket++;
+		region->hist[bucket]++;
+	}
+	prof_buf_len = 0;
+	slurm_mutex_unlock(&prof_mutex);
+}
+
+/* Upper bound on the 99th percentile sample from the latency histogram.
+ * Call with prof_mutex locked. */
+static uint64_t _prof_p99(prof_region_t *region)
+{
+	uint64_t bound, cumulative = 0, threshold;
+	int bucket;
+
+	if (region->count == 0)
+		return 0;
+	threshold = region->count - (region->count / 100);
+	for (bucket = 0; bucket < PROF_HIST_BUCKETS; bucket++) {
+		cumulative += region->hist[bucket];
+		if (cumulative >= threshold) {
+			bound = ((uint64_t) 1 << (bucket + 1)) - 1;
+			return MIN(bound, region->max_usec);
+		}
+	}
+	return region->max_usec;
+}
+
+extern void prof_region_begin(const char *name)
+{
+	if (prof_depth < PROF_NEST_MAX) {
+		prof_stack[prof_depth].name = name;
+		prof_stack[prof_depth].region_inx = _prof_region_inx(name);
+		gettimeofday(&prof_stack[prof_depth].begin, NULL);
+	}
+	prof_depth++;
+}
+
+extern void prof_region_end(const char *name)
+{
+	struct timeval now;
+	int64_t usec;
+	int inx;
+
+	while (prof_depth > 0) {
+		prof_depth--;
+		if (prof_depth >= PROF_NEST_MAX)
+			continue;
+		if (!xstrcmp(prof_stack[prof_depth].name, name))
+			break;
+		/* Inner region left open (early return?), discard it */
+	}
+	if ((prof_depth < 0) || (prof_depth >= PROF_NEST_MAX) ||
+	    xstrcmp(prof_stack[prof_depth].name, name))
+		return;
+	inx = prof_stack[prof_depth].region_inx;
+	if (inx < 0)	/* region table was full at begin time */
+		return;
+	gettimeofday(&now, NULL);
+	usec  = (now.tv_sec - prof_stack[prof_depth].begin.tv_sec) * 1000000;
+	usec += now.tv_usec - prof_stack[prof_depth].begin.tv_usec;
+	if (usec < 0)
+		usec = 0;
+	prof_buf[prof_buf_len].region_inx = inx;
+	prof_buf[prof_buf_len].usec = (uint64_t) usec;
+	if (++prof_buf_len >= PROF_BUF_SAMPLES)
+		_prof_flush();
+}
+
+extern int prof_region_snapshot(char ***names, uint64_t **counts,
+				uint64_t **total_usec, uint64_t **min_usec,
+				uint64_t **max_usec, uint64_t **p99_usec)
+{
+	int i, region_cnt;
+
+	_prof_flush();	/* include this thread's buffered samples */
+	slurm_mutex_lock(&prof_mutex);
+	region_cnt = prof_region_cnt;
+	*names      = xmalloc(sizeof(char *)   * region_cnt);
+	*counts     = xmalloc(sizeof(uint64_t) * region_cnt);
+	*total_usec = xmalloc(sizeof(uint64_t) * region_cnt);
+	*min_usec   = xmalloc(sizeof(uint64_t) * region_cnt);
+	*max_usec   = xmalloc(sizeof(uint64_t) * region_cnt);
+	*p99_usec   = xmalloc(sizeof(uint64_t) * region_cnt);
+	for (i = 0; i < region_cnt; i++) {
+		(*names)[i]      = xstrdup(prof_regions[i].name);
+		(*counts)[i]     = prof_regions[i].count;
+		(*total_usec)[i] = prof_regions[i].total_usec;
+		(*min_usec)[i]   = prof_regions[i].min_usec;
+		(*max_usec)[i]   = prof_regions[i].max_usec;
+		(*p99_usec)[i]   = _prof_p99(&prof_regions[i]);
+	}
+	slurm_mutex_unlock(&prof_mutex);
+	return region_cnt;
+}
+
+extern void prof_region_reset(void)
+{
+	int i;
+
+	slurm_mutex_lock(&prof_mutex);
+	for (i = 0; i < prof_region_cnt; i++) {
+		prof_regions[i].count = 0;
+		prof_regions[i].total_usec = 0;
+		prof_regions[i].min_usec = 0;
+		prof_regions[i].max_usec = 0;
+		memset(prof_regions[i].hist, 0,
+		       sizeof(prof_regions[i].hist));
+	}
+	slurm_mutex_unlock(&prof_mutex);
+}
+
 /* block_daemon()
  *
  * This function allows to block any daemon
@@ -39,6 +39,7 @@
 #ifndef _HAVE_TIMERS_H
 #define _HAVE_TIMERS_H
 
+#include <stdint.h>
 #include <sys/time.h>
 
 #define DEF_TIMERS	struct timeval tv1, tv2; char tv_str[20] = ""; long delta_t;
@@ -67,6 +68,35 @@ extern void slurm_diff_tv_str(struct timeval *tv1,struct timeval *tv2,
 			      char *tv_str, int len_tv_str, const char *from,
 			      long limit, long *delta_t);
 
+/*
+ * Named profiling regions layered over the timers above. Bracket a code
+ * phase with prof_region_begin()/prof_region_end() using the same name
+ * (a string literal); regions may nest and the same region may be
+ * entered concurrently from several threads. Samples are buffered per
+ * thread and periodically folded into global per-region aggregates
+ * (count, total, min, max and a latency histogram from which p99 is
+ * derived), so a snapshot can lag each thread's most recent samples.
+ * An end call whose name does not match the innermost open region
+ * discards the intervening regions, so a begin orphaned by an early
+ * return is dropped rather than corrupting the aggregates.
+ */
+extern void prof_region_begin(const char *name);
+extern void prof_region_end(const char *name);
+
+/*
+ * prof_region_snapshot - copy out the aggregated region statistics
+ * OUT names - xmalloc'd array of xmalloc'd region names
+ * OUT counts/total_usec/min_usec/max_usec/p99_usec - xmalloc'd arrays
+ *	with one entry per region, in the same order as names
+ * RET number of regions
+ */
+extern int prof_region_snapshot(char ***names, uint64_t **counts,
+				uint64_t **total_usec, uint64_t **min_usec,
+				uint64_t **max_usec, uint64_t **p99_usec);
+
+/* Clear all aggregated region statistics (the region names persist) */
+extern void prof_region_reset(void);
+
 /* Block daemon indefinitely.
  */
 extern void block_daemon(void);
@@ -41,6 +41,7 @@
 #  define _GNU_SOURCE
 #endif
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <pwd.h>
 #include <grp.h>
@@ -48,9 +49,12 @@
 #include <errno.h>
 #include <limits.h>
 #include <string.h>
+#include <time.h>
 
 #include "slurm/slurm_errno.h"
 
+#include "src/common/list.h"
+#include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
@@ -65,6 +69,181 @@ static pthread_mutex_t uid_lock = PTHREAD_MUTEX_INITIALIZER;
 static uid_cache_entry_t *uid_cache = NULL;
 static int uid_cache_used = 0;
 
+/*
+ * Process-wide uid/gid resolution cache. Every submit validation and
+ * launch credential check resolves names through NSS, so a slow
+ * directory service (LDAP) translates directly into submit and launch
+ * latency. Positive entries are served for UID_CACHE_TTL seconds and
+ * then refreshed asynchronously while the stale value keeps being
+ * served, so the hot path never blocks on the directory service once
+ * a name has been seen. Failed lookups are cached for the shorter
+ * UID_CACHE_NEG_TTL and then retried synchronously.
+ */
+#define UID_CACHE_TTL		300	/* seconds, positive entries */
+#define UID_CACHE_NEG_TTL	30	/* seconds, negative entries */
+
+typedef struct pw_cache_entry {
+	char  *key;		/* lookup string: name or numeric id */
+	char  *name;		/* canonical name (positive entries) */
+	uid_t  id;		/* resolved uid (or gid for groups) */
+	gid_t  gid;		/* primary gid (user entries only) */
+	bool   negative;	/* lookup failed */
+	bool   refreshing;	/* asynchronous refresh in flight */
+	time_t expire;
+} pw_cache_entry_t;
+
+struct pw_refresh_args {
+	char *key;
+	bool  is_group;
+};
+
+typedef struct valid_cache_entry {
+	uid_t  uid;
+	gid_t  req_gid;		/* gid as requested by the caller */
+	gid_t  gid;		/* resolved gid */
+	char  *user_name;
+	bool   validated_gid;	/* gid membership was verified */
+	time_t expire;
+} valid_cache_entry_t;
+
+struct valid_cache_key {
+	uid_t uid;
+	gid_t gid;
+};
+
+typedef struct grplist_cache_entry {
+	uid_t  uid;
+	gid_t  gid;		/* primary gid used for the lookup */
+	gid_t *groups;		/* supplementary groups (positive entries) */
+	int    ngroups;		/* group count, or -1 for a failed lookup */
+	time_t expire;
+} grplist_cache_entry_t;
+
+static pthread_mutex_t pw_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static List user_cache_list = NULL;
+static List group_cache_list = NULL;
+static List valid_cache_list = NULL;
+static List grplist_cache_list = NULL;
+
+static void *_pw_cache_refresh(void *arg);
+
+static void _pw_cache_del(void *x)
+{
+	pw_cache_entry_t *e = x;
+
+	if (e) {
+		xfree(e->key);
+		xfree(e->name);
+		xfree(e);
+	}
+}
+
+static int _pw_cache_find_key(void *x, void *key)
+{
+	pw_cache_entry_t *e = x;
+
+	return (xstrcmp(e->key, (char *) key) == 0);
+}
+
+static int _pw_cache_find_id(void *x, void *key)
+{
+	pw_cache_entry_t *e = x;
+
+	return (e->id == *(uid_t *) key);
+}
+
+static void _valid_cache_del(void *x)
+{
+	valid_cache_entry_t *e = x;
+
+	if (e) {
+		xfree(e->user_name);
+		xfree(e);
+	}
+}
+
+static int _valid_cache_find(void *x, void *key)
+{
+	valid_cache_entry_t *e = x;
+	struct valid_cache_key *k = key;
+
+	return ((e->uid == k->uid) && (e->req_gid == k->gid));
+}
+
+static void _grplist_cache_del(void *x)
+{
+	grplist_cache_entry_t *e = x;
+
+	if (e) {
+		xfree(e->groups);
+		xfree(e);
+	}
+}
+
+static int _grplist_cache_find(void *x, void *key)
+{
+	grplist_cache_entry_t *e = x;
+	struct valid_cache_key *k = key;
+
+	return ((e->uid == k->uid) && (e->gid == k->gid));
+}
+
+/* Insert or update a cache entry. Call with pw_cache_lock held.
+ * A failed lookup (rc != 0) produces a negative entry. */
+static void _pw_cache_upsert(List *list_ptr, char *key, int rc,
+			     char *name, uid_t id, gid_t gid)
+{
+	pw_cache_entry_t *e;
+
+	if (*list_ptr == NULL)
+		*list_ptr = list_create(_pw_cache_del);
+	e = list_find_first(*list_ptr, _pw_cache_find_key, key);
+	if (e == NULL) {
+		e = xmalloc(sizeof(pw_cache_entry_t));
+		e->key = xstrdup(key);
+		list_append(*list_ptr, e);
+	}
+	xfree(e->name);
+	if (rc == 0) {
+		e->name = xstrdup(name);
+		e->id = id;
+		e->gid = gid;
+		e->negative = false;
+		e->expire = time(NULL) + UID_CACHE_TTL;
+	} else {
+		e->id = id;
+		e->gid = (gid_t) -1;
+		e->negative = true;
+		e->expire = time(NULL) + UID_CACHE_NEG_TTL;
+	}
+	e->refreshing = false;
+}
+
+/* Refresh an expired positive entry in the background so the caller
+ * can keep using the stale value. Call with pw_cache_lock held. */
+static void _pw_cache_spawn_refresh(pw_cache_entry_t *e, bool is_group)
+{
+	pthread_attr_t attr;
+	pthread_t tid;
+	struct pw_refresh_args *args;
+
+	e->refreshing = true;
+	args = xmalloc(sizeof(struct pw_refresh_args));
+	args->key = xstrdup(e->key);
+	args->is_group = is_group;
+
+	slurm_attr_init(&attr);
+	if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED))
+		error("pthread_attr_setdetachstate error %m");
+	if (pthread_create(&tid, &attr, _pw_cache_refresh, args)) {
+		error("%s: pthread_create error %m", __func__);
+		e->refreshing = false;
+		xfree(args->key);
+		xfree(args);
+	}
+	slurm_attr_destroy(&attr);
+}
+
 static int _getpwnam_r (const char *name, struct passwd *pwd, char *buf,
 		size_t bufsiz, struct passwd **result)
 {
@@ -95,22 +274,24 @@ extern int slurm_getpwuid_r (uid_t uid, struct passwd *pwd, char *buf,
 	return rc;
 }
 
-int
-uid_from_string (char *name, uid_t *uidp)
+/* Resolve a user name (or numeric uid string) through NSS, bypassing
+ * the cache. On success (return 0), *uidp and *gidp are set and
+ * *user_namep is set to an xmalloc'd copy of the canonical name. */
+static int _uid_from_string_direct(char *name, uid_t *uidp, gid_t *gidp,
+				   char **user_namep)
 {
 	struct passwd pwd, *result;
 	char buffer[PW_BUF_SIZE], *p = NULL;
 	long l;
 
-	if (!name)
-		return -1;
-
 	/*
 	 *  Check to see if name is a valid username first.
 	 */
 	if ((_getpwnam_r (name, &pwd, buffer, PW_BUF_SIZE, &result) == 0)
 	    && result != NULL) {
 		*uidp = result->pw_uid;
+		*gidp = result->pw_gid;
+		*user_namep = xstrdup(result->pw_name);
 		return 0;
 	}
 
@@ -133,26 +314,122 @@ uid_from_string (char *name, uid_t *uidp)
 		return -1;
 
 	*uidp = (uid_t) l;
+	if (result) {
+		*gidp = result->pw_gid;
+		*user_namep = xstrdup(result->pw_name);
+	} else {
+		*gidp = (gid_t) -1;
+		*user_namep = xstrdup(name);
+	}
+	return 0;
+}
+
+/* Resolve a uid through NSS, bypassing the cache. On success (return
+ * 0), *user_namep is set to an xmalloc'd copy of the user name and
+ * *gidp to the primary gid. */
+static int _uid_lookup_direct(uid_t uid, char **user_namep, gid_t *gidp)
+{
+	struct passwd pwd, *result;
+	char buffer[PW_BUF_SIZE];
+	int rc;
+
+	rc = slurm_getpwuid_r(uid, &pwd, buffer, PW_BUF_SIZE, &result);
+	if (!result || rc)
+		return -1;
+
+	*user_namep = xstrdup(result->pw_name);
+	*gidp = result->pw_gid;
+	return 0;
+}
+
+int
+uid_from_string (char *name, uid_t *uidp)
+{
+	pw_cache_entry_t *e;
+	char *user_name = NULL;
+	uid_t uid = (uid_t) -1;
+	gid_t gid = (gid_t) -1;
+	time_t now = time(NULL);
+	int rc;
+
+	if (!name)
+		return -1;
+
+	slurm_mutex_lock(&pw_cache_lock);
+	if (user_cache_list &&
+	    (e = list_find_first(user_cache_list, _pw_cache_find_key, name))) {
+		if (!e->negative) {
+			*uidp = e->id;
+			if ((e->expire <= now) && !e->refreshing)
+				_pw_cache_spawn_refresh(e, false);
+			slurm_mutex_unlock(&pw_cache_lock);
+			return 0;
+		}
+		if (e->expire > now) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return -1;
+		}
+		/* expired negative entry, retry the lookup */
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	rc = _uid_from_string_direct(name, &uid, &gid, &user_name);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	_pw_cache_upsert(&user_cache_list, name, rc, user_name, uid, gid);
+	slurm_mutex_unlock(&pw_cache_lock);
+	xfree(user_name);
+
+	if (rc)
+		return -1;
+	*uidp = uid;
 	return 0;
 }
 
 char *
 uid_to_string (uid_t uid)
 {
-	struct passwd pwd, *result;
-	char buffer[PW_BUF_SIZE], *ustring;
+	pw_cache_entry_t *e;
+	char *user_name = NULL, *key, *ustring = NULL;
+	gid_t gid = (gid_t) -1;
+	time_t now = time(NULL);
 	int rc;
 
 	/* Suse Linux does not handle multiple users with UID=0 well */
 	if (uid == 0)
 		return xstrdup("root");
 
-	rc = slurm_getpwuid_r(uid, &pwd, buffer, PW_BUF_SIZE, &result);
-	if (result && (rc == 0))
-		ustring = xstrdup(result->pw_name);
+	slurm_mutex_lock(&pw_cache_lock);
+	if (user_cache_list &&
+	    (e = list_find_first(user_cache_list, _pw_cache_find_id, &uid))) {
+		if (!e->negative) {
+			ustring = xstrdup(e->name);
+			if ((e->expire <= now) && !e->refreshing)
+				_pw_cache_spawn_refresh(e, false);
+		} else if (e->expire > now)
+			ustring = xstrdup("nobody");
+		if (ustring) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return ustring;
+		}
+		/* expired negative entry, retry the lookup */
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	rc = _uid_lookup_direct(uid, &user_name, &gid);
+	if (rc == 0)
+		key = xstrdup(user_name);
 	else
-		ustring = xstrdup("nobody");
-	return ustring;
+		key = xstrdup_printf("%u", (uint32_t) uid);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	_pw_cache_upsert(&user_cache_list, key, rc, user_name, uid, gid);
+	slurm_mutex_unlock(&pw_cache_lock);
+	xfree(key);
+
+	if (rc == 0)
+		return user_name;
+	return xstrdup("nobody");
 }
 
 
@@ -173,6 +450,15 @@ extern void uid_cache_clear(void)
 	xfree(uid_cache);
 	uid_cache_used = 0;
 	slurm_mutex_unlock(&uid_lock);
+
+	/* Flush the TTL caches too, in-flight refreshes of flushed
+	 * entries drop their results. */
+	slurm_mutex_lock(&pw_cache_lock);
+	FREE_NULL_LIST(user_cache_list);
+	FREE_NULL_LIST(group_cache_list);
+	FREE_NULL_LIST(valid_cache_list);
+	FREE_NULL_LIST(grplist_cache_list);
+	slurm_mutex_unlock(&pw_cache_lock);
 }
 
 extern char *uid_to_string_cached(uid_t uid)
@@ -201,16 +487,41 @@ extern char *uid_to_string_cached(uid_t uid)
 gid_t
 gid_from_uid (uid_t uid)
 {
-	struct passwd pwd, *result;
-	char buffer[PW_BUF_SIZE];
-	gid_t gid;
+	pw_cache_entry_t *e;
+	char *user_name = NULL, *key;
+	gid_t gid = (gid_t) -1;
+	time_t now = time(NULL);
 	int rc;
 
-	rc = slurm_getpwuid_r(uid, &pwd, buffer, PW_BUF_SIZE, &result);
-	if (result && (rc == 0))
-		gid = result->pw_gid;
+	slurm_mutex_lock(&pw_cache_lock);
+	if (user_cache_list &&
+	    (e = list_find_first(user_cache_list, _pw_cache_find_id, &uid))) {
+		if (!e->negative) {
+			gid = e->gid;
+			if ((e->expire <= now) && !e->refreshing)
+				_pw_cache_spawn_refresh(e, false);
+			slurm_mutex_unlock(&pw_cache_lock);
+			return gid;
+		}
+		if (e->expire > now) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return (gid_t) -1;
+		}
+		/* expired negative entry, retry the lookup */
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	rc = _uid_lookup_direct(uid, &user_name, &gid);
+	if (rc == 0)
+		key = xstrdup(user_name);
 	else
-		gid = (gid_t) -1;
+		key = xstrdup_printf("%u", (uint32_t) uid);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	_pw_cache_upsert(&user_cache_list, key, rc, user_name, uid, gid);
+	slurm_mutex_unlock(&pw_cache_lock);
+	xfree(key);
+	xfree(user_name);
 
 	return gid;
 }
@@ -245,22 +556,23 @@ static int _getgrgid_r (gid_t gid, struct group *grp, char *buf,
 	return rc;
 }
 
-int
-gid_from_string (char *name, gid_t *gidp)
+/* Resolve a group name (or numeric gid string) through NSS, bypassing
+ * the cache. On success (return 0), *gidp is set and *group_namep is
+ * set to an xmalloc'd copy of the canonical name. */
+static int _gid_from_string_direct(char *name, gid_t *gidp,
+				   char **group_namep)
 {
 	struct group grp, *result;
 	char buffer[PW_BUF_SIZE], *p = NULL;
 	long l;
 
-	if (!name)
-		return -1;
-
 	/*
 	 *  Check for valid group name first.
 	 */
 	if ((_getgrnam_r (name, &grp, buffer, PW_BUF_SIZE, &result) == 0)
 	    && result != NULL) {
 		*gidp = result->gr_gid;
+		*group_namep = xstrdup(result->gr_name);
 		return 0;
 	}
 
@@ -284,6 +596,51 @@ gid_from_string (char *name, gid_t *gidp)
 		return -1;
 
 	*gidp = (gid_t) l;
+	*group_namep = xstrdup(result->gr_name);
+	return 0;
+}
+
+int
+gid_from_string (char *name, gid_t *gidp)
+{
+	pw_cache_entry_t *e;
+	char *group_name = NULL;
+	gid_t gid = (gid_t) -1;
+	time_t now = time(NULL);
+	int rc;
+
+	if (!name)
+		return -1;
+
+	slurm_mutex_lock(&pw_cache_lock);
+	if (group_cache_list &&
+	    (e = list_find_first(group_cache_list, _pw_cache_find_key, name))) {
+		if (!e->negative) {
+			*gidp = (gid_t) e->id;
+			if ((e->expire <= now) && !e->refreshing)
+				_pw_cache_spawn_refresh(e, true);
+			slurm_mutex_unlock(&pw_cache_lock);
+			return 0;
+		}
+		if (e->expire > now) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return -1;
+		}
+		/* expired negative entry, retry the lookup */
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	rc = _gid_from_string_direct(name, &gid, &group_name);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	_pw_cache_upsert(&group_cache_list, name, rc, group_name,
+			 (uid_t) gid, (gid_t) -1);
+	slurm_mutex_unlock(&pw_cache_lock);
+	xfree(group_name);
+
+	if (rc)
+		return -1;
+	*gidp = gid;
 	return 0;
 }
 
@@ -291,17 +648,158 @@ char *
 gid_to_string (gid_t gid)
 {
 	struct group grp, *result;
-	char buffer[PW_BUF_SIZE], *gstring;
+	char buffer[PW_BUF_SIZE], *key, *gstring = NULL;
+	pw_cache_entry_t *e;
+	uid_t id = (uid_t) gid;
+	time_t now = time(NULL);
 	int rc;
 
+	slurm_mutex_lock(&pw_cache_lock);
+	if (group_cache_list &&
+	    (e = list_find_first(group_cache_list, _pw_cache_find_id, &id))) {
+		if (!e->negative) {
+			gstring = xstrdup(e->name);
+			if ((e->expire <= now) && !e->refreshing)
+				_pw_cache_spawn_refresh(e, true);
+		} else if (e->expire > now)
+			gstring = xstrdup("nobody");
+		if (gstring) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return gstring;
+		}
+		/* expired negative entry, retry the lookup */
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
 	rc = _getgrgid_r(gid, &grp, buffer, PW_BUF_SIZE, &result);
-	if (rc == 0 && result)
+	if ((rc == 0) && result) {
 		gstring = xstrdup(result->gr_name);
-	else
+		key = xstrdup(gstring);
+		rc = 0;
+	} else {
+		key = xstrdup_printf("%u", (uint32_t) gid);
+		rc = -1;
+	}
+
+	slurm_mutex_lock(&pw_cache_lock);
+	_pw_cache_upsert(&group_cache_list, key, rc, gstring,
+			 id, (gid_t) -1);
+	slurm_mutex_unlock(&pw_cache_lock);
+	xfree(key);
+
+	if (gstring == NULL)
 		gstring = xstrdup("nobody");
 	return gstring;
 }
 
+/* Background thread: re-resolve one cache entry through NSS and
+ * store the fresh result (or a negative entry if the lookup now
+ * fails). The entry may have been flushed meanwhile, in which case
+ * the result is simply dropped. */
+static void *_pw_cache_refresh(void *arg)
+{
+	struct pw_refresh_args *args = arg;
+	pw_cache_entry_t *e;
+	char *name = NULL;
+	uid_t id = (uid_t) -1;
+	gid_t gid = (gid_t) -1;
+	List cache_list;
+	int rc;
+
+	if (args->is_group) {
+		gid_t g = (gid_t) -1;
+		rc = _gid_from_string_direct(args->key, &g, &name);
+		id = (uid_t) g;
+	} else
+		rc = _uid_from_string_direct(args->key, &id, &gid, &name);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	cache_list = args->is_group ? group_cache_list : user_cache_list;
+	if (cache_list &&
+	    (e = list_find_first(cache_list, _pw_cache_find_key, args->key))) {
+		xfree(e->name);
+		if (rc == 0) {
+			e->name = xstrdup(name);
+			e->id = id;
+			e->gid = gid;
+			e->negative = false;
+			e->expire = time(NULL) + UID_CACHE_TTL;
+		} else {
+			e->negative = true;
+			e->expire = time(NULL) + UID_CACHE_NEG_TTL;
+		}
+		e->refreshing = false;
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	xfree(name);
+	xfree(args->key);
+	xfree(args);
+	return NULL;
+}
+
+extern int slurm_user_grouplist_cached(uid_t uid, gid_t gid, gid_t *groups,
+				       int max_groups, int *ngroups)
+{
+	grplist_cache_entry_t *e;
+	struct valid_cache_key k = {uid, gid};
+	char *user_name;
+	time_t now = time(NULL);
+	int n, rc;
+
+	slurm_mutex_lock(&pw_cache_lock);
+	if (grplist_cache_list &&
+	    (e = list_find_first(grplist_cache_list, _grplist_cache_find, &k))
+	    && (e->expire > now)) {
+		if (e->ngroups < 0) {
+			slurm_mutex_unlock(&pw_cache_lock);
+			return SLURM_ERROR;
+		}
+		n = MIN(e->ngroups, max_groups);
+		memcpy(groups, e->groups, n * sizeof(gid_t));
+		*ngroups = n;
+		slurm_mutex_unlock(&pw_cache_lock);
+		return SLURM_SUCCESS;
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	user_name = uid_to_string(uid);
+	*ngroups = max_groups;
+	rc = getgrouplist(user_name, gid, groups, ngroups);
+	if (rc < 0) {
+		error("getgrouplist(%s): %m", user_name);
+		rc = SLURM_ERROR;
+	} else {
+		*ngroups = rc;
+		rc = SLURM_SUCCESS;
+	}
+	xfree(user_name);
+
+	slurm_mutex_lock(&pw_cache_lock);
+	if (grplist_cache_list == NULL)
+		grplist_cache_list = list_create(_grplist_cache_del);
+	e = list_find_first(grplist_cache_list, _grplist_cache_find, &k);
+	if (e == NULL) {
+		e = xmalloc(sizeof(grplist_cache_entry_t));
+		e->uid = uid;
+		e->gid = gid;
+		list_append(grplist_cache_list, e);
+	}
+	xfree(e->groups);
+	if (rc == SLURM_SUCCESS) {
+		e->ngroups = *ngroups;
+		e->groups = xmalloc(e->ngroups * sizeof(gid_t));
+		memcpy(e->groups, groups, e->ngroups * sizeof(gid_t));
+		e->expire = now + UID_CACHE_TTL;
+	} else {
+		e->ngroups = -1;
+		e->expire = now + UID_CACHE_NEG_TTL;
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	return rc;
+}
+
 int
 slurm_find_group_user(struct passwd *pwd, gid_t gid)
 {
@@ -342,9 +840,8 @@ slurm_find_group_user(struct passwd *pwd, gid_t gid)
  *                     uid.  Set gid with correct gid if root launched job.
  * RET - returns 0 if invalid uid/gid, otherwise returns 1
  */
-extern int slurm_valid_uid_gid(uid_t uid, gid_t *gid, char **user_name,
-			       bool name_already_verified,
-			       bool validate_gid)
+static int _valid_uid_gid(uid_t uid, gid_t *gid, char **user_name,
+			  bool validate_gid)
 {
 	struct passwd pwd, *result;
 	char buffer[PW_BUF_SIZE];
@@ -352,10 +849,6 @@ extern int slurm_valid_uid_gid(uid_t uid, gid_t *gid, char **user_name,
 	struct group *grp;
 	int i;
 
-	/* already verified */
-	if (name_already_verified && *user_name)
-		return 1;
-
 	rc = slurm_getpwuid_r(uid, &pwd, buffer, PW_BUF_SIZE, &result);
 
 	if (!result || rc) {
@@ -411,3 +904,59 @@ extern int slurm_valid_uid_gid(uid_t uid, gid_t *gid, char **user_name,
 
 	return 0;
 }
+
+extern int slurm_valid_uid_gid(uid_t uid, gid_t *gid, char **user_name,
+			       bool name_already_verified,
+			       bool validate_gid)
+{
+	valid_cache_entry_t *e;
+	struct valid_cache_key key;
+	time_t now = time(NULL);
+	int rc;
+
+	/* already verified */
+	if (name_already_verified && *user_name)
+		return 1;
+
+	/* Successful validations are cached so the launch hot path
+	 * does not query the directory service for every task launch
+	 * of the same user. Failures are never cached here, they
+	 * always get a fresh look at the user database. */
+	key.uid = uid;
+	key.gid = *gid;
+	slurm_mutex_lock(&pw_cache_lock);
+	if (valid_cache_list &&
+	    (e = list_find_first(valid_cache_list, _valid_cache_find, &key)) &&
+	    (e->expire > now) && (e->validated_gid || !validate_gid)) {
+		if (!*user_name)
+			*user_name = xstrdup(e->user_name);
+		*gid = e->gid;
+		slurm_mutex_unlock(&pw_cache_lock);
+		return 1;
+	}
+	slurm_mutex_unlock(&pw_cache_lock);
+
+	rc = _valid_uid_gid(uid, gid, user_name, validate_gid);
+	if (rc) {
+		slurm_mutex_lock(&pw_cache_lock);
+		if (valid_cache_list == NULL)
+			valid_cache_list = list_create(_valid_cache_del);
+		e = list_find_first(valid_cache_list, _valid_cache_find, &key);
+		if (e == NULL) {
+			e = xmalloc(sizeof(valid_cache_entry_t));
+			e->uid = key.uid;
+			e->req_gid = key.gid;
+			list_append(valid_cache_list, e);
+		}
+		e->gid = *gid;
+		xfree(e->user_name);
+		e->user_name = xstrdup(*user_name);
+		if (e->expire > now)	/* don't drop a stronger check */
+			e->validated_gid |= validate_gid;
+		else
+			e->validated_gid = validate_gid;
+		e->expire = now + UID_CACHE_TTL;
+		slurm_mutex_unlock(&pw_cache_lock);
+	}
+	return rc;
+}
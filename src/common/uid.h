@@ -84,7 +84,8 @@ int gid_from_string (char *name, gid_t *gidp);
  */
 char *uid_to_string (uid_t uid);
 
-/* Free any memory allocated by uid_to_string_cached() */
+/* Free any memory allocated by uid_to_string_cached() and flush the
+ * process-wide uid/gid resolution caches */
 extern void uid_cache_clear(void);
 
 /*
@@ -99,6 +100,16 @@ extern char *uid_to_string_cached(uid_t uid);
  */
 char *gid_to_string (gid_t gid);
 
+/*
+ * Resolve the supplementary group list of a user through getgrouplist(),
+ * using the process-wide resolution cache keyed by (uid, gid). Follows
+ * the getgrouplist() conventions: groups must point to max_groups
+ * entries and *ngroups is set to the number of groups stored.
+ * Returns SLURM_SUCCESS or SLURM_ERROR on resolution failure.
+ */
+extern int slurm_user_grouplist_cached(uid_t uid, gid_t gid, gid_t *groups,
+				       int max_groups, int *ngroups);
+
 /* slurm_find_group_user()
  *
  * Find the user entry in the group gid. As groups could
@@ -67,14 +67,117 @@ typedef struct xhash_item_st {
 	UT_hash_handle	hh;      /* make this structure hashable by uthash  */
 } xhash_item_t;
 
+/* Slot of the open-addressing (robin hood hashing) backend, selected by
+ * passing a non-zero table_size to xhash_init(). The cached key pointer
+ * and full hash are stored inline in the flat slot array, so probes
+ * compare hashes without chasing per-entry pointers and only touch the
+ * key string on a hash match. */
+typedef struct xhash_oa_slot {
+	void*		item;	/* user item                                */
+	const char*	key;	/* cached key calculated by user function   */
+	uint64_t	hash;	/* full hash of key                         */
+	uint32_t	dib;	/* distance from the initial bucket plus
+				 * one, zero marks an unused slot           */
+} xhash_oa_slot_t;
+
 struct xhash_st {
 	uint32_t		count;    /* user items count                */
 	xhash_freefunc_t	freefunc; /* function used to free items     */
 	xhash_item_t*		ht;       /* hash table                      */
 	xhash_idfunc_t		identify; /* function returning a unique str
 					     key */
+	xhash_oa_slot_t*	slots;    /* open addressing slot array, or
+					     NULL to use uthash chaining    */
+	uint32_t		slot_cnt; /* slot array size, power of two   */
+	uint32_t		grow_at;  /* count at which the slot array
+					     is doubled                     */
 };
 
+/* Place one entry in an open addressing slot array, displacing richer
+ * entries as needed (robin hood hashing) */
+static void _oa_insert(xhash_oa_slot_t* slots, uint32_t slot_cnt,
+		       void* item, const char* key, uint64_t hash)
+{
+	uint32_t mask = slot_cnt - 1;
+	uint32_t inx = (uint32_t) hash & mask;
+	xhash_oa_slot_t cur, tmp;
+
+	cur.item = item;
+	cur.key  = key;
+	cur.hash = hash;
+	cur.dib  = 1;
+	while (slots[inx].dib) {
+		if (slots[inx].dib < cur.dib) {
+			tmp = slots[inx];
+			slots[inx] = cur;
+			cur = tmp;
+		}
+		cur.dib++;
+		inx = (inx + 1) & mask;
+	}
+	slots[inx] = cur;
+}
+
+/* Resize the open addressing slot array to new_cnt (a power of two)
+ * and reinsert every entry. Also used to build the initial array. */
+static void _oa_grow(xhash_t* table, uint32_t new_cnt)
+{
+	xhash_oa_slot_t* old_slots = table->slots;
+	uint32_t old_cnt = table->slot_cnt;
+	uint32_t inx;
+
+	table->slots = (xhash_oa_slot_t*)xmalloc(sizeof(xhash_oa_slot_t) *
+						 new_cnt);
+	table->slot_cnt = new_cnt;
+	/* grow at 3/4 load to keep probe sequences short */
+	table->grow_at = new_cnt - (new_cnt / 4);
+	for (inx = 0; inx < old_cnt; inx++) {
+		if (!old_slots[inx].dib)
+			continue;
+		_oa_insert(table->slots, new_cnt, old_slots[inx].item,
+			   old_slots[inx].key, old_slots[inx].hash);
+	}
+	xfree(old_slots);
+}
+
+/* @returns the slot holding key, or NULL if not present */
+static xhash_oa_slot_t* _oa_find(xhash_t* table, const char* key)
+{
+	uint64_t hash = siphash_str(key);
+	uint32_t mask = table->slot_cnt - 1;
+	uint32_t inx = (uint32_t) hash & mask;
+	uint32_t dib = 1;
+
+	while (table->slots[inx].dib) {
+		/* were key present it would have displaced this entry */
+		if (table->slots[inx].dib < dib)
+			return NULL;
+		if ((table->slots[inx].hash == hash) &&
+		    (strcmp(table->slots[inx].key, key) == 0))
+			return &table->slots[inx];
+		dib++;
+		inx = (inx + 1) & mask;
+	}
+	return NULL;
+}
+
+/* Remove one slot, shifting the following probe sequence backward to
+ * preserve lookup invariants (no tombstones) */
+static void _oa_remove(xhash_t* table, xhash_oa_slot_t* slot)
+{
+	uint32_t mask = table->slot_cnt - 1;
+	uint32_t inx = slot - table->slots;
+	uint32_t next = (inx + 1) & mask;
+
+	while (table->slots[next].dib > 1) {
+		table->slots[inx] = table->slots[next];
+		table->slots[inx].dib--;
+		inx = next;
+		next = (next + 1) & mask;
+	}
+	memset(&table->slots[inx], 0, sizeof(xhash_oa_slot_t));
+}
+
 xhash_t* xhash_init(xhash_idfunc_t idfunc,
 		    xhash_freefunc_t freefunc,
 		    xhash_hashfunc_t hashfunc,
@@ -88,9 +191,30 @@ xhash_t* xhash_init(xhash_idfunc_t idfunc,
 	table->count = 0;
 	table->identify = idfunc;
 	table->freefunc = freefunc;
+	if (table_size) {
+		/* Known expected size: use the open addressing backend,
+		 * reserved so no rehash occurs below table_size items */
+		uint32_t slot_cnt = 16;
+		while ((slot_cnt - (slot_cnt / 4)) < table_size)
+			slot_cnt *= 2;
+		_oa_grow(table, slot_cnt);
+	}
 	return table;
 }
 
+void xhash_reserve(xhash_t* table, uint32_t item_count)
+{
+	uint32_t slot_cnt;
+
+	if (!table || !table->slot_cnt)
+		return;
+	slot_cnt = table->slot_cnt;
+	while ((slot_cnt - (slot_cnt / 4)) < item_count)
+		slot_cnt *= 2;
+	if (slot_cnt > table->slot_cnt)
+		_oa_grow(table, slot_cnt);
+}
+
 static xhash_item_t* xhash_find(xhash_t* table, const char* key)
 {
 	xhash_item_t* hash_item = NULL;
@@ -105,7 +229,17 @@ static xhash_item_t* xhash_find(xhash_t* table, const char* key)
 
 void* xhash_get(xhash_t* table, const char* key)
 {
-	xhash_item_t* item = xhash_find(table, key);
+	xhash_item_t* item;
+
+	if (!table || !key)
+		return NULL;
+	if (table->slot_cnt) {
+		xhash_oa_slot_t* slot = _oa_find(table, key);
+		if (!slot)
+			return NULL;
+		return slot->item;
+	}
+	item = xhash_find(table, key);
 	if (!item)
 		return NULL;
 	return item->item;
@@ -116,6 +250,15 @@ void* xhash_add(xhash_t* table, void* item)
 	xhash_item_t* hash_item = NULL;
 	if (!table || !item)
 		return NULL;
+	if (table->slot_cnt) {
+		const char* key = table->identify(item);
+		if ((table->count + 1) > table->grow_at)
+			_oa_grow(table, table->slot_cnt * 2);
+		_oa_insert(table->slots, table->slot_cnt, item, key,
+			   siphash_str(key));
+		++table->count;
+		return item;
+	}
 	hash_item          = (xhash_item_t*)xmalloc(sizeof(xhash_item_t));
 	hash_item->item    = item;
 	hash_item->key     = table->identify(item);
@@ -129,7 +272,20 @@ void* xhash_add(xhash_t* table, void* item)
 void* xhash_pop(xhash_t* table, const char* key)
 {
 	void* item_item;
-	xhash_item_t* item = xhash_find(table, key);
+	xhash_item_t* item;
+
+	if (!table || !key)
+		return NULL;
+	if (table->slot_cnt) {
+		xhash_oa_slot_t* slot = _oa_find(table, key);
+		if (!slot)
+			return NULL;
+		item_item = slot->item;
+		_oa_remove(table, slot);
+		--table->count;
+		return item_item;
+	}
+	item = xhash_find(table, key);
 	if (!item)
 		return NULL;
 	item_item = item->item;
@@ -161,8 +317,16 @@ void xhash_walk(xhash_t* table,
 {
 	xhash_item_t* current_item = NULL;
 	xhash_item_t* tmp = NULL;
+	uint32_t inx;
 	if (!table || !callback)
 		return;
+	if (table->slot_cnt) {
+		for (inx = 0; inx < table->slot_cnt; inx++) {
+			if (table->slots[inx].dib)
+				callback(table->slots[inx].item, arg);
+		}
+		return;
+	}
 	HASH_ITER(hh, table->ht, current_item, tmp) {
 		  callback(current_item->item, arg);
 	}
@@ -172,9 +336,22 @@ void xhash_clear(xhash_t* table)
 {
 	xhash_item_t* current_item = NULL;
 	xhash_item_t* tmp = NULL;
+	uint32_t inx;
 
 	if (!table)
 		return;
+	if (table->slot_cnt) {
+		for (inx = 0; inx < table->slot_cnt; inx++) {
+			if (!table->slots[inx].dib)
+				continue;
+			if (table->freefunc)
+				table->freefunc(table->slots[inx].item);
+		}
+		memset(table->slots, 0,
+		       sizeof(xhash_oa_slot_t) * table->slot_cnt);
+		table->count = 0;
+		return;
+	}
 	HASH_ITER(hh, table->ht, current_item, tmp) {
 		  HASH_DEL(table->ht, current_item);
 		  if (table->freefunc)
@@ -190,6 +367,7 @@ void xhash_free_ptr(xhash_t** table)
 	if (!table || !*table)
 		return;
 	xhash_clear(*table);
+	xfree((*table)->slots);
 	xfree(*table);
 }
 
@@ -78,13 +78,23 @@ typedef void (*xhash_freefunc_t)(void* item);
  *               item.
  * @param freefunc is used to free data insterted to the xhash table, use NULL
  *		   to bypass it.
+ * @param table_size is the expected item count. When non-zero, an
+ *                   open-addressing (robin hood) backend with inline key
+ *                   storage is used instead of uthash chaining, reserved
+ *                   large enough that no rehash occurs below table_size
+ *                   items. Zero selects the uthash backend.
  *
  * @returns the newly allocated hash table. Must be freed with xhash_free.
  */
 xhash_t* xhash_init(xhash_idfunc_t idfunc,
 		    xhash_freefunc_t freefunc,
 		    xhash_hashfunc_t hashfunc, /* Currently: should be NULL */
-		    uint32_t table_size);      /* Currently: unused         */
+		    uint32_t table_size);
+
+/** Grow an open-addressing hash table as needed to hold item_count items
+ * without further rehashing. No-op for uthash backed tables.
+ */
+void xhash_reserve(xhash_t* table, uint32_t item_count);
 
 /** @returns an item from a key searching through the hash table. NULL if not
  * found.
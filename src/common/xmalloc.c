@@ -42,6 +42,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -63,6 +64,159 @@ static void malloc_assert_failed(char *, const char *, int,
           } while (0)
 #endif /* NDEBUG */
 
+/*
+ * Optional per call site allocation accounting, enabled by setting
+ * SLURM_XMALLOC_PROFILE in the environment before the daemon starts.
+ * When enabled every allocation carries a pointer to its call site
+ * record (the header grows from two to four words so the returned
+ * pointer keeps its 16 byte alignment) and each site accumulates live
+ * bytes plus allocation/free counts.  xmalloc_profile_report() logs
+ * the sites holding the most live memory.  The mode is latched on the
+ * first allocation so the header layout never changes within a
+ * process; with the mode off the only cost is one integer test.
+ */
+typedef struct xmalloc_site {
+	const char *file;
+	int line;
+	uint64_t alloc_cnt;
+	uint64_t free_cnt;
+	uint64_t live_bytes;
+	struct xmalloc_site *next;
+} xmalloc_site_t;
+
+#define SITE_TABLE_SIZE 1024
+
+static xmalloc_site_t *site_table[SITE_TABLE_SIZE];
+static pthread_mutex_t site_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int profile_hdr_words = 0;	/* 0 until latched, then 2 or 4 */
+
+static int _hdr_words(void)
+{
+	if (!profile_hdr_words)
+		profile_hdr_words = getenv("SLURM_XMALLOC_PROFILE") ? 4 : 2;
+	return profile_hdr_words;
+}
+
+/* Record an allocation of size bytes and return the site record to be
+ * stored in the allocation header.  The table entries are plain
+ * calloc()'d so the accounting never accounts for itself. */
+static xmalloc_site_t *_site_account_alloc(const char *file, int line,
+					   size_t size)
+{
+	unsigned int hval = line;
+	const char *c;
+	xmalloc_site_t *s;
+
+	for (c = file; c && *c; c++)
+		hval = (hval * 33) + *c;
+	hval %= SITE_TABLE_SIZE;
+
+	pthread_mutex_lock(&site_mutex);
+	for (s = site_table[hval]; s; s = s->next) {
+		if ((s->line == line) && !strcmp(s->file, file))
+			break;
+	}
+	if (!s) {
+		if (!(s = calloc(1, sizeof(xmalloc_site_t)))) {
+			pthread_mutex_unlock(&site_mutex);
+			return NULL;
+		}
+		s->file = file;
+		s->line = line;
+		s->next = site_table[hval];
+		site_table[hval] = s;
+	}
+	s->alloc_cnt++;
+	s->live_bytes += size;
+	pthread_mutex_unlock(&site_mutex);
+
+	return s;
+}
+
+static void _site_account_free(xmalloc_site_t *s, size_t size)
+{
+	pthread_mutex_lock(&site_mutex);
+	s->free_cnt++;
+	s->live_bytes -= size;
+	pthread_mutex_unlock(&site_mutex);
+}
+
+static void _site_account_resize(xmalloc_site_t *s, size_t old_size,
+				 size_t new_size)
+{
+	pthread_mutex_lock(&site_mutex);
+	s->live_bytes += new_size - old_size;
+	pthread_mutex_unlock(&site_mutex);
+}
+
+extern bool xmalloc_profile_enabled(void)
+{
+	return (_hdr_words() == 4);
+}
+
+static int _site_live_cmp(const void *x, const void *y)
+{
+	const xmalloc_site_t *a = x, *b = y;
+
+	if (a->live_bytes > b->live_bytes)
+		return -1;
+	if (a->live_bytes < b->live_bytes)
+		return 1;
+	return 0;
+}
+
+/*
+ * Log the top_n call sites holding the most live memory (top_n <= 0
+ * selects a default of 20).  No-op unless SLURM_XMALLOC_PROFILE was
+ * set when the process started.  The table is snapshotted before
+ * logging since the log functions allocate through xmalloc themselves.
+ */
+extern void xmalloc_profile_report(int top_n)
+{
+	xmalloc_site_t *snap = NULL, *s;
+	uint64_t total_bytes = 0;
+	int site_cnt = 0, i, j;
+
+	if (!xmalloc_profile_enabled())
+		return;
+	if (top_n <= 0)
+		top_n = 20;
+
+	pthread_mutex_lock(&site_mutex);
+	for (i = 0; i < SITE_TABLE_SIZE; i++) {
+		for (s = site_table[i]; s; s = s->next)
+			site_cnt++;
+	}
+	if (site_cnt)
+		snap = calloc(site_cnt, sizeof(xmalloc_site_t));
+	if (snap) {
+		for (i = 0, j = 0; i < SITE_TABLE_SIZE; i++) {
+			for (s = site_table[i]; s; s = s->next) {
+				snap[j++] = *s;
+				total_bytes += s->live_bytes;
+			}
+		}
+	}
+	pthread_mutex_unlock(&site_mutex);
+
+	if (!snap)
+		return;
+
+	qsort(snap, site_cnt, sizeof(xmalloc_site_t), _site_live_cmp);
+	info("xmalloc: %"PRIu64" bytes live across %d call sites",
+	     total_bytes, site_cnt);
+	top_n = MIN(top_n, site_cnt);
+	for (j = 0; j < top_n; j++) {
+		if (!snap[j].live_bytes)
+			break;
+		info("xmalloc: %3d. %s:%d %"PRIu64" bytes live "
+		     "(%"PRIu64" allocs, %"PRIu64" frees)",
+		     j + 1, snap[j].file, snap[j].line, snap[j].live_bytes,
+		     snap[j].alloc_cnt, snap[j].free_cnt);
+	}
+	free(snap);
+}
+
 
 /*
  * "Safe" version of malloc().
@@ -75,7 +229,8 @@ void *slurm_xmalloc(size_t size, bool clear,
 {
 	void *new;
 	size_t *p;
-	size_t total_size = size + 2 * sizeof(size_t);
+	int hdr = _hdr_words();
+	size_t total_size = size + hdr * sizeof(size_t);
 
 	if (clear)
 		p = calloc(1, total_size);
@@ -88,8 +243,12 @@ void *slurm_xmalloc(size_t size, bool clear,
 	}
 	p[0] = XMALLOC_MAGIC;	/* add "secret" magic cookie */
 	p[1] = size;		/* store size in buffer */
+	if (hdr > 2) {
+		p[2] = (size_t) _site_account_alloc(file, line, size);
+		p[3] = 0;
+	}
 
-	new = &p[2];
+	new = &p[hdr];
 	return new;
 }
 
@@ -101,7 +260,8 @@ void *slurm_try_xmalloc(size_t size, const char *file, int line,
 {
 	void *new;
 	size_t *p;
-	size_t total_size = size + 2 * sizeof(size_t);
+	int hdr = _hdr_words();
+	size_t total_size = size + hdr * sizeof(size_t);
 
 	p = calloc(1, total_size);
 	if (!p) {
@@ -109,8 +269,12 @@ void *slurm_try_xmalloc(size_t size, const char *file, int line,
 	}
 	p[0] = XMALLOC_MAGIC;	/* add "secret" magic cookie */
 	p[1] = size;		/* store size in buffer */
+	if (hdr > 2) {
+		p[2] = (size_t) _site_account_alloc(file, line, size);
+		p[3] = 0;
+	}
 
-	new = &p[2];
+	new = &p[hdr];
 	return new;
 }
 
@@ -125,28 +289,32 @@ extern void * slurm_xrealloc(void **item, size_t newsize, bool clear,
 			     const char *file, int line, const char *func)
 {
 	size_t *p = NULL;
+	int hdr = _hdr_words();
 
 	if (*item != NULL) {
 		size_t old_size;
-		p = (size_t *)*item - 2;
+		p = (size_t *)*item - hdr;
 
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 		old_size = p[1];
 
-		p = realloc(p, newsize + 2*sizeof(size_t));
+		p = realloc(p, newsize + hdr*sizeof(size_t));
 		if (p == NULL)
 			goto error;
 
 		if (old_size < newsize) {
-			char *p_new = (char *)(&p[2]) + old_size;
+			char *p_new = (char *)(&p[hdr]) + old_size;
 			if (clear)
 				memset(p_new, 0, (newsize-old_size));
 		}
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
+		if ((hdr > 2) && p[2])
+			_site_account_resize((xmalloc_site_t *) p[2],
+					     old_size, newsize);
 
 	} else {
-		size_t total_size = newsize + 2 * sizeof(size_t);
+		size_t total_size = newsize + hdr * sizeof(size_t);
 		/* Initalize new memory */
 		if (clear)
 			p = calloc(1, total_size);
@@ -155,10 +323,15 @@ extern void * slurm_xrealloc(void **item, size_t newsize, bool clear,
 		if (p == NULL)
 			goto error;
 		p[0] = XMALLOC_MAGIC;
+		if (hdr > 2) {
+			p[2] = (size_t) _site_account_alloc(file, line,
+							    newsize);
+			p[3] = 0;
+		}
 	}
 
 	p[1] = newsize;
-	*item = &p[2];
+	*item = &p[hdr];
 	return *item;
 
   error:
@@ -174,36 +347,45 @@ int slurm_try_xrealloc(void **item, size_t newsize,
 	               const char *file, int line, const char *func)
 {
 	size_t *p = NULL;
+	int hdr = _hdr_words();
 
 	if (*item != NULL) {
 		size_t old_size;
-		p = (size_t *)*item - 2;
+		p = (size_t *)*item - hdr;
 
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 		old_size = p[1];
 
-		p = realloc(p, newsize + 2*sizeof(size_t));
+		p = realloc(p, newsize + hdr*sizeof(size_t));
 		if (p == NULL)
 			return 0;
 
 		if (old_size < newsize) {
-			char *p_new = (char *)(&p[2]) + old_size;
+			char *p_new = (char *)(&p[hdr]) + old_size;
 			memset(p_new, 0, (newsize-old_size));
 		}
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
+		if ((hdr > 2) && p[2])
+			_site_account_resize((xmalloc_site_t *) p[2],
+					     old_size, newsize);
 
 	} else {
-		size_t total_size = newsize + 2 * sizeof(size_t);
+		size_t total_size = newsize + hdr * sizeof(size_t);
 		/* Initalize new memory */
 		p = calloc(1, total_size);
 		if (p == NULL)
 			return 0;
 		p[0] = XMALLOC_MAGIC;
+		if (hdr > 2) {
+			p[2] = (size_t) _site_account_alloc(file, line,
+							    newsize);
+			p[3] = 0;
+		}
 	}
 
 	p[1] = newsize;
-	*item = &p[2];
+	*item = &p[hdr];
 	return 1;
 }
 
@@ -214,7 +396,7 @@ int slurm_try_xrealloc(void **item, size_t newsize,
  */
 size_t slurm_xsize(void *item, const char *file, int line, const char *func)
 {
-	size_t *p = (size_t *)item - 2;
+	size_t *p = (size_t *)item - _hdr_words();
 	xmalloc_assert(item != NULL);
 	xmalloc_assert(p[0] == XMALLOC_MAGIC); /* CLANG false positive here */
 	return p[1];
@@ -228,15 +410,112 @@ size_t slurm_xsize(void *item, const char *file, int line, const char *func)
 void slurm_xfree(void **item, const char *file, int line, const char *func)
 {
 	if (*item != NULL) {
-		size_t *p = (size_t *)*item - 2;
+		int hdr = _hdr_words();
+		size_t *p = (size_t *)*item - hdr;
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
+		if ((hdr > 2) && p[2])
+			_site_account_free((xmalloc_site_t *) p[2], p[1]);
 		p[0] = 0;	/* make sure xfree isn't called twice */
 		free(p);
 		*item = NULL;
 	}
 }
 
+#define XARENA_CHUNK_SIZE	(16 * 1024)
+#define XARENA_ALIGN		sizeof(size_t)
+
+typedef struct xarena_chunk {
+	struct xarena_chunk *next;
+	size_t used;		/* bytes consumed in this chunk */
+	size_t size;		/* usable bytes in this chunk */
+	/* chunk data follows the header */
+} xarena_chunk_t;
+
+struct xarena {
+	xarena_chunk_t *chunks;	/* current chunk at the head */
+	size_t chunk_size;	/* usable size of a regular chunk */
+};
+
+static xarena_chunk_t *_xarena_chunk_alloc(xarena_t *arena, size_t size)
+{
+	xarena_chunk_t *chunk;
+
+	chunk = xmalloc_nz(sizeof(xarena_chunk_t) + size);
+	chunk->next = arena->chunks;
+	chunk->used = 0;
+	chunk->size = size;
+	arena->chunks = chunk;
+	return chunk;
+}
+
+extern xarena_t *xarena_create(size_t chunk_size)
+{
+	xarena_t *arena;
+
+	arena = xmalloc(sizeof(xarena_t));
+	arena->chunk_size = chunk_size ? chunk_size : XARENA_CHUNK_SIZE;
+	return arena;
+}
+
+extern void *xarena_alloc(xarena_t *arena, size_t size)
+{
+	xarena_chunk_t *chunk = arena->chunks;
+	char *ptr;
+
+	size = (size + XARENA_ALIGN - 1) & ~(XARENA_ALIGN - 1);
+	if (size > arena->chunk_size) {
+		/* Oversized request gets a dedicated chunk, inserted behind
+		 * the current chunk so its free tail remains usable */
+		xarena_chunk_t *big = xmalloc_nz(sizeof(xarena_chunk_t) +
+						 size);
+		big->used = size;
+		big->size = size;
+		if (chunk) {
+			big->next = chunk->next;
+			chunk->next = big;
+		} else {
+			big->next = NULL;
+			arena->chunks = big;
+		}
+		memset(big + 1, 0, size);
+		return big + 1;
+	}
+	if (!chunk || ((chunk->size - chunk->used) < size))
+		chunk = _xarena_chunk_alloc(arena, arena->chunk_size);
+
+	ptr = ((char *) (chunk + 1)) + chunk->used;
+	chunk->used += size;
+	memset(ptr, 0, size);
+	return ptr;
+}
+
+extern char *xarena_strdup(xarena_t *arena, const char *str)
+{
+	size_t len;
+	char *copy;
+
+	if (!str)
+		return NULL;
+	len = strlen(str) + 1;
+	copy = xarena_alloc(arena, len);
+	memcpy(copy, str, len);
+	return copy;
+}
+
+extern void xarena_destroy(xarena_t *arena)
+{
+	xarena_chunk_t *chunk, *next;
+
+	if (!arena)
+		return;
+	for (chunk = arena->chunks; chunk; chunk = next) {
+		next = chunk->next;
+		xfree(chunk);
+	}
+	xfree(arena);
+}
+
 #ifndef NDEBUG
 static void malloc_assert_failed(char *expr, const char *file,
 		                 int line, const char *caller, const char *func)
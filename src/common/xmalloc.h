@@ -114,6 +114,32 @@ void *slurm_xrealloc(void **, size_t, bool, const char *, int, const char *);
 int  slurm_try_xrealloc(void **, size_t, const char *, int, const char *);
 size_t slurm_xsize(void *, const char *, int, const char *);
 
+/*
+ * Per call site allocation accounting, enabled by setting the
+ * SLURM_XMALLOC_PROFILE environment variable before the process
+ * starts.  While enabled each allocation is charged to its file:line
+ * call site; xmalloc_profile_report() logs the top_n sites by live
+ * bytes (top_n <= 0 for the default of 20) to help attribute daemon
+ * memory growth.  Both are cheap no-ops when the mode is off.
+ */
+bool xmalloc_profile_enabled(void);
+void xmalloc_profile_report(int top_n);
+
+/*
+ * Arena allocator for groups of transient allocations sharing one
+ * lifetime (e.g. the records built for one scheduling pass). Individual
+ * allocations are pointer bumps into larger chunks and can not be freed
+ * separately (never xfree() them); everything is released at once by
+ * xarena_destroy(). An arena is not thread safe, it is meant to be
+ * owned by a single request or pass.
+ */
+typedef struct xarena xarena_t;
+
+xarena_t *xarena_create(size_t chunk_size);	/* 0 for default size */
+void *xarena_alloc(xarena_t *arena, size_t size);
+char *xarena_strdup(xarena_t *arena, const char *str);
+void xarena_destroy(xarena_t *arena);
+
 #define XMALLOC_MAGIC 0x42
 
 #endif /* !_XMALLOC_H */
@@ -89,6 +89,13 @@ strong_alias(xstrtolower,       slurm_xstrtolower);
 strong_alias(xstrchr,           slurm_xstrchr);
 strong_alias(xstrcmp,           slurm_xstrcmp);
 strong_alias(xstrcasecmp,       slurm_xstrcasecmp);
+strong_alias(xstrbuf_init,      slurm_xstrbuf_init);
+strong_alias(xstrbuf_cat,       slurm_xstrbuf_cat);
+strong_alias(xstrbuf_ncat,      slurm_xstrbuf_ncat);
+strong_alias(xstrbuf_catchar,   slurm_xstrbuf_catchar);
+strong_alias(xstrbuf_fmtcat,    slurm_xstrbuf_fmtcat);
+strong_alias(xstrbuf_release,   slurm_xstrbuf_release);
+strong_alias(xstrbuf_free,      slurm_xstrbuf_free);
 
 /*
  * Ensure that a string has enough space to add 'needed' characters.
@@ -591,6 +598,123 @@ int xstrcasecmp(const char *s1, const char *s2)
 		return strcasecmp(s1, s2);
 }
 
+/*
+ * Ensure the builder can hold needed more characters plus the NUL,
+ * growing the buffer geometrically.
+ */
+static void _xstrbuf_makespace(xstrbuf_t *sb, size_t needed)
+{
+	size_t min_size = sb->len + needed + 1;
+	size_t new_size;
+
+	if (min_size <= sb->size)
+		return;
+
+	new_size = MAX(sb->size * 2, (size_t) XFGETS_CHUNKSIZE);
+	if (new_size < min_size)
+		new_size = min_size;
+	if (sb->buf)
+		xrealloc(sb->buf, new_size);
+	else
+		sb->buf = xmalloc(new_size);
+	sb->size = new_size;
+}
+
+/*
+ * Initialize a builder, pre-allocating hint bytes (0 for default)
+ */
+void xstrbuf_init(xstrbuf_t *sb, size_t hint)
+{
+	memset(sb, 0, sizeof(xstrbuf_t));
+	if (hint)
+		_xstrbuf_makespace(sb, hint);
+}
+
+/*
+ * Append string (NULL appends "(null)" like xstrcat)
+ */
+void xstrbuf_cat(xstrbuf_t *sb, const char *str)
+{
+	if (str == NULL)
+		str = "(null)";
+	xstrbuf_ncat(sb, str, strlen(str));
+}
+
+/*
+ * Append at most len characters of str
+ */
+void xstrbuf_ncat(xstrbuf_t *sb, const char *str, size_t len)
+{
+	if (str == NULL)
+		str = "(null)";
+	len = strnlen(str, len);
+	_xstrbuf_makespace(sb, len);
+	memcpy(sb->buf + sb->len, str, len);
+	sb->len += len;
+	sb->buf[sb->len] = '\0';
+}
+
+/*
+ * Append a single character
+ */
+void xstrbuf_catchar(xstrbuf_t *sb, char c)
+{
+	_xstrbuf_makespace(sb, 1);
+	sb->buf[sb->len++] = c;
+	sb->buf[sb->len] = '\0';
+}
+
+/*
+ * Append printf-style formatted output,
+ * return value is result from vsnprintf(3)
+ */
+int xstrbuf_fmtcat(xstrbuf_t *sb, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	size_t avail;
+
+	/* Try to print into the remaining space, grow and retry when
+	 * vsnprintf reports truncation. */
+	_xstrbuf_makespace(sb, 1);
+	while (1) {
+		avail = sb->size - sb->len;
+		va_start(ap, fmt);
+		n = vsnprintf(sb->buf + sb->len, avail, fmt, ap);
+		va_end(ap);
+		if (n < 0) {
+			sb->buf[sb->len] = '\0';
+			return n;
+		}
+		if ((size_t) n < avail)
+			break;
+		_xstrbuf_makespace(sb, n);
+	}
+	sb->len += n;
+	return n;
+}
+
+/*
+ * Hand the accumulated string to the caller (NULL if nothing was
+ * appended) and reset the builder. The caller must xfree the result.
+ */
+char *xstrbuf_release(xstrbuf_t *sb)
+{
+	char *str = sb->buf;
+
+	memset(sb, 0, sizeof(xstrbuf_t));
+	return str;
+}
+
+/*
+ * Discard the accumulated string and reset the builder
+ */
+void xstrbuf_free(xstrbuf_t *sb)
+{
+	xfree(sb->buf);
+	memset(sb, 0, sizeof(xstrbuf_t));
+}
+
 /*
  * Give me a copy of the string as if it were printf.
  * This is stdarg-compatible routine, so vararg-compatible
@@ -199,4 +199,49 @@ int xstrncmp(const char *s1, const char *s2, size_t n);
  */
 int xstrcasecmp(const char *s1, const char *s2);
 
+/*
+ * Length-tracked string builder. The xstrcat()/xstrfmtcat() family
+ * calls strlen() on the destination for every append, which makes
+ * long concatenation chains (e.g. database statement construction)
+ * O(n^2). The builder tracks the current length and grows the buffer
+ * geometrically, so a chain of appends is O(n). Use xstrbuf_release()
+ * to take ownership of the accumulated string (xfree it when done),
+ * or xstrbuf_free() to discard it.
+ */
+typedef struct {
+	char *buf;	/* NUL terminated string, NULL while empty */
+	size_t len;	/* current length, not counting the NUL */
+	size_t size;	/* allocated size of buf */
+} xstrbuf_t;
+
+#define XSTRBUF_INITIALIZER { NULL, 0, 0 }
+
+/* Initialize a builder, pre-allocating hint bytes (0 for default) */
+void xstrbuf_init(xstrbuf_t *sb, size_t hint);
+
+/* Append string (NULL appends "(null)" like xstrcat) */
+void xstrbuf_cat(xstrbuf_t *sb, const char *str);
+
+/* Append at most len characters of str */
+void xstrbuf_ncat(xstrbuf_t *sb, const char *str, size_t len);
+
+/* Append a single character */
+void xstrbuf_catchar(xstrbuf_t *sb, char c);
+
+/*
+ * Append printf-style formatted output,
+ * return value is result from vsnprintf(3)
+ */
+int xstrbuf_fmtcat(xstrbuf_t *sb, const char *fmt, ...)
+  __attribute__ ((format (printf, 2, 3)));
+
+/*
+ * Hand the accumulated string to the caller (NULL if nothing was
+ * appended) and reset the builder. The caller must xfree the result.
+ */
+char *xstrbuf_release(xstrbuf_t *sb);
+
+/* Discard the accumulated string and reset the builder */
+void xstrbuf_free(xstrbuf_t *sb);
+
 #endif /* !_XSTRING_H */
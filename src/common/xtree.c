@@ -578,3 +578,41 @@ xtree_node_t** xtree_get_leaves(xtree_t* tree,
 	return st.list;
 }
 
+
+xtree_node_t** xtree_get_bfs_nodes(xtree_t* tree,
+		xtree_node_t* node,
+		uint32_t* size)
+{
+	xtree_node_t** bfs_list = NULL;
+	xtree_node_t*  child    = NULL;
+	uint32_t       head     = 0;
+	uint32_t       tail     = 0;
+
+	if (!tree || !tree->root || !size)
+		return NULL;
+	if (!node)
+		node = tree->root;
+
+	/* tree->count bounds the number of reachable nodes whatever the
+	 * starting point, so the list can be allocated up front and used
+	 * as the traversal queue itself, leaving the nodes stored in
+	 * breadth-first order without any auxiliary memory. */
+	bfs_list = (xtree_node_t**)xmalloc(
+			sizeof(xtree_node_t*)*(tree->count + 1));
+	bfs_list[tail++] = node;
+	while (head < tail) {
+		child = bfs_list[head++]->start;
+		while (child) {
+			bfs_list[tail++] = child;
+			child = child->next;
+		}
+	}
+	if (tail != tree->count) {
+		bfs_list = (xtree_node_t**)xrealloc(bfs_list,
+				sizeof(xtree_node_t*)*(tail + 1));
+	}
+	/* safety measure, can be used as strlen if users assumes it */
+	bfs_list[tail] = NULL;
+	*size = tail;
+	return bfs_list;
+}
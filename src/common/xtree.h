@@ -320,5 +320,24 @@ xtree_node_t** xtree_get_leaves(xtree_t* tree,
 				xtree_node_t* node,
 				uint32_t* size);
 
+/** Get the nodes reachable from `node` stored contiguously in breadth-first
+ * (level) order, `node` itself being the first element. The children of any
+ * listed node occupy a contiguous run of the returned array, so iterating
+ * over a level or a sibling set touches adjacent memory instead of chasing
+ * the start/next pointers of individually allocated tree nodes.
+ * User is responsible for `xfree`'ing the returned list.
+ *
+ * @param tree the managed tree.
+ * @param node the node to start from or NULL for the root node.
+ * @param size will be modified according to the number of nodes in the
+ *             returned list if the return value is not null.
+ * @returns the `xmalloc`ed breadth-first ordered node array or NULL if bogus
+ *          tree or bad parameters. Although size contains the array number
+ *          of elements, the array is null terminated.
+ */
+xtree_node_t** xtree_get_bfs_nodes(xtree_t* tree,
+				   xtree_node_t* node,
+				   uint32_t* size);
+
 #endif
 
@@ -50,6 +50,14 @@
 
 static char *table_defs_table = "table_defs_table";
 
+/* Most prepared statements kept per connection */
+#define MAX_STMT_CACHE_SIZE 32
+
+typedef struct {
+	char *query;
+	MYSQL_STMT *stmt;
+} prep_stmt_t;
+
 typedef struct {
 	char *name;
 	char *columns;
@@ -613,6 +621,8 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn) {
 		mysql_db_close_db_connection(mysql_conn);
+		FREE_NULL_LIST(mysql_conn->stmt_cache);
+		xfree(mysql_conn->batch_query);
 		xfree(mysql_conn->pre_commit_query);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
@@ -746,6 +756,8 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 {
 	slurm_mutex_lock(&mysql_conn->lock);
 	if (mysql_conn && mysql_conn->db_conn) {
+		/* cached prepared statements die with the session */
+		FREE_NULL_LIST(mysql_conn->stmt_cache);
 		if (mysql_thread_safe())
 			mysql_thread_end();
 		mysql_close(mysql_conn->db_conn);
@@ -768,6 +780,151 @@ extern int mysql_db_cleanup()
 	return SLURM_SUCCESS;
 }
 
+static void _destroy_prep_stmt(void *object)
+{
+	prep_stmt_t *prep = (prep_stmt_t *) object;
+
+	if (prep) {
+		mysql_stmt_close(prep->stmt);
+		xfree(prep->query);
+		xfree(prep);
+	}
+}
+
+/* Find (or prepare) a statement in the connection's cache.  The most
+ * recently used entries are kept at the back of the list and the cache
+ * never grows past MAX_STMT_CACHE_SIZE statements.
+ * NOTE: mysql_conn->lock must be locked before calling this. */
+static MYSQL_STMT *_get_cached_stmt(mysql_conn_t *mysql_conn, char *query)
+{
+	ListIterator itr;
+	prep_stmt_t *prep;
+	MYSQL_STMT *stmt = NULL;
+
+	if (!mysql_conn->stmt_cache)
+		mysql_conn->stmt_cache = list_create(_destroy_prep_stmt);
+
+	itr = list_iterator_create(mysql_conn->stmt_cache);
+	while ((prep = list_next(itr))) {
+		if (!xstrcmp(prep->query, query)) {
+			list_remove(itr);
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	if (prep) {
+		list_append(mysql_conn->stmt_cache, prep);
+		return prep->stmt;
+	}
+
+	if (!(stmt = mysql_stmt_init(mysql_conn->db_conn))) {
+		error("mysql_stmt_init failed: %s",
+		      mysql_error(mysql_conn->db_conn));
+		return NULL;
+	}
+	if (mysql_stmt_prepare(stmt, query, strlen(query))) {
+		error("mysql_stmt_prepare failed: %s",
+		      mysql_stmt_error(stmt));
+		mysql_stmt_close(stmt);
+		return NULL;
+	}
+
+	while (list_count(mysql_conn->stmt_cache) >= MAX_STMT_CACHE_SIZE) {
+		/* drop the least recently used statement */
+		prep = list_pop(mysql_conn->stmt_cache);
+		_destroy_prep_stmt(prep);
+	}
+
+	prep = xmalloc(sizeof(prep_stmt_t));
+	prep->query = xstrdup(query);
+	prep->stmt = stmt;
+	list_append(mysql_conn->stmt_cache, prep);
+
+	return stmt;
+}
+
+/* NOTE: mysql_conn->lock must be locked before calling this */
+static void _drop_cached_stmt(mysql_conn_t *mysql_conn, char *query)
+{
+	ListIterator itr;
+	prep_stmt_t *prep;
+
+	if (!mysql_conn->stmt_cache)
+		return;
+
+	itr = list_iterator_create(mysql_conn->stmt_cache);
+	while ((prep = list_next(itr))) {
+		if (!xstrcmp(prep->query, query)) {
+			list_delete_item(itr);
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+}
+
+/* Run a query through a cached prepared statement, fetching at most
+ * one row.  Statements are prepared only on the first use of a query
+ * shape on the connection, repeated executions just bind new values,
+ * saving the server-side parse of the hot lookups.
+ * IN params - bind values for the statement's '?' markers, may be NULL
+ * IN result - bind description of the selected columns, may be NULL
+ * OUT found - set true if a row was fetched
+ * RET SLURM_SUCCESS or SLURM_ERROR */
+extern int mysql_db_prepared_query_row(mysql_conn_t *mysql_conn, char *query,
+				       MYSQL_BIND *params, MYSQL_BIND *result,
+				       bool *found)
+{
+	MYSQL_STMT *stmt = NULL;
+	int fetch_rc, rc = SLURM_ERROR, attempt;
+
+	if (found)
+		*found = false;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+	slurm_mutex_lock(&mysql_conn->lock);
+	/* Retry once with a freshly prepared statement since a
+	 * reconnect invalidates every statement of the old session. */
+	for (attempt = 0; attempt < 2; attempt++) {
+		if (!(stmt = _get_cached_stmt(mysql_conn, query)))
+			break;
+		if ((params && mysql_stmt_bind_param(stmt, params)) ||
+		    mysql_stmt_execute(stmt)) {
+			error("mysql_stmt_execute failed: %s",
+			      mysql_stmt_error(stmt));
+			_drop_cached_stmt(mysql_conn, query);
+			continue;
+		}
+		rc = SLURM_SUCCESS;
+		if (result) {
+			if (mysql_stmt_bind_result(stmt, result)) {
+				error("mysql_stmt_bind_result failed: %s",
+				      mysql_stmt_error(stmt));
+				rc = SLURM_ERROR;
+			} else {
+				fetch_rc = mysql_stmt_fetch(stmt);
+				if ((fetch_rc == 0) ||
+				    (fetch_rc == MYSQL_DATA_TRUNCATED)) {
+					if (found)
+						*found = true;
+				} else if (fetch_rc != MYSQL_NO_DATA) {
+					error("mysql_stmt_fetch failed: %s",
+					      mysql_stmt_error(stmt));
+					rc = SLURM_ERROR;
+				}
+			}
+			mysql_stmt_free_result(stmt);
+		}
+		break;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
 extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 {
 	int rc = SLURM_SUCCESS;
@@ -969,3 +1126,90 @@ extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 		mysql_conn, table_name, first_field, ending);
 	return rc;
 }
+
+/* State of the extra connection pool */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static List pool_conn_list = NULL;	/* idle mysql_conn_t */
+static char *pool_db_name = NULL;
+static mysql_db_info_t *pool_db_info = NULL;
+static int pool_conn_total = 0;
+static int pool_conn_limit = 0;
+
+static void _pool_conn_del(void *object)
+{
+	mysql_conn_t *mysql_conn = (mysql_conn_t *) object;
+
+	destroy_mysql_conn(mysql_conn);
+}
+
+extern int mysql_db_pool_init(char *db_name, mysql_db_info_t *db_info,
+			      int conn_limit)
+{
+	slurm_mutex_lock(&pool_lock);
+	if (pool_db_info) {
+		slurm_mutex_unlock(&pool_lock);
+		return SLURM_SUCCESS;
+	}
+	pool_db_name = xstrdup(db_name);
+	pool_db_info = xmalloc(sizeof(mysql_db_info_t));
+	pool_db_info->port = db_info->port;
+	pool_db_info->backup = xstrdup(db_info->backup);
+	pool_db_info->host = xstrdup(db_info->host);
+	pool_db_info->user = xstrdup(db_info->user);
+	pool_db_info->pass = xstrdup(db_info->pass);
+	pool_conn_list = list_create(_pool_conn_del);
+	pool_conn_limit = conn_limit;
+	slurm_mutex_unlock(&pool_lock);
+	return SLURM_SUCCESS;
+}
+
+extern mysql_conn_t *mysql_db_pool_get(void)
+{
+	mysql_conn_t *mysql_conn = NULL;
+
+	slurm_mutex_lock(&pool_lock);
+	if (pool_conn_list)
+		mysql_conn = list_pop(pool_conn_list);
+	if (!mysql_conn && pool_db_info &&
+	    (pool_conn_total < pool_conn_limit)) {
+		mysql_conn = create_mysql_conn(-1, false, NULL);
+		if (mysql_db_get_db_connection(mysql_conn, pool_db_name,
+					       pool_db_info)
+		    != SLURM_SUCCESS) {
+			destroy_mysql_conn(mysql_conn);
+			mysql_conn = NULL;
+		} else
+			pool_conn_total++;
+	}
+	slurm_mutex_unlock(&pool_lock);
+	return mysql_conn;
+}
+
+extern void mysql_db_pool_put(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn)
+		return;
+
+	slurm_mutex_lock(&pool_lock);
+	if (pool_conn_list) {
+		list_push(pool_conn_list, mysql_conn);
+		mysql_conn = NULL;
+	}
+	slurm_mutex_unlock(&pool_lock);
+
+	/* pool was torn down while the connection was out */
+	if (mysql_conn)
+		destroy_mysql_conn(mysql_conn);
+}
+
+extern void mysql_db_pool_fini(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	FREE_NULL_LIST(pool_conn_list);
+	destroy_mysql_db_info(pool_db_info);
+	pool_db_info = NULL;
+	xfree(pool_db_name);
+	pool_conn_total = 0;
+	pool_conn_limit = 0;
+	slurm_mutex_unlock(&pool_lock);
+}
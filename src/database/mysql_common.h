@@ -59,12 +59,16 @@ typedef enum {
 } slurm_mysql_plugin_type_t;
 
 typedef struct {
+	char *batch_query;	/* pending batched job/step statements */
+	uint32_t batch_cnt;	/* number of statements in batch_query */
+	time_t batch_time;	/* when batch_query got its first entry */
 	bool cluster_deleted;
 	char *cluster_name;
 	MYSQL *db_conn;
 	pthread_mutex_t lock;
 	char *pre_commit_query;
 	bool rollback;
+	List stmt_cache;	/* most recently used prepared statements */
 	List update_list;
 	int conn;
 } mysql_conn_t;
@@ -93,6 +97,9 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn);
 extern int mysql_db_cleanup();
 extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query);
+extern int mysql_db_prepared_query_row(mysql_conn_t *mysql_conn, char *query,
+				       MYSQL_BIND *params, MYSQL_BIND *result,
+				       bool *found);
 extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_ping(mysql_conn_t *mysql_conn);
 extern int mysql_db_commit(mysql_conn_t *mysql_conn);
@@ -107,4 +114,23 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending);
 
+/*
+ * Pool of extra database connections used to run the independent
+ * queries of one logical request (e.g. the per cluster job fetches of
+ * a sacct request) concurrently, overlapping server latency instead of
+ * summing it.  Pooled connections are created on demand up to
+ * conn_limit and reused across requests.
+ */
+extern int mysql_db_pool_init(char *db_name, mysql_db_info_t *db_info,
+			      int conn_limit);
+
+/* get an idle pooled connection, or NULL if the pool is exhausted or
+ * not initialized (callers must then fall back to serial execution) */
+extern mysql_conn_t *mysql_db_pool_get(void);
+
+/* return a connection obtained from mysql_db_pool_get() to the pool */
+extern void mysql_db_pool_put(mysql_conn_t *mysql_conn);
+
+extern void mysql_db_pool_fini(void);
+
 #endif
@@ -831,6 +831,103 @@ static char *_make_archive_name(time_t period_start, time_t period_end,
 			      start_char, end_char);
 }
 
+static pthread_mutex_t local_file_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Handle for an archive file being written incrementally */
+typedef struct {
+	int fd;
+	char *reg_file;
+	char *old_file;
+	char *new_file;
+} archive_file_t;
+
+extern void *archive_file_open(char *cluster_name, time_t period_start,
+			       time_t period_end, char *arch_dir,
+			       char *arch_type, uint32_t archive_period)
+{
+	archive_file_t *arch_file = xmalloc(sizeof(archive_file_t));
+
+	slurm_mutex_lock(&local_file_lock);
+	arch_file->reg_file = _make_archive_name(period_start, period_end,
+						 cluster_name, arch_dir,
+						 arch_type, archive_period);
+
+	debug("Storing %s archive for %s at %s",
+	      arch_type, cluster_name, arch_file->reg_file);
+	arch_file->old_file = xstrdup_printf("%s.old", arch_file->reg_file);
+	arch_file->new_file = xstrdup_printf("%s.new", arch_file->reg_file);
+
+	arch_file->fd = creat(arch_file->new_file, 0600);
+	if (arch_file->fd < 0) {
+		error("Can't save archive, create file %s error %m",
+		      arch_file->new_file);
+		xfree(arch_file->reg_file);
+		xfree(arch_file->old_file);
+		xfree(arch_file->new_file);
+		xfree(arch_file);
+		slurm_mutex_unlock(&local_file_lock);
+		return NULL;
+	}
+	return arch_file;
+}
+
+extern int archive_file_write(void *arch, Buf buffer)
+{
+	archive_file_t *arch_file = (archive_file_t *) arch;
+	int pos = 0, nwrite, amount;
+	char *data;
+
+	xassert(arch_file);
+	xassert(buffer);
+
+	nwrite = get_buf_offset(buffer);
+	data = (char *)get_buf_data(buffer);
+	while (nwrite > 0) {
+		amount = write(arch_file->fd, &data[pos], nwrite);
+		if ((amount < 0) && (errno != EINTR)) {
+			error("Error writing file %s, %m",
+			      arch_file->new_file);
+			return SLURM_ERROR;
+		}
+		nwrite -= amount;
+		pos    += amount;
+	}
+	return SLURM_SUCCESS;
+}
+
+extern int archive_file_close(void *arch, int rc)
+{
+	archive_file_t *arch_file = (archive_file_t *) arch;
+
+	if (!arch_file)
+		return rc;
+
+	if (rc == SLURM_SUCCESS)
+		fsync(arch_file->fd);
+	close(arch_file->fd);
+
+	if (rc != SLURM_SUCCESS)
+		(void) unlink(arch_file->new_file);
+	else {			/* file shuffle */
+		(void) unlink(arch_file->old_file);
+		if (link(arch_file->reg_file, arch_file->old_file))
+			debug4("Link(%s, %s): %m", arch_file->reg_file,
+			       arch_file->old_file);
+		(void) unlink(arch_file->reg_file);
+		if (link(arch_file->new_file, arch_file->reg_file))
+			debug4("Link(%s, %s): %m", arch_file->new_file,
+			       arch_file->reg_file);
+		(void) unlink(arch_file->new_file);
+	}
+	xfree(arch_file->reg_file);
+	xfree(arch_file->old_file);
+	xfree(arch_file->new_file);
+	xfree(arch_file);
+	slurm_mutex_unlock(&local_file_lock);
+
+	return rc;
+}
+
 extern int archive_write_file(Buf buffer, char *cluster_name,
 			      time_t period_start, time_t period_end,
 			      char *arch_dir, char *arch_type,
@@ -840,7 +937,6 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 	int rc = SLURM_SUCCESS;
 	char *old_file = NULL, *new_file = NULL, *reg_file = NULL;
 	static int high_buffer_size = (1024 * 1024);
-	static pthread_mutex_t local_file_lock = PTHREAD_MUTEX_INITIALIZER;
 
 	xassert(buffer);
 
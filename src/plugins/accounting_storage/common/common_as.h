@@ -85,4 +85,17 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 			      char *arch_dir, char *arch_type,
 			      uint32_t archive_period);
 
+/*
+ * Incremental archive file writer, used to stream an archive to disk
+ * chunk by chunk instead of materializing it in one buffer.  The
+ * handle holds the archive file lock from open to close, close
+ * performs the usual .old/.new file shuffle (or removes the partial
+ * file when rc is an error) and returns rc.
+ */
+extern void *archive_file_open(char *cluster_name, time_t period_start,
+			       time_t period_end, char *arch_dir,
+			       char *arch_type, uint32_t archive_period);
+extern int archive_file_write(void *arch, Buf buffer);
+extern int archive_file_close(void *arch, int rc);
+
 #endif
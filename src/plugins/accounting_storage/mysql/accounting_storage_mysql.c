@@ -1094,6 +1094,8 @@ extern void reset_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn->rollback)
 		mysql_db_rollback(mysql_conn);
+	xfree(mysql_conn->batch_query);
+	mysql_conn->batch_cnt = 0;
 	xfree(mysql_conn->pre_commit_query);
 	list_flush(mysql_conn->update_list);
 }
@@ -2409,8 +2411,10 @@ extern int init ( void )
 		if (mysql_db_commit(mysql_conn)) {
 			error("commit failed, meaning %s failed", plugin_name);
 			rc = SLURM_ERROR;
-		} else
+		} else {
+			mysql_db_pool_init(mysql_db_name, mysql_db_info, 4);
 			verbose("%s loaded", plugin_name);
+		}
 	} else {
 		verbose("%s failed", plugin_name);
 		if (mysql_db_rollback(mysql_conn))
@@ -2429,6 +2433,7 @@ extern int fini ( void )
 	FREE_NULL_LIST(as_mysql_total_cluster_list);
 	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
 	slurm_mutex_destroy(&as_mysql_cluster_list_lock);
+	mysql_db_pool_fini();
 	destroy_mysql_db_info(mysql_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
@@ -2493,17 +2498,22 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 
 	if (mysql_conn->rollback) {
 		if (!commit) {
+			/* pending batched job/step records die with
+			 * the transaction */
+			xfree(mysql_conn->batch_query);
+			mysql_conn->batch_cnt = 0;
 			if (mysql_db_rollback(mysql_conn))
 				error("rollback failed");
 		} else {
-			int rc = SLURM_SUCCESS;
+			int rc = as_mysql_job_batch_flush(mysql_conn);
 			/* Handle anything here we were unable to do
 			   because of rollback issues.  i.e. Since any
 			   use of altering a tables
 			   AUTO_INCREMENT will make it so you can't
 			   rollback, save it until right at the end.
 			*/
-			if (mysql_conn->pre_commit_query) {
+			if ((rc == SLURM_SUCCESS) &&
+			    mysql_conn->pre_commit_query) {
 				if (debug_flags & DEBUG_FLAG_DB_ASSOC)
 					DB_DEBUG(mysql_conn->conn, "query\n%s",
 						 mysql_conn->pre_commit_query);
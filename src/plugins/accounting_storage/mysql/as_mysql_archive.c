@@ -47,6 +47,15 @@
 #include "src/common/slurm_time.h"
 #include "src/common/slurmdbd_defs.h"
 
+#if HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+/* Number of records packed into one compressed archive chunk.  Chunks
+ * are written to the archive file as rows are processed so archiving a
+ * large period never materializes the whole packed stream in memory. */
+#define ARCHIVE_CHUNK_RECS 10000
+
 #define SLURM_14_11_PROTOCOL_VERSION ((28 << 8) | 0) /* slurm version 14.11. */
 #define SLURM_14_03_PROTOCOL_VERSION ((27 << 8) | 0) /* slurm version
 						      * 14.03, not
@@ -1540,21 +1549,15 @@ static char *_get_archive_columns(purge_type_t type)
 }
 
 
-static Buf _pack_archive_events(MYSQL_RES *result, char *cluster_name,
-				uint32_t cnt, time_t *period_start)
+/* pack up to max_recs rows into buffer, returns number of rows packed */
+static uint32_t _pack_archive_events(MYSQL_RES *result, Buf buffer,
+				     uint32_t max_recs, time_t *period_start)
 {
 	MYSQL_ROW row;
-	Buf buffer;
+	uint32_t cnt = 0;
 	local_event_t event;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_EVENTS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
-	while ((row = mysql_fetch_row(result))) {
+	while ((cnt < max_recs) && (row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[EVENT_REQ_START]);
 
@@ -1570,9 +1573,10 @@ static Buf _pack_archive_events(MYSQL_RES *result, char *cluster_name,
 		event.tres_str = row[EVENT_REQ_TRES];
 
 		_pack_local_event(&event, SLURM_PROTOCOL_VERSION, buffer);
+		cnt++;
 	}
 
-	return buffer;
+	return cnt;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -1627,21 +1631,15 @@ _load_events(uint16_t rpc_version, Buf buffer, char *cluster_name,
 	return insert;
 }
 
-static Buf _pack_archive_jobs(MYSQL_RES *result, char *cluster_name,
-			      uint32_t cnt, time_t *period_start)
+/* pack up to max_recs rows into buffer, returns number of rows packed */
+static uint32_t _pack_archive_jobs(MYSQL_RES *result, Buf buffer,
+				   uint32_t max_recs, time_t *period_start)
 {
 	MYSQL_ROW row;
-	Buf buffer;
+	uint32_t cnt = 0;
 	local_job_t job;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_JOBS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
-	while ((row = mysql_fetch_row(result))) {
+	while ((cnt < max_recs) && (row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[JOB_REQ_SUBMIT]);
 
@@ -1685,9 +1683,10 @@ static Buf _pack_archive_jobs(MYSQL_RES *result, char *cluster_name,
 		job.wckey_id = row[JOB_REQ_WCKEYID];
 
 		_pack_local_job(&job, SLURM_PROTOCOL_VERSION, buffer);
+		cnt++;
 	}
 
-	return buffer;
+	return cnt;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -1782,21 +1781,15 @@ _init_local_job(local_job_t *job)
 	xstrcat(job->array_taskid, "4294967294");
 }
 
-static Buf _pack_archive_resvs(MYSQL_RES *result, char *cluster_name,
-			       uint32_t cnt, time_t *period_start)
+/* pack up to max_recs rows into buffer, returns number of rows packed */
+static uint32_t _pack_archive_resvs(MYSQL_RES *result, Buf buffer,
+				    uint32_t max_recs, time_t *period_start)
 {
 	MYSQL_ROW row;
-	Buf buffer;
+	uint32_t cnt = 0;
 	local_resv_t resv;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_RESVS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
-	while ((row = mysql_fetch_row(result))) {
+	while ((cnt < max_recs) && (row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[RESV_REQ_START]);
 
@@ -1813,9 +1806,10 @@ static Buf _pack_archive_resvs(MYSQL_RES *result, char *cluster_name,
 		resv.tres_str = row[RESV_REQ_TRES];
 
 		_pack_local_resv(&resv, SLURM_PROTOCOL_VERSION, buffer);
+		cnt++;
 	}
 
-	return buffer;
+	return cnt;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -1869,21 +1863,15 @@ static char *_load_resvs(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_steps(MYSQL_RES *result, char *cluster_name,
-			       uint32_t cnt, time_t *period_start)
+/* pack up to max_recs rows into buffer, returns number of rows packed */
+static uint32_t _pack_archive_steps(MYSQL_RES *result, Buf buffer,
+				    uint32_t max_recs, time_t *period_start)
 {
 	MYSQL_ROW row;
-	Buf buffer;
+	uint32_t cnt = 0;
 	local_step_t step;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_STEP_START, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
-	while ((row = mysql_fetch_row(result))) {
+	while ((cnt < max_recs) && (row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[STEP_REQ_START]);
 
@@ -1939,9 +1927,10 @@ static Buf _pack_archive_steps(MYSQL_RES *result, char *cluster_name,
 		step.user_usec = row[STEP_REQ_USER_USEC];
 
 		_pack_local_step(&step, SLURM_PROTOCOL_VERSION, buffer);
+		cnt++;
 	}
 
-	return buffer;
+	return cnt;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2034,21 +2023,16 @@ static char *_load_steps(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_suspends(MYSQL_RES *result, char *cluster_name,
-				  uint32_t cnt, time_t *period_start)
+/* pack up to max_recs rows into buffer, returns number of rows packed */
+static uint32_t _pack_archive_suspends(MYSQL_RES *result, Buf buffer,
+				       uint32_t max_recs,
+				       time_t *period_start)
 {
 	MYSQL_ROW row;
-	Buf buffer;
+	uint32_t cnt = 0;
 	local_suspend_t suspend;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_JOB_SUSPEND, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
-	while ((row = mysql_fetch_row(result))) {
+	while ((cnt < max_recs) && (row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[SUSPEND_REQ_START]);
 
@@ -2060,9 +2044,10 @@ static Buf _pack_archive_suspends(MYSQL_RES *result, char *cluster_name,
 		suspend.period_end = row[SUSPEND_REQ_END];
 
 		_pack_local_suspend(&suspend, SLURM_PROTOCOL_VERSION, buffer);
+		cnt++;
 	}
 
-	return buffer;
+	return cnt;
 }
 
 
@@ -2109,6 +2094,40 @@ static char *_load_suspend(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
+/* Frame one packed chunk for the archive file: record count, a
+ * compression flag, the unpacked size and the (possibly deflated)
+ * chunk data.  Returns a buffer to append to the archive file. */
+static Buf _make_archive_chunk(Buf data, uint32_t rec_cnt)
+{
+	Buf frame;
+	uint32_t usize = get_buf_offset(data);
+
+	frame = init_buf(MIN(usize + 64, high_buffer_size));
+	pack32(rec_cnt, frame);
+#if HAVE_LIBZ
+	{
+		uLongf zsize = compressBound(usize);
+		char *zbuf = xmalloc(zsize);
+
+		if (compress2((Bytef *) zbuf, &zsize,
+			      (Bytef *) get_buf_data(data), usize,
+			      Z_DEFAULT_COMPRESSION) == Z_OK) {
+			pack16(1, frame);
+			pack32(usize, frame);
+			packmem(zbuf, (uint32_t) zsize, frame);
+			xfree(zbuf);
+			return frame;
+		}
+		error("compressing archive chunk failed, storing it raw");
+		xfree(zbuf);
+	}
+#endif
+	pack16(0, frame);
+	pack32(usize, frame);
+	packmem(get_buf_data(data), usize, frame);
+	return frame;
+}
+
 /* returns count of events archived or SLURM_ERROR on error */
 static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 			       char *cluster_name, time_t period_end,
@@ -2117,17 +2136,20 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 	char *cols = NULL, *query = NULL;
 	time_t period_start = 0;
-	uint32_t cnt = 0;
-	Buf buffer;
+	uint32_t cnt = 0, chunk_cnt = 0;
+	Buf buffer, frame;
+	void *arch_file = NULL;
 	int error_code = 0;
-	Buf (*pack_func)(MYSQL_RES *result, char *cluster_name,
-			 uint32_t cnt, time_t *period_start);
+	uint16_t dbd_type = 0;
+	uint32_t (*pack_func)(MYSQL_RES *result, Buf buffer,
+			      uint32_t max_recs, time_t *period_start);
 
 	cols = _get_archive_columns(type);
 
 	switch (type) {
 	case PURGE_EVENT:
 		pack_func = &_pack_archive_events;
+		dbd_type = DBD_GOT_EVENTS;
 		query = xstrdup_printf("select %s from \"%s_%s\" where "
 				       "time_start <= %ld && time_end != 0 "
 				       "order by time_start asc "
@@ -2137,6 +2159,7 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		break;
 	case PURGE_SUSPEND:
 		pack_func = &_pack_archive_suspends;
+		dbd_type = DBD_JOB_SUSPEND;
 		query = xstrdup_printf("select %s from \"%s_%s\" where "
 				       "time_start <= %ld && time_end != 0 "
 				       "order by time_start asc "
@@ -2146,6 +2169,7 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		break;
 	case PURGE_RESV:
 		pack_func = &_pack_archive_resvs;
+		dbd_type = DBD_GOT_RESVS;
 		query = xstrdup_printf("select %s from \"%s_%s\" where "
 				       "time_start <= %ld && time_end != 0 "
 				       "order by time_start asc "
@@ -2155,6 +2179,7 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		break;
 	case PURGE_JOB:
 		pack_func = &_pack_archive_jobs;
+		dbd_type = DBD_GOT_JOBS;
 		query = xstrdup_printf("select %s from \"%s_%s\" where "
 				       "time_submit < %ld && time_end != 0 "
 				       "&& !deleted order by time_submit asc "
@@ -2164,6 +2189,7 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		break;
 	case PURGE_STEP:
 		pack_func = &_pack_archive_steps;
+		dbd_type = DBD_STEP_START;
 		query = xstrdup_printf("select %s from \"%s_%s\" where "
 				       "time_start <= %ld && time_end != 0 "
 				       "&& !deleted order by time_start asc "
@@ -2191,13 +2217,55 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		return 0;
 	}
 
-	buffer = (*pack_func)(result, cluster_name, cnt, &period_start);
+	/* Stream the archive to disk in fixed size compressed chunks
+	   instead of materializing one huge packed buffer.  The file
+	   is opened after the first chunk since its name needs the
+	   period start from the first row. */
+	buffer = init_buf(high_buffer_size);
+	while ((chunk_cnt = (*pack_func)(result, buffer, ARCHIVE_CHUNK_RECS,
+					 &period_start))) {
+		if (!arch_file) {
+			Buf header;
+
+			arch_file = archive_file_open(cluster_name,
+						      period_start,
+						      period_end, arch_dir,
+						      purge_type_str[type],
+						      archive_period);
+			if (!arch_file) {
+				error_code = SLURM_ERROR;
+				break;
+			}
+			header = init_buf(BUF_SIZE);
+			pack16(SLURM_PROTOCOL_VERSION, header);
+			pack_time(time(NULL), header);
+			pack16(dbd_type, header);
+			packstr(cluster_name, header);
+			/* a chunked archive has no total record count
+			   up front, NO_VAL flags the chunk stream */
+			pack32(NO_VAL, header);
+			error_code = archive_file_write(arch_file, header);
+			free_buf(header);
+			if (error_code != SLURM_SUCCESS)
+				break;
+		}
+		frame = _make_archive_chunk(buffer, chunk_cnt);
+		error_code = archive_file_write(arch_file, frame);
+		free_buf(frame);
+		if (error_code != SLURM_SUCCESS)
+			break;
+		set_buf_offset(buffer, 0);
+	}
 	mysql_free_result(result);
 
-	error_code = archive_write_file(buffer, cluster_name,
-					period_start, period_end,
-					arch_dir, purge_type_str[type],
-					archive_period);
+	if (arch_file && (error_code == SLURM_SUCCESS)) {
+		/* chunk stream terminator */
+		frame = init_buf(BUF_SIZE);
+		pack32(0, frame);
+		error_code = archive_file_write(arch_file, frame);
+		free_buf(frame);
+	}
+	error_code = archive_file_close(arch_file, error_code);
 	free_buf(buffer);
 
 	if (error_code != SLURM_SUCCESS)
@@ -2484,6 +2552,103 @@ extern int as_mysql_jobacct_process_archive(mysql_conn_t *mysql_conn,
 	return rc;
 }
 
+/* returns sql statement from archived data or NULL on error */
+static char *_load_data(uint16_t type, uint16_t rpc_version, Buf buffer,
+			char *cluster_name, uint32_t rec_cnt)
+{
+	switch (type) {
+	case DBD_GOT_EVENTS:
+		return _load_events(rpc_version, buffer, cluster_name,
+				    rec_cnt);
+	case DBD_GOT_JOBS:
+		return _load_jobs(rpc_version, buffer, cluster_name, rec_cnt);
+	case DBD_GOT_RESVS:
+		return _load_resvs(rpc_version, buffer, cluster_name,
+				   rec_cnt);
+	case DBD_STEP_START:
+		return _load_steps(rpc_version, buffer, cluster_name,
+				   rec_cnt);
+	case DBD_JOB_SUSPEND:
+		return _load_suspend(rpc_version, buffer, cluster_name,
+				     rec_cnt);
+	default:
+		error("Unknown type '%u' to load from archive", type);
+		break;
+	}
+	return NULL;
+}
+
+/* Load a chunked archive stream: each chunk is unframed, decompressed
+ * if needed and inserted before the next one is touched, so restoring
+ * a large archive never builds one huge insert statement. */
+static int _load_archive_chunks(mysql_conn_t *mysql_conn, uint16_t type,
+				uint16_t rpc_version, Buf buffer,
+				char *cluster_name)
+{
+	uint32_t chunk_cnt = 0, usize = 0, zsize = 0;
+	uint16_t compressed = 0;
+	char *zdata = NULL, *udata = NULL, *sql = NULL;
+	Buf chunk_buffer;
+	int rc = SLURM_SUCCESS;
+
+	while (1) {
+		safe_unpack32(&chunk_cnt, buffer);
+		if (!chunk_cnt)		/* stream terminator */
+			break;
+		safe_unpack16(&compressed, buffer);
+		safe_unpack32(&usize, buffer);
+		safe_unpackmem_ptr(&zdata, &zsize, buffer);
+
+		udata = xmalloc(usize);
+		if (compressed) {
+#if HAVE_LIBZ
+			uLongf dlen = usize;
+
+			if ((uncompress((Bytef *) udata, &dlen,
+					(Bytef *) zdata, zsize) != Z_OK) ||
+			    (dlen != usize)) {
+				error("decompressing archive chunk failed");
+				xfree(udata);
+				return SLURM_ERROR;
+			}
+#else
+			error("archive chunk is compressed but zlib "
+			      "support is not built");
+			xfree(udata);
+			return SLURM_ERROR;
+#endif
+		} else {
+			if (zsize != usize)
+				goto unpack_error;
+			memcpy(udata, zdata, usize);
+		}
+		chunk_buffer = create_buf(udata, usize);
+		udata = NULL;
+
+		sql = _load_data(type, rpc_version, chunk_buffer,
+				 cluster_name, chunk_cnt);
+		free_buf(chunk_buffer);
+		if (!sql) {
+			error("No data to load");
+			return SLURM_ERROR;
+		}
+		if (debug_flags & DEBUG_FLAG_DB_ARCHIVE)
+			DB_DEBUG(mysql_conn->conn, "query\n%s", sql);
+		rc = mysql_db_query_check_after(mysql_conn, sql);
+		xfree(sql);
+		if (rc != SLURM_SUCCESS) {
+			error("Couldn't load old data");
+			return SLURM_ERROR;
+		}
+	}
+	return rc;
+
+unpack_error:
+	error("problem unpacking archive chunk");
+	xfree(udata);
+	return SLURM_ERROR;
+}
+
 extern int as_mysql_jobacct_process_archive_load(
 	mysql_conn_t *mysql_conn, slurmdb_archive_rec_t *arch_rec)
 {
@@ -2581,6 +2746,14 @@ extern int as_mysql_jobacct_process_archive_load(
 	unpackstr_ptr(&cluster_name, &tmp32, buffer);
 	safe_unpack32(&rec_cnt, buffer);
 
+	if (rec_cnt == NO_VAL) {
+		/* chunked archive, load and insert it chunk by chunk */
+		error_code = _load_archive_chunks(mysql_conn, type, ver,
+						  buffer, cluster_name);
+		free_buf(buffer);
+		return error_code;
+	}
+
 	if (!rec_cnt) {
 		error("we didn't get any records from this file of type '%s'",
 		      slurmdbd_msg_type_2_str(type, 0));
@@ -2588,26 +2761,7 @@ extern int as_mysql_jobacct_process_archive_load(
 		goto got_sql;
 	}
 
-	switch(type) {
-	case DBD_GOT_EVENTS:
-		data = _load_events(ver, buffer, cluster_name, rec_cnt);
-		break;
-	case DBD_GOT_JOBS:
-		data = _load_jobs(ver, buffer, cluster_name, rec_cnt);
-		break;
-	case DBD_GOT_RESVS:
-		data = _load_resvs(ver, buffer, cluster_name, rec_cnt);
-		break;
-	case DBD_STEP_START:
-		data = _load_steps(ver, buffer, cluster_name, rec_cnt);
-		break;
-	case DBD_JOB_SUSPEND:
-		data = _load_suspend(ver, buffer, cluster_name, rec_cnt);
-		break;
-	default:
-		error("Unknown type '%u' to load from archive", type);
-		break;
-	}
+	data = _load_data(type, ver, buffer, cluster_name, rec_cnt);
 	free_buf(buffer);
 
 got_sql:
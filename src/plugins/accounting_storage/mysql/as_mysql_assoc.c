@@ -117,8 +117,32 @@ enum {
 	ASSOC2_REQ_DEF_QOS,
 	ASSOC2_REQ_QOS,
 	ASSOC2_REQ_DELTA_QOS,
+	ASSOC2_REQ_COUNT
 };
 
+/* Cached result of get_parent_limits(), keyed by cluster and parent
+ * account, so a bulk add only calls the procedure once per parent
+ * instead of once per added association. */
+typedef struct {
+	char *cluster;
+	char *parent;
+	char *row[ASSOC2_REQ_COUNT];
+} parent_limits_cache_t;
+
+static void _destroy_parent_limits_cache(void *object)
+{
+	parent_limits_cache_t *entry = (parent_limits_cache_t *) object;
+	int i;
+
+	if (!entry)
+		return;
+	xfree(entry->cluster);
+	xfree(entry->parent);
+	for (i = 0; i < ASSOC2_REQ_COUNT; i++)
+		xfree(entry->row[i]);
+	xfree(entry);
+}
+
 static char *aassoc_req_inx[] = {
 	"id_assoc",
 	"parent_acct",
@@ -677,14 +701,16 @@ static int _set_assoc_lft_rgt(
 }
 
 static int _set_assoc_limits_for_add(
-	mysql_conn_t *mysql_conn, slurmdb_assoc_rec_t *assoc)
+	mysql_conn_t *mysql_conn, slurmdb_assoc_rec_t *assoc,
+	List limits_cache)
 {
 	MYSQL_RES *result = NULL;
-	MYSQL_ROW row;
+	MYSQL_ROW row = NULL;
 	char *query = NULL;
 	char *parent = NULL;
 	char *qos_delta = NULL;
 	uint32_t tres_str_flags = TRES_STR_FLAG_REMOVE;
+	parent_limits_cache_t *entry = NULL;
 
 	xassert(assoc);
 
@@ -695,20 +721,44 @@ static int _set_assoc_limits_for_add(
 	else
 		return SLURM_SUCCESS;
 
-	query = xstrdup_printf("call get_parent_limits('%s', "
-			       "'%s', '%s', %u); %s",
-			       assoc_table, parent, assoc->cluster, 0,
-			       get_parent_limits_select);
-	debug4("%d(%s:%d) query\n%s",
-	       mysql_conn->conn, THIS_FILE, __LINE__, query);
-	if (!(result = mysql_db_query_ret(mysql_conn, query, 1))) {
-		xfree(query);
-		return SLURM_ERROR;
+	if (limits_cache) {
+		ListIterator cache_itr = list_iterator_create(limits_cache);
+		while ((entry = list_next(cache_itr))) {
+			if (!xstrcmp(entry->cluster, assoc->cluster) &&
+			    !xstrcmp(entry->parent, parent))
+				break;
+		}
+		list_iterator_destroy(cache_itr);
+		if (entry)
+			row = entry->row;
 	}
-	xfree(query);
 
-	if (!(row = mysql_fetch_row(result)))
-		goto end_it;
+	if (!row) {
+		query = xstrdup_printf("call get_parent_limits('%s', "
+				       "'%s', '%s', %u); %s",
+				       assoc_table, parent, assoc->cluster, 0,
+				       get_parent_limits_select);
+		debug4("%d(%s:%d) query\n%s",
+		       mysql_conn->conn, THIS_FILE, __LINE__, query);
+		if (!(result = mysql_db_query_ret(mysql_conn, query, 1))) {
+			xfree(query);
+			return SLURM_ERROR;
+		}
+		xfree(query);
+
+		if (!(row = mysql_fetch_row(result)))
+			goto end_it;
+
+		if (limits_cache) {
+			int i;
+			entry = xmalloc(sizeof(parent_limits_cache_t));
+			entry->cluster = xstrdup(assoc->cluster);
+			entry->parent = xstrdup(parent);
+			for (i = 0; i < ASSOC2_REQ_COUNT; i++)
+				entry->row[i] = xstrdup(row[i]);
+			list_append(limits_cache, entry);
+		}
+	}
 
 	if (row[ASSOC2_REQ_DEF_QOS] && assoc->def_qos_id == INFINITE)
 		assoc->def_qos_id = slurm_atoul(row[ASSOC2_REQ_DEF_QOS]);
@@ -779,7 +829,8 @@ static int _set_assoc_limits_for_add(
 	}
 
 end_it:
-	mysql_free_result(result);
+	if (result)
+		mysql_free_result(result);
 
 	return SLURM_SUCCESS;
 }
@@ -2316,6 +2367,7 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 	char *last_parent = NULL, *last_cluster = NULL;
 	List local_cluster_list = NULL;
 	List added_user_list = NULL;
+	List limits_cache = NULL;
 	bool is_coord = false;
 	slurmdb_update_object_t *update_object = NULL;
 	List assoc_list_tmp = NULL;
@@ -2372,6 +2424,7 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 	}
 
 	local_cluster_list = list_create(NULL);
+	limits_cache = list_create(_destroy_parent_limits_cache);
 	user_name = uid_to_string((uid_t) uid);
 	/* these need to be in a specific order */
 	list_sort(assoc_list, (ListCmpF)_assoc_sort_cluster);
@@ -2599,6 +2652,14 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 				   object->cluster, assoc_table, cols,
 				   vals, my_left+(incr-1), my_left+incr);
 
+			/* We know where the new row lands, so no need to
+			 * read the lft and rgt back per record. Values
+			 * stale after later shifts get corrected in one
+			 * pass by as_mysql_get_modified_lfts() below,
+			 * just as when they were read back one by one. */
+			object->lft = my_left + (incr - 1);
+			object->rgt = my_left + incr;
+
 			/* definantly works but slow */
 /* 			xstrfmtcat(query, */
 /* 				   "SELECT @myLeft := lft FROM %s WHERE " */
@@ -2663,6 +2724,10 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 				   "id_assoc=LAST_INSERT_ID(id_assoc)%s %s;",
 				   object->cluster, assoc_table,
 				   extra, update);
+
+			/* This update could change the limits of a
+			 * parent we already have cached */
+			list_flush(limits_cache);
 		}
 		mysql_free_result(result);
 
@@ -2709,7 +2774,8 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 		object->parent_id = my_par_id;
 
 		if (!moved_parent) {
-			_set_assoc_limits_for_add(mysql_conn, object);
+			_set_assoc_limits_for_add(mysql_conn, object,
+						  limits_cache);
 			if (object->lft == NO_VAL)
 				_set_assoc_lft_rgt(mysql_conn, object);
 		}
@@ -2889,6 +2955,7 @@ end_it:
 			if (!(assoc_list_tmp =
 			      as_mysql_get_assocs(mysql_conn, uid, NULL))) {
 				FREE_NULL_LIST(local_cluster_list);
+				FREE_NULL_LIST(limits_cache);
 				return rc;
 			}
 			/* NOTE: you can not use list_pop, or list_push
@@ -2915,6 +2982,7 @@ end_it:
 		reset_mysql_conn(mysql_conn);
 	}
 	FREE_NULL_LIST(local_cluster_list);
+	FREE_NULL_LIST(limits_cache);
 	return rc;
 }
 
@@ -52,27 +52,76 @@
 /* Used in job functions for getting the database index based off the
  * submit time, job and assoc id.  0 is returned if none is found
  */
+/* Append a job/step record statement to the connection's pending
+ * batch.  The whole batch is sent as one multi-statement query once it
+ * holds JobBatchSize records or its oldest record has been pending
+ * JobBatchInterval seconds, cutting the per-record round trips during
+ * job array surges.
+ * IN/OUT query - statement to run, freed on return
+ */
+static int _job_batch_append(mysql_conn_t *mysql_conn, char **query)
+{
+	int rc = SLURM_SUCCESS;
+	int len;
+
+	if (!slurmdbd_conf || (slurmdbd_conf->job_batch_size <= 1)) {
+		rc = mysql_db_query(mysql_conn, *query);
+		xfree(*query);
+		return rc;
+	}
+
+	if (!mysql_conn->batch_query)
+		mysql_conn->batch_time = time(NULL);
+	xstrcat(mysql_conn->batch_query, *query);
+	len = strlen(*query);
+	if (len && ((*query)[len - 1] != ';'))
+		xstrcat(mysql_conn->batch_query, ";");
+	xfree(*query);
+	mysql_conn->batch_cnt++;
+
+	if ((mysql_conn->batch_cnt >= slurmdbd_conf->job_batch_size) ||
+	    (difftime(time(NULL), mysql_conn->batch_time) >=
+	     slurmdbd_conf->job_batch_interval))
+		rc = as_mysql_job_batch_flush(mysql_conn);
+
+	return rc;
+}
+
 static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 			      time_t submit, uint32_t jobid, uint32_t associd)
 {
-	MYSQL_RES *result = NULL;
-	MYSQL_ROW row;
 	uint64_t db_index = 0;
+	long long submit_ll = submit;
+	bool found = false;
+	MYSQL_BIND params[3], result;
 	char *query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
-				     "time_submit=%d and id_job=%u "
-				     "and id_assoc=%u",
-				     mysql_conn->cluster_name, job_table,
-				     (int)submit, jobid, associd);
-
-	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+				     "time_submit=? and id_job=? "
+				     "and id_assoc=?",
+				     mysql_conn->cluster_name, job_table);
+
+	memset(params, 0, sizeof(params));
+	params[0].buffer_type = MYSQL_TYPE_LONGLONG;
+	params[0].buffer = &submit_ll;
+	params[1].buffer_type = MYSQL_TYPE_LONG;
+	params[1].is_unsigned = 1;
+	params[1].buffer = &jobid;
+	params[2].buffer_type = MYSQL_TYPE_LONG;
+	params[2].is_unsigned = 1;
+	params[2].buffer = &associd;
+
+	memset(&result, 0, sizeof(result));
+	result.buffer_type = MYSQL_TYPE_LONGLONG;
+	result.is_unsigned = 1;
+	result.buffer = &db_index;
+
+	if (mysql_db_prepared_query_row(mysql_conn, query, params,
+					&result, &found) != SLURM_SUCCESS) {
 		xfree(query);
 		return 0;
 	}
 	xfree(query);
 
-	row = mysql_fetch_row(result);
-	if (!row) {
-		mysql_free_result(result);
+	if (!found) {
 		debug4("We can't get a db_index for this combo, "
 		       "time_submit=%d and id_job=%u and id_assoc=%u.  "
 		       "We must not have heard about the start yet, "
@@ -80,8 +129,6 @@ static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 		       (int)submit, jobid, associd);
 		return 0;
 	}
-	db_index = slurm_atoull(row[0]);
-	mysql_free_result(result);
 
 	return db_index;
 }
@@ -91,8 +138,10 @@ static char *_get_user_from_associd(mysql_conn_t *mysql_conn,
 {
 	char *user = NULL;
 	char *query = NULL;
-	MYSQL_RES *result = NULL;
-	MYSQL_ROW row;
+	char name[256];
+	unsigned long name_len = 0;
+	bool found = false;
+	MYSQL_BIND param, result;
 
 	/* Just so we don't have to keep a
 	   cache of the associations around we
@@ -101,22 +150,34 @@ static char *_get_user_from_associd(mysql_conn_t *mysql_conn,
 	   this should sort of be a rare case
 	   this isn't too bad.
 	*/
-	query = xstrdup_printf("select user from \"%s_%s\" where id_assoc=%u",
-			       cluster, assoc_table, associd);
+	query = xstrdup_printf("select user from \"%s_%s\" where id_assoc=?",
+			       cluster, assoc_table);
 
 	debug4("%d(%s:%d) query\n%s",
 	       mysql_conn->conn, THIS_FILE, __LINE__, query);
-	if (!(result =
-	      mysql_db_query_ret(mysql_conn, query, 0))) {
+
+	memset(&param, 0, sizeof(param));
+	param.buffer_type = MYSQL_TYPE_LONG;
+	param.is_unsigned = 1;
+	param.buffer = &associd;
+
+	memset(&result, 0, sizeof(result));
+	result.buffer_type = MYSQL_TYPE_STRING;
+	result.buffer = name;
+	result.buffer_length = sizeof(name) - 1;
+	result.length = &name_len;
+
+	if (mysql_db_prepared_query_row(mysql_conn, query, &param,
+					&result, &found) != SLURM_SUCCESS) {
 		xfree(query);
 		return NULL;
 	}
 	xfree(query);
 
-	if ((row = mysql_fetch_row(result)) && row[0][0])
-		user = xstrdup(row[0]);
-
-	mysql_free_result(result);
+	if (found && name_len) {
+		name[MIN(name_len, sizeof(name) - 1)] = '\0';
+		user = xstrdup(name);
+	}
 
 	return user;
 }
@@ -246,6 +307,7 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 	char *block_id = NULL, *partition = NULL,
 		*gres_req = NULL, *gres_alloc = NULL;
 	char *query = NULL;
+	xstrbuf_t sb = XSTRBUF_INITIALIZER;
 	int reinit = 0;
 	time_t begin_time, check_time, start_time, submit_time;
 	uint32_t wckeyid = 0;
@@ -266,6 +328,10 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 	if (check_connection(mysql_conn) != SLURM_SUCCESS)
 		return ESLURM_DB_CONNECTION;
 
+	/* Make sure any batched record for this job (e.g. the previous
+	 * completion of a requeued job) hits the table first. */
+	as_mysql_job_batch_flush(mysql_conn);
+
 	debug2("as_mysql_slurmdb_job_start() called");
 
 	job_state = job_ptr->job_state;
@@ -458,7 +524,10 @@ no_rollup_change:
 		gres_alloc = slurm_add_slash_to_quotes(job_ptr->gres_alloc);
 
 	if (!job_ptr->db_index) {
-		query = xstrdup_printf(
+		/* Build the statement with a length-tracked builder so the
+		 * long chain of appends does not rescan the query. */
+		xstrbuf_fmtcat(
+			&sb,
 			"insert into \"%s_%s\" "
 			"(id_job, mod_time, id_array_job, id_array_task, "
 			"id_assoc, id_qos, id_user, "
@@ -469,130 +538,135 @@ no_rollup_change:
 			mysql_conn->cluster_name, job_table);
 
 		if (wckeyid)
-			xstrcat(query, ", id_wckey");
+			xstrbuf_cat(&sb, ", id_wckey");
 		if (job_ptr->account)
-			xstrcat(query, ", account");
+			xstrbuf_cat(&sb, ", account");
 		if (partition)
-			xstrcat(query, ", `partition`");
+			xstrbuf_cat(&sb, ", `partition`");
 		if (block_id)
-			xstrcat(query, ", id_block");
+			xstrbuf_cat(&sb, ", id_block");
 		if (job_ptr->wckey)
-			xstrcat(query, ", wckey");
+			xstrbuf_cat(&sb, ", wckey");
 		if (node_inx)
-			xstrcat(query, ", node_inx");
+			xstrbuf_cat(&sb, ", node_inx");
 		if (gres_req)
-			xstrcat(query, ", gres_req");
+			xstrbuf_cat(&sb, ", gres_req");
 		if (gres_alloc)
-			xstrcat(query, ", gres_alloc");
+			xstrbuf_cat(&sb, ", gres_alloc");
 		if (array_recs && array_recs->task_id_str)
-			xstrcat(query, ", array_task_str, array_max_tasks, "
-				"array_task_pending");
+			xstrbuf_cat(&sb, ", array_task_str, array_max_tasks, "
+				    "array_task_pending");
 		else
-			xstrcat(query, ", array_task_str, array_task_pending");
+			xstrbuf_cat(&sb, ", array_task_str, "
+				    "array_task_pending");
 
 		if (job_ptr->tres_alloc_str)
-			xstrcat(query, ", tres_alloc");
+			xstrbuf_cat(&sb, ", tres_alloc");
 		if (job_ptr->tres_req_str)
-			xstrcat(query, ", tres_req");
-
-		xstrfmtcat(query,
-			   ") values (%u, UNIX_TIMESTAMP(), "
-			   "%u, %u, %u, %u, %u, %u, "
-			   "'%s', %u, %u, %ld, %ld, %ld, "
-			   "'%s', %u, %u, %u, %u, %u, %u",
-			   job_ptr->job_id, job_ptr->array_job_id,
-			   array_task_id, job_ptr->assoc_id,
-			   job_ptr->qos_id,
-			   job_ptr->user_id, job_ptr->group_id, nodes,
-			   job_ptr->resv_id, job_ptr->time_limit,
-			   begin_time, submit_time, start_time,
-			   jname, track_steps, job_state,
-			   job_ptr->priority, job_ptr->details->min_cpus,
-			   node_cnt,
-			   job_ptr->details->pn_min_memory);
+			xstrbuf_cat(&sb, ", tres_req");
+
+		xstrbuf_fmtcat(&sb,
+			       ") values (%u, UNIX_TIMESTAMP(), "
+			       "%u, %u, %u, %u, %u, %u, "
+			       "'%s', %u, %u, %ld, %ld, %ld, "
+			       "'%s', %u, %u, %u, %u, %u, %u",
+			       job_ptr->job_id, job_ptr->array_job_id,
+			       array_task_id, job_ptr->assoc_id,
+			       job_ptr->qos_id,
+			       job_ptr->user_id, job_ptr->group_id, nodes,
+			       job_ptr->resv_id, job_ptr->time_limit,
+			       begin_time, submit_time, start_time,
+			       jname, track_steps, job_state,
+			       job_ptr->priority, job_ptr->details->min_cpus,
+			       node_cnt,
+			       job_ptr->details->pn_min_memory);
 
 		if (wckeyid)
-			xstrfmtcat(query, ", %u", wckeyid);
+			xstrbuf_fmtcat(&sb, ", %u", wckeyid);
 		if (job_ptr->account)
-			xstrfmtcat(query, ", '%s'", job_ptr->account);
+			xstrbuf_fmtcat(&sb, ", '%s'", job_ptr->account);
 		if (partition)
-			xstrfmtcat(query, ", '%s'", partition);
+			xstrbuf_fmtcat(&sb, ", '%s'", partition);
 		if (block_id)
-			xstrfmtcat(query, ", '%s'", block_id);
+			xstrbuf_fmtcat(&sb, ", '%s'", block_id);
 		if (job_ptr->wckey)
-			xstrfmtcat(query, ", '%s'", job_ptr->wckey);
+			xstrbuf_fmtcat(&sb, ", '%s'", job_ptr->wckey);
 		if (node_inx)
-			xstrfmtcat(query, ", '%s'", node_inx);
+			xstrbuf_fmtcat(&sb, ", '%s'", node_inx);
 		if (gres_req)
-			xstrfmtcat(query, ", '%s'", gres_req);
+			xstrbuf_fmtcat(&sb, ", '%s'", gres_req);
 		if (gres_alloc)
-			xstrfmtcat(query, ", '%s'", gres_alloc);
+			xstrbuf_fmtcat(&sb, ", '%s'", gres_alloc);
 		if (array_recs && array_recs->task_id_str)
-			xstrfmtcat(query, ", '%s', %u, %u",
-				   array_recs->task_id_str,
-				   array_recs->max_run_tasks,
-				   array_recs->task_cnt);
+			xstrbuf_fmtcat(&sb, ", '%s', %u, %u",
+				       array_recs->task_id_str,
+				       array_recs->max_run_tasks,
+				       array_recs->task_cnt);
 		else
-			xstrcat(query, ", NULL, 0");
+			xstrbuf_cat(&sb, ", NULL, 0");
 
 		if (job_ptr->tres_alloc_str)
-			xstrfmtcat(query, ", '%s'", job_ptr->tres_alloc_str);
+			xstrbuf_fmtcat(&sb, ", '%s'", job_ptr->tres_alloc_str);
 		if (job_ptr->tres_req_str)
-			xstrfmtcat(query, ", '%s'", job_ptr->tres_req_str);
-
-		xstrfmtcat(query,
-			   ") on duplicate key update "
-			   "job_db_inx=LAST_INSERT_ID(job_db_inx), "
-			   "id_user=%u, id_group=%u, "
-			   "nodelist='%s', id_resv=%u, timelimit=%u, "
-			   "time_submit=%ld, time_eligible=%ld, "
-			   "time_start=%ld, mod_time=UNIX_TIMESTAMP(), "
-			   "job_name='%s', track_steps=%u, id_qos=%u, "
-			   "state=greatest(state, %u), priority=%u, "
-			   "cpus_req=%u, nodes_alloc=%u, "
-			   "mem_req=%u, id_array_job=%u, id_array_task=%u",
-			   job_ptr->user_id, job_ptr->group_id, nodes,
-			   job_ptr->resv_id, job_ptr->time_limit,
-			   submit_time, begin_time, start_time,
-			   jname, track_steps, job_ptr->qos_id, job_state,
-			   job_ptr->priority, job_ptr->details->min_cpus,
-			   node_cnt,
-			   job_ptr->details->pn_min_memory,
-			   job_ptr->array_job_id,
-			   array_task_id);
+			xstrbuf_fmtcat(&sb, ", '%s'", job_ptr->tres_req_str);
+
+		xstrbuf_fmtcat(&sb,
+			       ") on duplicate key update "
+			       "job_db_inx=LAST_INSERT_ID(job_db_inx), "
+			       "id_user=%u, id_group=%u, "
+			       "nodelist='%s', id_resv=%u, timelimit=%u, "
+			       "time_submit=%ld, time_eligible=%ld, "
+			       "time_start=%ld, mod_time=UNIX_TIMESTAMP(), "
+			       "job_name='%s', track_steps=%u, id_qos=%u, "
+			       "state=greatest(state, %u), priority=%u, "
+			       "cpus_req=%u, nodes_alloc=%u, "
+			       "mem_req=%u, id_array_job=%u, id_array_task=%u",
+			       job_ptr->user_id, job_ptr->group_id, nodes,
+			       job_ptr->resv_id, job_ptr->time_limit,
+			       submit_time, begin_time, start_time,
+			       jname, track_steps, job_ptr->qos_id, job_state,
+			       job_ptr->priority, job_ptr->details->min_cpus,
+			       node_cnt,
+			       job_ptr->details->pn_min_memory,
+			       job_ptr->array_job_id,
+			       array_task_id);
 
 		if (wckeyid)
-			xstrfmtcat(query, ", id_wckey=%u", wckeyid);
+			xstrbuf_fmtcat(&sb, ", id_wckey=%u", wckeyid);
 		if (job_ptr->account)
-			xstrfmtcat(query, ", account='%s'", job_ptr->account);
+			xstrbuf_fmtcat(&sb, ", account='%s'",
+				       job_ptr->account);
 		if (partition)
-			xstrfmtcat(query, ", `partition`='%s'", partition);
+			xstrbuf_fmtcat(&sb, ", `partition`='%s'", partition);
 		if (block_id)
-			xstrfmtcat(query, ", id_block='%s'", block_id);
+			xstrbuf_fmtcat(&sb, ", id_block='%s'", block_id);
 		if (job_ptr->wckey)
-			xstrfmtcat(query, ", wckey='%s'", job_ptr->wckey);
+			xstrbuf_fmtcat(&sb, ", wckey='%s'", job_ptr->wckey);
 		if (node_inx)
-			xstrfmtcat(query, ", node_inx='%s'", node_inx);
+			xstrbuf_fmtcat(&sb, ", node_inx='%s'", node_inx);
 		if (gres_req)
-			xstrfmtcat(query, ", gres_req='%s'", gres_req);
+			xstrbuf_fmtcat(&sb, ", gres_req='%s'", gres_req);
 		if (gres_alloc)
-			xstrfmtcat(query, ", gres_alloc='%s'", gres_alloc);
+			xstrbuf_fmtcat(&sb, ", gres_alloc='%s'", gres_alloc);
 		if (array_recs && array_recs->task_id_str)
-			xstrfmtcat(query, ", array_task_str='%s', "
-				   "array_max_tasks=%u, array_task_pending=%u",
-				   array_recs->task_id_str,
-				   array_recs->max_run_tasks,
-				   array_recs->task_cnt);
+			xstrbuf_fmtcat(&sb, ", array_task_str='%s', "
+				       "array_max_tasks=%u, "
+				       "array_task_pending=%u",
+				       array_recs->task_id_str,
+				       array_recs->max_run_tasks,
+				       array_recs->task_cnt);
 		else
-			xstrfmtcat(query, ", array_task_str=NULL, "
-				   "array_task_pending=0");
+			xstrbuf_cat(&sb, ", array_task_str=NULL, "
+				    "array_task_pending=0");
 
 		if (job_ptr->tres_alloc_str)
-			xstrfmtcat(query, ", tres_alloc='%s'",
-				   job_ptr->tres_alloc_str);
+			xstrbuf_fmtcat(&sb, ", tres_alloc='%s'",
+				       job_ptr->tres_alloc_str);
 		if (job_ptr->tres_req_str)
-			xstrfmtcat(query, ", tres_req='%s'",
-				   job_ptr->tres_req_str);
+			xstrbuf_fmtcat(&sb, ", tres_req='%s'",
+				       job_ptr->tres_req_str);
+
+		query = xstrbuf_release(&sb);
 
 		if (debug_flags & DEBUG_FLAG_DB_JOB)
 			DB_DEBUG(mysql_conn->conn, "query\n%s", query);
@@ -713,6 +787,9 @@ extern List as_mysql_modify_job(mysql_conn_t *mysql_conn, uint32_t uid,
 	} else if (check_connection(mysql_conn) != SLURM_SUCCESS)
 		return NULL;
 
+	/* a batched completion may also set the derived fields */
+	as_mysql_job_batch_flush(mysql_conn);
+
 	if (job->derived_ec != NO_VAL)
 		xstrfmtcat(vals, ", derived_ec=%u", job->derived_ec);
 
@@ -925,8 +1002,7 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 
 	if (debug_flags & DEBUG_FLAG_DB_JOB)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
-	xfree(query);
+	rc = _job_batch_append(mysql_conn, &query);
 
 	return rc;
 }
@@ -1100,8 +1176,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		step_ptr->tres_alloc_str);
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
-	xfree(query);
+	rc = _job_batch_append(mysql_conn, &query);
 	xfree(step_name);
 
 	return rc;
@@ -1301,8 +1376,7 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		   step_ptr->job_ptr->db_index, step_ptr->step_id);
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
-	xfree(query);
+	rc = _job_batch_append(mysql_conn, &query);
 
 	return rc;
 }
@@ -1319,6 +1393,10 @@ extern int as_mysql_suspend(mysql_conn_t *mysql_conn,
 	if (check_connection(mysql_conn) != SLURM_SUCCESS)
 		return ESLURM_DB_CONNECTION;
 
+	/* batched records for this job must land before we touch its
+	 * suspend accounting */
+	as_mysql_job_batch_flush(mysql_conn);
+
 	if (job_ptr->resize_time)
 		submit_time = job_ptr->resize_time;
 	else
@@ -1418,6 +1496,8 @@ extern int as_mysql_flush_jobs_on_cluster(
 	if (check_connection(mysql_conn) != SLURM_SUCCESS)
 		return ESLURM_DB_CONNECTION;
 
+	as_mysql_job_batch_flush(mysql_conn);
+
 	/* First we need to get the job_db_inx's and states so we can clean up
 	 * the suspend table and the step table
 	 */
@@ -1496,3 +1576,23 @@ extern int as_mysql_flush_jobs_on_cluster(
 
 	return rc;
 }
+
+/* Send any batched job/step record statements to the database as a
+ * single query.  Called whenever a following statement must see the
+ * batched ones, and from acct_storage_p_commit(). */
+extern int as_mysql_job_batch_flush(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	if (!mysql_conn->batch_query)
+		return SLURM_SUCCESS;
+
+	if (debug_flags & (DEBUG_FLAG_DB_JOB | DEBUG_FLAG_DB_STEP))
+		DB_DEBUG(mysql_conn->conn, "query\n%s",
+			 mysql_conn->batch_query);
+	rc = mysql_db_query(mysql_conn, mysql_conn->batch_query);
+	xfree(mysql_conn->batch_query);
+	mysql_conn->batch_cnt = 0;
+
+	return rc;
+}
@@ -63,4 +63,6 @@ extern int as_mysql_suspend(mysql_conn_t *mysql_conn, uint64_t old_db_inx,
 
 extern int as_mysql_flush_jobs_on_cluster(
 	mysql_conn_t *mysql_conn, time_t event_time);
+
+extern int as_mysql_job_batch_flush(mysql_conn_t *mysql_conn);
 #endif
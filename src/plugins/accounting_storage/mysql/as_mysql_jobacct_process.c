@@ -266,33 +266,35 @@ static void _state_time_string(char **extra, char *cluster_name, uint32_t state,
 		if (start) {
 			if (!end) {
 				xstrfmtcat(*extra,
-					   "(t1.time_eligible && "
-					   "((!t1.time_start && !t1.time_end) "
+					   "(t1.time_eligible > 0 && "
+					   "((t1.time_start = 0 && "
+					   "t1.time_end = 0) "
 					   "|| (%d between t1.time_eligible "
 					   "and t1.time_start)))",
 					   start);
 			} else {
 				xstrfmtcat(*extra,
-					   "(t1.time_eligible && ((%d between "
+					   "(t1.time_eligible > 0 && "
+					   "((%d between "
 					   "t1.time_eligible and "
 					   "t1.time_start) || "
 					   "(t1.time_eligible "
 					   "between %d and %d)) || "
-					   "(!t1.time_start && (%d between "
+					   "(t1.time_start = 0 && (%d between "
 					   "t1.time_eligible and "
 					   "t1.time_end)))",
 					   start, start,
 					   end, start);
 			}
 		} else if (end) {
-			xstrfmtcat(*extra, "(t1.time_eligible && "
+			xstrfmtcat(*extra, "(t1.time_eligible > 0 && "
 				   "t1.time_eligible < %d)",
 				   end);
 		}
 		break;
 	case JOB_SUSPENDED:
 		xstrfmtcat(*extra,
-			   "(select count(time_start) from "
+			   "exists (select 1 from "
 			   "\"%s_%s\" where "
 			   "(time_start <= %u && (time_end >= %u "
 			   "|| time_end = 0)) && job_db_inx=t1.job_db_inx)",
@@ -304,23 +306,24 @@ static void _state_time_string(char **extra, char *cluster_name, uint32_t state,
 		if (start) {
 			if (!end) {
 				xstrfmtcat(*extra,
-					   "(t1.time_start && "
-					   "((!t1.time_end && t1.state=%d) || "
-					   "(%d between t1.time_start "
-					   "and t1.time_end)))",
-					   base_state, start);
+					   "((t1.time_end = 0 && t1.state=%d "
+					   "&& t1.time_start > 0) || "
+					   "(t1.time_end >= %d && "
+					   "t1.time_start > 0 && "
+					   "t1.time_start <= %d))",
+					   base_state, start, start);
 			} else {
 				xstrfmtcat(*extra,
-					   "(t1.time_start && "
-					   "((%d between t1.time_start "
-					   "and t1.time_end) "
+					   "((t1.time_end >= %d && "
+					   "t1.time_start > 0 && "
+					   "t1.time_start <= %d) "
 					   "|| (t1.time_start between "
-					   "%d and %d)))",
-					   start, start,
+					   "%d and %d))",
+					   start, start, start,
 					   end);
 			}
 		} else if (end) {
-			xstrfmtcat(*extra, "(t1.time_start && "
+			xstrfmtcat(*extra, "(t1.time_start > 0 && "
 				   "t1.time_start < %d)", end);
 		}
 		break;
@@ -332,7 +335,8 @@ static void _state_time_string(char **extra, char *cluster_name, uint32_t state,
 	case JOB_PREEMPTED:
 	case JOB_DEADLINE:
 	default:
-		xstrfmtcat(*extra, "(t1.state='%u' && (t1.time_end && ", state);
+		xstrfmtcat(*extra, "(t1.state='%u' && (t1.time_end > 0 && ",
+			   state);
 		if (start) {
 			if (!end) {
 				xstrfmtcat(*extra, "(t1.time_end >= %d)))",
@@ -387,6 +391,8 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	int rc = SLURM_SUCCESS;
 	int last_id = -1, curr_id = -1;
 	local_cluster_t *curr_cluster = NULL;
+	uint32_t chunk_scanned = 0;
+	uint64_t last_db_inx = 0;
 
 	/* This is here to make sure we are looking at only this user
 	 * if this flag is set.  We also include any accounts they may be
@@ -455,6 +461,17 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	setup_job_cluster_cond_limits(mysql_conn, job_cond,
 				      cluster_name, &extra);
 
+	/* A chunked fetch resumes after the last database index the
+	   caller has already seen. */
+	if (job_cond && job_cond->chunk_size) {
+		if (extra)
+			xstrfmtcat(extra, " && (t1.job_db_inx > %"PRIu64")",
+				   job_cond->chunk_db_inx);
+		else
+			xstrfmtcat(extra, " where (t1.job_db_inx > %"PRIu64")",
+				   job_cond->chunk_db_inx);
+	}
+
 	query = xstrdup_printf("select %s from \"%s_%s\" as t1 "
 			       "left join \"%s_%s\" as t2 "
 			       "on t1.id_assoc=t2.id_assoc "
@@ -480,7 +497,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	   easy to look for duplicates, it is also easy to sort the
 	   resized jobs.
 	*/
-	xstrcat(query, " group by id_job, time_submit desc");
+	if (job_cond && job_cond->chunk_size)
+		/* The database index is the cursor for chunked
+		   fetches, so the rows have to come back ordered by
+		   it.  The group still collapses any row duplication
+		   coming from the reservation join. */
+		xstrfmtcat(query, " group by job_db_inx limit %u",
+			   job_cond->chunk_size);
+	else
+		xstrcat(query, " group by id_job, time_submit desc");
 
 	if (debug_flags & DEBUG_FLAG_DB_JOB)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
@@ -512,6 +537,9 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		bool job_ended = 0;
 		int start = slurm_atoul(row[JOB_REQ_START]);
 
+		chunk_scanned++;
+		last_db_inx = slurm_atoull(db_inx_char);
+
 		curr_id = slurm_atoul(row[JOB_REQ_JOBID]);
 
 		if (job_cond && !job_cond->duplicates
@@ -531,6 +559,7 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		}
 
 		job = slurmdb_create_job_rec();
+		job->db_index = slurm_atoull(db_inx_char);
 		job->state = slurm_atoul(row[JOB_REQ_STATE]);
 		if (curr_id == last_id)
 			/* put in reverse so we order by the submit getting
@@ -971,6 +1000,17 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	mysql_free_result(result);
 
+	/* Tell the caller where to resume if the table may hold more
+	   rows past this chunk.  The sentinel record is stripped off
+	   by the client and never shown to the user. */
+	if (job_cond && job_cond->chunk_size &&
+	    (chunk_scanned >= job_cond->chunk_size)) {
+		job = slurmdb_create_job_rec();
+		job->jobid = NO_VAL;
+		job->db_index = last_db_inx;
+		list_append(job_list, job);
+	}
+
 end_it:
 	if (itr2)
 		list_iterator_destroy(itr2);
@@ -1493,19 +1533,22 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 					   job_cond->usage_start);
 			else
 				xstrfmtcat(*extra,
-					   "(t1.time_eligible "
-					   "&& t1.time_eligible < %ld "
-					   "&& (t1.time_end >= %ld "
-					   "|| t1.time_end = 0)))",
+					   "((t1.time_end >= %ld "
+					   "&& t1.time_eligible > 0 "
+					   "&& t1.time_eligible < %ld) "
+					   "|| (t1.time_end = 0 "
+					   "&& t1.time_eligible > 0 "
+					   "&& t1.time_eligible < %ld)))",
+					   job_cond->usage_start,
 					   job_cond->usage_end,
-					   job_cond->usage_start);
+					   job_cond->usage_end);
 		} else if (job_cond->usage_end) {
 			if (*extra)
 				xstrcat(*extra, " && (");
 			else
 				xstrcat(*extra, " where (");
 			xstrfmtcat(*extra,
-				   "(t1.time_eligible && "
+				   "(t1.time_eligible > 0 && "
 				   "t1.time_eligible < %ld))",
 				   job_cond->usage_end);
 		}
@@ -1531,6 +1574,35 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 	return set;
 }
 
+/* Arguments for one per cluster job fetch run by _cluster_jobs_thread */
+typedef struct {
+	mysql_conn_t *mysql_conn;
+	slurmdb_user_rec_t *user;
+	slurmdb_job_cond_t *job_cond;
+	char *cluster_name;
+	char *job_fields;
+	char *step_fields;
+	char *extra;
+	bool is_admin;
+	int only_pending;
+	List job_list;
+	int rc;
+} cluster_jobs_args_t;
+
+static void *_cluster_jobs_thread(void *arg)
+{
+	cluster_jobs_args_t *args = (cluster_jobs_args_t *) arg;
+
+	mysql_thread_init();
+	args->rc = _cluster_get_jobs(args->mysql_conn, args->user,
+				     args->job_cond, args->cluster_name,
+				     args->job_fields, args->step_fields,
+				     args->extra, args->is_admin,
+				     args->only_pending, args->job_list);
+	mysql_thread_end();
+	return NULL;
+}
+
 extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 					      uid_t uid,
 					      slurmdb_job_cond_t *job_cond)
@@ -1538,6 +1610,9 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	char *extra = NULL;
 	char *tmp = NULL, *tmp2 = NULL;
 	ListIterator itr = NULL;
+	cluster_jobs_args_t *para_args = NULL;
+	pthread_t *para_threads = NULL;
+	int para_cnt = 0;
 	int is_admin=1;
 	int i;
 	List job_list = NULL;
@@ -1588,6 +1663,15 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 		xstrfmtcat(tmp2, ", %s", step_req_inx[i]);
 	}
 
+	/* The chunk cursor is a per cluster database index, so chunked
+	   fetches are only honored on a single cluster request. */
+	if (job_cond && job_cond->chunk_size &&
+	    (!job_cond->cluster_list ||
+	     (list_count(job_cond->cluster_list) != 1))) {
+		debug("ignoring chunk_size on a multi-cluster request");
+		job_cond->chunk_size = 0;
+	}
+
 	if (job_cond
 	    && job_cond->cluster_list && list_count(job_cond->cluster_list))
 		use_cluster_list = job_cond->cluster_list;
@@ -1597,9 +1681,52 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	assoc_mgr_lock(&locks);
 
 	job_list = list_create(slurmdb_destroy_job_rec);
+
+	/* On a multi-cluster request run the per cluster fetches
+	   concurrently on pooled connections, overlapping the server
+	   latency.  Clusters which can not get a pooled connection
+	   fall back to the caller's connection below. */
+	if (list_count(use_cluster_list) > 1) {
+		para_args = xmalloc(sizeof(cluster_jobs_args_t) *
+				    list_count(use_cluster_list));
+		para_threads = xmalloc(sizeof(pthread_t) *
+				       list_count(use_cluster_list));
+	}
+
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
+		if (para_args) {
+			mysql_conn_t *pool_conn = mysql_db_pool_get();
+			if (pool_conn) {
+				cluster_jobs_args_t *args =
+					&para_args[para_cnt];
+				pthread_attr_t attr;
+				args->mysql_conn = pool_conn;
+				args->user = &user;
+				args->job_cond = job_cond;
+				args->cluster_name = cluster_name;
+				args->job_fields = tmp;
+				args->step_fields = tmp2;
+				args->extra = extra;
+				args->is_admin = is_admin;
+				args->only_pending = only_pending;
+				args->job_list = job_list;
+				args->rc = SLURM_SUCCESS;
+				slurm_attr_init(&attr);
+				rc = pthread_create(&para_threads[para_cnt],
+						    &attr,
+						    _cluster_jobs_thread,
+						    args);
+				slurm_attr_destroy(&attr);
+				if (!rc) {
+					para_cnt++;
+					continue;
+				}
+				error("pthread_create: %m");
+				mysql_db_pool_put(pool_conn);
+			}
+		}
 		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
 					    cluster_name, tmp, tmp2, extra,
 					    is_admin, only_pending, job_list))
@@ -1609,6 +1736,16 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	list_iterator_destroy(itr);
 
+	for (i = 0; i < para_cnt; i++) {
+		pthread_join(para_threads[i], NULL);
+		mysql_db_pool_put(para_args[i].mysql_conn);
+		if (para_args[i].rc != SLURM_SUCCESS)
+			error("Problem getting jobs for cluster %s",
+			      para_args[i].cluster_name);
+	}
+	xfree(para_args);
+	xfree(para_threads);
+
 	assoc_mgr_unlock(&locks);
 
 	if (use_cluster_list == as_mysql_cluster_list)
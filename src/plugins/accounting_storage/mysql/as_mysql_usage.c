@@ -60,6 +60,261 @@ typedef struct {
 	time_t sent_start;
 } local_rollup_t;
 
+/* An hourly catch-up range is cut into chunks of this many seconds,
+ * rolled up concurrently by at most ROLLUP_MAX_WORKERS threads */
+#define ROLLUP_CHUNK_SECS (24 * 3600)
+#define ROLLUP_MAX_WORKERS 4
+
+typedef struct {
+	uint16_t archive_data;
+	int chunk_cnt;
+	pthread_mutex_t *chunk_lock;
+	char *cluster_name;
+	int conn_num;
+	time_t hour_end;
+	time_t hour_start;
+	int *next_chunk;
+	int *rc;
+} hourly_rollup_t;
+
+/* Usage reports tend to be re-run with identical ranges (e.g. the same
+ * monthly report every day), re-scanning rollup tables that only change
+ * when the rollup itself runs. Cache the parsed result of a usage query
+ * keyed by the query text, flush on every rollup and age entries out as
+ * a backstop for writers we don't see (e.g. an archive load). */
+#define USAGE_CACHE_SECS 600
+#define USAGE_CACHE_MAX_ENTRIES 64
+
+typedef struct {
+	time_t created;
+	bool cluster_usage;	/* slurmdb_cluster_accounting_rec_t's if
+				 * set, else slurmdb_accounting_rec_t's */
+	char *query;
+	List recs;
+} usage_cache_entry_t;
+
+static List usage_cache_list = NULL;
+static pthread_mutex_t usage_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _destroy_usage_cache_entry(void *object)
+{
+	usage_cache_entry_t *entry = (usage_cache_entry_t *) object;
+
+	if (!entry)
+		return;
+	xfree(entry->query);
+	FREE_NULL_LIST(entry->recs);
+	xfree(entry);
+}
+
+/* Caller must hold usage_cache_lock */
+static usage_cache_entry_t *_usage_cache_find(char *query, bool cluster_usage)
+{
+	usage_cache_entry_t *entry;
+	ListIterator itr;
+	time_t too_old = time(NULL) - USAGE_CACHE_SECS;
+
+	if (!usage_cache_list)
+		return NULL;
+
+	itr = list_iterator_create(usage_cache_list);
+	while ((entry = list_next(itr))) {
+		if (entry->created < too_old) {
+			list_delete_item(itr);
+			continue;
+		}
+		if ((entry->cluster_usage == cluster_usage) &&
+		    !xstrcmp(entry->query, query))
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	return entry;
+}
+
+/* Caller must hold usage_cache_lock, the entry takes over recs */
+static void _usage_cache_insert(char *query, bool cluster_usage, List recs)
+{
+	usage_cache_entry_t *entry;
+
+	if (!usage_cache_list)
+		usage_cache_list = list_create(_destroy_usage_cache_entry);
+
+	while (list_count(usage_cache_list) >= USAGE_CACHE_MAX_ENTRIES) {
+		/* evict the oldest entry */
+		ListIterator itr = list_iterator_create(usage_cache_list);
+		if (list_next(itr))
+			list_delete_item(itr);
+		list_iterator_destroy(itr);
+	}
+
+	entry = xmalloc(sizeof(usage_cache_entry_t));
+	entry->created = time(NULL);
+	entry->cluster_usage = cluster_usage;
+	entry->query = xstrdup(query);
+	entry->recs = recs;
+	list_append(usage_cache_list, entry);
+}
+
+static void _usage_cache_flush(void)
+{
+	slurm_mutex_lock(&usage_cache_lock);
+	if (usage_cache_list)
+		list_flush(usage_cache_list);
+	slurm_mutex_unlock(&usage_cache_lock);
+}
+
+static slurmdb_accounting_rec_t *_dup_accounting_rec(
+	slurmdb_accounting_rec_t *in)
+{
+	slurmdb_accounting_rec_t *out =
+		xmalloc(sizeof(slurmdb_accounting_rec_t));
+
+	out->alloc_secs = in->alloc_secs;
+	out->id = in->id;
+	out->period_start = in->period_start;
+	out->tres_rec.id = in->tres_rec.id;
+	out->tres_rec.count = in->tres_rec.count;
+	out->tres_rec.name = xstrdup(in->tres_rec.name);
+	out->tres_rec.type = xstrdup(in->tres_rec.type);
+
+	return out;
+}
+
+static slurmdb_cluster_accounting_rec_t *_dup_cluster_accounting_rec(
+	slurmdb_cluster_accounting_rec_t *in)
+{
+	slurmdb_cluster_accounting_rec_t *out =
+		xmalloc(sizeof(slurmdb_cluster_accounting_rec_t));
+
+	out->alloc_secs = in->alloc_secs;
+	out->down_secs = in->down_secs;
+	out->idle_secs = in->idle_secs;
+	out->over_secs = in->over_secs;
+	out->pdown_secs = in->pdown_secs;
+	out->period_start = in->period_start;
+	out->resv_secs = in->resv_secs;
+	out->tres_rec.id = in->tres_rec.id;
+	out->tres_rec.count = in->tres_rec.count;
+	out->tres_rec.name = xstrdup(in->tres_rec.name);
+	out->tres_rec.type = xstrdup(in->tres_rec.type);
+
+	return out;
+}
+
+static void *_hourly_rollup_worker(void *arg)
+{
+	hourly_rollup_t *args = (hourly_rollup_t *)arg;
+	mysql_conn_t mysql_conn;
+	int chunk, rc;
+
+	/* Just as with the per-cluster threads, each worker needs its
+	 * own connection. */
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = args->conn_num;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	if ((rc = check_connection(&mysql_conn)) != SLURM_SUCCESS)
+		goto end_it;
+
+	while (1) {
+		time_t chunk_start, chunk_end;
+
+		slurm_mutex_lock(args->chunk_lock);
+		if ((*args->rc != SLURM_SUCCESS) ||
+		    (*args->next_chunk >= args->chunk_cnt)) {
+			slurm_mutex_unlock(args->chunk_lock);
+			break;
+		}
+		chunk = (*args->next_chunk)++;
+		slurm_mutex_unlock(args->chunk_lock);
+
+		chunk_start = args->hour_start +
+			((time_t) chunk * ROLLUP_CHUNK_SECS);
+		chunk_end = MIN(chunk_start + ROLLUP_CHUNK_SECS,
+				args->hour_end);
+		/* only check for purge/archive with the newest chunk */
+		rc = as_mysql_hourly_rollup(&mysql_conn, args->cluster_name,
+					    chunk_start, chunk_end,
+					    (chunk_end == args->hour_end) ?
+					    args->archive_data : 0);
+		if (rc != SLURM_SUCCESS)
+			break;
+	}
+end_it:
+	if (rc != SLURM_SUCCESS) {
+		slurm_mutex_lock(args->chunk_lock);
+		if ((*args->rc) == SLURM_SUCCESS)
+			(*args->rc) = rc;
+		slurm_mutex_unlock(args->chunk_lock);
+		if (mysql_db_rollback(&mysql_conn))
+			error("rollback failed");
+	}
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	return NULL;
+}
+
+/* Roll up the hourly usage of one cluster, cutting a large catch-up
+ * range into day sized chunks rolled up concurrently on a small pool
+ * of connections.  The chunks are independent of each other (each hour
+ * is computed only from the event/job/suspend tables) and
+ * as_mysql_hourly_rollup() already commits per call, so the
+ * per-cluster boundaries do not change: last_ran is only advanced by
+ * the caller once every chunk succeeded, and a failure just causes an
+ * idempotent re-roll of the range. */
+static int _do_hourly_rollup(mysql_conn_t *mysql_conn,
+			     local_rollup_t *local_rollup,
+			     time_t hour_start, time_t hour_end)
+{
+	int rc = SLURM_SUCCESS;
+	int chunk_cnt, thread_cnt, next_chunk = 0, i;
+	pthread_mutex_t chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+	pthread_t worker_id[ROLLUP_MAX_WORKERS];
+	pthread_attr_t worker_attr;
+	hourly_rollup_t args;
+
+	chunk_cnt = (hour_end - hour_start + ROLLUP_CHUNK_SECS - 1) /
+		ROLLUP_CHUNK_SECS;
+	/* the common catch-up of an hour or two is not worth a pool */
+	if (chunk_cnt < 2)
+		return as_mysql_hourly_rollup(mysql_conn,
+					      local_rollup->cluster_name,
+					      hour_start, hour_end,
+					      local_rollup->archive_data);
+
+	thread_cnt = MIN(chunk_cnt, ROLLUP_MAX_WORKERS);
+	debug2("rolling %d hourly chunks for %s on %d threads",
+	       chunk_cnt, local_rollup->cluster_name, thread_cnt);
+
+	memset(&args, 0, sizeof(args));
+	args.archive_data = local_rollup->archive_data;
+	args.chunk_cnt = chunk_cnt;
+	args.chunk_lock = &chunk_lock;
+	args.cluster_name = local_rollup->cluster_name;
+	args.conn_num = mysql_conn->conn;
+	args.hour_end = hour_end;
+	args.hour_start = hour_start;
+	args.next_chunk = &next_chunk;
+	args.rc = &rc;
+
+	slurm_attr_init(&worker_attr);
+	for (i = 0; i < thread_cnt; i++) {
+		if (pthread_create(&worker_id[i], &worker_attr,
+				   _hourly_rollup_worker, (void *) &args))
+			fatal("pthread_create: %m");
+	}
+	slurm_attr_destroy(&worker_attr);
+
+	for (i = 0; i < thread_cnt; i++)
+		pthread_join(worker_id[i], NULL);
+	slurm_mutex_destroy(&chunk_lock);
+
+	return rc;
+}
+
 static void *_cluster_rollup_usage(void *arg)
 {
 	local_rollup_t *local_rollup = (local_rollup_t *)arg;
@@ -292,11 +547,8 @@ static void *_cluster_rollup_usage(void *arg)
 
 	if ((hour_end - hour_start) > 0) {
 		START_TIMER;
-		rc = as_mysql_hourly_rollup(&mysql_conn,
-					    local_rollup->cluster_name,
-					    hour_start,
-					    hour_end,
-					    local_rollup->archive_data);
+		rc = _do_hourly_rollup(&mysql_conn, local_rollup,
+				       hour_start, hour_end);
 		snprintf(timer_str, sizeof(timer_str),
 			 "hourly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -420,6 +672,8 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 	MYSQL_ROW row;
 	char *query = NULL;
+	usage_cache_entry_t *cache_entry = NULL;
+	List new_recs = NULL;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
 
@@ -473,16 +727,35 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 	}
 	xfree(tmp);
 
+	if (!(*usage_list))
+		(*usage_list) = list_create(slurmdb_destroy_accounting_rec);
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if ((cache_entry = _usage_cache_find(query, false))) {
+		ListIterator cache_itr =
+			list_iterator_create(cache_entry->recs);
+		slurmdb_accounting_rec_t *cached_rec;
+
+		while ((cached_rec = list_next(cache_itr)))
+			list_append(*usage_list,
+				    _dup_accounting_rec(cached_rec));
+		list_iterator_destroy(cache_itr);
+		slurm_mutex_unlock(&usage_cache_lock);
+		xfree(query);
+		return SLURM_SUCCESS;
+	}
+	slurm_mutex_unlock(&usage_cache_lock);
+
 	if (debug_flags & DEBUG_FLAG_DB_USAGE)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
 	result = mysql_db_query_ret(mysql_conn, query, 0);
-	xfree(query);
 
-	if (!result)
+	if (!result) {
+		xfree(query);
 		return SLURM_ERROR;
+	}
 
-	if (!(*usage_list))
-		(*usage_list) = list_create(slurmdb_destroy_accounting_rec);
+	new_recs = list_create(slurmdb_destroy_accounting_rec);
 
 	assoc_mgr_lock(&locks);
 	while ((row = mysql_fetch_row(result))) {
@@ -505,11 +778,20 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 		accounting_rec->alloc_secs = slurm_atoull(row[USAGE_ALLOC]);
 
 		list_append(*usage_list, accounting_rec);
+		list_append(new_recs, _dup_accounting_rec(accounting_rec));
 	}
 	assoc_mgr_unlock(&locks);
 
 	mysql_free_result(result);
 
+	slurm_mutex_lock(&usage_cache_lock);
+	if (_usage_cache_find(query, false))
+		FREE_NULL_LIST(new_recs);	/* query raced with us */
+	else
+		_usage_cache_insert(query, false, new_recs);
+	slurm_mutex_unlock(&usage_cache_lock);
+	xfree(query);
+
 	return SLURM_SUCCESS;
 }
 
@@ -526,6 +808,8 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 	char *tmp = NULL;
 	char *my_usage_table = cluster_day_table;
 	char *query = NULL;
+	usage_cache_entry_t *cache_entry = NULL;
+	List new_recs = NULL;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
 	char *cluster_req_inx[] = {
@@ -576,6 +860,27 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 		tmp, cluster_rec->name, my_usage_table, end, start);
 
 	xfree(tmp);
+
+	if (!cluster_rec->accounting_list)
+		cluster_rec->accounting_list =
+			list_create(slurmdb_destroy_cluster_accounting_rec);
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if ((cache_entry = _usage_cache_find(query, true))) {
+		ListIterator cache_itr =
+			list_iterator_create(cache_entry->recs);
+		slurmdb_cluster_accounting_rec_t *cached_rec;
+
+		while ((cached_rec = list_next(cache_itr)))
+			list_append(cluster_rec->accounting_list,
+				    _dup_cluster_accounting_rec(cached_rec));
+		list_iterator_destroy(cache_itr);
+		slurm_mutex_unlock(&usage_cache_lock);
+		xfree(query);
+		return rc;
+	}
+	slurm_mutex_unlock(&usage_cache_lock);
+
 	if (debug_flags & DEBUG_FLAG_DB_USAGE)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
 
@@ -583,11 +888,8 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 		xfree(query);
 		return SLURM_ERROR;
 	}
-	xfree(query);
 
-	if (!cluster_rec->accounting_list)
-		cluster_rec->accounting_list =
-			list_create(slurmdb_destroy_cluster_accounting_rec);
+	new_recs = list_create(slurmdb_destroy_cluster_accounting_rec);
 
 	assoc_mgr_lock(&locks);
 	while ((row = mysql_fetch_row(result))) {
@@ -614,10 +916,21 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 		accounting_rec->resv_secs = slurm_atoull(row[CLUSTER_RCPU]);
 		accounting_rec->period_start = slurm_atoul(row[CLUSTER_START]);
 		list_append(cluster_rec->accounting_list, accounting_rec);
+		list_append(new_recs,
+			    _dup_cluster_accounting_rec(accounting_rec));
 	}
 	assoc_mgr_unlock(&locks);
 
 	mysql_free_result(result);
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if (_usage_cache_find(query, true))
+		FREE_NULL_LIST(new_recs);	/* query raced with us */
+	else
+		_usage_cache_insert(query, true, new_recs);
+	slurm_mutex_unlock(&usage_cache_lock);
+	xfree(query);
+
 	return rc;
 }
 
@@ -997,6 +1310,9 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn, time_t sent_start,
 	/* END_TIMER; */
 	/* info("total time was %s", TIME_STR); */
 
+	/* the rollup rewrote the usage tables the cache was built from */
+	_usage_cache_flush();
+
 	slurm_mutex_unlock(&usage_rollup_lock);
 
 	return rc;
@@ -86,6 +86,14 @@ slurmd_conf_t *conf = NULL;
 #define NBFIRSTREAD 3
 #define MAX_LOG_ERRORS 5	/* Max sensor reading errors log messages */
 
+/* Back off the sampling interval when readings are stable (idle node) */
+#define BACKOFF_THRESH_WATTS 5	/* Watts delta under which a reading is
+				 * considered stable */
+#define BACKOFF_CYCLES 3	/* Stable cycles before lengthening the
+				 * sampling interval */
+#define BACKOFF_LIMIT 4		/* Max sampling interval, as a multiple of
+				 * EnergyIPMIFrequency */
+
 /*
  * These variables are required by the generic plugin interface.  If they
  * are not found in the plugin, the plugin loader will ignore it.
@@ -144,6 +152,18 @@ static sensor_status_t *sensors = NULL;
 static uint16_t sensors_len = 0;
 static uint64_t *start_current_energies = NULL;
 
+/* Snapshot of the latest readings, published by the sampling thread after
+ * each cycle. RPC queries for current values are answered from here so
+ * they never wait for an IPMI transaction holding ipmi_mutex. */
+static pthread_mutex_t snapshot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sensor_status_t *sensors_snap = NULL;
+static uint16_t sensors_snap_len = 0;
+static time_t snap_update_time = 0;
+
+/* Set by _thread_update_node_energy() when no sensor moved by more than
+ * BACKOFF_THRESH_WATTS, read by the sampling thread to back off */
+static bool readings_stable = false;
+
 /* array of struct describing the configuration of the sensors */
 typedef struct description {
 	const char* label;
@@ -578,10 +598,28 @@ static void _update_energy(acct_gather_energy_t *e, uint32_t last_update_watt)
  * _thread_update_node_energy calls _read_ipmi_values and updates all values
  * for node consumption
  */
+/* Publish a copy of the current readings for lock-free consumers.
+ * Called with ipmi_mutex locked. */
+static void _publish_snapshot(void)
+{
+	slurm_mutex_lock(&snapshot_mutex);
+	if (sensors_snap_len != sensors_len) {
+		xfree(sensors_snap);
+		sensors_snap_len = sensors_len;
+		sensors_snap = xmalloc(sizeof(sensor_status_t) *
+				       sensors_snap_len);
+	}
+	memcpy(sensors_snap, sensors, sizeof(sensor_status_t) * sensors_len);
+	snap_update_time = last_update_time;
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
 static int _thread_update_node_energy(void)
 {
 	int rc = SLURM_SUCCESS;
 	uint16_t i;
+	uint32_t delta;
+	bool stable = true;
 
 	rc = _read_ipmi_values();
 
@@ -592,10 +630,18 @@ static int _thread_update_node_energy(void)
 				return rc;
 			_update_energy(&sensors[i].energy,
 				       sensors[i].last_update_watt);
+			delta = MAX(sensors[i].energy.current_watts,
+				    sensors[i].energy.base_watts) -
+				MIN(sensors[i].energy.current_watts,
+				    sensors[i].energy.base_watts);
+			if (delta > BACKOFF_THRESH_WATTS)
+				stable = false;
 		}
+		readings_stable = stable;
 
 		if (previous_update_time == 0)
 			previous_update_time = last_update_time;
+		_publish_snapshot();
 	}
 
 	if (debug_flags & DEBUG_FLAG_ENERGY) {
@@ -722,7 +768,8 @@ static int _ipmi_send_profile(void)
 static void *_thread_ipmi_run(void *no_data)
 {
 // need input (attr)
-	int time_lost;
+	int time_lost, rc, stable_cnt = 0;
+	uint32_t interval, max_interval;
 
 	(void) pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 	(void) pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
@@ -742,15 +789,29 @@ static void *_thread_ipmi_run(void *no_data)
 
 	flag_thread_started = true;
 
+	interval = slurm_ipmi_conf.freq;
+	max_interval = slurm_ipmi_conf.freq * BACKOFF_LIMIT;
+
 	//loop until slurm stop
 	while (!flag_energy_accounting_shutdown) {
 		time_lost = (int)(time(NULL) - last_update_time);
-		if (time_lost <= slurm_ipmi_conf.freq)
-			_task_sleep(slurm_ipmi_conf.freq - time_lost);
+		if (time_lost <= interval)
+			_task_sleep(interval - time_lost);
 		else
 			_task_sleep(1);
 		slurm_mutex_lock(&ipmi_mutex);
-		_thread_update_node_energy();
+		rc = _thread_update_node_energy();
+		/* Back off sampling while the node power draw is stable,
+		 * return to the configured frequency as soon as a reading
+		 * moves. Consumed energy accuracy is preserved since
+		 * _update_energy() integrates over the elapsed time. */
+		if ((rc == SLURM_SUCCESS) && readings_stable) {
+			if (++stable_cnt >= BACKOFF_CYCLES)
+				interval = MIN(interval * 2, max_interval);
+		} else {
+			stable_cnt = 0;
+			interval = slurm_ipmi_conf.freq;
+		}
 		slurm_mutex_unlock(&ipmi_mutex);
 	}
 
@@ -899,7 +960,8 @@ static int _get_joules_task(uint16_t delta)
 	return SLURM_SUCCESS;
 }
 
-static void _get_node_energy(acct_gather_energy_t *energy)
+static void _get_node_energy(sensor_status_t *sens,
+			     acct_gather_energy_t *energy)
 {
 	uint16_t i, j, id;
 	acct_gather_energy_t *e;
@@ -916,7 +978,7 @@ static void _get_node_energy(acct_gather_energy_t *energy)
 	memset(energy, 0, sizeof(acct_gather_energy_t));
 	for (j = 0; j < descriptions[i].sensor_cnt; ++j) {
 		id = descriptions[i].sensor_idxs[j];
-		e = &sensors[id].energy;
+		e = &sens[id].energy;
 		energy->base_consumed_energy += e->base_consumed_energy;
 		energy->base_watts += e->base_watts;
 		energy->consumed_energy += e->consumed_energy;
@@ -960,6 +1022,7 @@ extern int fini(void)
 	slurm_mutex_unlock(&ipmi_mutex);
 
 	xfree(sensors);
+	xfree(sensors_snap);
 	xfree(start_current_energies);
 
 	for (i = 0; i < descriptions_len; ++i) {
@@ -999,28 +1062,53 @@ extern int acct_gather_energy_p_get_data(enum acct_energy_type data_type,
 		} else {
 			_get_joules_task(10);
 		}
-		_get_node_energy(energy);
+		_get_node_energy(sensors, energy);
 		slurm_mutex_unlock(&ipmi_mutex);
 		break;
 	case ENERGY_DATA_NODE_ENERGY:
-		slurm_mutex_lock(&ipmi_mutex);
-		_get_node_energy(energy);
-		slurm_mutex_unlock(&ipmi_mutex);
+		/* Answer from the published snapshot so the query does
+		 * not wait for an in-progress IPMI transaction */
+		slurm_mutex_lock(&snapshot_mutex);
+		if (sensors_snap) {
+			_get_node_energy(sensors_snap, energy);
+			slurm_mutex_unlock(&snapshot_mutex);
+		} else {	/* No sampling thread in this daemon */
+			slurm_mutex_unlock(&snapshot_mutex);
+			slurm_mutex_lock(&ipmi_mutex);
+			_get_node_energy(sensors, energy);
+			slurm_mutex_unlock(&ipmi_mutex);
+		}
 		break;
 	case ENERGY_DATA_LAST_POLL:
-		slurm_mutex_lock(&ipmi_mutex);
-		*last_poll = last_update_time;
-		slurm_mutex_unlock(&ipmi_mutex);
+		slurm_mutex_lock(&snapshot_mutex);
+		if (sensors_snap) {
+			*last_poll = snap_update_time;
+			slurm_mutex_unlock(&snapshot_mutex);
+		} else {
+			slurm_mutex_unlock(&snapshot_mutex);
+			slurm_mutex_lock(&ipmi_mutex);
+			*last_poll = last_update_time;
+			slurm_mutex_unlock(&ipmi_mutex);
+		}
 		break;
 	case ENERGY_DATA_SENSOR_CNT:
 		*sensor_cnt = sensors_len;
 		break;
 	case ENERGY_DATA_STRUCT:
-		slurm_mutex_lock(&ipmi_mutex);
-		for (i = 0; i < sensors_len; ++i)
-			memcpy(&energy[i], &sensors[i].energy,
-				sizeof(acct_gather_energy_t));
-		slurm_mutex_unlock(&ipmi_mutex);
+		slurm_mutex_lock(&snapshot_mutex);
+		if (sensors_snap && (sensors_snap_len == sensors_len)) {
+			for (i = 0; i < sensors_snap_len; ++i)
+				memcpy(&energy[i], &sensors_snap[i].energy,
+					sizeof(acct_gather_energy_t));
+			slurm_mutex_unlock(&snapshot_mutex);
+		} else {
+			slurm_mutex_unlock(&snapshot_mutex);
+			slurm_mutex_lock(&ipmi_mutex);
+			for (i = 0; i < sensors_len; ++i)
+				memcpy(&energy[i], &sensors[i].energy,
+					sizeof(acct_gather_energy_t));
+			slurm_mutex_unlock(&ipmi_mutex);
+		}
 		break;
 	case ENERGY_DATA_JOULES_TASK:
 		slurm_mutex_lock(&ipmi_mutex);
@@ -87,6 +87,12 @@ typedef unsigned long int	ulong;
 #define MSR_DRAM_PERF_STATUS            0x61B
 #define MSR_DRAM_POWER_INFO             0x61C
 
+/* Reuse one MSR read pass for all consumers sampling within this many
+ * seconds. Every step on the node plus slurmd polls us; the counters
+ * only tick a few times per second so reads any closer together than
+ * this return the same energy anyway. */
+#define MSR_SAMPLE_REUSE_SEC	1
+
 union {
 	uint64_t val;
 	struct {
@@ -139,6 +145,15 @@ static char hostname[MAXHOSTNAMELEN];
 
 static int nb_pkg = 0;
 
+/* Energy Status Units from MSR_RAPL_POWER_UNIT, read once at setup
+ * (the register is constant) */
+static double energy_units = 0;
+
+/* Serializes the MSR read pass; all steps on the node share the result
+ * of the latest pass through the extended counters above */
+static pthread_mutex_t msr_lock = PTHREAD_MUTEX_INITIALIZER;
+static time_t last_sample_time = 0;
+
 extern void acct_gather_energy_p_conf_set(s_p_hashtbl_t *tbl);
 
 static char *_msr_string(int which)
@@ -155,9 +170,8 @@ static uint64_t _read_msr(int fd, int which)
 	uint64_t data = 0;
 	static bool first = true;
 
-	if (lseek(fd, which, SEEK_SET) < 0)
-		error("lseek of /dev/cpu/#/msr: %m");
-	if (read(fd, &data, sizeof(data)) != sizeof(data)) {
+	/* pread() keeps this to one syscall per register */
+	if (pread(fd, &data, sizeof(data), which) != sizeof(data)) {
 		if (which == MSR_DRAM_ENERGY_STATUS) {
 			if (first && (debug_flags & DEBUG_FLAG_ENERGY)) {
 				first = false;
@@ -207,6 +221,33 @@ static uint64_t _get_dram_energy(int pkg)
 	return(dram_energy[pkg].val);
 }
 
+/* Run one coalesced read pass over all packages and return the node
+ * total in raw energy units. The 32 bit hardware counters are extended
+ * to 64 bits here, in this single collector, so the wrap detection can
+ * not be confused by consumers sampling at different rates. A pass made
+ * within the last MSR_SAMPLE_REUSE_SEC seconds (by any step or by
+ * slurmd) is reused rather than repeated. */
+static uint64_t _sample_all_pkgs(void)
+{
+	time_t now = time(NULL);
+	uint64_t result = 0;
+	int i;
+
+	slurm_mutex_lock(&msr_lock);
+	if ((now - last_sample_time) >= MSR_SAMPLE_REUSE_SEC) {
+		for (i = 0; i < nb_pkg; i++) {
+			(void) _get_package_energy(i);
+			(void) _get_dram_energy(i);
+		}
+		last_sample_time = now;
+	}
+	for (i = 0; i < nb_pkg; i++)
+		result += package_energy[i].val + dram_energy[i].val;
+	slurm_mutex_unlock(&msr_lock);
+
+	return result;
+}
+
 static int _open_msr(int core)
 {
 	char msr_filename[BUFSIZ];
@@ -307,8 +348,6 @@ _send_drain_request(void)
 
 static void _get_joules_task(acct_gather_energy_t *energy)
 {
-	int i;
-	double energy_units;
 	uint64_t result;
 	double ret;
 
@@ -319,36 +358,7 @@ static void _get_joules_task(acct_gather_energy_t *energy)
 		return;
 	}
 
-	/* MSR_RAPL_POWER_UNIT
-	 * Power Units - bits 3:0
-	 * Energy Status Units - bits 12:8
-	 * Time Units - bits 19:16
-	 * See: Intel 64 and IA-32 Architectures Software Developer's
-	 * Manual, Volume 3 for details */
-	result = _read_msr(pkg_fd[0], MSR_RAPL_POWER_UNIT);
-	energy_units = pow(0.5, (double)((result>>8)&0x1f));
-
-	if (debug_flags & DEBUG_FLAG_ENERGY) {
-		double power_units = pow(0.5, (double)(result&0xf));
-		ulong max_power;
-
-		info("RAPL powercapture_debug Energy units = %.6f, "
-		     "Power Units = %.6f", energy_units, power_units);
-		/* MSR_PKG_POWER_INFO
-		 * Thermal Spec Power - bits 14:0
-		 * Minimum Power - bits 30:16
-		 * Maximum Power - bits 46:32
-		 * Maximum Time Window - bits 53:48
-		 * See: Intel 64 and IA-32 Architectures Software Developer's
-		 * Manual, Volume 3 for details */
-		result = _read_msr(pkg_fd[0], MSR_PKG_POWER_INFO);
-		max_power = power_units * ((result >> 32) & 0x7fff);
-		info("RAPL Max power = %ld w", max_power);
-	}
-
-	result = 0;
-	for (i = 0; i < nb_pkg; i++)
-		result += _get_package_energy(i) + _get_dram_energy(i);
+	result = _sample_all_pkgs();
 
 	ret = (double)result * energy_units;
 
@@ -570,9 +580,36 @@ extern void acct_gather_energy_p_conf_set(s_p_hashtbl_t *tbl)
 
 	local_energy = acct_gather_energy_alloc(1);
 
+	/* MSR_RAPL_POWER_UNIT
+	 * Power Units - bits 3:0
+	 * Energy Status Units - bits 12:8
+	 * Time Units - bits 19:16
+	 * See: Intel 64 and IA-32 Architectures Software Developer's
+	 * Manual, Volume 3 for details.
+	 * The register is constant, so read it once here rather than on
+	 * every sample. */
 	result = _read_msr(pkg_fd[0], MSR_RAPL_POWER_UNIT);
 	if (result == 0)
 		local_energy->current_watts = NO_VAL;
+	energy_units = pow(0.5, (double)((result>>8)&0x1f));
+
+	if (debug_flags & DEBUG_FLAG_ENERGY) {
+		double power_units = pow(0.5, (double)(result&0xf));
+		ulong max_power;
+
+		info("RAPL powercapture_debug Energy units = %.6f, "
+		     "Power Units = %.6f", energy_units, power_units);
+		/* MSR_PKG_POWER_INFO
+		 * Thermal Spec Power - bits 14:0
+		 * Minimum Power - bits 30:16
+		 * Maximum Power - bits 46:32
+		 * Maximum Time Window - bits 53:48
+		 * See: Intel 64 and IA-32 Architectures Software Developer's
+		 * Manual, Volume 3 for details */
+		result = _read_msr(pkg_fd[0], MSR_PKG_POWER_INFO);
+		max_power = power_units * ((result >> 32) & 0x7fff);
+		info("RAPL Max power = %ld w", max_power);
+	}
 
 	debug("%s loaded", plugin_name);
 
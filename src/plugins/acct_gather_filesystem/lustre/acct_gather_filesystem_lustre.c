@@ -45,6 +45,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -117,6 +118,88 @@ static pthread_mutex_t lustre_lock = PTHREAD_MUTEX_INITIALIZER;
 /* Default path to lustre stats */
 const char proc_base_path[] = "/proc/fs/lustre";
 
+/*
+ * Node level snapshot of the aggregated Lustre counters, shared between
+ * the slurmstepds running on this node.  Every stepd samples at the same
+ * profile frequency, so without sharing each of them walks the whole
+ * /proc/fs/lustre/llite tree per interval and the procfs traffic scales
+ * with steps x mounts.  The first stepd to sample an interval refreshes
+ * the snapshot, the others just copy the totals out of it; the deltas
+ * against each step's own previous values are still computed privately.
+ */
+#define LUSTRE_SHM_NAME    "/slurm_lustre_stats"
+#define LUSTRE_SHM_MAGIC   0x6c757374
+#define LUSTRE_SHM_MAX_AGE 1	/* seconds a shared snapshot stays fresh */
+
+typedef struct {
+	uint32_t magic;
+	time_t update_time;
+	uint64_t nb_reads;
+	uint64_t nb_writes;
+	uint64_t read_bytes;
+	uint64_t write_bytes;
+} lustre_shm_snap_t;
+
+static lustre_shm_snap_t *lustre_shm = NULL;
+static int lustre_shm_fd = -1;
+
+static int _shm_attach(void)
+{
+	if (lustre_shm)
+		return SLURM_SUCCESS;
+
+	lustre_shm_fd = shm_open(LUSTRE_SHM_NAME, O_CREAT | O_RDWR, 0600);
+	if (lustre_shm_fd < 0) {
+		debug2("%s: shm_open(%s): %m", __func__, LUSTRE_SHM_NAME);
+		return SLURM_FAILURE;
+	}
+	if (ftruncate(lustre_shm_fd, sizeof(lustre_shm_snap_t)) < 0) {
+		debug2("%s: ftruncate(%s): %m", __func__, LUSTRE_SHM_NAME);
+		close(lustre_shm_fd);
+		lustre_shm_fd = -1;
+		return SLURM_FAILURE;
+	}
+	lustre_shm = mmap(NULL, sizeof(lustre_shm_snap_t),
+			  PROT_READ | PROT_WRITE, MAP_SHARED,
+			  lustre_shm_fd, 0);
+	if (lustre_shm == MAP_FAILED) {
+		debug2("%s: mmap(%s): %m", __func__, LUSTRE_SHM_NAME);
+		lustre_shm = NULL;
+		close(lustre_shm_fd);
+		lustre_shm_fd = -1;
+		return SLURM_FAILURE;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static void _shm_detach(void)
+{
+	if (lustre_shm) {
+		munmap(lustre_shm, sizeof(lustre_shm_snap_t));
+		lustre_shm = NULL;
+	}
+	if (lustre_shm_fd >= 0) {
+		close(lustre_shm_fd);
+		lustre_shm_fd = -1;
+	}
+}
+
+/* Serialize snapshot access between the stepds with a record lock on
+ * the shared memory object.  The lock goes away with the process, so a
+ * dying collector can not wedge the other samplers. */
+static void _shm_lock(int type)
+{
+	struct flock fl;
+
+	memset(&fl, 0, sizeof(fl));
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	while ((fcntl(lustre_shm_fd, F_SETLKW, &fl) < 0) &&
+	       (errno == EINTR))
+		;
+}
+
 /**
  *  is lustre fs supported
  **/
@@ -261,6 +344,51 @@ static int _read_lustre_counters(void)
 	return SLURM_SUCCESS;
 }
 
+/* _get_lustre_counters()
+ * Fill in lustre_se with the node wide totals, from the shared snapshot
+ * when another stepd already walked the stats tree this interval, or by
+ * walking it ourselves (and publishing the result) otherwise.
+ */
+static int _get_lustre_counters(void)
+{
+	time_t now = time(NULL);
+	int rc;
+
+	if (_shm_attach() != SLURM_SUCCESS) {
+		/* no shared snapshot available, walk privately */
+		return _read_lustre_counters();
+	}
+
+	_shm_lock(F_WRLCK);
+	if ((lustre_shm->magic == LUSTRE_SHM_MAGIC) &&
+	    (difftime(now, lustre_shm->update_time) >= 0) &&
+	    (difftime(now, lustre_shm->update_time) <= LUSTRE_SHM_MAX_AGE)) {
+		lustre_se.all_lustre_nb_reads = lustre_shm->nb_reads;
+		lustre_se.all_lustre_nb_writes = lustre_shm->nb_writes;
+		lustre_se.all_lustre_read_bytes = lustre_shm->read_bytes;
+		lustre_se.all_lustre_write_bytes = lustre_shm->write_bytes;
+		lustre_se.last_update_time = lustre_se.update_time;
+		lustre_se.update_time = now;
+		_shm_lock(F_UNLCK);
+		debug3("%s: using shared snapshot from %ld",
+		       __func__, (long) lustre_shm->update_time);
+		return SLURM_SUCCESS;
+	}
+
+	rc = _read_lustre_counters();
+	if (rc == SLURM_SUCCESS) {
+		lustre_shm->nb_reads = lustre_se.all_lustre_nb_reads;
+		lustre_shm->nb_writes = lustre_se.all_lustre_nb_writes;
+		lustre_shm->read_bytes = lustre_se.all_lustre_read_bytes;
+		lustre_shm->write_bytes = lustre_se.all_lustre_write_bytes;
+		lustre_shm->update_time = lustre_se.update_time;
+		lustre_shm->magic = LUSTRE_SHM_MAGIC;
+	}
+	_shm_lock(F_UNLCK);
+
+	return rc;
+}
+
 
 
 
@@ -298,7 +426,7 @@ static int _update_node_filesystem(void)
 
 	slurm_mutex_lock(&lustre_lock);
 
-	if (_read_lustre_counters() != SLURM_SUCCESS) {
+	if (_get_lustre_counters() != SLURM_SUCCESS) {
 		error("%s: Cannot read lustre counters", __func__);
 		slurm_mutex_unlock(&lustre_lock);
 		return SLURM_FAILURE;
@@ -390,6 +518,10 @@ extern int fini(void)
 	if (!_run_in_daemon())
 		return SLURM_SUCCESS;
 
+	/* The shared memory object itself is left in place for the
+	 * other stepds still sampling on this node. */
+	_shm_detach();
+
 	if (debug_flags & DEBUG_FLAG_FILESYSTEM)
 		info("lustre: ended");
 
@@ -44,6 +44,7 @@
  *  Copyright (C) 2002 The Regents of the University of California.
 \*****************************************************************************/
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -103,11 +104,19 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 typedef struct {
 	char *dir;
 	uint32_t def;
+	uint32_t buffered_samples;
 } slurm_hdf5_conf_t;
 
 typedef struct {
 	hid_t  table_id;
 	size_t type_size;
+	/* Double buffered sample aggregation for the writer thread.
+	 * The sampling thread fills buf[active] while the writer
+	 * thread appends the other buffer to the table. */
+	uint8_t *buf[2];
+	size_t   buf_cnt[2];
+	int      active;
+	bool     pending;
 } table_t;
 
 // Global HDF5 Variables
@@ -133,10 +142,21 @@ static table_t *tables = NULL;
 static size_t   tables_max_len = 0;
 static size_t   tables_cur_len = 0;
 
+/* Writer thread draining the inactive buffers.  HDF5 is not thread
+ * safe, so once the writer is running all H5PTappend calls are made
+ * from it alone and the sampling thread only copies records around. */
+static pthread_t       writer_thread_id = 0;
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  writer_drain_cond = PTHREAD_COND_INITIALIZER;
+static bool writer_running = false;
+static bool writer_shutdown = false;
+
 static void _reset_slurm_profile_conf(void)
 {
 	xfree(hdf5_conf.dir);
 	hdf5_conf.def = ACCT_GATHER_PROFILE_NONE;
+	hdf5_conf.buffered_samples = 1;
 }
 
 static uint32_t _determine_profile(void)
@@ -211,6 +231,87 @@ static bool _run_in_daemon(void)
 	return run;
 }
 
+/* Append the given buffer of a table to its dataset and mark it empty.
+ * writer_mutex must be held by the caller; the append itself is done
+ * unlocked so the sampling thread keeps filling the other buffer. */
+static void _flush_table_buf(table_t *ds, int idx)
+{
+	size_t cnt = ds->buf_cnt[idx];
+
+	if (cnt == 0)
+		return;
+
+	slurm_mutex_unlock(&writer_mutex);
+	if (H5PTappend(ds->table_id, cnt, ds->buf[idx]) < 0)
+		error("PROFILE: Impossible to add %zu buffered samples to "
+		      "the table %d", cnt, (int) (ds - tables));
+	slurm_mutex_lock(&writer_mutex);
+	ds->buf_cnt[idx] = 0;
+}
+
+static void *_writer_thread(void *no_data)
+{
+	size_t i;
+
+	slurm_mutex_lock(&writer_mutex);
+	while (!writer_shutdown) {
+		bool found = false;
+		for (i = 0; i < tables_cur_len; ++i) {
+			table_t *ds = &tables[i];
+			if (!ds->pending)
+				continue;
+			found = true;
+			_flush_table_buf(ds, 1 - ds->active);
+			ds->pending = false;
+			pthread_cond_broadcast(&writer_drain_cond);
+		}
+		if (!found && !writer_shutdown)
+			pthread_cond_wait(&writer_cond, &writer_mutex);
+	}
+	/* drain whatever is left so node_step_end only has to close */
+	for (i = 0; i < tables_cur_len; ++i) {
+		table_t *ds = &tables[i];
+		_flush_table_buf(ds, 1 - ds->active);
+		_flush_table_buf(ds, ds->active);
+		ds->pending = false;
+	}
+	slurm_mutex_unlock(&writer_mutex);
+
+	return NULL;
+}
+
+static void _writer_start(void)
+{
+	pthread_attr_t attr;
+
+	if (writer_running || (hdf5_conf.buffered_samples <= 1))
+		return;
+
+	writer_shutdown = false;
+	slurm_attr_init(&attr);
+	if (pthread_create(&writer_thread_id, &attr, &_writer_thread, NULL)) {
+		error("PROFILE: failed to create the writer thread, "
+		      "falling back to synchronous writes: %m");
+		writer_thread_id = 0;
+	} else
+		writer_running = true;
+	slurm_attr_destroy(&attr);
+}
+
+static void _writer_stop(void)
+{
+	if (!writer_running)
+		return;
+
+	slurm_mutex_lock(&writer_mutex);
+	writer_shutdown = true;
+	pthread_cond_signal(&writer_cond);
+	slurm_mutex_unlock(&writer_mutex);
+	pthread_join(writer_thread_id, NULL);
+	writer_thread_id = 0;
+	writer_running = false;
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
@@ -231,6 +332,13 @@ extern int init(void)
 
 extern int fini(void)
 {
+	size_t i;
+
+	_writer_stop();
+	for (i = 0; i < tables_cur_len; ++i) {
+		xfree(tables[i].buf[0]);
+		xfree(tables[i].buf[1]);
+	}
 	xfree(tables);
 	xfree(groups);
 	xfree(hdf5_conf.dir);
@@ -243,6 +351,7 @@ extern void acct_gather_profile_p_conf_options(s_p_options_t **full_options,
 	s_p_options_t options[] = {
 		{"ProfileHDF5Dir", S_P_STRING},
 		{"ProfileHDF5Default", S_P_STRING},
+		{"ProfileHDF5BufferedSamples", S_P_UINT32},
 		{NULL} };
 
 	transfer_s_p_options(full_options, options, full_options_cnt);
@@ -265,6 +374,11 @@ extern void acct_gather_profile_p_conf_set(s_p_hashtbl_t *tbl)
 			}
 			xfree(tmp);
 		}
+
+		s_p_get_uint32(&hdf5_conf.buffered_samples,
+			       "ProfileHDF5BufferedSamples", tbl);
+		if (hdf5_conf.buffered_samples < 1)
+			hdf5_conf.buffered_samples = 1;
 	}
 
 	if (!hdf5_conf.dir)
@@ -376,6 +490,8 @@ extern int acct_gather_profile_p_node_step_start(stepd_step_rec_t* job)
 	put_string_attribute(gid_node, ATTR_STARTTIME,
 			     slurm_ctime2(&step_start_time));
 
+	_writer_start();
+
 	return rc;
 }
 
@@ -414,9 +530,14 @@ extern int acct_gather_profile_p_node_step_end(void)
 	if (debug_flags & DEBUG_FLAG_PROFILE)
 		info("PROFILE: node_step_end (shutdown)");
 
+	/* let the writer thread drain the buffered samples and exit */
+	_writer_stop();
+
 	/* close tables */
 	for (i = 0; i < tables_cur_len; ++i) {
 		H5PTclose(tables[i].table_id);
+		xfree(tables[i].buf[0]);
+		xfree(tables[i].buf[1]);
 	}
 	/* close groups */
 	for (i = 0; i < groups_len; ++i) {
@@ -560,6 +681,10 @@ extern int acct_gather_profile_p_create_dataset(
 	}
 	H5Tclose(dtype_id); /* close the datatype since H5PT keeps a copy */
 
+	/* the writer thread walks the tables array, keep it out while
+	 * the array is reallocated or extended */
+	slurm_mutex_lock(&writer_mutex);
+
 	/* resize the tables array if full */
 	if (tables_cur_len == tables_max_len) {
 		if (tables_max_len == 0)
@@ -569,10 +694,19 @@ extern int acct_gather_profile_p_create_dataset(
 	}
 
 	/* reserve a new table */
+	memset(&tables[tables_cur_len], 0, sizeof(table_t));
 	tables[tables_cur_len].table_id  = table_id;
 	tables[tables_cur_len].type_size = type_size;
+	if (writer_running) {
+		tables[tables_cur_len].buf[0] =
+			xmalloc(hdf5_conf.buffered_samples * type_size);
+		tables[tables_cur_len].buf[1] =
+			xmalloc(hdf5_conf.buffered_samples * type_size);
+	}
 	++tables_cur_len;
 
+	slurm_mutex_unlock(&writer_mutex);
+
 	return tables_cur_len - 1;
 }
 
@@ -611,6 +745,27 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 
 	memcpy(send_data + header_size, data, ds->type_size - header_size);
 
+	if (writer_running && ds->buf[0]) {
+		/* hand the record over to the writer thread; the only
+		 * cost left on the sampling thread is the memcpy */
+		slurm_mutex_lock(&writer_mutex);
+		memcpy(ds->buf[ds->active] +
+		       (ds->buf_cnt[ds->active] * ds->type_size),
+		       send_data, ds->type_size);
+		if (++ds->buf_cnt[ds->active] >= hdf5_conf.buffered_samples) {
+			/* wait for the writer if it is still behind on
+			 * the other buffer, then swap and kick it */
+			while (ds->pending)
+				pthread_cond_wait(&writer_drain_cond,
+						  &writer_mutex);
+			ds->pending = true;
+			ds->active = 1 - ds->active;
+			pthread_cond_signal(&writer_cond);
+		}
+		slurm_mutex_unlock(&writer_mutex);
+		return SLURM_SUCCESS;
+	}
+
 	/* append the record to the table */
 	if (H5PTappend(ds->table_id, 1, send_data) < 0) {
 		error("PROFILE: Impossible to add data to the table %d; "
@@ -637,6 +792,11 @@ extern void acct_gather_profile_p_conf_values(List *data)
 	key_pair->value = xstrdup(acct_gather_profile_to_string(hdf5_conf.def));
 	list_append(*data, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("ProfileHDF5BufferedSamples");
+	key_pair->value = xstrdup_printf("%u", hdf5_conf.buffered_samples);
+	list_append(*data, key_pair);
+
 	return;
 
 }
@@ -89,6 +89,19 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 static int plugin_errno = SLURM_SUCCESS;
 static int bad_cred_test = -1;
 
+/* Per-thread munge context, created on first use and kept for the
+ * lifetime of the thread instead of one context per message */
+static pthread_key_t ctx_key;
+static pthread_once_t ctx_key_once = PTHREAD_ONCE_INIT;
+
+/* Optional encoded credential reuse window (AuthInfo "cred_reuse=N"
+ * seconds).  Within the window one encoded credential authenticates
+ * multiple messages, the same tolerance message forwarding already
+ * relies on, which cuts munged round trips during agent fan-outs. */
+static pthread_mutex_t cred_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *cred_cache_str = NULL;
+static time_t cred_cache_time = 0;
+
 
 enum {
 	SLURM_AUTH_UNPACK = SLURM_AUTH_FIRST_LOCAL_ERROR
@@ -127,6 +140,8 @@ typedef struct munge_info {
  */
 
 static char *         _auth_opts_to_socket(char *opts);
+static int            _auth_opts_to_reuse(char *opts);
+static munge_ctx_t    _get_thread_ctx(void);
 static munge_info_t * cred_info_alloc(void);
 static munge_info_t * cred_info_create(munge_ctx_t ctx);
 static void           cred_info_destroy(munge_info_t *);
@@ -158,12 +173,13 @@ int init ( void )
 slurm_auth_credential_t *
 slurm_auth_create( void *argv[], char *opts )
 {
-	int rc, retry = RETRY_COUNT, auth_ttl;
+	int rc, retry = RETRY_COUNT, auth_ttl, cred_reuse;
 	slurm_auth_credential_t *cred = NULL;
 	munge_err_t err = EMUNGE_SUCCESS;
-	munge_ctx_t ctx = munge_ctx_create();
+	munge_ctx_t ctx = _get_thread_ctx();
 	SigFunc *ohandler;
 	char *socket;
+	time_t now;
 
 	if (ctx == NULL) {
 		error("munge_ctx_create failure");
@@ -188,7 +204,6 @@ slurm_auth_create( void *argv[], char *opts )
 		xfree(socket);
 		if (rc != EMUNGE_SUCCESS) {
 			error("munge_ctx_set failure");
-			munge_ctx_destroy(ctx);
 			return NULL;
 		}
 	}
@@ -197,6 +212,12 @@ slurm_auth_create( void *argv[], char *opts )
 	if (auth_ttl)
 		(void) munge_ctx_set(ctx, MUNGE_OPT_TTL, auth_ttl);
 
+	/* The reuse window has to stay well inside the credential TTL
+	   so a reused credential can not expire in flight. */
+	cred_reuse = _auth_opts_to_reuse(opts);
+	if (auth_ttl && (cred_reuse > (auth_ttl / 2)))
+		cred_reuse = auth_ttl / 2;
+
 	cred = xmalloc(sizeof(*cred));
 	cred->verified = false;
 	cred->m_str    = NULL;
@@ -206,6 +227,20 @@ slurm_auth_create( void *argv[], char *opts )
 
 	xassert(cred->magic = MUNGE_MAGIC);
 
+	if (cred_reuse > 0) {
+		now = time(NULL);
+		slurm_mutex_lock(&cred_cache_lock);
+		if (cred_cache_str &&
+		    (difftime(now, cred_cache_time) < cred_reuse)) {
+			/* handed out copy is freed with free() */
+			cred->m_str = strdup(cred_cache_str);
+			slurm_mutex_unlock(&cred_cache_lock);
+			if (cred->m_str)
+				return cred;
+		} else
+			slurm_mutex_unlock(&cred_cache_lock);
+	}
+
 	/*
 	 *  Temporarily block SIGALARM to avoid misleading
 	 *    "Munged communication error" from libmunge if we
@@ -232,12 +267,16 @@ slurm_auth_create( void *argv[], char *opts )
 	} else if ((bad_cred_test > 0) && cred->m_str) {
 		int i = ((int) time(NULL)) % strlen(cred->m_str);
 		cred->m_str[i]++;	/* random position in credential */
+	} else if ((cred_reuse > 0) && cred->m_str) {
+		slurm_mutex_lock(&cred_cache_lock);
+		xfree(cred_cache_str);
+		cred_cache_str = xstrdup(cred->m_str);
+		cred_cache_time = time(NULL);
+		slurm_mutex_unlock(&cred_cache_lock);
 	}
 
 	xsignal(SIGALRM, ohandler);
 
-	munge_ctx_destroy(ctx);
-
 	return cred;
 }
 
@@ -512,14 +551,13 @@ _decode_cred(slurm_auth_credential_t *c, char *socket)
 	if (c->verified)
 		return SLURM_SUCCESS;
 
-	if ((ctx = munge_ctx_create()) == NULL) {
+	if ((ctx = _get_thread_ctx()) == NULL) {
 		error("munge_ctx_create failure");
 		return SLURM_ERROR;
 	}
 	if (socket &&
 	    (munge_ctx_set(ctx, MUNGE_OPT_SOCKET, socket) != EMUNGE_SUCCESS)) {
 		error("munge_ctx_set failure");
-		munge_ctx_destroy(ctx);
 		return SLURM_ERROR;
 	}
 
@@ -569,7 +607,6 @@ _decode_cred(slurm_auth_credential_t *c, char *socket)
 	c->verified = true;
 
      done:
-	munge_ctx_destroy(ctx);
 	return err ? SLURM_ERROR : SLURM_SUCCESS;
 }
 
@@ -681,3 +718,46 @@ static char *_auth_opts_to_socket(char *opts)
 
 	return socket;
 }
+
+/* parse the credential reuse window in seconds from the plugin options
+ * (AuthInfo "cred_reuse=N"), 0 (disabled) if not configured */
+static int _auth_opts_to_reuse(char *opts)
+{
+	char *tmp;
+
+	if (opts && (tmp = strstr(opts, "cred_reuse=")))
+		return atoi(tmp + 11);
+
+	return 0;
+}
+
+static void _ctx_destroy(void *arg)
+{
+	munge_ctx_destroy((munge_ctx_t) arg);
+}
+
+static void _ctx_key_create(void)
+{
+	if (pthread_key_create(&ctx_key, _ctx_destroy))
+		error("pthread_key_create failure: %m");
+}
+
+/* Return this thread's munge context, creating it on first use.  The
+ * context is destroyed when the thread exits, so encode/decode stops
+ * paying a context create/destroy per message.  Options (socket, TTL)
+ * are re-applied by the callers on every use. */
+static munge_ctx_t _get_thread_ctx(void)
+{
+	munge_ctx_t ctx;
+
+	pthread_once(&ctx_key_once, _ctx_key_create);
+	if (!(ctx = (munge_ctx_t) pthread_getspecific(ctx_key))) {
+		ctx = munge_ctx_create();
+		if (ctx && pthread_setspecific(ctx_key, ctx)) {
+			error("pthread_setspecific failure: %m");
+			munge_ctx_destroy(ctx);
+			ctx = NULL;
+		}
+	}
+	return ctx;
+}
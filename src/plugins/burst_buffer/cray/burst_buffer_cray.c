@@ -178,6 +178,16 @@ typedef struct {
 	uint32_t user_id;
 } stage_args_t;
 
+/* State poller queries, fetched by worker threads in _load_state() */
+#define POLL_FETCH_INSTANCES	1
+#define POLL_FETCH_SESSIONS	2
+typedef struct poll_fetch_args {
+	int type;		/* POLL_FETCH_* query to run */
+	uint32_t timeout;	/* Job state timeout, in msec */
+	void *ents;		/* Parsed records, type dependent */
+	int num_ent;		/* Count of parsed records */
+} poll_fetch_args_t;
+
 typedef struct create_buf_data {
 	char *access;		/* Access mode */
 	bool hurry;		/* Set to destroy in a hurry (no stage-out) */
@@ -247,6 +257,7 @@ static void	_parse_config_links(json_object *instance, bb_configs_t *ent);
 static void	_parse_instance_capacity(json_object *instance,
 					 bb_instances_t *ent);
 static void	_pick_alloc_account(bb_alloc_t *bb_alloc);
+static void *	_poll_fetch_thread(void *x);
 static void	_purge_bb_files(uint32_t job_id, struct job_record *job_ptr);
 static void	_purge_vestigial_bufs(void);
 static void	_python2json(char *buf);
@@ -1085,6 +1096,22 @@ static void _set_assoc_mgr_ptrs(bb_alloc_t *bb_alloc)
 	assoc_mgr_unlock(&assoc_locks);
 }
 
+/* Worker for _load_state(): run one dw_wlm_cli query and parse its JSON
+ * response with no locks held */
+static void *_poll_fetch_thread(void *x)
+{
+	poll_fetch_args_t *args = x;
+
+	if (args->type == POLL_FETCH_INSTANCES) {
+		args->ents = _bb_get_instances(&args->num_ent, &bb_state,
+					       args->timeout);
+	} else if (args->type == POLL_FETCH_SESSIONS) {
+		args->ents = _bb_get_sessions(&args->num_ent, &bb_state,
+					      args->timeout);
+	}
+	return NULL;
+}
+
 /*
  * Determine the current actual burst buffer state.
  */
@@ -1106,6 +1133,10 @@ static void _load_state(bool init_config)
 	assoc_mgr_lock_t assoc_locks = { READ_LOCK, NO_LOCK, READ_LOCK, NO_LOCK,
 					 NO_LOCK, NO_LOCK, NO_LOCK };
 	bool found_pool;
+	pthread_attr_t attr;
+	pthread_t inst_tid = 0, sess_tid = 0;
+	poll_fetch_args_t inst_args, sess_args;
+	bool inst_thread = false, sess_thread = false;
 
 	slurm_mutex_lock(&bb_state.bb_mutex);
 	if (bb_state.bb_config.other_timeout)
@@ -1115,12 +1146,46 @@ static void _load_state(bool init_config)
 	slurm_mutex_unlock(&bb_state.bb_mutex);
 
 	/*
-	 * Load the pools information
+	 * Fetch the pools, instances and sessions information in parallel,
+	 * so one refresh costs the slowest single dw_wlm_cli query rather
+	 * than the sum of all of them. The workers run the commands and
+	 * parse the JSON responses with no locks held. The results are
+	 * applied below under bb_mutex.
 	 */
+	memset(&inst_args, 0, sizeof(inst_args));
+	inst_args.type = POLL_FETCH_INSTANCES;
+	inst_args.timeout = timeout;
+	memset(&sess_args, 0, sizeof(sess_args));
+	sess_args.type = POLL_FETCH_SESSIONS;
+	sess_args.timeout = timeout;
+	slurm_attr_init(&attr);
+	if (pthread_create(&inst_tid, &attr, _poll_fetch_thread, &inst_args)) {
+		error("%s: pthread_create: %m", __func__);
+		_poll_fetch_thread(&inst_args);	/* Fetch in-line */
+	} else
+		inst_thread = true;
+	if (pthread_create(&sess_tid, &attr, _poll_fetch_thread, &sess_args)) {
+		error("%s: pthread_create: %m", __func__);
+		_poll_fetch_thread(&sess_args);	/* Fetch in-line */
+	} else
+		sess_thread = true;
+	slurm_attr_destroy(&attr);
+
 	pools = _bb_get_pools(&num_pools, &bb_state, timeout);
+	if (inst_thread)
+		pthread_join(inst_tid, NULL);
+	if (sess_thread)
+		pthread_join(sess_tid, NULL);
+	instances = inst_args.ents;
+	num_instances = inst_args.num_ent;
+	sessions = sess_args.ents;
+	num_sessions = sess_args.num_ent;
+
 	if (pools == NULL) {
 		error("%s: failed to find DataWarp entries, what now?",
 		      __func__);
+		_bb_free_sessions(sessions, num_sessions);
+		_bb_free_instances(instances, num_instances);
 		return;
 	}
 
@@ -1185,14 +1250,10 @@ static void _load_state(bool init_config)
 	_bb_free_pools(pools, num_pools);
 
 	/*
-	 * Load the instances information
+	 * Apply the instances and sessions information
 	 */
-	instances = _bb_get_instances(&num_instances, &bb_state, timeout);
-	if (instances == NULL) {
+	if (instances == NULL)
 		info("%s: failed to find DataWarp instances", __func__);
-		num_instances = 0;	/* Redundant, but fixes CLANG bug */
-	}
-	sessions = _bb_get_sessions(&num_sessions, &bb_state, timeout);
 	slurm_mutex_lock(&bb_state.bb_mutex);
 	assoc_mgr_lock(&assoc_locks);
 	bb_state.last_load_time = time(NULL);
@@ -94,6 +94,13 @@ struct ckpt_req {
 	uint16_t sig_done;
 };
 
+struct ckpt_reap {
+	uint32_t jobid;
+	uint32_t stepid;
+	int ntasks;
+	pid_t *children;
+};
+
 static void _send_sig(uint32_t job_id, uint32_t step_id, uint16_t signal,
 		      char *nodelist);
 static void *_ckpt_agent_thr(void *arg);
@@ -438,6 +445,31 @@ extern int slurm_ckpt_stepd_prefork(stepd_step_rec_t *job)
 	return SLURM_SUCCESS;
 }
 
+/* Reap the cr_checkpoint helpers in the background. The image dump can
+ * take minutes for a large memory footprint and must not stall the
+ * stepd request handler, which holds the suspend mutex while the
+ * checkpoint request is being processed. */
+static void *_ckpt_reap_thr(void *arg)
+{
+	struct ckpt_reap *reap = (struct ckpt_reap *)arg;
+	int i, status;
+
+	for (i = 0; i < reap->ntasks; i++) {
+		if (reap->children[i] == 0)
+			continue;
+		while ((waitpid(reap->children[i], &status, 0) < 0) &&
+		       (errno == EINTR));
+		if (!(WIFEXITED(status) && (WEXITSTATUS(status) == 0))) {
+			error("checkpoint/blcr: checkpoint of task %d "
+			      "of job %u.%u failed",
+			      i, reap->jobid, reap->stepid);
+		}
+	}
+	xfree(reap->children);
+	xfree(reap);
+	return NULL;
+}
+
 extern int slurm_ckpt_signal_tasks(stepd_step_rec_t *job, char *image_dir)
 {
 	char *argv[4];
@@ -530,10 +562,39 @@ extern int slurm_ckpt_signal_tasks(stepd_step_rec_t *job, char *image_dir)
 	for (i = 0; i < job->node_tasks; i ++) {
 		if (fd[i*2+1] >= 0) {
 			while(write(fd[i*2+1], &c, 1) < 0 && errno == EINTR);
+			close(fd[i*2+1]);
 		}
 	}
-	/* wait children in sequence is OK */
-	for (i = 0; i < job->node_tasks; i ++) {
+
+	if (rc == SLURM_SUCCESS) {
+		/* All helpers are launched and released. Reap them in a
+		 * background thread so the step is not stalled for the
+		 * duration of the image dump. */
+		struct ckpt_reap *reap = xmalloc(sizeof(struct ckpt_reap));
+		pthread_attr_t attr;
+		pthread_t reap_tid;
+
+		reap->jobid = job->jobid;
+		reap->stepid = job->stepid;
+		reap->ntasks = job->node_tasks;
+		reap->children = children;
+		children = NULL;
+
+		slurm_attr_init(&attr);
+		if (pthread_attr_setdetachstate(&attr,
+						PTHREAD_CREATE_DETACHED))
+			error("pthread_attr_setdetachstate: %m");
+		if (pthread_create(&reap_tid, &attr, _ckpt_reap_thr, reap)) {
+			error("pthread_create: %m");
+			children = reap->children;
+			xfree(reap);
+		}
+		slurm_attr_destroy(&attr);
+	}
+
+	/* Reap in line on launch failure, or if no reaper thread could
+	 * be created */
+	for (i = 0; children && (i < job->node_tasks); i ++) {
 		if (children[i] == 0)
 			continue;
 		while(waitpid(children[i], &status, 0) < 0 && errno == EINTR);
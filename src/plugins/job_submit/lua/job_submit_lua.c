@@ -95,17 +95,41 @@ const uint32_t plugin_version   = SLURM_VERSION_NUMBER;
 
 static const char lua_script_path[] = DEFAULT_SCRIPT_DIR "/job_submit.lua";
 static time_t lua_script_last_loaded = (time_t) 0;
-static lua_State *L = NULL;
-static char *user_msg = NULL;
 
-time_t last_lua_jobs_update = (time_t) 0;
-time_t last_lua_resv_update = (time_t) 0;
+/* Number of interpreters kept ready, bounding how many job submissions
+ * can run the script concurrently */
+#define LUA_STATE_POOL_SIZE 4
+
+/* Registry key under which each interpreter stores a pointer to its
+ * pool entry, so that script callbacks (e.g. slurm.user_msg) can find
+ * per-interpreter data */
+#define LUA_POOL_ENTRY_KEY "slurm_job_submit_pool_entry"
+
+typedef struct lua_pool_entry {
+	lua_State *L;		/* interpreter with the script loaded */
+	bool busy;		/* leased to a hook currently running */
+	time_t loaded;		/* when this interpreter loaded the script,
+				 * rebuilt when older than the compiled
+				 * script image */
+	time_t jobs_update;	/* last rebuild of the "jobs" global */
+	time_t resvs_update;	/* last rebuild of the "reservations"
+				 * global */
+	char *user_msg;		/* messages from slurm.user_msg() */
+} lua_pool_entry_t;
+
+static lua_pool_entry_t lua_state_pool[LUA_STATE_POOL_SIZE];
+
+/* The script compiled to byte code once, loaded into each interpreter */
+static char *lua_script_image = NULL;
+static size_t lua_script_image_size = 0;
 
 /*
- *  Mutex for protecting multi-threaded access to this plugin.
- *   (Only 1 thread at a time should be in here)
+ *  Mutex for protecting the state pool and compiled script image. Held
+ *   only while leasing or returning an interpreter, not while the
+ *   script runs, so submissions no longer serialize on one interpreter.
  */
 static pthread_mutex_t lua_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lua_cond = PTHREAD_COND_INITIALIZER;
 
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined.  They will get
@@ -209,9 +233,16 @@ static int _log_lua_error (lua_State *L)
 static int _log_lua_user_msg (lua_State *L)
 {
 	const char *msg = lua_tostring(L, -1);
+	lua_pool_entry_t *entry;
 
-	xfree(user_msg);
-	user_msg = xstrdup(msg);
+	lua_getfield(L, LUA_REGISTRYINDEX, LUA_POOL_ENTRY_KEY);
+	entry = (lua_pool_entry_t *) lua_touserdata(L, -1);
+	lua_pop(L, 1);
+	if (!entry)
+		return (0);
+
+	xfree(entry->user_msg);
+	entry->user_msg = xstrdup(msg);
 	return (0);
 }
 
@@ -275,7 +306,8 @@ static char *_get_default_qos(uint32_t user_id, char *account, char *partition)
  * This is an incomplete list of job record fields. Add more as needed and
  * send patches to slurm-dev@schedmd.com.
  */
-static int _job_rec_field(const struct job_record *job_ptr,
+static int _job_rec_field(lua_State *L,
+                          const struct job_record *job_ptr,
                           const char *name)
 {
 	int i;
@@ -382,17 +414,18 @@ static int _job_rec_field_index(lua_State *L)
 	lua_getfield(L, -1, "_job_rec_ptr");
 	job_ptr = lua_touserdata(L, -1);
 
-	return _job_rec_field(job_ptr, name);
+	return _job_rec_field(L, job_ptr, name);
 }
 
 /* Get the list of existing slurmctld job records. */
-static void _update_jobs_global(void)
+static void _update_jobs_global(lua_pool_entry_t *entry)
 {
 	char job_id_buf[11]; /* Big enough for a uint32_t */
 	ListIterator iter;
 	struct job_record *job_ptr;
+	lua_State *L = entry->L;
 
-	if (last_lua_jobs_update >= last_job_update) {
+	if (entry->jobs_update >= last_job_update) {
 		return;
 	}
 
@@ -421,14 +454,14 @@ static void _update_jobs_global(void)
 		         "%d", job_ptr->job_id);
 		lua_setfield(L, -2, job_id_buf);
 	}
-	last_lua_jobs_update = last_job_update;
+	entry->jobs_update = last_job_update;
 	list_iterator_destroy(iter);
 
 	lua_setfield(L, -2, "jobs");
 	lua_pop(L, 1);
 }
 
-static int _resv_field(const slurmctld_resv_t *resv_ptr,
+static int _resv_field(lua_State *L, const slurmctld_resv_t *resv_ptr,
                        const char *name)
 {
 	if (resv_ptr == NULL) {
@@ -483,16 +516,17 @@ static int _resv_field_index(lua_State *L)
 	lua_getfield(L, -1, "_resv_ptr");
 	resv_ptr = lua_touserdata(L, -1);
 
-	return _resv_field(resv_ptr, name);
+	return _resv_field(L, resv_ptr, name);
 }
 
 /* Get the list of existing slurmctld reservation records. */
-static void _update_resvs_global(void)
+static void _update_resvs_global(lua_pool_entry_t *entry)
 {
 	ListIterator iter;
 	slurmctld_resv_t *resv_ptr;
+	lua_State *L = entry->L;
 
-	if (last_lua_resv_update >= last_resv_update) {
+	if (entry->resvs_update >= last_resv_update) {
 		return;
 	}
 
@@ -518,7 +552,7 @@ static void _update_resvs_global(void)
 
 		lua_setfield(L, -2, resv_ptr->name);
 	}
-	last_lua_resv_update = last_resv_update;
+	entry->resvs_update = last_resv_update;
 	list_iterator_destroy(iter);
 
 	lua_setfield(L, -2, "reservations");
@@ -568,7 +602,8 @@ static int _set_job_env_field(lua_State *L)
 	return 0;
 }
 
-static int _job_env_field(const struct job_descriptor *job_desc,
+static int _job_env_field(lua_State *L,
+			  const struct job_descriptor *job_desc,
 			  const char *name)
 {
 	char *name_eq = "";
@@ -605,7 +640,7 @@ static int _get_job_env_field_name(lua_State *L)
 {
 	const struct job_descriptor *job_desc = lua_touserdata(L, 1);
 	const char *name = luaL_checkstring(L, 2);
-	return _job_env_field(job_desc, name);
+	return _job_env_field(L, job_desc, name);
 }
 
 /* Get fields in an existing slurmctld job_descriptor record */
@@ -618,10 +653,10 @@ static int _job_env_field_index(lua_State *L)
 	lua_getmetatable(L, -2);
 	lua_getfield(L, -1, "_job_desc");
 	job_desc = lua_touserdata(L, -1);
-	return _job_env_field(job_desc, name);
+	return _job_env_field(L, job_desc, name);
 }
 
-static void _push_job_env(struct job_descriptor *job_desc)
+static void _push_job_env(lua_State *L, struct job_descriptor *job_desc)
 {
 	lua_newtable(L);
 
@@ -638,7 +673,8 @@ static void _push_job_env(struct job_descriptor *job_desc)
 	lua_setmetatable(L, -2);
 }
 
-static int _get_job_req_field(const struct job_descriptor *job_desc,
+static int _get_job_req_field(lua_State *L,
+			      const struct job_descriptor *job_desc,
 			      const char *name)
 {
 	int i;
@@ -687,7 +723,7 @@ static int _get_job_req_field(const struct job_descriptor *job_desc,
 	} else if (!xstrcmp(name, "end_time")) {
 		lua_pushnumber (L, job_desc->end_time);
 	} else if (!xstrcmp(name, "environment")) {
-		_push_job_env ((struct job_descriptor *)job_desc); // No const
+		_push_job_env (L, (struct job_descriptor *)job_desc); // No const
 	} else if (!xstrcmp(name, "exc_nodes")) {
 		lua_pushstring (L, job_desc->exc_nodes);
 	} else if (!xstrcmp(name, "features")) {
@@ -806,7 +842,7 @@ static int _get_job_req_field_name(lua_State *L)
 	const struct job_descriptor *job_desc = lua_touserdata(L, 1);
 	const char *name = luaL_checkstring(L, 2);
 
-	return _get_job_req_field(job_desc, name);
+	return _get_job_req_field(L, job_desc, name);
 }
 
 /* Get fields in an existing slurmctld job_descriptor record */
@@ -820,7 +856,7 @@ static int _get_job_req_field_index(lua_State *L)
 	lua_getfield(L, -1, "_job_desc");
 	job_desc = lua_touserdata(L, -1);
 
-	return _get_job_req_field(job_desc, name);
+	return _get_job_req_field(L, job_desc, name);
 }
 
 /* Set fields in the job request structure on job submit or modify */
@@ -1012,7 +1048,7 @@ static int _set_job_req_field(lua_State *L)
 	return 0;
 }
 
-static void _push_job_desc(struct job_descriptor *job_desc)
+static void _push_job_desc(lua_State *L, struct job_descriptor *job_desc)
 {
 	lua_newtable(L);
 
@@ -1029,7 +1065,7 @@ static void _push_job_desc(struct job_descriptor *job_desc)
 	lua_setmetatable(L, -2);
 }
 
-static void _push_job_rec(struct job_record *job_ptr)
+static void _push_job_rec(lua_State *L, struct job_record *job_ptr)
 {
 	lua_newtable(L);
 
@@ -1049,7 +1085,8 @@ static void _push_job_rec(struct job_record *job_ptr)
  * This is an incomplete list of partition record fields. Add more as needed
  * and send patches to slurm-dev@schedmd.com
  */
-static int _part_rec_field(const struct part_record *part_ptr,
+static int _part_rec_field(lua_State *L,
+                           const struct part_record *part_ptr,
                            const char *name)
 {
 	if (part_ptr == NULL) {
@@ -1100,7 +1137,7 @@ static int _get_part_rec_field (lua_State *L)
 	const struct part_record *part_ptr = lua_touserdata(L, 1);
 	const char *name = luaL_checkstring(L, 2);
 
-	return _part_rec_field(part_ptr, name);
+	return _part_rec_field(L, part_ptr, name);
 }
 
 static int _part_rec_field_index(lua_State *L)
@@ -1112,7 +1149,7 @@ static int _part_rec_field_index(lua_State *L)
 	lua_getfield(L, -1, "_part_rec_ptr");
 	part_ptr = lua_touserdata(L, -1);
 
-	return _part_rec_field(part_ptr, name);
+	return _part_rec_field(L, part_ptr, name);
 }
 
 static bool _user_can_use_part(uint32_t user_id, uint32_t submit_uid,
@@ -1139,7 +1176,8 @@ static bool _user_can_use_part(uint32_t user_id, uint32_t submit_uid,
 	return false;
 }
 
-static void _push_partition_list(uint32_t user_id, uint32_t submit_uid)
+static void _push_partition_list(lua_State *L, uint32_t user_id,
+				 uint32_t submit_uid)
 {
 	ListIterator part_iterator;
 	struct part_record *part_ptr;
@@ -1170,7 +1208,7 @@ static void _push_partition_list(uint32_t user_id, uint32_t submit_uid)
 	list_iterator_destroy(part_iterator);
 }
 
-static void _register_lua_slurm_output_functions (void)
+static void _register_lua_slurm_output_functions (lua_State *L)
 {
 	/*
 	 *  Register slurm output functions in a global "slurm" table
@@ -1254,14 +1292,9 @@ static void _register_lua_slurm_output_functions (void)
 	lua_setfield (L, -2, "NO_VAL8");
 
 	lua_setglobal (L, "slurm");
-
-	last_lua_jobs_update = 0;
-	_update_jobs_global();
-	last_lua_resv_update = 0;
-	_update_resvs_global();
 }
 
-static void _register_lua_slurm_struct_functions (void)
+static void _register_lua_slurm_struct_functions (lua_State *L)
 {
 	lua_pushcfunction(L, _get_job_env_field_name);
 	lua_setglobal(L, "_get_job_env_field_name");
@@ -1278,7 +1311,7 @@ static void _register_lua_slurm_struct_functions (void)
 /*
  *  check that global symbol [name] in lua script is a function
  */
-static int _check_lua_script_function(const char *name)
+static int _check_lua_script_function(lua_State *L, const char *name)
 {
 	int rc = 0;
 	lua_getglobal(L, name);
@@ -1291,7 +1324,7 @@ static int _check_lua_script_function(const char *name)
 /*
  *   Verify all required functions are defined in the job_submit/lua script
  */
-static int _check_lua_script_functions(void)
+static int _check_lua_script_functions(lua_State *L)
 {
 	int rc = 0;
 	int i;
@@ -1303,7 +1336,7 @@ static int _check_lua_script_functions(void)
 
 	i = 0;
 	do {
-		if (_check_lua_script_function(fns[i]) < 0) {
+		if (_check_lua_script_function(L, fns[i]) < 0) {
 			error("job_submit/lua: %s: "
 			      "missing required function %s",
 			      lua_script_path, fns[i]);
@@ -1314,14 +1347,33 @@ static int _check_lua_script_functions(void)
 	return (rc);
 }
 
+/* Append a chunk of byte code to the compiled script image
+ * (writer callback for lua_dump) */
+static int _dump_writer(lua_State *T, const void *chunk, size_t chunk_size,
+			void *arg)
+{
+	(void) T;
+	(void) arg;
+	lua_script_image = xrealloc(lua_script_image,
+				    lua_script_image_size + chunk_size);
+	memcpy(lua_script_image + lua_script_image_size, chunk, chunk_size);
+	lua_script_image_size += chunk_size;
+	return 0;
+}
+
+/* Compile the script to byte code if it changed on disk. Interpreters
+ * in the pool are rebuilt from the new image as they are next leased.
+ * The lua_lock must be held. */
 static int _load_script(void)
 {
-	int rc = SLURM_SUCCESS;
 	struct stat st;
-	lua_State *L_orig = L;
+	lua_State *cL;
+	char *image_orig = lua_script_image;
+	size_t image_size_orig = lua_script_image_size;
+	int rc;
 
 	if (stat(lua_script_path, &st) != 0) {
-		if (L_orig) {
+		if (image_orig) {
 			(void) error("Unable to stat %s, "
 			             "using old script: %s",
 			             lua_script_path, strerror(errno));
@@ -1330,97 +1382,159 @@ static int _load_script(void)
 		return error("Unable to stat %s: %s",
 		             lua_script_path, strerror(errno));
 	}
-	
+
 	if (st.st_mtime <= lua_script_last_loaded) {
 		return SLURM_SUCCESS;
 	}
 
-	/*
-	 *  Initilize lua
-	 */
-	L = luaL_newstate();
-	luaL_openlibs(L);
-	if (luaL_loadfile(L, lua_script_path)) {
-		if (L_orig) {
+	cL = luaL_newstate();
+	luaL_openlibs(cL);
+	if (luaL_loadfile(cL, lua_script_path)) {
+		if (image_orig) {
 			(void) error("lua: %s: %s, using previous script",
-			             lua_script_path, lua_tostring(L, -1));
-			lua_close(L);
-			L = L_orig;
+			             lua_script_path, lua_tostring(cL, -1));
+			lua_close(cL);
 			return SLURM_SUCCESS;
 		}
 		rc = error("lua: %s: %s", lua_script_path,
-		           lua_tostring(L, -1));
-		lua_pop(L, 1);
+		           lua_tostring(cL, -1));
+		lua_close(cL);
 		return rc;
 	}
 
+	/*
+	 *  Compile once, the byte code image is shared by every
+	 *  interpreter in the pool:
+	 */
+	lua_script_image = NULL;
+	lua_script_image_size = 0;
+	if (lua_dump(cL, _dump_writer, NULL)) {
+		xfree(lua_script_image);
+		lua_script_image = image_orig;
+		lua_script_image_size = image_size_orig;
+		lua_close(cL);
+		if (image_orig) {
+			(void) error("lua: unable to dump %s, "
+			             "using previous script",
+			             lua_script_path);
+			return SLURM_SUCCESS;
+		}
+		return error("lua: unable to dump %s", lua_script_path);
+	}
+	lua_close(cL);
+	xfree(image_orig);
+	lua_script_last_loaded = time(NULL);
+	return SLURM_SUCCESS;
+}
+
+/* Build (or rebuild) one pooled interpreter from the compiled script
+ * image. On failure any previous interpreter in the slot is retained.
+ * The lua_lock must be held. */
+static int _start_lua_state(lua_pool_entry_t *entry)
+{
+	lua_State *L = luaL_newstate();
+	int rc;
+
+	luaL_openlibs(L);
+	if (luaL_loadbuffer(L, lua_script_image, lua_script_image_size,
+			    lua_script_path)) {
+		(void) error("lua: %s: %s", lua_script_path,
+			     lua_tostring(L, -1));
+		lua_close(L);
+		return SLURM_ERROR;
+	}
+
+	/*
+	 *  Let script callbacks locate this entry (e.g. for user messages)
+	 */
+	lua_pushlightuserdata(L, entry);
+	lua_setfield(L, LUA_REGISTRYINDEX, LUA_POOL_ENTRY_KEY);
+
 	/*
 	 *  Register SLURM functions in lua state:
 	 *  logging and slurm structure read/write functions
 	 */
-	_register_lua_slurm_output_functions();
-	_register_lua_slurm_struct_functions();
+	_register_lua_slurm_output_functions(L);
+	_register_lua_slurm_struct_functions(L);
 
 	/*
 	 *  Run the user script:
 	 */
 	if (lua_pcall(L, 0, 1, 0) != 0) {
-		if (L_orig) {
-			(void) error("job_submit/lua: %s: %s, "
-			             "using previous script",
-			             lua_script_path, lua_tostring(L, -1));
-			lua_close(L);
-			L = L_orig;
-			return SLURM_SUCCESS;
-		}
-		rc = error("job_submit/lua: %s: %s",
-		           lua_script_path, lua_tostring(L, -1));
-		lua_pop(L, 1);
-		return rc;
+		(void) error("job_submit/lua: %s: %s",
+			     lua_script_path, lua_tostring(L, -1));
+		lua_close(L);
+		return SLURM_ERROR;
 	}
 
 	/*
 	 *  Get any return code from the lua script
 	 */
 	rc = (int) lua_tonumber(L, -1);
+	lua_pop(L, 1);
 	if (rc != SLURM_SUCCESS) {
-		if (L_orig) {
-			(void) error("job_submit/lua: %s: returned %d "
-			             "on load, using previous script",
-			             lua_script_path, rc);
-			lua_close(L);
-			L = L_orig;
-			return SLURM_SUCCESS;
-		}
 		(void) error("job_submit/lua: %s: returned %d on load",
-		             lua_script_path, rc);
-		lua_pop (L, 1);
+			     lua_script_path, rc);
+		lua_close(L);
 		return rc;
 	}
 
 	/*
 	 *  Check for required lua script functions:
 	 */
-	rc = _check_lua_script_functions();
-	if (rc != SLURM_SUCCESS) {
-		if (L_orig) {
-			(void) error("job_submit/lua: %s: "
-			             "required function(s) not present, "
-			             "using previous script",
-			             lua_script_path);
-			lua_close(L);
-			L = L_orig;
-			return SLURM_SUCCESS;
-		}
-		return rc;
+	if (_check_lua_script_functions(L) != SLURM_SUCCESS) {
+		lua_close(L);
+		return SLURM_ERROR;
 	}
 
-	if (L_orig)
-		lua_close(L_orig);
-	lua_script_last_loaded = time(NULL);
+	if (entry->L)
+		lua_close(entry->L);
+	entry->L = L;
+	entry->loaded = lua_script_last_loaded;
+	entry->jobs_update = 0;
+	entry->resvs_update = 0;
 	return SLURM_SUCCESS;
 }
 
+/* Lease an interpreter from the pool, waiting for one to be returned
+ * if all are running the script. Also picks up script changes on disk,
+ * rebuilding the leased interpreter if it predates the current image. */
+static lua_pool_entry_t *_acquire_lua_state(void)
+{
+	lua_pool_entry_t *entry = NULL;
+	int i;
+
+	slurm_mutex_lock(&lua_lock);
+	(void) _load_script();
+	while (!entry) {
+		for (i = 0; i < LUA_STATE_POOL_SIZE; i++) {
+			if (!lua_state_pool[i].busy) {
+				entry = &lua_state_pool[i];
+				break;
+			}
+		}
+		if (!entry)
+			slurm_cond_wait(&lua_cond, &lua_lock);
+	}
+	if (entry->loaded < lua_script_last_loaded) {
+		/* Keeps the previous interpreter on failure, matching the
+		 * old use-previous-script behavior */
+		(void) _start_lua_state(entry);
+	}
+	entry->busy = true;
+	slurm_mutex_unlock(&lua_lock);
+	return entry;
+}
+
+/* Return a leased interpreter to the pool */
+static void _release_lua_state(lua_pool_entry_t *entry)
+{
+	slurm_mutex_lock(&lua_lock);
+	entry->busy = false;
+	slurm_cond_signal(&lua_cond);
+	slurm_mutex_unlock(&lua_lock);
+}
+
 /*
  *  NOTE: The init callback should never be called multiple times,
  *   let alone called from multiple threads. Therefore, locking
@@ -1429,6 +1543,7 @@ static int _load_script(void)
 int init(void)
 {
 	int rc = SLURM_SUCCESS;
+	int i;
 
 	/*
 	 * Need to dlopen() the Lua library to ensure plugins see
@@ -1437,12 +1552,29 @@ int init(void)
 	if ((rc = xlua_dlopen()) != SLURM_SUCCESS)
 		return rc;
 
-	return _load_script();
+	if ((rc = _load_script()) != SLURM_SUCCESS)
+		return rc;
+
+	for (i = 0; i < LUA_STATE_POOL_SIZE; i++) {
+		rc = _start_lua_state(&lua_state_pool[i]);
+		if (rc != SLURM_SUCCESS)
+			return rc;
+	}
+	return SLURM_SUCCESS;
 }
 
 int fini(void)
 {
-	lua_close (L);
+	int i;
+
+	for (i = 0; i < LUA_STATE_POOL_SIZE; i++) {
+		if (lua_state_pool[i].L)
+			lua_close(lua_state_pool[i].L);
+		lua_state_pool[i].L = NULL;
+		xfree(lua_state_pool[i].user_msg);
+	}
+	xfree(lua_script_image);
+	lua_script_image_size = 0;
 	return SLURM_SUCCESS;
 }
 
@@ -1452,9 +1584,8 @@ extern int job_submit(struct job_descriptor *job_desc, uint32_t submit_uid,
 		      char **err_msg)
 {
 	int rc = SLURM_ERROR;
-	slurm_mutex_lock (&lua_lock);
-
-	(void) _load_script();
+	lua_pool_entry_t *entry = _acquire_lua_state();
+	lua_State *L = entry->L;
 
 	/*
 	 *  All lua script functions should have been verified during
@@ -1464,11 +1595,11 @@ extern int job_submit(struct job_descriptor *job_desc, uint32_t submit_uid,
 	if (lua_isnil(L, -1))
 		goto out;
 
-	_update_jobs_global();
-	_update_resvs_global();
+	_update_jobs_global(entry);
+	_update_resvs_global(entry);
 
-	_push_job_desc(job_desc);
-	_push_partition_list(job_desc->user_id, submit_uid);
+	_push_job_desc(L, job_desc);
+	_push_partition_list(L, job_desc->user_id, submit_uid);
 	lua_pushnumber (L, submit_uid);
 	_stack_dump("job_submit, before lua_pcall", L);
 	if (lua_pcall (L, 3, 1, 0) != 0) {
@@ -1485,15 +1616,15 @@ extern int job_submit(struct job_descriptor *job_desc, uint32_t submit_uid,
 		lua_pop(L, 1);
 	}
 	_stack_dump("job_submit, after lua_pcall", L);
-	if (user_msg) {
+	if (entry->user_msg) {
 		if (err_msg) {
-			*err_msg = user_msg;
-			user_msg = NULL;
+			*err_msg = entry->user_msg;
+			entry->user_msg = NULL;
 		} else
-			xfree(user_msg);
+			xfree(entry->user_msg);
 	}
 
-out:	slurm_mutex_unlock (&lua_lock);
+out:	_release_lua_state(entry);
 	return rc;
 }
 
@@ -1502,7 +1633,8 @@ extern int job_modify(struct job_descriptor *job_desc,
 		      struct job_record *job_ptr, uint32_t submit_uid)
 {
 	int rc = SLURM_ERROR;
-	slurm_mutex_lock (&lua_lock);
+	lua_pool_entry_t *entry = _acquire_lua_state();
+	lua_State *L = entry->L;
 
 	/*
 	 *  All lua script functions should have been verified during
@@ -1512,12 +1644,12 @@ extern int job_modify(struct job_descriptor *job_desc,
 	if (lua_isnil(L, -1))
 		goto out;
 
-	_update_jobs_global();
-	_update_resvs_global();
+	_update_jobs_global(entry);
+	_update_resvs_global(entry);
 
-	_push_job_desc(job_desc);
-	_push_job_rec(job_ptr);
-	_push_partition_list(job_ptr->user_id, submit_uid);
+	_push_job_desc(L, job_desc);
+	_push_job_rec(L, job_ptr);
+	_push_partition_list(L, job_ptr->user_id, submit_uid);
 	lua_pushnumber (L, submit_uid);
 	_stack_dump("job_modify, before lua_pcall", L);
 	if (lua_pcall (L, 4, 1, 0) != 0) {
@@ -1534,7 +1666,8 @@ extern int job_modify(struct job_descriptor *job_desc,
 		lua_pop(L, 1);
 	}
 	_stack_dump("job_modify, after lua_pcall", L);
+	xfree(entry->user_msg);
 
-out:	slurm_mutex_unlock (&lua_lock);
+out:	_release_lua_state(entry);
 	return rc;
 }
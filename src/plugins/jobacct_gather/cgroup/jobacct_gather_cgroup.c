@@ -40,7 +40,9 @@
 \*****************************************************************************/
 
 #include <fcntl.h>
+#include <limits.h>
 #include <signal.h>
+#include <unistd.h>
 #include "src/common/slurm_xlator.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_defs.h"
@@ -99,19 +101,77 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 /* Other useful declarations */
 static slurm_cgroup_conf_t slurm_cgroup_conf;
 
+/* Persistent handle on a cgroup accounting file.  The polling loop
+ * reads the same cpuacct.stat/memory.stat files every interval, so
+ * keep the descriptor open between samples and pread() the contents
+ * into a caller supplied buffer instead of paying an open/read/close
+ * cycle plus a heap copy per sample through xcgroup_get_param().  The
+ * handle is rebound transparently when the task cgroup it was opened
+ * on changes or goes away. */
+typedef struct {
+	int fd;
+	char path[PATH_MAX];
+} cg_stat_file_t;
+
+static cg_stat_file_t cpuacct_stat_file = { -1, "" };
+static cg_stat_file_t memory_stat_file = { -1, "" };
+
+static void _stat_file_close(cg_stat_file_t *sf)
+{
+	if (sf->fd >= 0) {
+		close(sf->fd);
+		sf->fd = -1;
+	}
+	sf->path[0] = '\0';
+}
+
+static ssize_t _stat_file_read(cg_stat_file_t *sf, xcgroup_t *cg,
+			       char *param, char *buf, size_t buf_size)
+{
+	char file_path[PATH_MAX];
+	ssize_t nread;
+
+	if (snprintf(file_path, PATH_MAX, "%s/%s", cg->path, param)
+	    >= PATH_MAX)
+		return -1;
+
+	if ((sf->fd < 0) || xstrcmp(sf->path, file_path)) {
+		_stat_file_close(sf);
+		if ((sf->fd = open(file_path, O_RDONLY | O_CLOEXEC)) < 0)
+			return -1;
+		strlcpy(sf->path, file_path, sizeof(sf->path));
+	}
+
+	nread = pread(sf->fd, buf, buf_size - 1, 0);
+	if (nread < 0) {
+		/* The cgroup was likely deleted and recreated under
+		 * the same name; retry once on a fresh descriptor. */
+		_stat_file_close(sf);
+		if ((sf->fd = open(file_path, O_RDONLY | O_CLOEXEC)) < 0)
+			return -1;
+		strlcpy(sf->path, file_path, sizeof(sf->path));
+		nread = pread(sf->fd, buf, buf_size - 1, 0);
+		if (nread < 0) {
+			_stat_file_close(sf);
+			return -1;
+		}
+	}
+	buf[nread] = '\0';
+	return nread;
+}
+
 static void _prec_extra(jag_prec_t *prec)
 {
 	unsigned long utime, stime, total_rss, total_pgpgin;
-	char *cpu_time = NULL, *memory_stat = NULL, *ptr;
-	size_t cpu_time_size = 0, memory_stat_size = 0;
+	char cpu_time[256], memory_stat[8192], *ptr;
 
 	//DEF_TIMERS;
 	//START_TIMER;
 	/* info("before"); */
 	/* print_jag_prec(prec); */
-	xcgroup_get_param(&task_cpuacct_cg, "cpuacct.stat",
-			  &cpu_time, &cpu_time_size);
-	if (cpu_time == NULL) {
+	if (_stat_file_read(&cpuacct_stat_file, &task_cpuacct_cg,
+			    "cpuacct.stat", cpu_time,
+			    sizeof(cpu_time)) < 0) {
 		debug2("%s: failed to collect cpuacct.stat pid %d ppid %d",
 		       __func__, prec->pid, prec->ppid);
 	} else {
@@ -120,9 +180,9 @@ static void _prec_extra(jag_prec_t *prec)
 		prec->ssec = stime;
 	}
 
-	xcgroup_get_param(&task_memory_cg, "memory.stat",
-			  &memory_stat, &memory_stat_size);
-	if (memory_stat == NULL) {
+	if (_stat_file_read(&memory_stat_file, &task_memory_cg,
+			    "memory.stat", memory_stat,
+			    sizeof(memory_stat)) < 0) {
 		debug2("%s: failed to collect memory.stat  pid %d ppid %d",
 		       __func__, prec->pid, prec->ppid);
 	} else {
@@ -131,9 +191,11 @@ static void _prec_extra(jag_prec_t *prec)
 		   different than what proc presents, but is probably more
 		   accurate on what the user is actually using.
 		*/
-		ptr = strstr(memory_stat, "total_rss");
-		sscanf(ptr, "total_rss %lu", &total_rss);
-		prec->rss = total_rss / 1024; /* convert from bytes to KB */
+		if ((ptr = strstr(memory_stat, "total_rss"))) {
+			sscanf(ptr, "total_rss %lu", &total_rss);
+			/* convert from bytes to KB */
+			prec->rss = total_rss / 1024;
+		}
 
 		/* total_pgmajfault is what is reported in proc, so we use
 		 * the same thing here. */
@@ -143,9 +205,6 @@ static void _prec_extra(jag_prec_t *prec)
 		}
 	}
 
-	xfree(cpu_time);
-	xfree(memory_stat);
-
 	/* FIXME: Enable when kernel support ready.
 	 *
 	 * "Read" and "Write" from blkio.throttle.io_service_bytes are
@@ -253,6 +312,8 @@ extern int init (void)
 extern int fini (void)
 {
 	if (_run_in_daemon()) {
+		_stat_file_close(&cpuacct_stat_file);
+		_stat_file_close(&memory_stat_file);
 		jobacct_gather_cgroup_cpuacct_fini(&slurm_cgroup_conf);
 		jobacct_gather_cgroup_memory_fini(&slurm_cgroup_conf);
 		/* jobacct_gather_cgroup_blkio_fini(&slurm_cgroup_conf); */
@@ -386,18 +386,15 @@ static int _get_process_memory_line(int in, jag_prec_t *prec)
 
 static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
 {
-	FILE *statm_fp = NULL;
 	char proc_statm_file[256];	/* Allow ~20x extra length */
 	int rc = 0, fd;
 
 	snprintf(proc_statm_file, sizeof(proc_statm_file), "%sm",
 		 proc_stat_file);
-	if (!(statm_fp = fopen(proc_statm_file, "r")))
+	if ((fd = open(proc_statm_file, O_RDONLY | O_CLOEXEC)) < 0)
 		return rc;  /* Assume the process went away */
-	fd = fileno(statm_fp);
-	fcntl(fd, F_SETFD, FD_CLOEXEC);
 	rc = _get_process_memory_line(fd, prec);
-	fclose(statm_fp);
+	close(fd);
 	return rc;
 }
 
@@ -430,8 +427,9 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	if (nvals < 4)
 		return 0;
 
-	if (_is_a_lwp(prec->pid) > 0)
-		return 0;
+	/* NOTE: The caller only reads the io file for a pid whose stat
+	 * line was already accepted, so the pid is known not to be a
+	 * LWP and the status file need not be read a second time. */
 
 	/* Copy the values that slurm records into our data structure */
 	prec->disk_read = (double)rchar / (double)1048576;
@@ -445,8 +443,6 @@ static void _handle_stats(List prec_list, char *proc_stat_file, char *proc_io_fi
 {
 	static int no_share_data = -1;
 	static int use_pss = -1;
-	FILE *stat_fp = NULL;
-	FILE *io_fp = NULL;
 	int fd, fd2;
 	jag_prec_t *prec = NULL;
 
@@ -464,32 +460,27 @@ static void _handle_stats(List prec_list, char *proc_stat_file, char *proc_io_fi
 		xfree(acct_params);
 	}
 
-	if (!(stat_fp = fopen(proc_stat_file, "r")))
-		return;  /* Assume the process went away */
 	/*
-	 * Close the file on exec() of user tasks.
-	 *
-	 * NOTE: If we fork() slurmstepd after the
-	 * fopen() above and before the fcntl() below,
-	 * then the user task may have this extra file
-	 * open, which can cause problems for
-	 * checkpoint/restart, but this should be a very rare
-	 * problem in practice.
+	 * Open with O_CLOEXEC so a user task fork()ed while we sample
+	 * can never inherit this extra open file, which can cause
+	 * problems for checkpoint/restart. The raw open also avoids the
+	 * FILE allocation and extra fcntl() the old fopen() path paid
+	 * for every pid on every sample.
 	 */
-	fd = fileno(stat_fp);
-	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	if ((fd = open(proc_stat_file, O_RDONLY | O_CLOEXEC)) < 0)
+		return;  /* Assume the process went away */
 
 	prec = try_xmalloc(sizeof(jag_prec_t));
 	if (prec == NULL) {	/* Avoid killing slurmstepd on malloc failure */
-		fclose(stat_fp);
+		close(fd);
 		return;
 	}
 	if (!_get_process_data_line(fd, prec)) {
 		xfree(prec);
-		fclose(stat_fp);
+		close(fd);
 		return;
 	}
-	fclose(stat_fp);
+	close(fd);
 
 	/* Remove shared data from rss */
 	if (no_share_data)
@@ -505,11 +496,9 @@ static void _handle_stats(List prec_list, char *proc_stat_file, char *proc_io_fi
 
 	list_append(prec_list, prec);
 
-	if ((io_fp = fopen(proc_io_file, "r"))) {
-		fd2 = fileno(io_fp);
-		fcntl(fd2, F_SETFD, FD_CLOEXEC);
+	if ((fd2 = open(proc_io_file, O_RDONLY | O_CLOEXEC)) >= 0) {
 		_get_process_io_data_line(fd2, prec);
-		fclose(io_fp);
+		close(fd2);
 	}
 	if (callbacks->prec_extra)
 		(*(callbacks->prec_extra))(prec);
@@ -166,8 +166,10 @@ int init ( void )
 
 int fini ( void )
 {
-	if (job_comp_fd >= 0)
-		close(job_comp_fd);
+	if (job_comp_fd >= 0) {
+		jobcomp_buf_close();
+		job_comp_fd = -1;
+	}
 	xfree(log_name);
 	return SLURM_SUCCESS;
 }
@@ -189,15 +191,12 @@ extern int slurm_jobcomp_set_location ( char * location )
 	log_name = xstrdup(location);
 
 	slurm_mutex_lock( &file_lock );
-	if (job_comp_fd >= 0)
-		close(job_comp_fd);
-	job_comp_fd = open(location, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	job_comp_fd = jobcomp_buf_open(location);
 	if (job_comp_fd == -1) {
 		fatal("open %s: %m", location);
 		plugin_errno = errno;
 		rc = SLURM_ERROR;
-	} else
-		fchmod(job_comp_fd, 0644);
+	}
 	slurm_mutex_unlock( &file_lock );
 	return rc;
 }
@@ -234,11 +233,9 @@ static void _make_time_str (time_t *time, char *string, int size)
 
 extern int slurm_jobcomp_log_record ( struct job_record *job_ptr )
 {
-	int rc = SLURM_SUCCESS;
 	char job_rec[1024];
 	char usr_str[32], grp_str[32], start_str[32], end_str[32], lim_str[32];
 	char select_buf[128], *state_string, *work_dir;
-	size_t offset = 0, tot_size, wrote;
 	uint32_t job_state;
 	uint32_t time_limit;
 
@@ -309,24 +306,11 @@ extern int slurm_jobcomp_log_record ( struct job_record *job_ptr )
 		 end_str, job_ptr->nodes, job_ptr->node_cnt,
 		 job_ptr->total_cpus, work_dir,
 		 select_buf);
-	tot_size = strlen(job_rec);
-
-	while ( offset < tot_size ) {
-		wrote = write(job_comp_fd, job_rec + offset,
-			tot_size - offset);
-		if (wrote == -1) {
-			if (errno == EAGAIN)
-				continue;
-			else {
-				plugin_errno = errno;
-				rc = SLURM_ERROR;
-				break;
-			}
-		}
-		offset += wrote;
-	}
 	slurm_mutex_unlock( &file_lock );
-	return rc;
+
+	/* Queue the record for the writer thread, the actual file
+	 * write happens outside of the job completion path */
+	return jobcomp_buf_write(xstrdup(job_rec));
 }
 
 extern int slurm_jobcomp_get_errno( void )
@@ -347,6 +331,7 @@ extern char *slurm_jobcomp_strerror( int errnum )
  */
 extern List slurm_jobcomp_get_jobs(slurmdb_job_cond_t *job_cond)
 {
+	jobcomp_buf_flush();	/* queued records must be readable */
 	return filetxt_jobcomp_process_get_jobs(job_cond);
 }
 
@@ -355,5 +340,6 @@ extern List slurm_jobcomp_get_jobs(slurmdb_job_cond_t *job_cond)
  */
 extern int slurm_jobcomp_archive(slurmdb_archive_cond_t *arch_cond)
 {
+	jobcomp_buf_flush();
 	return filetxt_jobcomp_process_archive(arch_cond);
 }
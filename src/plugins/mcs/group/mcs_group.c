@@ -114,26 +114,15 @@ extern int fini(void)
 
 /*
  * Get a list of groups associated with a specific user_id
+ * The lookup goes through the process-wide grouplist cache, so only the
+ * first resolution of a user in the cache lifetime pays the NSS cost.
  * Return 0 on success, -1 on failure
  */
 static int _get_user_groups(uint32_t user_id, uint32_t group_id,
 			    gid_t *groups, int max_groups, int *ngroups)
 {
-	int rc = SLURM_ERROR;
-	char *user_name;
-
-	user_name = uid_to_string((uid_t) user_id);
-	*ngroups = max_groups;
-	rc = getgrouplist(user_name, (gid_t) group_id, groups, ngroups);
-	if (rc < 0) {
-		error("getgrouplist(%s): %m", user_name);
-		rc = SLURM_ERROR;
-	} else {
-		*ngroups = rc;
-		rc = SLURM_SUCCESS;
-	}
-	xfree(user_name);
-	return rc;
+	return slurm_user_grouplist_cached((uid_t) user_id, (gid_t) group_id,
+					   groups, max_groups, ngroups);
 }
 
 /*
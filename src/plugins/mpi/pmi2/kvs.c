@@ -71,6 +71,19 @@ static int no_dup_keys = 0;
 #define TASKS_PER_BUCKET 8
 #define TEMP_KVS_SIZE_INC 2048
 
+/* grow the temp kvs buffer geometrically. srun merges the payload of
+ * every child in turn, so growing by just the size needed makes the
+ * aggregate copying cost quadratic in the job size. */
+static void
+_temp_kvs_reserve(uint32_t size)
+{
+	if (temp_kvs_cnt + size <= temp_kvs_size)
+		return;
+	while (temp_kvs_cnt + size > temp_kvs_size)
+		temp_kvs_size *= 2;
+	xrealloc(temp_kvs_buf, temp_kvs_size);
+}
+
 #define KEY_INDEX(i) (i * 2)
 #define VAL_INDEX(i) (i * 2 + 1)
 #define HASH(key) ( _hash(key) % hash_size)
@@ -124,10 +137,7 @@ temp_kvs_init(void)
 		pack32(kvs_seq, buf);
 	}
 	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
+	_temp_kvs_reserve(size);
 	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
 	temp_kvs_cnt += size;
 	free_buf(buf);
@@ -141,23 +151,28 @@ temp_kvs_init(void)
 extern int
 temp_kvs_add(char *key, char *val)
 {
-	Buf buf;
-	uint32_t size;
+	uint32_t key_len, val_len, len_nl;
 
 	if ( key == NULL || val == NULL )
 		return SLURM_SUCCESS;
 
-	buf = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN + 2 * sizeof(uint32_t));
-	packstr(key, buf);
-	packstr(val, buf);
-	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
-	temp_kvs_cnt += size;
-	free_buf(buf);
+	/* pack the pair in packstr() wire format directly into the
+	 * buffer, avoiding a scratch Buf for every key-value pair */
+	key_len = strlen(key) + 1;
+	val_len = strlen(val) + 1;
+	_temp_kvs_reserve(key_len + val_len + 2 * sizeof(uint32_t));
+
+	len_nl = htonl(key_len);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], &len_nl, sizeof(uint32_t));
+	temp_kvs_cnt += sizeof(uint32_t);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], key, key_len);
+	temp_kvs_cnt += key_len;
+
+	len_nl = htonl(val_len);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], &len_nl, sizeof(uint32_t));
+	temp_kvs_cnt += sizeof(uint32_t);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], val, val_len);
+	temp_kvs_cnt += val_len;
 
 	return SLURM_SUCCESS;
 }
@@ -175,10 +190,7 @@ temp_kvs_merge(Buf buf)
 	data = get_buf_data(buf);
 	offset = get_buf_offset(buf);
 
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += size;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
+	_temp_kvs_reserve(size);
 	memcpy(&temp_kvs_buf[temp_kvs_cnt], &data[offset], size);
 	temp_kvs_cnt += size;
 
@@ -308,6 +320,46 @@ kvs_put(char *key, char *val)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * like kvs_put(), but takes ownership of key and val, which must be
+ * xmalloc-ed. Saves duplicating every pair when loading the fence
+ * response payload into the hash.
+ */
+extern int
+kvs_put_own(char *key, char *val)
+{
+	kvs_bucket_t *bucket;
+	int i;
+
+	bucket = &kvs_hash[HASH(key)];
+
+	if (! no_dup_keys) {
+		for (i = 0; i < bucket->count; i ++) {
+			if (! xstrcmp(key, bucket->pairs[KEY_INDEX(i)])) {
+				/* replace the k-v pair */
+				xfree(bucket->pairs[VAL_INDEX(i)]);
+				bucket->pairs[VAL_INDEX(i)] = val;
+				xfree(key);
+				debug3("mpi/pmi2: put kvs %s",
+				       bucket->pairs[KEY_INDEX(i)]);
+				return SLURM_SUCCESS;
+			}
+		}
+	}
+	if (bucket->count * 2 >= bucket->size) {
+		bucket->size += (TASKS_PER_BUCKET * 2);
+		xrealloc(bucket->pairs, bucket->size * sizeof(char *));
+	}
+	/* add the k-v pair */
+	i = bucket->count;
+	bucket->pairs[KEY_INDEX(i)] = key;
+	bucket->pairs[VAL_INDEX(i)] = val;
+	bucket->count ++;
+
+	debug3("mpi/pmi2: put kvs %s=%s", key, val);
+	return SLURM_SUCCESS;
+}
+
 extern int
 kvs_clear(void)
 {
@@ -199,14 +199,11 @@ _handle_kvs_fence_resp(int fd, Buf buf)
 
 	temp32 = remaining_buf(buf);
 	debug3("mpi/pmi2: buf length: %u", temp32);
-	/* put kvs into local hash */
+	/* put kvs into local hash, which takes the strings over */
 	while (remaining_buf(buf) > 0) {
 		safe_unpackstr_xmalloc(&key, &temp32, buf);
 		safe_unpackstr_xmalloc(&val, &temp32, buf);
-		kvs_put(key, val);
-		//temp32 = remaining_buf(buf);
-		xfree(key);
-		xfree(val);
+		kvs_put_own(key, val);
 	}
 
 resp:
@@ -44,6 +44,7 @@
 #include "pmixp_debug.h"
 #include "pmixp_agent.h"
 #include "pmixp_info.h"
+#include "pmixp_dstore.h"
 
 #include <pmix_server.h>
 #include <pmixp_client.h>
@@ -130,6 +131,12 @@ int p_mpi_hook_slurmstepd_task(const mpi_plugin_task_info_t *job, char ***env)
 		free(tmp_env);
 		tmp_env = NULL;
 	}
+	/* Point the client at the node-local shared memory dstore so it
+	 * can read job data and fence results directly */
+	if (NULL != pmixp_dstore_path()) {
+		env_array_overwrite(env, PMIXP_DSTORE_FILE_ENV,
+				pmixp_dstore_path());
+	}
 	return SLURM_SUCCESS;
 }
 
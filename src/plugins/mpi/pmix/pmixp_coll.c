@@ -41,6 +41,7 @@
 #include "pmixp_coll.h"
 #include "pmixp_nspaces.h"
 #include "pmixp_server.h"
+#include "pmixp_dstore.h"
 
 static void _progress_fan_in(pmixp_coll_t *coll);
 static void _progres_fan_out(pmixp_coll_t *coll, Buf buf);
@@ -628,8 +629,14 @@ void _progres_fan_out(pmixp_coll_t *coll, Buf buf)
 	if (NULL != coll->cbfunc) {
 		void *data = get_buf_data(buf) + get_buf_offset(buf);
 		size_t size = remaining_buf(buf);
+		char key[64];
 		PMIXP_DEBUG("%s:%d: use the callback", pmixp_info_namespace(),
 				pmixp_info_nodeid());
+		/* publish once into the node-local dstore so local clients
+		 * read the result from the shared segment instead of each
+		 * receiving its own copy over the server channel */
+		snprintf(key, sizeof(key), "fence.%u", coll->seq);
+		pmixp_dstore_put(key, data, size);
 		coll->cbfunc(PMIX_SUCCESS, data, size, coll->cbdata,
 				pmixp_free_Buf, (void *)buf);
 	}
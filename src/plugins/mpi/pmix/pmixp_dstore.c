@@ -0,0 +1,281 @@
+/*****************************************************************************\
+ **	pmixp_dstore.c - node-local shared memory job data store
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+ \*****************************************************************************/
+
+/*
+ * Job data and fence results used to be delivered to every local client
+ * over the server channel, duplicating them once per rank. This module
+ * instead publishes them into a single file-backed segment mapped by
+ * slurmstepd; local clients are pointed at it through
+ * PMIXP_DSTORE_FILE_ENV and map it read-only, so the per-rank cost is
+ * one mmap regardless of the amount of data or the number of ranks.
+ *
+ * Layout: a header, a fixed section table, and a data heap. slurmstepd
+ * is the only writer. Readers are synchronized with a seqlock: the
+ * header sequence number is odd while an update is in flight, so a
+ * reader retries when it observes an odd value or a value that changed
+ * across its read. Sections are append-only; an updated key points its
+ * table entry at freshly appended data, old data is never overwritten,
+ * which keeps concurrent readers of the previous value safe.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pmixp_common.h"
+#include "pmixp_debug.h"
+#include "pmixp_info.h"
+#include "pmixp_dstore.h"
+
+#define PMIXP_DSTORE_MAGIC	0x70647374
+#define PMIXP_DSTORE_VERSION	1
+#define PMIXP_DSTORE_KEY_LEN	64
+#define PMIXP_DSTORE_SECT_MAX	1024
+#define PMIXP_DSTORE_INIT_SIZE	(256 * 1024)
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	volatile uint32_t seq;	/* seqlock, odd while updating */
+	uint32_t sect_cnt;
+	uint64_t seg_size;
+	uint64_t heap_off;	/* next free heap byte */
+} pmixp_dstore_hdr_t;
+
+typedef struct {
+	char key[PMIXP_DSTORE_KEY_LEN];
+	uint64_t offset;
+	uint64_t size;
+} pmixp_dstore_sect_t;
+
+static char *_dstore_path = NULL;
+static int _dstore_fd = -1;
+static void *_dstore_base = NULL;
+static size_t _dstore_size = 0;
+static pthread_mutex_t _dstore_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline pmixp_dstore_hdr_t *_hdr(void)
+{
+	return (pmixp_dstore_hdr_t *) _dstore_base;
+}
+
+static inline pmixp_dstore_sect_t *_sect_tab(void)
+{
+	return (pmixp_dstore_sect_t *)
+		((char *) _dstore_base + sizeof(pmixp_dstore_hdr_t));
+}
+
+int pmixp_dstore_init(void)
+{
+	pmixp_dstore_hdr_t *hdr;
+
+	_dstore_path = xstrdup_printf("%s/pmixp_dstore",
+				      pmixp_info_tmpdir_lib());
+	_dstore_fd = open(_dstore_path, O_CREAT | O_RDWR | O_TRUNC, 0600);
+	if (_dstore_fd < 0) {
+		PMIXP_ERROR_STD("Cannot create dstore segment \"%s\"",
+				_dstore_path);
+		goto err_open;
+	}
+	if (ftruncate(_dstore_fd, PMIXP_DSTORE_INIT_SIZE) < 0) {
+		PMIXP_ERROR_STD("Cannot size dstore segment \"%s\"",
+				_dstore_path);
+		goto err_size;
+	}
+	_dstore_size = PMIXP_DSTORE_INIT_SIZE;
+	_dstore_base = mmap(NULL, _dstore_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED, _dstore_fd, 0);
+	if (MAP_FAILED == _dstore_base) {
+		_dstore_base = NULL;
+		PMIXP_ERROR_STD("Cannot map dstore segment \"%s\"",
+				_dstore_path);
+		goto err_size;
+	}
+
+	hdr = _hdr();
+	hdr->magic = PMIXP_DSTORE_MAGIC;
+	hdr->version = PMIXP_DSTORE_VERSION;
+	hdr->seq = 0;
+	hdr->sect_cnt = 0;
+	hdr->seg_size = _dstore_size;
+	hdr->heap_off = sizeof(pmixp_dstore_hdr_t) +
+		PMIXP_DSTORE_SECT_MAX * sizeof(pmixp_dstore_sect_t);
+	PMIXP_DEBUG("dstore segment \"%s\" created", _dstore_path);
+	return SLURM_SUCCESS;
+
+err_size:
+	close(_dstore_fd);
+	_dstore_fd = -1;
+	unlink(_dstore_path);
+err_open:
+	xfree(_dstore_path);
+	return SLURM_ERROR;
+}
+
+void pmixp_dstore_finalize(void)
+{
+	if (NULL != _dstore_base) {
+		munmap(_dstore_base, _dstore_size);
+		_dstore_base = NULL;
+	}
+	if (0 <= _dstore_fd) {
+		close(_dstore_fd);
+		_dstore_fd = -1;
+	}
+	if (NULL != _dstore_path) {
+		unlink(_dstore_path);
+		xfree(_dstore_path);
+	}
+}
+
+/* Grow the mapped segment so at least need more heap bytes fit.
+ * NOTE: Caller must hold _dstore_lock */
+static int _dstore_grow(size_t need)
+{
+	size_t new_size = _dstore_size;
+	pmixp_dstore_hdr_t *hdr = _hdr();
+
+	while ((new_size - hdr->heap_off) < need)
+		new_size *= 2;
+	if (new_size == _dstore_size)
+		return SLURM_SUCCESS;
+
+	if (ftruncate(_dstore_fd, new_size) < 0) {
+		PMIXP_ERROR_STD("Cannot grow dstore segment \"%s\"",
+				_dstore_path);
+		return SLURM_ERROR;
+	}
+	if (munmap(_dstore_base, _dstore_size) < 0) {
+		PMIXP_ERROR_STD("Cannot unmap dstore segment \"%s\"",
+				_dstore_path);
+		return SLURM_ERROR;
+	}
+	_dstore_base = mmap(NULL, new_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED, _dstore_fd, 0);
+	if (MAP_FAILED == _dstore_base) {
+		_dstore_base = NULL;
+		PMIXP_ERROR_STD("Cannot remap dstore segment \"%s\"",
+				_dstore_path);
+		return SLURM_ERROR;
+	}
+	_dstore_size = new_size;
+	_hdr()->seg_size = new_size;
+	return SLURM_SUCCESS;
+}
+
+int pmixp_dstore_put(const char *key, const void *data, size_t size)
+{
+	pmixp_dstore_hdr_t *hdr;
+	pmixp_dstore_sect_t *sect;
+	uint32_t i;
+	int rc = SLURM_ERROR;
+
+	if (NULL == _dstore_base) {
+		return SLURM_ERROR;
+	}
+	if (strlen(key) >= PMIXP_DSTORE_KEY_LEN) {
+		PMIXP_ERROR("dstore key \"%s\" too long", key);
+		return SLURM_ERROR;
+	}
+
+	slurm_mutex_lock(&_dstore_lock);
+	if (SLURM_SUCCESS != _dstore_grow(size)) {
+		goto unlock;
+	}
+	hdr = _hdr();
+	sect = _sect_tab();
+	for (i = 0; i < hdr->sect_cnt; i++) {
+		if (0 == strcmp(sect[i].key, key)) {
+			break;
+		}
+	}
+	if (i >= PMIXP_DSTORE_SECT_MAX) {
+		PMIXP_ERROR("dstore section table full, dropping \"%s\"",
+			    key);
+		goto unlock;
+	}
+
+	/* Data is appended before the seqlocked table/header update so a
+	 * reader never sees a section pointing at unwritten bytes */
+	memcpy((char *) _dstore_base + hdr->heap_off, data, size);
+
+	hdr->seq++;		/* odd: update in flight */
+	__sync_synchronize();
+	strcpy(sect[i].key, key);
+	sect[i].offset = hdr->heap_off;
+	sect[i].size = size;
+	if (i == hdr->sect_cnt) {
+		hdr->sect_cnt++;
+	}
+	hdr->heap_off += size;
+	__sync_synchronize();
+	hdr->seq++;		/* even: consistent again */
+	rc = SLURM_SUCCESS;
+
+unlock:
+	slurm_mutex_unlock(&_dstore_lock);
+	return rc;
+}
+
+/* Mostly for the writer's own use and for testing; clients map the
+ * segment read-only and apply the same seqlock protocol themselves */
+const void *pmixp_dstore_get(const char *key, size_t *size)
+{
+	pmixp_dstore_hdr_t *hdr;
+	pmixp_dstore_sect_t *sect;
+	const void *data = NULL;
+	uint32_t i;
+
+	if (NULL == _dstore_base) {
+		return NULL;
+	}
+	slurm_mutex_lock(&_dstore_lock);
+	hdr = _hdr();
+	sect = _sect_tab();
+	for (i = 0; i < hdr->sect_cnt; i++) {
+		if (0 == strcmp(sect[i].key, key)) {
+			data = (char *) _dstore_base + sect[i].offset;
+			*size = sect[i].size;
+			break;
+		}
+	}
+	slurm_mutex_unlock(&_dstore_lock);
+	return data;
+}
+
+const char *pmixp_dstore_path(void)
+{
+	return _dstore_path;
+}
@@ -46,6 +46,7 @@
 #include "pmixp_state.h"
 #include "pmixp_client.h"
 #include "pmixp_dmdx.h"
+#include "pmixp_dstore.h"
 
 #include <pmix_server.h>
 
@@ -137,6 +138,15 @@ int pmixp_stepd_init(const stepd_step_rec_t *job, char ***env)
 		goto err_dmdx;
 	}
 
+	if (SLURM_SUCCESS != (rc = pmixp_dstore_init())) {
+		PMIXP_ERROR("pmixp_dstore_init() failed");
+		goto err_dstore;
+	}
+	/* Publish job data once per node instead of sending a copy
+	 * to every local rank */
+	pmixp_dstore_put("job.taskmap", pmixp_info_task_map(),
+			strlen(pmixp_info_task_map()) + 1);
+
 	if (SLURM_SUCCESS != (rc = pmixp_libpmix_init())) {
 		PMIXP_ERROR("pmixp_libpmix_init() failed");
 		goto err_lib;
@@ -154,6 +164,8 @@ int pmixp_stepd_init(const stepd_step_rec_t *job, char ***env)
 err_job:
 	pmixp_libpmix_finalize();
 err_lib:
+	pmixp_dstore_finalize();
+err_dstore:
 	pmixp_dmdx_finalize();
 err_dmdx:
 	pmixp_state_finalize();
@@ -175,6 +187,7 @@ int pmixp_stepd_finalize(void)
 	}
 
 	pmixp_libpmix_finalize();
+	pmixp_dstore_finalize();
 	pmixp_dmdx_finalize();
 	pmixp_state_finalize();
 	pmixp_nspaces_finalize();
@@ -56,6 +56,43 @@ const uint32_t	plugin_version	= SLURM_VERSION_NUMBER;
 static uint32_t _gen_job_prio(struct job_record *job_ptr);
 static int  _sort_by_prio (void *x, void *y);
 
+/* Index of running/suspended jobs in preemptable partitions, sorted by
+ * preemption order. Rebuilt when the job records change rather than
+ * scanning and sorting the full job_list on every preemptor tested. */
+static List cand_job_list = NULL;
+static time_t cand_build_time = 0;
+
+/* Rebuild cand_job_list if any job record changed since it was built.
+ * Valid only while the build time is strictly newer than last_job_update,
+ * so a change in the same second as the build forces another rebuild and
+ * the index can never hold a pointer to a purged job record.
+ * Caller must hold a job read lock. */
+static void _build_cand_index(void)
+{
+	ListIterator job_iterator;
+	struct job_record *job_p;
+
+	if (cand_job_list && (last_job_update < cand_build_time))
+		return;
+
+	FREE_NULL_LIST(cand_job_list);
+	cand_job_list = list_create(NULL);
+	cand_build_time = time(NULL);
+	job_iterator = list_iterator_create(job_list);
+	while ((job_p = (struct job_record *) list_next(job_iterator))) {
+		if (!IS_JOB_RUNNING(job_p) && !IS_JOB_SUSPENDED(job_p))
+			continue;
+		if ((job_p->part_ptr == NULL) ||
+		    (job_p->part_ptr->preempt_mode == PREEMPT_MODE_OFF))
+			continue;
+		if (job_p->node_bitmap == NULL)
+			continue;
+		list_append(cand_job_list, job_p);
+	}
+	list_iterator_destroy(job_iterator);
+	list_sort(cand_job_list, _sort_by_prio);
+}
+
 /**************************************************************************/
 /*  TAG(                              init                              ) */
 /**************************************************************************/
@@ -70,7 +107,7 @@ extern int init( void )
 /**************************************************************************/
 extern void fini( void )
 {
-	/* Empty. */
+	FREE_NULL_LIST(cand_job_list);
 }
 
 /**************************************************************************/
@@ -103,19 +140,16 @@ extern List find_preemptable_jobs(struct job_record *job_ptr)
 		return preemptee_job_list;
 	}
 
-	/* Build an array of pointers to preemption candidates */
-	job_iterator = list_iterator_create(job_list);
+	/* Build an array of pointers to preemption candidates from the
+	 * pre-sorted index, so the resulting list needs no sort */
+	_build_cand_index();
+	job_iterator = list_iterator_create(cand_job_list);
 	while ((job_p = (struct job_record *) list_next(job_iterator))) {
-		if (!IS_JOB_RUNNING(job_p) && !IS_JOB_SUSPENDED(job_p))
-			continue;
-		if ((job_p->part_ptr == NULL) ||
-		    (job_p->part_ptr->priority_tier >=
-		     job_ptr->part_ptr->priority_tier) ||
-		    (job_p->part_ptr->preempt_mode == PREEMPT_MODE_OFF))
+		if (job_p->part_ptr->priority_tier >=
+		    job_ptr->part_ptr->priority_tier)
 			continue;
-		if ((job_p->node_bitmap == NULL) ||
-		    (bit_overlap(job_p->node_bitmap,
-				 job_ptr->part_ptr->node_bitmap) == 0))
+		if (bit_overlap(job_p->node_bitmap,
+				job_ptr->part_ptr->node_bitmap) == 0)
 			continue;
 		if (job_ptr->details &&
 		    (job_ptr->details->expanding_jobid == job_p->job_id))
@@ -129,8 +163,6 @@ extern List find_preemptable_jobs(struct job_record *job_ptr)
 	}
 	list_iterator_destroy(job_iterator);
 
-	if (preemptee_job_list)
-		list_sort(preemptee_job_list, _sort_by_prio);
 	return preemptee_job_list;
 }
 
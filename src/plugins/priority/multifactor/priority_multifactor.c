@@ -148,9 +148,25 @@ static uint32_t prevflags;    /* Priority Flags before _internal_setup() resets
 static time_t g_last_ran = 0; /* when the last poll ran */
 static double decay_factor = 1; /* The decay factor when decaying time. */
 
+/* Cached snapshot of the priority factors of all eligible jobs.  The
+ * factors only change when the decay thread runs, so the snapshot is
+ * built at most once per PriorityCalcPeriod and all concurrent client
+ * requests (e.g. sprio) are served from it instead of rescanning the
+ * job list per RPC. */
+typedef struct {
+	priority_factors_object_t *factors;
+	char *account;		/* for PRIVATE_DATA_JOBS filtering */
+	char *mcs_label;
+} factors_cache_rec_t;
+
+static pthread_mutex_t factors_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static List factors_cache_list = NULL;
+static time_t factors_cache_time = 0;
+
 /* variables defined in prirority_multifactor.h */
 bool priority_debug = 0;
 
+static void _factors_cache_invalidate(void);
 static void _priority_p_set_assoc_usage_debug(slurmdb_assoc_rec_t *assoc);
 static void _set_assoc_usage_efctv(slurmdb_assoc_rec_t *assoc);
 
@@ -188,6 +204,18 @@ static int _apply_decay(double real_decay)
 	   All usage_raws are calculated from the bottom up.
 	*/
 	while ((assoc = list_next(itr))) {
+		/* Idle associations stay at zero under decay, skip them
+		 * so this pass scales with the associations actually
+		 * carrying usage rather than the full table */
+		if ((assoc->usage->usage_raw == 0) &&
+		    (assoc->usage->grp_used_wall == 0)) {
+			for (i=0; i<slurmctld_tres_cnt; i++) {
+				if (assoc->usage->usage_tres_raw[i])
+					break;
+			}
+			if (i >= slurmctld_tres_cnt)
+				continue;
+		}
 		assoc->usage->usage_raw *= real_decay;
 		for (i=0; i<slurmctld_tres_cnt; i++)
 			assoc->usage->usage_tres_raw[i] *= real_decay;
@@ -197,6 +225,15 @@ static int _apply_decay(double real_decay)
 
 	itr = list_iterator_create(assoc_mgr_qos_list);
 	while ((qos = list_next(itr))) {
+		if ((qos->usage->usage_raw == 0) &&
+		    (qos->usage->grp_used_wall == 0)) {
+			for (i=0; i<slurmctld_tres_cnt; i++) {
+				if (qos->usage->usage_tres_raw[i])
+					break;
+			}
+			if (i >= slurmctld_tres_cnt)
+				continue;
+		}
 		qos->usage->usage_raw *= real_decay;
 		for (i=0; i<slurmctld_tres_cnt; i++)
 			qos->usage->usage_tres_raw[i] *= real_decay;
@@ -1065,8 +1102,23 @@ static int _apply_new_usage(struct job_record *job_ptr,
 			info("No alloced TRES, state is %s",
 			     job_state_string(job_ptr->job_state));
 	}
-	/* get the time in decayed fashion */
-	run_decay = run_delta * pow(decay_factor, run_delta);
+	/* Get the time in decayed fashion. Jobs which ran for the whole
+	 * period all share run_delta == PriorityCalcPeriod, so cache the
+	 * last exponentiation rather than calling pow() per job. All
+	 * callers hold the job write lock, which serializes access. */
+	{
+		static double last_decay_factor = 0.0;
+		static double last_run_delta = -1.0, last_run_decay = 0.0;
+
+		if ((run_delta != last_run_delta) ||
+		    (decay_factor != last_decay_factor)) {
+			last_decay_factor = decay_factor;
+			last_run_delta = run_delta;
+			last_run_decay = run_delta *
+					 pow(decay_factor, run_delta);
+		}
+		run_decay = last_run_decay;
+	}
 	/* clang needs these memset to avoid a warning */
 	memset(tres_run_decay, 0, sizeof(tres_run_decay));
 	memset(tres_run_delta, 0, sizeof(tres_run_delta));
@@ -1344,6 +1396,10 @@ static void *_decay_thread(void *no_data)
 
 		_write_last_decay_ran(g_last_ran, last_reset);
 
+		/* Job priorities just changed, rebuild the factors
+		 * snapshot on the next client request */
+		_factors_cache_invalidate();
+
 		running_decay = 0;
 		slurm_mutex_unlock(&decay_lock);
 
@@ -1363,19 +1419,19 @@ static void *_decay_thread(void *no_data)
 /* Selects the specific jobs that the user wanted to see
  * Requests that include job id(s) and user id(s) must match both to be passed.
  * Returns 1 if job should be omitted */
-static int _filter_job(struct job_record *job_ptr, List req_job_list,
+static int _filter_job(uint32_t job_id, uint32_t user_id, List req_job_list,
 		       List req_user_list)
 {
 	int filter = 0;
 	ListIterator iterator;
-	uint32_t *job_id;
-	uint32_t *user_id;
+	uint32_t *req_job_id;
+	uint32_t *req_user_id;
 
 	if (req_job_list) {
 		filter = 1;
 		iterator = list_iterator_create(req_job_list);
-		while ((job_id = list_next(iterator))) {
-			if (*job_id == job_ptr->job_id) {
+		while ((req_job_id = list_next(iterator))) {
+			if (*req_job_id == job_id) {
 				filter = 0;
 				break;
 			}
@@ -1389,8 +1445,8 @@ static int _filter_job(struct job_record *job_ptr, List req_job_list,
 	if (req_user_list) {
 		filter = 1;
 		iterator = list_iterator_create(req_user_list);
-		while ((user_id = list_next(iterator))) {
-			if (*user_id == job_ptr->user_id) {
+		while ((req_user_id = list_next(iterator))) {
+			if (*req_user_id == user_id) {
 				filter = 0;
 				break;
 			}
@@ -1403,6 +1459,89 @@ static int _filter_job(struct job_record *job_ptr, List req_job_list,
 	return filter;
 }
 
+static void _factors_cache_rec_del(void *object)
+{
+	factors_cache_rec_t *rec = (factors_cache_rec_t *) object;
+
+	if (rec) {
+		if (rec->factors)
+			slurm_destroy_priority_factors_object(rec->factors);
+		xfree(rec->account);
+		xfree(rec->mcs_label);
+		xfree(rec);
+	}
+}
+
+/* Force a rebuild of the priority factors snapshot on the next client
+ * request, called whenever the factors may have changed */
+static void _factors_cache_invalidate(void)
+{
+	slurm_mutex_lock(&factors_cache_lock);
+	factors_cache_time = 0;
+	slurm_mutex_unlock(&factors_cache_lock);
+}
+
+/* Rebuild the priority factors snapshot from the job list.  Request
+ * specific filtering (job/user lists, private data) is NOT applied
+ * here, it is done per request when serving from the snapshot.
+ * Caller must hold factors_cache_lock and no slurmctld locks. */
+static void _factors_cache_rebuild(time_t now)
+{
+	ListIterator itr;
+	factors_cache_rec_t *rec;
+	struct job_record *job_ptr = NULL;
+	/* Read lock on jobs, nodes, and partitions */
+	slurmctld_lock_t job_read_lock =
+		{ NO_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+
+	FREE_NULL_LIST(factors_cache_list);
+	factors_cache_list = list_create(_factors_cache_rec_del);
+
+	lock_slurmctld(job_read_lock);
+	if (job_list && list_count(job_list)) {
+		itr = list_iterator_create(job_list);
+		while ((job_ptr = list_next(itr))) {
+			if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
+			    !IS_JOB_PENDING(job_ptr))
+				continue;
+
+			/*
+			 * This means the job is not eligible yet
+			 */
+			if (!job_ptr->details->begin_time
+			    || (job_ptr->details->begin_time > now))
+				continue;
+
+			/*
+			 * 0 means the job is held
+			 */
+			if (job_ptr->priority == 0)
+				continue;
+
+			/*
+			 * Priority has been set elsewhere (e.g. by SlurmUser)
+			 */
+			if (job_ptr->direct_set_prio)
+				continue;
+
+			rec = xmalloc(sizeof(factors_cache_rec_t));
+			rec->factors =
+				xmalloc(sizeof(priority_factors_object_t));
+			slurm_copy_priority_factors_object(
+				rec->factors, job_ptr->prio_factors);
+			rec->factors->job_id = job_ptr->job_id;
+			rec->factors->user_id = job_ptr->user_id;
+			rec->account = xstrdup(job_ptr->account);
+			rec->mcs_label = xstrdup(job_ptr->mcs_label);
+			list_append(factors_cache_list, rec);
+		}
+		list_iterator_destroy(itr);
+	}
+	unlock_slurmctld(job_read_lock);
+
+	factors_cache_time = now;
+}
+
 static void *_cleanup_thread(void *no_data)
 {
 	pthread_join(decay_handler_thread, NULL);
@@ -1683,6 +1822,10 @@ int fini ( void )
 
 	xfree(weight_tres);
 
+	slurm_mutex_lock(&factors_cache_lock);
+	FREE_NULL_LIST(factors_cache_list);
+	slurm_mutex_unlock(&factors_cache_lock);
+
 	slurm_mutex_unlock(&decay_lock);
 
 	return SLURM_SUCCESS;
@@ -1705,6 +1848,7 @@ extern void priority_p_reconfig(bool assoc_clear)
 	reconfig = 1;
 	prevflags = flags;
 	_internal_setup();
+	_factors_cache_invalidate();
 
 	/* Since Fair Tree uses a different shares calculation method, we
 	 * must reassign shares at reconfigure if the algorithm was switched to
@@ -1789,66 +1933,41 @@ extern List priority_p_get_priority_factors_list(
 	List ret_list = NULL;
 	ListIterator itr;
 	priority_factors_object_t *obj = NULL;
-	struct job_record *job_ptr = NULL;
+	factors_cache_rec_t *rec;
 	time_t start_time = time(NULL);
-
-	/* Read lock on jobs, nodes, and partitions */
-	slurmctld_lock_t job_read_lock =
-		{ NO_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+	uint32_t calc_period = slurm_get_priority_calc_period();
 
 	xassert(req_msg);
 	req_job_list = req_msg->job_id_list;
 	req_user_list = req_msg->uid_list;
 
-	lock_slurmctld(job_read_lock);
-	if (job_list && list_count(job_list)) {
-		ret_list = list_create(slurm_destroy_priority_factors_object);
-		itr = list_iterator_create(job_list);
-		while ((job_ptr = list_next(itr))) {
-			if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
-			    !IS_JOB_PENDING(job_ptr))
-				continue;
-
-			/*
-			 * This means the job is not eligible yet
-			 */
-			if (!job_ptr->details->begin_time
-			    || (job_ptr->details->begin_time > start_time))
-				continue;
+	slurm_mutex_lock(&factors_cache_lock);
+	if (!factors_cache_list ||
+	    (difftime(start_time, factors_cache_time) >= calc_period))
+		_factors_cache_rebuild(start_time);
 
-			/*
-			 * 0 means the job is held
-			 */
-			if (job_ptr->priority == 0)
-				continue;
-
-			/*
-			 * Priority has been set elsewhere (e.g. by SlurmUser)
-			 */
-			if (job_ptr->direct_set_prio)
-				continue;
-
-			if (_filter_job(job_ptr, req_job_list, req_user_list))
+	if (list_count(factors_cache_list)) {
+		ret_list = list_create(slurm_destroy_priority_factors_object);
+		itr = list_iterator_create(factors_cache_list);
+		while ((rec = list_next(itr))) {
+			if (_filter_job(rec->factors->job_id,
+					rec->factors->user_id,
+					req_job_list, req_user_list))
 				continue;
 
 			if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
-			    (job_ptr->user_id != uid) &&
+			    (rec->factors->user_id != uid) &&
 			    !validate_operator(uid) &&
 			    (((slurm_mcs_get_privatedata() == 0) &&
 			      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-							    job_ptr->account))||
+							    rec->account)) ||
 			     ((slurm_mcs_get_privatedata() == 1) &&
-			      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label)
+			      (mcs_g_check_mcs_label(uid, rec->mcs_label)
 			       != 0))))
 				continue;
 
 			obj = xmalloc(sizeof(priority_factors_object_t));
-
-			slurm_copy_priority_factors_object(
-				obj, job_ptr->prio_factors);
-
-			obj->job_id = job_ptr->job_id;
-			obj->user_id = job_ptr->user_id;
+			slurm_copy_priority_factors_object(obj, rec->factors);
 			list_append(ret_list, obj);
 		}
 		list_iterator_destroy(itr);
@@ -1856,7 +1975,7 @@ extern List priority_p_get_priority_factors_list(
 			FREE_NULL_LIST(ret_list);
 		}
 	}
-	unlock_slurmctld(job_read_lock);
+	slurm_mutex_unlock(&factors_cache_lock);
 
 	return ret_list;
 }
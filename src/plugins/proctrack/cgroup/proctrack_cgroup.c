@@ -231,6 +231,13 @@ int _slurm_cgroup_create(stepd_step_rec_t *job, uint64_t id, uid_t uid, gid_t gi
 		goto bail;
 	}
 
+	/* inhibit release agent for the step cgroup thus letting
+	 * slurmstepd being able to add new pids to the container
+	 * when the job ends (TaskEpilog,...). Clearing the notify flag
+	 * before instantiation lets the flag be written once at cgroup
+	 * creation instead of being set and then rewritten. */
+	step_freezer_cg.notify = 0;
+
 	if ((xcgroup_instantiate(&user_freezer_cg) != XCGROUP_SUCCESS) ||
 	    (xcgroup_instantiate(&job_freezer_cg)  != XCGROUP_SUCCESS) ||
 	    (xcgroup_instantiate(&step_freezer_cg) != XCGROUP_SUCCESS)) {
@@ -240,10 +247,6 @@ int _slurm_cgroup_create(stepd_step_rec_t *job, uint64_t id, uid_t uid, gid_t gi
 		goto bail;
 	}
 
-	/* inhibit release agent for the step cgroup thus letting
-	 * slurmstepd being able to add new pids to the container
-	 * when the job ends (TaskEpilog,...) */
-	xcgroup_set_param(&step_freezer_cg, "notify_on_release", "0");
 	slurm_freezer_init = true;
 
 	xcgroup_unlock(&freezer_cg);
@@ -94,6 +94,90 @@ const uint32_t plugin_version   = SLURM_VERSION_NUMBER;
 static uint64_t debug_flags = 0;
 static pthread_mutex_t route_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/* Cache of computed forwarding splits, keyed by the ranged string of
+ * the message hostlist. Broadcast RPCs repeatedly split the same node
+ * sets (all nodes, whole partitions), so repeats become a lookup
+ * instead of a switch table scan with per-switch bitmap operations.
+ * Cleared on reconfigure, when the topology may have changed. */
+#define ROUTE_CACHE_SIZE 128
+
+typedef struct route_cache_entry {
+	char *nodes;		/* ranged string of the message hostlist */
+	char **sub_lists;	/* ranged strings of the forwarding split */
+	int sub_cnt;		/* count of sub_lists entries */
+	time_t last_use;	/* for LRU eviction */
+} route_cache_entry_t;
+
+static List route_cache = NULL;
+
+static void _route_cache_free(void *x)
+{
+	route_cache_entry_t *cache_entry = (route_cache_entry_t *) x;
+	int i;
+
+	if (cache_entry) {
+		xfree(cache_entry->nodes);
+		for (i = 0; i < cache_entry->sub_cnt; i++)
+			xfree(cache_entry->sub_lists[i]);
+		xfree(cache_entry->sub_lists);
+		xfree(cache_entry);
+	}
+}
+
+/* Find a route_cache_entry_t by node list (for use by list_find_first) */
+static int _route_cache_find(void *x, void *key)
+{
+	route_cache_entry_t *cache_entry = (route_cache_entry_t *) x;
+
+	if (xstrcmp(cache_entry->nodes, (char *) key))
+		return 0;
+	return 1;
+}
+
+/* Record a computed forwarding split in the cache, evicting the least
+ * recently used entry if full. The route_lock must not be held. */
+static void _route_cache_insert(char *nodes, hostlist_t *sp_hl, int count)
+{
+	route_cache_entry_t *cache_entry, *oldest;
+	ListIterator iter;
+	int i;
+
+	slurm_mutex_lock(&route_lock);
+	if (!route_cache)
+		route_cache = list_create(_route_cache_free);
+	if (list_find_first(route_cache, _route_cache_find, nodes)) {
+		/* Computed concurrently by another thread */
+		slurm_mutex_unlock(&route_lock);
+		return;
+	}
+	if (list_count(route_cache) >= ROUTE_CACHE_SIZE) {
+		oldest = NULL;
+		iter = list_iterator_create(route_cache);
+		while ((cache_entry = (route_cache_entry_t *)
+				      list_next(iter))) {
+			if (!oldest ||
+			    (cache_entry->last_use < oldest->last_use))
+				oldest = cache_entry;
+		}
+		list_iterator_destroy(iter);
+		if (oldest)
+			(void) list_delete_all(route_cache,
+					       _route_cache_find,
+					       oldest->nodes);
+	}
+	cache_entry = xmalloc(sizeof(route_cache_entry_t));
+	cache_entry->nodes = xstrdup(nodes);
+	cache_entry->sub_cnt = count;
+	cache_entry->sub_lists = xmalloc(count * sizeof(char *));
+	for (i = 0; i < count; i++) {
+		cache_entry->sub_lists[i] =
+			hostlist_ranged_string_xmalloc(sp_hl[i]);
+	}
+	cache_entry->last_use = time(NULL);
+	list_append(route_cache, cache_entry);
+	slurm_mutex_unlock(&route_lock);
+}
+
 /*****************************************************************************\
  *  Functions required of all plugins
 \*****************************************************************************/
@@ -119,6 +203,9 @@ extern int init(void)
  */
 extern int fini(void)
 {
+	slurm_mutex_lock(&route_lock);
+	FREE_NULL_LIST(route_cache);
+	slurm_mutex_unlock(&route_lock);
 	return SLURM_SUCCESS;
 }
 
@@ -144,12 +231,29 @@ extern int route_p_split_hostlist(hostlist_t hl,
 				  int* count, uint16_t tree_width)
 {
 	int i, j, k, hl_ndx, msg_count, sw_count, lst_count;
-	char  *buf;
+	char  *buf, *key;
+	route_cache_entry_t *cache_entry;
 	bitstr_t *nodes_bitmap = NULL;		/* nodes in message list */
 	bitstr_t *fwd_bitmap = NULL;		/* nodes in forward list */
 
 	msg_count = hostlist_count(hl);
+	key = hostlist_ranged_string_xmalloc(hl);
 	slurm_mutex_lock(&route_lock);
+	if (route_cache &&
+	    (cache_entry = (route_cache_entry_t *)
+			   list_find_first(route_cache, _route_cache_find,
+					   key))) {
+		*sp_hl = (hostlist_t *) xmalloc(cache_entry->sub_cnt *
+						sizeof(hostlist_t));
+		for (i = 0; i < cache_entry->sub_cnt; i++)
+			(*sp_hl)[i] = hostlist_create(
+						cache_entry->sub_lists[i]);
+		*count = cache_entry->sub_cnt;
+		cache_entry->last_use = time(NULL);
+		slurm_mutex_unlock(&route_lock);
+		xfree(key);
+		return SLURM_SUCCESS;
+	}
 	if (switch_record_cnt == 0) {
 		/* configs have not already been processed */
 		slurm_conf_init(NULL);
@@ -206,6 +310,7 @@ extern int route_p_split_hostlist(hostlist_t hl,
 		}
 		FREE_NULL_BITMAP(nodes_bitmap);
 		xfree(*sp_hl);
+		xfree(key);
 		return route_split_hostlist_treewidth(
 			hl, sp_hl, count, tree_width);
 	}
@@ -213,6 +318,7 @@ extern int route_p_split_hostlist(hostlist_t hl,
 		/* This is a leaf switch. Construct list based on TreeWidth */
 		FREE_NULL_BITMAP(nodes_bitmap);
 		xfree(*sp_hl);
+		xfree(key);
 		return route_split_hostlist_treewidth(
 			hl, sp_hl, count, tree_width);
 	}
@@ -246,6 +352,12 @@ extern int route_p_split_hostlist(hostlist_t hl,
 	}
 	FREE_NULL_BITMAP(nodes_bitmap);
 
+	/* Cache only splits computed from the switch table. The treewidth
+	 * fallback above consumes the input hostlist, so caching it would
+	 * change caller-visible behavior on a hit. */
+	_route_cache_insert(key, *sp_hl, hl_ndx);
+	xfree(key);
+
 	*count = hl_ndx;
 	return SLURM_SUCCESS;
 
@@ -259,6 +371,9 @@ extern int route_p_split_hostlist(hostlist_t hl,
 extern int route_p_reconfigure (void)
 {
 	debug_flags = slurm_get_debug_flags();
+	slurm_mutex_lock(&route_lock);
+	FREE_NULL_LIST(route_cache);
+	slurm_mutex_unlock(&route_lock);
 	return SLURM_SUCCESS;
 }
 
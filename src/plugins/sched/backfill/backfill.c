@@ -76,6 +76,7 @@
 #include "src/common/slurm_accounting_storage.h"
 #include "src/common/slurm_mcs.h"
 #include "src/common/slurm_protocol_api.h"
+#include "src/common/timers.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -86,6 +87,7 @@
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/node_scheduler.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/slurmctld.h"
@@ -105,7 +107,7 @@
 typedef struct node_space_map {
 	time_t begin_time;
 	time_t end_time;
-	bitstr_t *avail_bitmap;
+	bit_cow_t *avail_bitmap;	/* shared, copied on write */
 	int next;	/* next record, by time, zero termination */
 } node_space_map_t;
 
@@ -132,6 +134,8 @@ static int max_backfill_job_per_part = 0;
 static int max_backfill_job_per_user = 0;
 static int max_backfill_jobs_start = 0;
 static bool backfill_continue = false;
+static bool bf_interleave_parts = false;
+static bool bf_rpc_snapshot = false;
 static int defer_rpc_cnt = 0;
 static int sched_timeout = SCHED_TIMEOUT;
 static int yield_sleep   = YIELD_SLEEP;
@@ -203,7 +207,8 @@ static void _dump_node_space_table(node_space_map_t *node_space_ptr)
 				    begin_buf, sizeof(begin_buf));
 		slurm_make_time_str(&node_space_ptr[i].end_time,
 				    end_buf, sizeof(end_buf));
-		node_list = bitmap2node_name(node_space_ptr[i].avail_bitmap);
+		node_list = bitmap2node_name(
+			bit_cow_get(node_space_ptr[i].avail_bitmap));
 		info("Begin:%s End:%s Nodes:%s",
 		     begin_buf, end_buf, node_list);
 		xfree(node_list);
@@ -636,6 +641,23 @@ static void _load_config(void)
 		backfill_continue = false;
 	}
 
+	/* bf_interleave_parts spreads the job test budget across partitions
+	 * rather than letting one deep partition queue consume all of it */
+	if (sched_params && (strstr(sched_params, "bf_interleave_parts"))) {
+		bf_interleave_parts = true;
+	} else {
+		bf_interleave_parts = false;
+	}
+
+	/* bf_snapshot makes backfill plan against its node-space snapshot
+	 * and release locks between individual job tests whenever RPCs are
+	 * pending, rather than holding locks for bf_yield_interval */
+	if (sched_params && (strstr(sched_params, "bf_snapshot"))) {
+		bf_rpc_snapshot = true;
+	} else {
+		bf_rpc_snapshot = false;
+	}
+
 	if (sched_params &&
 	    (tmp_ptr = strstr(sched_params, "bf_yield_interval="))) {
 		sched_timeout = atoi(tmp_ptr + 18);
@@ -731,6 +753,9 @@ extern void *backfill_agent(void *args)
 		error("%s: cannot set my name to %s %m", __func__, "backfill");
 	}
 #endif
+	/* Keep this thread and its snapshot copies of the node and job
+	 * data on one NUMA node */
+	ctld_numa_bind_sched_thread();
 	_load_config();
 	last_backfill_time = time(NULL);
 	while (!stop_backfill) {
@@ -759,7 +784,9 @@ extern void *backfill_agent(void *args)
 			continue;
 		}
 		lock_slurmctld(all_locks);
+		prof_region_begin("backfill");
 		(void) _attempt_backfill();
+		prof_region_end("backfill");
 		last_backfill_time = time(NULL);
 		(void) bb_g_job_try_stage_in();
 		unlock_slurmctld(all_locks);
@@ -849,11 +876,70 @@ static bool _job_part_valid(struct job_record *job_ptr,
 	return rc;
 }
 
+/* Reorder the priority sorted job queue so that candidates from different
+ * partitions alternate, round-robin in order of each partition's highest
+ * priority candidate. With a bounded job test budget (bf_max_job_test,
+ * bf_yield_interval) this prevents one partition with a deep queue from
+ * consuming the entire budget while other partitions starve. Relative
+ * candidate order within each partition is preserved. */
+static void _interleave_queue_by_part(List job_queue)
+{
+	job_queue_rec_t **recs;
+	struct part_record **parts;
+	int *rec_part_inx, *part_cursor;
+	int rec_cnt, part_cnt = 0;
+	int i, j, added;
+
+	rec_cnt = list_count(job_queue);
+	if (rec_cnt < 2)
+		return;
+
+	recs         = xmalloc(sizeof(job_queue_rec_t *) * rec_cnt);
+	parts        = xmalloc(sizeof(struct part_record *) * rec_cnt);
+	rec_part_inx = xmalloc(sizeof(int) * rec_cnt);
+	part_cursor  = xmalloc(sizeof(int) * rec_cnt);
+
+	/* Dequeue in priority order, noting each record's partition.
+	 * Partitions are numbered in order of first appearance, which is
+	 * the order of their highest priority candidates. */
+	for (i = 0; i < rec_cnt; i++) {
+		recs[i] = (job_queue_rec_t *) list_dequeue(job_queue);
+		for (j = 0; j < part_cnt; j++) {
+			if (parts[j] == recs[i]->part_ptr)
+				break;
+		}
+		if (j == part_cnt)
+			parts[part_cnt++] = recs[i]->part_ptr;
+		rec_part_inx[i] = j;
+	}
+
+	/* Round-robin over the partitions, appending each partition's next
+	 * not yet consumed candidate */
+	for (added = 0; added < rec_cnt; ) {
+		for (j = 0; j < part_cnt; j++) {
+			for (i = part_cursor[j]; i < rec_cnt; i++) {
+				if (rec_part_inx[i] != j)
+					continue;
+				list_append(job_queue, recs[i]);
+				part_cursor[j] = i + 1;
+				added++;
+				break;
+			}
+		}
+	}
+
+	xfree(recs);
+	xfree(parts);
+	xfree(rec_part_inx);
+	xfree(part_cursor);
+}
+
 static int _attempt_backfill(void)
 {
 	DEF_TIMERS;
 	bool filter_root = false;
 	List job_queue;
+	xarena_t *queue_arena;
 	job_queue_rec_t *job_queue_rec;
 	slurmdb_qos_rec_t *qos_ptr = NULL;
 	int bb, i, j, node_space_recs, mcs_select = 0;
@@ -919,7 +1005,10 @@ static int _attempt_backfill(void)
 	if (slurm_get_root_filter())
 		filter_root = true;
 
-	job_queue = build_job_queue(true, true);
+	prof_region_begin("bf_build_queue");
+	queue_arena = xarena_create(0);
+	job_queue = build_job_queue(true, true, queue_arena);
+	prof_region_end("bf_build_queue");
 	job_test_count = list_count(job_queue);
 	if (job_test_count == 0) {		
 		if (debug_flags & DEBUG_FLAG_BACKFILL)
@@ -927,13 +1016,14 @@ static int _attempt_backfill(void)
 		else
 			debug("backfill: no jobs to backfill");
 		FREE_NULL_LIST(job_queue);
+		xarena_destroy(queue_arena);
 		return 0;
 	} else {
 		debug("backfill: %u jobs to backfill", job_test_count);
 		job_test_count = 0;
 	}
 
-	if (backfill_continue)
+	if (backfill_continue || bf_rpc_snapshot)
 		_clear_job_start_times();
 
 	gettimeofday(&bf_time1, NULL);
@@ -951,7 +1041,8 @@ static int _attempt_backfill(void)
 	node_space[0].begin_time = sched_start;
 	window_end = sched_start + backfill_window;
 	node_space[0].end_time = window_end;
-	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
+	node_space[0].avail_bitmap =
+		bit_cow_create(bit_copy(avail_node_bitmap));
 	node_space[0].next = 0;
 	node_space_recs = 1;
 	if (debug_flags & DEBUG_FLAG_BACKFILL_MAP)
@@ -976,6 +1067,8 @@ static int _attempt_backfill(void)
 		njobs = xmalloc(BF_MAX_USERS * sizeof(uint16_t));
 	}
 	sort_job_queue(job_queue);
+	if (bf_interleave_parts)
+		_interleave_queue_by_part(job_queue);
 	while (1) {
 		job_queue_rec = (job_queue_rec_t *) list_pop(job_queue);
 		if (!job_queue_rec) {
@@ -985,11 +1078,12 @@ static int _attempt_backfill(void)
 		}
 		if (slurmctld_config.shutdown_time ||
 		    (difftime(time(NULL),orig_sched_start)>=backfill_interval)){
-			xfree(job_queue_rec);
 			break;
 		}
 		if (((defer_rpc_cnt > 0) &&
 		     (slurmctld_config.server_thread_count >= defer_rpc_cnt)) ||
+		    (bf_rpc_snapshot && job_test_count &&
+		     (slurmctld_config.server_thread_count > 0)) ||
 		    (_delta_tv(&start_tv) >= sched_timeout)) {
 			if (debug_flags & DEBUG_FLAG_BACKFILL) {
 				END_TIMER;
@@ -998,7 +1092,12 @@ static int _attempt_backfill(void)
 				     slurmctld_diag_stats.bf_last_depth,
 				     job_test_count, TIME_STR);
 			}
-			if ((_yield_locks(yield_sleep) && !backfill_continue) ||
+			/* In bf_snapshot mode keep planning against our
+			 * node-space snapshot across lock yields; each job
+			 * is re-validated before use and each start decision
+			 * is committed while the locks are held. */
+			if ((_yield_locks(yield_sleep) && !backfill_continue &&
+			     !bf_rpc_snapshot) ||
 			    (slurmctld_conf.last_update != config_update) ||
 			    (last_part_update != part_update)) {
 				if (debug_flags & DEBUG_FLAG_BACKFILL) {
@@ -1009,7 +1108,6 @@ static int _attempt_backfill(void)
 					     job_test_count);
 				}
 				rc = 1;
-				xfree(job_queue_rec);
 				break;
 			}
 			/* Reset backfill scheduling timers, resume testing */
@@ -1026,7 +1124,6 @@ static int _attempt_backfill(void)
 		 * been cancelled and purged. Validate pointer here. */
 		if ((job_ptr->magic  != JOB_MAGIC) ||
 		    (job_ptr->job_id != job_queue_rec->job_id)) {
-			xfree(job_queue_rec);
 			continue;
 		}
 		if ((job_ptr->array_task_id != job_queue_rec->array_task_id) &&
@@ -1111,7 +1208,6 @@ static int _attempt_backfill(void)
 
 		orig_start_time = job_ptr->start_time;
 		orig_time_limit = job_ptr->time_limit;
-		xfree(job_queue_rec);
 
 next_task:
 		job_test_count++;
@@ -1392,7 +1488,8 @@ next_task:
 				;
 			else if (node_space[j].begin_time <= end_time) {
 				bit_and(avail_bitmap,
-					node_space[j].avail_bitmap);
+					bit_cow_get(node_space[j].
+						    avail_bitmap));
 			} else
 				break;
 			if ((j = node_space[j].next) == 0)
@@ -1745,12 +1842,13 @@ next_task:
 	FREE_NULL_BITMAP(resv_bitmap);
 
 	for (i=0; ; ) {
-		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+		bit_cow_free(&node_space[i].avail_bitmap);
 		if ((i = node_space[i].next) == 0)
 			break;
 	}
 	xfree(node_space);
 	FREE_NULL_LIST(job_queue);
+	xarena_destroy(queue_arena);
 	gettimeofday(&bf_time2, NULL);
 	_do_diag_stats(&bf_time1, &bf_time2);
 	if (debug_flags & DEBUG_FLAG_BACKFILL) {
@@ -1860,7 +1958,8 @@ static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
 		if ((node_space[j].begin_time != now) &&
 		    (node_space[j].begin_time < job_ptr->end_time) &&
 		    (!bit_super_set(job_ptr->node_bitmap,
-				    node_space[j].avail_bitmap))) {
+				    bit_cow_get(node_space[j].
+						avail_bitmap)))) {
 			/* Job overlaps pending job's resource reservation */
 			resv_delay = difftime(node_space[j].begin_time, now);
 			resv_delay /= 60;	/* seconds to minutes */
@@ -1927,7 +2026,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			node_space[i].end_time = node_space[j].end_time;
 			node_space[j].end_time = start_time;
 			node_space[i].avail_bitmap =
-				bit_copy(node_space[j].avail_bitmap);
+				bit_cow_ref(node_space[j].avail_bitmap);
 			node_space[i].next = node_space[j].next;
 			node_space[j].next = i;
 			(*node_space_recs)++;
@@ -1947,8 +2046,8 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 								 end_time;
 					node_space[j].end_time = end_reserve;
 					node_space[i].avail_bitmap =
-						bit_copy(node_space[j].
-							 avail_bitmap);
+						bit_cow_ref(node_space[j].
+							    avail_bitmap);
 					node_space[i].next = node_space[j].next;
 					node_space[j].next = i;
 					(*node_space_recs)++;
@@ -1967,7 +2066,8 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 	for (j = 0; ; ) {
 		if ((node_space[j].begin_time >= start_time) &&
 		    (node_space[j].end_time <= end_reserve))
-			bit_and(node_space[j].avail_bitmap, res_bitmap);
+			bit_and(bit_cow_modify(&node_space[j].avail_bitmap),
+				res_bitmap);
 		if ((node_space[j].begin_time >= end_reserve) ||
 		    ((j = node_space[j].next) == 0))
 			break;
@@ -1978,14 +2078,16 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 	for (i = 0; ; ) {
 		if ((j = node_space[i].next) == 0)
 			break;
-		if (!bit_equal(node_space[i].avail_bitmap,
-			       node_space[j].avail_bitmap)) {
+		if ((bit_cow_get(node_space[i].avail_bitmap) !=
+		     bit_cow_get(node_space[j].avail_bitmap)) &&
+		    !bit_equal(bit_cow_get(node_space[i].avail_bitmap),
+			       bit_cow_get(node_space[j].avail_bitmap))) {
 			i = j;
 			continue;
 		}
 		node_space[i].end_time = node_space[j].end_time;
 		node_space[i].next = node_space[j].next;
-		FREE_NULL_BITMAP(node_space[j].avail_bitmap);
+		bit_cow_free(&node_space[j].avail_bitmap);
 		break;
 	}
 }
@@ -2008,7 +2110,8 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 	for (j=0; ; ) {
 		if ((node_space[j].end_time   > start_time) &&
 		    (node_space[j].begin_time < end_reserve) &&
-		    (!bit_super_set(use_bitmap, node_space[j].avail_bitmap))) {
+		    (!bit_super_set(use_bitmap,
+				    bit_cow_get(node_space[j].avail_bitmap)))) {
 			overlap = true;
 			break;
 		}
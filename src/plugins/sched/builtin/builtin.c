@@ -150,6 +150,7 @@ static void _compute_start_times(void)
 {
 	int j, rc = SLURM_SUCCESS, job_cnt = 0;
 	List job_queue;
+	xarena_t *queue_arena;
 	job_queue_rec_t *job_queue_rec;
 	List preemptee_candidates = NULL;
 	struct job_record *job_ptr;
@@ -163,12 +164,12 @@ static void _compute_start_times(void)
 	sched_start = now;
 	last_job_alloc = now - 1;
 	alloc_bitmap = bit_alloc(node_record_count);
-	job_queue = build_job_queue(true, false);
+	queue_arena = xarena_create(0);
+	job_queue = build_job_queue(true, false, queue_arena);
 	sort_job_queue(job_queue);
 	while ((job_queue_rec = (job_queue_rec_t *) list_pop(job_queue))) {
 		job_ptr  = job_queue_rec->job_ptr;
 		part_ptr = job_queue_rec->part_ptr;
-		xfree(job_queue_rec);
 		if (part_ptr != job_ptr->part_ptr)
 			continue;	/* Only test one partition */
 
@@ -243,6 +244,7 @@ static void _compute_start_times(void)
 		}
 	}
 	FREE_NULL_LIST(job_queue);
+	xarena_destroy(queue_arena);
 	FREE_NULL_BITMAP(alloc_bitmap);
 }
 
@@ -93,6 +93,7 @@
 \*****************************************************************************/
 
 #include <inttypes.h>
+#include <pthread.h>
 #include <time.h>
 
 #include "dist_tasks.h"
@@ -922,6 +923,22 @@ clear_bit:	/* This node is not usable by this job */
  * RET bitmap of cores available for use by this job or reservation
  * NOTE: Call bit_free() on return value to avoid memory leak.
  */
+/* Cache of the core bitmap last built without core specialization. That
+ * bitmap depends only upon static node topology (core counts and offsets),
+ * not upon allocations, so repeated job tests over the same candidate node
+ * set (e.g. every job in a backfill pass) can reuse the prior computation.
+ * The cache is flushed when the select node table is rebuilt. */
+static bitstr_t *cache_node_map = NULL;
+static bitstr_t *cache_core_map = NULL;
+
+/* Clear the cached core bitmap, call after any rebuild of the select
+ * plugin's global core data */
+extern void clear_core_bitmap_cache(void)
+{
+	FREE_NULL_BITMAP(cache_node_map);
+	FREE_NULL_BITMAP(cache_core_map);
+}
+
 extern bitstr_t *make_core_bitmap(bitstr_t *node_map, uint16_t core_spec)
 {
 	uint32_t c, nodes, size;
@@ -930,15 +947,21 @@ extern bitstr_t *make_core_bitmap(bitstr_t *node_map, uint16_t core_spec)
 	uint32_t coff;
 	uint16_t i;
 	struct node_record *node_ptr;
-
-	nodes = bit_size(node_map);
-	size = cr_get_coremap_offset(nodes);
-	bitstr_t *core_map = bit_alloc(size);
+	bitstr_t *core_map;
 
 	if ((core_spec != (uint16_t) NO_VAL) &&
 	    (core_spec & CORE_SPEC_THREAD))	/* Reserving threads */
 		core_spec = (uint16_t) NO_VAL;	/* Don't remove cores */
 
+	if ((core_spec == (uint16_t) NO_VAL) && cache_node_map &&
+	    (bit_size(cache_node_map) == bit_size(node_map)) &&
+	    bit_equal(cache_node_map, node_map))
+		return bit_copy(cache_core_map);
+
+	nodes = bit_size(node_map);
+	size = cr_get_coremap_offset(nodes);
+	core_map = bit_alloc(size);
+
 	n_first = bit_ffs(node_map);
 	if (n_first == -1)
 		n_last = -2;
@@ -987,6 +1010,11 @@ extern bitstr_t *make_core_bitmap(bitstr_t *node_map, uint16_t core_spec)
 				bit_clear(core_map, c + i);
 		}
 	}
+	if (core_spec == (uint16_t) NO_VAL) {
+		clear_core_bitmap_cache();
+		cache_node_map = bit_copy(node_map);
+		cache_core_map = bit_copy(core_map);
+	}
 	return core_map;
 }
 
@@ -1158,6 +1186,140 @@ static uint32_t _socks_per_node(struct job_record *job_ptr)
  * OUT: cpu_cnt    - number of cpus that can be used by this job
  * IN: test_only   - ignore allocated memory check
  */
+/* Parallel node scoring for _get_res_usage(). Worker threads claim chunks
+ * of the node table from a shared cursor (idle workers steal the chunks a
+ * loaded worker would otherwise process) and run _can_job_run_on_node()
+ * against a private copy of the core bitmap, so concurrent updates can not
+ * race on core_map words shared by adjacent nodes. Each node is scored by
+ * exactly one worker and that worker's copy holds the authoritative core
+ * selection for it, merged back after the join. */
+#define SCORE_THREAD_CNT	4	/* workers, including calling thread */
+#define SCORE_CHUNK_NODES	16	/* nodes claimed per cursor advance */
+#define SCORE_THREAD_MIN_NODES	64	/* minimum candidates to use workers */
+
+struct score_workq {
+	struct job_record *job_ptr;
+	bitstr_t *node_map;
+	uint32_t cr_node_cnt;
+	struct node_use_record *node_usage;
+	uint16_t cr_type;
+	bool test_only;
+	bitstr_t *part_core_map;
+	uint32_t s_p_n;
+	uint32_t *gres_cpus;
+	uint16_t *cpu_cnt;
+	uint8_t *owner;		/* which worker scored each node */
+	uint32_t next_node;	/* shared work cursor */
+};
+
+struct score_worker {
+	struct score_workq *workq;
+	bitstr_t *core_map;	/* private copy of the core bitmap */
+	uint8_t id;
+};
+
+static void *_score_nodes_worker(void *arg)
+{
+	struct score_worker *worker = (struct score_worker *) arg;
+	struct score_workq *workq = worker->workq;
+	uint32_t n, first, last;
+
+	while (1) {
+		first = __sync_fetch_and_add(&workq->next_node,
+					     SCORE_CHUNK_NODES);
+		if (first >= workq->cr_node_cnt)
+			break;
+		last = MIN(first + SCORE_CHUNK_NODES, workq->cr_node_cnt);
+		for (n = first; n < last; n++) {
+			if (!bit_test(workq->node_map, n))
+				continue;
+			if (workq->gres_cpus && (workq->gres_cpus[n] == 0))
+				continue;
+			workq->owner[n] = worker->id;
+			workq->cpu_cnt[n] = _can_job_run_on_node(
+				workq->job_ptr, worker->core_map, n,
+				workq->s_p_n, workq->node_usage,
+				workq->cr_type, workq->test_only,
+				workq->part_core_map);
+		}
+	}
+	return NULL;
+}
+
+/* Score all candidate nodes with a worker pool, then merge each scored
+ * node's core range from the scoring worker's private bitmap back into
+ * core_map. Arguments as for _get_res_usage(). */
+static void _score_nodes_parallel(struct job_record *job_ptr,
+				  bitstr_t *node_map, bitstr_t *core_map,
+				  uint32_t cr_node_cnt,
+				  struct node_use_record *node_usage,
+				  uint16_t cr_type, bool test_only,
+				  bitstr_t *part_core_map, uint32_t s_p_n,
+				  uint32_t *gres_cpus, uint16_t *cpu_cnt)
+{
+	struct score_workq workq;
+	struct score_worker workers[SCORE_THREAD_CNT];
+	pthread_t worker_id[SCORE_THREAD_CNT];
+	pthread_attr_t attr;
+	bitstr_t *scored_map;
+	uint32_t b, n, start_bit, end_bit;
+	int w, spawned = 0;
+
+	workq.job_ptr       = job_ptr;
+	workq.node_map      = node_map;
+	workq.cr_node_cnt   = cr_node_cnt;
+	workq.node_usage    = node_usage;
+	workq.cr_type       = cr_type;
+	workq.test_only     = test_only;
+	workq.part_core_map = part_core_map;
+	workq.s_p_n         = s_p_n;
+	workq.gres_cpus     = gres_cpus;
+	workq.cpu_cnt       = cpu_cnt;
+	workq.owner         = xmalloc(cr_node_cnt * sizeof(uint8_t));
+	workq.next_node     = 0;
+	memset(workq.owner, 0xff, cr_node_cnt * sizeof(uint8_t));
+
+	for (w = 0; w < SCORE_THREAD_CNT; w++) {
+		workers[w].workq    = &workq;
+		workers[w].core_map = bit_copy(core_map);
+		workers[w].id       = w;
+	}
+
+	slurm_attr_init(&attr);
+	for (w = 1; w < SCORE_THREAD_CNT; w++) {
+		if (pthread_create(&worker_id[w], &attr,
+				   _score_nodes_worker, &workers[w])) {
+			error("cons_res: pthread_create: %m");
+			break;	/* remaining work done by this thread */
+		}
+		spawned++;
+	}
+	slurm_attr_destroy(&attr);
+
+	/* The calling thread works too, as worker zero */
+	(void) _score_nodes_worker(&workers[0]);
+	for (w = 1; w <= spawned; w++)
+		pthread_join(worker_id[w], NULL);
+
+	for (n = 0; n < cr_node_cnt; n++) {
+		if (workq.owner[n] == 0xff)
+			continue;
+		scored_map = workers[workq.owner[n]].core_map;
+		start_bit = cr_get_coremap_offset(n);
+		end_bit   = cr_get_coremap_offset(n+1) - 1;
+		for (b = start_bit; b <= end_bit; b++) {
+			if (bit_test(scored_map, b))
+				bit_set(core_map, b);
+			else
+				bit_clear(core_map, b);
+		}
+	}
+
+	for (w = 0; w < SCORE_THREAD_CNT; w++)
+		FREE_NULL_BITMAP(workers[w].core_map);
+	xfree(workq.owner);
+}
+
 static void _get_res_usage(struct job_record *job_ptr, bitstr_t *node_map,
 			   bitstr_t *core_map, uint32_t cr_node_cnt,
 			   struct node_use_record *node_usage,
@@ -1167,15 +1329,50 @@ static void _get_res_usage(struct job_record *job_ptr, bitstr_t *node_map,
 	uint16_t *cpu_cnt;
 	uint32_t n;
 	uint32_t s_p_n = _socks_per_node(job_ptr);
+	uint32_t *gres_cpus = NULL;
+	List *node_gres_lists;
+
+	if (job_ptr->gres_list) {
+		/* Filter out nodes whose GRES counts can not satisfy the
+		 * job in a single locked pass, the full per node test
+		 * including core placement runs only on the remainder */
+		node_gres_lists = xmalloc(cr_node_cnt * sizeof(List));
+		for (n = 0; n < cr_node_cnt; n++) {
+			if (!bit_test(node_map, n))
+				continue;
+			if (node_usage[n].gres_list) {
+				node_gres_lists[n] = node_usage[n].gres_list;
+			} else {
+				node_gres_lists[n] = select_node_record[n].
+						     node_ptr->gres_list;
+			}
+		}
+		gres_cpus = xmalloc(cr_node_cnt * sizeof(uint32_t));
+		gres_plugin_job_test_batch(job_ptr->gres_list, node_gres_lists,
+					   node_map, cr_node_cnt, test_only,
+					   job_ptr->job_id, gres_cpus);
+		xfree(node_gres_lists);
+	}
 
 	cpu_cnt = xmalloc(cr_node_cnt * sizeof(uint16_t));
-	for (n = 0; n < cr_node_cnt; n++) {
-		if (!bit_test(node_map, n))
-			continue;
-		cpu_cnt[n] = _can_job_run_on_node(job_ptr, core_map, n, s_p_n,
-						  node_usage, cr_type,
-						  test_only, part_core_map);
+	if (bit_set_count(node_map) >= SCORE_THREAD_MIN_NODES) {
+		_score_nodes_parallel(job_ptr, node_map, core_map,
+				      cr_node_cnt, node_usage, cr_type,
+				      test_only, part_core_map, s_p_n,
+				      gres_cpus, cpu_cnt);
+	} else {
+		for (n = 0; n < cr_node_cnt; n++) {
+			if (!bit_test(node_map, n))
+				continue;
+			if (gres_cpus && (gres_cpus[n] == 0))
+				continue;  /* Insufficient GRES on this node */
+			cpu_cnt[n] = _can_job_run_on_node(job_ptr, core_map,
+							  n, s_p_n, node_usage,
+							  cr_type, test_only,
+							  part_core_map);
+		}
 	}
+	xfree(gres_cpus);
 	*cpu_cnt_ptr = cpu_cnt;
 }
 
@@ -2177,7 +2374,9 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	/* Identify usable leafs (within higher switch having best fit) */
 	for (j=0; j<switch_record_cnt; j++) {
 		if ((switch_record_table[j].level != 0) ||
-		    (!bit_super_set(switches_bitmap[j],
+		    (switch_desc_bitmap ?
+		     !bit_test(switch_desc_bitmap[best_fit_inx], j) :
+		     !bit_super_set(switches_bitmap[j],
 				    switches_bitmap[best_fit_inx]))) {
 			switches_node_cnt[j] = 0;
 		}
@@ -2624,7 +2823,9 @@ static int _eval_nodes_dfly(struct job_record *job_ptr, bitstr_t *bitmap,
 	/* Identify usable leafs (within higher switch having best fit) */
 	for (j = 0; j < switch_record_cnt; j++) {
 		if ((switch_record_table[j].level != 0) ||
-		    (!bit_super_set(switches_bitmap[j],
+		    (switch_desc_bitmap ?
+		     !bit_test(switch_desc_bitmap[best_fit_inx], j) :
+		     !bit_super_set(switches_bitmap[j],
 				    switches_bitmap[best_fit_inx]))) {
 			switches_node_cnt[j] = 0;
 		}
@@ -78,4 +78,8 @@ int cr_job_test(struct job_record *job_ptr, bitstr_t *node_bitmap,
  */
 extern bitstr_t *make_core_bitmap(bitstr_t *node_map, uint16_t core_spec);
 
+/* Clear the cached core bitmap, call after any rebuild of the select
+ * plugin's global core data */
+extern void clear_core_bitmap_cache(void);
+
 #endif /* !_CR_JOB_TEST_H */
@@ -2109,6 +2109,7 @@ extern int select_p_node_init(struct node_record *node_ptr, int node_cnt)
 	select_state_initializing = true;
 	select_fast_schedule = slurm_get_fast_schedule();
 	cr_init_global_core_data(node_ptr, node_cnt, select_fast_schedule);
+	clear_core_bitmap_cache();
 
 	_destroy_node_data(select_node_usage, select_node_record);
 	select_node_cnt  = node_cnt;
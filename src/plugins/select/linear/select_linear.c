@@ -98,6 +98,7 @@ int hypercube_dimensions __attribute__((weak_import));
 struct hypercube_switch *hypercube_switch_table __attribute__((weak_import));
 int hypercube_switch_cnt __attribute__((weak_import));
 struct hypercube_switch ***hypercube_switches __attribute__((weak_import));
+int *hypercube_node_table __attribute__((weak_import));
 
 #else
 slurm_ctl_conf_t slurmctld_conf;
@@ -113,6 +114,7 @@ int hypercube_dimensions;
 struct hypercube_switch *hypercube_switch_table;
 int hypercube_switch_cnt;
 struct hypercube_switch ***hypercube_switches;
+int *hypercube_node_table;
 #endif
 
 struct select_nodeinfo {
@@ -718,7 +720,7 @@ static int _job_test(struct job_record *job_ptr, bitstr_t *bitmap,
 		     uint32_t min_nodes, uint32_t max_nodes,
 		     uint32_t req_nodes)
 {
-	int i, index, error_code = EINVAL, sufficient;
+	int i, index, prev_index, error_code = EINVAL, sufficient;
 	int *consec_nodes;	/* how many nodes we can add from this
 				 * consecutive set of nodes */
 	int *consec_cpus;	/* how many nodes we can add from this
@@ -777,53 +779,60 @@ static int _job_test(struct job_record *job_ptr, bitstr_t *bitmap,
 	else
 		rem_nodes = min_nodes;
 
-	for (index = 0; index < select_node_cnt; index++) {
-		if (bit_test(bitmap, index)) {
-			if (consec_nodes[consec_index] == 0)
-				consec_start[consec_index] = index;
-			avail_cpus = _get_avail_cpus(job_ptr, index);
-			if (job_ptr->details->req_node_bitmap	&&
-			    (max_nodes > 0)			&&
-			    bit_test(job_ptr->details->req_node_bitmap,index)){
-				if (consec_req[consec_index] == -1) {
-					/* first required node in set */
-					consec_req[consec_index] = index;
+	/* Jump from one run of available nodes to the next with word-wise
+	 * bitmap searches rather than testing every node's bit */
+	prev_index = -1;
+	for (index = bit_ffs(bitmap); index >= 0;
+	     index = bit_ffs_from(bitmap, index + 1)) {
+		if ((prev_index >= 0) && (index > (prev_index + 1))) {
+			/* gap found, close out the current set */
+			if (consec_nodes[consec_index] == 0) {
+				consec_req[consec_index] = -1;
+				/* already picked up any required nodes */
+				/* re-use this record */
+			} else {
+				consec_end[consec_index] = prev_index;
+				if (++consec_index >= consec_size) {
+					consec_size *= 2;
+					xrealloc(consec_cpus,
+						 sizeof(int) * consec_size);
+					xrealloc(consec_nodes,
+						 sizeof(int) * consec_size);
+					xrealloc(consec_start,
+						 sizeof(int) * consec_size);
+					xrealloc(consec_end,
+						 sizeof(int) * consec_size);
+					xrealloc(consec_req,
+						 sizeof(int) * consec_size);
 				}
-				rem_nodes--;
-				max_nodes--;
-				rem_cpus   -= avail_cpus;
-				total_cpus += _get_total_cpus(index);
-			} else {	 /* node not required (yet) */
-				bit_clear(bitmap, index);
-				consec_cpus[consec_index] += avail_cpus;
-				consec_nodes[consec_index]++;
+				consec_cpus[consec_index] = 0;
+				consec_nodes[consec_index] = 0;
+				consec_req[consec_index] = -1;
 			}
-		} else if (consec_nodes[consec_index] == 0) {
-			consec_req[consec_index] = -1;
-			/* already picked up any required nodes */
-			/* re-use this record */
-		} else {
-			consec_end[consec_index] = index - 1;
-			if (++consec_index >= consec_size) {
-				consec_size *= 2;
-				xrealloc(consec_cpus,
-					 sizeof(int) * consec_size);
-				xrealloc(consec_nodes,
-					 sizeof(int) * consec_size);
-				xrealloc(consec_start,
-					 sizeof(int) * consec_size);
-				xrealloc(consec_end,
-					 sizeof(int) * consec_size);
-				xrealloc(consec_req,
-					 sizeof(int) * consec_size);
+		}
+		if (consec_nodes[consec_index] == 0)
+			consec_start[consec_index] = index;
+		avail_cpus = _get_avail_cpus(job_ptr, index);
+		if (job_ptr->details->req_node_bitmap	&&
+		    (max_nodes > 0)			&&
+		    bit_test(job_ptr->details->req_node_bitmap,index)){
+			if (consec_req[consec_index] == -1) {
+				/* first required node in set */
+				consec_req[consec_index] = index;
 			}
-			consec_cpus[consec_index] = 0;
-			consec_nodes[consec_index] = 0;
-			consec_req[consec_index] = -1;
+			rem_nodes--;
+			max_nodes--;
+			rem_cpus   -= avail_cpus;
+			total_cpus += _get_total_cpus(index);
+		} else {	 /* node not required (yet) */
+			bit_clear(bitmap, index);
+			consec_cpus[consec_index] += avail_cpus;
+			consec_nodes[consec_index]++;
 		}
+		prev_index = index;
 	}
 	if (consec_nodes[consec_index] != 0)
-		consec_end[consec_index++] = index - 1;
+		consec_end[consec_index++] = prev_index;
 
 #if SELECT_DEBUG
 	/* don't compile this, it slows things down too much */
@@ -1464,37 +1473,37 @@ static int _job_test_hypercube(struct job_record *job_ptr, bitstr_t *bitmap,
 		/* Add all the nodes on this switch */
 		hypercube_switch_table[i].avail_cnt = bit_set_count_range(
 			avail_bitmap, node_idx, node_idx + cnt);
+	}
 
-		/* If the switch has nodes that are required, loop through them */
-		if (req_nodes_bitmap && (hypercube_switch_table[i].avail_cnt != 0) && 
-		    (bit_set_count_range(
-			     req_nodes_bitmap, node_idx, node_idx + cnt) > 0)) {
-			int j;
-
-			/* Check each node on the switch */
-			for (j = 0; j < cnt; j++) {
-				int idx = hypercube_switch_table[i].node_index[j];
-
-				/* If is req'd, add cpus and distance to calulations */
-				if (bit_test(req_nodes_bitmap, idx)) {
-					int k;
-
-					rem_cpus   -= _get_avail_cpus(job_ptr, idx);
-					total_cpus += _get_total_cpus(idx);
-
-					/*
-					 * Add the required nodes data to the
-					 * variance calculations
-					 */
-					for (k = 0; k < hypercube_dimensions; k++) {
-						int distance = hypercube_switch_table[i].
-							distance[k];
-
-						req_summed_squares[k] += distance *
-							distance;
-						req_squared_sums[k] += distance;
-					}
-				}
+	/* Walk the required nodes, resolving each node's switch through
+	 * the node to switch table built at topology load */
+	if (req_nodes_bitmap) {
+		int idx;
+
+		for (idx = bit_ffs(req_nodes_bitmap); idx >= 0;
+		     idx = bit_ffs_from(req_nodes_bitmap, idx + 1)) {
+			int sw = hypercube_node_table[idx];
+			int k;
+
+			if ((sw < 0) ||
+			    (hypercube_switch_table[sw].avail_cnt == 0))
+				continue;
+
+			/* Add cpus and distance to calulations */
+			rem_cpus   -= _get_avail_cpus(job_ptr, idx);
+			total_cpus += _get_total_cpus(idx);
+
+			/*
+			 * Add the required nodes data to the
+			 * variance calculations
+			 */
+			for (k = 0; k < hypercube_dimensions; k++) {
+				int distance = hypercube_switch_table[sw].
+					distance[k];
+
+				req_summed_squares[k] += distance *
+					distance;
+				req_squared_sums[k] += distance;
 			}
 		}
 	}
@@ -1729,7 +1738,9 @@ static int _job_test_dfly(struct job_record *job_ptr, bitstr_t *bitmap,
 	/* Identify usable leafs (within higher switch having best fit) */
 	for (j = 0; j < switch_record_cnt; j++) {
 		if ((switch_record_table[j].level > 0) ||
-		    (!bit_super_set(switches_bitmap[j],
+		    (switch_desc_bitmap ?
+		     !bit_test(switch_desc_bitmap[best_fit_inx], j) :
+		     !bit_super_set(switches_bitmap[j],
 				    switches_bitmap[best_fit_inx]))) {
 			switches_node_cnt[j] = 0;
 		} else if (req_nodes_bitmap) {
@@ -2024,7 +2035,9 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	/* Identify usable leafs (within higher switch having best fit) */
 	for (j = 0; j < switch_record_cnt; j++) {
 		if ((switch_record_table[j].level > 0) ||
-		    (!bit_super_set(switches_bitmap[j],
+		    (switch_desc_bitmap ?
+		     !bit_test(switch_desc_bitmap[best_fit_inx], j) :
+		     !bit_super_set(switches_bitmap[j],
 				    switches_bitmap[best_fit_inx]))) {
 			switches_node_cnt[j] = 0;
 		} else if (req_nodes_bitmap) {
@@ -4227,7 +4240,9 @@ extern bitstr_t * select_p_resv_test(resv_desc_msg_t *resv_desc_ptr,
 	/* Identify usable leafs (within higher switch having best fit) */
 	for (j=0; j<switch_record_cnt; j++) {
 		if ((switch_record_table[j].level != 0) ||
-		    (!bit_super_set(switches_bitmap[j],
+		    (switch_desc_bitmap ?
+		     !bit_test(switch_desc_bitmap[best_fit_inx], j) :
+		     !bit_super_set(switches_bitmap[j],
 				    switches_bitmap[best_fit_inx]))) {
 			switches_node_cnt[j] = 0;
 		}
@@ -70,6 +70,18 @@ static size_t cookie_id_list_capacity = 0;
 // Mutex for the cookie id list
 static pthread_mutex_t cookie_id_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Cookie ids queued for release, drained in batches by the lease
+// extender thread so ALPS latency does not stall step completion
+static int32_t *release_list = NULL;
+
+// Size of the pending release list
+static int32_t release_list_size = 0;
+
+// Capacity of the pending release list
+static size_t release_list_capacity = 0;
+
+// Signalled when cookie ids are queued for release
+static pthread_cond_t cookie_agent_cond = PTHREAD_COND_INITIALIZER;
 
 // If we are running the lease_extender
 static bool lease_extender_running = false;
@@ -131,6 +143,10 @@ extern int cleanup_lease_extender(void)
 	xfree(cookie_id_list);
 	cookie_id_list_size = 0;
 	cookie_id_list_capacity = 0;
+	xfree(release_list);
+	release_list_size = 0;
+	release_list_capacity = 0;
+	slurm_cond_signal(&cookie_agent_cond);
 	slurm_mutex_unlock(&cookie_id_mutex);
 
 	return SLURM_SUCCESS;
@@ -214,13 +230,13 @@ extern int track_cookies(slurm_cray_jobinfo_t *job)
 }
 
 /*
- * Release cookies which have been leased.
+ * Release cookies which have been leased. The ids are queued and
+ * released in batches by the lease extender thread, so the caller
+ * (the step completion path in the slurmctld) never blocks on ALPS.
  */
 extern int release_cookies(slurm_cray_jobinfo_t *job)
 {
 	uint32_t i;
-	int rc;
-	char *err_msg = NULL;
 
 	if (!_in_slurmctld())
 		return SLURM_SUCCESS;
@@ -230,13 +246,24 @@ extern int release_cookies(slurm_cray_jobinfo_t *job)
 		_remove_cookie(job->cookie_ids[i]);
 	}
 
-	// Release them
-	rc = alpsc_release_cookies(&err_msg, (int32_t *) job->cookie_ids,
-				   (int32_t) job->num_cookies);
-	ALPSC_SN_DEBUG("alpsc_release_cookies");
-	if (rc != 0) {
-		return SLURM_ERROR;
+	// Queue them for release
+	slurm_mutex_lock(&cookie_id_mutex);
+	if (release_list_size + job->num_cookies > release_list_capacity) {
+		if (release_list_capacity == 0) {
+			release_list_capacity = 2048;
+		} else {
+			release_list_capacity *= 2;
+		}
+		release_list = xrealloc(release_list,
+					(release_list_capacity
+					 * sizeof(int32_t)));
+	}
+	for (i = 0; i < job->num_cookies; i++) {
+		release_list[release_list_size] = job->cookie_ids[i];
+		release_list_size++;
 	}
+	slurm_cond_signal(&cookie_agent_cond);
+	slurm_mutex_unlock(&cookie_id_mutex);
 
 	return SLURM_SUCCESS;
 }
@@ -319,35 +346,80 @@ static void *_lease_extender(void *args)
 {
 	int rc;
 	char *err_msg = NULL;
+	int32_t *rel_ids, *ext_ids;
+	int32_t rel_size, ext_size;
+	time_t now, next_extend;
+	struct timespec ts = {0, 0};
 
 	CRAY_INFO("Leasing cookies for %ds, renewing every %ds",
 		  COOKIE_LEASE_TIME, COOKIE_LEASE_INTERVAL);
 
 	lease_extender_running = true;
+	next_extend = time(NULL) + COOKIE_LEASE_INTERVAL;
 
 	while (lease_extender_running) {
+		rel_ids = ext_ids = NULL;
+		rel_size = ext_size = 0;
+
 		// Lock the mutex
 		slurm_mutex_lock(&cookie_id_mutex);
 
-		// If there are cookies, extend their leases
-		if (cookie_id_list_size > 0) {
+		// Wait for queued releases or the next lease renewal
+		if ((release_list_size == 0) &&
+		    (time(NULL) < next_extend)) {
+			ts.tv_sec = next_extend;
+			slurm_cond_timedwait(&cookie_agent_cond,
+					     &cookie_id_mutex, &ts);
+		}
+
+		// Take all queued releases as one batch
+		if (release_list_size > 0) {
+			rel_ids = release_list;
+			rel_size = release_list_size;
+			release_list = NULL;
+			release_list_size = 0;
+			release_list_capacity = 0;
+		}
+
+		// Copy the tracked ids if their lease renewal is due,
+		// so the ALPS calls below run without the mutex held
+		// and job starts adding new cookies are not blocked
+		now = time(NULL);
+		if (now >= next_extend) {
+			if (cookie_id_list_size > 0) {
+				ext_size = cookie_id_list_size;
+				ext_ids = xmalloc(ext_size * sizeof(int32_t));
+				memcpy(ext_ids, cookie_id_list,
+				       ext_size * sizeof(int32_t));
+			}
+			next_extend = now + COOKIE_LEASE_INTERVAL;
+		}
+
+		// Unlock the mutex
+		slurm_mutex_unlock(&cookie_id_mutex);
+
+		if (rel_size > 0) {
+			rc = alpsc_release_cookies(&err_msg, rel_ids,
+						   rel_size);
+			ALPSC_SN_DEBUG("alpsc_release_cookies");
+
+			// On error the leases simply expire
+			xfree(rel_ids);
+		}
+
+		if (ext_size > 0) {
 			// Extend the cookie leases
 			CRAY_INFO("Extending leases for %"PRId32" cookies",
-				  cookie_id_list_size);
+				  ext_size);
 
-			rc = alpsc_set_cookie_lease(&err_msg, cookie_id_list,
-						    cookie_id_list_size,
+			rc = alpsc_set_cookie_lease(&err_msg, ext_ids,
+						    ext_size,
 						    COOKIE_LEASE_TIME);
 			ALPSC_SN_DEBUG("alpsc_set_cookie_lease");
 
 			// Just ignore errors, not much we can do about them
+			xfree(ext_ids);
 		}
-
-		// Unlock the mutex
-		slurm_mutex_unlock(&cookie_id_mutex);
-
-		// Wait until we want to extend leases again
-		sleep(COOKIE_LEASE_INTERVAL);
 	}
 	return NULL;
 }
@@ -37,11 +37,14 @@
 #include "affinity.h"
 #include "dist_tasks.h"
 #include "src/common/bitstring.h"
+#include "src/common/list.h"
 #include "src/common/log.h"
+#include "src/common/macros.h"
 #include "src/common/slurm_cred.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_resource_info.h"
 #include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
 #include "src/slurmd/slurmd/slurmd.h"
 
 #ifdef HAVE_NUMA
@@ -59,9 +62,13 @@ static int _get_local_node_info(slurm_cred_arg_t *arg, int job_node_id,
 				uint16_t *sockets, uint16_t *cores);
 
 static int _task_layout_lllp_block(launch_tasks_request_msg_t *req,
-				   uint32_t node_id, bitstr_t ***masks_p);
+				   uint32_t node_id, bitstr_t *avail_map,
+				   uint16_t hw_sockets, uint16_t hw_cores,
+				   uint16_t hw_threads, bitstr_t ***masks_p);
 static int _task_layout_lllp_cyclic(launch_tasks_request_msg_t *req,
-				    uint32_t node_id, bitstr_t ***masks_p);
+				    uint32_t node_id, bitstr_t *avail_map,
+				    uint16_t hw_sockets, uint16_t hw_cores,
+				    uint16_t hw_threads, bitstr_t ***masks_p);
 
 static void _lllp_map_abstract_masks(const uint32_t maxtasks,
 				     bitstr_t **masks);
@@ -362,14 +369,140 @@ static void _validate_mask(launch_tasks_request_msg_t *req, char *avail_mask)
  * IN/OUT- job launch request (cpu_bind_type and cpu_bind updated)
  * IN- global task id array
  */
+/*
+ * Cache of generated binding masks. High frequency users tend to launch
+ * identically shaped steps over and over, in which case the generated
+ * bind masks only depend upon the available cpu map and the geometry of
+ * the step. Keep the generated cpu_bind strings in slurmd memory so that
+ * a repeated launch of an already seen shape skips the task layout and
+ * mask generation logic entirely.
+ */
+#define BIND_CACHE_MAX_ENTRIES 128
+
+struct bind_cache_entry {
+	char    *avail_map_hex;	/* hex string of the available cpu map */
+	uint32_t max_tasks;	/* tasks launched on this node */
+	uint16_t cpus_per_task;
+	uint32_t task_dist;
+	uint16_t cpu_bind_type;	/* bind type before mask generation */
+	uint16_t ntasks_per_core;
+	uint16_t ntasks_per_socket;
+	uint16_t job_core_spec;
+	char    *cpu_bind;	/* generated bind mask string */
+	uint16_t new_bind_type;	/* bind type after mask generation */
+	uint16_t new_cpus_per_task; /* possibly reset upon overcommit */
+};
+
+static List bind_cache_list = NULL;
+static pthread_mutex_t bind_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _bind_cache_del(void *x)
+{
+	struct bind_cache_entry *e = x;
+
+	if (e) {
+		xfree(e->avail_map_hex);
+		xfree(e->cpu_bind);
+		xfree(e);
+	}
+}
+
+static int _bind_cache_match(void *x, void *key)
+{
+	struct bind_cache_entry *e = x;
+	struct bind_cache_entry *k = key;
+
+	if ((e->max_tasks == k->max_tasks) &&
+	    (e->cpus_per_task == k->cpus_per_task) &&
+	    (e->task_dist == k->task_dist) &&
+	    (e->cpu_bind_type == k->cpu_bind_type) &&
+	    (e->ntasks_per_core == k->ntasks_per_core) &&
+	    (e->ntasks_per_socket == k->ntasks_per_socket) &&
+	    (e->job_core_spec == k->job_core_spec) &&
+	    (xstrcmp(e->avail_map_hex, k->avail_map_hex) == 0))
+		return 1;
+	return 0;
+}
+
+/* Replay a previously generated binding for an identically shaped step.
+ * Returns true and updates the request upon a cache hit. */
+static bool _bind_cache_lookup(launch_tasks_request_msg_t *req,
+			       uint32_t node_id, char *avail_map_hex)
+{
+	struct bind_cache_entry key, *e;
+	bool found = false;
+
+	memset(&key, 0, sizeof(key));
+	key.avail_map_hex = avail_map_hex;
+	key.max_tasks = req->tasks_to_launch[(int)node_id];
+	key.cpus_per_task = req->cpus_per_task;
+	key.task_dist = req->task_dist;
+	key.cpu_bind_type = req->cpu_bind_type;
+	key.ntasks_per_core = req->ntasks_per_core;
+	key.ntasks_per_socket = req->ntasks_per_socket;
+	key.job_core_spec = req->job_core_spec;
+
+	slurm_mutex_lock(&bind_cache_mutex);
+	if (bind_cache_list &&
+	    (e = list_find_first(bind_cache_list, _bind_cache_match, &key))) {
+		xfree(req->cpu_bind);
+		req->cpu_bind = xstrdup(e->cpu_bind);
+		req->cpu_bind_type = e->new_bind_type;
+		req->cpus_per_task = e->new_cpus_per_task;
+		found = true;
+	}
+	slurm_mutex_unlock(&bind_cache_mutex);
+
+	return found;
+}
+
+/* Record a generated binding, evicting the oldest entry as needed.
+ * The bind type and cpus_per_task of the request have already been
+ * updated by the mask generation, so the values they had before mask
+ * generation are passed in for use in the cache key. */
+static void _bind_cache_store(launch_tasks_request_msg_t *req,
+			      uint32_t node_id, char *avail_map_hex,
+			      uint16_t orig_bind_type, uint16_t orig_cpt)
+{
+	struct bind_cache_entry *e;
+
+	if (!req->cpu_bind)
+		return;
+
+	e = xmalloc(sizeof(struct bind_cache_entry));
+	e->avail_map_hex = xstrdup(avail_map_hex);
+	e->max_tasks = req->tasks_to_launch[(int)node_id];
+	e->cpus_per_task = orig_cpt;
+	e->task_dist = req->task_dist;
+	e->cpu_bind_type = orig_bind_type;
+	e->ntasks_per_core = req->ntasks_per_core;
+	e->ntasks_per_socket = req->ntasks_per_socket;
+	e->job_core_spec = req->job_core_spec;
+	e->cpu_bind = xstrdup(req->cpu_bind);
+	e->new_bind_type = req->cpu_bind_type;
+	e->new_cpus_per_task = req->cpus_per_task;
+
+	slurm_mutex_lock(&bind_cache_mutex);
+	if (!bind_cache_list)
+		bind_cache_list = list_create(_bind_cache_del);
+	if (list_count(bind_cache_list) >= BIND_CACHE_MAX_ENTRIES)
+		_bind_cache_del(list_dequeue(bind_cache_list));
+	list_enqueue(bind_cache_list, e);
+	slurm_mutex_unlock(&bind_cache_mutex);
+}
+
 void lllp_distribution(launch_tasks_request_msg_t *req, uint32_t node_id)
 {
 	int rc = SLURM_SUCCESS;
 	bitstr_t **masks = NULL;
+	bitstr_t *avail_map = NULL;
+	char *avail_map_hex = NULL;
 	char buf_type[100];
 	int maxtasks = req->tasks_to_launch[(int)node_id];
 	int whole_nodes, whole_sockets, whole_cores, whole_threads;
 	int part_sockets, part_cores;
+	uint16_t hw_sockets = 0, hw_cores = 0, hw_threads = 0;
+	uint16_t orig_bind_type = 0, orig_cpt = 0;
 	const uint32_t *gtid = req->global_task_ids[(int)node_id];
 	static uint16_t bind_entity = CPU_BIND_TO_THREADS | CPU_BIND_TO_CORES |
 				      CPU_BIND_TO_SOCKETS | CPU_BIND_TO_LDOMS;
@@ -499,12 +632,30 @@ void lllp_distribution(launch_tasks_request_msg_t *req, uint32_t node_id)
 		     req->job_id, buf_type, req->task_dist);
 	}
 
+	avail_map = _get_avail_map(req, &hw_sockets, &hw_cores, &hw_threads);
+	if (avail_map) {
+		avail_map_hex = (char *)bit_fmt_hexmask(avail_map);
+		if (_bind_cache_lookup(req, node_id, avail_map_hex)) {
+			slurm_sprint_cpu_bind_type(buf_type,
+						   req->cpu_bind_type);
+			info("lllp_distribution jobid [%u] cached binding: "
+			     "%s, %s", req->job_id, buf_type, req->cpu_bind);
+			xfree(avail_map_hex);
+			FREE_NULL_BITMAP(avail_map);
+			return;
+		}
+		orig_bind_type = req->cpu_bind_type;
+		orig_cpt = req->cpus_per_task;
+	}
+
 	switch (req->task_dist & SLURM_DIST_STATE_BASE) {
 	case SLURM_DIST_BLOCK_BLOCK:
 	case SLURM_DIST_CYCLIC_BLOCK:
 	case SLURM_DIST_PLANE:
 		/* tasks are distributed in blocks within a plane */
-		rc = _task_layout_lllp_block(req, node_id, &masks);
+		rc = _task_layout_lllp_block(req, node_id, avail_map,
+					     hw_sockets, hw_cores, hw_threads,
+					     &masks);
 		break;
 	case SLURM_DIST_ARBITRARY:
 	case SLURM_DIST_BLOCK:
@@ -512,14 +663,18 @@ void lllp_distribution(launch_tasks_request_msg_t *req, uint32_t node_id)
 	case SLURM_DIST_UNKNOWN:
 		if (slurm_get_select_type_param()
 		    & CR_CORE_DEFAULT_DIST_BLOCK) {
-			rc = _task_layout_lllp_block(req, node_id, &masks);
+			rc = _task_layout_lllp_block(req, node_id, avail_map,
+						     hw_sockets, hw_cores,
+						     hw_threads, &masks);
 			break;
 		}
 		/* We want to fall through here if we aren't doing a
 		   default dist block.
 		*/
 	default:
-		rc = _task_layout_lllp_cyclic(req, node_id, &masks);
+		rc = _task_layout_lllp_cyclic(req, node_id, avail_map,
+					      hw_sockets, hw_cores, hw_threads,
+					      &masks);
 		break;
 	}
 
@@ -541,6 +696,9 @@ void lllp_distribution(launch_tasks_request_msg_t *req, uint32_t node_id)
 #endif
 	    	 /* convert masks into cpu_bind mask string */
 		 _lllp_generate_cpu_bind(req, maxtasks, masks);
+		 if (avail_map_hex)
+			 _bind_cache_store(req, node_id, avail_map_hex,
+					   orig_bind_type, orig_cpt);
 	} else {
 		char *avail_mask = _alloc_mask(req,
 					       &whole_nodes,  &whole_sockets,
@@ -557,6 +715,8 @@ void lllp_distribution(launch_tasks_request_msg_t *req, uint32_t node_id)
 		      req->job_id, buf_type);
 		error("Verify socket/core/thread counts in configuration");
 	}
+	xfree(avail_map_hex);
+	FREE_NULL_BITMAP(avail_map);
 	if (masks)
 		_lllp_free_masks(maxtasks, masks);
 }
@@ -923,20 +1083,20 @@ static void _expand_masks(uint16_t cpu_bind_type, const uint32_t maxtasks,
  *
  */
 static int _task_layout_lllp_cyclic(launch_tasks_request_msg_t *req,
-				    uint32_t node_id, bitstr_t ***masks_p)
+				    uint32_t node_id, bitstr_t *avail_map,
+				    uint16_t hw_sockets, uint16_t hw_cores,
+				    uint16_t hw_threads, bitstr_t ***masks_p)
 {
 	int last_taskcount = -1, taskcount = 0;
-	uint16_t i, s, hw_sockets = 0, hw_cores = 0, hw_threads = 0;
+	uint16_t i, s;
 	uint16_t offset = 0, p = 0;
 	int size, max_tasks = req->tasks_to_launch[(int)node_id];
 	int max_cpus = max_tasks * req->cpus_per_task;
-	bitstr_t *avail_map;
 	bitstr_t **masks = NULL;
 	int *socket_last_pu = NULL;
 
 	info ("_task_layout_lllp_cyclic ");
 
-	avail_map = _get_avail_map(req, &hw_sockets, &hw_cores, &hw_threads);
 	if (!avail_map)
 		return SLURM_ERROR;
 
@@ -944,7 +1104,6 @@ static int _task_layout_lllp_cyclic(launch_tasks_request_msg_t *req,
 	if (size < max_tasks) {
 		error("task/affinity: only %d bits in avail_map for %d tasks!",
 		      size, max_tasks);
-		FREE_NULL_BITMAP(avail_map);
 		return SLURM_ERROR;
 	}
 	if (size < max_cpus) {
@@ -1066,7 +1225,6 @@ static int _task_layout_lllp_cyclic(launch_tasks_request_msg_t *req,
 	 * to the requested resource */
 	_expand_masks(req->cpu_bind_type, max_tasks, masks,
 		      hw_sockets, hw_cores, hw_threads, avail_map);
-	FREE_NULL_BITMAP(avail_map);
 	xfree(socket_last_pu);
 
 	return SLURM_SUCCESS;
@@ -1095,19 +1253,18 @@ static int _task_layout_lllp_cyclic(launch_tasks_request_msg_t *req,
  *
  */
 static int _task_layout_lllp_block(launch_tasks_request_msg_t *req,
-				   uint32_t node_id, bitstr_t ***masks_p)
+				   uint32_t node_id, bitstr_t *avail_map,
+				   uint16_t hw_sockets, uint16_t hw_cores,
+				   uint16_t hw_threads, bitstr_t ***masks_p)
 {
 	int c, i, size, last_taskcount = -1, taskcount = 0;
-	uint16_t hw_sockets = 0, hw_cores = 0, hw_threads = 0;
 	int max_tasks = req->tasks_to_launch[(int)node_id];
 	int max_cpus = max_tasks * req->cpus_per_task;
-	bitstr_t *avail_map;
 	bitstr_t **masks = NULL;
 	int sock_inx, pu_per_socket, *socket_tasks = NULL;
 
 	info("_task_layout_lllp_block ");
 
-	avail_map = _get_avail_map(req, &hw_sockets, &hw_cores, &hw_threads);
 	if (!avail_map) {
 		return SLURM_ERROR;
 	}
@@ -1116,7 +1273,6 @@ static int _task_layout_lllp_block(launch_tasks_request_msg_t *req,
 	if (size < max_tasks) {
 		error("task/affinity: only %d bits in avail_map for %d tasks!",
 		      size, max_tasks);
-		FREE_NULL_BITMAP(avail_map);
 		return SLURM_ERROR;
 	}
 	if (size < max_cpus) {
@@ -1206,7 +1362,6 @@ static int _task_layout_lllp_block(launch_tasks_request_msg_t *req,
 	 * to the requested resource */
 	_expand_masks(req->cpu_bind_type, max_tasks, masks,
 			hw_sockets, hw_cores, hw_threads, avail_map);
-	FREE_NULL_BITMAP(avail_map);
 
 	return SLURM_SUCCESS;
 }
@@ -1021,6 +1021,19 @@ static void _build_hypercube_switch_table(int num_curves)
 	// allocated space for the pointers to each of the different curves
 	hypercube_switches =
 		xmalloc(sizeof(struct hypercube_switch **) * num_curves);
+
+	// build the immutable node to switch lookup used by the
+	// selection logic
+	hypercube_node_table = xmalloc(sizeof(int) * node_record_count);
+	for (i = 0; i < node_record_count; i++) {
+		hypercube_node_table[i] = -1;
+	}
+	for (i = 0; i < switch_data_cnt; i++) {
+		for (j = 0; j < hypercube_switch_table[i].node_cnt; j++) {
+			hypercube_node_table[
+				hypercube_switch_table[i].node_index[j]] = i;
+		}
+	}
 }
 
 
@@ -1439,4 +1452,5 @@ static void _free_hypercube_switch_table(void)
 		}
 		xfree(hypercube_switch_table);
 	}
+	xfree(hypercube_node_table);
 }
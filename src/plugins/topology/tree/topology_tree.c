@@ -98,6 +98,7 @@ static int  _parse_switches(void **dest, slurm_parser_enum_t type,
 			    const char *key, const char *value,
 			    const char *line, char **leftover);
 extern int  _read_topo_file(slurm_conf_switches_t **ptr_array[]);
+static void _build_switch_tables(void);
 static void _find_child_switches (int sw);
 static void _validate_switches(void);
 
@@ -427,10 +428,52 @@ static void _validate_switches(void)
 				" through its descendants."
 				"Do not use route/topology");
 	}
+	_build_switch_tables();
 	s_p_hashtbl_destroy(conf_hashtbl);
 	_log_switches();
 }
 
+/* Build the precomputed lookup tables used for best-fit switch selection:
+ * an array mapping each node to its leaf switch and, for each switch, a
+ * bitmap of the switches in its subtree. These replace repeated bitmap
+ * traversals in the select plugins with table lookups. */
+static void _build_switch_tables(void)
+{
+	int i, j, level;
+	struct switch_record *switch_ptr;
+
+	switch_node_leaf = xmalloc(sizeof(int) * node_record_count);
+	for (j = 0; j < node_record_count; j++)
+		switch_node_leaf[j] = -1;
+	switch_desc_bitmap = xmalloc(sizeof(bitstr_t *) * switch_record_cnt);
+	switch_ptr = switch_record_table;
+	for (i = 0; i < switch_record_cnt; i++, switch_ptr++) {
+		switch_desc_bitmap[i] = bit_alloc(switch_record_cnt);
+		bit_set(switch_desc_bitmap[i], i);
+		if (switch_ptr->level != 0)
+			continue;
+		for (j = 0; j < node_record_count; j++) {
+			if ((switch_node_leaf[j] == -1) &&
+			    bit_test(switch_ptr->node_bitmap, j))
+				switch_node_leaf[j] = i;
+		}
+	}
+	/* Accumulate descendants bottom up, children always resolve to a
+	 * lower level than their parent */
+	for (level = 1; level <= switch_levels; level++) {
+		switch_ptr = switch_record_table;
+		for (i = 0; i < switch_record_cnt; i++, switch_ptr++) {
+			if (switch_ptr->level != level)
+				continue;
+			for (j = 0; j < switch_ptr->num_switches; j++) {
+				bit_or(switch_desc_bitmap[i],
+				       switch_desc_bitmap[switch_ptr->
+							  switch_index[j]]);
+			}
+		}
+	}
+}
+
 static void _log_switches(void)
 {
 	int i;
@@ -475,8 +518,12 @@ static void _free_switch_record_table(void)
 			xfree(switch_record_table[i].switches);
 			xfree(switch_record_table[i].switch_index);
 			FREE_NULL_BITMAP(switch_record_table[i].node_bitmap);
+			if (switch_desc_bitmap)
+				FREE_NULL_BITMAP(switch_desc_bitmap[i]);
 		}
 		xfree(switch_record_table);
+		xfree(switch_desc_bitmap);
+		xfree(switch_node_leaf);
 		switch_record_cnt = 0;
 		switch_levels = 0;
 	}
@@ -51,6 +51,7 @@
 #define OPT_LONG_DELIMITER 0x101
 #define OPT_LONG_NOCONVERT 0x102
 #define OPT_LONG_UNITS     0x103
+#define OPT_LONG_CHUNK     0x104
 
 void _help_fields_msg(void);
 void _help_msg(void);
@@ -290,6 +291,11 @@ sacct [<OPTION>]                                                            \n \
      -b, --brief:                                                           \n\
 	           Equivalent to '--format=jobstep,state,error'.            \n\
      -c, --completion: Use job completion instead of accounting data.       \n\
+     --chunksize=N:                                                         \n\
+                 Fetch and print jobs from the database in chunks of at     \n\
+                 most N jobs instead of all at once, so output starts       \n\
+                 immediately and memory use stays bounded.  Only honored    \n\
+                 on a single cluster request.                               \n\
      --delimiter:                                                           \n\
                  ASCII characters used to separate the fields when\n\
                  specifying the  -p  or  -P options. The default\n\
@@ -427,6 +433,21 @@ void _init_params()
 	params.units = NO_VAL;
 }
 
+static uint64_t chunk_next_inx = 0;
+static bool chunk_more = false;
+
+/* Advance the fetch cursor past the chunk just listed.
+ * Returns true if another chunk should be fetched. */
+bool more_job_chunks(void)
+{
+	if (!chunk_more)
+		return false;
+	chunk_more = false;
+	params.job_cond->chunk_db_inx = chunk_next_inx;
+	FREE_NULL_LIST(jobs);
+	return true;
+}
+
 int get_data(void)
 {
 	slurmdb_job_rec_t *job = NULL;
@@ -445,6 +466,21 @@ int get_data(void)
 	if (!jobs)
 		return SLURM_ERROR;
 
+	/* A chunked fetch ends with a sentinel record carrying the
+	 * database index to resume from if more jobs may remain.
+	 * Strip it off before anything tries to print it. */
+	if (job_cond->chunk_size) {
+		itr = list_iterator_create(jobs);
+		while ((job = list_next(itr))) {
+			if (job->jobid != NO_VAL)
+				continue;
+			chunk_more = true;
+			chunk_next_inx = job->db_index;
+			list_delete_item(itr);
+		}
+		list_iterator_destroy(itr);
+	}
+
 	itr = list_iterator_create(jobs);
 	while((job = list_next(itr))) {
 		if (job->user) {
@@ -506,6 +542,7 @@ void parse_command_line(int argc, char **argv)
                 {"accounts",       required_argument, 0,    'A'},
                 {"allocations",    no_argument,       0,    'X'},
                 {"brief",          no_argument,       0,    'b'},
+                {"chunksize",      required_argument, 0,    OPT_LONG_CHUNK},
                 {"completion",     no_argument,       0,    'c'},
                 {"delimiter",      required_argument, 0,    OPT_LONG_DELIMITER},
                 {"duplicates",     no_argument,       0,    'D'},
@@ -673,6 +710,9 @@ void parse_command_line(int argc, char **argv)
 		case 'l':
 			long_output = true;
 			break;
+		case OPT_LONG_CHUNK:
+			job_cond->chunk_size = slurm_atoul(optarg);
+			break;
 		case OPT_LONG_NOCONVERT:
 			params.convert_flags |= CONVERT_NUM_UNIT_NO;
 			break;
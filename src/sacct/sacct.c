@@ -146,6 +146,11 @@ int main(int argc, char **argv)
 	sacct_init();
 	parse_command_line(argc, argv);
 
+	/* Dumps redirected to a file or pipe run at disk speed with
+	 * large block writes; leave a terminal line buffered. */
+	if (!isatty(STDOUT_FILENO))
+		print_fields_block_output();
+
 	/* What are we doing? Requests for help take highest priority,
 	 * but then check for illogical switch combinations.
 	 */
@@ -159,12 +164,15 @@ int main(int argc, char **argv)
 	switch (op) {
 	case SACCT_LIST:
 		print_fields_header(print_fields_list);
-		if (get_data() == SLURM_ERROR)
-			exit(errno);
-		if (params.opt_completion)
-			do_list_completion();
-		else
+		do {
+			if (get_data() == SLURM_ERROR)
+				exit(errno);
+			if (params.opt_completion) {
+				do_list_completion();
+				break;
+			}
 			do_list();
+		} while (more_job_chunks());
 		break;
 	case SACCT_HELP:
 		do_help();
@@ -205,6 +205,7 @@ void print_fields(type_t type, void *object);
 
 /* options.c */
 int get_data(void);
+bool more_job_chunks(void);
 void parse_command_line(int argc, char **argv);
 void do_help(void);
 void do_list(void);
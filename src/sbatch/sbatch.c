@@ -276,18 +276,52 @@ static void  _add_bb_to_script(char **script_body, char *burst_buffer_file)
 }
 
 /* Wait for specified job ID to terminate, return it's exit code */
+/* Set by the message thread upon a pushed job completion notification */
+static volatile bool wait_job_notified = false;
+
+static void _job_complete_cb(srun_job_complete_msg_t *comp)
+{
+	wait_job_notified = true;
+}
+
 static int _job_wait(uint32_t job_id)
 {
 	slurm_job_info_t *job_ptr;
 	job_info_msg_t *resp = NULL;
+	allocation_msg_thread_t *msg_thr = NULL;
+	slurm_allocation_callbacks_t callbacks;
+	uint16_t port = 0;
 	int ec = 0, ec2, i, rc;
 	int sleep_time = 2;
-	bool complete = false;
+	bool complete = false, subscribed = false;
+
+	/* Subscribe for a pushed completion notification rather than
+	 * polling the controller; fall back to polling if the
+	 * subscription cannot be established */
+	memset(&callbacks, 0, sizeof(callbacks));
+	callbacks.job_complete = _job_complete_cb;
+	msg_thr = slurm_allocation_msg_thr_create(&port, &callbacks);
+	if (msg_thr) {
+		if (slurm_job_state_subscribe(job_id, port) == SLURM_SUCCESS)
+			subscribed = true;
+		else if (slurm_get_errno() == ESLURM_ALREADY_DONE) {
+			subscribed = true;
+			wait_job_notified = true;
+		} else
+			debug("Job state subscription failed, polling: %m");
+	}
 
 	while (!complete) {
 		complete = true;
-		sleep(sleep_time);
-		sleep_time = MIN(sleep_time + 2, 10);
+		if (subscribed) {
+			/* Wait for the pushed notification, but still check
+			 * the job state periodically in case it is lost */
+			for (i = 0; (i < 300) && !wait_job_notified; i++)
+				sleep(1);
+		} else {
+			sleep(sleep_time);
+			sleep_time = MIN(sleep_time + 2, 10);
+		}
 
 		rc = slurm_load_job(&resp, job_id, SHOW_ALL);
 		if (rc == SLURM_SUCCESS) {
@@ -314,6 +348,8 @@ static int _job_wait(uint32_t job_id)
 			      "information, retrying: %m");
 		}
 	}
+	if (msg_thr)
+		slurm_allocation_msg_thr_destroy(msg_thr);
 
 	return ec;
 }
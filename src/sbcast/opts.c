@@ -80,6 +80,7 @@ extern void parse_command_line(int argc, char *argv[])
 		{"timeout",   required_argument, 0, 't'},
 		{"verbose",   no_argument,       0, 'v'},
 		{"version",   no_argument,       0, 'V'},
+		{"window",    required_argument, 0, 'W'},
 		{"help",      no_argument,       0, OPT_LONG_HELP},
 		{"usage",     no_argument,       0, OPT_LONG_USAGE},
 		{NULL,        0,                 0, 0}
@@ -103,9 +104,11 @@ extern void parse_command_line(int argc, char *argv[])
 		params.block_size = 8 * 1024 * 1024;
 	if ( ( env_val = getenv("SBCAST_TIMEOUT") ) )
 		params.timeout = (atoi(env_val) * 1000);
+	if ( ( env_val = getenv("SBCAST_WINDOW") ) )
+		params.window = atoi(env_val);
 
 	optind = 0;
-	while((opt_char = getopt_long(argc, argv, "CfF:j:ps:t:vV",
+	while((opt_char = getopt_long(argc, argv, "CfF:j:ps:t:vVW:",
 			long_options, &option_index)) != -1) {
 		switch (opt_char) {
 		case (int)'?':
@@ -142,6 +145,9 @@ extern void parse_command_line(int argc, char *argv[])
 		case (int) 'V':
 			print_slurm_version();
 			exit(0);
+		case (int) 'W':
+			params.window = atoi(optarg);
+			break;
 		case (int) OPT_LONG_HELP:
 			_help();
 			exit(0);
@@ -221,6 +227,7 @@ static void _print_options( void )
 	info("preserve   = %s", params.preserve ? "true" : "false");
 	info("timeout    = %d", params.timeout);
 	info("verbose    = %d", params.verbose);
+	info("window     = %u", params.window);
 	info("source     = %s", params.src_fname);
 	info("dest       = %s", params.dst_fname);
 	info("-----------------------------");
@@ -229,7 +236,7 @@ static void _print_options( void )
 
 static void _usage( void )
 {
-	printf("Usage: sbcast [-CfFjpvV] SOURCE DEST\n");
+	printf("Usage: sbcast [-CfFjpvVW] SOURCE DEST\n");
 }
 
 static void _help( void )
@@ -246,6 +253,7 @@ Usage: sbcast [OPTIONS] SOURCE DEST\n\
   -t, --timeout=secs   specify message timeout (seconds)\n\
   -v, --verbose        provide detailed event logging\n\
   -V, --version        print version information and exit\n\
+  -W, --window=blocks  number of file blocks kept in flight\n\
 \nHelp options:\n\
   --help               show this help message\n\
   --usage              display brief usage message\n");
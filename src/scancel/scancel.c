@@ -65,6 +65,7 @@
 #define MAX_THREADS 10
 
 static void  _add_delay(void);
+static void  _bulk_signal_jobs (char **job_ids, uint32_t job_cnt, int *rc);
 static int   _cancel_jobs (int filter_cnt);
 static void *_cancel_job_id (void *cancel_info);
 static void *_cancel_step_id (void *cancel_info);
@@ -541,6 +542,8 @@ _cancel_jobs_by_state(uint32_t job_state, int filter_cnt, int *rc)
 	job_cancel_info_t *cancel_info;
 	job_info_t *job_ptr = job_buffer_ptr->job_array;
 	pthread_t dummy;
+	char **bulk_ids = NULL;
+	uint32_t bulk_cnt = 0;
 
 	/* Spawn a thread to cancel each job or job step marked for
 	 * cancellation */
@@ -549,6 +552,13 @@ _cancel_jobs_by_state(uint32_t job_state, int filter_cnt, int *rc)
 		return;
 	}
 
+	/* Without interactive confirmation the matched jobs can all be
+	 * signaled with a single bulk RPC */
+	if (!opt.interactive && job_buffer_ptr->record_count) {
+		bulk_ids = xmalloc(job_buffer_ptr->record_count *
+				   sizeof(char *));
+	}
+
 	for (i = 0; i < job_buffer_ptr->record_count; i++, job_ptr++) {
 		if (IS_JOB_FINISHED(job_ptr))
 			job_ptr->job_id = 0;
@@ -565,6 +575,12 @@ _cancel_jobs_by_state(uint32_t job_state, int filter_cnt, int *rc)
 			continue;
 		}
 
+		if (bulk_ids) {
+			bulk_ids[bulk_cnt++] = _build_jobid_str(job_ptr);
+			job_ptr->job_id = 0;
+			continue;
+		}
+
 		cancel_info = (job_cancel_info_t *)
 			xmalloc(sizeof(job_cancel_info_t));
 		cancel_info->job_id_str = _build_jobid_str(job_ptr);
@@ -600,6 +616,13 @@ _cancel_jobs_by_state(uint32_t job_state, int filter_cnt, int *rc)
 			slurm_mutex_unlock(&num_active_threads_lock);
 		}
 	}
+
+	if (bulk_ids) {
+		_bulk_signal_jobs(bulk_ids, bulk_cnt, rc);
+		for (i = 0; i < bulk_cnt; i++)
+			xfree(bulk_ids[i]);
+		xfree(bulk_ids);
+	}
 }
 
 /* _cancel_jobs - filter then cancel jobs or job steps per request */
@@ -888,52 +911,60 @@ _confirmation(job_info_t *job_ptr, uint32_t step_id)
 
 }
 
-static int _signal_job_by_str(void)
+/* _bulk_signal_jobs - signal a set of job id strings with a single
+ * bulk RPC. The controller processes the whole set within one lock
+ * window rather than paying the RPC overhead per job. */
+static void _bulk_signal_jobs(char **job_ids, uint32_t job_cnt, int *rc)
 {
-	job_cancel_info_t *cancel_info;
-	int err, i, rc = 0;
-	pthread_t dummy;
-
-	slurm_attr_init(&attr);
-	if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED))
-		error("pthread_attr_setdetachstate error %m");
-	slurm_mutex_init(&num_active_threads_lock);
-	slurm_cond_init(&num_active_threads_cond, NULL);
+	int error_code, i;
+	uint16_t sig = opt.signal, flags = 0;
+	char *job_type = "";
 
-	for (i = 0; opt.job_list[i]; i++) {
-		cancel_info = (job_cancel_info_t *)
-			xmalloc(sizeof(job_cancel_info_t));
-		cancel_info->job_id_str = xstrdup(opt.job_list[i]);
-		cancel_info->rc      = &rc;
-		cancel_info->sig     = opt.signal;
-		cancel_info->num_active_threads = &num_active_threads;
-		cancel_info->num_active_threads_lock =
-			&num_active_threads_lock;
-		cancel_info->num_active_threads_cond =
-			&num_active_threads_cond;
+	if (job_cnt == 0)
+		return;
+	if (sig == (uint16_t) NO_VAL)
+		sig = SIGKILL;
+	if (opt.batch) {
+		flags |= KILL_JOB_BATCH;
+		job_type = "batch ";
+	}
+	if (opt.full) {
+		flags |= KILL_FULL_JOB;
+		job_type = "full ";
+	}
+	for (i = 0; i < job_cnt; i++) {
+		if (opt.signal == (uint16_t) NO_VAL)
+			verbose("Terminating %sjob %s", job_type, job_ids[i]);
+		else
+			verbose("Signal %u to %sjob %s", sig, job_type,
+				job_ids[i]);
+	}
 
-		slurm_mutex_lock(&num_active_threads_lock);
-		num_active_threads++;
-		while (num_active_threads > MAX_THREADS) {
-			slurm_cond_wait(&num_active_threads_cond,
-					&num_active_threads_lock);
+	error_code = slurm_kill_jobs(job_ids, job_cnt, sig, flags);
+	if (error_code) {
+		error_code = slurm_get_errno();
+		if ((opt.verbose > 0) ||
+		    ((error_code != ESLURM_ALREADY_DONE) &&
+		     (error_code != ESLURM_INVALID_JOB_ID))) {
+			error("Kill job error: %s",
+			      slurm_strerror(error_code));
 		}
-		slurm_mutex_unlock(&num_active_threads_lock);
-
-		err = pthread_create(&dummy, &attr, _cancel_job_id,cancel_info);
-		if (err)	/* Run in-line if thread create fails */
-			_cancel_job_id(cancel_info);
+		if (((error_code == ESLURM_ALREADY_DONE) ||
+		     (error_code == ESLURM_INVALID_JOB_ID)) &&
+		    (sig == SIGKILL)) {
+			error_code = 0;	/* Ignore error if job done */
+		}
+		*rc = MAX(*rc, error_code);
 	}
+}
 
-	/* Wait all spawned threads to finish */
-	slurm_mutex_lock( &num_active_threads_lock );
-	while (num_active_threads > 0) {
-		slurm_cond_wait(&num_active_threads_cond,
-				&num_active_threads_lock);
-	}
-	slurm_mutex_unlock(&num_active_threads_lock);
+static int _signal_job_by_str(void)
+{
+	int i, rc = 0;
 
-	slurm_attr_destroy(&attr);
+	for (i = 0; opt.job_list[i]; i++)
+		;
+	_bulk_signal_jobs(opt.job_list, i, &rc);
 
 	return rc;
 }
@@ -61,6 +61,17 @@ uint32_t *rpc_type_ave_time = NULL, *rpc_user_ave_time = NULL;
 
 static int  _print_stats(void);
 static void _sort_rpc(void);
+static void _swap_type_hist(int i, int j);
+
+/* Lock data types, in slurmctld lock_datatype_t order */
+static const char *lock_names[] = {
+	"Config", "Job", "Node", "Partition", "Federation"
+};
+
+/* Record pools, in slurmctld rec_pool enum order */
+static const char *rec_pool_names[] = {
+	"job_record", "job_details", "step_record"
+};
 
 stats_info_request_msg_t req;
 
@@ -188,9 +199,109 @@ static int _print_stats(void)
 		       rpc_user_ave_time[i], buf->rpc_user_time[i]);
 	}
 
+	if (buf->rpc_hist_buckets && buf->rpc_type_hist) {
+		int b;
+		uint64_t cnt;
+		printf("\nRemote Procedure Call latency histograms "
+		       "(microseconds)\n");
+		for (i = 0; i < buf->rpc_type_size; i++) {
+			printf("\t%-40s(%5u)",
+			       rpc_num2string(buf->rpc_type_id[i]),
+			       buf->rpc_type_id[i]);
+			for (b = 0; b < buf->rpc_hist_buckets; b++) {
+				cnt = buf->rpc_type_hist[
+					(i * buf->rpc_hist_buckets) + b];
+				if (!cnt)
+					continue;
+				if (b == (buf->rpc_hist_buckets - 1)) {
+					printf(" >=%u:%"PRIu64,
+					       1 << b, cnt);
+				} else {
+					printf(" <%u:%"PRIu64,
+					       1 << (b + 1), cnt);
+				}
+			}
+			printf("\n");
+		}
+	}
+
+	if (buf->lock_stats_size) {
+		printf("\nLock statistics (microseconds)\n");
+		for (i = 0; i < buf->lock_stats_size; i++) {
+			printf("\t%-10s read_cnt:%-10"PRIu64
+			       " read_wait:%-10"PRIu64
+			       " write_cnt:%-10"PRIu64
+			       " write_wait:%-10"PRIu64
+			       " write_hold:%"PRIu64"\n",
+			       (i < 5) ? lock_names[i] : "Unknown",
+			       buf->lock_read_cnt[i],
+			       buf->lock_read_wait[i],
+			       buf->lock_write_cnt[i],
+			       buf->lock_write_wait[i],
+			       buf->lock_write_hold[i]);
+		}
+	}
+
+	if (buf->rec_pool_size) {
+		double hit_rate;
+		printf("\nRecord pool statistics\n");
+		for (i = 0; i < buf->rec_pool_size; i++) {
+			if (buf->rec_pool_allocs[i]) {
+				hit_rate = 100.0 * buf->rec_pool_reuses[i] /
+					   buf->rec_pool_allocs[i];
+			} else
+				hit_rate = 0.0;
+			printf("\t%-12s cached:%-6u allocs:%-10"PRIu64
+			       " reuses:%-10"PRIu64" hit_rate:%.2f%%\n",
+			       (i < 3) ? rec_pool_names[i] : "Unknown",
+			       buf->rec_pool_occupancy[i],
+			       buf->rec_pool_allocs[i],
+			       buf->rec_pool_reuses[i], hit_rate);
+		}
+	}
+
+	if (buf->prof_region_size) {
+		uint64_t mean;
+		printf("\nProfiling region statistics (microseconds)\n");
+		for (i = 0; i < buf->prof_region_size; i++) {
+			if (buf->prof_region_counts[i]) {
+				mean = buf->prof_region_time[i] /
+				       buf->prof_region_counts[i];
+			} else
+				mean = 0;
+			printf("\t%-20s count:%-8"PRIu64" min:%-8"PRIu64
+			       " mean:%-8"PRIu64" max:%-10"PRIu64
+			       " p99:%-10"PRIu64" total:%"PRIu64"\n",
+			       buf->prof_region_names[i],
+			       buf->prof_region_counts[i],
+			       buf->prof_region_time_min[i],
+			       mean,
+			       buf->prof_region_time_max[i],
+			       buf->prof_region_time_p99[i],
+			       buf->prof_region_time[i]);
+		}
+	}
+
 	return 0;
 }
 
+/* Keep the latency histogram rows aligned with the rpc_type_* arrays
+ * when _sort_rpc() reorders them */
+static void _swap_type_hist(int i, int j)
+{
+	uint64_t hist_tmp;
+	int b;
+
+	if (!buf->rpc_type_hist)
+		return;
+	for (b = 0; b < buf->rpc_hist_buckets; b++) {
+		hist_tmp = buf->rpc_type_hist[(i * buf->rpc_hist_buckets) + b];
+		buf->rpc_type_hist[(i * buf->rpc_hist_buckets) + b] =
+			buf->rpc_type_hist[(j * buf->rpc_hist_buckets) + b];
+		buf->rpc_type_hist[(j * buf->rpc_hist_buckets) + b] = hist_tmp;
+	}
+}
+
 static void _sort_rpc(void)
 {
 	int i, j;
@@ -206,6 +317,7 @@ static void _sort_rpc(void)
 			for (j = i+1; j < buf->rpc_type_size; j++) {
 				if (buf->rpc_type_id[i] <= buf->rpc_type_id[j])
 					continue;
+				_swap_type_hist(i, j);
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
@@ -245,6 +357,7 @@ static void _sort_rpc(void)
 			for (j = i+1; j < buf->rpc_type_size; j++) {
 				if (buf->rpc_type_time[i] >= buf->rpc_type_time[j])
 					continue;
+				_swap_type_hist(i, j);
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
@@ -290,6 +403,7 @@ static void _sort_rpc(void)
 			for (j = i+1; j < buf->rpc_type_size; j++) {
 				if (rpc_type_ave_time[i] >= rpc_type_ave_time[j])
 					continue;
+				_swap_type_hist(i, j);
 				type_ave  = rpc_type_ave_time[i];
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
@@ -333,6 +447,7 @@ static void _sort_rpc(void)
 			for (j = i+1; j < buf->rpc_type_size; j++) {
 				if (buf->rpc_type_cnt[i] >= buf->rpc_type_cnt[j])
 					continue;
+				_swap_type_hist(i, j);
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
@@ -109,18 +109,44 @@ int print_sinfo_list(List sinfo_list)
 	return SLURM_SUCCESS;
 }
 
+/* The format list is compiled once into a flat op array so printing a
+ * row walks plain memory rather than creating a list iterator per row */
+static sinfo_format_t *compiled_format = NULL;
+static int compiled_format_cnt = 0;
+static List compiled_format_list = NULL;
+
+static void _compile_format(List list)
+{
+	ListIterator i;
+	sinfo_format_t *current;
+	int inx = 0;
+
+	if (compiled_format_list == list)
+		return;
+	xfree(compiled_format);
+	compiled_format_cnt = list_count(list);
+	compiled_format = xmalloc(sizeof(sinfo_format_t) *
+				  compiled_format_cnt);
+	i = list_iterator_create(list);
+	while ((current = (sinfo_format_t *) list_next(i)))
+		compiled_format[inx++] = *current;
+	list_iterator_destroy(i);
+	compiled_format_list = list;
+}
+
 int print_sinfo_entry(sinfo_data_t *sinfo_data)
 {
-	ListIterator i = list_iterator_create(params.format_list);
 	sinfo_format_t *current;
+	int inx;
 
-	while ((current = (sinfo_format_t *) list_next(i)) != NULL) {
+	_compile_format(params.format_list);
+	for (inx = 0; inx < compiled_format_cnt; inx++) {
+		current = &compiled_format[inx];
 		if (current->function(sinfo_data, current->width,
 				      current->right_justify, current->suffix)
 		    != SLURM_SUCCESS)
 			return SLURM_ERROR;
 	}
-	list_iterator_destroy(i);
 
 	printf("\n");
 	return SLURM_SUCCESS;
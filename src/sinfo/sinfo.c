@@ -63,6 +63,17 @@ static pthread_mutex_t sinfo_cnt_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  sinfo_cnt_cond  = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t sinfo_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Hash index over the sinfo records under construction so each node is
+ * matched against its own grouping bucket rather than every record on
+ * sinfo_list. Keyed by a digest of exactly the fields the active match
+ * flags compare, with _match_part_data()/_match_node_data() still making
+ * the final call within a bucket. */
+#define SINFO_HASH_BUCKETS 1024
+static List sinfo_hash_table[SINFO_HASH_BUCKETS];
+static List sinfo_part_holders = NULL;	/* records awaiting first node */
+static pthread_mutex_t sinfo_hash_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool sinfo_hash_usable = false;
+
 /*************
  * Functions *
  *************/
@@ -98,6 +109,9 @@ static int _handle_subgrps(List sinfo_list, uint16_t part_num,
 			   partition_info_t *part_ptr,
 			   node_info_t *node_ptr, uint32_t node_scaling);
 static int _find_part_list(void *x, void *key);
+static uint32_t _group_hash(partition_info_t *part_ptr, node_info_t *node_ptr);
+static void _sinfo_hash_init(void);
+static void _sinfo_hash_fini(void);
 
 int main(int argc, char *argv[])
 {
@@ -502,6 +516,7 @@ static int _build_sinfo_data(List sinfo_list,
 	int j;
 
 	g_node_scaling = node_msg->node_scaling;
+	_sinfo_hash_init();
 
 	/* by default every partition is shown, even if no nodes */
 	if ((!params.node_flag) && params.match_flags.partition_flag) {
@@ -511,10 +526,14 @@ static int _build_sinfo_data(List sinfo_list,
 			    (list_find_first(params.part_list,
 					     _find_part_list,
 					     part_ptr->name))) {
-				list_append(sinfo_list, _create_sinfo(
+				sinfo_data_t *sinfo_ptr = _create_sinfo(
 						    part_ptr, (uint16_t) j,
 						    NULL,
-						    node_msg->node_scaling));
+						    node_msg->node_scaling);
+				list_append(sinfo_list, sinfo_ptr);
+				if (sinfo_hash_usable)
+					list_append(sinfo_part_holders,
+						    sinfo_ptr);
 			}
 		}
 	}
@@ -603,6 +622,7 @@ static int _build_sinfo_data(List sinfo_list,
 	}
 	slurm_mutex_unlock(&sinfo_cnt_mutex);
 
+	_sinfo_hash_fini();
 	_sort_hostlist(sinfo_list);
 	return SLURM_SUCCESS;
 }
@@ -1102,6 +1122,143 @@ static void _update_sinfo(sinfo_data_t *sinfo_ptr, node_info_t *node_ptr,
 		sinfo_ptr->cpus_idle += total_cpus;
 }
 
+static uint32_t _hash_str(uint32_t hash, const char *str)
+{
+	if (!str)
+		return (hash * 33) + 0xff;	/* distinct from "" */
+	while (*str)
+		hash = (hash * 33) + (unsigned char) *str++;
+	return (hash * 33) + 1;
+}
+
+static uint32_t _hash_u32(uint32_t hash, uint32_t value)
+{
+	return (hash * 33) + value;
+}
+
+/* Digest the fields that _match_part_data() and _match_node_data() will
+ * compare under the current match flags. Two entities with different
+ * digests can never be grouped together, two entities that would be
+ * grouped together always share a digest. Note that the digest must
+ * cover exactly the compared fields, nothing more. */
+static uint32_t _group_hash(partition_info_t *part_ptr, node_info_t *node_ptr)
+{
+	uint32_t hash = 5381, tmp = 0;
+
+	if (!params.list_reasons && part_ptr) {
+		if (params.match_flags.partition_flag)
+			hash = _hash_str(hash, part_ptr->name);
+		if (params.match_flags.avail_flag)
+			hash = _hash_u32(hash, part_ptr->state_up);
+		if (params.match_flags.groups_flag)
+			hash = _hash_str(hash, part_ptr->allow_groups);
+		if (params.match_flags.job_size_flag) {
+			hash = _hash_u32(hash, part_ptr->min_nodes);
+			hash = _hash_u32(hash, part_ptr->max_nodes);
+		}
+		if (params.match_flags.default_time_flag)
+			hash = _hash_u32(hash, part_ptr->default_time);
+		if (params.match_flags.max_time_flag)
+			hash = _hash_u32(hash, part_ptr->max_time);
+		if (params.match_flags.root_flag)
+			hash = _hash_u32(hash, part_ptr->flags &
+					 PART_FLAG_ROOT_ONLY);
+		if (params.match_flags.oversubscribe_flag)
+			hash = _hash_u32(hash, part_ptr->max_share);
+		if (params.match_flags.preempt_mode_flag)
+			hash = _hash_u32(hash, part_ptr->preempt_mode);
+		if (params.match_flags.priority_tier_flag)
+			hash = _hash_u32(hash, part_ptr->priority_tier);
+		if (params.match_flags.priority_job_factor_flag)
+			hash = _hash_u32(hash, part_ptr->priority_job_factor);
+		if (params.match_flags.max_cpus_per_node_flag)
+			hash = _hash_u32(hash, part_ptr->max_cpus_per_node);
+	}
+
+	if (params.node_flag)	/* never grouped, digest is partition only */
+		return hash;
+
+	if (params.match_flags.features_flag)
+		hash = _hash_str(hash, node_ptr->features);
+	if (params.match_flags.features_act_flag)
+		hash = _hash_str(hash, node_ptr->features_act);
+	if (params.match_flags.gres_flag)
+		hash = _hash_str(hash, node_ptr->gres);
+	if (params.match_flags.reason_flag)
+		hash = _hash_str(hash, node_ptr->reason);
+	if (params.match_flags.reason_timestamp_flag)
+		hash = _hash_u32(hash, (uint32_t) node_ptr->reason_time);
+	if (params.match_flags.reason_user_flag)
+		hash = _hash_u32(hash, node_ptr->reason_uid);
+	if (params.match_flags.state_flag)
+		hash = _hash_str(hash,
+				 node_state_string(node_ptr->node_state));
+	if (params.match_flags.alloc_mem_flag) {
+		select_g_select_nodeinfo_get(node_ptr->select_nodeinfo,
+					     SELECT_NODEDATA_MEM_ALLOC,
+					     NODE_STATE_ALLOCATED,
+					     &tmp);
+		hash = _hash_u32(hash, tmp);
+	}
+
+	if (!params.exact_match)
+		return hash;
+
+	if (params.match_flags.cpus_flag)
+		hash = _hash_u32(hash, node_ptr->cpus);
+	if (params.match_flags.sockets_flag)
+		hash = _hash_u32(hash, node_ptr->sockets);
+	if (params.match_flags.cores_flag)
+		hash = _hash_u32(hash, node_ptr->cores);
+	if (params.match_flags.threads_flag)
+		hash = _hash_u32(hash, node_ptr->threads);
+	if (params.match_flags.sct_flag) {
+		hash = _hash_u32(hash, node_ptr->sockets);
+		hash = _hash_u32(hash, node_ptr->cores);
+		hash = _hash_u32(hash, node_ptr->threads);
+	}
+	if (params.match_flags.disk_flag)
+		hash = _hash_u32(hash, node_ptr->tmp_disk);
+	if (params.match_flags.memory_flag)
+		hash = _hash_u32(hash, node_ptr->real_memory);
+	if (params.match_flags.weight_flag)
+		hash = _hash_u32(hash, node_ptr->weight);
+	if (params.match_flags.cpu_load_flag)
+		hash = _hash_u32(hash, node_ptr->cpu_load);
+	if (params.match_flags.free_mem_flag)
+		hash = _hash_u32(hash, node_ptr->free_mem);
+	if (params.match_flags.version_flag) {
+		/* _match_node_data() compares version by pointer */
+		hash = _hash_u32(hash, (uint32_t)
+				 ((intptr_t) node_ptr->version));
+	}
+
+	return hash;
+}
+
+static void _sinfo_hash_init(void)
+{
+	/* Hostname and node address grouping test hostlist membership
+	 * rather than field equality and cannot be keyed by a digest */
+	sinfo_hash_usable = !params.match_flags.hostnames_flag &&
+			    !params.match_flags.node_addr_flag;
+	if (!sinfo_hash_usable)
+		return;
+	sinfo_part_holders = list_create(NULL);
+}
+
+static void _sinfo_hash_fini(void)
+{
+	int i;
+
+	if (!sinfo_hash_usable)
+		return;
+	FREE_NULL_LIST(sinfo_part_holders);
+	for (i = 0; i < SINFO_HASH_BUCKETS; i++)
+		FREE_NULL_LIST(sinfo_hash_table[i]);
+	sinfo_hash_usable = false;
+}
+
 static int _insert_node_ptr(List sinfo_list, uint16_t part_num,
 			    partition_info_t *part_ptr,
 			    node_info_t *node_ptr, uint32_t node_scaling)
@@ -1121,6 +1278,65 @@ static int _insert_node_ptr(List sinfo_list, uint16_t part_num,
 			node_ptr->reason = xstrdup("Block(s) in error state");
 	}
 
+	if (sinfo_hash_usable) {
+		uint32_t hash = _group_hash(part_ptr, node_ptr);
+		int inx = hash % SINFO_HASH_BUCKETS;
+
+		slurm_mutex_lock(&sinfo_hash_mutex);
+		/* The first node of a partition claims the empty record
+		 * built up front by _build_sinfo_data() */
+		itr = list_iterator_create(sinfo_part_holders);
+		while ((sinfo_ptr = list_next(itr))) {
+			if (!_match_part_data(sinfo_ptr, part_ptr))
+				continue;
+			list_remove(itr);
+			if (!params.node_flag) {
+				if (!sinfo_hash_table[inx]) {
+					sinfo_hash_table[inx] =
+						list_create(NULL);
+				}
+				sinfo_ptr->group_hash = hash;
+				list_append(sinfo_hash_table[inx], sinfo_ptr);
+			}
+			break;
+		}
+		list_iterator_destroy(itr);
+
+		if (!sinfo_ptr && !params.node_flag && sinfo_hash_table[inx]) {
+			itr = list_iterator_create(sinfo_hash_table[inx]);
+			while ((sinfo_ptr = list_next(itr))) {
+				if (sinfo_ptr->group_hash != hash)
+					continue;
+				if (!_match_part_data(sinfo_ptr, part_ptr))
+					continue;
+				if (!_match_node_data(sinfo_ptr, node_ptr))
+					continue;
+				break;
+			}
+			list_iterator_destroy(itr);
+		}
+
+		if (!sinfo_ptr) {
+			sinfo_ptr = _create_sinfo(part_ptr, part_num,
+						  node_ptr, node_scaling);
+			if (!params.node_flag) {
+				if (!sinfo_hash_table[inx]) {
+					sinfo_hash_table[inx] =
+						list_create(NULL);
+				}
+				sinfo_ptr->group_hash = hash;
+				list_append(sinfo_hash_table[inx], sinfo_ptr);
+			}
+			slurm_mutex_unlock(&sinfo_hash_mutex);
+			list_append(sinfo_list, sinfo_ptr);
+			return rc;
+		}
+		slurm_mutex_unlock(&sinfo_hash_mutex);
+
+		_update_sinfo(sinfo_ptr, node_ptr, node_scaling);
+		return rc;
+	}
+
 	itr = list_iterator_create(sinfo_list);
 	while ((sinfo_ptr = list_next(itr))) {
 		if (!_match_part_data(sinfo_ptr, part_ptr))
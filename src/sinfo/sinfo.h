@@ -112,6 +112,10 @@ typedef struct {
 	 * root, share/oversubscribe, groups, priority */
 	partition_info_t* part_info;
 	uint16_t part_inx;
+
+	/* digest of the fields tested by the active match flags, used to
+	 * index this record while building the sinfo list */
+	uint32_t group_hash;
 } sinfo_data_t;
 
 /* Identify what fields must match for a node's information to be
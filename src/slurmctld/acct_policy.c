@@ -55,6 +55,121 @@ enum {
 	ACCT_POLICY_JOB_FINI
 };
 
+/*
+ * Memoize "job is blocked by limits" verdicts from
+ * acct_policy_job_runnable_pre_select(). When thousands of pending
+ * jobs share one association the scheduler walks the same assoc/QOS
+ * usage tree for each of them every cycle just to re-derive the same
+ * headroom answer. Blocked verdicts are keyed by the limit inputs
+ * (assoc, QOS, partition, job time limit) and invalidated whenever
+ * usage changes (job start/finish/submit) via a generation counter.
+ * A short time based expiration catches limit changes coming from
+ * the database which do not pass through this file. Only negative
+ * verdicts are cached, runnable jobs continue into node selection
+ * anyway, so there is little to save on that path.
+ */
+#define BLOCKED_CACHE_MAX_ENTRIES 4096
+#define BLOCKED_CACHE_LIFETIME 2	/* seconds */
+
+typedef struct blocked_cache_entry {
+	void *assoc_ptr;
+	void *qos_ptr;
+	void *part_ptr;
+	uint32_t time_limit;
+	uint16_t state_reason;
+	uint64_t generation;
+	time_t stamp;
+} blocked_cache_entry_t;
+
+static List blocked_cache_list = NULL;
+static pthread_mutex_t blocked_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t usage_generation = 0;
+
+static int _blocked_cache_match(void *x, void *key)
+{
+	blocked_cache_entry_t *entry = x;
+	blocked_cache_entry_t *probe = key;
+
+	return ((entry->assoc_ptr == probe->assoc_ptr) &&
+		(entry->qos_ptr == probe->qos_ptr) &&
+		(entry->part_ptr == probe->part_ptr) &&
+		(entry->time_limit == probe->time_limit));
+}
+
+static void _blocked_cache_del(void *x)
+{
+	xfree(x);
+}
+
+/* Note that assoc/QOS usage changed; all cached verdicts are stale */
+static void _blocked_cache_invalidate(void)
+{
+	slurm_mutex_lock(&blocked_cache_mutex);
+	usage_generation++;
+	slurm_mutex_unlock(&blocked_cache_mutex);
+}
+
+/* Test if a cached "blocked" verdict exists for this job's limit
+ * inputs. If found, sets the job's state reason and returns true. */
+static bool _blocked_cache_check(struct job_record *job_ptr)
+{
+	blocked_cache_entry_t probe, *entry;
+	bool found = false;
+
+	memset(&probe, 0, sizeof(blocked_cache_entry_t));
+	probe.assoc_ptr = job_ptr->assoc_ptr;
+	probe.qos_ptr = job_ptr->qos_ptr;
+	probe.part_ptr = job_ptr->part_ptr;
+	probe.time_limit = job_ptr->time_limit;
+
+	slurm_mutex_lock(&blocked_cache_mutex);
+	if (blocked_cache_list &&
+	    (entry = list_find_first(blocked_cache_list, _blocked_cache_match,
+				     &probe)) &&
+	    (entry->generation == usage_generation) &&
+	    (difftime(time(NULL), entry->stamp) < BLOCKED_CACHE_LIFETIME)) {
+		xfree(job_ptr->state_desc);
+		job_ptr->state_reason = entry->state_reason;
+		found = true;
+	}
+	slurm_mutex_unlock(&blocked_cache_mutex);
+
+	return found;
+}
+
+/* Record that a job with these limit inputs is blocked */
+static void _blocked_cache_store(struct job_record *job_ptr)
+{
+	blocked_cache_entry_t probe, *entry;
+
+	memset(&probe, 0, sizeof(blocked_cache_entry_t));
+	probe.assoc_ptr = job_ptr->assoc_ptr;
+	probe.qos_ptr = job_ptr->qos_ptr;
+	probe.part_ptr = job_ptr->part_ptr;
+	probe.time_limit = job_ptr->time_limit;
+
+	slurm_mutex_lock(&blocked_cache_mutex);
+	if (blocked_cache_list == NULL)
+		blocked_cache_list = list_create(_blocked_cache_del);
+	entry = list_find_first(blocked_cache_list, _blocked_cache_match,
+				&probe);
+	if (entry == NULL) {
+		if (list_count(blocked_cache_list) >=
+		    BLOCKED_CACHE_MAX_ENTRIES)
+			_blocked_cache_del(list_dequeue(blocked_cache_list));
+		entry = xmalloc(sizeof(blocked_cache_entry_t));
+		entry->assoc_ptr = probe.assoc_ptr;
+		entry->qos_ptr = probe.qos_ptr;
+		entry->part_ptr = probe.part_ptr;
+		entry->time_limit = probe.time_limit;
+		list_enqueue(blocked_cache_list, entry);
+	}
+	entry->state_reason = job_ptr->state_reason;
+	entry->generation = usage_generation;
+	entry->stamp = time(NULL);
+	slurm_mutex_unlock(&blocked_cache_mutex);
+}
+
 static int _get_tres_state_reason(int tres_pos, int unk_reason)
 {
 	switch (tres_pos) {
@@ -613,6 +728,8 @@ static void _adjust_limit_usage(int type, struct job_record *job_ptr)
 	    || !_valid_job_assoc(job_ptr))
 		return;
 
+	_blocked_cache_invalidate();
+
 	if (type == ACCT_POLICY_JOB_FINI)
 		priority_g_job_end(job_ptr);
 	else if (type == ACCT_POLICY_JOB_BEGIN) {
@@ -2311,6 +2428,8 @@ extern void acct_policy_alter_job(struct job_record *job_ptr,
 	    || !_valid_job_assoc(job_ptr))
 		return;
 
+	_blocked_cache_invalidate();
+
 	time_limit_secs = (uint64_t)job_ptr->time_limit * 60;
 	new_time_limit_secs = (uint64_t)new_time_limit * 60;
 
@@ -2753,6 +2872,11 @@ extern bool acct_policy_job_runnable_pre_select(struct job_record *job_ptr)
 	if (!(accounting_enforce & ACCOUNTING_ENFORCE_LIMITS))
 		return true;
 
+	/* A job sharing the limit inputs of one already evaluated
+	 * since the last usage change gets the memoized verdict */
+	if (_blocked_cache_check(job_ptr))
+		return false;
+
 	/* clear old state reason */
 	if (!acct_policy_job_runnable_state(job_ptr)) {
 		xfree(job_ptr->state_desc);
@@ -2932,6 +3056,9 @@ end_it:
 	assoc_mgr_unlock(&locks);
 	slurmdb_free_qos_rec_members(&qos_rec);
 
+	if (!rc)
+		_blocked_cache_store(job_ptr);
+
 	return rc;
 }
 
@@ -69,15 +69,18 @@
 #endif
 
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <pwd.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "src/common/fd.h"
 #include "src/common/forward.h"
 #include "src/common/list.h"
 #include "src/common/log.h"
@@ -95,6 +98,7 @@
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/locks.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/ping_nodes.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/state_save.h"
@@ -102,6 +106,9 @@
 
 #define MAX_RETRIES		100
 
+/* Concurrent non-blocking connections for wide no-response fan-out */
+#define FANOUT_IO_WINDOW	128
+
 typedef enum {
 	DSH_NEW,        /* Request not yet started */
 	DSH_ACTIVE,     /* Request in progress */
@@ -164,6 +171,7 @@ typedef struct queued_request {
 	time_t       first_attempt;	/* Time of first check for batch
 					 * launch RPC *only* */
 	time_t       last_attempt;	/* Time of last xmit attempt */
+	time_t       retry_time;	/* Time when eligible for replay */
 } queued_request_t;
 
 typedef struct mail_info {
@@ -177,11 +185,17 @@ static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type);
 static void _list_delete_retry(void *retry_entry);
 static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr);
 static task_info_t *_make_task_data(agent_info_t *agent_info_ptr, int inx);
+static void _no_resp_fanout(agent_info_t *agent_info_ptr);
 static void _notify_slurmctld_jobs(agent_info_t *agent_ptr);
 static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 		int no_resp_cnt, int retry_cnt);
 static void _purge_agent_args(agent_arg_t *agent_arg_ptr);
+static bool _coalesce_retry(queued_request_t *queued_req_ptr, time_t now);
+static bool _probe_recent(char *node_name, time_t now);
+static void _probe_note(char *node_name, time_t now);
 static void _queue_agent_retry(agent_info_t * agent_info_ptr, int count);
+static void _retry_wheel_insert(queued_request_t *queued_req_ptr,
+				time_t retry_time);
 static int _setup_requeue(agent_arg_t *agent_arg_ptr, thd_t *thread_ptr,
 			  int *count, int *spot);
 static void _spawn_retry_agent(agent_arg_t * agent_arg_ptr);
@@ -194,9 +208,31 @@ static void  _mail_free(void *arg);
 static void *_mail_proc(void *arg);
 static char *_mail_type_str(uint16_t mail_type);
 
+/* The retry queue is kept as a timer wheel of one-second slots so that
+ * agent_retry() only touches the requests which have actually come due
+ * rather than scanning every queued request on each pass.  Requests due
+ * beyond the wheel's horizon park in the last slot and re-circulate when
+ * it is serviced, which collapses the higher wheel levels into re-queues
+ * that are rare in practice (the horizon exceeds RPC_RETRY_INTERVAL). */
+#define RETRY_WHEEL_SIZE 256		/* one-second slots, power of two */
+
+/* Cache of recent single-node retry transmissions, used to coalesce
+ * multiple RPCs queued for the same non-responding node into one probe
+ * per retry interval.  Strictly a heuristic: hash collisions just
+ * overwrite and at worst an extra RPC is sent. */
+#define PROBE_HASH_SIZE 64
+typedef struct probe_ent {
+	char  *node_name;	/* last node probed in this hash slot */
+	time_t probe_time;	/* time of last transmission to it */
+} probe_ent_t;
+
 static pthread_mutex_t retry_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t mail_mutex  = PTHREAD_MUTEX_INITIALIZER;
-static List retry_list = NULL;		/* agent_arg_t list for retry */
+static List *retry_wheel = NULL;	/* timer wheel of queued_request_t */
+static time_t retry_wheel_time = 0;	/* due time of slot retry_wheel_inx */
+static int  retry_wheel_inx = 0;	/* next slot to service */
+static int  retry_wheel_cnt = 0;	/* total requests queued in wheel */
+static probe_ent_t probe_table[PROBE_HASH_SIZE];
 static List mail_list = NULL;		/* pending e-mail requests */
 
 static pthread_mutex_t agent_cnt_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -239,7 +275,7 @@ void *agent(void *args)
 #if 0
 	info("Agent_cnt=%d agent_thread_cnt=%d with msg_type=%d backlog_size=%d",
 	     agent_cnt, agent_thread_cnt, agent_arg_ptr->msg_type,
-	     list_count(retry_list));
+	     retry_wheel_cnt);
 #endif
 	slurm_mutex_lock(&agent_cnt_mutex);
 	if (!wiki2_sched_test) {
@@ -289,6 +325,18 @@ void *agent(void *args)
 	slurm_attr_destroy(&attr_wdog);
 
 	debug2("got %d threads to send out", agent_info_ptr->thread_count);
+	if (!agent_info_ptr->get_reply) {
+		/* No reply expected (e.g. REBOOT_NODES, RECONFIGURE,
+		 * SHUTDOWN, srun notifications). Drive all of the sends
+		 * from this thread with non-blocking I/O rather than
+		 * cycling AGENT_THREAD_COUNT blocking threads through
+		 * the list. An unresponsive destination (e.g. a wedged
+		 * srun on a login node) then costs a polled file
+		 * descriptor instead of a thread blocked for the full
+		 * message timeout. */
+		_no_resp_fanout(agent_info_ptr);
+		goto threads_done;
+	}
 	/* start all the other threads (up to AGENT_THREAD_COUNT active) */
 	for (i = 0; i < agent_info_ptr->thread_count; i++) {
 
@@ -329,6 +377,7 @@ void *agent(void *args)
 		slurm_mutex_unlock(&agent_info_ptr->thread_mutex);
 	}
 
+threads_done:
 	/* Wait for termination of remaining threads */
 	pthread_join(thread_wdog, NULL);
 	delay = (int) difftime(time(NULL), begin_time);
@@ -809,6 +858,208 @@ static int _wif_status(void)
 	return rc;
 }
 
+/* Non-blocking connection used by _no_resp_fanout() */
+typedef struct fanout_conn {
+	int fd;			/* connected socket */
+	int inx;		/* index into thread_struct */
+	bool connecting;	/* connect() still in progress */
+	uint32_t offset;	/* bytes of message image already sent */
+	time_t end_time;	/* when to give up on this peer */
+} fanout_conn_t;
+
+/* Record the completion state of one fan-out destination */
+static void _fanout_set_state(agent_info_t *agent_info_ptr, int inx,
+			      state_t state, bool srun_agent)
+{
+	thd_t *thread_ptr = agent_info_ptr->thread_struct;
+	/* Lock: Read node */
+	slurmctld_lock_t node_read_lock = {
+		NO_LOCK, NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
+
+	if ((state != DSH_DONE) && !srun_agent) {
+		lock_slurmctld(node_read_lock);
+		_comm_err(thread_ptr[inx].nodelist, agent_info_ptr->msg_type);
+		unlock_slurmctld(node_read_lock);
+	}
+	if (srun_agent && thread_ptr[inx].addr) {
+		if (state == DSH_DONE)
+			srun_comm_note_success(thread_ptr[inx].addr);
+		else
+			srun_comm_note_failure(thread_ptr[inx].addr);
+	}
+	slurm_mutex_lock(&agent_info_ptr->thread_mutex);
+	thread_ptr[inx].state = state;
+	thread_ptr[inx].end_time = time(NULL);
+	slurm_mutex_unlock(&agent_info_ptr->thread_mutex);
+}
+
+/*
+ * _no_resp_fanout - issue an RPC expecting no reply to every destination
+ *	of this agent from a single thread. The message is packed (with
+ *	its auth credential) once, then sent over a wide window of
+ *	non-blocking connections multiplexed with poll() instead of
+ *	cycling AGENT_THREAD_COUNT blocking threads through the node
+ *	list. Thread states are recorded for the watchdog exactly as the
+ *	per-thread path does, so retry handling is unchanged.
+ */
+static void _no_resp_fanout(agent_info_t *agent_info_ptr)
+{
+	thd_t *thread_ptr = agent_info_ptr->thread_struct;
+	slurm_msg_t msg;
+	Buf buffer;
+	char *image;
+	uint32_t image_size, nl_size;
+	struct pollfd *pfds;
+	fanout_conn_t *conns;
+	int nconns = 0, next_inx = 0, i, timeout;
+	bool srun_agent;
+	time_t now;
+
+	timeout = MAX(slurm_get_msg_timeout(), 30);
+	srun_agent = ((agent_info_ptr->msg_type == SRUN_PING)		||
+		      (agent_info_ptr->msg_type == SRUN_EXEC)		||
+		      (agent_info_ptr->msg_type == SRUN_JOB_COMPLETE)	||
+		      (agent_info_ptr->msg_type == SRUN_STEP_MISSING)	||
+		      (agent_info_ptr->msg_type == SRUN_STEP_SIGNAL)	||
+		      (agent_info_ptr->msg_type == SRUN_TIMEOUT)	||
+		      (agent_info_ptr->msg_type == SRUN_USER_MSG)	||
+		      (agent_info_ptr->msg_type == SRUN_NODE_FAIL));
+	xsignal(SIGPIPE, SIG_IGN);
+
+	slurm_msg_t_init(&msg);
+	if (agent_info_ptr->protocol_version)
+		msg.protocol_version = agent_info_ptr->protocol_version;
+	msg.msg_type = agent_info_ptr->msg_type;
+	msg.data     = *agent_info_ptr->msg_args_pptr;
+	buffer = slurm_pack_msg_buf(&msg);
+	if (!buffer) {
+		error("%s: unable to pack msg_type %u",
+		      __func__, agent_info_ptr->msg_type);
+		for (i = 0; i < agent_info_ptr->thread_count; i++)
+			_fanout_set_state(agent_info_ptr, i, DSH_NO_RESP,
+					  srun_agent);
+		return;
+	}
+
+	/* build on-wire image: uint32 length then packed message */
+	image_size = get_buf_offset(buffer) + sizeof(uint32_t);
+	image = xmalloc(image_size);
+	nl_size = htonl(get_buf_offset(buffer));
+	memcpy(image, &nl_size, sizeof(uint32_t));
+	memcpy(image + sizeof(uint32_t), get_buf_data(buffer),
+	       get_buf_offset(buffer));
+	free_buf(buffer);
+
+	conns = xmalloc(sizeof(fanout_conn_t) * FANOUT_IO_WINDOW);
+	pfds  = xmalloc(sizeof(struct pollfd)  * FANOUT_IO_WINDOW);
+
+	while ((next_inx < agent_info_ptr->thread_count) || (nconns > 0)) {
+		/* open new connections to fill the I/O window */
+		while ((nconns < FANOUT_IO_WINDOW) &&
+		       (next_inx < agent_info_ptr->thread_count)) {
+			slurm_addr_t addr;
+			int inx = next_inx++, fd;
+
+			thread_ptr[inx].start_time = time(NULL);
+			if (thread_ptr[inx].addr) {
+				addr = *thread_ptr[inx].addr;
+			} else if (slurm_conf_get_addr(thread_ptr[inx].
+						       nodelist, &addr)
+				   == SLURM_ERROR) {
+				error("%s: can't find address for host %s, "
+				      "check slurm.conf",
+				      __func__, thread_ptr[inx].nodelist);
+				_fanout_set_state(agent_info_ptr, inx,
+						  DSH_FAILED, srun_agent);
+				continue;
+			}
+			fd = socket(AF_INET, SOCK_STREAM, 0);
+			if (fd < 0) {
+				error("%s: socket: %m", __func__);
+				_fanout_set_state(agent_info_ptr, inx,
+						  DSH_NO_RESP, srun_agent);
+				continue;
+			}
+			fd_set_nonblocking(fd);
+			if ((connect(fd, (struct sockaddr *) &addr,
+				     sizeof(addr)) < 0) &&
+			    (errno != EINPROGRESS)) {
+				close(fd);
+				_fanout_set_state(agent_info_ptr, inx,
+						  DSH_NO_RESP, srun_agent);
+				continue;
+			}
+			conns[nconns].fd = fd;
+			conns[nconns].inx = inx;
+			conns[nconns].connecting = true;
+			conns[nconns].offset = 0;
+			conns[nconns].end_time = time(NULL) + timeout;
+			nconns++;
+		}
+		if (nconns == 0)
+			continue;	/* all new destinations failed */
+
+		for (i = 0; i < nconns; i++) {
+			pfds[i].fd = conns[i].fd;
+			pfds[i].events = POLLOUT;
+			pfds[i].revents = 0;
+		}
+		(void) poll(pfds, nconns, 1000);
+		now = time(NULL);
+
+		/* reverse order, completed entries swap with the tail */
+		for (i = nconns - 1; i >= 0; i--) {
+			bool fail = false, done = false;
+
+			if (pfds[i].revents &
+			    (POLLERR | POLLHUP | POLLNVAL)) {
+				fail = true;
+			} else if (pfds[i].revents & POLLOUT) {
+				if (conns[i].connecting) {
+					int err = 0;
+					socklen_t len = sizeof(err);
+					if (getsockopt(conns[i].fd, SOL_SOCKET,
+						       SO_ERROR, &err, &len) ||
+					    err)
+						fail = true;
+					else
+						conns[i].connecting = false;
+				}
+				if (!fail && !conns[i].connecting) {
+					ssize_t n;
+					n = write(conns[i].fd,
+						  image + conns[i].offset,
+						  image_size -
+						  conns[i].offset);
+					if ((n < 0) && (errno != EAGAIN) &&
+					    (errno != EINTR)) {
+						fail = true;
+					} else if (n > 0) {
+						conns[i].offset += n;
+						if (conns[i].offset ==
+						    image_size)
+							done = true;
+					}
+				}
+			}
+			if (!fail && !done && (now >= conns[i].end_time))
+				fail = true;
+			if (fail || done) {
+				close(conns[i].fd);
+				_fanout_set_state(agent_info_ptr,
+						  conns[i].inx,
+						  done ? DSH_DONE :
+							 DSH_NO_RESP,
+						  srun_agent);
+				conns[i] = conns[--nconns];
+			}
+		}
+	}
+	xfree(conns);
+	xfree(pfds);
+	xfree(image);
+}
+
 /*
  * _thread_per_group_rpc - thread to issue an RPC for a group of nodes
  *                         sending message out to one and forwarding it to
@@ -847,6 +1098,7 @@ static void *_thread_per_group_rpc(void *args)
 		NO_LOCK, NO_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
 
 	xassert(args != NULL);
+	ctld_numa_bind_rpc_thread();
 	xsignal(SIGUSR1, _sig_handler);
 	xsignal_unblock(sig_array);
 	is_kill_msg = (	(msg_type == REQUEST_KILL_TIMELIMIT)	||
@@ -1207,19 +1459,122 @@ static void _queue_agent_retry(agent_info_t * agent_info_ptr, int count)
 	debug2("Queue RPC msg_type=%u, nodes=%d for retry",
 	       agent_arg_ptr->msg_type, j);
 
-	/* add the requeust to a list */
+	/* add the request to the timer wheel */
 	queued_req_ptr = xmalloc(sizeof(queued_request_t));
 	queued_req_ptr->agent_arg_ptr = agent_arg_ptr;
 	queued_req_ptr->last_attempt  = time(NULL);
 	slurm_mutex_lock(&retry_mutex);
-	if (retry_list == NULL) {
-		retry_list = list_create(_list_delete_retry);
-		if (retry_list == NULL)
-			fatal("list_create failed");
+	_retry_wheel_insert(queued_req_ptr,
+			    queued_req_ptr->last_attempt + RPC_RETRY_INTERVAL);
+	slurm_mutex_unlock(&retry_mutex);
+}
+
+/*
+ * _retry_wheel_insert - queue a request in the timer wheel slot matching
+ *	its eligibility time, creating the wheel on first use
+ * IN queued_req_ptr - request to queue, wheel takes ownership
+ * IN retry_time - time when the request becomes eligible for replay
+ * NOTE: the caller must hold retry_mutex
+ */
+static void _retry_wheel_insert(queued_request_t *queued_req_ptr,
+				time_t retry_time)
+{
+	int slot;
+
+	if (retry_wheel == NULL) {
+		retry_wheel = xmalloc(sizeof(List) * RETRY_WHEEL_SIZE);
+		retry_wheel_time = time(NULL);
+		retry_wheel_inx  = 0;
 	}
-	if (list_append(retry_list, (void *) queued_req_ptr) == 0)
+	if (retry_time < retry_wheel_time)
+		retry_time = retry_wheel_time;
+	slot = retry_wheel_inx +
+	       MIN(retry_time - retry_wheel_time, (RETRY_WHEEL_SIZE - 1));
+	slot &= (RETRY_WHEEL_SIZE - 1);
+	if (retry_wheel[slot] == NULL)
+		retry_wheel[slot] = list_create(_list_delete_retry);
+	queued_req_ptr->retry_time = retry_time;
+	if (list_append(retry_wheel[slot], (void *) queued_req_ptr) == 0)
 		fatal("list_append failed");
-	slurm_mutex_unlock(&retry_mutex);
+	retry_wheel_cnt++;
+}
+
+/* Hash a node name into the probe table */
+static int _probe_hash(char *node_name)
+{
+	unsigned int hash = 5381;
+
+	while (*node_name)
+		hash = ((hash << 5) + hash) + *node_name++;
+	return (int) (hash % PROBE_HASH_SIZE);
+}
+
+/* Return true if a retry RPC was already sent to this node within the
+ * last RPC_RETRY_INTERVAL seconds (one probe per node per interval) */
+static bool _probe_recent(char *node_name, time_t now)
+{
+	probe_ent_t *probe_ent = probe_table + _probe_hash(node_name);
+
+	if (probe_ent->node_name &&
+	    (xstrcmp(probe_ent->node_name, node_name) == 0) &&
+	    (difftime(now, probe_ent->probe_time) < RPC_RETRY_INTERVAL))
+		return true;
+	return false;
+}
+
+/* Record the transmission of a retry RPC to the given node */
+static void _probe_note(char *node_name, time_t now)
+{
+	probe_ent_t *probe_ent = probe_table + _probe_hash(node_name);
+
+	if (xstrcmp(probe_ent->node_name, node_name)) {
+		xfree(probe_ent->node_name);
+		probe_ent->node_name = xstrdup(node_name);
+	}
+	probe_ent->probe_time = now;
+}
+
+/*
+ * _coalesce_retry - coalesce retries targeted at a non-responding node
+ *	into one probe per retry interval
+ * IN queued_req_ptr - request due for replay
+ * IN now - current time
+ * RET true if the target node was probed recently and this request
+ *	should be held back, false if it should be transmitted (in which
+ *	case the probe time has been recorded)
+ * NOTE: the caller must hold retry_mutex
+ */
+static bool _coalesce_retry(queued_request_t *queued_req_ptr, time_t now)
+{
+	agent_arg_t *agent_arg_ptr = queued_req_ptr->agent_arg_ptr;
+#ifdef HAVE_FRONT_END
+	front_end_record_t *node_ptr;
+#else
+	struct node_record *node_ptr;
+#endif
+	char *node_name;
+	bool hold = false;
+
+	if (!agent_arg_ptr || !agent_arg_ptr->retry ||
+	    (agent_arg_ptr->node_count != 1) || !agent_arg_ptr->hostlist)
+		return false;
+
+	node_name = hostlist_nth(agent_arg_ptr->hostlist, 0);
+	if (node_name == NULL)
+		return false;
+#ifdef HAVE_FRONT_END
+	node_ptr = find_front_end_record(node_name);
+#else
+	node_ptr = find_node_record(node_name);
+#endif
+	if (node_ptr && IS_NODE_NO_RESPOND(node_ptr)) {
+		if (_probe_recent(node_name, now))
+			hold = true;
+		else
+			_probe_note(node_name, now);
+	}
+	free(node_name);
+	return hold;
 }
 
 /*
@@ -1240,8 +1595,10 @@ static void _list_delete_retry(void *retry_entry)
 
 /*
  * agent_retry - Agent for retrying pending RPCs. One pending request is
- *	issued if it has been pending for at least min_wait seconds
- * IN min_wait - Minimum wait time between re-issue of a pending RPC
+ *	issued if it has come due in the retry timer wheel; eligibility
+ *	times are assigned when requests are queued
+ * IN min_wait - Historic minimum wait time between re-issue of a pending
+ *	RPC, now captured in the queued request's eligibility time
  * IN mail_too - Send pending email too, note this performed using a
  *	fork/waitpid, so it can take longer than just creating a pthread
  *	to send RPCs
@@ -1259,25 +1616,34 @@ extern int agent_retry (int min_wait, bool mail_too)
 	mail_info_t *mi = NULL;
 
 	slurm_mutex_lock(&retry_mutex);
-	if (retry_list) {
+	list_size = retry_wheel_cnt;
+	if (retry_wheel) {
 		static time_t last_msg_time = (time_t) 0;
 		uint32_t msg_type[5] = {0, 0, 0, 0, 0}, i = 0;
-		list_size = list_count(retry_list);
+		int slot;
 		if ((list_size > 100) &&
 		    (difftime(now, last_msg_time) > 300)) {
 			/* Note sizable backlog of work */
-			info("slurmctld: agent retry_list size is %d",
+			info("slurmctld: agent retry queue size is %d",
 				list_size);
-			retry_iter = list_iterator_create(retry_list);
-			while ((queued_req_ptr = (queued_request_t *)
-					list_next(retry_iter))) {
-				agent_arg_ptr = queued_req_ptr->agent_arg_ptr;
-				msg_type[i++] = agent_arg_ptr->msg_type;
-				if (i == 5)
-					break;
+			for (slot = 0; (slot < RETRY_WHEEL_SIZE) && (i < 5);
+			     slot++) {
+				if (retry_wheel[slot] == NULL)
+					continue;
+				retry_iter = list_iterator_create(
+							retry_wheel[slot]);
+				while ((i < 5) &&
+				       (queued_req_ptr = (queued_request_t *)
+						list_next(retry_iter))) {
+					agent_arg_ptr = queued_req_ptr->
+							agent_arg_ptr;
+					msg_type[i++] = agent_arg_ptr->
+							msg_type;
+				}
+				list_iterator_destroy(retry_iter);
 			}
-			list_iterator_destroy(retry_iter);
-			info("   retry_list msg_type=%u,%u,%u,%u,%u",
+			queued_req_ptr = NULL;
+			info("   retry queue msg_type=%u,%u,%u,%u,%u",
 				msg_type[0], msg_type[1], msg_type[2],
 				msg_type[3], msg_type[4]);
 			last_msg_time = now;
@@ -1293,61 +1659,73 @@ extern int agent_retry (int min_wait, bool mail_too)
 	}
 	slurm_mutex_unlock(&agent_cnt_mutex);
 
-	if (retry_list) {
-		/* first try to find a new (never tried) record */
-
-		retry_iter = list_iterator_create(retry_list);
-		while ((queued_req_ptr = (queued_request_t *)
-				list_next(retry_iter))) {
-			rc = _batch_launch_defer(queued_req_ptr);
-			if (rc == -1) {		/* abort request */
-				_purge_agent_args(queued_req_ptr->
-						  agent_arg_ptr);
-				xfree(queued_req_ptr);
-				list_remove(retry_iter);
-				list_size--;
-				continue;
-			}
-			if (rc > 0)
-				continue;
- 			if (queued_req_ptr->last_attempt == 0) {
-				list_remove(retry_iter);
-				list_size--;
-				break;
-			}
-		}
-		list_iterator_destroy(retry_iter);
-	}
+	/* Advance the wheel through the slots which have come due,
+	 * dispatching at most one request per call as before.  Slots
+	 * which have not yet come due are never touched. */
+	while (retry_wheel && (queued_req_ptr == NULL) &&
+	       (retry_wheel_time <= now)) {
+		List slot_list = retry_wheel[retry_wheel_inx];
 
-	if (retry_list && (queued_req_ptr == NULL)) {
-		/* now try to find a requeue request that is
-		 * relatively old */
-		double age = 0;
-
-		retry_iter = list_iterator_create(retry_list);
-		/* next try to find an older record to retry */
-		while ((queued_req_ptr = (queued_request_t *)
-				list_next(retry_iter))) {
-			rc = _batch_launch_defer(queued_req_ptr);
-			if (rc == -1) { 	/* abort request */
-				_purge_agent_args(queued_req_ptr->
-						  agent_arg_ptr);
-				xfree(queued_req_ptr);
-				list_remove(retry_iter);
-				list_size--;
-				continue;
-			}
-			if (rc > 0)
-				continue;
-			age = difftime(now, queued_req_ptr->last_attempt);
-			if (age > min_wait) {
+		if (slot_list && list_count(slot_list)) {
+			retry_iter = list_iterator_create(slot_list);
+			while ((queued_req_ptr = (queued_request_t *)
+					list_next(retry_iter))) {
+				rc = _batch_launch_defer(queued_req_ptr);
+				if (rc == -1) {		/* abort request */
+					_purge_agent_args(queued_req_ptr->
+							  agent_arg_ptr);
+					xfree(queued_req_ptr);
+					list_remove(retry_iter);
+					retry_wheel_cnt--;
+					queued_req_ptr = NULL;
+					continue;
+				}
+				if (rc > 0) {
+					/* Batch launch still deferred, its
+					 * node test is throttled to once
+					 * every 10 seconds */
+					list_remove(retry_iter);
+					retry_wheel_cnt--;
+					_retry_wheel_insert(queued_req_ptr,
+							    now + 10);
+					queued_req_ptr = NULL;
+					continue;
+				}
+				if (queued_req_ptr->retry_time > now) {
+					/* Timer beyond the wheel horizon
+					 * which wrapped, re-circulate it */
+					list_remove(retry_iter);
+					retry_wheel_cnt--;
+					_retry_wheel_insert(queued_req_ptr,
+						queued_req_ptr->retry_time);
+					queued_req_ptr = NULL;
+					continue;
+				}
+				if (_coalesce_retry(queued_req_ptr, now)) {
+					/* Another RPC probed this
+					 * non-responding node recently,
+					 * hold this one back */
+					list_remove(retry_iter);
+					retry_wheel_cnt--;
+					_retry_wheel_insert(queued_req_ptr,
+							    now + 2);
+					queued_req_ptr = NULL;
+					continue;
+				}
 				list_remove(retry_iter);
-				list_size--;
+				retry_wheel_cnt--;
 				break;
 			}
+			list_iterator_destroy(retry_iter);
 		}
-		list_iterator_destroy(retry_iter);
+		if (queued_req_ptr)
+			break;
+		/* slot drained, advance the wheel */
+		retry_wheel_inx = (retry_wheel_inx + 1) &
+				  (RETRY_WHEEL_SIZE - 1);
+		retry_wheel_time++;
 	}
+	list_size = retry_wheel_cnt;
 	slurm_mutex_unlock(&retry_mutex);
 
 	if (queued_req_ptr) {
@@ -1426,13 +1804,8 @@ void agent_queue_request(agent_arg_t *agent_arg_ptr)
 /*	queued_req_ptr->last_attempt  = 0; Implicit */
 
 	slurm_mutex_lock(&retry_mutex);
-
-	if (retry_list == NULL) {
-		retry_list = list_create(_list_delete_retry);
-		if (retry_list == NULL)
-			fatal("list_create failed");
-	}
-	list_append(retry_list, (void *)queued_req_ptr);
+	/* new (never tried) requests are eligible immediately */
+	_retry_wheel_insert(queued_req_ptr, time(NULL));
 	slurm_mutex_unlock(&retry_mutex);
 
 	/* now process the request in a separate pthread
@@ -1485,9 +1858,18 @@ extern void slurmctld_free_batch_job_launch_msg(batch_job_launch_msg_t * msg)
 /* agent_purge - purge all pending RPC requests */
 void agent_purge(void)
 {
-	if (retry_list) {
+	int i;
+
+	if (retry_wheel) {
 		slurm_mutex_lock(&retry_mutex);
-		FREE_NULL_LIST(retry_list);
+		for (i = 0; i < RETRY_WHEEL_SIZE; i++)
+			FREE_NULL_LIST(retry_wheel[i]);
+		xfree(retry_wheel);
+		retry_wheel_time = 0;
+		retry_wheel_inx  = 0;
+		retry_wheel_cnt  = 0;
+		for (i = 0; i < PROBE_HASH_SIZE; i++)
+			xfree(probe_table[i].node_name);
 		slurm_mutex_unlock(&retry_mutex);
 	}
 	if (mail_list) {
@@ -1885,10 +2267,8 @@ static int _batch_launch_defer(queued_request_t *queued_req_ptr)
 	return 1;
 }
 
-/* Return length of agent's retry_list */
+/* Return length of agent's retry queue */
 extern int retry_list_size(void)
 {
-	if (retry_list == NULL)
-		return 0;
-	return list_count(retry_list);
+	return retry_wheel_cnt;
 }
@@ -40,6 +40,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
@@ -51,6 +52,7 @@
 #include "slurm/slurm_errno.h"
 
 #include "src/common/daemonize.h"
+#include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/node_select.h"
@@ -63,6 +65,7 @@
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
 #define SHUTDOWN_WAIT     2	/* Time to wait for primary server shutdown */
@@ -72,6 +75,8 @@ static void *       _background_rpc_mgr(void *no_data);
 static void *       _background_signal_hand(void *no_data);
 static void         _backup_reconfig(void);
 static int          _ping_controller(void);
+static void         _state_replica_flush(void);
+static void         _state_stream_save(ctld_state_stream_msg_t *stream_msg);
 static int          _shutdown_primary_controller(int wait_time);
 static void	     _trigger_slurmctld_event(uint32_t trig_type);
 inline static void  _update_cred_key(void);
@@ -81,6 +86,17 @@ static bool          dump_core = false;
 static volatile bool takeover = false;
 static time_t last_controller_response;
 
+/* State save buffers streamed from the primary controller, one entry per
+ * state file, each holding the most recently streamed copy */
+typedef struct state_replica {
+	char *file_name;	/* state file base name, e.g. "job_state" */
+	char *data;		/* serialized state */
+	uint32_t data_size;	/* size of data */
+	time_t update_time;	/* time last streamed copy arrived */
+} state_replica_t;
+static List state_replica_list = NULL;
+static pthread_mutex_t state_replica_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * Static list of signals to block in this process
  * *Must be zero-terminated*
@@ -215,6 +231,11 @@ void run_backup(slurm_trigger_callbacks_t *callbacks)
 
 	ctld_assoc_mgr_init(callbacks);
 
+	/* Update StateSaveLocation with any state the primary streamed to
+	 * us, so the recovery below works from current, memory resident
+	 * data */
+	_state_replica_flush();
+
 	/* clear old state and read new state */
 	lock_slurmctld(config_write_lock);
 	if (switch_g_restore(slurmctld_conf.state_save_location, true)) {
@@ -232,6 +253,132 @@ void run_backup(slurm_trigger_callbacks_t *callbacks)
 	return;
 }
 
+static void _state_replica_del(void *x)
+{
+	state_replica_t *rep = (state_replica_t *) x;
+
+	xfree(rep->file_name);
+	xfree(rep->data);
+	xfree(rep);
+}
+
+static int _find_state_replica(void *x, void *key)
+{
+	state_replica_t *rep = (state_replica_t *) x;
+
+	if (xstrcmp(rep->file_name, (char *) key) == 0)
+		return 1;
+	return 0;
+}
+
+/* Record a state save buffer streamed from the primary controller,
+ * replacing any previously streamed copy of the same file. The buffers
+ * are taken over from stream_msg rather than copied, a job_state buffer
+ * can be quite large. */
+static void _state_stream_save(ctld_state_stream_msg_t *stream_msg)
+{
+	state_replica_t *rep;
+
+	if ((stream_msg == NULL) || (stream_msg->file_name == NULL) ||
+	    (stream_msg->file_name[0] == '\0') ||
+	    strchr(stream_msg->file_name, '/')) {
+		error("Invalid state stream file name");
+		return;
+	}
+
+	slurm_mutex_lock(&state_replica_mutex);
+	if (state_replica_list == NULL)
+		state_replica_list = list_create(_state_replica_del);
+	rep = list_find_first(state_replica_list, _find_state_replica,
+			      stream_msg->file_name);
+	if (rep == NULL) {
+		rep = xmalloc(sizeof(state_replica_t));
+		rep->file_name = stream_msg->file_name;
+		stream_msg->file_name = NULL;
+		list_append(state_replica_list, rep);
+	} else
+		xfree(rep->data);
+	rep->data = stream_msg->data;
+	rep->data_size = stream_msg->data_size;
+	rep->update_time = time(NULL);
+	stream_msg->data = NULL;
+	stream_msg->data_size = 0;
+	slurm_mutex_unlock(&state_replica_mutex);
+	debug2("cached streamed state file %s (%u bytes)",
+	       rep->file_name, rep->data_size);
+}
+
+/* Write the state file replicas streamed by the primary controller to
+ * StateSaveLocation so the state recovery which follows reads current
+ * data directly from the page cache rather than from a possibly slow or
+ * stale filesystem. A file is skipped if the copy already on disk is
+ * newer than the streamed one (e.g. the primary saved state to a shared
+ * filesystem after relinquishing control). */
+static void _state_replica_flush(void)
+{
+	ListIterator iter;
+	state_replica_t *rep;
+	struct stat stat_buf;
+	char *reg_file, *new_file;
+	int fd;
+
+	slurm_mutex_lock(&state_replica_mutex);
+	if (state_replica_list == NULL) {
+		slurm_mutex_unlock(&state_replica_mutex);
+		return;
+	}
+	iter = list_iterator_create(state_replica_list);
+	while ((rep = list_next(iter))) {
+		reg_file = xstrdup_printf("%s/%s",
+					  slurmctld_conf.state_save_location,
+					  rep->file_name);
+		if ((stat(reg_file, &stat_buf) == 0) &&
+		    (stat_buf.st_mtime > rep->update_time)) {
+			debug("state file %s on disk is newer than streamed "
+			      "copy, leaving it in place", rep->file_name);
+			xfree(reg_file);
+			continue;
+		}
+		new_file = xstrdup_printf("%s.new", reg_file);
+		fd = creat(new_file, 0600);
+		if (fd < 0) {
+			error("Can't save streamed state, create file %s "
+			      "error %m", new_file);
+		} else {
+			int pos = 0, nwrite = rep->data_size, amount, rc;
+
+			while (nwrite > 0) {
+				amount = write(fd, &rep->data[pos], nwrite);
+				if ((amount < 0) && (errno != EINTR)) {
+					error("Error writing file %s, %m",
+					      new_file);
+					break;
+				} else if (amount >= 0) {
+					nwrite -= amount;
+					pos    += amount;
+				}
+			}
+			rc = fsync_and_close(fd, rep->file_name);
+			if ((rc == 0) && (nwrite == 0)) {
+				(void) unlink(reg_file);
+				if (link(new_file, reg_file))
+					debug4("unable to create link for "
+					       "%s -> %s: %m",
+					       new_file, reg_file);
+				info("Restored %s from state streamed by "
+				     "the primary controller",
+				     rep->file_name);
+			}
+			(void) unlink(new_file);
+		}
+		xfree(new_file);
+		xfree(reg_file);
+	}
+	list_iterator_destroy(iter);
+	FREE_NULL_LIST(state_replica_list);
+	slurm_mutex_unlock(&state_replica_mutex);
+}
+
 /* _background_signal_hand - Process daemon-wide signals for the
  *	backup controller */
 static void *_background_signal_hand(void *no_data)
@@ -410,6 +557,11 @@ static int _background_process_msg(slurm_msg_t * msg)
 			debug3("Ignoring RPC: REQUEST_CONTROL");
 			error_code = ESLURM_DISABLED;
 			last_controller_response = time(NULL);
+		} else if (super_user &&
+			   (msg->msg_type == REQUEST_CTLD_STATE_STREAM)) {
+			_state_stream_save((ctld_state_stream_msg_t *)
+					   msg->data);
+			last_controller_response = time(NULL);
 		} else {
 			error("Invalid RPC received %d while in standby mode",
 			      msg->msg_type);
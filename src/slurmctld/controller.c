@@ -99,6 +99,7 @@
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/ping_nodes.h"
 #include "src/slurmctld/port_mgr.h"
 #include "src/slurmctld/power_save.h"
@@ -184,6 +185,18 @@ static char *	debug_logfile = NULL;
 static bool	dump_core = false;
 static int      job_sched_cnt = 0;
 static uint32_t max_server_threads = MAX_SERVER_THREADS;
+
+/* RPC worker pool: accepted connections are queued and serviced by
+ * persistent worker threads rather than one pthread per connection.
+ * Workers are spawned on demand up to max_server_threads and exit
+ * after RPC_WORKER_IDLE_TIME seconds without work. */
+#define RPC_WORKER_IDLE_TIME 60
+static pthread_mutex_t rpc_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  rpc_queue_cond  = PTHREAD_COND_INITIALIZER;
+static List     rpc_conn_queue    = NULL;
+static uint32_t rpc_workers_total = 0;
+static uint32_t rpc_workers_idle  = 0;
+static bool     rpc_pool_shutdown = false;
 static time_t	next_stats_reset = 0;
 static int	new_nice = 0;
 static char	node_name_short[MAX_SLURM_NAME];
@@ -222,10 +235,13 @@ static int          _init_tres(void);
 static void         _update_cluster_tres(void);
 
 inline static int   _report_locks_set(void);
+static int          _rpc_enqueue(connection_arg_t *conn_arg);
+static void *       _rpc_worker(void *no_data);
 static void *       _service_connection(void *arg);
 static void         _set_work_dir(void);
 static int          _shutdown_backup_controller(int wait_time);
 static void *       _slurmctld_background(void *no_data);
+static void *       _rpc_accept_shard(void *arg);
 static void *       _slurmctld_rpc_mgr(void *no_data);
 static void *       _slurmctld_signal_hand(void *no_data);
 static void         _test_thread_limit(void);
@@ -822,7 +838,7 @@ static void _reconfigure_slurm(void)
 	 * restart the (possibly new) plugin.
 	 */
 	lock_slurmctld(config_write_lock);
-	rc = read_slurm_conf(2, true);
+	rc = read_slurm_conf_diff(2, true);
 	if (rc)
 		error("read_slurm_conf: %s", slurm_strerror(rc));
 	else {
@@ -843,6 +859,18 @@ static void _reconfigure_slurm(void)
 /* Request that the job scheduler execute soon (typically within seconds) */
 extern void queue_job_scheduler(void)
 {
+	sched_part_dirty(NULL);		/* scope unknown, full queue pass */
+	slurm_mutex_lock(&sched_cnt_mutex);
+	job_sched_cnt++;
+	slurm_mutex_unlock(&sched_cnt_mutex);
+}
+
+/* Request that the job scheduler promptly evaluate the queue of the given
+ * partition in response to a job completion, node state change or
+ * reservation expiry event (NULL partition requests a full queue pass) */
+extern void queue_part_scheduler(struct part_record *part_ptr)
+{
+	sched_part_dirty(part_ptr);
 	slurm_mutex_lock(&sched_cnt_mutex);
 	job_sched_cnt++;
 	slurm_mutex_unlock(&sched_cnt_mutex);
@@ -916,86 +944,29 @@ static void _sig_handler(int signal)
 {
 }
 
-/* _slurmctld_rpc_mgr - Read incoming RPCs and create pthread for each */
-static void *_slurmctld_rpc_mgr(void *no_data)
+/* Number of SO_REUSEPORT listeners sharing each slurmctld port.  Each
+ * shard accepts and queues its own subset of the incoming connections,
+ * so one accept(2) wakeup never serializes an RPC storm. */
+#define RPC_ACCEPT_SHARDS 4
+
+typedef struct rpc_shard_arg {
+	int *sockfd;		/* this shard's listeners, one per port */
+	int nports;
+} rpc_shard_arg_t;
+
+/* _rpc_accept_shard - accept and queue connections arriving on one
+ *	shard's set of listening sockets until told to shutdown */
+static void *_rpc_accept_shard(void *arg)
 {
+	rpc_shard_arg_t *shard = (rpc_shard_arg_t *) arg;
+	int *sockfd = shard->sockfd;
+	int nports = shard->nports;
 	int newsockfd;
-	int *sockfd;	/* our set of socket file descriptors */
-	slurm_addr_t cli_addr, srv_addr;
-	uint16_t port;
-	char ip[32];
-	pthread_t thread_id_rpc_req;
-	pthread_attr_t thread_attr_rpc_req;
+	slurm_addr_t cli_addr;
 	int no_thread;
-	int fd_next = 0, i, nports;
+	int fd_next = 0, i;
 	fd_set rfds;
 	connection_arg_t *conn_arg = NULL;
-	/* Locks: Read config */
-	slurmctld_lock_t config_read_lock = {
-		READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
-	int sigarray[] = {SIGUSR1, 0};
-	char* node_addr = NULL;
-
-#if HAVE_SYS_PRCTL_H
-	if (prctl(PR_SET_NAME, "rpcmgr", NULL, NULL, NULL) < 0) {
-		error("%s: cannot set my name to %s %m", __func__, "rpcmgr");
-	}
-#endif
-
-	(void) pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	(void) pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
-	debug3("_slurmctld_rpc_mgr pid = %u", getpid());
-
-	/* threads to process individual RPC's are detached */
-	slurm_attr_init(&thread_attr_rpc_req);
-	if (pthread_attr_setdetachstate
-	    (&thread_attr_rpc_req, PTHREAD_CREATE_DETACHED))
-		fatal("pthread_attr_setdetachstate %m");
-
-	/* set node_addr to bind to (NULL means any) */
-	if (slurmctld_conf.backup_controller && slurmctld_conf.backup_addr &&
-	    ((xstrcmp(node_name_short,slurmctld_conf.backup_controller) == 0) ||
-	     (xstrcmp(node_name_long, slurmctld_conf.backup_controller) == 0))&&
-	    (xstrcmp(slurmctld_conf.backup_controller,
-		     slurmctld_conf.backup_addr) != 0)) {
-		node_addr = slurmctld_conf.backup_addr ;
-	}
-	else if (_valid_controller() &&
-		 xstrcmp(slurmctld_conf.control_machine,
-			 slurmctld_conf.control_addr)) {
-		node_addr = slurmctld_conf.control_addr ;
-	}
-
-	/* initialize ports for RPCs */
-	lock_slurmctld(config_read_lock);
-	nports = slurmctld_conf.slurmctld_port_count;
-	if (nports == 0) {
-		fatal("slurmctld port count is zero");
-		return NULL;	/* Fix CLANG false positive */
-	}
-	sockfd = xmalloc(sizeof(int) * nports);
-	for (i=0; i<nports; i++) {
-		sockfd[i] = slurm_init_msg_engine_addrname_port(
-					node_addr,
-					slurmctld_conf.slurmctld_port+i);
-		if (sockfd[i] == SLURM_SOCKET_ERROR) {
-			fatal("slurm_init_msg_engine_addrname_port error %m");
-			return NULL;	/* Fix CLANG false positive */
-		}
-		fd_set_close_on_exec(sockfd[i]);
-		slurm_get_stream_addr(sockfd[i], &srv_addr);
-		slurm_get_ip_str(&srv_addr, &port, ip, sizeof(ip));
-		debug2("slurmctld listening on %s:%d", ip, ntohs(port));
-	}
-	unlock_slurmctld(config_read_lock);
-
-	/* Prepare to catch SIGUSR1 to interrupt accept().
-	 * This signal is generated by the slurmctld signal
-	 * handler thread upon receipt of SIGABRT, SIGINT,
-	 * or SIGTERM. That thread does all processing of
-	 * all signals. */
-	xsignal(SIGUSR1, _sig_handler);
-	xsignal_unblock(sigarray);
 
 	/*
 	 * Process incoming RPCs until told to shutdown
@@ -1050,11 +1021,8 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 
 		if (slurmctld_config.shutdown_time)
 			no_thread = 1;
-		else if (pthread_create(&thread_id_rpc_req,
-					&thread_attr_rpc_req,
-					_service_connection,
-					(void *) conn_arg)) {
-			error("pthread_create: %m");
+		else if (_rpc_enqueue(conn_arg)) {
+			error("%s: unable to queue connection", __func__);
 			no_thread = 1;
 		} else
 			no_thread = 0;
@@ -1065,16 +1033,216 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 	       	}
 	}
 
+	return NULL;
+}
+
+/* _slurmctld_rpc_mgr - Read incoming RPCs and create pthread for each */
+static void *_slurmctld_rpc_mgr(void *no_data)
+{
+	int *sockfd;	/* our set of socket file descriptors */
+	slurm_addr_t srv_addr;
+	uint16_t port;
+	char ip[32];
+	int i, nports;
+	int shard, nshards;
+	pthread_t *shard_tids = NULL;
+	rpc_shard_arg_t *shard_args = NULL;
+	/* Locks: Read config */
+	slurmctld_lock_t config_read_lock = {
+		READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	int sigarray[] = {SIGUSR1, 0};
+	char* node_addr = NULL;
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "rpcmgr", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "rpcmgr");
+	}
+#endif
+
+	(void) pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	(void) pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+	debug3("_slurmctld_rpc_mgr pid = %u", getpid());
+
+	rpc_conn_queue = list_create(NULL);
+
+	/* set node_addr to bind to (NULL means any) */
+	if (slurmctld_conf.backup_controller && slurmctld_conf.backup_addr &&
+	    ((xstrcmp(node_name_short,slurmctld_conf.backup_controller) == 0) ||
+	     (xstrcmp(node_name_long, slurmctld_conf.backup_controller) == 0))&&
+	    (xstrcmp(slurmctld_conf.backup_controller,
+		     slurmctld_conf.backup_addr) != 0)) {
+		node_addr = slurmctld_conf.backup_addr ;
+	}
+	else if (_valid_controller() &&
+		 xstrcmp(slurmctld_conf.control_machine,
+			 slurmctld_conf.control_addr)) {
+		node_addr = slurmctld_conf.control_addr ;
+	}
+
+	/* initialize ports for RPCs */
+	lock_slurmctld(config_read_lock);
+	nports = slurmctld_conf.slurmctld_port_count;
+	if (nports == 0) {
+		fatal("slurmctld port count is zero");
+		return NULL;	/* Fix CLANG false positive */
+	}
+	sockfd = xmalloc(sizeof(int) * nports * RPC_ACCEPT_SHARDS);
+	nshards = 0;
+	for (shard = 0; shard < RPC_ACCEPT_SHARDS; shard++) {
+		int *shard_fd = sockfd + (shard * nports);
+		for (i=0; i<nports; i++) {
+			shard_fd[i] = slurm_init_msg_engine_shard(
+						node_addr,
+						slurmctld_conf.slurmctld_port+i);
+			if (shard_fd[i] == SLURM_SOCKET_ERROR) {
+				if (shard == 0) {
+					fatal("slurm_init_msg_engine_shard error %m");
+					return NULL;	/* Fix CLANG false positive */
+				}
+				/* no SO_REUSEPORT support; run with the
+				 * shards already bound */
+				while (--i >= 0)
+					(void) slurm_shutdown_msg_engine(
+						shard_fd[i]);
+				break;
+			}
+			fd_set_close_on_exec(shard_fd[i]);
+			slurm_get_stream_addr(shard_fd[i], &srv_addr);
+			slurm_get_ip_str(&srv_addr, &port, ip, sizeof(ip));
+			debug2("slurmctld shard %d listening on %s:%d",
+			       shard, ip, ntohs(port));
+		}
+		if (i < nports)
+			break;
+		nshards++;
+	}
+	unlock_slurmctld(config_read_lock);
+
+	/* Prepare to catch SIGUSR1 to interrupt accept().
+	 * This signal is generated by the slurmctld signal
+	 * handler thread upon receipt of SIGABRT, SIGINT,
+	 * or SIGTERM. That thread does all processing of
+	 * all signals. */
+	xsignal(SIGUSR1, _sig_handler);
+	xsignal_unblock(sigarray);
+
+	/* Spawn the other shards; this thread services shard 0 */
+	shard_tids = xmalloc(sizeof(pthread_t) * nshards);
+	shard_args = xmalloc(sizeof(rpc_shard_arg_t) * nshards);
+	for (shard = 0; shard < nshards; shard++) {
+		shard_args[shard].sockfd = sockfd + (shard * nports);
+		shard_args[shard].nports = nports;
+	}
+	for (shard = 1; shard < nshards; shard++) {
+		pthread_attr_t shard_attr;
+		slurm_attr_init(&shard_attr);
+		if (pthread_create(&shard_tids[shard], &shard_attr,
+				   _rpc_accept_shard, &shard_args[shard])) {
+			error("pthread_create error %m");
+			slurm_attr_destroy(&shard_attr);
+			for (i=0; i<nports; i++)
+				(void) slurm_shutdown_msg_engine(
+					shard_args[shard].sockfd[i]);
+			nshards = shard;
+			break;
+		}
+		slurm_attr_destroy(&shard_attr);
+	}
+
+	_rpc_accept_shard(&shard_args[0]);
+
 	debug3("_slurmctld_rpc_mgr shutting down");
-	slurm_attr_destroy(&thread_attr_rpc_req);
-	for (i=0; i<nports; i++)
+	slurm_mutex_lock(&rpc_queue_mutex);
+	rpc_pool_shutdown = true;
+	slurm_cond_broadcast(&rpc_queue_cond);
+	slurm_mutex_unlock(&rpc_queue_mutex);
+	for (shard = 1; shard < nshards; shard++)
+		pthread_kill(shard_tids[shard], SIGUSR1);
+	for (shard = 1; shard < nshards; shard++)
+		pthread_join(shard_tids[shard], NULL);
+	for (i=0; i<nshards*nports; i++)
 		(void) slurm_shutdown_msg_engine(sockfd[i]);
 	xfree(sockfd);
+	xfree(shard_tids);
+	xfree(shard_args);
 	server_thread_decr();
 	pthread_exit((void *) 0);
 	return NULL;
 }
 
+/*
+ * _rpc_enqueue - hand an accepted connection to the RPC worker pool,
+ *	spawning a new detached worker if none is idle. The queue depth
+ *	is bounded by max_server_threads via _wait_for_server_thread().
+ * RET 0 on success, -1 if no worker could be spawned or found
+ */
+static int _rpc_enqueue(connection_arg_t *conn_arg)
+{
+	int rc = 0;
+
+	slurm_mutex_lock(&rpc_queue_mutex);
+	if ((rpc_workers_idle == 0) &&
+	    (rpc_workers_total < max_server_threads)) {
+		pthread_attr_t worker_attr;
+		pthread_t worker_id;
+
+		slurm_attr_init(&worker_attr);
+		if (pthread_attr_setdetachstate(&worker_attr,
+						PTHREAD_CREATE_DETACHED))
+			error("pthread_attr_setdetachstate %m");
+		if (pthread_create(&worker_id, &worker_attr,
+				   _rpc_worker, NULL)) {
+			error("pthread_create: %m");
+			if (rpc_workers_total == 0)
+				rc = -1;	/* nobody to service it */
+		} else
+			rpc_workers_total++;
+		slurm_attr_destroy(&worker_attr);
+	}
+	if (rc == 0) {
+		list_enqueue(rpc_conn_queue, conn_arg);
+		slurm_cond_signal(&rpc_queue_cond);
+	}
+	slurm_mutex_unlock(&rpc_queue_mutex);
+	return rc;
+}
+
+/* _rpc_worker - persistent RPC service thread, exits after
+ *	RPC_WORKER_IDLE_TIME seconds without work */
+static void *_rpc_worker(void *no_data)
+{
+	connection_arg_t *conn_arg;
+	struct timespec ts = {0, 0};
+
+	while (1) {
+		slurm_mutex_lock(&rpc_queue_mutex);
+		while (!(conn_arg = list_dequeue(rpc_conn_queue))) {
+			int rc;
+
+			if (rpc_pool_shutdown)
+				break;
+			rpc_workers_idle++;
+			ts.tv_sec = time(NULL) + RPC_WORKER_IDLE_TIME;
+			rc = pthread_cond_timedwait(&rpc_queue_cond,
+						    &rpc_queue_mutex, &ts);
+			rpc_workers_idle--;
+			if ((rc == ETIMEDOUT) &&
+			    !(conn_arg = list_dequeue(rpc_conn_queue)))
+				break;
+			if (conn_arg)
+				break;
+		}
+		if (!conn_arg) {	/* idle timeout or shutdown */
+			rpc_workers_total--;
+			slurm_mutex_unlock(&rpc_queue_mutex);
+			break;
+		}
+		slurm_mutex_unlock(&rpc_queue_mutex);
+		_service_connection(conn_arg);
+	}
+	return NULL;
+}
+
 /*
  * _service_connection - service the RPC
  * IN/OUT arg - really just the connection's file descriptor, freed
@@ -1091,6 +1259,7 @@ static void *_service_connection(void *arg)
 		error("%s: cannot set my name to %s %m", __func__, "srvcn");
 	}
 #endif
+	ctld_numa_bind_rpc_thread();
 	while (1) {
 		slurm_msg_t *msg;
 		if (slurmctld_config.shutdown_time) {
@@ -1649,6 +1818,7 @@ static void *_slurmctld_background(void *no_data)
 	static time_t last_ctld_bu_ping;
 	static time_t last_uid_update;
 	static time_t last_reboot_msg_time;
+	static time_t last_xmalloc_report;
 	time_t now;
 	int no_resp_msg_interval, ping_interval, purge_job_interval;
 	int group_time, group_force;
@@ -1868,6 +2038,10 @@ static void *_slurmctld_background(void *no_data)
 				group_force = 0;
 			now = time(NULL);
 			last_group_time = now;
+			/* Renew expired group membership cache records
+			 * before locking so the rebuild below does not
+			 * block RPCs on NSS lookups */
+			precache_group_members();
 			lock_slurmctld(part_write_lock);
 			load_part_uid_allow_list(group_force);
 			unlock_slurmctld(part_write_lock);
@@ -1884,6 +2058,7 @@ static void *_slurmctld_background(void *no_data)
 
 		job_limit = NO_VAL;
 		if (difftime(now, last_full_sched_time) >= sched_interval) {
+			sched_part_dirty(NULL);	/* periodic full queue pass */
 			slurm_mutex_lock(&sched_cnt_mutex);
 			/* job_limit = job_sched_cnt;	Ignored */
 			job_limit = INFINITE;
@@ -1906,7 +2081,9 @@ static void *_slurmctld_background(void *no_data)
 			lock_slurmctld(job_write_lock2);
 			bb_g_load_state(false);	/* May alter job nice/prio */
 			unlock_slurmctld(job_write_lock2);
-			if (schedule(job_limit))
+			/* The full/event scope was recorded by the pending
+			 * scheduling requests */
+			if (schedule_pending(job_limit))
 				last_checkpoint_time = 0; /* force state save */
 			set_job_elig_time();
 		}
@@ -1935,6 +2112,16 @@ static void *_slurmctld_background(void *no_data)
 			save_all_state();
 		}
 
+		/* When xmalloc call site accounting is enabled
+		 * periodically log the top memory holders so RSS growth
+		 * can be attributed to a subsystem. */
+		if (xmalloc_profile_enabled() &&
+		    (difftime(now, last_xmalloc_report) >= 1800)) {
+			now = time(NULL);
+			last_xmalloc_report = now;
+			xmalloc_profile_report(0);
+		}
+
 		if (difftime(now, last_node_acct) >= PERIODIC_NODE_ACCT) {
 			/* Report current node state to account for added
 			 * or reconfigured nodes.  Locks are done
@@ -2531,6 +2718,11 @@ void update_logging(void)
 
 	log_set_timefmt(slurmctld_conf.log_fmt);
 
+	/* When running as a daemon with a log file, drain log messages from
+	 * a dedicated writer thread so RPC handling and the schedulers do
+	 * not block on log file I/O at high debug levels */
+	log_set_async(daemonize && (slurmctld_conf.slurmctld_logfile != NULL));
+
 	/*
 	 * SchedLogLevel restore
 	 */
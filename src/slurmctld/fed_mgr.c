@@ -174,6 +174,20 @@ fini:
 	return SLURM_SUCCESS;
 }
 
+/* Worker for _ping_thread(): maintain and ping one sibling connection,
+ * so an unresponsive WAN peer only costs its own worker's time */
+static void *_ping_sibling_thread(void *arg)
+{
+	slurmdb_cluster_rec_t *conn = arg;
+
+	if (conn->sockfd == -1)
+		_open_controller_conn(conn);
+	if (conn->sockfd != -1)
+		_ping_controller(conn);
+
+	return NULL;
+}
+
 static void *_ping_thread(void *arg)
 {
 	slurmctld_lock_t fed_read_lock = {
@@ -187,23 +201,37 @@ static void *_ping_thread(void *arg)
 	while (!slurmctld_config.shutdown_time) {
 		ListIterator itr;
 		slurmdb_cluster_rec_t *conn;
+		pthread_attr_t attr;
+		pthread_t *ping_tids;
+		int ping_cnt = 0, i;
 
 		lock_slurmctld(fed_read_lock);
 		if (!fed_mgr_siblings)
 			goto next;
 
+		/* Ping each sibling from its own worker, so the cycle
+		 * (and the federation read lock) is held for the slowest
+		 * single peer rather than the sum of all of them */
+		ping_tids = xmalloc(sizeof(pthread_t) *
+				    list_count(fed_mgr_siblings));
+		slurm_attr_init(&attr);
 		itr = list_iterator_create(fed_mgr_siblings);
-
 		while ((conn = list_next(itr))) {
 			if (!xstrcasecmp(conn->name, fed_mgr_cluster_name))
 				continue;
-			if (conn->sockfd == -1)
-				_open_controller_conn(conn);
-			if (conn->sockfd == -1)
-				continue;
-			_ping_controller(conn);
+			if (pthread_create(&ping_tids[ping_cnt], &attr,
+					   _ping_sibling_thread, conn)) {
+				error("%s: pthread_create: %m", __func__);
+				_ping_sibling_thread(conn);
+			} else
+				ping_cnt++;
 		}
 		list_iterator_destroy(itr);
+		slurm_attr_destroy(&attr);
+
+		for (i = 0; i < ping_cnt; i++)
+			pthread_join(ping_tids[i], NULL);
+		xfree(ping_tids);
 
 next:
 		unlock_slurmctld(fed_read_lock);
@@ -104,6 +104,15 @@ struct gs_part {
 	bitstr_t *active_resmap;
 	uint16_t *active_cpus;
 	uint16_t array_size;
+	/* Snapshot of the active row with only the shadow jobs applied.
+	 * The shadow set only changes when a job is added, removed,
+	 * suspended or resumed, so the row rebuild on every timeslice
+	 * tick restores this snapshot rather than re-accumulating each
+	 * shadow job's resource map. */
+	bitstr_t *shadow_resmap;
+	uint16_t *shadow_cpus;
+	uint32_t shadow_jobs_active;
+	bool shadow_dirty;
 	struct gs_part *next;
 };
 
@@ -326,6 +335,8 @@ static void _destroy_parts(void *x)
 	xfree(gs_part_ptr->shadow);
 	FREE_NULL_BITMAP(gs_part_ptr->active_resmap);
 	xfree(gs_part_ptr->active_cpus);
+	FREE_NULL_BITMAP(gs_part_ptr->shadow_resmap);
+	xfree(gs_part_ptr->shadow_cpus);
 	xfree(gs_part_ptr->job_list);
 	xfree(gs_part_ptr);
 }
@@ -568,6 +579,60 @@ static void _add_job_to_active(struct job_record *job_ptr,
 	p_ptr->jobs_active += 1;
 }
 
+/* Apply all shadow jobs to an empty active row. When the shadow set is
+ * unchanged since the last row build, restore the cached post-shadow
+ * snapshot instead of re-adding every shadow job's resource map. */
+static void _apply_shadow_jobs(struct gs_part *p_ptr)
+{
+	uint32_t sz;
+	int i;
+
+	if (!p_ptr->shadow_dirty && (p_ptr->num_shadows == 0))
+		return;
+
+	if (!p_ptr->shadow_dirty && p_ptr->shadow_resmap) {
+		/* Restore the cached snapshot */
+		if (p_ptr->active_resmap &&
+		    (bit_size(p_ptr->active_resmap) ==
+		     bit_size(p_ptr->shadow_resmap))) {
+			bit_copybits(p_ptr->active_resmap,
+				     p_ptr->shadow_resmap);
+		} else {
+			FREE_NULL_BITMAP(p_ptr->active_resmap);
+			p_ptr->active_resmap = bit_copy(p_ptr->shadow_resmap);
+		}
+		if (p_ptr->shadow_cpus) {
+			sz = bit_size(p_ptr->shadow_resmap);
+			if (!p_ptr->active_cpus) {
+				p_ptr->active_cpus = xmalloc(sz *
+							     sizeof(uint16_t));
+			}
+			memcpy(p_ptr->active_cpus, p_ptr->shadow_cpus,
+			       sz * sizeof(uint16_t));
+		}
+		p_ptr->jobs_active = p_ptr->shadow_jobs_active;
+		return;
+	}
+
+	for (i = 0; i < p_ptr->num_shadows; i++)
+		_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
+
+	/* Cache the post-shadow row for the next rebuild */
+	FREE_NULL_BITMAP(p_ptr->shadow_resmap);
+	xfree(p_ptr->shadow_cpus);
+	if (p_ptr->num_shadows && p_ptr->active_resmap) {
+		p_ptr->shadow_resmap = bit_copy(p_ptr->active_resmap);
+		if (p_ptr->active_cpus) {
+			sz = bit_size(p_ptr->active_resmap);
+			p_ptr->shadow_cpus = xmalloc(sz * sizeof(uint16_t));
+			memcpy(p_ptr->shadow_cpus, p_ptr->active_cpus,
+			       sz * sizeof(uint16_t));
+		}
+	}
+	p_ptr->shadow_jobs_active = p_ptr->jobs_active;
+	p_ptr->shadow_dirty = false;
+}
+
 static int _suspend_job(uint32_t job_id)
 {
 	int rc;
@@ -759,6 +824,7 @@ static void _cast_shadow(struct gs_job *j_ptr, uint16_t priority)
 						sizeof(struct gs_job *));
 		}
 		p_ptr->shadow[p_ptr->num_shadows++] = j_ptr;
+		p_ptr->shadow_dirty = true;
 	}
 	list_iterator_destroy(part_iterator);
 }
@@ -790,6 +856,7 @@ static void _clear_shadow(struct gs_job *j_ptr)
 		for (; i < p_ptr->num_shadows; i++)
 			p_ptr->shadow[i] = p_ptr->shadow[i+1];
 		p_ptr->shadow[p_ptr->num_shadows] = NULL;
+		p_ptr->shadow_dirty = true;
 	}
 	 list_iterator_destroy(part_iterator);
 }
@@ -812,9 +879,7 @@ static void _update_active_row(struct gs_part *p_ptr, int add_new_jobs)
 	}
 	/* rebuild the active row, starting with any shadows */
 	p_ptr->jobs_active = 0;
-	for (i = 0; p_ptr->shadow && p_ptr->shadow[i]; i++) {
-		_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
-	}
+	_apply_shadow_jobs(p_ptr);
 
 	/* attempt to add the existing 'active' jobs */
 	for (i = 0; i < p_ptr->num_jobs; i++) {
@@ -1502,9 +1567,7 @@ static void _build_active_row(struct gs_part *p_ptr)
 		return;
 
 	/* apply all shadow jobs first */
-	for (i = 0; i < p_ptr->num_shadows; i++) {
-		_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
-	}
+	_apply_shadow_jobs(p_ptr);
 
 	/* attempt to add jobs from the job_list in the current order */
 	for (i = 0; i < p_ptr->num_jobs; i++) {
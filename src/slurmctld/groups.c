@@ -43,34 +43,52 @@
 #define _GNU_SOURCE
 #define   __USE_GNU
 
+#include <fcntl.h>
 #include <grp.h>
 #include <pthread.h>
 #include <pwd.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
 
 #include "src/common/list.h"
 #include "src/common/log.h"
+#include "src/common/pack.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
+#include "src/slurmctld/groups.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
 
 #include "slurm/slurm_errno.h"
 
 #define _DEBUG 0
 
+/* Version string in the group cache state file, see state file plugging */
+#define GROUP_STATE_VERSION	"PROTOCOL_VERSION"
+
+/* Default cache entry lifetime when GroupUpdateTime is not configured */
+#define GROUP_CACHE_DEF_TTL	600
+
 static void   _cache_del_func(void *x);
+static int    _find_group_rec(void *x, void *key);
 static uid_t *_get_group_cache(char *group_name);
+static time_t _group_cache_ttl(void);
+static void   _load_group_cache_state(void);
 static void   _log_group_members(char *group_name, uid_t *group_uids);
 static void   _put_group_cache(char *group_name, void *group_uids, int uid_cnt);
 
 static List group_cache_list = NULL;
 static pthread_mutex_t group_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool group_state_loaded = false;
 struct group_cache_rec {
 	char *group_name;
 	int uid_cnt;
 	uid_t *group_uids;
+	time_t expire_time;
 };
 
 /*
@@ -242,16 +260,35 @@ extern void clear_group_cache(void)
 	slurm_mutex_unlock(&group_cache_mutex);
 }
 
+/* Entry lifetime for the group/uid cache, tracks GroupUpdateTime so the
+ * periodic refresh in the slurmctld background thread renews entries just
+ * as they go stale */
+static time_t _group_cache_ttl(void)
+{
+	time_t ttl = slurmctld_conf.group_info & GROUP_TIME_MASK;
+
+	if (ttl == 0)
+		ttl = GROUP_CACHE_DEF_TTL;
+	return ttl;
+}
+
 /* Get a record from our group/uid cache.
- * Return NULL if not found. */
+ * Return NULL if not found or expired. */
 static uid_t *_get_group_cache(char *group_name)
 {
 	ListIterator iter;
 	struct group_cache_rec *cache_rec;
 	uid_t *group_uids = NULL;
+	time_t now = time(NULL);
 	int sz;
 
 	slurm_mutex_lock(&group_cache_mutex);
+	if (!group_state_loaded) {
+		/* Warm start from the previously saved cache to avoid a
+		 * flood of NSS (e.g. LDAP) lookups at slurmctld startup */
+		group_state_loaded = true;
+		_load_group_cache_state();
+	}
 	if (!group_cache_list) {
 		slurm_mutex_unlock(&group_cache_mutex);
 		return NULL;
@@ -261,6 +298,8 @@ static uid_t *_get_group_cache(char *group_name)
 	while ((cache_rec = (struct group_cache_rec *) list_next(iter))) {
 		if (xstrcmp(group_name, cache_rec->group_name))
 			continue;
+		if (cache_rec->expire_time <= now)
+			break;	/* stale, caller re-resolves through NSS */
 		sz = sizeof(uid_t) * (cache_rec->uid_cnt + 1);
 		group_uids = (uid_t *) xmalloc(sz);
 		memcpy(group_uids, cache_rec->group_uids, sz);
@@ -282,7 +321,17 @@ static void _cache_del_func(void *x)
 	xfree(cache_rec);
 }
 
-/* Put a record on our group/uid cache */
+/* Find a record in the group/uid cache by group name, used by list
+ * functions */
+static int _find_group_rec(void *x, void *key)
+{
+	struct group_cache_rec *cache_rec = (struct group_cache_rec *) x;
+
+	return !xstrcmp(cache_rec->group_name, (char *) key);
+}
+
+/* Put a record on our group/uid cache, replacing any stale record for the
+ * same group */
 static void _put_group_cache(char *group_name, void *group_uids, int uid_cnt)
 {
 	struct group_cache_rec *cache_rec;
@@ -292,18 +341,218 @@ static void _put_group_cache(char *group_name, void *group_uids, int uid_cnt)
 	if (!group_cache_list) {
 		group_cache_list = list_create(_cache_del_func);
 	}
+	(void) list_delete_all(group_cache_list, _find_group_rec, group_name);
 
 	sz = sizeof(uid_t) * (uid_cnt);
 	cache_rec = xmalloc(sizeof(struct group_cache_rec));
-	cache_rec->group_name = xstrdup(group_name);
-	cache_rec->uid_cnt    = uid_cnt;
-	cache_rec->group_uids = (uid_t *) xmalloc(sizeof(uid_t) + sz);
+	cache_rec->group_name  = xstrdup(group_name);
+	cache_rec->uid_cnt     = uid_cnt;
+	cache_rec->group_uids  = (uid_t *) xmalloc(sizeof(uid_t) + sz);
+	cache_rec->expire_time = time(NULL) + _group_cache_ttl();
 	if (uid_cnt > 0)
 		memcpy(cache_rec->group_uids, group_uids, sz);
 	list_append(group_cache_list, cache_rec);
 	slurm_mutex_unlock(&group_cache_mutex);
 }
 
+/*
+ * dump_group_cache_state - save the group/uid cache to disk so that a
+ *	restarted slurmctld can rebuild the partition allow_uids lists
+ *	without issuing blocking NSS (e.g. LDAP) lookups
+ */
+extern void dump_group_cache_state(void)
+{
+	ListIterator iter;
+	struct group_cache_rec *cache_rec;
+	int error_code = 0, log_fd;
+	char *old_file, *new_file, *reg_file;
+	Buf buffer = init_buf(BUF_SIZE);
+	DEF_TIMERS;
+
+	START_TIMER;
+	/* write header: version and time */
+	packstr(GROUP_STATE_VERSION, buffer);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(time(NULL), buffer);
+
+	/* write group cache records to buffer */
+	slurm_mutex_lock(&group_cache_mutex);
+	if (group_cache_list) {
+		pack32(list_count(group_cache_list), buffer);
+		iter = list_iterator_create(group_cache_list);
+		while ((cache_rec = (struct group_cache_rec *)
+				    list_next(iter))) {
+			packstr(cache_rec->group_name, buffer);
+			pack_time(cache_rec->expire_time, buffer);
+			pack32_array((uint32_t *) cache_rec->group_uids,
+				     cache_rec->uid_cnt, buffer);
+		}
+		list_iterator_destroy(iter);
+	} else
+		pack32(0, buffer);
+	slurm_mutex_unlock(&group_cache_mutex);
+
+	old_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(old_file, "/group_cache_state.old");
+	reg_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(reg_file, "/group_cache_state");
+	new_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(new_file, "/group_cache_state.new");
+
+	/* write the buffer to file */
+	lock_state_files();
+	log_fd = creat(new_file, 0600);
+	if (log_fd < 0) {
+		error("Can't save state, error creating file %s, %m",
+		      new_file);
+		error_code = errno;
+	} else {
+		int pos = 0, nwrite = get_buf_offset(buffer), amount, rc;
+		char *data = (char *)get_buf_data(buffer);
+
+		while (nwrite > 0) {
+			amount = write(log_fd, &data[pos], nwrite);
+			if ((amount < 0) && (errno != EINTR)) {
+				error("Error writing file %s, %m", new_file);
+				error_code = errno;
+				break;
+			}
+			nwrite -= amount;
+			pos    += amount;
+		}
+		rc = fsync_and_close(log_fd, "group_cache");
+		if (rc && !error_code)
+			error_code = rc;
+	}
+	if (error_code)
+		(void) unlink(new_file);
+	else {			/* file shuffle */
+		(void) unlink(old_file);
+		if (link(reg_file, old_file))
+			debug4("unable to create link for %s -> %s: %m",
+			       reg_file, old_file);
+		(void) unlink(reg_file);
+		if (link(new_file, reg_file))
+			debug4("unable to create link for %s -> %s: %m",
+			       new_file, reg_file);
+		(void) unlink(new_file);
+	}
+	xfree(old_file);
+	xfree(reg_file);
+	xfree(new_file);
+	unlock_state_files();
+
+	free_buf(buffer);
+	END_TIMER2("dump_group_cache_state");
+}
+
+/* Recover the group/uid cache saved by a previous slurmctld, dropping any
+ * record whose lifetime has already expired.
+ * NOTE: Run once at startup with group_cache_mutex locked */
+static void _load_group_cache_state(void)
+{
+	struct group_cache_rec *cache_rec;
+	char *data = NULL, *state_file, *ver_str = NULL;
+	char *group_name = NULL;
+	uid_t *group_uids = NULL;
+	int data_allocated, data_read = 0, data_size = 0, state_fd;
+	uint32_t name_len, rec_cnt = 0, uid_cnt = 0, i;
+	uint16_t protocol_version = (uint16_t) NO_VAL;
+	time_t expire_time, now = time(NULL);
+	Buf buffer;
+
+	/* read the file */
+	state_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(state_file, "/group_cache_state");
+	lock_state_files();
+	state_fd = open(state_file, O_RDONLY);
+	if (state_fd < 0) {
+		debug2("No group cache state file (%s) to recover",
+		       state_file);
+		xfree(state_file);
+		unlock_state_files();
+		return;
+	}
+	data_allocated = BUF_SIZE;
+	data = xmalloc(data_allocated);
+	while (1) {
+		data_read = read(state_fd, &data[data_size], BUF_SIZE);
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			else {
+				error("Read error on %s: %m", state_file);
+				break;
+			}
+		} else if (data_read == 0)	/* eof */
+			break;
+		data_size      += data_read;
+		data_allocated += data_read;
+		xrealloc(data, data_allocated);
+	}
+	close(state_fd);
+	xfree(state_file);
+	unlock_state_files();
+
+	buffer = create_buf(data, data_size);
+
+	safe_unpackstr_xmalloc(&ver_str, &name_len, buffer);
+	debug3("Version string in group_cache_state header is %s", ver_str);
+	if (ver_str && !xstrcmp(ver_str, GROUP_STATE_VERSION))
+		safe_unpack16(&protocol_version, buffer);
+
+	if (protocol_version == (uint16_t) NO_VAL) {
+		error("************************************************");
+		error("Can not recover group cache state, incompatible");
+		error("************************************************");
+		xfree(ver_str);
+		free_buf(buffer);
+		return;
+	}
+	xfree(ver_str);
+	safe_unpack_time(&expire_time, buffer);		/* save time */
+	safe_unpack32(&rec_cnt, buffer);
+
+	for (i = 0; i < rec_cnt; i++) {
+		safe_unpackstr_xmalloc(&group_name, &name_len, buffer);
+		safe_unpack_time(&expire_time, buffer);
+		safe_unpack32_array((uint32_t **) &group_uids, &uid_cnt,
+				    buffer);
+		if (!group_name || (expire_time <= now)) {
+			/* expired entry, let it be rebuilt through NSS */
+			xfree(group_name);
+			xfree(group_uids);
+			continue;
+		}
+		if (!group_cache_list)
+			group_cache_list = list_create(_cache_del_func);
+		/* zero terminator expected by _get_group_cache() */
+		xrealloc(group_uids, sizeof(uid_t) * (uid_cnt + 1));
+		group_uids[uid_cnt] = 0;
+		cache_rec = xmalloc(sizeof(struct group_cache_rec));
+		cache_rec->group_name  = group_name;
+		cache_rec->uid_cnt     = uid_cnt;
+		cache_rec->group_uids  = group_uids;
+		cache_rec->expire_time = expire_time;
+		list_append(group_cache_list, cache_rec);
+		group_name = NULL;
+		group_uids = NULL;
+	}
+	free_buf(buffer);
+	if (group_cache_list) {
+		debug("Recovered group membership cache for %d groups",
+		      list_count(group_cache_list));
+	}
+	return;
+
+unpack_error:
+	error("Incomplete group cache state file");
+	xfree(group_name);
+	xfree(group_uids);
+	xfree(ver_str);
+	free_buf(buffer);
+}
+
 static void _log_group_members(char *group_name, uid_t *group_uids)
 {
 #if _DEBUG
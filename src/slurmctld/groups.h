@@ -46,6 +46,9 @@
 /* Delete our group/uid cache */
 extern void clear_group_cache(void);
 
+/* Save our group/uid cache to disk for recovery at slurmctld restart */
+extern void dump_group_cache_state(void);
+
 /*
  * get_group_members - identify the users in a given group name
  * IN group_name - a single group name
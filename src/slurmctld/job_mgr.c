@@ -91,6 +91,7 @@
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/node_scheduler.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/reservation.h"
@@ -111,12 +112,36 @@
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
 #define JOB_ARRAY_HASH_INX(_job_id, _task_id) \
 	((_job_id + _task_id) % hash_table_size)
+#define JOB_USER_HASH_INX(_user_id)	(_user_id % hash_table_size)
+
+/* Values for job_record.array_hash_flags */
+#define JOB_ARRAY_HASH_J	0x01	/* linked into job_array_hash_j */
+#define JOB_ARRAY_HASH_T	0x02	/* linked into job_array_hash_t */
 
 /* No need to change we always pack SLURM_PROTOCOL_VERSION */
 #define JOB_STATE_VERSION       "PROTOCOL_VERSION"
 
 #define JOB_CKPT_VERSION      "PROTOCOL_VERSION"
 
+/*
+ * Delta journal for incremental job state saves. Steady-state save cycles
+ * append only the jobs which changed since the previous cycle (plus purge
+ * records for deleted jobs) to "job_state.jrnl". The full "job_state" file
+ * is rewritten and the journal truncated every JOB_JRNL_COMPACT_CYCLES
+ * cycles, after any journal write error, and at shutdown time.
+ */
+#define JOB_JRNL_COMPACT_CYCLES	30
+#define JOB_JRNL_ENTRY_JOB	0x6a01	/* job record follows */
+#define JOB_JRNL_ENTRY_PURGE	0x6a02	/* purged job id follows */
+#define JOB_JRNL_ENTRY_SEQ	0x6a03	/* job_id_sequence follows */
+
+/* Worker threads used by load_all_job_state() to unpack job records in
+ * parallel. The job records in the state file are length prefixed, so
+ * their boundaries can be found without parsing them. The unpack work
+ * runs concurrently while updates to the job list, hash tables and
+ * accounting are serialized by job_load_mutex. */
+#define JOB_LOAD_THREADS 4
+
 typedef struct {
 	int resp_array_cnt;
 	int resp_array_size;
@@ -138,14 +163,48 @@ static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
 static struct   job_record **job_array_hash_j = NULL;
 static struct   job_record **job_array_hash_t = NULL;
+static struct   job_record **job_user_hash = NULL;
+static pthread_mutex_t job_load_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int      jrnl_delta_cycles = 0;	/* delta cycles since full dump */
+static bool     jrnl_full_needed = true;/* force full job state dump */
+static List     jrnl_purged_ids = NULL;	/* job ids purged since last save */
 static bool     kill_invalid_dep;
 static time_t   last_file_write_time = (time_t) 0;
 static uint32_t max_array_size = NO_VAL;
 static bool	purge_quit = false;
 static struct timeval purge_start_time = {0, 0};
+static List	purge_cand_list = NULL;	/* purge_cand_t: finished jobs
+					 * pending record purge, roughly
+					 * ordered by completion time */
+static List	purge_free_list = NULL;	/* job records handed off to the
+					 * reclamation thread for freeing
+					 * outside the job write lock */
+static pthread_mutex_t purge_free_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  purge_free_cond  = PTHREAD_COND_INITIALIZER;
+static bool	purge_free_thread = false; /* reclamation thread started */
+static bool	purge_defer_free = false;  /* _list_delete_job() defers the
+					    * memory release to the
+					    * reclamation thread */
 static bitstr_t *requeue_exit = NULL;
 static bitstr_t *requeue_exit_hold = NULL;
 static int	select_serial = -1;
+
+/* Job and step records turn over constantly on high-throughput
+ * clusters. Recycle the fixed-size record shells through type-specific
+ * pools rather than returning them to the heap, so new records skip
+ * the allocator and the controller heap does not slowly fragment.
+ * Shells are zeroed when pooled; their contents were already released
+ * by the caller. Pool occupancy and hit rates are reported by sdiag. */
+#define REC_POOL_SLOTS 128
+typedef struct {
+	void    *slots[REC_POOL_SLOTS];
+	int      cnt;		/* shells currently pooled */
+	size_t   obj_size;
+	uint64_t allocs;	/* shells handed out, in total */
+	uint64_t reuses;	/* shells handed out from the pool */
+} rec_pool_t;
+static rec_pool_t rec_pool[REC_POOL_COUNT];
+static pthread_mutex_t rec_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool     wiki_sched = false;
 static bool     wiki2_sched = false;
 static bool     wiki_sched_test = false;
@@ -155,7 +214,6 @@ static void _add_job_hash(struct job_record *job_ptr);
 static void _add_job_array_hash(struct job_record *job_ptr);
 static int  _checkpoint_job_record (struct job_record *job_ptr,
 				    char *image_dir);
-static int  _copy_job_desc_files(uint32_t job_id_src, uint32_t job_id_dest);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
 				   uint32_t job_id);
 static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
@@ -173,6 +231,7 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	char *resv_name, slurmdb_assoc_rec_t *assoc_ptr,
 	bool admin, slurmdb_qos_rec_t *qos_rec,	int *error_code, bool locked);
 static void _dump_job_details(struct job_details *detail_ptr, Buf buffer);
+static int  _dump_job_delta(void);
 static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer);
 static void _get_batch_job_dir_ids(List batch_dirs);
 static time_t _get_last_state_write_time(void);
@@ -181,6 +240,10 @@ static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid,
 			char **err_msg, uint16_t protocol_version);
 static void _job_purge_start(void);
+static void _job_record_free(struct job_record *job_ptr);
+static void *_job_reclaim_thread(void *no_data);
+static void _purge_cand_enqueue(struct job_record *job_ptr);
+static uint64_t _job_state_hash(Buf buffer);
 static void _job_timed_out(struct job_record *job_ptr);
 static void _kill_dependent(struct job_record *job_ptr);
 static void _list_delete_job(void *job_entry);
@@ -188,6 +251,7 @@ static int  _list_find_job_id(void *job_entry, void *key);
 static int  _list_find_job_old(void *job_entry, void *key);
 static int  _load_job_details(struct job_record *job_ptr, Buf buffer,
 			      uint16_t protocol_version);
+static int  _load_job_journal(void);
 static int  _load_job_state(Buf buffer,	uint16_t protocol_version);
 static bitstr_t *_make_requeue_array(char *conf_buf);
 static uint32_t _max_switch_wait(uint32_t input_wait);
@@ -433,6 +497,88 @@ static job_array_resp_msg_t *_resp_array_xlate(resp_array_struct_t *resp,
 	return msg;
 }
 
+/* Get an empty (zero filled) record shell from the specified pool,
+ * falling back upon the allocator when the pool is dry */
+extern void *rec_pool_get(int pool_id)
+{
+	rec_pool_t *pool = &rec_pool[pool_id];
+	void *rec = NULL;
+
+	xassert((pool_id >= 0) && (pool_id < REC_POOL_COUNT));
+
+	slurm_mutex_lock(&rec_pool_mutex);
+	if (pool->obj_size == 0) {	/* one time setup */
+		if (pool_id == REC_POOL_JOB)
+			pool->obj_size = sizeof(struct job_record);
+		else if (pool_id == REC_POOL_DETAILS)
+			pool->obj_size = sizeof(struct job_details);
+		else
+			pool->obj_size = sizeof(struct step_record);
+	}
+	pool->allocs++;
+	if (pool->cnt) {
+		rec = pool->slots[--pool->cnt];
+		pool->reuses++;
+	}
+	slurm_mutex_unlock(&rec_pool_mutex);
+	if (!rec)
+		rec = xmalloc(pool->obj_size);
+	return rec;
+}
+
+/* Recycle or free an emptied record shell. All of its contents must
+ * already have been released. */
+extern void rec_pool_put(int pool_id, void *rec)
+{
+	rec_pool_t *pool = &rec_pool[pool_id];
+	bool pooled = false;
+
+	xassert((pool_id >= 0) && (pool_id < REC_POOL_COUNT));
+
+	if (pool->obj_size == 0) {	/* never allocated from pool */
+		xfree(rec);
+		return;
+	}
+	memset(rec, 0, pool->obj_size);
+	slurm_mutex_lock(&rec_pool_mutex);
+	if (pool->cnt < REC_POOL_SLOTS) {
+		pool->slots[pool->cnt++] = rec;
+		pooled = true;
+	}
+	slurm_mutex_unlock(&rec_pool_mutex);
+	if (!pooled)
+		xfree(rec);
+}
+
+/* Report record pool occupancy and hit counts for sdiag.
+ * Each array must have room for REC_POOL_COUNT entries. */
+extern void rec_pool_get_stats(uint32_t *occupancy, uint64_t *allocs,
+			       uint64_t *reuses)
+{
+	int i;
+
+	slurm_mutex_lock(&rec_pool_mutex);
+	for (i = 0; i < REC_POOL_COUNT; i++) {
+		occupancy[i] = rec_pool[i].cnt;
+		allocs[i]    = rec_pool[i].allocs;
+		reuses[i]    = rec_pool[i].reuses;
+	}
+	slurm_mutex_unlock(&rec_pool_mutex);
+}
+
+/* Clear the record pool counters (sdiag reset) */
+extern void rec_pool_reset_stats(void)
+{
+	int i;
+
+	slurm_mutex_lock(&rec_pool_mutex);
+	for (i = 0; i < REC_POOL_COUNT; i++) {
+		rec_pool[i].allocs = 0;
+		rec_pool[i].reuses = 0;
+	}
+	slurm_mutex_unlock(&rec_pool_mutex);
+}
+
 /*
  * _create_job_record - create an empty job_record including job_details.
  *	load its values with defaults (zeros, nulls, and magic cookie)
@@ -458,8 +604,8 @@ static struct job_record *_create_job_record(int *error_code, uint32_t num_jobs)
 	*error_code = 0;
 	last_job_update = time(NULL);
 
-	job_ptr    = (struct job_record *) xmalloc(sizeof(struct job_record));
-	detail_ptr = (struct job_details *)xmalloc(sizeof(struct job_details));
+	job_ptr    = rec_pool_get(REC_POOL_JOB);
+	detail_ptr = rec_pool_get(REC_POOL_DETAILS);
 
 	job_ptr->magic = JOB_MAGIC;
 	job_ptr->array_task_id = NO_VAL;
@@ -521,7 +667,8 @@ void delete_job_details(struct job_record *job_entry)
 	xfree(job_entry->details->req_nodes);
 	xfree(job_entry->details->restart_dir);
 	xfree(job_entry->details->work_dir);
-	xfree(job_entry->details);	/* Must be last */
+	rec_pool_put(REC_POOL_DETAILS, job_entry->details); /* Must be last */
+	job_entry->details = NULL;
 }
 
 /* _delete_job_desc_files - delete job descriptor related files */
@@ -660,11 +807,26 @@ int dump_all_job_state(void)
 		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
-	Buf buffer = init_buf(high_buffer_size);
+	Buf buffer, job_scratch;
 	time_t now = time(NULL);
 	time_t last_state_file_time;
 	DEF_TIMERS;
 
+	if (!jrnl_purged_ids)
+		jrnl_purged_ids = list_create(slurm_destroy_uint32_ptr);
+
+	/* Steady-state cycles append changed jobs to the delta journal.
+	 * Write the full file periodically, after any journal problem and
+	 * at shutdown (so the journal is empty across a clean restart). */
+	if (!jrnl_full_needed &&
+	    (jrnl_delta_cycles < JOB_JRNL_COMPACT_CYCLES) &&
+	    (slurmctld_config.shutdown_time == 0))
+		return _dump_job_delta();
+
+	prof_region_begin("dump_job_state");
+	buffer = init_buf(high_buffer_size);
+	job_scratch = init_buf(BUF_SIZE);
+
 	START_TIMER;
 	/* Check that last state file was written at expected time.
 	 * This is a check for two slurmctld daemons running at the same
@@ -699,11 +861,23 @@ int dump_all_job_state(void)
 	       job_id_sequence);
 
 	/* write individual job records */
+	prof_region_begin("dump_job_pack");
 	lock_slurmctld(job_read_lock);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
-		_dump_job_state(job_ptr, buffer);
+		/* Pack via a scratch buffer so the saved image can be
+		 * hashed. Only the state save logic uses save_hash, so
+		 * updating it under the job read lock is safe. */
+		set_buf_offset(job_scratch, 0);
+		_dump_job_state(job_ptr, job_scratch);
+		job_ptr->save_hash = _job_state_hash(job_scratch);
+		/* Length prefix so load_all_job_state() can locate the
+		 * record boundaries without parsing the records and
+		 * unpack them in parallel */
+		pack32(get_buf_offset(job_scratch), buffer);
+		packmem_array(get_buf_data(job_scratch),
+			      get_buf_offset(job_scratch), buffer);
 	}
 	list_iterator_destroy(job_iterator);
 
@@ -715,6 +889,7 @@ int dump_all_job_state(void)
 	new_file = xstrdup(slurmctld_conf.state_save_location);
 	xstrcat(new_file, "/job_state.new");
 	unlock_slurmctld(job_read_lock);
+	prof_region_end("dump_job_pack");
 
 	if (stat(reg_file, &stat_buf) == 0) {
 		static time_t last_mtime = (time_t) 0;
@@ -731,6 +906,7 @@ int dump_all_job_state(void)
 		last_mtime = time(NULL);
 	}
 
+	prof_region_begin("dump_job_write");
 	lock_state_files();
 	log_fd = creat(new_file, 0600);
 	if (log_fd < 0) {
@@ -760,9 +936,12 @@ int dump_all_job_state(void)
 		if (rc && !error_code)
 			error_code = rc;
 	}
-	if (error_code)
+	if (error_code) {
 		(void) unlink(new_file);
-	else {			/* file shuffle */
+		jrnl_full_needed = true;
+	} else {		/* file shuffle */
+		char *jrnl_file;
+
 		(void) unlink(old_file);
 		if (link(reg_file, old_file))
 			debug4("unable to create link for %s -> %s: %m",
@@ -773,14 +952,155 @@ int dump_all_job_state(void)
 			       new_file, reg_file);
 		(void) unlink(new_file);
 		last_file_write_time = now;
+
+		/* The full file now covers everything in the journal */
+		jrnl_file = xstrdup(slurmctld_conf.state_save_location);
+		xstrcat(jrnl_file, "/job_state.jrnl");
+		(void) unlink(jrnl_file);
+		xfree(jrnl_file);
+		list_flush(jrnl_purged_ids);
+		jrnl_delta_cycles = 0;
+		jrnl_full_needed = false;
 	}
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
 	unlock_state_files();
+	prof_region_end("dump_job_write");
 
+	stream_state_file("job_state", buffer);
 	free_buf(buffer);
+	free_buf(job_scratch);
 	END_TIMER2("dump_all_job_state");
+	prof_region_end("dump_job_state");
+	return error_code;
+}
+
+/* Hash a packed job state image (FNV-1a) to identify changed jobs */
+static uint64_t _job_state_hash(Buf buffer)
+{
+	unsigned char *data = (unsigned char *) get_buf_data(buffer);
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint32_t i, len = get_buf_offset(buffer);
+
+	for (i = 0; i < len; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/*
+ * _dump_job_delta - append records for jobs which changed since the last
+ *	save cycle (and purge records for deleted jobs) to the job state
+ *	delta journal. Replayed by _load_job_journal() on top of the full
+ *	job_state file at recovery time.
+ * RET 0 or error code
+ */
+static int _dump_job_delta(void)
+{
+	static uint32_t last_seq = NO_VAL;
+	int error_code = SLURM_SUCCESS, log_fd, dirty_cnt = 0;
+	bool new_journal = false;
+	char *jrnl_file;
+	uint32_t *purged_id;
+	/* Locks: Read config and job */
+	slurmctld_lock_t job_read_lock =
+		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	Buf buffer = init_buf(BUF_SIZE);
+	Buf job_scratch = init_buf(BUF_SIZE);
+	time_t now = time(NULL);
+	uint64_t hash;
+	DEF_TIMERS;
+
+	START_TIMER;
+	jrnl_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(jrnl_file, "/job_state.jrnl");
+	if (access(jrnl_file, F_OK) < 0)
+		new_journal = true;
+
+	lock_slurmctld(job_read_lock);
+	if (new_journal) {
+		/* write header: version, time */
+		packstr(JOB_STATE_VERSION, buffer);
+		pack16(SLURM_PROTOCOL_VERSION, buffer);
+		pack_time(now, buffer);
+		last_seq = NO_VAL;
+	}
+	if (job_id_sequence != last_seq) {
+		pack16(JOB_JRNL_ENTRY_SEQ, buffer);
+		pack32(job_id_sequence, buffer);
+	}
+	while ((purged_id = (uint32_t *) list_pop(jrnl_purged_ids))) {
+		pack16(JOB_JRNL_ENTRY_PURGE, buffer);
+		pack32(*purged_id, buffer);
+		xfree(purged_id);
+		dirty_cnt++;
+	}
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		xassert (job_ptr->magic == JOB_MAGIC);
+		set_buf_offset(job_scratch, 0);
+		_dump_job_state(job_ptr, job_scratch);
+		hash = _job_state_hash(job_scratch);
+		if (hash == job_ptr->save_hash)
+			continue;	/* unchanged since last cycle */
+		job_ptr->save_hash = hash;
+		pack16(JOB_JRNL_ENTRY_JOB, buffer);
+		packmem_array(get_buf_data(job_scratch),
+			      get_buf_offset(job_scratch), buffer);
+		dirty_cnt++;
+	}
+	list_iterator_destroy(job_iterator);
+	unlock_slurmctld(job_read_lock);
+
+	if ((dirty_cnt == 0) && (new_journal || (job_id_sequence == last_seq)))
+		goto fini;	/* nothing changed, no write required */
+
+	lock_state_files();
+	log_fd = open(jrnl_file, O_CREAT | O_WRONLY | O_APPEND, 0600);
+	if (log_fd < 0) {
+		error("Can't save state, open file %s error %m", jrnl_file);
+		error_code = errno;
+	} else {
+		int pos = 0, nwrite, amount, rc;
+		char *data;
+
+		fd_set_close_on_exec(log_fd);
+		nwrite = get_buf_offset(buffer);
+		data = (char *)get_buf_data(buffer);
+		while (nwrite > 0) {
+			amount = write(log_fd, &data[pos], nwrite);
+			if ((amount < 0) && (errno != EINTR)) {
+				error("Error writing file %s, %m", jrnl_file);
+				error_code = errno;
+				break;
+			}
+			nwrite -= amount;
+			pos    += amount;
+		}
+
+		rc = fsync_and_close(log_fd, "job journal");
+		if (rc && !error_code)
+			error_code = rc;
+	}
+	unlock_state_files();
+
+	if (error_code) {
+		/* Journal contents suspect, rewrite everything next cycle */
+		jrnl_full_needed = true;
+	} else
+		last_seq = job_id_sequence;
+
+fini:	if (!error_code)
+		jrnl_delta_cycles++;
+	xfree(jrnl_file);
+	free_buf(buffer);
+	free_buf(job_scratch);
+	END_TIMER2("_dump_job_delta");
+	debug3("_dump_job_delta: %d changed job records", dirty_cnt);
 	return error_code;
 }
 
@@ -882,13 +1202,130 @@ unpack_error:
  *	Changes here should be reflected in load_last_job_id().
  * RET 0 or error code
  */
+typedef struct job_load_arg {
+	char *data;		/* shared job state image */
+	uint32_t *rec_offset;	/* offset of each job record */
+	uint32_t *rec_len;	/* length of each job record */
+	int rec_cnt;		/* count of job records */
+	int thread_inx;		/* this worker's index */
+	int thread_cnt;		/* count of workers */
+	uint16_t protocol_version;
+	int rc;			/* SLURM_SUCCESS or error */
+	int job_cnt;		/* count of jobs this worker recovered */
+} job_load_arg_t;
+
+/* Worker for _load_all_job_state_framed(), unpacks every thread_cnt'th
+ * job record starting at this worker's index */
+static void *_load_job_worker(void *args)
+{
+	job_load_arg_t *arg = (job_load_arg_t *) args;
+	Buf buffer;
+	int i;
+
+	for (i = arg->thread_inx; i < arg->rec_cnt; i += arg->thread_cnt) {
+		buffer = create_buf(arg->data + arg->rec_offset[i],
+				    arg->rec_len[i]);
+		if (_load_job_state(buffer, arg->protocol_version) ==
+		    SLURM_SUCCESS)
+			arg->job_cnt++;
+		else
+			arg->rc = SLURM_ERROR;
+		/* Free the Buf structure, the data is shared */
+		(void) xfer_buf_data(buffer);
+	}
+	return NULL;
+}
+
+/* Unpack and insert all job records from a state file with length
+ * prefixed records (protocol 17.02 or later) using a pool of worker
+ * threads. The boundary scan only reads the length prefixes, so a
+ * truncated file is detected before any worker starts.
+ * Called with the assoc_mgr read locks held.
+ * OUT job_cnt_p - count of job records recovered
+ * RET 0 or an error code */
+static int _load_all_job_state_framed(Buf buffer, uint16_t protocol_version,
+				      int *job_cnt_p)
+{
+	int error_code = SLURM_SUCCESS;
+	int i, rec_cnt = 0, rec_size = 1024, thread_cnt;
+	uint32_t *rec_offset, *rec_len, len;
+	pthread_attr_t load_attr;
+	pthread_t *load_thread;
+	job_load_arg_t *load_arg;
+
+	rec_offset = xmalloc(sizeof(uint32_t) * rec_size);
+	rec_len    = xmalloc(sizeof(uint32_t) * rec_size);
+	while (remaining_buf(buffer) > 0) {
+		safe_unpack32(&len, buffer);
+		if ((len == 0) || (remaining_buf(buffer) < len))
+			goto unpack_error;
+		if (rec_cnt >= rec_size) {
+			rec_size *= 2;
+			xrealloc(rec_offset, sizeof(uint32_t) * rec_size);
+			xrealloc(rec_len,    sizeof(uint32_t) * rec_size);
+		}
+		rec_offset[rec_cnt] = get_buf_offset(buffer);
+		rec_len[rec_cnt]    = len;
+		rec_cnt++;
+		set_buf_offset(buffer, get_buf_offset(buffer) + len);
+	}
+
+	thread_cnt = MIN(JOB_LOAD_THREADS, rec_cnt);
+	load_arg    = xmalloc(sizeof(job_load_arg_t) * thread_cnt);
+	load_thread = xmalloc(sizeof(pthread_t) * thread_cnt);
+	for (i = 0; i < thread_cnt; i++) {
+		load_arg[i].data       = get_buf_data(buffer);
+		load_arg[i].rec_offset = rec_offset;
+		load_arg[i].rec_len    = rec_len;
+		load_arg[i].rec_cnt    = rec_cnt;
+		load_arg[i].thread_inx = i;
+		load_arg[i].thread_cnt = thread_cnt;
+		load_arg[i].protocol_version = protocol_version;
+		load_arg[i].rc         = SLURM_SUCCESS;
+		load_arg[i].job_cnt    = 0;
+		if (i == (thread_cnt - 1)) {
+			/* run the last partition in this thread */
+			(void) _load_job_worker(&load_arg[i]);
+			continue;
+		}
+		slurm_attr_init(&load_attr);
+		if (pthread_create(&load_thread[i], &load_attr,
+				   _load_job_worker, &load_arg[i])) {
+			/* run this partition in-line instead */
+			error("%s: pthread_create: %m", __func__);
+			(void) _load_job_worker(&load_arg[i]);
+			load_thread[i] = (pthread_t) 0;
+		}
+		slurm_attr_destroy(&load_attr);
+	}
+	for (i = 0; i < thread_cnt; i++) {
+		if ((i != (thread_cnt - 1)) && load_thread[i])
+			pthread_join(load_thread[i], NULL);
+		*job_cnt_p += load_arg[i].job_cnt;
+		if (load_arg[i].rc != SLURM_SUCCESS)
+			error_code = SLURM_FAILURE;
+	}
+	xfree(load_arg);
+	xfree(load_thread);
+	xfree(rec_offset);
+	xfree(rec_len);
+	return error_code;
+
+unpack_error:
+	error("Incomplete job record framing in job state file");
+	xfree(rec_offset);
+	xfree(rec_len);
+	return SLURM_FAILURE;
+}
+
 extern int load_all_job_state(void)
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
-	uint32_t data_size = 0;
+	int error_code = SLURM_SUCCESS;
 	int state_fd, job_cnt = 0;
-	char *data = NULL, *state_file;
-	Buf buffer;
+	char *state_file;
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	Buf buffer = NULL;
 	time_t buf_time;
 	uint32_t saved_job_id;
 	char *ver_str = NULL;
@@ -904,26 +1341,12 @@ extern int load_all_job_state(void)
 		info("No job state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
+		(void) close(state_fd);
+		if (!(buffer = create_mmap_buf(state_file))) {
+			error("Can not map job state file %s: %m",
+			      state_file);
+			error_code = ENOENT;
 		}
-		close(state_fd);
 	}
 	xfree(state_file);
 	unlock_state_files();
@@ -931,8 +1354,6 @@ extern int load_all_job_state(void)
 	job_id_sequence = MAX(job_id_sequence, slurmctld_conf.first_job_id);
 	if (error_code)
 		return error_code;
-
-	buffer = create_buf(data, data_size);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
 	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
@@ -954,15 +1375,35 @@ extern int load_all_job_state(void)
 	debug3("Job id in job_state header is %u", saved_job_id);
 
 	assoc_mgr_lock(&locks);
-	while (remaining_buf(buffer) > 0) {
-		error_code = _load_job_state(buffer, protocol_version);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		/* Job records are length prefixed, unpack them in
+		 * parallel */
+		error_code = _load_all_job_state_framed(buffer,
+							protocol_version,
+							&job_cnt);
 		if (error_code != SLURM_SUCCESS)
 			goto unpack_error;
-		job_cnt++;
+	} else {
+		while (remaining_buf(buffer) > 0) {
+			error_code = _load_job_state(buffer,
+						     protocol_version);
+			if (error_code != SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+		}
 	}
+	job_cnt += _load_job_journal();
 	assoc_mgr_unlock(&locks);
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
+	/* Rebuild the purge candidate queue for recovered finished jobs */
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if (IS_JOB_COMPLETED(job_ptr) || IS_JOB_COMPLETING(job_ptr))
+			_purge_cand_enqueue(job_ptr);
+	}
+	list_iterator_destroy(job_iterator);
+
 	free_buf(buffer);
 	info("Recovered information about %d jobs", job_cnt);
 	return error_code;
@@ -975,6 +1416,106 @@ unpack_error:
 	return SLURM_FAILURE;
 }
 
+/*
+ * _load_job_journal - replay the job state delta journal on top of the
+ *	job records recovered from the full job_state file. A damaged or
+ *	truncated journal entry ends the replay, retaining everything
+ *	recovered up to that point. Called with the assoc_mgr locks held.
+ * RET count of job records replayed
+ */
+static int _load_job_journal(void)
+{
+	int data_allocated, data_read = 0;
+	uint32_t data_size = 0;
+	int state_fd, job_cnt = 0, purge_cnt = 0;
+	char *data = NULL, *jrnl_file;
+	Buf buffer;
+	time_t buf_time;
+	uint32_t job_id, seq;
+	uint16_t entry_type;
+	char *ver_str = NULL;
+	uint32_t ver_str_len;
+	uint16_t protocol_version = (uint16_t)NO_VAL;
+
+	/* read the journal, if any */
+	jrnl_file = slurm_get_state_save_location();
+	xstrcat(jrnl_file, "/job_state.jrnl");
+	lock_state_files();
+	state_fd = open(jrnl_file, O_RDONLY);
+	if (state_fd < 0) {
+		debug("No job state journal (%s) to recover", jrnl_file);
+		unlock_state_files();
+		xfree(jrnl_file);
+		return 0;
+	}
+	data_allocated = BUF_SIZE;
+	data = xmalloc(data_allocated);
+	while (1) {
+		data_read = read(state_fd, &data[data_size], BUF_SIZE);
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			else {
+				error("Read error on %s: %m", jrnl_file);
+				break;
+			}
+		} else if (data_read == 0)	/* eof */
+			break;
+		data_size      += data_read;
+		data_allocated += data_read;
+		xrealloc(data, data_allocated);
+	}
+	close(state_fd);
+	unlock_state_files();
+
+	buffer = create_buf(data, data_size);
+	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
+	debug3("Version string in job_state journal header is %s", ver_str);
+	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+		safe_unpack16(&protocol_version, buffer);
+	xfree(ver_str);
+
+	if (protocol_version == (uint16_t)NO_VAL) {
+		error("Can not recover job state journal, incompatible version");
+		free_buf(buffer);
+		xfree(jrnl_file);
+		return 0;
+	}
+	safe_unpack_time(&buf_time, buffer);
+
+	while (remaining_buf(buffer) > 0) {
+		safe_unpack16(&entry_type, buffer);
+		if (entry_type == JOB_JRNL_ENTRY_SEQ) {
+			safe_unpack32(&seq, buffer);
+			if (seq <= slurmctld_conf.max_job_id)
+				job_id_sequence = MAX(seq, job_id_sequence);
+		} else if (entry_type == JOB_JRNL_ENTRY_PURGE) {
+			safe_unpack32(&job_id, buffer);
+			purge_cnt += _purge_job_record(job_id);
+		} else if (entry_type == JOB_JRNL_ENTRY_JOB) {
+			if (_load_job_state(buffer, protocol_version) !=
+			    SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+		} else {
+			error("Invalid job state journal entry type %hu",
+			      entry_type);
+			goto unpack_error;
+		}
+	}
+	free_buf(buffer);
+	xfree(jrnl_file);
+	info("Replayed journal records for %d jobs (%d purged)",
+	     job_cnt, purge_cnt);
+	return job_cnt;
+
+unpack_error:
+	error("Incomplete job state journal %s", jrnl_file);
+	free_buf(buffer);
+	xfree(jrnl_file);
+	return job_cnt;
+}
+
 /*
  * load_last_job_id - load only the last job ID from state save file.
  *	Changes here should be reflected in load_all_job_state().
@@ -1336,10 +1877,12 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
+		slurm_mutex_lock(&job_load_mutex);
 		job_ptr = find_job_record(job_id);
 		if (job_ptr == NULL) {
 			job_ptr = _create_job_record(&error_code, 1);
 			if (error_code) {
+				slurm_mutex_unlock(&job_load_mutex);
 				error("Create job entry failed for job_id %u",
 				      job_id);
 				goto unpack_error;
@@ -1348,6 +1891,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			job_ptr->array_job_id = array_job_id;
 			job_ptr->array_task_id = array_task_id;
 		}
+		slurm_mutex_unlock(&job_load_mutex);
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1526,10 +2070,12 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
+		slurm_mutex_lock(&job_load_mutex);
 		job_ptr = find_job_record(job_id);
 		if (job_ptr == NULL) {
 			job_ptr = _create_job_record(&error_code, 1);
 			if (error_code) {
+				slurm_mutex_unlock(&job_load_mutex);
 				error("Create job entry failed for job_id %u",
 				      job_id);
 				goto unpack_error;
@@ -1538,6 +2084,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			job_ptr->array_job_id = array_job_id;
 			job_ptr->array_task_id = array_task_id;
 		}
+		slurm_mutex_unlock(&job_load_mutex);
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1719,10 +2266,12 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
+		slurm_mutex_lock(&job_load_mutex);
 		job_ptr = find_job_record(job_id);
 		if (job_ptr == NULL) {
 			job_ptr = _create_job_record(&error_code, 1);
 			if (error_code) {
+				slurm_mutex_unlock(&job_load_mutex);
 				error("Create job entry failed for job_id %u",
 				      job_id);
 				goto unpack_error;
@@ -1731,6 +2280,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			job_ptr->array_job_id = array_job_id;
 			job_ptr->array_task_id = array_task_id;
 		}
+		slurm_mutex_unlock(&job_load_mutex);
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1901,6 +2451,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 		goto unpack_error;
 	}
 
+	slurm_mutex_lock(&job_load_mutex);
 	if ((priority > 1) && (direct_set_prio == 0)) {
 		highest_prio = MAX(highest_prio, priority);
 		lowest_prio  = MIN(lowest_prio,  priority);
@@ -1910,6 +2461,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	local_job_id = fed_mgr_get_local_id(job_id);
 	if (job_id_sequence <= local_job_id)
 		job_id_sequence = local_job_id + 1;
+	slurm_mutex_unlock(&job_load_mutex);
 
 	xfree(job_ptr->tres_alloc_str);
 	job_ptr->tres_alloc_str = tres_alloc_str;
@@ -2097,6 +2649,9 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	job_ptr->best_switch     = true;
 	job_ptr->start_protocol_ver = start_protocol_ver;
 
+	/* Serialize hash table updates and accounting storage calls when
+	 * records are being loaded in parallel */
+	slurm_mutex_lock(&job_load_mutex);
 	_add_job_hash(job_ptr);
 	_add_job_array_hash(job_ptr);
 
@@ -2169,6 +2724,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 		} else
 			job_ptr->qos_id = qos_rec.id;
 	}
+	slurm_mutex_unlock(&job_load_mutex);
 
 	/* do this after the format string just incase for some
 	 * reason the tres_alloc_str is NULL but not the fmt_str */
@@ -2227,7 +2783,9 @@ unpack_error:
 	if (job_ptr) {
 		if (job_ptr->job_id == 0)
 			job_ptr->job_id = NO_VAL;
+		slurm_mutex_lock(&job_load_mutex);
 		_purge_job_record(job_ptr->job_id);
+		slurm_mutex_unlock(&job_load_mutex);
 	}
 	return SLURM_FAILURE;
 }
@@ -2556,10 +3114,10 @@ unpack_error:
 	return SLURM_FAILURE;
 }
 
-/* _add_job_hash - add a job hash entry for given job record, job_id must
- *	already be set
+/* _add_job_hash - add a job hash entry for given job record, job_id and
+ *	user_id must already be set
  * IN job_ptr - pointer to job record
- * Globals: hash table updated
+ * Globals: hash tables updated
  */
 static void _add_job_hash(struct job_record *job_ptr)
 {
@@ -2568,12 +3126,16 @@ static void _add_job_hash(struct job_record *job_ptr)
 	inx = JOB_HASH_INX(job_ptr->job_id);
 	job_ptr->job_next = job_hash[inx];
 	job_hash[inx] = job_ptr;
+
+	inx = JOB_USER_HASH_INX(job_ptr->user_id);
+	job_ptr->job_user_next = job_user_hash[inx];
+	job_user_hash[inx] = job_ptr;
 }
 
-/* _remove_job_hash - remove a job hash entry for given job record, job_id must
- *	already be set
+/* _remove_job_hash - remove a job hash entry for given job record, job_id and
+ *	user_id must already be set
  * IN job_ptr - pointer to job record
- * Globals: hash table updated
+ * Globals: hash tables updated
  */
 static void _remove_job_hash(struct job_record *job_entry)
 {
@@ -2590,27 +3152,54 @@ static void _remove_job_hash(struct job_record *job_entry)
 	}
 	*job_pptr = job_entry->job_next;
 	job_entry->job_next = NULL;
+
+	job_pptr = &job_user_hash[JOB_USER_HASH_INX(job_entry->user_id)];
+	while ((job_pptr != NULL) &&
+	       ((job_ptr = *job_pptr) != job_entry)) {
+		job_pptr = &job_ptr->job_user_next;
+	}
+	if (job_pptr == NULL) {
+		fatal("job user hash error");
+		return; /* Fix CLANG false positive error */
+	}
+	*job_pptr = job_entry->job_user_next;
+	job_entry->job_user_next = NULL;
 }
 
 /* _add_job_array_hash - add a job hash entry for given job record,
  *	array_job_id and array_task_id must already be set
  * IN job_ptr - pointer to job record
  * Globals: hash table updated
+ * NOTE: Secondary META records (job_id != array_job_id with pending tasks
+ * in a bitmap, see job_array_split_meta()) are added to job_array_hash_j
+ * only. The primary META record is located via find_job_record() and is
+ * in neither table.
  */
 void _add_job_array_hash(struct job_record *job_ptr)
 {
 	int inx;
 
-	if (job_ptr->array_task_id == NO_VAL)
-		return;	/* Not a job array */
+	if (job_ptr->array_task_id == NO_VAL) {
+		if ((job_ptr->array_recs == NULL) ||
+		    (job_ptr->job_id == job_ptr->array_job_id))
+			return;	/* Not a job array or primary META record */
+	}
 
-	inx = JOB_HASH_INX(job_ptr->array_job_id);
-	job_ptr->job_array_next_j = job_array_hash_j[inx];
-	job_array_hash_j[inx] = job_ptr;
+	if (!(job_ptr->array_hash_flags & JOB_ARRAY_HASH_J)) {
+		inx = JOB_HASH_INX(job_ptr->array_job_id);
+		job_ptr->job_array_next_j = job_array_hash_j[inx];
+		job_array_hash_j[inx] = job_ptr;
+		job_ptr->array_hash_flags |= JOB_ARRAY_HASH_J;
+	}
 
-	inx = JOB_ARRAY_HASH_INX(job_ptr->array_job_id,job_ptr->array_task_id);
-	job_ptr->job_array_next_t = job_array_hash_t[inx];
-	job_array_hash_t[inx] = job_ptr;
+	if ((job_ptr->array_task_id != NO_VAL) &&
+	    !(job_ptr->array_hash_flags & JOB_ARRAY_HASH_T)) {
+		inx = JOB_ARRAY_HASH_INX(job_ptr->array_job_id,
+					 job_ptr->array_task_id);
+		job_ptr->job_array_next_t = job_array_hash_t[inx];
+		job_array_hash_t[inx] = job_ptr;
+		job_ptr->array_hash_flags |= JOB_ARRAY_HASH_T;
+	}
 }
 
 /* For the job array data structure, build the string representation of the
@@ -2764,6 +3353,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id)
 	job_ptr = job_array_hash_j[inx];
 	while (job_ptr) {
 		if ((job_ptr->array_job_id == array_job_id) &&
+		    (job_ptr->array_task_id != NO_VAL) &&  /* skip META recs */
 		    IS_JOB_PENDING(job_ptr))
 			count++;
 		job_ptr = job_ptr->job_array_next_j;
@@ -2830,6 +3420,23 @@ extern struct job_record *find_job_array_rec(uint32_t array_job_id,
 				return job_ptr;
 			}
 		}
+		/* Look for secondary META record with a subset of the
+		 * pending tasks (see job_array_split_meta()) */
+		inx = JOB_HASH_INX(array_job_id);
+		job_ptr = job_array_hash_j[inx];
+		while (job_ptr) {
+			if ((job_ptr->array_job_id == array_job_id) &&
+			    (job_ptr->array_task_id == NO_VAL) &&
+			    job_ptr->array_recs &&
+			    job_ptr->array_recs->task_id_bitmap &&
+			    (array_task_id <
+			     bit_size(job_ptr->array_recs->task_id_bitmap)) &&
+			    bit_test(job_ptr->array_recs->task_id_bitmap,
+				     array_task_id)) {
+				return job_ptr;
+			}
+			job_ptr = job_ptr->job_array_next_j;
+		}
 		return NULL;	/* None found */
 	}
 }
@@ -3682,6 +4289,18 @@ extern void rehash_jobs(void)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
 		job_array_hash_t = (struct job_record **)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
+		job_user_hash = (struct job_record **)
+			xmalloc(hash_table_size * sizeof(struct job_record *));
+		/* These tables are walked from every RPC thread, do not
+		 * leave them all on the building thread's socket */
+		ctld_numa_interleave(job_hash, hash_table_size *
+				     sizeof(struct job_record *));
+		ctld_numa_interleave(job_array_hash_j, hash_table_size *
+				     sizeof(struct job_record *));
+		ctld_numa_interleave(job_array_hash_t, hash_table_size *
+				     sizeof(struct job_record *));
+		ctld_numa_interleave(job_user_hash, hash_table_size *
+				     sizeof(struct job_record *));
 	} else if (hash_table_size < (slurmctld_conf.max_job_cnt / 2)) {
 		/* If the MaxJobCount grows by too much, the hash table will
 		 * be ineffective without rebuilding. We don't presently bother
@@ -3692,41 +4311,20 @@ extern void rehash_jobs(void)
 	}
 }
 
-/* Create an exact copy of an existing job record for a job array.
- * IN job_ptr - META job record for a job array, which is to become an
- *		individial task of the job array.
- *		Set the job's array_task_id to the task to be split out.
- * RET - The new job record, which is the new META job record. */
-extern struct job_record *job_array_split(struct job_record *job_ptr)
+/* Copy a job record for job array splitting purposes. Deep copies all of
+ * the source job record except the job ID, hash table linkage and
+ * array_recs, which the callers establish. */
+static void _job_array_rec_copy(struct job_record *job_ptr,
+				struct job_record *job_ptr_pend)
 {
-	struct job_record *job_ptr_pend = NULL, *save_job_next;
 	struct job_details *job_details, *details_new, *save_details;
+	struct job_record *save_job_next;
 	uint32_t save_job_id;
 	uint64_t save_db_index = job_ptr->db_index;
 	priority_factors_object_t *save_prio_factors;
 	List save_step_list;
-	int error_code = SLURM_SUCCESS;
 	int i;
 
-	job_ptr_pend = _create_job_record(&error_code, 0);
-	if (!job_ptr_pend)     /* MaxJobCount checked when job array submitted */
-		fatal("%s: _create_job_record error", __func__);
-	if (error_code != SLURM_SUCCESS)
-		return NULL;
-
-	_remove_job_hash(job_ptr);
-	job_ptr_pend->job_id = job_ptr->job_id;
-	if (_set_job_id(job_ptr) != SLURM_SUCCESS)
-		fatal("%s: _set_job_id error", __func__);
-	if (!job_ptr->array_recs) {
-		fatal("%s: job %u record lacks array structure",
-		      __func__, job_ptr->job_id);
-	}
-	if (_copy_job_desc_files(job_ptr_pend->job_id, job_ptr->job_id)) {
-		error("%s: failed to create working directory for job %u",
-		      __func__, job_ptr->job_id);
-	}
-
 	/* Copy most of original job data.
 	 * This could be done in parallel, but performance was worse. */
 	save_job_id   = job_ptr_pend->job_id;
@@ -3742,6 +4340,12 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	job_ptr_pend->step_list = save_step_list;
 	job_ptr_pend->db_index = save_db_index;
 
+	/* Array hash table membership is not copied, the original record
+	 * retains its place in the hash chains */
+	job_ptr_pend->job_array_next_j = NULL;
+	job_ptr_pend->job_array_next_t = NULL;
+	job_ptr_pend->array_hash_flags = 0;
+
 	job_ptr_pend->prio_factors = save_prio_factors;
 	slurm_copy_priority_factors_object(job_ptr_pend->prio_factors,
 					   job_ptr->prio_factors);
@@ -3750,22 +4354,8 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	job_ptr_pend->alias_list = xstrdup(job_ptr->alias_list);
 	job_ptr_pend->alloc_node = xstrdup(job_ptr->alloc_node);
 
-	job_ptr_pend->array_recs = job_ptr->array_recs;
-	job_ptr->array_recs = NULL;
-
-	if (job_ptr_pend->array_recs &&
-	    job_ptr_pend->array_recs->task_id_bitmap) {
-		bit_clear(job_ptr_pend->array_recs->task_id_bitmap,
-			  job_ptr_pend->array_task_id);
-	}
-	xfree(job_ptr_pend->array_recs->task_id_str);
-	if (job_ptr_pend->array_recs->task_cnt) {
-		job_ptr_pend->array_recs->task_cnt--;
-	} else {
-		error("Job %u array_recs->task_cnt underflow",
-		      job_ptr->array_job_id);
-	}
-	job_ptr_pend->array_task_id = NO_VAL;
+	/* NOTE: array_recs handled by the caller */
+	job_ptr_pend->array_recs = NULL;
 
 	job_ptr_pend->batch_host = NULL;
 	if (job_ptr->check_job) {
@@ -3791,9 +4381,6 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	memcpy(job_ptr_pend->limit_set.tres, job_ptr->limit_set.tres,
 	       sizeof(uint16_t) * slurmctld_tres_cnt);
 
-	_add_job_hash(job_ptr);		/* Sets job_next */
-	_add_job_hash(job_ptr_pend);	/* Sets job_next */
-	_add_job_array_hash(job_ptr);
 	job_ptr_pend->job_resrcs = NULL;
 
 	job_ptr_pend->licenses = xstrdup(job_ptr->licenses);
@@ -3906,6 +4493,123 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	details_new->std_in = xstrdup(job_details->std_in);
 	details_new->std_out = xstrdup(job_details->std_out);
 	details_new->work_dir = xstrdup(job_details->work_dir);
+}
+
+/* Create an exact copy of an existing job record for a job array.
+ * IN job_ptr - META job record for a job array, which is to become an
+ *		individial task of the job array.
+ *		Set the job's array_task_id to the task to be split out.
+ * RET - The new job record, which is the new META job record. */
+extern struct job_record *job_array_split(struct job_record *job_ptr)
+{
+	struct job_record *job_ptr_pend = NULL;
+	int error_code = SLURM_SUCCESS;
+
+	job_ptr_pend = _create_job_record(&error_code, 0);
+	if (!job_ptr_pend)     /* MaxJobCount checked when job array submitted */
+		fatal("%s: _create_job_record error", __func__);
+	if (error_code != SLURM_SUCCESS)
+		return NULL;
+
+	_remove_job_hash(job_ptr);
+	job_ptr_pend->job_id = job_ptr->job_id;
+	if (_set_job_id(job_ptr) != SLURM_SUCCESS)
+		fatal("%s: _set_job_id error", __func__);
+	if (!job_ptr->array_recs) {
+		fatal("%s: job %u record lacks array structure",
+		      __func__, job_ptr->job_id);
+	}
+	/* NOTE: The script and environment files are read from the array
+	 * head job's state directory, no files or directory are created
+	 * for the split out task */
+
+	_job_array_rec_copy(job_ptr, job_ptr_pend);
+
+	job_ptr_pend->array_recs = job_ptr->array_recs;
+	job_ptr->array_recs = NULL;
+
+	if (job_ptr_pend->array_recs &&
+	    job_ptr_pend->array_recs->task_id_bitmap) {
+		bit_clear(job_ptr_pend->array_recs->task_id_bitmap,
+			  job_ptr_pend->array_task_id);
+	}
+	xfree(job_ptr_pend->array_recs->task_id_str);
+	if (job_ptr_pend->array_recs->task_cnt) {
+		job_ptr_pend->array_recs->task_cnt--;
+	} else {
+		error("Job %u array_recs->task_cnt underflow",
+		      job_ptr->array_job_id);
+	}
+	job_ptr_pend->array_task_id = NO_VAL;
+
+	_add_job_hash(job_ptr);		/* Sets job_next */
+	_add_job_hash(job_ptr_pend);	/* Sets job_next */
+	_add_job_array_hash(job_ptr);
+	_add_job_array_hash(job_ptr_pend); /* No-op unless secondary META */
+
+	return job_ptr_pend;
+}
+
+/* Split the pending tasks in task_bitmap out of an existing META job
+ * record into a new secondary META job record, typically so a different
+ * set of specifications can be applied to them.
+ * IN job_ptr - META job record holding a superset of task_bitmap
+ * IN task_bitmap - tasks to move into the new record, not modified
+ * RET - The new secondary META job record or NULL on error */
+extern struct job_record *job_array_split_meta(struct job_record *job_ptr,
+					       bitstr_t *task_bitmap)
+{
+	struct job_record *job_ptr_pend = NULL;
+	int error_code = SLURM_SUCCESS;
+	uint32_t task_cnt;
+
+	if (!job_ptr->array_recs || !job_ptr->array_recs->task_id_bitmap)
+		return NULL;
+	task_cnt = bit_set_count(task_bitmap);
+	if (task_cnt == 0)
+		return NULL;
+
+	job_ptr_pend = _create_job_record(&error_code, 0);
+	if (!job_ptr_pend)     /* MaxJobCount checked when job array submitted */
+		fatal("%s: _create_job_record error", __func__);
+	if (error_code != SLURM_SUCCESS)
+		return NULL;
+
+	_job_array_rec_copy(job_ptr, job_ptr_pend);
+	if (_set_job_id(job_ptr_pend) != SLURM_SUCCESS)
+		fatal("%s: _set_job_id error", __func__);
+
+	/* The new record holds the tasks in task_bitmap, it keeps
+	 * NO_VAL as its task ID and remains a META record */
+	job_ptr_pend->array_recs = xmalloc(sizeof(job_array_struct_t));
+	memcpy(job_ptr_pend->array_recs, job_ptr->array_recs,
+	       sizeof(job_array_struct_t));
+	job_ptr_pend->array_recs->task_id_str = NULL;
+	job_ptr_pend->array_recs->task_id_bitmap = bit_copy(task_bitmap);
+	job_ptr_pend->array_recs->task_cnt = task_cnt;
+	/* Task run/completion stats are aggregated on the record with
+	 * job_id == array_job_id (see job_array_start()) */
+	job_ptr_pend->array_recs->tot_run_tasks = 0;
+	job_ptr_pend->array_recs->tot_comp_tasks = 0;
+	job_ptr_pend->array_recs->min_exit_code = 0;
+	job_ptr_pend->array_recs->max_exit_code = 0;
+	job_ptr_pend->array_task_id = NO_VAL;
+
+	/* Remove those tasks from the original META record */
+	bit_not(task_bitmap);
+	bit_and(job_ptr->array_recs->task_id_bitmap, task_bitmap);
+	bit_not(task_bitmap);
+	xfree(job_ptr->array_recs->task_id_str);
+	if (job_ptr->array_recs->task_cnt >= task_cnt) {
+		job_ptr->array_recs->task_cnt -= task_cnt;
+	} else {
+		error("Job %u array_recs->task_cnt underflow",
+		      job_ptr->array_job_id);
+		job_ptr->array_recs->task_cnt = 0;
+	}
+
+	_add_job_hash(job_ptr_pend);	/* Sets job_next */
+	_add_job_array_hash(job_ptr_pend);
 
 	return job_ptr_pend;
 }
@@ -4540,7 +5244,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 			  uid_t uid, bool preempt)
 {
 	slurm_ctl_conf_t *conf;
-	struct job_record *job_ptr;
+	struct job_record *job_ptr, *next_job_ptr;
 	uint32_t job_id;
 	time_t now = time(NULL);
 	char *end_ptr = NULL, *tok, *tmp;
@@ -4703,17 +5407,36 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 		goto endit;
 	}
 
-	if (IS_JOB_PENDING(job_ptr) &&
-	    job_ptr->array_recs && job_ptr->array_recs->task_id_bitmap) {
+	/* Remove the pending tasks held in META records from the signal
+	 * set via bitmap operations. The record with job_id == array_job_id
+	 * is not in the array hash tables, so check it first, then scan the
+	 * hash table for secondary META records (see job_array_split_meta()).
+	 */
+	job_ptr = find_job_record(job_id);
+	next_job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+	while (job_ptr || next_job_ptr) {
+		if (!job_ptr) {
+			job_ptr = next_job_ptr;
+			next_job_ptr = next_job_ptr->job_array_next_j;
+			if ((job_ptr->array_job_id != job_id) ||
+			    (job_ptr->array_task_id != NO_VAL)) {
+				job_ptr = NULL;	/* Not a secondary META */
+				continue;
+			}
+		}
+		if (!IS_JOB_PENDING(job_ptr) || !job_ptr->array_recs ||
+		    !job_ptr->array_recs->task_id_bitmap) {
+			job_ptr = NULL;
+			continue;
+		}
 		/* Ensure bitmap sizes match for AND operations */
 		len = bit_size(job_ptr->array_recs->task_id_bitmap);
-		i_last++;
-		if (i_last < len) {
+		if (len > bit_size(array_bitmap)) {
 			array_bitmap = bit_realloc(array_bitmap, len);
-		} else {
-			array_bitmap = bit_realloc(array_bitmap, i_last);
+		} else if (len < bit_size(array_bitmap)) {
 			job_ptr->array_recs->task_id_bitmap = bit_realloc(
-				job_ptr->array_recs->task_id_bitmap, i_last);
+				job_ptr->array_recs->task_id_bitmap,
+				bit_size(array_bitmap));
 		}
 		tmp_bitmap = bit_copy(job_ptr->array_recs->task_id_bitmap);
 		if (signal == SIGKILL) {
@@ -4757,6 +5480,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 			FREE_NULL_BITMAP(tmp_bitmap);
 			rc = ESLURM_TRANSITION_STATE_NO_UPDATE;
 		}
+		job_ptr = NULL;
 	}
 
 	i_first = bit_ffs(array_bitmap);
@@ -6470,56 +7194,18 @@ static bool _dup_job_file_test(uint32_t job_id)
 	dir_name_src  = slurm_get_state_save_location();
 	hash = job_id % 10;
 	sprintf(job_dir, "/hash.%d", hash);
-	xstrcat(dir_name_src, job_dir);
-	sprintf(job_dir, "/job.%u", job_id);
-	xstrcat(dir_name_src, job_dir);
-	rc = stat(dir_name_src, &buf);
-	xfree(dir_name_src);
-	if (rc == 0) {
-		error("Vestigial state files for job %u, but no job record. "
-		      "this may be the result of two slurmctld running in "
-		      "primary mode", job_id);
-		return true;
-	}
-	return false;
-}
-
-/* _copy_job_desc_files - Create work directory for job array task.
- * No longer copies environment/script files. */
-static int
-_copy_job_desc_files(uint32_t job_id_src, uint32_t job_id_dest)
-{
-	int error_code = SLURM_SUCCESS, hash;
-	char *dir_name_src, *dir_name_dest, job_dir[40];
-
-	/* Create state_save_location directory */
-	dir_name_src  = slurm_get_state_save_location();
-	dir_name_dest = xstrdup(dir_name_src);
-
-	/* Create directory based upon job ID due to limitations on the number
-	 * of files possible in a directory on some file system types (e.g.
-	 * up to 64k files on a FAT32 file system). */
-	hash = job_id_dest % 10;
-	sprintf(job_dir, "/hash.%d", hash);
-	xstrcat(dir_name_dest, job_dir);
-	(void) mkdir(dir_name_dest, 0700);
-
-	/* Create job_id_dest specific directory */
-	sprintf(job_dir, "/job.%u", job_id_dest);
-	xstrcat(dir_name_dest, job_dir);
-	if (mkdir(dir_name_dest, 0700)) {
-		if (!slurmctld_primary && (errno == EEXIST)) {
-			error("Apparent duplicate job ID %u. Two primary "
-			      "slurmctld daemons might currently be active",
-			      job_id_dest);
-		}
-		error("mkdir(%s) error %m", dir_name_dest);
-		error_code = ESLURM_WRITING_TO_FILE;
-	}
+	xstrcat(dir_name_src, job_dir);
+	sprintf(job_dir, "/job.%u", job_id);
+	xstrcat(dir_name_src, job_dir);
+	rc = stat(dir_name_src, &buf);
 	xfree(dir_name_src);
-	xfree(dir_name_dest);
-
-	return error_code;
+	if (rc == 0) {
+		error("Vestigial state files for job %u, but no job record. "
+		      "this may be the result of two slurmctld running in "
+		      "primary mode", job_id);
+		return true;
+	}
+	return false;
 }
 
 /*
@@ -6619,8 +7305,12 @@ char **get_job_env(struct job_record *job_ptr, uint32_t * env_size)
 	char *file_name = NULL, job_dir[40], **environment = NULL;
 	int cc, fd = -1, hash;
 
-	/* Standard file location for job arrays, version 16.05+ */
-	if (job_ptr->array_task_id != NO_VAL) {
+	/* Standard file location for job arrays, version 16.05+.
+	 * Also covers secondary META records, which lack files of their own
+	 * and read from the array head job's directory. */
+	if ((job_ptr->array_task_id != NO_VAL) ||
+	    (job_ptr->array_job_id &&
+	     (job_ptr->array_job_id != job_ptr->job_id))) {
 		hash = job_ptr->array_job_id % 10;
 		sprintf(job_dir, "/hash.%d/job.%u/environment",
 			hash, job_ptr->array_job_id);
@@ -6685,8 +7375,12 @@ char *get_job_script(struct job_record *job_ptr)
 	if (!job_ptr->batch_flag)
 		return NULL;
 
-	/* Standard file location for job arrays, version 16.05+ */
-	if (job_ptr->array_task_id != NO_VAL) {
+	/* Standard file location for job arrays, version 16.05+.
+	 * Also covers secondary META records, which lack files of their own
+	 * and read from the array head job's directory. */
+	if ((job_ptr->array_task_id != NO_VAL) ||
+	    (job_ptr->array_job_id &&
+	     (job_ptr->array_job_id != job_ptr->job_id))) {
 		hash = job_ptr->array_job_id % 10;
 		sprintf(job_dir, "/hash.%d/job.%u/script",
 			hash, job_ptr->array_job_id);
@@ -7035,10 +7729,11 @@ _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 	job_ptr->tres_fmt_req_str = assoc_mgr_make_tres_str_from_array(
 		job_ptr->tres_req_cnt, 0, false);
 
-	_add_job_hash(job_ptr);
-
 	job_ptr->user_id    = (uid_t) job_desc->user_id;
 	job_ptr->group_id   = (gid_t) job_desc->group_id;
+
+	_add_job_hash(job_ptr);	/* user_id must be set first */
+
 	job_ptr->job_state  = JOB_PENDING;
 	job_ptr->time_limit = job_desc->time_limit;
 	job_ptr->deadline   = job_desc->deadline;
@@ -7955,16 +8650,67 @@ _validate_min_mem_partition(job_desc_msg_t *job_desc_msg,
  *	see common/list.h for documentation
  * IN job_entry - pointer to job_record to delete
  */
+/* Purged job ids are remembered for a while so diff info responses
+ * can report deletions, see pack_all_jobs() */
+#define DELETED_JOB_RETAIN 3600
+typedef struct {
+	uint32_t job_id;
+	time_t del_time;
+} deleted_job_t;
+static List deleted_job_list = NULL;
+static time_t deleted_job_horizon = 0;	/* diff requests presenting an
+					 * older update time get a full
+					 * dump */
+
+static void _del_deleted_job(void *x)
+{
+	xfree(x);
+}
+
+static void _record_deleted_job(uint32_t job_id)
+{
+	deleted_job_t *del;
+	time_t now = time(NULL);
+
+	if (!deleted_job_horizon)
+		deleted_job_horizon = slurmctld_config.boot_time;
+	if (!deleted_job_list)
+		deleted_job_list = list_create(_del_deleted_job);
+
+	while ((del = list_peek(deleted_job_list))) {
+		if (del->del_time > (now - DELETED_JOB_RETAIN))
+			break;
+		deleted_job_horizon = MAX(deleted_job_horizon,
+					  del->del_time);
+		del = list_pop(deleted_job_list);
+		xfree(del);
+	}
+
+	del = xmalloc(sizeof(deleted_job_t));
+	del->job_id = job_id;
+	del->del_time = now;
+	list_append(deleted_job_list, del);
+}
+
 static void _list_delete_job(void *job_entry)
 {
 	struct job_record *job_ptr = (struct job_record *) job_entry;
 	struct job_record **job_pptr, *tmp_ptr;
-	int job_array_size, i;
+	int job_array_size;
 
 	xassert(job_entry);
 	xassert (job_ptr->magic == JOB_MAGIC);
 	job_ptr->magic = 0;	/* make sure we don't delete record twice */
 
+	_record_deleted_job(job_ptr->job_id);
+
+	/* Record deletion for the job state delta journal */
+	if (jrnl_purged_ids) {
+		uint32_t *purged_id = xmalloc(sizeof(uint32_t));
+		*purged_id = job_ptr->job_id;
+		list_append(jrnl_purged_ids, purged_id);
+	}
+
 	/* Remove the record from job hash table */
 	job_pptr = &job_hash[JOB_HASH_INX(job_ptr->job_id)];
 	while ((job_pptr != NULL) && (*job_pptr != NULL) &&
@@ -7977,6 +8723,18 @@ static void _list_delete_job(void *job_entry)
 	else
 		*job_pptr = job_ptr->job_next;
 
+	/* Remove the record from the user hash table */
+	job_pptr = &job_user_hash[JOB_USER_HASH_INX(job_ptr->user_id)];
+	while ((job_pptr != NULL) && (*job_pptr != NULL) &&
+	       ((tmp_ptr = *job_pptr) != (struct job_record *) job_entry)) {
+		xassert(tmp_ptr->magic == JOB_MAGIC);
+		job_pptr = &tmp_ptr->job_user_next;
+	}
+	if (job_pptr == NULL)
+		error("job user hash error");
+	else
+		*job_pptr = job_ptr->job_user_next;
+
 	if (job_ptr->array_recs) {
 		job_array_size = MAX(1, job_ptr->array_recs->task_cnt);
 	} else {
@@ -7984,7 +8742,7 @@ static void _list_delete_job(void *job_entry)
 	}
 
 	/* Remove the record from job array hash tables, if applicable */
-	if (job_ptr->array_task_id != NO_VAL) {
+	if (job_ptr->array_hash_flags & JOB_ARRAY_HASH_J) {
 		job_pptr = &job_array_hash_j[
 			JOB_HASH_INX(job_ptr->array_job_id)];
 		while ((job_pptr != NULL) && (*job_pptr != NULL) &&
@@ -7997,7 +8755,9 @@ static void _list_delete_job(void *job_entry)
 			error("job array hash error");
 		else
 			*job_pptr = job_ptr->job_array_next_j;
+	}
 
+	if (job_ptr->array_hash_flags & JOB_ARRAY_HASH_T) {
 		job_pptr = &job_array_hash_t[
 			JOB_ARRAY_HASH_INX(job_ptr->array_job_id,
 					   job_ptr->array_task_id)];
@@ -8013,6 +8773,32 @@ static void _list_delete_job(void *job_entry)
 			*job_pptr = job_ptr->job_array_next_t;
 	}
 
+	if (job_array_size > job_count) {
+		error("job_count underflow");
+		job_count = 0;
+	} else {
+		job_count -= job_array_size;
+	}
+
+	/* The record is fully unlinked from the job list, hash tables and
+	 * counters at this point. During purge sweeps the memory release
+	 * is handed to the reclamation thread so the xfree storm happens
+	 * outside the job write lock window. */
+	if (purge_defer_free) {
+		slurm_mutex_lock(&purge_free_mutex);
+		list_append(purge_free_list, job_ptr);
+		slurm_cond_signal(&purge_free_cond);
+		slurm_mutex_unlock(&purge_free_mutex);
+		return;
+	}
+	_job_record_free(job_ptr);
+}
+
+/* Release all memory associated with an already unlinked job record */
+static void _job_record_free(struct job_record *job_ptr)
+{
+	int i;
+
 	delete_job_details(job_ptr);
 	xfree(job_ptr->account);
 	xfree(job_ptr->admin_comment);
@@ -8056,6 +8842,7 @@ static void _list_delete_job(void *job_entry)
 		xfree(job_ptr->spank_job_env[i]);
 	xfree(job_ptr->spank_job_env);
 	xfree(job_ptr->state_desc);
+	xfree(job_ptr->steps_on_node);
 	xfree(job_ptr->tres_alloc_cnt);
 	xfree(job_ptr->tres_alloc_str);
 	xfree(job_ptr->tres_fmt_alloc_str);
@@ -8065,14 +8852,8 @@ static void _list_delete_job(void *job_entry)
 	step_list_purge(job_ptr);
 	select_g_select_jobinfo_free(job_ptr->select_jobinfo);
 	xfree(job_ptr->wckey);
-	if (job_array_size > job_count) {
-		error("job_count underflow");
-		job_count = 0;
-	} else {
-		job_count -= job_array_size;
-	}
 	job_ptr->job_id = 0;
-	xfree(job_ptr);
+	rec_pool_put(REC_POOL_JOB, job_ptr);
 }
 
 
@@ -8097,6 +8878,85 @@ static void _job_purge_start(void)
 	gettimeofday(&purge_start_time, NULL);
 }
 
+/* How long to wait before re-evaluating a finished job that could not be
+ * purged yet (still completing, active steps, stage-out, etc.) */
+#define PURGE_RETRY_SECS 30
+
+typedef struct {
+	uint32_t job_id;
+	time_t due_time;	/* earliest useful evaluation time */
+} purge_cand_t;
+
+static void _del_purge_cand(void *x)
+{
+	xfree(x);
+}
+
+/* Note that a job has finished and its record will eventually be purged.
+ * The queue lets purge_old_job() skip the full job_list sweep until some
+ * candidate is actually due. Caller must hold the job write lock. */
+static void _purge_cand_enqueue(struct job_record *job_ptr)
+{
+	purge_cand_t *cand;
+	time_t base, kill_age;
+
+	if (!purge_cand_list)
+		purge_cand_list = list_create(_del_purge_cand);
+
+	kill_age = slurmctld_conf.kill_wait + 2 * slurm_get_msg_timeout();
+	base = job_ptr->end_time ? job_ptr->end_time : time(NULL);
+	cand = xmalloc(sizeof(purge_cand_t));
+	cand->job_id = job_ptr->job_id;
+	if (slurmctld_conf.min_job_age == 0) {
+		/* No record purging, but completing jobs still need the
+		 * stuck-kill checks performed by the sweep */
+		cand->due_time = base + kill_age;
+	} else {
+		cand->due_time = base + MIN(slurmctld_conf.min_job_age,
+					    kill_age);
+	}
+	list_append(purge_cand_list, cand);
+}
+
+/* Release job record memory handed off by _list_delete_job() without
+ * holding any slurmctld locks */
+static void *_job_reclaim_thread(void *no_data)
+{
+	struct job_record *job_ptr;
+
+	while (1) {
+		slurm_mutex_lock(&purge_free_mutex);
+		while (!list_count(purge_free_list))
+			slurm_cond_wait(&purge_free_cond, &purge_free_mutex);
+		job_ptr = (struct job_record *) list_dequeue(purge_free_list);
+		slurm_mutex_unlock(&purge_free_mutex);
+		if (job_ptr)
+			_job_record_free(job_ptr);
+	}
+	return NULL;
+}
+
+static void _job_reclaim_start(void)
+{
+	pthread_attr_t reclaim_attr;
+	pthread_t reclaim_tid;
+
+	if (purge_free_thread)
+		return;
+	purge_free_list = list_create(NULL);
+	slurm_attr_init(&reclaim_attr);
+	if (pthread_attr_setdetachstate(&reclaim_attr,
+					PTHREAD_CREATE_DETACHED))
+		error("pthread_attr_setdetachstate %m");
+	if (pthread_create(&reclaim_tid, &reclaim_attr,
+			   _job_reclaim_thread, NULL)) {
+		/* records will be freed in-line instead */
+		error("%s: pthread_create: %m", __func__);
+	} else
+		purge_free_thread = true;
+	slurm_attr_destroy(&reclaim_attr);
+}
+
 /*
  * _list_find_job_old - find old entries in the job list,
  *	see common/list.h for documentation, key is ignored
@@ -8219,6 +9079,89 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid)
 	return false;
 }
 
+#define PACK_JOBS_CACHE_RECS 4
+typedef struct pack_jobs_cache {
+	char *data;		/* packed RESPONSE_JOB_INFO body */
+	int data_size;
+	time_t job_update;	/* last_job_update when packed */
+	time_t part_update;	/* last_part_update when packed */
+	time_t last_used;
+	uint16_t protocol_version;
+	uint16_t show_flags;
+	uid_t uid;
+} pack_jobs_cache_t;
+static pack_jobs_cache_t pack_jobs_cache[PACK_JOBS_CACHE_RECS];
+static pthread_mutex_t pack_jobs_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* If a previously packed job info response for this uid, show_flags and
+ * protocol_version is still current, return a copy of it.
+ * Caller must hold a read lock on the job and partition data. */
+static bool _pack_jobs_cache_lookup(char **buffer_ptr, int *buffer_size,
+				    uint16_t show_flags, uid_t uid,
+				    uint16_t protocol_version)
+{
+	pack_jobs_cache_t *rec;
+	bool found = false;
+	int i;
+
+	slurm_mutex_lock(&pack_jobs_cache_mutex);
+	for (i = 0; i < PACK_JOBS_CACHE_RECS; i++) {
+		rec = &pack_jobs_cache[i];
+		if (!rec->data ||
+		    (rec->uid != uid) ||
+		    (rec->show_flags != show_flags) ||
+		    (rec->protocol_version != protocol_version))
+			continue;
+		if ((rec->job_update  != last_job_update) ||
+		    (rec->part_update != last_part_update)) {
+			xfree(rec->data);	/* stale */
+			continue;
+		}
+		buffer_ptr[0] = xmalloc(rec->data_size);
+		memcpy(buffer_ptr[0], rec->data, rec->data_size);
+		*buffer_size = rec->data_size;
+		rec->last_used = time(NULL);
+		found = true;
+		break;
+	}
+	slurm_mutex_unlock(&pack_jobs_cache_mutex);
+	return found;
+}
+
+/* Cache a copy of a freshly packed job info response, replacing the
+ * least recently used record.
+ * Caller must hold a read lock on the job and partition data. */
+static void _pack_jobs_cache_insert(char *data, int data_size,
+				    uint16_t show_flags, uid_t uid,
+				    uint16_t protocol_version)
+{
+	pack_jobs_cache_t *rec, *lru_rec;
+	int i;
+
+	slurm_mutex_lock(&pack_jobs_cache_mutex);
+	lru_rec = &pack_jobs_cache[0];
+	for (i = 0; i < PACK_JOBS_CACHE_RECS; i++) {
+		rec = &pack_jobs_cache[i];
+		if (!rec->data) {
+			lru_rec = rec;
+			break;
+		}
+		if (rec->last_used < lru_rec->last_used)
+			lru_rec = rec;
+	}
+	xfree(lru_rec->data);
+	lru_rec->data = xmalloc(data_size);
+	memcpy(lru_rec->data, data, data_size);
+	lru_rec->data_size = data_size;
+	lru_rec->job_update = last_job_update;
+	lru_rec->part_update = last_part_update;
+	lru_rec->last_used = time(NULL);
+	lru_rec->protocol_version = protocol_version;
+	lru_rec->show_flags = show_flags;
+	lru_rec->uid = uid;
+	slurm_mutex_unlock(&pack_jobs_cache_mutex);
+}
+
 /*
  * pack_all_jobs - dump all job information for all jobs in
  *	machine independent form (for network transmission)
@@ -8232,45 +9175,294 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid)
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
  *	whenever the data format changes
  */
+/* Return true if name appears as one element of the comma separated
+ * list in csv */
+static bool _csv_contains(char *csv, char *name)
+{
+	char *tmp, *tok, *save_ptr = NULL;
+	bool found = false;
+
+	tmp = xstrdup(csv);
+	tok = strtok_r(tmp, ",", &save_ptr);
+	while (tok) {
+		if (!xstrcmp(tok, name)) {
+			found = true;
+			break;
+		}
+		tok = strtok_r(NULL, ",", &save_ptr);
+	}
+	xfree(tmp);
+	return found;
+}
+
+/* Return true if job_ids[inx] already appears earlier in the filter
+ * job id list */
+static bool _job_id_repeated(job_info_request_msg_t *filter_msg, int inx)
+{
+	int i;
+
+	for (i = 0; i < inx; i++) {
+		if (filter_msg->job_ids[i] == filter_msg->job_ids[inx])
+			return true;
+	}
+	return false;
+}
+
+/* Return true if job_id is one of the ids in the filter job id list */
+static bool _job_id_requested(job_info_request_msg_t *filter_msg,
+			      uint32_t job_id)
+{
+	int i;
+
+	for (i = 0; i < filter_msg->job_id_count; i++) {
+		if (filter_msg->job_ids[i] == job_id)
+			return true;
+	}
+	return false;
+}
+
+/* Build the list of job records matching the ids in the filter job id
+ * list, resolving each id through the job hash table and the job array
+ * hash table (for the tasks of an array) rather than scanning job_list.
+ * A record whose own id is also in the list is left to its direct
+ * lookup so it is enumerated only once.
+ * Caller must free the returned list. */
+static List _job_id_filter_candidates(job_info_request_msg_t *filter_msg)
+{
+	struct job_record *job_ptr;
+	List cand_list = list_create(NULL);
+	uint32_t job_id;
+	int i;
+
+	for (i = 0; i < filter_msg->job_id_count; i++) {
+		if (_job_id_repeated(filter_msg, i))
+			continue;
+		job_id = filter_msg->job_ids[i];
+		if ((job_ptr = find_job_record(job_id)))
+			list_append(cand_list, job_ptr);
+		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		while (job_ptr) {
+			if ((job_ptr->array_job_id == job_id) &&
+			    (job_ptr->job_id != job_id) &&
+			    !_job_id_requested(filter_msg, job_ptr->job_id))
+				list_append(cand_list, job_ptr);
+			job_ptr = job_ptr->job_array_next_j;
+		}
+	}
+	return cand_list;
+}
+
+/* Return true if job_ptr satisfies the server side filters carried in
+ * a REQUEST_JOB_INFO message.  This is only a coarse cut to limit the
+ * transfer size, the client still applies its full filtering to
+ * whatever it receives (e.g. individual array tasks). */
+static bool _job_matches_filter(struct job_record *job_ptr,
+				job_info_request_msg_t *filter_msg)
+{
+	int i;
+
+	if (filter_msg->job_id_count) {
+		for (i = 0; i < filter_msg->job_id_count; i++) {
+			if ((filter_msg->job_ids[i] == job_ptr->job_id) ||
+			    (filter_msg->job_ids[i] == job_ptr->array_job_id))
+				break;
+		}
+		if (i >= filter_msg->job_id_count)
+			return false;
+	}
+
+	if (filter_msg->user_count) {
+		for (i = 0; i < filter_msg->user_count; i++) {
+			if (filter_msg->user_ids[i] == job_ptr->user_id)
+				break;
+		}
+		if (i >= filter_msg->user_count)
+			return false;
+	}
+
+	if (filter_msg->state_count) {
+		/* Match the way squeue matches states so we never drop
+		 * a job the client would have kept */
+		uint32_t state = job_ptr->job_state & ~JOB_UPDATE_DB;
+		for (i = 0; i < filter_msg->state_count; i++) {
+			uint32_t want = filter_msg->states[i];
+			if (want & JOB_STATE_FLAGS) {
+				if (want & state)
+					break;
+			} else if (want == state)
+				break;
+		}
+		if (i >= filter_msg->state_count)
+			return false;
+	}
+
+	if (filter_msg->partitions) {
+		char *tmp, *tok, *save_ptr = NULL;
+		bool found = false;
+
+		if (!job_ptr->partition)
+			return false;
+		tmp = xstrdup(filter_msg->partitions);
+		tok = strtok_r(tmp, ",", &save_ptr);
+		while (tok) {
+			/* a job may itself list several partitions */
+			if (_csv_contains(job_ptr->partition, tok)) {
+				found = true;
+				break;
+			}
+			tok = strtok_r(NULL, ",", &save_ptr);
+		}
+		xfree(tmp);
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
+/* Hash the bytes a job was just packed into to notice changes between
+ * polls.  The packed image depends upon the requesting uid, flags and
+ * protocol version, so with several distinct pollers a record may flap
+ * to "changed" needlessly, which costs a resend but never staleness.
+ * Returns true if the job has not changed since the update time the
+ * client presented and its record need not be sent. */
+static bool _job_unchanged(struct job_record *job_ptr, Buf buffer,
+			   uint32_t rec_offset, time_t generation)
+{
+	uint32_t hash = 2166136261u;
+	uint32_t i, end = get_buf_offset(buffer);
+	unsigned char *data = (unsigned char *) get_buf_data(buffer);
+
+	for (i = rec_offset; i < end; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	if (hash != job_ptr->diff_crc) {
+		job_ptr->diff_crc = hash;
+		job_ptr->diff_time = time(NULL);
+		return false;
+	}
+	/* strictly older: a change noticed in the same second as the
+	 * presented update time is resent rather than risk being lost */
+	return (job_ptr->diff_time < generation);
+}
+
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			  job_info_request_msg_t *filter_msg,
 			  uint16_t protocol_version)
 {
+	bool filtered = filter_msg &&
+		(filter_msg->job_id_count || filter_msg->user_count ||
+		 filter_msg->state_count || filter_msg->partitions);
+	bool diff_mode = filter_msg && filter_msg->last_update &&
+		(filter_msg->show_flags & SHOW_DIFF) &&
+		(protocol_version >= SLURM_17_02_PROTOCOL_VERSION);
+	time_t generation = filter_msg ? filter_msg->last_update : 0;
+	uint32_t *del_ids = NULL;
+	uint32_t del_cnt = 0;
+	static int high_buffer_size = BUF_SIZE;
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
+	List cand_list = NULL;
 	uint32_t jobs_packed = 0, tmp_offset;
 	Buf buffer;
 
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
-	buffer = init_buf(BUF_SIZE);
+	if (diff_mode) {
+		if (!deleted_job_horizon)
+			deleted_job_horizon = slurmctld_config.boot_time;
+		/* Deletions this far back are no longer remembered, so
+		 * the client has to get a full dump */
+		if (generation <= deleted_job_horizon)
+			diff_mode = false;
+	}
+	if (diff_mode && deleted_job_list && list_count(deleted_job_list)) {
+		deleted_job_t *del;
+		ListIterator del_itr;
+
+		del_ids = xmalloc(sizeof(uint32_t) *
+				  list_count(deleted_job_list));
+		del_itr = list_iterator_create(deleted_job_list);
+		while ((del = list_next(del_itr))) {
+			if (del->del_time >= generation)
+				del_ids[del_cnt++] = del->job_id;
+		}
+		list_iterator_destroy(del_itr);
+	}
+
+	/* Identical requests (same uid, flags and version) are common with
+	 * periodic squeue polling. Re-use the previously packed response
+	 * while nothing has changed rather than repacking every job. */
+	if ((filter_uid == NO_VAL) && !filtered && !diff_mode &&
+	    _pack_jobs_cache_lookup(buffer_ptr, buffer_size, show_flags,
+				    uid, protocol_version)) {
+		xfree(del_ids);
+		return;
+	}
+
+	/* Pre-size based upon the previous response so the buffer is
+	 * normally allocated just once */
+	buffer = init_buf(high_buffer_size);
 
 	/* write message body header : size and time */
 	/* put in a place holder job record count of 0 for now */
 	pack32(jobs_packed, buffer);
 	pack_time(time(NULL), buffer);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		pack16((uint16_t) diff_mode, buffer);
+		pack32_array(del_ids, del_cnt, buffer);
+	}
+	xfree(del_ids);
 
 	/* write individual job records */
 	part_filter_set(uid);
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+	if (filter_uid != NO_VAL) {
+		/* only enumerate this user's jobs via the user hash table */
+		job_ptr = job_user_hash[JOB_USER_HASH_INX(filter_uid)];
+		job_iterator = NULL;
+	} else if (filter_msg && filter_msg->job_id_count) {
+		/* only enumerate the requested job ids (and their array
+		 * tasks) via the hash tables */
+		cand_list = _job_id_filter_candidates(filter_msg);
+		job_iterator = list_iterator_create(cand_list);
+		job_ptr = (struct job_record *) list_next(job_iterator);
+	} else {
+		job_iterator = list_iterator_create(job_list);
+		job_ptr = (struct job_record *) list_next(job_iterator);
+	}
+	while (job_ptr) {
 		xassert (job_ptr->magic == JOB_MAGIC);
 
-		if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
-		    _all_parts_hidden(job_ptr))
-			continue;
-
-		if (_hide_job(job_ptr, uid))
-			continue;
-
-		if ((filter_uid != NO_VAL) && (filter_uid != job_ptr->user_id))
-			continue;
-
-		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
-		jobs_packed++;
+		if (((show_flags & SHOW_ALL) != 0) || (uid == 0) ||
+		    !_all_parts_hidden(job_ptr)) {
+			if (!_hide_job(job_ptr, uid) &&
+			    ((filter_uid == NO_VAL) ||
+			     (filter_uid == job_ptr->user_id)) &&
+			    (!filtered ||
+			     _job_matches_filter(job_ptr, filter_msg))) {
+				uint32_t rec_offset = get_buf_offset(buffer);
+				pack_job(job_ptr, show_flags, buffer,
+					 protocol_version, uid);
+				if (diff_mode &&
+				    _job_unchanged(job_ptr, buffer,
+						   rec_offset, generation))
+					set_buf_offset(buffer, rec_offset);
+				else
+					jobs_packed++;
+			}
+		}
+		if (job_iterator)
+			job_ptr = (struct job_record *)
+				  list_next(job_iterator);
+		else
+			job_ptr = job_ptr->job_user_next;
 	}
-	list_iterator_destroy(job_iterator);
+	if (job_iterator)
+		list_iterator_destroy(job_iterator);
+	FREE_NULL_LIST(cand_list);
 	part_filter_clear();
 
 	/* put the real record count in the message body header */
@@ -8281,6 +9473,12 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 
 	*buffer_size = get_buf_offset(buffer);
 	buffer_ptr[0] = xfer_buf_data(buffer);
+	high_buffer_size = MAX(*buffer_size, high_buffer_size);
+
+	if ((filter_uid == NO_VAL) && !filtered && !diff_mode) {
+		_pack_jobs_cache_insert(buffer_ptr[0], *buffer_size,
+					show_flags, uid, protocol_version);
+	}
 }
 
 /*
@@ -8312,6 +9510,10 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 	/* put in a place holder job record count of 0 for now */
 	pack32(jobs_packed, buffer);
 	pack_time(time(NULL), buffer);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		pack16(0, buffer);	/* diff_mode */
+		pack32_array(NULL, 0, buffer);	/* deleted ids */
+	}
 
 	job_ptr = find_job_record(job_id);
 	if (job_ptr && (job_ptr->array_task_id == NO_VAL) &&
@@ -9309,9 +10511,11 @@ static void _pack_pending_job_details(struct job_details *detail_ptr,
  */
 void purge_old_job(void)
 {
-	ListIterator job_iterator;
+	ListIterator job_iterator, cand_iterator;
 	struct job_record  *job_ptr;
-	int i;
+	purge_cand_t *cand;
+	time_t now;
+	int i, due_cnt;
 
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
@@ -9357,12 +10561,52 @@ void purge_old_job(void)
 	}
 	list_iterator_destroy(job_iterator);
 
+	/* Sweep the job list only when some finished job is actually due
+	 * for evaluation, rather than every cycle */
+	now = time(NULL);
+	due_cnt = 0;
+	if (purge_cand_list) {
+		cand_iterator = list_iterator_create(purge_cand_list);
+		while ((cand = (purge_cand_t *) list_next(cand_iterator))) {
+			if (cand->due_time <= now)
+				due_cnt++;
+		}
+		list_iterator_destroy(cand_iterator);
+	}
+	if (!due_cnt)
+		return;
+
+	_job_reclaim_start();
 	_job_purge_start();
+	purge_defer_free = purge_free_thread;
 	i = list_delete_all(job_list, &_list_find_job_old, "");
+	purge_defer_free = false;
 	if (i) {
 		debug2("purge_old_job: purged %d old job records", i);
 		last_job_update = time(NULL);
 	}
+
+	/* Drop candidates that were purged or resurrected (e.g. requeued),
+	 * re-schedule the rest */
+	cand_iterator = list_iterator_create(purge_cand_list);
+	while ((cand = (purge_cand_t *) list_next(cand_iterator))) {
+		struct job_record *cand_job_ptr;
+
+		if (cand->due_time > now)
+			continue;
+		cand_job_ptr = find_job_record(cand->job_id);
+		if (!cand_job_ptr ||
+		    (!IS_JOB_COMPLETED(cand_job_ptr) &&
+		     !IS_JOB_COMPLETING(cand_job_ptr))) {
+			list_delete_item(cand_iterator);
+		} else if (IS_JOB_COMPLETED(cand_job_ptr) &&
+			   (slurmctld_conf.min_job_age == 0)) {
+			list_delete_item(cand_iterator); /* never purged */
+		} else {
+			cand->due_time = now + PURGE_RETRY_SECS;
+		}
+	}
+	list_iterator_destroy(cand_iterator);
 }
 
 
@@ -9565,6 +10809,10 @@ static void _reset_step_bitmaps(struct job_record *job_ptr)
 	ListIterator step_iterator;
 	struct step_record *step_ptr;
 
+	/* Stale counts from before the restart, possibly for a different
+	 * node table. Rebuilt below once the bitmaps are reset. */
+	xfree(job_ptr->steps_on_node);
+
 	step_iterator = list_iterator_create (job_ptr->step_list);
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		if (step_ptr->state < JOB_RUNNING)
@@ -9589,6 +10837,7 @@ static void _reset_step_bitmaps(struct job_record *job_ptr)
 	}
 
 	list_iterator_destroy (step_iterator);
+	step_node_usage_rebuild(job_ptr);
 	return;
 }
 
@@ -11829,7 +13078,7 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 {
 	slurm_msg_t resp_msg;
 	job_desc_msg_t *job_specs = (job_desc_msg_t *) msg->data;
-	struct job_record *job_ptr, *new_job_ptr;
+	struct job_record *job_ptr, *new_job_ptr, *next_job_ptr;
 	slurm_ctl_conf_t *conf;
 	long int long_id;
 	uint32_t job_id = 0;
@@ -11917,18 +13166,35 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 		goto reply;
 	}
 
+	/* Apply the changes to pending tasks still held in META records.
+	 * The record with job_id == array_job_id is not in the array hash
+	 * tables, so check it first, then scan the hash table for secondary
+	 * META records (see job_array_split_meta()). */
 	job_ptr = find_job_record(job_id);
-	if (job_ptr && IS_JOB_PENDING(job_ptr) &&
-	    job_ptr->array_recs && job_ptr->array_recs->task_id_bitmap) {
+	next_job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+	while (job_ptr || next_job_ptr) {
+		if (!job_ptr) {
+			job_ptr = next_job_ptr;
+			next_job_ptr = next_job_ptr->job_array_next_j;
+			if ((job_ptr->array_job_id != job_id) ||
+			    (job_ptr->array_task_id != NO_VAL)) {
+				job_ptr = NULL;	/* Not a secondary META */
+				continue;
+			}
+		}
+		if (!IS_JOB_PENDING(job_ptr) || !job_ptr->array_recs ||
+		    !job_ptr->array_recs->task_id_bitmap) {
+			job_ptr = NULL;
+			continue;
+		}
 		/* Ensure bitmap sizes match for AND operations */
 		len = bit_size(job_ptr->array_recs->task_id_bitmap);
-		i_last++;
-		if (i_last < len) {
+		if (len > bit_size(array_bitmap)) {
 			array_bitmap = bit_realloc(array_bitmap, len);
-		} else {
-			array_bitmap = bit_realloc(array_bitmap, i_last);
+		} else if (len < bit_size(array_bitmap)) {
 			job_ptr->array_recs->task_id_bitmap = bit_realloc(
-				job_ptr->array_recs->task_id_bitmap, i_last);
+				job_ptr->array_recs->task_id_bitmap,
+				bit_size(array_bitmap));
 		}
 		if (!bit_overlap(job_ptr->array_recs->task_id_bitmap,
 				 array_bitmap)) {
@@ -11943,33 +13209,27 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 				job_ptr->array_recs->task_id_bitmap);
 			bit_not(job_ptr->array_recs->task_id_bitmap);
 		} else {
-			/* Need to split out tasks to separate job records */
+			/* Split the tasks to be changed out into a new
+			 * secondary META record */
 			tmp_bitmap = bit_copy(job_ptr->array_recs->
 					      task_id_bitmap);
 			bit_and(tmp_bitmap, array_bitmap);
-			i_first = bit_ffs(tmp_bitmap);
-			if (i_first >= 0)
-				i_last = bit_fls(tmp_bitmap);
-			else
-				i_last = -2;
-			for (i = i_first; i <= i_last; i++) {
-				if (!bit_test(tmp_bitmap, i))
-					continue;
-				job_ptr->array_task_id = i;
-				new_job_ptr = job_array_split(job_ptr);
-				if (!new_job_ptr) {
-					error("update_job_str: Unable to copy "
-					      "record for job %u",
-					      job_ptr->job_id);
-				} else {
-					/* The array_recs structure is moved
-					 * to the new job record copy */
-					bb_g_job_validate2(job_ptr, NULL);
-					job_ptr = new_job_ptr;
-				}
+			new_job_ptr = job_array_split_meta(job_ptr,
+							   tmp_bitmap);
+			if (!new_job_ptr) {
+				error("update_job_str: Unable to split "
+				      "record for job %u", job_ptr->job_id);
+			} else {
+				rc2 = _update_job(new_job_ptr, job_specs,
+						  uid);
+				_resp_array_add(&resp_array, new_job_ptr,
+						rc2);
+				bit_not(tmp_bitmap);
+				bit_and(array_bitmap, tmp_bitmap);
 			}
 			FREE_NULL_BITMAP(tmp_bitmap);
 		}
+		job_ptr = NULL;
 	}
 
 	i_first = bit_ffs(array_bitmap);
@@ -12838,11 +14098,27 @@ extern uint64_t job_get_tres_mem(uint32_t pn_min_memory,
  */
 extern bool job_epilog_complete(uint32_t job_id, char *node_name,
 				uint32_t return_code)
+{
+	return job_epilog_complete_ptr(find_job_record(job_id), node_name,
+				       return_code);
+}
+
+/*
+ * job_epilog_complete_ptr - as job_epilog_complete, but with the job record
+ *	already looked up. Used when applying a batch of epilog complete
+ *	messages sorted by job ID so the lookup is done once per job.
+ * IN job_ptr     - the job for which the epilog was executed, or NULL if no
+ *	matching job record exists
+ * IN node_name   - name of the node on which the epilog was executed
+ * IN return_code - return code from epilog script
+ * RET true if job is COMPLETED, otherwise false
+ */
+extern bool job_epilog_complete_ptr(struct job_record *job_ptr,
+				    char *node_name, uint32_t return_code)
 {
 #ifdef HAVE_FRONT_END
 	int i;
 #endif
-	struct job_record  *job_ptr = find_job_record(job_id);
 	struct node_record *node_ptr;
 	char jbuf[JBUFSIZ];
 
@@ -13122,6 +14398,9 @@ extern void job_completion_logger(struct job_record *job_ptr, bool requeue)
 
 	xassert(job_ptr);
 
+	if (!IS_JOB_RESIZING(job_ptr))
+		_purge_cand_enqueue(job_ptr);
+
 	acct_policy_remove_job_submit(job_ptr);
 	if (job_ptr->nodes) {
 		(void) bb_g_job_start_stage_out(job_ptr);
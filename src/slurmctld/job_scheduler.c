@@ -80,6 +80,7 @@
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/node_scheduler.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/power_save.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/proc_req.h"
@@ -107,7 +108,8 @@ typedef struct epilog_arg {
 static char **	_build_env(struct job_record *job_ptr);
 static void	_depend_list_del(void *dep_ptr);
 static void	_feature_list_delete(void *x);
-static void	_job_queue_append(List job_queue, struct job_record *job_ptr,
+static void	_job_queue_append(List job_queue, xarena_t *arena,
+				  struct job_record *job_ptr,
 				  struct part_record *part_ptr, uint32_t priority);
 static void	_job_queue_rec_del(void *x);
 static bool	_job_runnable_test1(struct job_record *job_ptr,
@@ -117,7 +119,9 @@ static bool	_job_runnable_test2(struct job_record *job_ptr,
 static void *	_run_epilog(void *arg);
 static void *	_run_prolog(void *arg);
 static bool	_scan_depend(List dependency_list, uint32_t job_id);
+static int	_find_dirty_part(void *x, void *key);
 static void *	_sched_agent(void *args);
+static int	_sched_kick(uint32_t job_limit, bool full_queue);
 static int	_schedule(uint32_t job_limit);
 static int	_valid_feature_list(struct job_record *job_ptr,
 				    List feature_list);
@@ -131,6 +135,8 @@ static int	save_last_part_update = 0;
 static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int sched_pend_thread = 0;
 static bool sched_running = false;
+static List sched_dirty_parts = NULL;	/* partitions with pending events */
+static bool sched_full_queue = true;	/* examine all partitions next pass */
 static struct timeval sched_last = {0, 0};
 static uint32_t max_array_size = NO_VAL;
 #ifdef HAVE_ALPS_CRAY
@@ -172,12 +178,13 @@ static List _build_user_job_list(uint32_t user_id, char* job_name)
 	return job_queue;
 }
 
-static void _job_queue_append(List job_queue, struct job_record *job_ptr,
+static void _job_queue_append(List job_queue, xarena_t *arena,
+			      struct job_record *job_ptr,
 			      struct part_record *part_ptr, uint32_t prio)
 {
 	job_queue_rec_t *job_queue_rec;
 
-	job_queue_rec = xmalloc(sizeof(job_queue_rec_t));
+	job_queue_rec = xarena_alloc(arena, sizeof(job_queue_rec_t));
 	job_queue_rec->array_task_id = job_ptr->array_task_id;
 	job_queue_rec->job_id   = job_ptr->job_id;
 	job_queue_rec->job_ptr  = job_ptr;
@@ -186,9 +193,80 @@ static void _job_queue_append(List job_queue, struct job_record *job_ptr,
 	list_append(job_queue, job_queue_rec);
 }
 
-static void _job_queue_rec_del(void *x)
+/* Binary max-heap over job_queue_rec_t, ordered by sort_job_queue2().
+ * The main scheduling loop typically starts or rejects only a small
+ * prefix of the queue (default_queue_depth, sched_max_job_start,
+ * timeouts), so heapify in O(n) and pop the records actually examined
+ * rather than fully sorting the queue on every pass. */
+typedef struct job_queue_heap {
+	job_queue_rec_t **recs;
+	int rec_cnt;
+} job_queue_heap_t;
+
+static void _job_queue_heap_sift(job_queue_heap_t *heap, int inx)
 {
-	xfree(x);
+	job_queue_rec_t *tmp_rec;
+	int child, swap_inx;
+
+	while ((child = (inx * 2) + 1) < heap->rec_cnt) {
+		swap_inx = inx;
+		if (sort_job_queue2(&heap->recs[child],
+				    &heap->recs[swap_inx]) < 0)
+			swap_inx = child;
+		if (((child + 1) < heap->rec_cnt) &&
+		    (sort_job_queue2(&heap->recs[child + 1],
+				     &heap->recs[swap_inx]) < 0))
+			swap_inx = child + 1;
+		if (swap_inx == inx)
+			break;
+		tmp_rec = heap->recs[inx];
+		heap->recs[inx] = heap->recs[swap_inx];
+		heap->recs[swap_inx] = tmp_rec;
+		inx = swap_inx;
+	}
+}
+
+/* Move the records of job_queue into a new heap. The heap takes
+ * ownership of the records, the (now empty) list remains owned by the
+ * caller. Free the result with _job_queue_heap_free(). */
+static job_queue_heap_t *_job_queue_heapify(List job_queue)
+{
+	job_queue_heap_t *heap;
+	job_queue_rec_t *job_queue_rec;
+	int i;
+
+	heap = xmalloc(sizeof(job_queue_heap_t));
+	heap->recs = xmalloc(sizeof(job_queue_rec_t *) *
+			     MAX(list_count(job_queue), 1));
+	while ((job_queue_rec = list_dequeue(job_queue)))
+		heap->recs[heap->rec_cnt++] = job_queue_rec;
+	for (i = (heap->rec_cnt / 2) - 1; i >= 0; i--)
+		_job_queue_heap_sift(heap, i);
+
+	return heap;
+}
+
+/* Remove and return the highest priority record, NULL when empty */
+static job_queue_rec_t *_job_queue_heap_pop(job_queue_heap_t *heap)
+{
+	job_queue_rec_t *top_rec;
+
+	if (heap->rec_cnt == 0)
+		return NULL;
+	top_rec = heap->recs[0];
+	heap->recs[0] = heap->recs[--heap->rec_cnt];
+	_job_queue_heap_sift(heap, 0);
+
+	return top_rec;
+}
+
+static void _job_queue_heap_free(job_queue_heap_t *heap)
+{
+	if (!heap)
+		return;
+	/* The records belong to the queue arena, only free the heap */
+	xfree(heap->recs);
+	xfree(heap);
 }
 
 /* Job test for ability to run now, excludes partition specific tests */
@@ -312,7 +390,7 @@ static int _delta_tv(struct timeval *tv)
  * RET the job queue
  * NOTE: the caller must call FREE_NULL_LIST() on RET value to free memory
  */
-extern List build_job_queue(bool clear_start, bool backfill)
+extern List build_job_queue(bool clear_start, bool backfill, xarena_t *arena)
 {
 	static time_t last_log_time = 0;
 	List job_queue;
@@ -327,7 +405,8 @@ extern List build_job_queue(bool clear_start, bool backfill)
 	int job_part_pairs = 0;
 
 	(void) _delta_tv(&start_tv);
-	job_queue = list_create(_job_queue_rec_del);
+	/* The records live in the caller's arena, nothing to free per node */
+	job_queue = list_create(NULL);
 
 	/* Create individual job records for job arrays that need burst buffer
 	 * staging */
@@ -463,13 +542,13 @@ extern List build_job_queue(bool clear_start, bool backfill)
 					continue;
 				job_part_pairs++;
 				if (job_ptr->priority_array) {
-					_job_queue_append(job_queue, job_ptr,
-							  part_ptr,
+					_job_queue_append(job_queue, arena,
+							  job_ptr, part_ptr,
 							  job_ptr->
 							  priority_array[inx]);
 				} else {
-					_job_queue_append(job_queue, job_ptr,
-							  part_ptr,
+					_job_queue_append(job_queue, arena,
+							  job_ptr, part_ptr,
 							  job_ptr->priority);
 				}
 			}
@@ -491,7 +570,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 			if (!_job_runnable_test2(job_ptr, backfill))
 				continue;
 			job_part_pairs++;
-			_job_queue_append(job_queue, job_ptr,
+			_job_queue_append(job_queue, arena, job_ptr,
 					  job_ptr->part_ptr, job_ptr->priority);
 		}
 	}
@@ -606,6 +685,67 @@ static bool _failed_partition(struct part_record *part_ptr,
 	return false;
 }
 
+/* Assign each partition to a conflict group such that partitions in
+ * different groups have completely disjoint node sets. Jobs in
+ * different groups can not compete for resources, so each group gets
+ * its own scheduling depth budget and a deep queue on one set of
+ * nodes does not starve jobs on unrelated nodes.
+ * IN part_ptrs - array of all partition records, part_cnt entries
+ * OUT group_ids - conflict group index for each partition
+ * RET number of conflict groups */
+static int _build_part_conflict_groups(struct part_record **part_ptrs,
+				       int *group_ids, int part_cnt)
+{
+	int i, j, k, old_id, group_cnt = 0;
+	int *new_id;
+
+	for (i = 0; i < part_cnt; i++)
+		group_ids[i] = i;
+	for (i = 0; i < part_cnt; i++) {
+		for (j = i + 1; j < part_cnt; j++) {
+			if (group_ids[j] == group_ids[i])
+				continue;
+			if (!part_ptrs[i]->node_bitmap ||
+			    !part_ptrs[j]->node_bitmap)
+				continue;
+			if (!bit_overlap(part_ptrs[i]->node_bitmap,
+					 part_ptrs[j]->node_bitmap))
+				continue;
+			old_id = group_ids[j];
+			for (k = 0; k < part_cnt; k++) {
+				if (group_ids[k] == old_id)
+					group_ids[k] = group_ids[i];
+			}
+		}
+	}
+
+	/* Renumber the group labels to 0, 1, ... group_cnt-1 */
+	new_id = xmalloc(sizeof(int) * part_cnt);
+	for (i = 0; i < part_cnt; i++) {
+		if (group_ids[i] == i)
+			new_id[i] = group_cnt++;
+	}
+	for (i = 0; i < part_cnt; i++)
+		group_ids[i] = new_id[group_ids[i]];
+	xfree(new_id);
+
+	return group_cnt;
+}
+
+/* Return the conflict group index for the given partition */
+static int _part_conflict_group(struct part_record *part_ptr,
+				struct part_record **part_ptrs,
+				int *group_ids, int part_cnt)
+{
+	int i;
+
+	for (i = 0; i < part_cnt; i++) {
+		if (part_ptrs[i] == part_ptr)
+			return group_ids[i];
+	}
+	return 0;
+}
+
 static void _do_diag_stats(long delta_t)
 {
 	if (delta_t > slurmctld_diag_stats.schedule_cycle_max)
@@ -923,7 +1063,7 @@ static bool _all_partition_priorities_same(void)
  *	order (by submit time), so the sorting should be pretty fast.
  * Note: job_write_lock must be unlocked before calling this.
  */
-extern int schedule(uint32_t job_limit)
+static int _sched_kick(uint32_t job_limit, bool full_queue)
 {
 	static int sched_job_limit = -1;
 	int job_count = 0;
@@ -944,6 +1084,8 @@ extern int schedule(uint32_t job_limit)
 	}
 
 	slurm_mutex_lock(&sched_mutex);
+	if (full_queue)
+		sched_full_queue = true;
 	if (sched_job_limit == 0)
 		;				/* leave unlimited */
 	else if (job_limit == 0)
@@ -996,6 +1138,50 @@ extern int schedule(uint32_t job_limit)
 	return job_count;
 }
 
+extern int schedule(uint32_t job_limit)
+{
+	return _sched_kick(job_limit, true);
+}
+
+/*
+ * schedule_pending - run the scheduler for the pending event requests,
+ *	limiting the pass to the partitions recorded by sched_part_dirty()
+ *	unless a full queue pass was requested since the last pass
+ * IN job_limit - maximum number of jobs to test now (0 uses the default)
+ * RET count of jobs scheduled
+ */
+extern int schedule_pending(uint32_t job_limit)
+{
+	return _sched_kick(job_limit, false);
+}
+
+/* List find function for dirty partition names */
+static int _find_dirty_part(void *x, void *key)
+{
+	return (xstrcmp((char *) x, (char *) key) == 0);
+}
+
+/*
+ * sched_part_dirty - record a scheduling event for the given partition so
+ *	that the next event-driven pass evaluates its job queue
+ * IN part_ptr - affected partition, or NULL to request a full queue pass
+ */
+extern void sched_part_dirty(struct part_record *part_ptr)
+{
+	slurm_mutex_lock(&sched_mutex);
+	if (part_ptr == NULL) {
+		sched_full_queue = true;
+	} else {
+		if (sched_dirty_parts == NULL)
+			sched_dirty_parts = list_create(slurm_destroy_char);
+		if (!list_find_first(sched_dirty_parts, _find_dirty_part,
+				     part_ptr->name))
+			list_append(sched_dirty_parts,
+				    xstrdup(part_ptr->name));
+	}
+	slurm_mutex_unlock(&sched_mutex);
+}
+
 /* Thread used to possibly start job scheduler later, if nothing else does */
 static void *_sched_agent(void *args)
 {
@@ -1004,6 +1190,8 @@ static void *_sched_agent(void *args)
 	useconds_t usec;
 	int job_cnt;
 
+	ctld_numa_bind_sched_thread();
+
 	usec = sched_min_interval / 2;
 	usec = MIN(usec, 1000000);
 	usec = MAX(usec, 10000);
@@ -1020,7 +1208,8 @@ static void *_sched_agent(void *args)
 			break;
 	}
 
-	job_cnt = schedule(1);
+	/* The full/event scope was recorded when this agent was spawned */
+	job_cnt = _sched_kick(1, false);
 	slurm_mutex_lock(&sched_mutex);
 	sched_pend_thread = 0;
 	slurm_mutex_unlock(&sched_mutex);
@@ -1091,6 +1280,8 @@ static int _schedule(uint32_t job_limit)
 {
 	ListIterator job_iterator = NULL, part_iterator = NULL;
 	List job_queue = NULL;
+	job_queue_heap_t *queue_heap = NULL;
+	xarena_t *queue_arena = NULL;
 	int failed_part_cnt = 0, failed_resv_cnt = 0, job_cnt = 0;
 	int error_code, i, j, part_cnt, time_limit, pend_time;
 	uint32_t job_depth = 0, array_task_id;
@@ -1102,6 +1293,14 @@ static int _schedule(uint32_t job_limit)
 	bitstr_t *save_avail_node_bitmap;
 	struct part_record **sched_part_ptr = NULL;
 	int *sched_part_jobs = NULL, bb_wait_cnt = 0;
+	struct part_record **group_part_ptrs = NULL;
+	int *part_group_ids = NULL;
+	uint32_t *group_depth = NULL;
+	int group_cnt = 1, job_group = 0;
+	uint64_t depth_limit;
+	bitstr_t *failed_part_nodes = NULL;
+	List dirty_parts = NULL;
+	bool full_queue = true;
 	/* Locks: Read config, write job, write node, read partition */
 	slurmctld_lock_t job_write_lock =
 	    { READ_LOCK, WRITE_LOCK, WRITE_LOCK, READ_LOCK, NO_LOCK };
@@ -1327,6 +1526,8 @@ static int _schedule(uint32_t job_limit)
 		     sched_min_interval);
 	}
 
+	prof_region_begin("schedule");
+
 	if ((defer_rpc_cnt > 0) &&
 	    (slurmctld_config.server_thread_count >= defer_rpc_cnt)) {
 		debug("sched: schedule() returning, too many RPCs");
@@ -1406,6 +1607,41 @@ static int _schedule(uint32_t job_limit)
 		list_iterator_destroy(part_iterator);
 	}
 
+	/* Group partitions by node set overlap. Partitions in different
+	 * conflict groups can not compete for resources, so each group
+	 * gets its own queue depth budget and small partitions are not
+	 * starved by a deep queue on an unrelated (big) partition. */
+	{
+		ListIterator part_iterator;
+		group_part_ptrs = xmalloc(sizeof(struct part_record *) *
+					  part_cnt);
+		part_group_ids = xmalloc(sizeof(int) * part_cnt);
+		part_iterator = list_iterator_create(part_list);
+		i = 0;
+		while ((part_ptr = (struct part_record *)
+				   list_next(part_iterator))) {
+			group_part_ptrs[i++] = part_ptr;
+		}
+		list_iterator_destroy(part_iterator);
+		group_cnt = _build_part_conflict_groups(group_part_ptrs,
+							part_group_ids,
+							part_cnt);
+		if (group_cnt < 1)
+			group_cnt = 1;
+		group_depth = xmalloc(sizeof(uint32_t) * group_cnt);
+	}
+
+	/* Consume the event set recorded since the last pass; an event
+	 * driven pass only evaluates the partitions with recorded events */
+	slurm_mutex_lock(&sched_mutex);
+	full_queue  = sched_full_queue;
+	dirty_parts = sched_dirty_parts;
+	sched_full_queue  = false;
+	sched_dirty_parts = NULL;
+	slurm_mutex_unlock(&sched_mutex);
+	if (dirty_parts == NULL)
+		full_queue = true;	/* no recorded events, test everything */
+
 	debug("sched: Running job scheduler");
 	/*
 	 * If we are doing FIFO scheduling, use the job records right off the
@@ -1420,10 +1656,14 @@ static int _schedule(uint32_t job_limit)
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_list);
 		job_iterator = list_iterator_create(job_list);
 	} else {
-		job_queue = build_job_queue(false, false);
+		prof_region_begin("sched_build_queue");
+		queue_arena = xarena_create(0);
+		job_queue = build_job_queue(false, false, queue_arena);
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
-		sort_job_queue(job_queue);
+		queue_heap = _job_queue_heapify(job_queue);
+		prof_region_end("sched_build_queue");
 	}
+	prof_region_begin("sched_job_loop");
 	while (1) {
 		if (fifo_sched) {
 			if (job_ptr && part_iterator &&
@@ -1460,14 +1700,13 @@ next_part:			part_ptr = (struct part_record *)
 					continue;
 			}
 		} else {
-			job_queue_rec = list_pop(job_queue);
+			job_queue_rec = _job_queue_heap_pop(queue_heap);
 			if (!job_queue_rec)
 				break;
 			array_task_id = job_queue_rec->array_task_id;
 			job_ptr  = job_queue_rec->job_ptr;
 			part_ptr = job_queue_rec->part_ptr;
 			job_ptr->priority = job_queue_rec->priority;
-			xfree(job_queue_rec);
 			if (!avail_front_end(job_ptr)) {
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
@@ -1485,6 +1724,11 @@ next_part:			part_ptr = (struct part_record *)
 			job_ptr->part_ptr = part_ptr;
 		}
 
+		if (!full_queue && job_ptr->part_ptr &&
+		    !list_find_first(dirty_parts, _find_dirty_part,
+				     job_ptr->part_ptr->name))
+			continue;	/* no events for this partition */
+
 		if (job_ptr->preempt_in_progress)
 			continue;	/* scheduled in another partition */
 
@@ -1543,7 +1787,25 @@ next_task:
 				continue;
 			}
 		}
-		if (job_depth++ > job_limit) {
+		if (job_ptr->part_ptr)
+			job_group = _part_conflict_group(job_ptr->part_ptr,
+							 group_part_ptrs,
+							 part_group_ids,
+							 part_cnt);
+		else
+			job_group = 0;
+		if (group_depth[job_group]++ > job_limit) {
+			/* This group of overlapping partitions has used up
+			 * its depth budget, but jobs on disjoint node sets
+			 * can still be scheduled. */
+			debug2("sched: already tested %u jobs in partition "
+			       "conflict group %d, skipping JobId=%u",
+			       group_depth[job_group] - 1, job_group,
+			       job_ptr->job_id);
+			continue;
+		}
+		depth_limit = (uint64_t) job_limit * group_cnt;
+		if (++job_depth > depth_limit) {
 			debug("sched: already tested %u jobs, breaking out",
 			       job_depth);
 			break;
@@ -1575,7 +1837,15 @@ next_task:
 				continue;
 			}
 		} else if (_failed_partition(job_ptr->part_ptr, failed_parts,
-					     failed_part_cnt)) {
+					     failed_part_cnt) ||
+			   (failed_part_nodes && job_ptr->part_ptr &&
+			    job_ptr->part_ptr->node_bitmap &&
+			    bit_super_set(job_ptr->part_ptr->node_bitmap,
+					  failed_part_nodes))) {
+			/* Also skip jobs whose partition nodes are fully
+			 * covered by failed partitions. They can not be
+			 * allocated anything, so don't waste a select call
+			 * on them. */
 			job_ptr->state_reason = WAIT_PRIORITY;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
@@ -1909,6 +2179,14 @@ next_task:
 		 	/* do not schedule more jobs in this partition or on
 			 * nodes in this partition */
 			failed_parts[failed_part_cnt++] = job_ptr->part_ptr;
+			if (failed_part_nodes) {
+				bit_or(failed_part_nodes,
+				       job_ptr->part_ptr->node_bitmap);
+			} else {
+				failed_part_nodes =
+					bit_copy(job_ptr->part_ptr->
+						 node_bitmap);
+			}
 			bit_not(job_ptr->part_ptr->node_bitmap);
 			bit_and(avail_node_bitmap,
 				job_ptr->part_ptr->node_bitmap);
@@ -1922,6 +2200,7 @@ next_task:
 			reject_state_reason = job_ptr->state_reason;
 		}
 	}
+	prof_region_end("sched_job_loop");
 
 	if (bb_wait_cnt)
 		(void) bb_g_job_try_stage_in();
@@ -1929,16 +2208,22 @@ next_task:
 	save_last_part_update = last_part_update;
 	FREE_NULL_BITMAP(avail_node_bitmap);
 	avail_node_bitmap = save_avail_node_bitmap;
+	FREE_NULL_BITMAP(failed_part_nodes);
 	xfree(unavail_node_str);
 	xfree(failed_parts);
 	xfree(failed_resv);
+	xfree(group_part_ptrs);
+	xfree(part_group_ids);
+	xfree(group_depth);
 	if (fifo_sched) {
 		if (job_iterator)
 			list_iterator_destroy(job_iterator);
 		if (part_iterator)
 			list_iterator_destroy(part_iterator);
-	} else if (job_queue) {
+	} else {
+		_job_queue_heap_free(queue_heap);
 		FREE_NULL_LIST(job_queue);
+		xarena_destroy(queue_arena);
 	}
 	xfree(sched_part_ptr);
 	xfree(sched_part_jobs);
@@ -1953,7 +2238,9 @@ next_task:
 
 	_do_diag_stats(DELTA_TIMER);
 
+	FREE_NULL_LIST(dirty_parts);
 out:
+	prof_region_end("schedule");
 #if HAVE_SYS_PRCTL_H
 	if (prctl(PR_SET_NAME, get_name, NULL, NULL, NULL) < 0) {
 		error("%s: cannot set my name to %s %m",
@@ -4170,6 +4457,10 @@ cleanup_completing(struct job_record *job_ptr)
 	job_ptr->job_state &= (~JOB_COMPLETING);
 	job_hold_requeue(job_ptr);
 
+	/* The job's resources are free, wake the scheduler for its
+	 * partition */
+	queue_part_scheduler(job_ptr->part_ptr);
+
 	slurm_sched_g_schedule();
 }
 
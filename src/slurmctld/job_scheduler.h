@@ -65,10 +65,12 @@ extern int build_feature_list(struct job_record *job_ptr);
  * build_job_queue - build (non-priority ordered) list of pending jobs
  * IN clear_start - if set then clear the start_time for pending jobs
  * IN backfill - true if running backfill scheduler, enforce min time limit
+ * IN arena - arena from which the queue records are allocated; the caller
+ *	owns it and destroys it (after the queue) to release the records
  * RET the job queue
  * NOTE: the caller must call list_destroy() on RET value to free memory
  */
-extern List build_job_queue(bool clear_start, bool backfill);
+extern List build_job_queue(bool clear_start, bool backfill, xarena_t *arena);
 
 /* Given a scheduled job, return a pointer to it batch_job_launch_msg_t data */
 extern batch_job_launch_msg_t *build_launch_job_msg(
@@ -181,6 +183,22 @@ extern bool replace_batch_job(slurm_msg_t * msg, void *fini_job, bool locked);
  */
 extern int schedule(uint32_t job_limit);
 
+/*
+ * schedule_pending - run the scheduler for the pending event requests,
+ *	limiting the pass to the partitions recorded by sched_part_dirty()
+ *	unless a full queue pass was requested since the last pass
+ * IN job_limit - maximum number of jobs to test now (0 uses the default)
+ * RET count of jobs scheduled
+ */
+extern int schedule_pending(uint32_t job_limit);
+
+/*
+ * sched_part_dirty - record a scheduling event for the given partition so
+ *	that the next event-driven pass evaluates its job queue
+ * IN part_ptr - affected partition, or NULL to request a full queue pass
+ */
+extern void sched_part_dirty(struct part_record *part_ptr);
+
 /*
  * set_job_elig_time - set the eligible time for pending jobs once their
  *	dependencies are lifted (in job->details->begin_time)
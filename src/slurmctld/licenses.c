@@ -57,9 +57,35 @@
 
 List license_list = (List) NULL;
 time_t last_license_update = 0;
-static pthread_mutex_t license_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* The license table is read on every scheduling cycle but only modified
+ * by reconfiguration or database resource updates, so readers take a
+ * shared lock and job tests do not serialize against each other */
+static pthread_rwlock_t license_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* Incremented when license_list membership may have changed, invalidating
+ * the cluster record pointers cached in job license records */
+static uint32_t license_gen = 1;
+
 static void _pack_license(struct licenses *lic, Buf buffer, uint16_t protocol_version);
 
+static void _license_rdlock(void)
+{
+	if (pthread_rwlock_rdlock(&license_rwlock))
+		fatal("pthread_rwlock_rdlock: %m");
+}
+
+static void _license_wrlock(void)
+{
+	if (pthread_rwlock_wrlock(&license_rwlock))
+		fatal("pthread_rwlock_wrlock: %m");
+}
+
+static void _license_unlock(void)
+{
+	if (pthread_rwlock_unlock(&license_rwlock))
+		fatal("pthread_rwlock_unlock: %m");
+}
+
 /* Print all licenses on a list */
 static inline void _licenses_print(char *header, List licenses, int job_id)
 {
@@ -120,6 +146,22 @@ static int _license_find_remote_rec(void *x, void *key)
 	return _license_find_rec(x, key);
 }
 
+/* Resolve a job license record to its cluster license record. The
+ * pointer cached in the job record is used when still current,
+ * otherwise it is recomputed with a name lookup. The caller must hold
+ * the license lock (read lock suffices, the cached fields are private
+ * to the job and protected by the job's own lock). */
+static licenses_t *_license_lookup(licenses_t *license_entry)
+{
+	if (license_entry->clus_gen != license_gen) {
+		license_entry->clus_ptr = (licenses_t *)
+			list_find_first(license_list, _license_find_rec,
+					license_entry->name);
+		license_entry->clus_gen = license_gen;
+	}
+	return license_entry->clus_ptr;
+}
+
 /* Given a license string, return a list of license_t records */
 static List _build_license_list(char *licenses, bool *valid)
 {
@@ -203,7 +245,7 @@ static char * _build_license_string(List license_list)
 	return licenses;
 }
 
-/* license_mutex should be locked before calling this. */
+/* The license write lock should be held before calling this. */
 static void _add_res_rec_2_lic_list(slurmdb_res_rec_t *rec, bool sync)
 {
 	licenses_t *license_entry = xmalloc(sizeof(licenses_t));
@@ -224,7 +266,7 @@ extern char *get_licenses_used(void)
 	licenses_t *license_entry;
 	ListIterator iter;
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	if (license_list) {
 		iter = list_iterator_create(license_list);
 		while ((license_entry = (licenses_t *) list_next(iter))) {
@@ -236,7 +278,7 @@ extern char *get_licenses_used(void)
 		}
 		list_iterator_destroy(iter);
 	}
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 
 	return licenses_used;
 }
@@ -249,7 +291,7 @@ extern int license_init(char *licenses)
 
 	last_license_update = time(NULL);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	if (license_list)
 		fatal("license_list already defined");
 
@@ -258,7 +300,8 @@ extern int license_init(char *licenses)
 		fatal("Invalid configured licenses: %s", licenses);
 
 	_licenses_print("init_license", license_list, 0);
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 	return SLURM_SUCCESS;
 }
 
@@ -275,10 +318,11 @@ extern int license_update(char *licenses)
         if (!valid)
                 fatal("Invalid configured licenses: %s", licenses);
 
-        slurm_mutex_lock(&license_mutex);
+        _license_wrlock();
         if (!license_list) {        /* no licenses before now */
                 license_list = new_list;
-                slurm_mutex_unlock(&license_mutex);
+                license_gen++;
+        _license_unlock();
                 return SLURM_SUCCESS;
         }
 
@@ -315,7 +359,8 @@ extern int license_update(char *licenses)
         FREE_NULL_LIST(license_list);
         license_list = new_list;
         _licenses_print("update_license", license_list, 0);
-        slurm_mutex_unlock(&license_mutex);
+        license_gen++;
+        _license_unlock();
         return SLURM_SUCCESS;
 }
 
@@ -330,7 +375,7 @@ extern void license_add_remote(slurmdb_res_rec_t *rec)
 
 	name = xstrdup_printf("%s@%s", rec->name, rec->server);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	if (!license_list) {
 		/* If last_license_update then init already ran and we
 		 * don't have any licenses defined in the slurm.conf
@@ -350,7 +395,8 @@ extern void license_add_remote(slurmdb_res_rec_t *rec)
 
 	xfree(name);
 
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 }
 
 extern void license_update_remote(slurmdb_res_rec_t *rec)
@@ -364,7 +410,7 @@ extern void license_update_remote(slurmdb_res_rec_t *rec)
 
 	name = xstrdup_printf("%s@%s", rec->name, rec->server);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	if (!license_list) {
 		/* If last_license_update then init already ran and we
 		 * don't have any licenses defined in the slurm.conf
@@ -394,7 +440,8 @@ extern void license_update_remote(slurmdb_res_rec_t *rec)
 
 	xfree(name);
 
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 }
 
 extern void license_remove_remote(slurmdb_res_rec_t *rec)
@@ -406,7 +453,7 @@ extern void license_remove_remote(slurmdb_res_rec_t *rec)
 	xassert(rec);
 	xassert(rec->type == SLURMDB_RESOURCE_LICENSE);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	if (!license_list) {
 		xassert(last_license_update);
 		license_list = list_create(license_free_rec);
@@ -433,7 +480,8 @@ extern void license_remove_remote(slurmdb_res_rec_t *rec)
 		error("license_remote_remote: License '%s' not found", name);
 
 	xfree(name);
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 }
 
 extern void license_sync_remote(List res_list)
@@ -442,7 +490,7 @@ extern void license_sync_remote(List res_list)
 	licenses_t *license_entry;
 	ListIterator iter;
 
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	if (res_list && !license_list) {
 		xassert(last_license_update);
 		license_list = list_create(license_free_rec);
@@ -497,15 +545,17 @@ extern void license_sync_remote(List res_list)
 	}
 	list_iterator_destroy(iter);
 
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 }
 
 /* Free memory associated with licenses on this system */
 extern void license_free(void)
 {
-	slurm_mutex_lock(&license_mutex);
+	_license_wrlock();
 	FREE_NULL_LIST(license_list);
-	slurm_mutex_unlock(&license_mutex);
+	license_gen++;
+	_license_unlock();
 }
 
 /*
@@ -539,7 +589,7 @@ extern List license_validate(char *licenses,
 		tres_req.type = "license";
 	}
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	_licenses_print("request_license", job_license_list, 0);
 	iter = list_iterator_create(job_license_list);
 	while ((license_entry = (licenses_t *) list_next(iter))) {
@@ -571,7 +621,7 @@ extern List license_validate(char *licenses,
 		}
 	}
 	list_iterator_destroy(iter);
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 
 	if (!(*valid)) {
 		FREE_NULL_LIST(job_license_list);
@@ -610,11 +660,10 @@ extern int license_job_test(struct job_record *job_ptr, time_t when)
 	if (!job_ptr->license_list)	/* no licenses needed */
 		return rc;
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (!match) {
 			error("could not find license %s for job %u",
 			      license_entry->name, job_ptr->job_id);
@@ -641,7 +690,7 @@ extern int license_job_test(struct job_record *job_ptr, time_t when)
 		}
 	}
 	list_iterator_destroy(iter);
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 	return rc;
 }
 
@@ -687,13 +736,13 @@ extern int license_job_get(struct job_record *job_ptr)
 
 	last_license_update = time(NULL);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (match) {
-			match->used += license_entry->total;
+			(void) __sync_fetch_and_add(&match->used,
+						    license_entry->total);
 			license_entry->used += license_entry->total;
 		} else {
 			error("could not find license %s for job %u",
@@ -703,7 +752,7 @@ extern int license_job_get(struct job_record *job_ptr)
 	}
 	list_iterator_destroy(iter);
 	_licenses_print("acquire_license", license_list, job_ptr->job_id);
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 	return rc;
 }
 
@@ -723,18 +772,20 @@ extern int license_job_return(struct job_record *job_ptr)
 
 	last_license_update = time(NULL);
 	trace_job(job_ptr, __func__, "");
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (match) {
-			if (match->used >= license_entry->total)
-				match->used -= license_entry->total;
-			else {
+			uint32_t old_used;
+			old_used = __sync_fetch_and_sub(
+				&match->used, license_entry->total);
+			if (old_used < license_entry->total) {
 				error("%s: license use count underflow for %s",
 				      __func__, match->name);
-				match->used = 0;
+				(void) __sync_fetch_and_add(
+					&match->used,
+					license_entry->total - old_used);
 				rc = SLURM_ERROR;
 			}
 			license_entry->used = 0;
@@ -746,7 +797,7 @@ extern int license_job_return(struct job_record *job_ptr)
 	}
 	list_iterator_destroy(iter);
 	_licenses_print("return_license", license_list, job_ptr->job_id);
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 	return rc;
 }
 
@@ -806,7 +857,7 @@ get_all_license_info(char **buffer_ptr,
 	pack32(lics_packed, buffer);
 	pack_time(now, buffer);
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	if (license_list) {
 		iter = list_iterator_create(license_list);
 		while ((lic_entry = list_next(iter))) {
@@ -818,7 +869,7 @@ get_all_license_info(char **buffer_ptr,
 		list_iterator_destroy(iter);
 	}
 
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 	debug2("%s: processed %d licenses", __func__, lics_packed);
 
 	/* put the real record count in the message body header
@@ -837,7 +888,7 @@ extern uint32_t get_total_license_cnt(char *name)
 	uint32_t count = 0;
 	licenses_t *lic;
 
-	slurm_mutex_lock(&license_mutex);
+	_license_rdlock();
 	if (license_list) {
 		lic = list_find_first(
 			license_list, _license_find_rec, name);
@@ -845,7 +896,7 @@ extern uint32_t get_total_license_cnt(char *name)
 		if (lic)
 			count = lic->total;
 	}
-	slurm_mutex_unlock(&license_mutex);
+	_license_unlock();
 
 	return count;
 }
@@ -47,6 +47,13 @@ typedef struct licenses {
 	uint32_t	total;		/* total license configued */
 	uint32_t	used;		/* used licenses */
 	uint8_t         remote;	        /* non-zero if remote (from database) */
+	struct licenses *clus_ptr;	/* for job license records, cached
+					 * pointer to the matching cluster
+					 * license record */
+	uint32_t	clus_gen;	/* license table generation at which
+					 * clus_ptr was resolved, stale and
+					 * recomputed when it differs from
+					 * the current generation */
 } licenses_t;
 
 extern List license_list;
@@ -40,17 +40,21 @@
 #include <errno.h>
 #include <pthread.h>
 #include <string.h>
+#include <sys/time.h>
 #include <sys/types.h>
 
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 
-static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
+static pthread_rwlock_t slurmctld_rwlocks[ENTITY_COUNT];
+static pthread_mutex_t counts_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static slurmctld_lock_flags_t slurmctld_locks;
-static int kill_thread = 0;
+static slurmctld_lock_stats_t lock_stats;
+/* Time at which the current writer acquired each lock. There is at most
+ * one writer per data type, so no further synchronization is needed. */
+static uint64_t wr_acquire_time[ENTITY_COUNT];
 
 static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock);
 static void _wr_rdunlock(lock_datatype_t datatype);
@@ -61,7 +65,23 @@ static void _wr_wrunlock(lock_datatype_t datatype);
  *	control */
 void init_locks(void)
 {
-	/* just clear all semaphores */
+	pthread_rwlockattr_t attr;
+	int i;
+
+	pthread_rwlockattr_init(&attr);
+#ifdef PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP
+	/* Preserve the writer preference of the old condition variable
+	 * based implementation, a steady stream of read locks must not
+	 * starve state changing RPCs */
+	pthread_rwlockattr_setkind_np(
+		&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		if (pthread_rwlock_init(&slurmctld_rwlocks[i], &attr))
+			fatal("pthread_rwlock_init: %m");
+	}
+	pthread_rwlockattr_destroy(&attr);
+
 	memset((void *) &slurmctld_locks, 0, sizeof(slurmctld_locks));
 }
 
@@ -212,90 +232,97 @@ extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
 		_wr_wrunlock(CONFIG_LOCK);
 }
 
-/* _wr_rdlock - Issue a read lock on the specified data type
- *	Wait until there are no write locks AND
- *	no pending write locks (write_wait_lock == 0)
- *
- *	NOTE: Always favoring write locks can result in starvation for
- *	read locks. To prevent this, read locks were permitted to be satisified
- *	after 10 consecutive write locks. This prevented starvation, but
- *	deadlock has been observed with some values for the count. */
-static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
+/* Adjust the lock counts reported by get_lock_values(). The counts are
+ * diagnostic only (e.g. report_locks_set()), the locking itself is done
+ * by the pthread rwlocks. */
+static void _count_adjust(int entity_inx, int cnt)
 {
-	bool success = true;
+	slurm_mutex_lock(&counts_mutex);
+	slurmctld_locks.entity[entity_inx] += cnt;
+	slurm_mutex_unlock(&counts_mutex);
+}
 
-	slurm_mutex_lock(&locks_mutex);
-	while (1) {
-#if 1
-		if ((slurmctld_locks.entity[write_lock(datatype)] == 0) &&
-		    (slurmctld_locks.entity[write_wait_lock(datatype)] == 0)) {
-#else
-		/* SEE NOTE ABOVE */
-		if ((slurmctld_locks.entity[write_lock(datatype)] == 0) &&
-		    ((slurmctld_locks.entity[write_wait_lock(datatype)] == 0) ||
-		     (slurmctld_locks.entity[write_cnt_lock(datatype)] > 10))) {
-#endif
-			slurmctld_locks.entity[read_lock(datatype)]++;
-			slurmctld_locks.entity[write_cnt_lock(datatype)] = 0;
-			break;
-		} else if (!wait_lock) {
-			success = false;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-			if (kill_thread)
-				pthread_exit(NULL);
-		}
+/* _lock_time - Microsecond timestamp for the lock statistics */
+static uint64_t _lock_time(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return ((uint64_t) tv.tv_sec * 1000000) + tv.tv_usec;
+}
+
+/* _stats_acquired - Record a lock acquisition and the time spent
+ *	blocked waiting for it */
+static void _stats_acquired(lock_datatype_t datatype, bool writer,
+			    uint64_t wait_time)
+{
+	slurm_mutex_lock(&counts_mutex);
+	if (writer) {
+		lock_stats.write_cnt[datatype]++;
+		lock_stats.write_wait[datatype] += wait_time;
+	} else {
+		lock_stats.read_cnt[datatype]++;
+		lock_stats.read_wait[datatype] += wait_time;
 	}
-	slurm_mutex_unlock(&locks_mutex);
-	return success;
+	slurm_mutex_unlock(&counts_mutex);
+}
+
+/* _wr_rdlock - Issue a read lock on the specified data type */
+static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
+{
+	uint64_t start_time = _lock_time();
+
+	if (wait_lock) {
+		if (pthread_rwlock_rdlock(&slurmctld_rwlocks[datatype]))
+			fatal("pthread_rwlock_rdlock: %m");
+	} else if (pthread_rwlock_tryrdlock(&slurmctld_rwlocks[datatype]))
+		return false;
+
+	_stats_acquired(datatype, false, _lock_time() - start_time);
+	_count_adjust(read_lock(datatype), 1);
+	return true;
 }
 
 /* _wr_rdunlock - Issue a read unlock on the specified data type */
 static void _wr_rdunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
-	slurmctld_locks.entity[read_lock(datatype)]--;
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	_count_adjust(read_lock(datatype), -1);
+	if (pthread_rwlock_unlock(&slurmctld_rwlocks[datatype]))
+		fatal("pthread_rwlock_unlock: %m");
 }
 
 /* _wr_wrlock - Issue a write lock on the specified data type */
 static bool _wr_wrlock(lock_datatype_t datatype, bool wait_lock)
 {
-	bool success = true;
-
-	slurm_mutex_lock(&locks_mutex);
-	slurmctld_locks.entity[write_wait_lock(datatype)]++;
-
-	while (1) {
-		if ((slurmctld_locks.entity[read_lock(datatype)] == 0) &&
-		    (slurmctld_locks.entity[write_lock(datatype)] == 0)) {
-			slurmctld_locks.entity[write_lock(datatype)]++;
-			slurmctld_locks.entity[write_wait_lock(datatype)]--;
-			slurmctld_locks.entity[write_cnt_lock(datatype)]++;
-			break;
-		} else if (!wait_lock) {
-			slurmctld_locks.entity[write_wait_lock(datatype)]--;
-			success = false;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-			if (kill_thread)
-				pthread_exit(NULL);
-		}
-	}
-	slurm_mutex_unlock(&locks_mutex);
-	return success;
+	uint64_t start_time = _lock_time();
+
+	if (wait_lock) {
+		_count_adjust(write_wait_lock(datatype), 1);
+		if (pthread_rwlock_wrlock(&slurmctld_rwlocks[datatype]))
+			fatal("pthread_rwlock_wrlock: %m");
+		_count_adjust(write_wait_lock(datatype), -1);
+	} else if (pthread_rwlock_trywrlock(&slurmctld_rwlocks[datatype]))
+		return false;
+
+	wr_acquire_time[datatype] = _lock_time();
+	_stats_acquired(datatype, true,
+			wr_acquire_time[datatype] - start_time);
+	_count_adjust(write_lock(datatype), 1);
+	return true;
 }
 
 /* _wr_wrunlock - Issue a write unlock on the specified data type */
 static void _wr_wrunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
-	slurmctld_locks.entity[write_lock(datatype)]--;
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	uint64_t hold_time = _lock_time() - wr_acquire_time[datatype];
+
+	slurm_mutex_lock(&counts_mutex);
+	lock_stats.write_hold[datatype] += hold_time;
+	slurm_mutex_unlock(&counts_mutex);
+
+	_count_adjust(write_lock(datatype), -1);
+	if (pthread_rwlock_unlock(&slurmctld_rwlocks[datatype]))
+		fatal("pthread_rwlock_unlock: %m");
 }
 
 /* get_lock_values - Get the current value of all locks
@@ -303,15 +330,35 @@ static void _wr_wrunlock(lock_datatype_t datatype)
 void get_lock_values(slurmctld_lock_flags_t * lock_flags)
 {
 	xassert(lock_flags);
+	slurm_mutex_lock(&counts_mutex);
 	memcpy((void *) lock_flags, (void *) &slurmctld_locks,
 	       sizeof(slurmctld_locks));
+	slurm_mutex_unlock(&counts_mutex);
+}
+
+/* get_lock_stats - Get accumulated lock wait/hold statistics
+ * OUT stats - a copy of the current counters */
+extern void get_lock_stats(slurmctld_lock_stats_t * stats)
+{
+	xassert(stats);
+	slurm_mutex_lock(&counts_mutex);
+	memcpy((void *) stats, (void *) &lock_stats, sizeof(lock_stats));
+	slurm_mutex_unlock(&counts_mutex);
+}
+
+/* reset_lock_stats - Zero accumulated lock wait/hold statistics */
+extern void reset_lock_stats(void)
+{
+	slurm_mutex_lock(&counts_mutex);
+	memset((void *) &lock_stats, 0, sizeof(lock_stats));
+	slurm_mutex_unlock(&counts_mutex);
 }
 
-/* kill_locked_threads - Kill all threads waiting on semaphores */
+/* kill_locked_threads - Kill all threads waiting on semaphores
+ * NOTE: Obsolete with the pthread rwlock implementation, waiters can
+ * not be cancelled from here. Retained as a no-op for the API. */
 extern void kill_locked_threads(void)
 {
-	kill_thread = 1;
-	slurm_cond_broadcast(&locks_cond);
 }
 
 /* un/lock semaphore used for saving state of slurmctld */
@@ -37,43 +37,19 @@
 \*****************************************************************************/
 
 /*****************************************************************************\
- * Read/write locks are implemented by the routines in this directory by using
- * a set of three (3) UNIX semaphores to lock a resource.
+ * Read/write locks are implemented with one native pthread rwlock per
+ * data type (config, job, node, partition, federation). Readers of
+ * unrelated data types no longer serialize on a common mutex as they
+ * did with the older condition variable implementation.
  *
- * The set of three (3) semaphores represent a reader semaphore,
- * a writer semaphore and a writers waiting semaphore.
+ * Where supported, the rwlocks are initialized with writer preference
+ * to match the behavior of the previous implementation: a reader can
+ * not acquire a lock while a writer is waiting for it, so a steady
+ * stream of read-only RPCs can not starve state changes.
  *
- * The reader semaphore indicates the number of readers that currently have a
- * read lock on the resource.
- * The writers semaphore indicates that a writer has the resource locked.
- * The writers waiting semaphore indicates the number of writers waiting to
- * lock the resource.
- *
- * Readers cannot lock the resource until there are no writers waiting for the
- * resource and the resource is not locked by a writer.
- *
- * Writers cannot lock the resource if the resource is locked by other writers
- * or if any readers have the resource locked.
- *
- * Writers will have priority in locking the resource over readers because
- * of the writers waiting semaphore.  The writers waiting semaphore is incremented
- * by a writer that is waiting to lock the resource.  A reader cannot lock
- * the resource until there are no writers waiting to lock the resource and
- * the resource is not locked by a writer.
- *
- * So, if the resource is locked by an unspecified number of readers,
- * and a writer trys to lock the resource, then the writer will be blocked
- * until all of the previous readers have unlocked the resource.  But,
- * just before the writer checked to see if there were any readers locking
- * the resource, the writer incremented the writers waiting semaphore,
- * indicating that there is now a writer waiting to lock the resource.
- * In the mean time, if an unspecified number of readers try to lock the
- * resource after a writer (or writers) has tried to lock the resource,
- * those readers will be blocked until all writers have obtained the lock on
- * the resource, used the resource and unlocked the resource.  The subsequent
- * unspecified number of readers are blocked because they are waiting for the
- * number of writers waiting semaphore to become 0, meaning that there are no
- * writers waiting to lock the resource.
+ * The lock counts reported by get_lock_values() are maintained
+ * separately for diagnostic purposes (see report_locks_set()) and are
+ * not used for synchronization.
  *
  * use init_locks() to initialize the locks then
  * lock_slurmctld() and unlock_slurmctld() to get the ordering so as to
@@ -91,6 +67,8 @@
 #ifndef _SLURMCTLD_LOCKS_H
 #define _SLURMCTLD_LOCKS_H
 
+#include <inttypes.h>
+
 /* levels of locking required for each data structure */
 typedef enum {
 	NO_LOCK,
@@ -134,11 +112,29 @@ typedef struct {
 	int entity[ENTITY_COUNT * 4];
 }	slurmctld_lock_flags_t;
 
+/* Accumulated lock contention statistics, all times in microseconds.
+ * Read lock hold times are not tracked, multiple readers hold a lock
+ * concurrently so no single holder owns the interval. */
+typedef struct {
+	uint64_t read_cnt[ENTITY_COUNT];   /* read lock acquisitions */
+	uint64_t read_wait[ENTITY_COUNT];  /* time blocked getting read locks */
+	uint64_t write_cnt[ENTITY_COUNT];  /* write lock acquisitions */
+	uint64_t write_wait[ENTITY_COUNT]; /* time blocked getting write locks */
+	uint64_t write_hold[ENTITY_COUNT]; /* time write locks were held */
+}	slurmctld_lock_stats_t;
+
 
 /* get_lock_values - Get the current value of all locks
  * OUT lock_flags - a copy of the current lock values */
 extern void get_lock_values (slurmctld_lock_flags_t *lock_flags);
 
+/* get_lock_stats - Get accumulated lock wait/hold statistics
+ * OUT stats - a copy of the current counters */
+extern void get_lock_stats (slurmctld_lock_stats_t *stats);
+
+/* reset_lock_stats - Zero accumulated lock wait/hold statistics */
+extern void reset_lock_stats ( void );
+
 /* init_locks - create locks used for slurmctld data structure access
  *	control */
 extern void init_locks ( void );
@@ -98,6 +98,17 @@ bitstr_t *power_node_bitmap = NULL;	/* bitmap of powered down nodes */
 bitstr_t *share_node_bitmap = NULL;  	/* bitmap of sharable nodes */
 bitstr_t *up_node_bitmap    = NULL;  	/* bitmap of non-down nodes */
 
+/* Cache of the last packed node table, replayed while node and partition
+ * state are unchanged. Only responses with uid-independent node visibility
+ * are cached (see _pack_cache_usable()). */
+static pthread_mutex_t pack_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char *	pack_cache_data = NULL;
+static int	pack_cache_size = 0;
+static time_t	pack_cache_node_time = (time_t) 0;
+static time_t	pack_cache_part_time = (time_t) 0;
+static uint16_t	pack_cache_show_flags = 0;
+static uint16_t	pack_cache_protocol_version = 0;
+
 static void 	_dump_node_state (struct node_record *dump_node_ptr,
 				  Buf buffer);
 static front_end_record_t * _front_end_reg(
@@ -107,6 +118,7 @@ static void 	_make_node_down(struct node_record *node_ptr,
 				time_t event_time);
 static bool	_node_is_hidden(struct node_record *node_ptr, uid_t uid);
 static int	_open_node_state_file(char **state_file);
+static bool	_pack_cache_usable(uint16_t show_flags, uid_t uid);
 static void 	_pack_node(struct node_record *dump_node_ptr, Buf buffer,
 			   uint16_t protocol_version, uint16_t show_flags);
 static void	_sync_bitmaps(struct node_record *node_ptr, int job_count);
@@ -118,6 +130,9 @@ static int	_update_node_avail_features(char *node_names,
 				char *avail_features);
 static int	_update_node_gres(char *node_names, char *gres);
 static int	_update_node_weight(char *node_names, uint32_t weight);
+static int	_validate_node_config(struct node_record *node_ptr,
+				slurm_node_registration_status_msg_t *reg_msg,
+				char **reason_down);
 static bool 	_valid_node_state_change(uint32_t old, uint32_t new);
 
 
@@ -201,6 +216,7 @@ int dump_all_node_state ( void )
 	xfree (new_file);
 	unlock_state_files ();
 
+	stream_state_file("node_state", buffer);
 	free_buf (buffer);
 	END_TIMER2("dump_all_node_state");
 	return error_code;
@@ -282,22 +298,22 @@ static int _open_node_state_file(char **state_file)
 extern int load_all_node_state ( bool state_only )
 {
 	char *comm_name = NULL, *node_hostname = NULL;
-	char *node_name = NULL, *reason = NULL, *data = NULL, *state_file;
+	char *node_name = NULL, *reason = NULL, *state_file;
 	char *features = NULL, *features_act = NULL;
 	char *gres = NULL, *cpu_spec_list = NULL;
 	char *mcs_label = NULL;
-	int data_allocated, data_read = 0, error_code = 0, node_cnt = 0;
+	int error_code = 0, node_cnt = 0;
 	uint16_t core_spec_cnt = 0;
 	uint32_t node_state;
 	uint16_t cpus = 1, boards = 1, sockets = 1, cores = 1, threads = 1;
-	uint32_t real_memory, tmp_disk, data_size = 0, name_len;
+	uint32_t real_memory, tmp_disk, name_len;
 	uint32_t reason_uid = NO_VAL, mem_spec_limit = 0;
 	time_t reason_time = 0;
 	List gres_list = NULL;
 	struct node_record *node_ptr;
 	int state_fd;
 	time_t time_stamp, now = time(NULL);
-	Buf buffer;
+	Buf buffer = NULL;
 	char *ver_str = NULL;
 	hostset_t hs = NULL;
 	bool power_save_mode = false;
@@ -314,30 +330,16 @@ extern int load_all_node_state ( bool state_only )
 		error_code = ENOENT;
 	}
 	else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size], BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error ("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
-		close (state_fd);
+		(void) close(state_fd);
+		if (!(buffer = create_mmap_buf(state_file)))
+			error("Can not map node state file %s: %m",
+			      state_file);
 	}
 	xfree (state_file);
 	unlock_state_files ();
 
-	buffer = create_buf (data, data_size);
+	if (!buffer)	/* preserve the empty buffer unpack error path */
+		buffer = create_buf(NULL, 0);
 
 	safe_unpackstr_xmalloc( &ver_str, &name_len, buffer);
 	debug3("Version string in node_state header is %s", ver_str);
@@ -469,6 +471,7 @@ extern int load_all_node_state ( bool state_only )
 					slurm_reset_alias(node_ptr->name,
 							  node_ptr->comm_name,
 							  node_ptr->node_hostname);
+					reset_node_addr_hashes();
 				}
 				node_ptr->node_state    = node_state;
 			} else if (IS_NODE_UNKNOWN(node_ptr)) {
@@ -589,6 +592,7 @@ extern int load_all_node_state ( bool state_only )
 				slurm_reset_alias(node_ptr->name,
 						  node_ptr->comm_name,
 						  node_ptr->node_hostname);
+				reset_node_addr_hashes();
 			}
 			node_ptr->node_state    = node_state;
 			xfree(node_ptr->reason);
@@ -725,6 +729,22 @@ static bool _node_is_hidden(struct node_record *node_ptr, uid_t uid)
 	return true;
 }
 
+/* Determine if a packed node table built for this request would be
+ * identical for every user, in which case it may be served from and
+ * stored in the pack cache. Visibility is uid-independent if the hidden
+ * node filter is skipped (SHOW_ALL or user root) or could not hide
+ * anything (no partition hidden from this user, no MCS label filtering).
+ * NOTE: call after part_filter_set() so per-user hidden flags are set */
+static bool _pack_cache_usable(uint16_t show_flags, uid_t uid)
+{
+	if ((slurmctld_conf.private_data & PRIVATE_DATA_NODES) &&
+	    (slurm_mcs_get_privatedata() == 1))
+		return false;
+	if ((show_flags & SHOW_ALL) || (uid == 0))
+		return true;
+	return !part_any_hidden();
+}
+
 /*
  * pack_all_node - dump all configuration and node information for all nodes
  *	in machine independent form (for network transmission)
@@ -743,17 +763,43 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid,
 			   uint16_t protocol_version)
 {
+	static int high_buffer_size = BUF_SIZE * 16;
 	int inx;
 	uint32_t nodes_packed, tmp_offset, node_scaling;
 	Buf buffer;
 	time_t now = time(NULL);
 	struct node_record *node_ptr = node_record_table_ptr;
-	bool hidden;
+	bool hidden, cacheable;
 
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
-	buffer = init_buf (BUF_SIZE*16);
+	part_filter_set(uid);
+
+	/* Replay the cached response if node and partition state are
+	 * unchanged since it was built */
+	cacheable = _pack_cache_usable(show_flags, uid);
+	if (cacheable) {
+		slurm_mutex_lock(&pack_cache_mutex);
+		if (pack_cache_data &&
+		    (pack_cache_node_time == last_node_update) &&
+		    (pack_cache_part_time == last_part_update) &&
+		    (pack_cache_show_flags == show_flags) &&
+		    (pack_cache_protocol_version == protocol_version)) {
+			*buffer_size = pack_cache_size;
+			buffer_ptr[0] = xmalloc_nz(pack_cache_size);
+			memcpy(buffer_ptr[0], pack_cache_data,
+			       pack_cache_size);
+			slurm_mutex_unlock(&pack_cache_mutex);
+			part_filter_clear();
+			return;
+		}
+		slurm_mutex_unlock(&pack_cache_mutex);
+	}
+
+	/* Pre-size based upon the previous response so the buffer is
+	 * normally allocated just once */
+	buffer = init_buf (high_buffer_size);
 	nodes_packed = 0;
 
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
@@ -766,7 +812,6 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 		pack_time(now, buffer);
 
 		/* write node records */
-		part_filter_set(uid);
 		for (inx = 0; inx < node_record_count; inx++, node_ptr++) {
 			xassert (node_ptr->magic == NODE_MAGIC);
 			xassert (node_ptr->config_ptr->magic ==
@@ -800,11 +845,11 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			}
 			nodes_packed++;
 		}
-		part_filter_clear();
 	} else {
 		error("select_g_select_jobinfo_pack: protocol_version "
 		      "%hu not supported", protocol_version);
 	}
+	part_filter_clear();
 
 	tmp_offset = get_buf_offset (buffer);
 	set_buf_offset (buffer, 0);
@@ -813,6 +858,20 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 
 	*buffer_size = get_buf_offset (buffer);
 	buffer_ptr[0] = xfer_buf_data (buffer);
+	high_buffer_size = MAX(*buffer_size, high_buffer_size);
+
+	if (cacheable && nodes_packed) {
+		slurm_mutex_lock(&pack_cache_mutex);
+		xfree(pack_cache_data);
+		pack_cache_size = *buffer_size;
+		pack_cache_data = xmalloc_nz(pack_cache_size);
+		memcpy(pack_cache_data, buffer_ptr[0], pack_cache_size);
+		pack_cache_node_time = last_node_update;
+		pack_cache_part_time = last_part_update;
+		pack_cache_show_flags = show_flags;
+		pack_cache_protocol_version = protocol_version;
+		slurm_mutex_unlock(&pack_cache_mutex);
+	}
 }
 
 /*
@@ -1270,6 +1329,7 @@ int update_node ( update_node_msg_t * update_node_msg )
 			/* This updates the lookup table addresses */
 			slurm_reset_alias(node_ptr->name, node_ptr->comm_name,
 					  node_ptr->node_hostname);
+			reset_node_addr_hashes();
 		}
 
 		if (update_node_msg->features) {
@@ -2138,52 +2198,22 @@ static void _split_node_config(struct node_record *node_ptr,
 }
 
 /*
- * validate_node_specs - validate the node's specifications as valid,
- *	if not set state to down, in any case update last_response
- * IN reg_msg - node registration message
- * IN protocol_version - Version of Slurm on this node
- * OUT newly_up - set if node newly brought into service
- * RET 0 if no error, ENOENT if no such node, EINVAL if values too low
- * NOTE: READ lock_slurmctld config before entry
+ * _validate_node_config - validate the static configuration portion of a
+ *	node registration message and update the node record accordingly.
+ *	Skipped entirely for delta registrations, which carry only a digest
+ *	of this data.
  */
-extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
-			       uint16_t protocol_version, bool *newly_up)
+static int _validate_node_config(struct node_record *node_ptr,
+				 slurm_node_registration_status_msg_t *reg_msg,
+				 char **reason_down)
 {
-	int error_code, i, node_inx;
-	struct config_record *config_ptr;
-	struct node_record *node_ptr;
-	char *reason_down = NULL, *tmp_str;
-	uint32_t node_flags;
-	time_t boot_req_time, now = time(NULL);
+	int error_code = SLURM_SUCCESS, i;
+	struct config_record *config_ptr = node_ptr->config_ptr;
+	char *tmp_str;
 	bool gang_flag = false;
-	bool orig_node_avail;
 	static uint32_t cr_flag = NO_VAL;
 	int *cpu_spec_array;
 
-	node_ptr = find_node_record (reg_msg->node_name);
-	if (node_ptr == NULL)
-		return ENOENT;
-	node_inx = node_ptr - node_record_table_ptr;
-	orig_node_avail = bit_test(avail_node_bitmap, node_inx);
-
-	config_ptr = node_ptr->config_ptr;
-	error_code = SLURM_SUCCESS;
-
-	node_ptr->protocol_version = protocol_version;
-	xfree(node_ptr->version);
-	node_ptr->version = reg_msg->version;
-	reg_msg->version = NULL;
-
-	if (IS_NODE_POWER_UP(node_ptr)) {
-		boot_req_time = node_ptr->last_response -
-				slurm_get_resume_timeout();
-		if (node_ptr->boot_time < boot_req_time) {
-			debug("Still waiting for boot of node %s",
-			      node_ptr->name);
-			return SLURM_SUCCESS;
-		}
-	}
-
 	if (cr_flag == NO_VAL) {
 		cr_flag = 0;  /* call is no-op for select/linear and bluegene */
 		if (select_g_get_info_from_plugin(SELECT_CR_PLUGIN,
@@ -2214,11 +2244,11 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 	if (gres_plugin_node_config_unpack(reg_msg->gres_info,
 					   node_ptr->name) != SLURM_SUCCESS) {
 		error_code = SLURM_ERROR;
-		xstrcat(reason_down, "Could not unpack gres data");
+		xstrcat(*reason_down, "Could not unpack gres data");
 	} else if (gres_plugin_node_config_validate(
 			   node_ptr->name, config_ptr->gres,
 			   &node_ptr->gres, &node_ptr->gres_list,
-			   slurmctld_conf.fast_schedule, &reason_down)
+			   slurmctld_conf.fast_schedule, reason_down)
 		   != SLURM_SUCCESS) {
 		error_code = EINVAL;
 		/* reason_down set in function above */
@@ -2242,17 +2272,17 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 			      "(%d < %d)",
 			      reg_msg->node_name, threads1, threads2);
 			error_code = EINVAL;
-			if (reason_down)
-				xstrcat(reason_down, ", ");
-			xstrcat(reason_down, "Low socket*core*thread count");
+			if (*reason_down)
+				xstrcat(*reason_down, ", ");
+			xstrcat(*reason_down, "Low socket*core*thread count");
 		} else if ((slurmctld_conf.fast_schedule == 0) &&
 			   ((cr_flag == 1) || gang_flag) && (cores1 < cores2)) {
 			error("Node %s has low socket*core count (%d < %d)",
 			      reg_msg->node_name, cores1, cores2);
 			error_code = EINVAL;
-			if (reason_down)
-				xstrcat(reason_down, ", ");
-			xstrcat(reason_down, "Low socket*core count");
+			if (*reason_down)
+				xstrcat(*reason_down, ", ");
+			xstrcat(*reason_down, "Low socket*core count");
 		} else if ((slurmctld_conf.fast_schedule == 0) &&
 			   ((cr_flag == 1) || gang_flag) &&
 			   ((sockets1 > sockets2) || (cores1 > cores2) ||
@@ -2272,9 +2302,9 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 			      reg_msg->node_name, reg_msg->cpus,
 			      config_ptr->cpus);
 			error_code  = EINVAL;
-			if (reason_down)
-				xstrcat(reason_down, ", ");
-			xstrcat(reason_down, "Low CPUs");
+			if (*reason_down)
+				xstrcat(*reason_down, ", ");
+			xstrcat(*reason_down, "Low CPUs");
 		} else if ((slurmctld_conf.fast_schedule == 0) &&
 			   ((cr_flag == 1) || gang_flag) &&
 			   (reg_msg->cpus > config_ptr->cpus)) {
@@ -2319,9 +2349,9 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 			      reg_msg->node_name, reg_msg->real_memory,
 			      config_ptr->real_memory);
 			error_code  = EINVAL;
-			if (reason_down)
-				xstrcat(reason_down, ", ");
-			xstrcat(reason_down, "Low RealMemory");
+			if (*reason_down)
+				xstrcat(*reason_down, ", ");
+			xstrcat(*reason_down, "Low RealMemory");
 		}
 	}
 	node_ptr->real_memory = reg_msg->real_memory;
@@ -2336,9 +2366,9 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 			      reg_msg->node_name, reg_msg->tmp_disk,
 			      config_ptr->tmp_disk);
 			error_code = EINVAL;
-			if (reason_down)
-				xstrcat(reason_down, ", ");
-			xstrcat(reason_down, "Low TmpDisk");
+			if (*reason_down)
+				xstrcat(*reason_down, ", ");
+			xstrcat(*reason_down, "Low TmpDisk");
 		}
 	}
 	node_ptr->tmp_disk = reg_msg->tmp_disk;
@@ -2371,6 +2401,65 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 	node_ptr->os = reg_msg->os;
 	reg_msg->os = NULL;	/* Nothing left to free */
 
+	return error_code;
+}
+
+/*
+ * validate_node_specs - validate the node's specifications as valid,
+ *	if not set state to down, in any case update last_response
+ * IN reg_msg - node registration message
+ * IN protocol_version - Version of Slurm on this node
+ * OUT newly_up - set if node newly brought into service
+ * RET 0 if no error, ENOENT if no such node, EINVAL if values too low
+ * NOTE: READ lock_slurmctld config before entry
+ */
+extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
+			       uint16_t protocol_version, bool *newly_up)
+{
+	int error_code, node_inx;
+	struct node_record *node_ptr;
+	char *reason_down = NULL;
+	uint32_t node_flags;
+	time_t boot_req_time, now = time(NULL);
+	bool orig_node_avail;
+
+	node_ptr = find_node_record (reg_msg->node_name);
+	if (node_ptr == NULL)
+		return ENOENT;
+	node_inx = node_ptr - node_record_table_ptr;
+	orig_node_avail = bit_test(avail_node_bitmap, node_inx);
+
+	error_code = SLURM_SUCCESS;
+
+	node_ptr->protocol_version = protocol_version;
+	xfree(node_ptr->version);
+	node_ptr->version = reg_msg->version;
+	reg_msg->version = NULL;
+
+	if (reg_msg->delta) {
+		/* The static configuration was omitted.  Unless the digest
+		 * matches what the node sent in its last full registration,
+		 * make it send everything again. */
+		if (!node_ptr->config_digest ||
+		    (node_ptr->config_digest != reg_msg->config_digest))
+			return ESLURM_NODE_REG_DIGEST_MISMATCH;
+	} else
+		node_ptr->config_digest = reg_msg->config_digest;
+
+	if (IS_NODE_POWER_UP(node_ptr)) {
+		boot_req_time = node_ptr->last_response -
+				slurm_get_resume_timeout();
+		if (node_ptr->boot_time < boot_req_time) {
+			debug("Still waiting for boot of node %s",
+			      node_ptr->name);
+			return SLURM_SUCCESS;
+		}
+	}
+
+	if (!reg_msg->delta)
+		error_code = _validate_node_config(node_ptr, reg_msg,
+						   &reason_down);
+
 	if (node_ptr->cpu_load != reg_msg->cpu_load) {
 		node_ptr->cpu_load = reg_msg->cpu_load;
 		node_ptr->cpu_load_time = now;
@@ -3627,6 +3716,7 @@ void make_node_idle(struct node_record *node_ptr,
 		     !IS_NODE_FAIL(node_ptr) && !IS_NODE_DRAIN(node_ptr))
 			bit_set(avail_node_bitmap, inx);
 	} else {
+		int i;
 		node_ptr->node_state = NODE_STATE_IDLE | node_flags;
 		if (!IS_NODE_NO_RESPOND(node_ptr) &&
 		     !IS_NODE_FAIL(node_ptr) && !IS_NODE_DRAIN(node_ptr))
@@ -3635,6 +3725,9 @@ void make_node_idle(struct node_record *node_ptr,
 		    !IS_NODE_COMPLETING(node_ptr))
 			bit_set(idle_node_bitmap, inx);
 		node_ptr->last_idle = now;
+		/* The node freed up, wake the scheduler for its partitions */
+		for (i = 0; i < node_ptr->part_cnt; i++)
+			queue_part_scheduler(node_ptr->part_pptr[i]);
 	}
 	last_node_update = now;
 }
@@ -3726,6 +3819,10 @@ extern void node_fini (void)
 	FREE_NULL_BITMAP(power_node_bitmap);
 	FREE_NULL_BITMAP(share_node_bitmap);
 	FREE_NULL_BITMAP(up_node_bitmap);
+	slurm_mutex_lock(&pack_cache_mutex);
+	xfree(pack_cache_data);
+	pack_cache_size = 0;
+	slurm_mutex_unlock(&pack_cache_mutex);
 	node_fini2();
 }
 
@@ -102,6 +102,26 @@ struct node_set {		/* set of nodes with same configuration */
 	bitstr_t *my_bitmap;		/* node bitmap */
 };
 
+/* Cache of per-partition node sets, grouped by configuration record,
+ * intersected with the partition node bitmap and sorted by ascending
+ * weight. Rebuilt when node or partition state changes, so per-job node
+ * set construction in _build_node_list() is a filtered scan of an
+ * already ordered structure. */
+struct config_node_set {
+	struct config_record *config_ptr;
+	bitstr_t *my_bitmap;		/* config nodes in this partition */
+	uint32_t weight;
+};
+struct part_node_index {
+	struct part_record *part_ptr;
+	struct config_node_set *sets;	/* sorted by ascending weight */
+	int set_cnt;
+};
+static List part_node_index_list = NULL;
+static pthread_mutex_t part_node_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+static time_t part_node_index_node_time = (time_t) 0;
+static time_t part_node_index_part_time = (time_t) 0;
+
 static int  _build_node_list(struct job_record *job_ptr,
 			     struct node_set **node_set_pptr,
 			     int *node_set_size, char **err_msg,
@@ -115,9 +135,11 @@ static bool _first_array_task(struct job_record *job_ptr);
 static void _launch_prolog(struct job_record *job_ptr);
 static void _log_node_set(uint32_t job_id, struct node_set *node_set_ptr,
 			  int node_set_size);
-static int  _match_feature(char *seek, struct node_set *node_set_ptr,
+static int  _match_feature(job_feature_t *seek,
+			   struct node_set *node_set_ptr,
 			   bool can_reboot);
-static int  _match_feature2(char *seek, struct node_set *node_set_ptr,
+static int  _match_feature2(job_feature_t *seek,
+			    struct node_set *node_set_ptr,
 			    bitstr_t **inactive_bitmap);
 static int  _match_feature3(struct job_record *job_ptr,
 			    struct node_set *node_set_ptr,
@@ -632,26 +654,23 @@ extern void deallocate_nodes(struct job_record *job_ptr, bool timeout,
 
 /*
  * _match_feature - determine if the desired feature is one of those available
- * IN seek - desired feature
+ * IN seek - desired job feature record
  * IN node_set_ptr - Pointer to node_set being searched
  * IN can_reboot - if true node can use any available feature,
  *	else job can use only active features
  * RET 1 if found, 0 otherwise
  */
-static int _match_feature(char *seek, struct node_set *node_set_ptr,
+static int _match_feature(job_feature_t *seek, struct node_set *node_set_ptr,
 			  bool can_reboot)
 {
 	node_feature_t *feat_ptr;
 
 	if (seek == NULL)
 		return 1;	/* nothing to look for */
-	if (can_reboot) {
-		feat_ptr = list_find_first(avail_feature_list,
-					   list_find_feature, (void *) seek);
-	} else {
-		feat_ptr = list_find_first(active_feature_list,
-					   list_find_feature, (void *) seek);
-	}
+	if (can_reboot)
+		feat_ptr = find_job_node_feature(seek, avail_feature_list);
+	else
+		feat_ptr = find_job_node_feature(seek, active_feature_list);
 	if ((feat_ptr == NULL) || (feat_ptr->node_bitmap == NULL))
 		return 0;	/* no such feature */
 
@@ -662,12 +681,12 @@ static int _match_feature(char *seek, struct node_set *node_set_ptr,
 
 /*
  * _match_feature2 - determine which of the desired features is now inactive
- * IN seek - desired feature
+ * IN seek - desired job feature record
  * IN node_set_ptr - Pointer to node_set being searched
  * OUT inactive_bitmap - Nodes with this as inactive feature
  * RET 1 if some nodes with this inactive feature, 0 no such inactive feature
  */
-static int _match_feature2(char *seek, struct node_set *node_set_ptr,
+static int _match_feature2(job_feature_t *seek, struct node_set *node_set_ptr,
 			   bitstr_t **inactive_bitmap)
 {
 	node_feature_t *feat_ptr;
@@ -676,8 +695,7 @@ static int _match_feature2(char *seek, struct node_set *node_set_ptr,
 	    (node_features_g_count() == 0))	/* No inactive features */
 		return 0;
 
-	feat_ptr = list_find_first(active_feature_list, list_find_feature,
-				   (void *) seek);
+	feat_ptr = find_job_node_feature(seek, active_feature_list);
 	if ((feat_ptr == NULL) || (feat_ptr->node_bitmap == NULL)) {
 		if (bit_set_count(node_set_ptr->my_bitmap) > 0) {
 			*inactive_bitmap = bit_copy(node_set_ptr->my_bitmap);
@@ -719,9 +737,8 @@ static int _match_feature3(struct job_record *job_ptr,
 
 	feat_iter = list_iterator_create(details_ptr->feature_list);
 	while ((job_feat_ptr = (job_feature_t *) list_next(feat_iter))) {
-		node_feat_ptr = list_find_first(active_feature_list,
-						list_find_feature,
-						(void *)job_feat_ptr->name);
+		node_feat_ptr = find_job_node_feature(job_feat_ptr,
+						      active_feature_list);
 		if ((node_feat_ptr == NULL) ||
 		    (node_feat_ptr->node_bitmap == NULL)) {
 			if (!tmp_bitmap)
@@ -769,9 +786,8 @@ extern void build_active_feature_bitmap(struct job_record *job_ptr,
 
 	feat_iter = list_iterator_create(details_ptr->feature_list);
 	while ((job_feat_ptr = (job_feature_t *) list_next(feat_iter))) {
-		node_feat_ptr = list_find_first(active_feature_list,
-						list_find_feature,
-						(void *)job_feat_ptr->name);
+		node_feat_ptr = find_job_node_feature(job_feat_ptr,
+						      active_feature_list);
 		if ((node_feat_ptr == NULL) ||
 		    (node_feat_ptr->node_bitmap == NULL)) {
 			if (!tmp_bitmap)
@@ -1095,7 +1111,7 @@ _get_req_features(struct node_set *node_set_ptr, int node_set_size,
 			 * data structure, so we need to make a copy and then
 			 * purge it */
 			for (i = 0; i < node_set_size; i++) {
-				if (!_match_feature(feat_ptr->name,
+				if (!_match_feature(feat_ptr,
 						    node_set_ptr+i,
 						    can_reboot))
 					continue;
@@ -1123,7 +1139,7 @@ _get_req_features(struct node_set *node_set_ptr, int node_set_size,
 				if (test_only || !can_reboot ||
 				    (prev_node_set_ptr->weight == INFINITE))
 					continue;
-				if (!_match_feature2(feat_ptr->name,
+				if (!_match_feature2(feat_ptr,
 						     node_set_ptr+i,
 						     &inactive_bitmap))
 					continue;
@@ -2853,6 +2869,34 @@ extern int list_find_feature(void *feature_entry, void *key)
 	return 0;
 }
 
+/*
+ * find_job_node_feature - return the node feature record matching a job
+ *	feature record, using the lookup compiled into the job feature
+ *	record when still current
+ * IN job_feat_ptr - feature record from some job's feature_list
+ * IN feature_list - avail_feature_list or active_feature_list
+ * RET the matching node feature record or NULL if none
+ */
+extern node_feature_t *find_job_node_feature(job_feature_t *job_feat_ptr,
+					     List feature_list)
+{
+	if (job_feat_ptr->feat_gen != node_feature_gen) {
+		/* Compile the name lookups into the job feature record.
+		 * They remain valid until a node feature list changes and
+		 * node_feature_gen advances. */
+		job_feat_ptr->avail_feat_ptr = (node_feature_t *)
+			list_find_first(avail_feature_list, list_find_feature,
+					(void *) job_feat_ptr->name);
+		job_feat_ptr->active_feat_ptr = (node_feature_t *)
+			list_find_first(active_feature_list, list_find_feature,
+					(void *) job_feat_ptr->name);
+		job_feat_ptr->feat_gen = node_feature_gen;
+	}
+	if (feature_list == avail_feature_list)
+		return job_feat_ptr->avail_feat_ptr;
+	return job_feat_ptr->active_feat_ptr;
+}
+
 /*
  * _valid_feature_counts - validate a job's features can be satisfied
  *	by the selected nodes (NOTE: does not process XOR or XAND operators)
@@ -2888,9 +2932,8 @@ static bool _valid_feature_counts(struct job_record *job_ptr,
 	feature_bitmap = bit_copy(node_bitmap);
 	job_feat_iter = list_iterator_create(detail_ptr->feature_list);
 	while ((job_feat_ptr = (job_feature_t *) list_next(job_feat_iter))) {
-		node_feat_ptr = list_find_first(feature_list,
-					list_find_feature,
-					(void *) job_feat_ptr->name);
+		node_feat_ptr = find_job_node_feature(job_feat_ptr,
+						      feature_list);
 		if (node_feat_ptr) {
 			if (last_op == FEATURE_OP_AND) {
 				bit_and(feature_bitmap,
@@ -2922,9 +2965,8 @@ static bool _valid_feature_counts(struct job_record *job_ptr,
 				list_next(job_feat_iter))) {
 			if (job_feat_ptr->count == 0)
 				continue;
-			node_feat_ptr = list_find_first(feature_list,
-						list_find_feature,
-						(void *)job_feat_ptr->name);
+			node_feat_ptr = find_job_node_feature(job_feat_ptr,
+							      feature_list);
 			if (!node_feat_ptr) {
 				rc = false;
 				break;
@@ -3053,6 +3095,94 @@ static int _no_reg_nodes(void)
 	return node_count;
 }
 
+static void _del_part_node_index(void *x)
+{
+	struct part_node_index *pni = (struct part_node_index *) x;
+	int i;
+
+	for (i = 0; i < pni->set_cnt; i++)
+		FREE_NULL_BITMAP(pni->sets[i].my_bitmap);
+	xfree(pni->sets);
+	xfree(pni);
+}
+
+static int _find_part_node_index(void *x, void *key)
+{
+	struct part_node_index *pni = (struct part_node_index *) x;
+
+	return (pni->part_ptr == (struct part_record *) key);
+}
+
+static int _sort_config_node_set(const void *x, const void *y)
+{
+	struct config_node_set *set_ptr1 = (struct config_node_set *) x;
+	struct config_node_set *set_ptr2 = (struct config_node_set *) y;
+
+	if (set_ptr1->weight < set_ptr2->weight)
+		return -1;
+	if (set_ptr1->weight > set_ptr2->weight)
+		return 1;
+	return 0;
+}
+
+/*
+ * _part_node_index - return this partition's node sets grouped by config
+ *	record and sorted by weight, rebuilding the cache if node or
+ *	partition state changed since it was built
+ * NOTE: the caller's node and partition locks also guard the returned
+ *	sets against a concurrent rebuild, which requires a state change
+ */
+static struct part_node_index *_part_node_index(struct part_record *part_ptr)
+{
+	struct part_node_index *pni;
+	struct config_node_set *set;
+	struct config_record *config_ptr;
+	ListIterator config_iterator;
+
+	slurm_mutex_lock(&part_node_index_mutex);
+	if (!part_node_index_list)
+		part_node_index_list = list_create(_del_part_node_index);
+	if ((part_node_index_node_time != last_node_update) ||
+	    (part_node_index_part_time != last_part_update)) {
+		list_flush(part_node_index_list);
+		part_node_index_node_time = last_node_update;
+		part_node_index_part_time = last_part_update;
+	}
+	pni = list_find_first(part_node_index_list, _find_part_node_index,
+			      part_ptr);
+	if (!pni) {
+		pni = xmalloc(sizeof(struct part_node_index));
+		pni->part_ptr = part_ptr;
+		pni->sets = xmalloc(list_count(config_list) *
+				    sizeof(struct config_node_set));
+		config_iterator = list_iterator_create(config_list);
+		while ((config_ptr = (struct config_record *)
+				list_next(config_iterator))) {
+			if (!config_ptr->node_bitmap ||
+			    !part_ptr->node_bitmap)
+				continue;
+			set = pni->sets + pni->set_cnt;
+			set->my_bitmap = bit_copy(config_ptr->node_bitmap);
+			bit_and(set->my_bitmap, part_ptr->node_bitmap);
+			if (bit_set_count(set->my_bitmap) == 0) {
+				/* no nodes in this partition */
+				FREE_NULL_BITMAP(set->my_bitmap);
+				continue;
+			}
+			set->config_ptr = config_ptr;
+			set->weight = config_ptr->weight;
+			pni->set_cnt++;
+		}
+		list_iterator_destroy(config_iterator);
+		qsort(pni->sets, pni->set_cnt,
+		      sizeof(struct config_node_set), _sort_config_node_set);
+		list_append(part_node_index_list, pni);
+	}
+	slurm_mutex_unlock(&part_node_index_mutex);
+
+	return pni;
+}
+
 /*
  * _build_node_list - identify which nodes could be allocated to a job
  *	based upon node features, memory, processors, etc. Note that a
@@ -3076,7 +3206,8 @@ static int _build_node_list(struct job_record *job_ptr,
 	struct node_set *node_set_ptr, *prev_node_set_ptr;
 	struct config_record *config_ptr;
 	struct part_record *part_ptr = job_ptr->part_ptr;
-	ListIterator config_iterator;
+	struct part_node_index *pni;
+	int pni_inx;
 	int check_node_config;
 	struct job_details *detail_ptr = job_ptr->details;
 	bitstr_t *power_up_bitmap = NULL, *usable_node_mask = NULL;
@@ -3154,15 +3285,15 @@ static int _build_node_list(struct job_record *job_ptr,
 		return ESLURM_REQUESTED_NODE_CONFIG_UNAVAILABLE;
 	}
 
+	pni = _part_node_index(part_ptr);
 	node_set_inx = 0;
-	node_set_len = list_count(config_list) * 4 + 1;
+	node_set_len = pni->set_cnt * 4 + 1;
 	node_set_ptr = (struct node_set *)
 			xmalloc(sizeof(struct node_set) * node_set_len);
-	config_iterator = list_iterator_create(config_list);
-	while ((config_ptr = (struct config_record *)
-			list_next(config_iterator))) {
+	for (pni_inx = 0; pni_inx < pni->set_cnt; pni_inx++) {
 		bool cpus_ok = false, mem_ok = false, disk_ok = false;
 		bool job_mc_ok = false, config_filter = false;
+		config_ptr = pni->sets[pni_inx].config_ptr;
 		adj_cpus = adjust_cpus_nppcu(_get_ntasks_per_core(detail_ptr),
 					     config_ptr->threads,
 					     config_ptr->cpus);
@@ -3201,9 +3332,7 @@ static int _build_node_list(struct job_record *job_ptr,
 			check_node_config = 0;
 
 		node_set_ptr[node_set_inx].my_bitmap =
-			bit_copy(config_ptr->node_bitmap);
-		bit_and(node_set_ptr[node_set_inx].my_bitmap,
-			part_ptr->node_bitmap);
+			bit_copy(pni->sets[pni_inx].my_bitmap);
 		if (usable_node_mask) {
 			bit_and(node_set_ptr[node_set_inx].my_bitmap,
 				usable_node_mask);
@@ -3288,7 +3417,6 @@ static int _build_node_list(struct job_record *job_ptr,
 			break;
 		}
 	}
-	list_iterator_destroy(config_iterator);
 	/* eliminate any incomplete node_set record */
 	xfree(node_set_ptr[node_set_inx].features);
 	FREE_NULL_BITMAP(node_set_ptr[node_set_inx].my_bitmap);
@@ -3650,9 +3778,8 @@ static bitstr_t *_valid_features(struct job_record *job_ptr,
 		    (job_feat_ptr->op_code == FEATURE_OP_XOR)  ||
 		    (last_op == FEATURE_OP_XAND) ||
 		    (last_op == FEATURE_OP_XOR)) {
-			node_feat_ptr = list_find_first(feature_list,
-						   list_find_feature,
-						   (void *)job_feat_ptr->name);
+			node_feat_ptr = find_job_node_feature(job_feat_ptr,
+							      feature_list);
 			if (node_feat_ptr &&
 			    bit_super_set(config_ptr->node_bitmap,
 					  node_feat_ptr->node_bitmap)) {
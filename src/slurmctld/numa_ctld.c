@@ -0,0 +1,159 @@
+/*****************************************************************************\
+ *  numa_ctld.c - NUMA aware data placement and thread binding for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#ifdef HAVE_NUMA
+#  include <numa.h>
+#  include <numaif.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/slurmctld/numa_ctld.h"
+
+#ifdef HAVE_NUMA
+/* Do not bother interleaving tables smaller than this many pages, the
+ * placement of a table that small can not matter */
+#define NUMA_MIN_PAGES 4
+
+static bool numa_enabled = false;
+static int numa_node_cnt = 1;
+static int numa_next_node = 0;
+static pthread_mutex_t numa_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Round robin over the NUMA nodes for thread binding */
+static int _next_node(void)
+{
+	int node;
+
+	slurm_mutex_lock(&numa_mutex);
+	node = numa_next_node;
+	numa_next_node = (numa_next_node + 1) % numa_node_cnt;
+	slurm_mutex_unlock(&numa_mutex);
+
+	return node;
+}
+#endif
+
+extern void ctld_numa_init(void)
+{
+#ifdef HAVE_NUMA
+	char *sched_params = slurm_get_sched_params();
+
+	numa_enabled = false;
+	if (sched_params && strstr(sched_params, "numa_aware")) {
+		if ((numa_available() < 0) || (numa_max_node() < 1)) {
+			info("numa_aware requested, but this host has a "
+			     "single NUMA node, ignoring");
+		} else {
+			numa_node_cnt = numa_max_node() + 1;
+			numa_enabled = true;
+			info("NUMA aware operation enabled across %d nodes",
+			     numa_node_cnt);
+		}
+	}
+	xfree(sched_params);
+#endif
+}
+
+extern void ctld_numa_interleave(void *buf, size_t len)
+{
+#ifdef HAVE_NUMA
+	long page_size = sysconf(_SC_PAGESIZE);
+	uintptr_t start, end;
+
+	if (!numa_enabled || !buf)
+		return;
+
+	/* mbind() wants page aligned addresses, so interleave the fully
+	 * covered pages and leave the edges of the table where they are */
+	start = ((uintptr_t) buf + page_size - 1) & ~((uintptr_t)page_size - 1);
+	end   = ((uintptr_t) buf + len) & ~((uintptr_t) page_size - 1);
+	if ((end <= start) || ((end - start) < (NUMA_MIN_PAGES * page_size)))
+		return;
+
+	/* MPOL_MF_MOVE migrates pages already placed by first touch */
+	if (mbind((void *) start, end - start, MPOL_INTERLEAVE,
+		  numa_all_nodes_ptr->maskp, numa_all_nodes_ptr->size + 1,
+		  MPOL_MF_MOVE)) {
+		debug2("%s: mbind of %zu bytes failed: %m", __func__, len);
+	} else {
+		debug2("%s: interleaved %zu bytes over %d NUMA nodes",
+		       __func__, len, numa_node_cnt);
+	}
+#endif
+}
+
+extern void ctld_numa_bind_rpc_thread(void)
+{
+#ifdef HAVE_NUMA
+	int node;
+
+	if (!numa_enabled)
+		return;
+
+	node = _next_node();
+	if (numa_run_on_node(node))
+		debug2("%s: can not bind to NUMA node %d: %m", __func__, node);
+#endif
+}
+
+extern void ctld_numa_bind_sched_thread(void)
+{
+#ifdef HAVE_NUMA
+	int node;
+
+	if (!numa_enabled)
+		return;
+
+	node = _next_node();
+	if (numa_run_on_node(node)) {
+		debug2("%s: can not bind to NUMA node %d: %m", __func__, node);
+		return;
+	}
+	/* Scratch data built by this thread (e.g. the backfill copy of
+	 * the node table) is first touched here, keep it on this node */
+	numa_set_localalloc();
+	debug2("%s: scheduler thread bound to NUMA node %d", __func__, node);
+#endif
+}
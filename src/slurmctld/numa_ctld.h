@@ -0,0 +1,76 @@
+/*****************************************************************************\
+ *  numa_ctld.h - NUMA aware data placement and thread binding for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _HAVE_NUMA_CTLD_H
+#define _HAVE_NUMA_CTLD_H
+
+#include <sys/types.h>
+
+/*
+ * ctld_numa_init - enable NUMA aware operation if SchedulerParameters
+ *	contains "numa_aware", libnuma support was built in and the host
+ *	actually has more than one NUMA node. Call after the configuration
+ *	is read; safe to call again on reconfigure. All other functions
+ *	below are no-ops unless this enabled NUMA aware operation.
+ */
+extern void ctld_numa_init(void);
+
+/*
+ * ctld_numa_interleave - spread the pages backing a large shared table
+ *	across all NUMA nodes, migrating already touched pages. Without
+ *	this, first-touch policy places tables like the node and job hash
+ *	tables entirely on the socket of the thread that built them and
+ *	every reader on the other socket pays remote access latency.
+ * IN buf - start of the table
+ * IN len - its length in bytes (short tables are left alone)
+ */
+extern void ctld_numa_interleave(void *buf, size_t len);
+
+/*
+ * ctld_numa_bind_rpc_thread - bind the calling RPC service or agent
+ *	thread to one NUMA node, chosen round robin, so it does not
+ *	migrate between sockets while handling traffic
+ */
+extern void ctld_numa_bind_rpc_thread(void);
+
+/*
+ * ctld_numa_bind_sched_thread - bind the calling scheduler thread to one
+ *	NUMA node and request node local memory allocation, so scratch
+ *	data built during scheduling passes (e.g. the backfill snapshot
+ *	of the node table) stays local to the thread using it
+ */
+extern void ctld_numa_bind_sched_thread(void);
+
+#endif	/* _HAVE_NUMA_CTLD_H */
@@ -480,6 +480,7 @@ int dump_all_part_state(void)
 	xfree(new_file);
 	unlock_state_files();
 
+	stream_state_file("part_state", buffer);
 	free_buf(buffer);
 	END_TIMER2("dump_all_part_state");
 	return 0;
@@ -576,17 +577,17 @@ int load_all_part_state(void)
 	char *part_name = NULL, *nodes = NULL;
 	char *allow_accounts = NULL, *allow_groups = NULL, *allow_qos = NULL;
 	char *deny_accounts = NULL, *deny_qos = NULL, *qos_char = NULL;
-	char *state_file = NULL, *data = NULL;
+	char *state_file = NULL;
 	uint32_t max_time, default_time, max_nodes, min_nodes;
 	uint32_t max_cpus_per_node = INFINITE, grace_time = 0;
 	time_t time;
 	uint16_t flags, priority_job_factor, priority_tier;
 	uint16_t max_share, preempt_mode, state_up, cr_type;
 	struct part_record *part_ptr;
-	uint32_t data_size = 0, name_len;
-	int data_allocated, data_read = 0, error_code = 0, part_cnt = 0;
+	uint32_t name_len;
+	int error_code = 0, part_cnt = 0;
 	int state_fd;
-	Buf buffer;
+	Buf buffer = NULL;
 	char *ver_str = NULL;
 	char* allow_alloc_nodes = NULL;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
@@ -600,31 +601,16 @@ int load_all_part_state(void)
 		     state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if  (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
-		close(state_fd);
+		(void) close(state_fd);
+		if (!(buffer = create_mmap_buf(state_file)))
+			error("Can not map partition state file %s: %m",
+			      state_file);
 	}
 	xfree(state_file);
 	unlock_state_files();
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)	/* preserve the empty buffer unpack error path */
+		buffer = create_buf(NULL, 0);
 
 	safe_unpackstr_xmalloc(&ver_str, &name_len, buffer);
 	debug3("Version string in part_state header is %s", ver_str);
@@ -1087,6 +1073,25 @@ static int _match_part_ptr(void *part_ptr, void *key)
 	return 0;
 }
 
+static int _part_test_hidden(void *x, void *arg)
+{
+	struct part_record *part_ptr = (struct part_record *) x;
+
+	if (part_ptr->flags & PART_FLAG_HIDDEN)
+		return -1;
+
+	return 0;
+}
+
+/* part_any_hidden - report if any partition currently has its hidden flag
+ * set, either by configuration or by a preceding part_filter_set() call */
+extern bool part_any_hidden(void)
+{
+	if (list_for_each(part_list, _part_test_hidden, NULL) < 0)
+		return true;
+	return false;
+}
+
 /* part_filter_set - Set the partition's hidden flag based upon a user's
  * group access. This must be followed by a call to part_filter_clear() */
 static int _part_filter_set(void *x, void *arg)
@@ -1560,9 +1565,11 @@ extern int update_part (update_part_msg_t * part_desc, bool create_flag)
 			info("update_part: setting allow_groups to %s for "
 				"partition %s",
 				part_ptr->allow_groups, part_desc->name);
+			/* Flush the cache first so the new list is built
+			 * from fresh group membership data */
+			clear_group_cache();
 			part_ptr->allow_uids =
 				_get_groups_members(part_ptr->allow_groups);
-			clear_group_cache();
 		}
 	}
 
@@ -1953,11 +1960,57 @@ void load_part_uid_allow_list(int force)
 		part_ptr->allow_uids =
 			_get_groups_members(part_ptr->allow_groups);
 	}
-	clear_group_cache();
 	list_iterator_destroy(part_iterator);
+	/* The group membership cache is preserved, its records carry a TTL
+	 * of GroupUpdateTime so they are renewed by the periodic refresh
+	 * rather than flushed here. Save it for a warm start, a restarted
+	 * slurmctld can then rebuild the allow_uids lists without blocking
+	 * on NSS lookups. */
+	dump_group_cache_state();
 	END_TIMER2("load_part_uid_allow_list");
 }
 
+/*
+ * precache_group_members - resolve and cache the members of every group
+ *	referenced by a partition AllowGroups list, so that a subsequent
+ *	load_part_uid_allow_list() call made with locks held is serviced
+ *	from the warm cache rather than blocking on NSS lookups
+ * NOTE: Acquires its own partition lock, call with no locks set
+ */
+extern void precache_group_members(void)
+{
+	char *tmp_names, *name_ptr, *one_name_ptr, *save_ptr = NULL;
+	ListIterator part_iterator;
+	struct part_record *part_ptr;
+	List group_names;
+	uid_t *group_uids;
+	/* Locks: Read partition */
+	slurmctld_lock_t part_read_lock =
+	    { NO_LOCK, NO_LOCK, NO_LOCK, READ_LOCK, NO_LOCK };
+
+	group_names = list_create(slurm_destroy_char);
+	lock_slurmctld(part_read_lock);
+	part_iterator = list_iterator_create(part_list);
+	while ((part_ptr = (struct part_record *) list_next(part_iterator))) {
+		if (part_ptr->allow_groups)
+			list_append(group_names,
+				    xstrdup(part_ptr->allow_groups));
+	}
+	list_iterator_destroy(part_iterator);
+	unlock_slurmctld(part_read_lock);
+
+	while ((tmp_names = (char *) list_pop(group_names))) {
+		name_ptr = tmp_names;
+		while ((one_name_ptr = strtok_r(name_ptr, ",", &save_ptr))) {
+			name_ptr = NULL;
+			group_uids = get_group_members(one_name_ptr);
+			xfree(group_uids);
+		}
+		xfree(tmp_names);
+	}
+	FREE_NULL_LIST(group_names);
+}
+
 
 /*
  * _get_groups_members - identify the users in a list of group names
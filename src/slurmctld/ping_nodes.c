@@ -60,6 +60,12 @@
 /* Log an error for ping that takes more than 100 seconds to complete */
 #define PING_TIMEOUT 100
 
+/* Maximum number of consecutive responsive ping cycles credited to a node.
+ * Each credit stretches the node's ping interval by SlurmdTimeout/12, so
+ * the interval grows from SlurmdTimeout/3 to at most 2*SlurmdTimeout/3,
+ * leaving ample margin before the node could be marked DOWN. */
+#define PING_STREAK_MAX 4
+
 static pthread_mutex_t lock_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int ping_count = 0;
 static time_t ping_start = 0;
@@ -148,6 +154,7 @@ void ping_nodes (void)
 	struct node_record *node_ptr = NULL;
 	time_t old_cpu_load_time = now - slurmctld_conf.slurmd_timeout;
 	time_t old_free_mem_time = now - slurmctld_conf.slurmd_timeout;
+	time_t node_live_time, prev_ping_time;
 #endif
 
 	ping_agent_args = xmalloc (sizeof (agent_arg_t));
@@ -179,6 +186,9 @@ void ping_nodes (void)
 				 slurmctld_conf.slurmd_timeout;
 	}
 	still_live_time = now - (slurmctld_conf.slurmd_timeout / 3);
+#ifndef HAVE_FRONT_END
+	prev_ping_time  = last_ping_time;
+#endif
 	last_ping_time  = now;
 
 	if (max_reg_threads == 0) {
@@ -316,8 +326,18 @@ void ping_nodes (void)
 			continue;
 		}
 
+		/* Adapt this node's ping interval to its responsiveness,
+		 * consistently responsive nodes are pinged less often */
+		if (IS_NODE_NO_RESPOND(node_ptr))
+			node_ptr->ping_streak = 0;
+		else if ((node_ptr->last_response >= prev_ping_time) &&
+			 (node_ptr->ping_streak < PING_STREAK_MAX))
+			node_ptr->ping_streak++;
+		node_live_time = still_live_time -
+				 (node_ptr->ping_streak *
+				  (slurmctld_conf.slurmd_timeout / 12));
 		if ((!IS_NODE_NO_RESPOND(node_ptr)) &&
-		    (node_ptr->last_response >= still_live_time) &&
+		    (node_ptr->last_response >= node_live_time) &&
 		    (node_ptr->cpu_load_time >= old_cpu_load_time) &&
 		    (node_ptr->free_mem_time >= old_free_mem_time))
 			continue;
@@ -54,6 +54,11 @@ int        port_resv_cnt   = 0;
 int        port_resv_min   = 0;
 int        port_resv_max   = 0;
 
+/* Bit set for each port with no reservation on any node. Lets
+ * resv_port_alloc() find unused ports with word-wise bitmap searches
+ * instead of testing every port's node bitmap for overlap. */
+static bitstr_t *port_free_bitmap = (bitstr_t *) NULL;
+
 static void _dump_resv_port_info(void);
 static void _make_all_resv(void);
 static void _make_step_resv(struct step_record *step_ptr);
@@ -132,6 +137,8 @@ static void _make_step_resv(struct step_record *step_ptr)
 			continue;
 		j = step_ptr->resv_port_array[i] - port_resv_min;
 		bit_or(port_resv_table[j], step_ptr->step_node_bitmap);
+		if (port_free_bitmap)
+			bit_clear(port_free_bitmap, j);
 	}
 }
 
@@ -172,6 +179,7 @@ extern int reserve_port_config(char *mpi_params)
 			for (i=0; i<port_resv_cnt; i++)
 				FREE_NULL_BITMAP(port_resv_table[i]);
 			xfree(port_resv_table);
+			FREE_NULL_BITMAP(port_free_bitmap);
 			port_resv_cnt = 0;
 			port_resv_min = port_resv_max = 0;
 		}
@@ -206,6 +214,9 @@ extern int reserve_port_config(char *mpi_params)
 	port_resv_table = xmalloc(sizeof(bitstr_t *) * port_resv_cnt);
 	for (i=0; i<port_resv_cnt; i++)
 		port_resv_table[i] = bit_alloc(node_record_count);
+	FREE_NULL_BITMAP(port_free_bitmap);
+	port_free_bitmap = bit_alloc(port_resv_cnt);
+	bit_nset(port_free_bitmap, 0, port_resv_cnt - 1);
 
 	_make_all_resv();
 	_dump_resv_port_info();
@@ -236,18 +247,52 @@ extern int resv_port_alloc(struct step_record *step_ptr)
 		return ESLURM_PORTS_INVALID;
 	}
 
-	/* Identify available ports */
+	/* Identify available ports. Take completely unused ports first,
+	 * found with word-wise searches of port_free_bitmap rather than
+	 * testing each port's node bitmap for overlap. */
 	port_array = xmalloc(sizeof(int) * step_ptr->resv_port_cnt);
 	port_inx = 0;
-	for (i=0; i<port_resv_cnt; i++) {
+	if (port_free_bitmap) {
+		bitstr_t *search = bit_copy(port_free_bitmap);
+		bool wrapped = false;
+
+		if (last_port_alloc)
+			bit_nclear(search, 0, last_port_alloc - 1);
+		while (port_inx < step_ptr->resv_port_cnt) {
+			i = bit_ffs(search);
+			if (i == -1) {
+				if (wrapped || (last_port_alloc == 0))
+					break;
+				/* Wrap to the start of the port range */
+				wrapped = true;
+				bit_free(search);
+				search = bit_copy(port_free_bitmap);
+				bit_nclear(search, last_port_alloc,
+					   port_resv_cnt - 1);
+				continue;
+			}
+			bit_clear(search, i);
+			port_array[port_inx++] = i;
+			last_port_alloc = i + 1;
+			if (last_port_alloc >= port_resv_cnt)
+				last_port_alloc = 0;
+		}
+		bit_free(search);
+	}
+	/* Fall back to ports reserved on other nodes, but still free on
+	 * every node used by this job step. Any port still marked in
+	 * port_free_bitmap was already taken above. */
+	for (i=0; ((port_inx < step_ptr->resv_port_cnt) &&
+		   (i < port_resv_cnt)); i++) {
 		if (++last_port_alloc >= port_resv_cnt)
 			last_port_alloc = 0;
+		if (port_free_bitmap &&
+		    bit_test(port_free_bitmap, last_port_alloc))
+			continue;
 		if (bit_overlap(step_ptr->step_node_bitmap,
 				port_resv_table[last_port_alloc]))
 			continue;
 		port_array[port_inx++] = last_port_alloc;
-		if (port_inx >= step_ptr->resv_port_cnt)
-			break;
 	}
 	if (port_inx < step_ptr->resv_port_cnt) {
 		info("insufficient ports for step %u.%u to reserve (%d of %u)",
@@ -262,6 +307,8 @@ extern int resv_port_alloc(struct step_record *step_ptr)
 	for (i=0; i<port_inx; i++) {
 		bit_or(port_resv_table[port_array[i]],
 		       step_ptr->step_node_bitmap);
+		if (port_free_bitmap)
+			bit_clear(port_free_bitmap, port_array[i]);
 		port_array[i] += port_resv_min;
 		snprintf(port_str, sizeof(port_str), "%d", port_array[i]);
 		hostlist_push_host(hl, port_str);
@@ -295,7 +342,8 @@ extern void resv_port_free(struct step_record *step_ptr)
 			continue;
 		j = step_ptr->resv_port_array[i] - port_resv_min;
 		bit_and(port_resv_table[j], step_ptr->step_node_bitmap);
-
+		if (port_free_bitmap && (bit_ffs(port_resv_table[j]) == -1))
+			bit_set(port_free_bitmap, j);
 	}
 	bit_not(step_ptr->step_node_bitmap);
 	xfree(step_ptr->resv_port_array);
@@ -66,7 +66,11 @@
 #include "src/slurmctld/slurmctld.h"
 
 #define _DEBUG			0
-#define PID_CNT			10
+#define PID_CNT			128
+#define NODES_PER_PROG		100	/* maximum node count per program
+					 * invocation, larger node sets are
+					 * split into concurrently executed
+					 * batches of this size */
 #define MAX_SHUTDOWN_DELAY	10	/* seconds to wait for child procs
 					 * to exit after daemon shutdown
 					 * request, then orphan or kill proc */
@@ -94,14 +98,16 @@ float suspend_cnt_f, resume_cnt_f;
 
 static void  _clear_power_config(void);
 static void  _do_power_work(time_t now);
-static void  _do_resume(char *host);
-static void  _do_suspend(char *host);
+static void  _do_resume(bitstr_t *node_bitmap);
+static void  _do_suspend(bitstr_t *node_bitmap);
 static int   _init_power_config(void);
 static void *_init_power_save(void *arg);
 static int   _kill_procs(void);
 static int   _reap_procs(void);
 static void  _re_wake(void);
 static pid_t _run_prog(char *prog, char *arg1, char *arg2);
+static void  _run_prog_batches(char *prog, bitstr_t *node_bitmap, char *arg2,
+			       char *op);
 static void  _shutdown_power(void);
 static bool  _valid_prog(char *file_name);
 
@@ -247,26 +253,14 @@ static void _do_power_work(time_t now)
 	}
 
 	if (sleep_node_bitmap) {
-		char *nodes;
-		nodes = bitmap2node_name(sleep_node_bitmap);
-		if (nodes)
-			_do_suspend(nodes);
-		else
-			error("power_save: bitmap2nodename");
-		xfree(nodes);
+		_do_suspend(sleep_node_bitmap);
 		FREE_NULL_BITMAP(sleep_node_bitmap);
 		/* last_node_update could be changed already by another thread!
 		last_node_update = now; */
 	}
 
 	if (wake_node_bitmap) {
-		char *nodes;
-		nodes = bitmap2node_name(wake_node_bitmap);
-		if (nodes)
-			_do_resume(nodes);
-		else
-			error("power_save: bitmap2nodename");
-		xfree(nodes);
+		_do_resume(wake_node_bitmap);
 		FREE_NULL_BITMAP(wake_node_bitmap);
 		/* last_node_update could be changed already by another thread!
 		last_node_update = now; */
@@ -364,37 +358,78 @@ static void _re_wake(void)
 	}
 
 	if (wake_node_bitmap) {
-		char *nodes;
-		nodes = bitmap2node_name(wake_node_bitmap);
-		if (nodes) {
-			pid_t pid = _run_prog(resume_prog, nodes, NULL);
-			info("power_save: pid %d rewaking nodes %s",
-			     (int) pid, nodes);
-		} else
-			error("power_save: bitmap2nodename");
-		xfree(nodes);
+		_run_prog_batches(resume_prog, wake_node_bitmap, NULL,
+				  "rewaking");
 		FREE_NULL_BITMAP(wake_node_bitmap);
 	}
 }
 
-static void _do_resume(char *host)
+static void _do_resume(bitstr_t *node_bitmap)
 {
-	pid_t pid = _run_prog(resume_prog, host, NULL);
-#if _DEBUG
-	info("power_save: pid %d waking nodes %s", (int) pid, host);
-#else
-	verbose("power_save: pid %d waking nodes %s", (int) pid, host);
-#endif
+	_run_prog_batches(resume_prog, node_bitmap, NULL, "waking");
+}
+
+static void _do_suspend(bitstr_t *node_bitmap)
+{
+	_run_prog_batches(suspend_prog, node_bitmap, NULL, "suspending");
 }
 
-static void _do_suspend(char *host)
+/* Run a suspend or resume program against a set of nodes, splitting the
+ * set into hostlist-ranged batches of at most NODES_PER_PROG nodes with
+ * one concurrently executing program invocation per batch. The children
+ * run in parallel and are reaped asynchronously by _reap_procs().
+ * prog IN		- program to run
+ * node_bitmap IN	- bitmap of the nodes to change state
+ * arg2 IN		- second program argument or NULL
+ * op IN		- descriptive word for logging (e.g. "waking")
+ */
+static void _run_prog_batches(char *prog, bitstr_t *node_bitmap, char *arg2,
+			      char *op)
 {
-	pid_t pid = _run_prog(suspend_prog, host, NULL);
+	bitstr_t *batch_bitmap;
+	char *nodes;
+	pid_t pid;
+	int batch_size = 0, i;
+
+	batch_bitmap = bit_alloc(node_record_count);
+	for (i = 0; i < node_record_count; i++) {
+		if (!bit_test(node_bitmap, i))
+			continue;
+		bit_set(batch_bitmap, i);
+		if (++batch_size < NODES_PER_PROG)
+			continue;
+		nodes = bitmap2node_name(batch_bitmap);
+		if (nodes) {
+			pid = _run_prog(prog, nodes, arg2);
+#if _DEBUG
+			info("power_save: pid %d %s nodes %s",
+			     (int) pid, op, nodes);
+#else
+			verbose("power_save: pid %d %s nodes %s",
+				(int) pid, op, nodes);
+#endif
+		} else
+			error("power_save: bitmap2nodename");
+		xfree(nodes);
+		bit_nclear(batch_bitmap, 0, (node_record_count - 1));
+		batch_size = 0;
+	}
+	if (batch_size) {
+		nodes = bitmap2node_name(batch_bitmap);
+		if (nodes) {
+			pid = _run_prog(prog, nodes, arg2);
 #if _DEBUG
-	info("power_save: pid %d suspending nodes %s", (int) pid, host);
+			info("power_save: pid %d %s nodes %s",
+			     (int) pid, op, nodes);
 #else
-	verbose("power_save: pid %d suspending nodes %s", (int) pid, host);
+			verbose("power_save: pid %d %s nodes %s",
+				(int) pid, op, nodes);
 #endif
+		} else
+			error("power_save: bitmap2nodename");
+		xfree(nodes);
+	}
+	FREE_NULL_BITMAP(batch_bitmap);
 }
 
 /* run a suspend or resume program
@@ -722,7 +757,9 @@ static void *_init_power_save(void *arg)
 	while (slurmctld_config.shutdown_time == 0) {
 		sleep(1);
 
-		if (_reap_procs() < 2) {
+		/* Keep enough free process slots for a full scan worth of
+		 * concurrent batch invocations */
+		if (_reap_procs() < (PID_CNT / 8)) {
 			debug("power_save programs getting backlogged");
 			continue;
 		}
@@ -64,6 +64,77 @@
 #define L_NUM_FREQ	"NumFreqChoices"
 #define L_CUR_POWER	"CurrentCorePower"
 
+/* Lifetime of the cached power summaries below. The per-node watts values
+ * come from layouts.d/power.conf and the cap_watts value from the
+ * PowerParameters string, both of which change only on reconfiguration or
+ * an explicit update, while the functions reading them run for every job
+ * placement attempt when capping is enabled. A short expiration bounds the
+ * delay before an out-of-band update (e.g. "scontrol update layouts") is
+ * taken into account without rescanning the layout on every call. */
+#define PCAP_CACHE_SECS 2
+
+/* Per-node copy of the static watts values of the power layout */
+typedef struct pcap_node_watts {
+	uint32_t max_watts;
+	uint32_t idle_watts;
+	uint32_t down_watts;
+	uint32_t save_watts;
+} pcap_node_watts_t;
+
+static pcap_node_watts_t *pcap_watts_tbl = NULL;
+static int    pcap_watts_cnt = 0;
+static time_t pcap_watts_time = (time_t) 0;
+static bool   pcap_layout_ready = false;
+static uint32_t pcap_min_watts = 0;
+
+static uint32_t pcap_cur_cap = 0;
+static time_t pcap_cur_cap_time = (time_t) 0;
+
+/* Build or refresh the per-node watts table and the cluster min watts sum
+ * from the power layout. Also records whether every node was found in the
+ * layout (see power_layout_ready()). No-op while the cache is fresh. */
+static void _build_watts_cache(void)
+{
+	static time_t last_error_time = (time_t) 0;
+	time_t now = time(NULL);
+	struct node_record *node_ptr;
+	uint32_t data[4], node_min;
+	int i;
+
+	if (pcap_watts_tbl && (pcap_watts_cnt == node_record_count) &&
+	    (difftime(now, pcap_watts_time) < PCAP_CACHE_SECS))
+		return;
+
+	xfree(pcap_watts_tbl);
+	pcap_watts_cnt = node_record_count;
+	pcap_watts_tbl = xmalloc(sizeof(pcap_node_watts_t) * pcap_watts_cnt);
+	pcap_watts_time = now;
+	pcap_layout_ready = true;
+	pcap_min_watts = 0;
+	for (i = 0, node_ptr = node_record_table_ptr; i < node_record_count;
+	     i++, node_ptr++) {
+		if (layouts_entity_get_mkv(L_NAME, node_ptr->name,
+		    "MaxWatts,IdleWatts,DownWatts,PowerSaveWatts", data,
+		    (sizeof(uint32_t) * 4), L_T_UINT32)) {
+			pcap_layout_ready = false;
+			/* Limit error message frequency, once per minute */
+			if (difftime(now, last_error_time) < 60)
+				return;
+			last_error_time = now;
+			error("%s: node %s is not in the layouts.d/power.conf file",
+			      __func__, node_ptr->name);
+			return;
+		}
+		pcap_watts_tbl[i].max_watts  = data[0];
+		pcap_watts_tbl[i].idle_watts = data[1];
+		pcap_watts_tbl[i].down_watts = data[2];
+		pcap_watts_tbl[i].save_watts = data[3];
+		node_min = MIN(data[1], data[2]);
+		node_min = MIN(node_min, data[3]);
+		pcap_min_watts += node_min;
+	}
+}
+
 static bool _powercap_enabled(void)
 {
 	if (powercap_get_cluster_current_cap() == 0)
@@ -101,27 +172,8 @@ int which_power_layout(void)
 
 bool power_layout_ready(void)
 {
-	static time_t last_error_time = (time_t) 0;
-	time_t now = time(NULL);
-	struct node_record *node_ptr;
-	uint32_t data[2];
-	int i;
-
-	for (i = 0, node_ptr = node_record_table_ptr; i < node_record_count;
-	     i++, node_ptr++) {
-		if (layouts_entity_get_mkv(L_NAME, node_ptr->name,
-		    "MaxWatts,IdleWatts", data, (sizeof(uint32_t) * 2),
-		    L_T_UINT32)) {
-			/* Limit error message frequency, once per minute */
-			if (difftime(now, last_error_time) < 60)
-				return false;
-			last_error_time = now;
-			error("%s: node %s is not in the layouts.d/power.conf file",
-			     __func__, node_ptr->name);
-			return false;
-		}
-	}
-	return true;
+	_build_watts_cache();
+	return pcap_layout_ready;
 }
 
 
@@ -143,40 +195,32 @@ uint32_t powercap_get_cluster_max_watts(void)
 
 uint32_t powercap_get_cluster_min_watts(void)
 {
-	uint32_t min_watts = 0, tmp_watts, save_watts, down_watts;
-	struct node_record *node_ptr;
-	int i;
-
 	if (!_powercap_enabled())
 		return 0;
-	
+
 	if (!power_layout_ready())
 		return 0;
 
-	for (i = 0, node_ptr = node_record_table_ptr; i < node_record_count;
-	     i++, node_ptr++) {
-		layouts_entity_get_kv(L_NAME, node_ptr->name, L_NODE_IDLE,
-					  &tmp_watts, L_T_UINT32);
-		layouts_entity_get_kv(L_NAME, node_ptr->name, L_NODE_DOWN,
-					  &down_watts, L_T_UINT32);
-		tmp_watts = MIN(tmp_watts, down_watts);
-		layouts_entity_get_kv(L_NAME, node_ptr->name, L_NODE_SAVE,
-					  &save_watts, L_T_UINT32);
-		tmp_watts = MIN(tmp_watts, save_watts);
-		min_watts += tmp_watts;
-	}
-
-	return min_watts;
+	/* maintained by _build_watts_cache() */
+	return pcap_min_watts;
 }
 
 uint32_t powercap_get_cluster_current_cap(void)
 {
 	char *end_ptr = NULL, *sched_params, *tmp_ptr;
 	uint32_t cap_watts = 0;
+	time_t now = time(NULL);
+
+	if (pcap_cur_cap_time &&
+	    (difftime(now, pcap_cur_cap_time) < PCAP_CACHE_SECS))
+		return pcap_cur_cap;
 
 	sched_params = slurm_get_power_parameters();
-	if (!sched_params)
+	if (!sched_params) {
+		pcap_cur_cap = cap_watts;
+		pcap_cur_cap_time = now;
 		return cap_watts;
+	}
 
 	if ((tmp_ptr = strstr(sched_params, "cap_watts=INFINITE"))) {
 		cap_watts = INFINITE;
@@ -192,6 +236,9 @@ uint32_t powercap_get_cluster_current_cap(void)
 	}
 	xfree(sched_params);
 
+	pcap_cur_cap = cap_watts;
+	pcap_cur_cap_time = now;
+
 	return cap_watts;
 }
 
@@ -238,32 +285,28 @@ int powercap_set_cluster_cap(uint32_t new_cap)
 	power_g_reconfig();
 	xfree(sched_params);
 
+	/* force the next powercap_get_cluster_current_cap() to re-parse */
+	pcap_cur_cap_time = (time_t) 0;
+
 	return 0;
 }
 
 uint32_t powercap_get_cluster_adjusted_max_watts(void)
 {
-	uint32_t adj_max_watts = 0,val;
-	struct node_record *node_ptr;
+	uint32_t adj_max_watts = 0;
 	int i;
 
 	if (!_powercap_enabled())
 		return 0;
 	if (!power_layout_ready())
 		return 0;
-	for (i = 0, node_ptr = node_record_table_ptr; i < node_record_count;
-	     i++, node_ptr++) {
-		if (bit_test(power_node_bitmap, i)) {
-			layouts_entity_get_kv(L_NAME, node_ptr->name,
-					L_NODE_SAVE, &val, L_T_UINT32);
-		} else if (!bit_test(up_node_bitmap, i)) {
-			layouts_entity_get_kv(L_NAME, node_ptr->name,
-					L_NODE_DOWN, &val, L_T_UINT32);
-		} else {
-			layouts_entity_get_kv(L_NAME, node_ptr->name,
-					L_NODE_MAX, &val, L_T_UINT32);
-		}
-		adj_max_watts += val;
+	for (i = 0; i < node_record_count; i++) {
+		if (bit_test(power_node_bitmap, i))
+			adj_max_watts += pcap_watts_tbl[i].save_watts;
+		else if (!bit_test(up_node_bitmap, i))
+			adj_max_watts += pcap_watts_tbl[i].down_watts;
+		else
+			adj_max_watts += pcap_watts_tbl[i].max_watts;
 	}
 
 	return adj_max_watts;
@@ -290,8 +333,7 @@ uint32_t powercap_get_cluster_current_max_watts(void)
 
 uint32_t powercap_get_node_bitmap_maxwatts(bitstr_t *idle_bitmap)
 {
-	uint32_t max_watts = 0, val;
-	struct node_record *node_ptr;
+	uint32_t max_watts = 0;
 	int i;
 	bitstr_t *tmp_bitmap = NULL;
 
@@ -300,41 +342,29 @@ uint32_t powercap_get_node_bitmap_maxwatts(bitstr_t *idle_bitmap)
 	if (!power_layout_ready())
 		return 0;
 
-	/* if no input bitmap, consider the current idle nodes 
-	 * bitmap as the input bitmap tagging nodes to consider 
+	/* if no input bitmap, consider the current idle nodes
+	 * bitmap as the input bitmap tagging nodes to consider
 	 * as idle while computing the max watts of the cluster */
 	if (idle_bitmap == NULL) {
 		tmp_bitmap = bit_copy(idle_node_bitmap);
 		idle_bitmap = tmp_bitmap;
 	}
 
-	for (i = 0, node_ptr = node_record_table_ptr; i < node_record_count;
-	     i++, node_ptr++) {
+	for (i = 0; i < node_record_count; i++) {
 		/* non reserved node, evaluate the different cases */
 		if (bit_test(idle_bitmap, i)) {
 			 /* idle nodes, 2 cases : power save or not */
-			if (bit_test(power_node_bitmap, i)) {
-				layouts_entity_get_kv(L_NAME,
-						node_ptr->name, L_NODE_SAVE,
-						&val, L_T_UINT32);
-			} else {
-				layouts_entity_get_kv(L_NAME,
-						node_ptr->name, L_NODE_IDLE,
-						&val, L_T_UINT32);
-			}
+			if (bit_test(power_node_bitmap, i))
+				max_watts += pcap_watts_tbl[i].save_watts;
+			else
+				max_watts += pcap_watts_tbl[i].idle_watts;
 		} else {
 			/* non idle nodes, 2 cases : down or not */
-			if (!bit_test(up_node_bitmap, i)) {
-				layouts_entity_get_kv(L_NAME, 
-						node_ptr->name, L_NODE_DOWN,
-						&val, L_T_UINT32);
-			} else {
-				layouts_entity_get_kv(L_NAME,
-						node_ptr->name, L_NODE_MAX,
-						&val, L_T_UINT32);
-			}
+			if (!bit_test(up_node_bitmap, i))
+				max_watts += pcap_watts_tbl[i].down_watts;
+			else
+				max_watts += pcap_watts_tbl[i].max_watts;
 		}
-		max_watts += val;	
 	}
 
 	if (tmp_bitmap)
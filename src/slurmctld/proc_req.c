@@ -74,6 +74,7 @@
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/slurm_topology.h"
 #include "src/common/switch.h"
+#include "src/common/timers.h"
 #include "src/common/xstring.h"
 
 #include "src/slurmctld/agent.h"
@@ -98,10 +99,16 @@
 #include "src/plugins/select/bluegene/bg_enums.h"
 
 static pthread_mutex_t rpc_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Power-of-two latency histogram buckets per RPC type, bucket b counts
+ * RPCs processed in less than 2^(b+1) usec (last bucket is unbounded,
+ * 2^23 usec is about 8.4 seconds) */
+#define RPC_TIME_HIST_BUCKETS 24
+
 static int rpc_type_size = 0;	/* Size of rpc_type_* arrays */
 static uint16_t *rpc_type_id = NULL;
 static uint32_t *rpc_type_cnt = NULL;
 static uint64_t *rpc_type_time = NULL;
+static uint64_t *rpc_type_hist = NULL;
 static int rpc_user_size = 0;	/* Size of rpc_user_* arrays */
 static uint32_t *rpc_user_id = NULL;
 static uint32_t *rpc_user_cnt = NULL;
@@ -159,6 +166,7 @@ inline static void  _slurm_rpc_get_topo(slurm_msg_t * msg);
 inline static void  _slurm_rpc_get_powercap(slurm_msg_t * msg);
 inline static void  _slurm_rpc_get_priority_factors(slurm_msg_t *msg);
 inline static void  _slurm_rpc_job_notify(slurm_msg_t * msg);
+inline static void  _slurm_rpc_job_state_subscribe(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_ready(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_sbcast_cred(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_step_kill(slurm_msg_t * msg);
@@ -168,6 +176,7 @@ inline static void  _slurm_rpc_job_will_run(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_alloc_info(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_alloc_info_lite(slurm_msg_t * msg);
 inline static void  _slurm_rpc_kill_job2(slurm_msg_t *msg);
+inline static void  _slurm_rpc_kill_jobs(slurm_msg_t *msg);
 inline static void  _slurm_rpc_node_registration(slurm_msg_t *msg,
 						 bool running_composite);
 inline static void  _slurm_rpc_ping(slurm_msg_t * msg);
@@ -191,6 +200,7 @@ inline static void  _slurm_rpc_step_complete(slurm_msg_t * msg,
 inline static void  _slurm_rpc_step_layout(slurm_msg_t * msg);
 inline static void  _slurm_rpc_step_update(slurm_msg_t * msg);
 inline static void  _slurm_rpc_submit_batch_job(slurm_msg_t * msg);
+inline static void  _slurm_rpc_submit_batch_jobs(slurm_msg_t * msg);
 inline static void  _slurm_rpc_suspend(slurm_msg_t * msg);
 inline static void  _slurm_rpc_top_job(slurm_msg_t * msg);
 inline static void  _slurm_rpc_trigger_clear(slurm_msg_t * msg);
@@ -212,12 +222,28 @@ static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 				      List msg_list_in,
 				      struct timeval *start_tv,
 				      int timeout);
+static int   _epilog_complete_sort(void *x, void *y);
+static void  _epilog_complete_batch(List batch_list, bool *run_scheduler,
+				    List msg_list_in,
+				    struct timeval *start_tv, int timeout);
+static void  _node_registration_batch(List batch_list, List msg_list_in,
+				      struct timeval *start_tv, int timeout);
 static void  _slurm_rpc_assoc_mgr_info(slurm_msg_t * msg);
 
 static void  _set_persist_thread_name(connection_arg_t *arg);
 
 extern diag_stats_t slurmctld_diag_stats;
 
+/* Map an RPC processing time in usec to its latency histogram bucket */
+static int _rpc_time_bucket(uint64_t usec)
+{
+	int bucket = 0;
+
+	while ((usec >>= 1) && (bucket < (RPC_TIME_HIST_BUCKETS - 1)))
+		bucket++;
+	return bucket;
+}
+
 /*
  * slurmctld_req  - Process an individual RPC request
  * IN/OUT msg - the request message, data associated with the message is freed
@@ -242,6 +268,8 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		rpc_type_id   = xmalloc(sizeof(uint16_t) * rpc_type_size);
 		rpc_type_cnt  = xmalloc(sizeof(uint32_t) * rpc_type_size);
 		rpc_type_time = xmalloc(sizeof(uint64_t) * rpc_type_size);
+		rpc_type_hist = xmalloc(sizeof(uint64_t) * rpc_type_size *
+					RPC_TIME_HIST_BUCKETS);
 	}
 	for (i = 0; i < rpc_type_size; i++) {
 		if (rpc_type_id[i] == 0)
@@ -281,6 +309,7 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		info("%s: received opcode %s from %s", __func__, p, inetbuf);
 	}
 
+	prof_region_begin("slurmctld_req");
 	switch (msg->msg_type) {
 	case REQUEST_RESOURCE_ALLOCATION:
 		_slurm_rpc_allocate_resources(msg);
@@ -381,6 +410,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_SUBMIT_BATCH_JOB:
 		_slurm_rpc_submit_batch_job(msg);
 		break;
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		_slurm_rpc_submit_batch_jobs(msg);
+		break;
 	case REQUEST_UPDATE_FRONT_END:
 		_slurm_rpc_update_front_end(msg);
 		break;
@@ -477,6 +509,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_JOB_NOTIFY:
 		_slurm_rpc_job_notify(msg);
 		break;
+	case REQUEST_JOB_STATE_SUBSCRIBE:
+		_slurm_rpc_job_state_subscribe(msg);
+		break;
 	case REQUEST_SET_DEBUG_FLAGS:
 		_slurm_rpc_set_debug_flags(msg);
 		break;
@@ -516,6 +551,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_KILL_JOB:
 		_slurm_rpc_kill_job2(msg);
 		break;
+	case REQUEST_KILL_JOBS:
+		_slurm_rpc_kill_jobs(msg);
+		break;
 	case MESSAGE_COMPOSITE:
 		_slurm_rpc_composite_msg(msg);
 		break;
@@ -539,12 +577,15 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		slurm_send_rc_msg(msg, EINVAL);
 		break;
 	}
+	prof_region_end("slurmctld_req");
 
 	END_TIMER;
 	slurm_mutex_lock(&rpc_mutex);
 	if (rpc_type_index >= 0) {
 		rpc_type_cnt[rpc_type_index]++;
 		rpc_type_time[rpc_type_index] += DELTA_TIMER;
+		rpc_type_hist[(rpc_type_index * RPC_TIME_HIST_BUCKETS) +
+			      _rpc_time_bucket(DELTA_TIMER)]++;
 	}
 	if (rpc_user_index >= 0) {
 		rpc_user_cnt[rpc_user_index]++;
@@ -1297,7 +1338,8 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 			      job_info_request_msg->show_flags,
 			      g_slurm_auth_get_uid(msg->auth_cred,
 						   slurmctld_config.auth_info),
-			      NO_VAL, msg->protocol_version);
+			      NO_VAL, job_info_request_msg,
+			      msg->protocol_version);
 		unlock_slurmctld(job_read_lock);
 		END_TIMER2("_slurm_rpc_dump_jobs");
 #if 0
@@ -1341,7 +1383,8 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 		      job_info_request_msg->show_flags,
 		      g_slurm_auth_get_uid(msg->auth_cred,
 					   slurmctld_config.auth_info),
-		      job_info_request_msg->user_id, msg->protocol_version);
+		      job_info_request_msg->user_id, NULL,
+		      msg->protocol_version);
 	unlock_slurmctld(job_read_lock);
 	END_TIMER2("_slurm_rpc_dump_job_user");
 #if 0
@@ -3063,7 +3106,7 @@ static void _slurm_rpc_reconfigure_controller(slurm_msg_t * msg)
 		debug("sched: begin reconfiguration");
 		lock_slurmctld(config_write_lock);
 		in_progress = true;
-		error_code = read_slurm_conf(1, true);
+		error_code = read_slurm_conf_diff(1, true);
 		if (error_code == SLURM_SUCCESS) {
 			_update_cred_key();
 			set_slurmctld_state_loc();
@@ -3588,6 +3631,146 @@ static void _slurm_rpc_submit_batch_job(slurm_msg_t * msg)
 fini:	xfree(err_msg);
 }
 
+/* _slurm_rpc_submit_batch_jobs - process RPC to submit a list of batch jobs
+ *	under a single job write lock acquisition */
+static void _slurm_rpc_submit_batch_jobs(slurm_msg_t * msg)
+{
+	static int active_rpc_cnt = 0;
+	int error_code;
+	DEF_TIMERS;
+	uint32_t i, accept_cnt = 0;
+	struct job_record *job_ptr;
+	slurm_msg_t response_msg;
+	submit_response_list_msg_t resp_list_msg;
+	job_desc_list_msg_t *job_desc_list_msg =
+		(job_desc_list_msg_t *) msg->data;
+	job_desc_msg_t *job_desc_msg;
+	/* Locks: Read config, read job, read node, read partition */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+	/* Locks: Write job, read node, read partition */
+	slurmctld_lock_t job_write_lock = {
+		NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
+					 slurmctld_config.auth_info);
+	char *err_msg = NULL;
+	bool reject_job;
+
+	START_TIMER;
+	debug2("Processing RPC: REQUEST_SUBMIT_BATCH_JOBS (%u jobs) from "
+	       "uid=%d", job_desc_list_msg->job_count, uid);
+
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+
+	if (job_desc_list_msg->job_count == 0) {
+		slurm_send_rc_msg(msg, ESLURM_INVALID_JOB_ID);
+		return;
+	}
+
+	resp_list_msg.resp_count = job_desc_list_msg->job_count;
+	resp_list_msg.resps = xmalloc(sizeof(submit_response_msg_t) *
+				      job_desc_list_msg->job_count);
+
+	/* Validate each request. No job id re-use or batch job step launch
+	 * is supported on this path, only new job submissions. */
+	for (i = 0; i < job_desc_list_msg->job_count; i++) {
+		job_desc_msg = job_desc_list_msg->job_descs[i];
+		error_code = SLURM_SUCCESS;
+		if ((uid != job_desc_msg->user_id) &&
+		    (!validate_super_user(uid))) {
+			/* NOTE: Super root can submit a job for any user */
+			error_code = ESLURM_USER_ID_MISSING;
+			error("Security violation, SUBMIT_JOBS from uid=%d",
+			      uid);
+		} else if ((job_desc_msg->alloc_node == NULL) ||
+			   (job_desc_msg->alloc_node[0] == '\0')) {
+			error_code = ESLURM_INVALID_NODE_NAME;
+			error("REQUEST_SUBMIT_BATCH_JOBS lacks alloc_node "
+			      "from uid=%d", uid);
+		} else if (job_desc_msg->job_id != SLURM_BATCH_SCRIPT) {
+			error_code = ESLURM_INVALID_JOB_ID;
+			info("REQUEST_SUBMIT_BATCH_JOBS with explicit job id "
+			     "%u rejected", job_desc_msg->job_id);
+		}
+		resp_list_msg.resps[i].job_id     = NO_VAL;
+		resp_list_msg.resps[i].step_id    = SLURM_BATCH_SCRIPT;
+		resp_list_msg.resps[i].error_code = error_code;
+	}
+
+	/* Locks are for job_submit plugin use */
+	lock_slurmctld(job_read_lock);
+	for (i = 0; i < job_desc_list_msg->job_count; i++) {
+		if (resp_list_msg.resps[i].error_code != SLURM_SUCCESS)
+			continue;
+		job_desc_msg = job_desc_list_msg->job_descs[i];
+		resp_list_msg.resps[i].error_code =
+			validate_job_create_req(job_desc_msg, uid, &err_msg);
+		xfree(err_msg);
+	}
+	unlock_slurmctld(job_read_lock);
+
+	/* Create all new job allocations under one write lock */
+	_throttle_start(&active_rpc_cnt);
+	lock_slurmctld(job_write_lock);
+	START_TIMER;	/* Restart after we have locks */
+	for (i = 0; i < job_desc_list_msg->job_count; i++) {
+		if (resp_list_msg.resps[i].error_code != SLURM_SUCCESS)
+			continue;
+		job_desc_msg = job_desc_list_msg->job_descs[i];
+		job_ptr = NULL;
+		error_code = job_allocate(job_desc_msg,
+					  job_desc_msg->immediate, false,
+					  NULL, 0, uid, &job_ptr, &err_msg,
+					  msg->protocol_version);
+		xfree(err_msg);
+		if (job_desc_msg->immediate && (error_code != SLURM_SUCCESS))
+			error_code = ESLURM_CAN_NOT_START_IMMEDIATELY;
+
+		reject_job = false;
+		if ((error_code != SLURM_SUCCESS) &&
+		    (error_code != ESLURM_JOB_HELD) &&
+		    (error_code != ESLURM_NODE_NOT_AVAIL) &&
+		    (error_code != ESLURM_QOS_THRES) &&
+		    (error_code != ESLURM_RESERVATION_NOT_USABLE) &&
+		    (error_code != ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE) &&
+		    (error_code != ESLURM_POWER_NOT_AVAIL) &&
+		    (error_code != ESLURM_POWER_RESERVED)) {
+			reject_job = true;
+		}
+		if ((error_code == ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE) &&
+		    (slurmctld_conf.enforce_part_limits !=
+		     PARTITION_ENFORCE_NONE))
+			reject_job = true;
+
+		if (reject_job || !job_ptr) {
+			info("_slurm_rpc_submit_batch_jobs: %s",
+			     slurm_strerror(error_code));
+		} else {
+			resp_list_msg.resps[i].job_id = job_ptr->job_id;
+			accept_cnt++;
+		}
+		resp_list_msg.resps[i].error_code = error_code;
+	}
+	unlock_slurmctld(job_write_lock);
+	_throttle_fini(&active_rpc_cnt);
+	END_TIMER2("_slurm_rpc_submit_batch_jobs");
+
+	info("_slurm_rpc_submit_batch_jobs: %u of %u jobs accepted %s",
+	     accept_cnt, job_desc_list_msg->job_count, TIME_STR);
+	response_msg.msg_type = RESPONSE_SUBMIT_BATCH_JOBS;
+	response_msg.data = &resp_list_msg;
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(resp_list_msg.resps);
+
+	if (accept_cnt) {
+		schedule_job_save();	/* Has own locks */
+		schedule_node_save();	/* Has own locks */
+		queue_job_scheduler();
+	}
+}
+
 /* _slurm_rpc_update_job - process RPC to update the configuration of a
  * job (e.g. priority)
  */
@@ -5150,6 +5333,59 @@ inline static void  _slurm_rpc_job_notify(slurm_msg_t * msg)
 	slurm_send_rc_msg(msg, error_code);
 }
 
+/* _slurm_rpc_job_state_subscribe - register the requesting client for a
+ * push notification (SRUN_JOB_COMPLETE via the srun_comm.c machinery) when
+ * the job terminates, so clients such as "sbatch --wait" need not poll */
+inline static void  _slurm_rpc_job_state_subscribe(slurm_msg_t * msg)
+{
+	int error_code = SLURM_SUCCESS;
+	/* Locks: write job */
+	slurmctld_lock_t job_write_lock = {
+		NO_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
+					 slurmctld_config.auth_info);
+	job_state_subscribe_msg_t *sub_msg =
+		(job_state_subscribe_msg_t *) msg->data;
+	struct job_record *job_ptr;
+	slurm_addr_t resp_addr;
+	char resp_host[16];
+	uint16_t port;
+	DEF_TIMERS;
+
+	START_TIMER;
+	debug2("Processing RPC: REQUEST_JOB_STATE_SUBSCRIBE from uid=%d", uid);
+
+	if (slurm_get_peer_addr(msg->conn_fd, &resp_addr)) {
+		error("%s: slurm_get_peer_addr: %m", __func__);
+		slurm_send_rc_msg(msg, SLURM_ERROR);
+		return;
+	}
+	slurm_get_ip_str(&resp_addr, &port, resp_host, sizeof(resp_host));
+
+	lock_slurmctld(job_write_lock);
+	job_ptr = find_job_record(sub_msg->job_id);
+	if (!job_ptr)
+		error_code = ESLURM_INVALID_JOB_ID;
+	else if ((job_ptr->user_id != uid) && !validate_slurm_user(uid)) {
+		error_code = ESLURM_USER_ID_MISSING;
+		error("Security violation, REQUEST_JOB_STATE_SUBSCRIBE RPC "
+		      "from uid=%d for jobid %u owner %d",
+		      uid, sub_msg->job_id, job_ptr->user_id);
+	} else if (IS_JOB_FINISHED(job_ptr)) {
+		/* No transition will follow; the client should collect the
+		 * final job state directly */
+		error_code = ESLURM_ALREADY_DONE;
+	} else {
+		job_ptr->other_port = sub_msg->port;
+		xfree(job_ptr->resp_host);
+		job_ptr->resp_host = xstrdup(resp_host);
+	}
+	unlock_slurmctld(job_write_lock);
+
+	END_TIMER2("_slurm_rpc_job_state_subscribe");
+	slurm_send_rc_msg(msg, error_code);
+}
+
 inline static void  _slurm_rpc_set_debug_flags(slurm_msg_t *msg)
 {
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
@@ -5566,6 +5802,10 @@ static void _clear_rpc_stats(void)
 		rpc_type_id[i] = 0;
 		rpc_type_time[i] = 0;
 	}
+	if (rpc_type_hist) {
+		memset(rpc_type_hist, 0, sizeof(uint64_t) * rpc_type_size *
+		       RPC_TIME_HIST_BUCKETS);
+	}
 	for (i = 0; i < rpc_user_size; i++) {
 		rpc_user_cnt[i] = 0;
 		rpc_user_id[i] = 0;
@@ -5600,6 +5840,68 @@ static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
 	pack32_array(rpc_user_id,   i, buffer);
 	pack32_array(rpc_user_cnt,  i, buffer);
 	pack64_array(rpc_user_time, i, buffer);
+
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		slurmctld_lock_stats_t lock_stats;
+
+		for (i = 0; i < rpc_type_size; i++) {
+			if (rpc_type_id[i] == 0)
+				break;
+		}
+		pack32(RPC_TIME_HIST_BUCKETS, buffer);
+		pack64_array(rpc_type_hist, i * RPC_TIME_HIST_BUCKETS,
+			     buffer);
+
+		get_lock_stats(&lock_stats);
+		pack32(ENTITY_COUNT, buffer);
+		pack64_array(lock_stats.read_cnt,   ENTITY_COUNT, buffer);
+		pack64_array(lock_stats.read_wait,  ENTITY_COUNT, buffer);
+		pack64_array(lock_stats.write_cnt,  ENTITY_COUNT, buffer);
+		pack64_array(lock_stats.write_wait, ENTITY_COUNT, buffer);
+		pack64_array(lock_stats.write_hold, ENTITY_COUNT, buffer);
+
+		{	/* job/step record pool occupancy */
+			uint32_t pool_occ[REC_POOL_COUNT];
+			uint64_t pool_allocs[REC_POOL_COUNT];
+			uint64_t pool_reuses[REC_POOL_COUNT];
+
+			rec_pool_get_stats(pool_occ, pool_allocs,
+					   pool_reuses);
+			pack32(REC_POOL_COUNT, buffer);
+			pack32_array(pool_occ,    REC_POOL_COUNT, buffer);
+			pack64_array(pool_allocs, REC_POOL_COUNT, buffer);
+			pack64_array(pool_reuses, REC_POOL_COUNT, buffer);
+		}
+
+		{	/* profiling region aggregates */
+			char **prof_names;
+			uint64_t *prof_cnt, *prof_time, *prof_min;
+			uint64_t *prof_max, *prof_p99;
+			uint32_t j, prof_size;
+
+			prof_size = prof_region_snapshot(&prof_names,
+							 &prof_cnt,
+							 &prof_time,
+							 &prof_min,
+							 &prof_max,
+							 &prof_p99);
+			pack32(prof_size, buffer);
+			packstr_array(prof_names, prof_size, buffer);
+			pack64_array(prof_cnt,  prof_size, buffer);
+			pack64_array(prof_time, prof_size, buffer);
+			pack64_array(prof_min,  prof_size, buffer);
+			pack64_array(prof_max,  prof_size, buffer);
+			pack64_array(prof_p99,  prof_size, buffer);
+			for (j = 0; j < prof_size; j++)
+				xfree(prof_names[j]);
+			xfree(prof_names);
+			xfree(prof_cnt);
+			xfree(prof_time);
+			xfree(prof_min);
+			xfree(prof_max);
+			xfree(prof_p99);
+		}
+	}
 	slurm_mutex_unlock(&rpc_mutex);
 
 	*buffer_size = get_buf_offset(buffer);
@@ -5637,6 +5939,9 @@ inline static void _slurm_rpc_dump_stats(slurm_msg_t * msg)
 	if (request_msg->command_id == STAT_COMMAND_RESET) {
 		reset_stats(1);
 		_clear_rpc_stats();
+		reset_lock_stats();
+		rec_pool_reset_stats();
+		prof_region_reset();
 		pack_all_stat(0, &dump, &dump_size, msg->protocol_version);
 		_pack_rpc_stats(0, &dump, &dump_size, msg->protocol_version);
 		response_msg.data = dump;
@@ -5770,6 +6075,57 @@ _slurm_rpc_kill_job2(slurm_msg_t *msg)
 	END_TIMER2("_slurm_rpc_kill_job2");
 }
 
+/* _slurm_rpc_kill_jobs() - signal a set of jobs within a single lock
+ * window rather than paying the RPC and lock overhead per job */
+inline static void
+_slurm_rpc_kill_jobs(slurm_msg_t *msg)
+{
+	static int active_rpc_cnt = 0;
+	DEF_TIMERS;
+	kill_jobs_msg_t *kill;
+	slurmctld_lock_t lock = {READ_LOCK, WRITE_LOCK,
+				 WRITE_LOCK, NO_LOCK, NO_LOCK };
+	uid_t uid;
+	uint32_t i;
+	int cc, rc = SLURM_SUCCESS;
+
+	kill =	(kill_jobs_msg_t *)msg->data;
+	uid = g_slurm_auth_get_uid(msg->auth_cred,
+				   slurmctld_config.auth_info);
+
+	START_TIMER;
+	info("%s: REQUEST_KILL_JOBS %u jobs uid %d",
+	     __func__, kill->job_cnt, uid);
+
+	_throttle_start(&active_rpc_cnt);
+	lock_slurmctld(lock);
+	for (i = 0; i < kill->job_cnt; i++) {
+		cc = job_str_signal(kill->job_ids[i],
+				    kill->signal,
+				    kill->flags,
+				    uid,
+				    0);
+		if (cc == ESLURM_ALREADY_DONE) {
+			debug2("%s: job_str_signal() job %s sig %d "
+			       "returned %s", __func__, kill->job_ids[i],
+			       kill->signal, slurm_strerror(cc));
+		} else if (cc != SLURM_SUCCESS) {
+			info("%s: job_str_signal() job %s sig %d returned %s",
+			     __func__, kill->job_ids[i],
+			     kill->signal, slurm_strerror(cc));
+			rc = cc;
+		} else {
+			slurmctld_diag_stats.jobs_canceled++;
+		}
+	}
+	unlock_slurmctld(lock);
+	_throttle_fini(&active_rpc_cnt);
+
+	slurm_send_rc_msg(msg, rc);
+
+	END_TIMER2("_slurm_rpc_kill_jobs");
+}
+
 /* Return the number of micro-seconds between now and argument "tv" */
 static int _delta_tv(struct timeval *tv)
 {
@@ -5900,6 +6256,7 @@ static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 	slurm_msg_t *next_msg;
 	composite_msg_t *ncomp_msg;
 	composite_msg_t *comp_resp_msg;
+	List epilog_batch = NULL, node_reg_batch = NULL;
 	/* Locks: Read configuration, write job, write node */
 	slurmctld_lock_t job_write_lock = {
 		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
@@ -5975,10 +6332,16 @@ static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 			_slurm_rpc_step_complete(next_msg, 1);
 			break;
 		case MESSAGE_EPILOG_COMPLETE:
-			_slurm_rpc_epilog_complete(next_msg, run_scheduler, 1);
+			/* Defer and batch these, sorted by job ID */
+			if (!epilog_batch)
+				epilog_batch = list_create(NULL);
+			list_append(epilog_batch, next_msg);
 			break;
 		case MESSAGE_NODE_REGISTRATION_STATUS:
-			_slurm_rpc_node_registration(next_msg, 1);
+			/* Defer these so they see final job/node state */
+			if (!node_reg_batch)
+				node_reg_batch = list_create(NULL);
+			list_append(node_reg_batch, next_msg);
 			break;
 		default:
 			error("_slurm_rpc_comp_msg_list: invalid msg type");
@@ -5987,10 +6350,154 @@ static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 		next_msg->ret_list = NULL;
 	}
 	list_iterator_destroy(itr);
+
+	/* Apply the deferred messages while still holding the write locks
+	 * acquired by our caller. Epilog completes are applied first (they
+	 * release resources), then node registrations (so they validate
+	 * against the resulting job/node state). */
+	if (epilog_batch) {
+		list_sort(epilog_batch, _epilog_complete_sort);
+		_epilog_complete_batch(epilog_batch, run_scheduler,
+				       msg_list_in, start_tv, timeout);
+		FREE_NULL_LIST(epilog_batch);
+	}
+	if (node_reg_batch) {
+		_node_registration_batch(node_reg_batch, msg_list_in,
+					 start_tv, timeout);
+		FREE_NULL_LIST(node_reg_batch);
+	}
 	END_TIMER;
 	/* NOTE: RPC has no response */
 }
 
+/* Sort epilog complete messages by job ID so that a batch is applied with
+ * one job record lookup per job rather than one per node */
+static int _epilog_complete_sort(void *x, void *y)
+{
+	slurm_msg_t *msg1 = *(slurm_msg_t **) x;
+	slurm_msg_t *msg2 = *(slurm_msg_t **) y;
+	epilog_complete_msg_t *epilog_msg1 =
+		(epilog_complete_msg_t *) msg1->data;
+	epilog_complete_msg_t *epilog_msg2 =
+		(epilog_complete_msg_t *) msg2->data;
+
+	if (epilog_msg1->job_id < epilog_msg2->job_id)
+		return -1;
+	if (epilog_msg1->job_id > epilog_msg2->job_id)
+		return 1;
+	return 0;
+}
+
+/* Apply a batch of MESSAGE_EPILOG_COMPLETE messages, sorted by job ID.
+ * The job and node write locks must be held by the caller and are
+ * periodically yielded as in _slurm_rpc_comp_msg_list(). */
+static void _epilog_complete_batch(List batch_list, bool *run_scheduler,
+				   List msg_list_in,
+				   struct timeval *start_tv, int timeout)
+{
+	ListIterator itr;
+	slurm_msg_t *next_msg;
+	struct job_record *job_ptr = NULL;
+	uint32_t last_job_id = NO_VAL;
+	char jbuf[JBUFSIZ];
+	/* Locks: Read configuration, write job, write node */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
+	DEF_TIMERS;
+
+	START_TIMER;
+	itr = list_iterator_create(batch_list);
+	while ((next_msg = list_next(itr))) {
+		epilog_complete_msg_t *epilog_msg =
+			(epilog_complete_msg_t *) next_msg->data;
+		uid_t uid = g_slurm_auth_get_uid(next_msg->auth_cred,
+						 slurmctld_config.auth_info);
+
+		if (!validate_slurm_user(uid)) {
+			error("Security violation, EPILOG_COMPLETE RPC "
+			      "from uid=%d", uid);
+			continue;
+		}
+		if (_delta_tv(start_tv) >= timeout) {
+			END_TIMER;
+			if (slurmctld_conf.debug_flags & DEBUG_FLAG_ROUTE)
+				info("epilog complete batch processing "
+				     "yielding locks after running for %s",
+				     TIME_STR);
+			unlock_slurmctld(job_write_lock);
+			usleep(10);
+			lock_slurmctld(job_write_lock);
+			gettimeofday(start_tv, NULL);
+			START_TIMER;
+			/* The job could have been purged while unlocked */
+			last_job_id = NO_VAL;
+		}
+		if (slurmctld_conf.debug_flags & DEBUG_FLAG_ROUTE)
+			info("%s: node_name = %s, job_id = %u", __func__,
+			     epilog_msg->node_name, epilog_msg->job_id);
+
+		if (epilog_msg->job_id != last_job_id) {
+			job_ptr = find_job_record(epilog_msg->job_id);
+			last_job_id = epilog_msg->job_id;
+		}
+		FREE_NULL_LIST(next_msg->ret_list);
+		next_msg->ret_list = msg_list_in;
+		if (job_epilog_complete_ptr(job_ptr, epilog_msg->node_name,
+					    epilog_msg->return_code))
+			*run_scheduler = true;
+		next_msg->ret_list = NULL;
+
+		if (epilog_msg->return_code)
+			error("%s: epilog error %s Node=%s Err=%s",
+			      __func__, jobid2str(job_ptr, jbuf, sizeof(jbuf)),
+			      epilog_msg->node_name,
+			      slurm_strerror(epilog_msg->return_code));
+		else
+			debug2("%s: %s Node=%s", __func__,
+			       jobid2str(job_ptr, jbuf, sizeof(jbuf)),
+			       epilog_msg->node_name);
+	}
+	list_iterator_destroy(itr);
+	END_TIMER;
+}
+
+/* Apply a batch of MESSAGE_NODE_REGISTRATION_STATUS messages. The job and
+ * node write locks must be held by the caller and are periodically yielded
+ * as in _slurm_rpc_comp_msg_list(). */
+static void _node_registration_batch(List batch_list, List msg_list_in,
+				     struct timeval *start_tv, int timeout)
+{
+	ListIterator itr;
+	slurm_msg_t *next_msg;
+	/* Locks: Read configuration, write job, write node */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
+	DEF_TIMERS;
+
+	START_TIMER;
+	itr = list_iterator_create(batch_list);
+	while ((next_msg = list_next(itr))) {
+		if (_delta_tv(start_tv) >= timeout) {
+			END_TIMER;
+			if (slurmctld_conf.debug_flags & DEBUG_FLAG_ROUTE)
+				info("node registration batch processing "
+				     "yielding locks after running for %s",
+				     TIME_STR);
+			unlock_slurmctld(job_write_lock);
+			usleep(10);
+			lock_slurmctld(job_write_lock);
+			gettimeofday(start_tv, NULL);
+			START_TIMER;
+		}
+		FREE_NULL_LIST(next_msg->ret_list);
+		next_msg->ret_list = msg_list_in;
+		_slurm_rpc_node_registration(next_msg, 1);
+		next_msg->ret_list = NULL;
+	}
+	list_iterator_destroy(itr);
+	END_TIMER;
+}
+
 /* _slurm_rpc_assoc_mgr_info()
  *
  * Pack the assoc_mgr lists and return it back to the caller.
@@ -46,6 +46,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <syslog.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -82,6 +83,7 @@
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/node_scheduler.h"
+#include "src/slurmctld/numa_ctld.h"
 #include "src/slurmctld/port_mgr.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/proc_req.h"
@@ -97,16 +99,20 @@
 /* Global variables */
 List active_feature_list;	/* list of currently active features_records */
 List avail_feature_list;	/* list of available features_records */
+uint32_t node_feature_gen = 1;	/* see find_job_node_feature() */
 bool slurmctld_init_db = 1;
 
 static void _acct_restore_active_jobs(void);
 static void _add_config_feature(List feature_list, char *feature,
 				bitstr_t *node_bitmap);
+static int  _apply_partition_diff(void);
 static void _add_config_feature_inx(List feature_list, char *feature,
 				    int node_inx);
 static int  _build_bitmaps(void);
 static void _build_bitmaps_pre_select(void);
 static void _gres_reconfig(bool reconfig);
+static int  _hash_config_sections(uint64_t *base_hash, uint64_t *part_hash,
+				  bool *has_include);
 static int  _init_all_slurm_conf(void);
 static void _list_delete_feature(void *feature_entry);
 static int  _preserve_select_type_param(slurm_ctl_conf_t * ctl_conf_ptr,
@@ -119,12 +125,16 @@ static int  _preserve_plugins(slurm_ctl_conf_t * ctl_conf_ptr,
 static void _purge_old_node_state(struct node_record *old_node_table_ptr,
 				int old_node_record_count);
 static void _purge_old_part_state(List old_part_list, char *old_def_part_name);
+static void _reset_partitionline_fields(struct part_record *part_ptr);
 static int  _restore_job_dependencies(void);
 static int  _restore_node_state(int recover,
 				struct node_record *old_node_table_ptr,
 				int old_node_record_count);
 static int  _restore_part_state(List old_part_list, char *old_def_part_name,
 				uint16_t flags);
+static void *_preload_state_files(void *no_data);
+static void _set_partitionline_fields(struct part_record *part_ptr,
+				      slurm_conf_partition_t *part);
 static void _stat_slurm_dirs(void);
 static int  _sync_nodes_to_comp_job(void);
 static int  _sync_nodes_to_jobs(bool reconfig);
@@ -170,6 +180,33 @@ static void _stat_slurm_dirs(void)
 	}
 }
 
+/* Sequentially read the state files restored at startup into the page
+ * cache so the state load functions below do not block on disk I/O.
+ * Runs as a detached thread so the I/O overlaps the configuration
+ * processing which precedes the state loads. */
+static void *_preload_state_files(void *no_data)
+{
+	static char *state_files[] = {
+		"job_state", "node_state", "part_state", "resv_state",
+		"trigger_state", "front_end_state", "fed_mgr_state", NULL };
+	char *state_file, buf[65536];
+	int i, fd;
+
+	for (i = 0; state_files[i]; i++) {
+		state_file = xstrdup_printf("%s/%s",
+					    slurmctld_conf.state_save_location,
+					    state_files[i]);
+		fd = open(state_file, O_RDONLY);
+		if (fd >= 0) {
+			while (read(fd, buf, sizeof(buf)) > 0)
+				;
+			close(fd);
+		}
+		xfree(state_file);
+	}
+	return NULL;
+}
+
 /*
  * _reorder_nodes_by_name - order node table in ascending order of name
  */
@@ -628,6 +665,19 @@ static int _build_single_partitionline_info(slurm_conf_partition_t *part)
 		return EEXIST;
 	}
 
+	_set_partitionline_fields(part_ptr, part);
+
+	return 0;
+}
+
+/*
+ * _set_partitionline_fields - apply the values from a parsed partition
+ *	definition to a partition record, used both when building the
+ *	table and when reapplying a changed definition to a live record
+ */
+static void _set_partitionline_fields(struct part_record *part_ptr,
+				      slurm_conf_partition_t *part)
+{
 	if (part->default_flag) {
 		if (default_part_name &&
 		    xstrcmp(default_part_name, part->name)) {
@@ -796,8 +846,6 @@ static int _build_single_partitionline_info(slurm_conf_partition_t *part)
 			part_ptr->nodes = xstrdup(part->nodes);
 		}
 	}
-
-	return 0;
 }
 
 /*
@@ -860,6 +908,186 @@ static void _sync_part_prio(void)
 	list_for_each(part_list, _reset_part_prio, NULL);
 }
 
+/* Fingerprint of the last loaded configuration file, used to classify
+ * what a reconfigure request actually changes */
+static uint64_t conf_base_hash = 0;	/* all non-partition lines */
+static uint64_t conf_part_hash = 0;	/* PartitionName lines */
+static bool conf_hash_valid = false;
+
+/* Fold one byte into a FNV-1a hash */
+static uint64_t _hash_byte(uint64_t hash, unsigned char byte)
+{
+	return (hash ^ byte) * 0x100000001b3;
+}
+
+/*
+ * _hash_config_sections - hash the configuration file line by line,
+ *	separating the partition definitions from everything else so a
+ *	reconfigure request can tell which of the two changed. Blank and
+ *	comment lines are ignored. Included files are not followed, the
+ *	caller must fall back to a full rebuild when has_include is set.
+ */
+static int _hash_config_sections(uint64_t *base_hash, uint64_t *part_hash,
+				 bool *has_include)
+{
+	char *line = NULL, *ptr;
+	size_t line_size = 0;
+	ssize_t line_len;
+	uint64_t *hash;
+	ssize_t i;
+	FILE *fp;
+
+	*base_hash = *part_hash = 0xcbf29ce484222325;
+	*has_include = false;
+
+	if (!(fp = fopen(slurmctld_conf.slurm_conf, "r"))) {
+		error("%s: could not open %s: %m",
+		      __func__, slurmctld_conf.slurm_conf);
+		return SLURM_ERROR;
+	}
+	while ((line_len = getline(&line, &line_size, fp)) != -1) {
+		ptr = line;
+		while ((*ptr == ' ') || (*ptr == '\t'))
+			ptr++;
+		if ((*ptr == '\0') || (*ptr == '\n') || (*ptr == '#'))
+			continue;
+		if (!strncasecmp(ptr, "Include", 7))
+			*has_include = true;
+		if (!strncasecmp(ptr, "PartitionName", 13))
+			hash = part_hash;
+		else
+			hash = base_hash;
+		for (i = 0; ptr[i] && (ptr[i] != '\n'); i++)
+			*hash = _hash_byte(*hash, (unsigned char) ptr[i]);
+		*hash = _hash_byte(*hash, '\n');
+	}
+	free(line);
+	fclose(fp);
+	return SLURM_SUCCESS;
+}
+
+/*
+ * _reset_partitionline_fields - restore a live partition record to the
+ *	create_part_record() defaults before its changed configuration
+ *	file definition is reapplied, so values dropped from the new
+ *	definition do not survive the update. The name, node membership,
+ *	bitmap and allowed UID list are deliberately left alone.
+ */
+static void _reset_partitionline_fields(struct part_record *part_ptr)
+{
+	xfree(part_ptr->allow_accounts);
+	accounts_list_free(&part_ptr->allow_account_array);
+	xfree(part_ptr->allow_alloc_nodes);
+	xfree(part_ptr->allow_groups);
+	xfree(part_ptr->allow_qos);
+	FREE_NULL_BITMAP(part_ptr->allow_qos_bitstr);
+	xfree(part_ptr->alternate);
+	xfree(part_ptr->billing_weights);
+	xfree(part_ptr->billing_weights_str);
+	xfree(part_ptr->deny_accounts);
+	accounts_list_free(&part_ptr->deny_account_array);
+	xfree(part_ptr->deny_qos);
+	FREE_NULL_BITMAP(part_ptr->deny_qos_bitstr);
+	xfree(part_ptr->qos_char);
+	part_ptr->qos_ptr = NULL;
+
+	part_ptr->alternate = xstrdup(default_part.alternate);
+	part_ptr->flags     = default_part.flags;
+	if (default_part.allow_alloc_nodes) {
+		part_ptr->allow_alloc_nodes =
+			xstrdup(default_part.allow_alloc_nodes);
+	}
+}
+
+/*
+ * _apply_partition_diff - reapply the partition definitions from a
+ *	re-parsed configuration file to the live partition records.
+ *	Only attribute changes to existing partitions are handled here.
+ *	Added or removed partitions and node membership changes have side
+ *	effects on other tables (node/job/reservation pointers and
+ *	bitmaps), so those cases return an error and the caller falls
+ *	back to a full rebuild.
+ */
+static int _apply_partition_diff(void)
+{
+	slurm_conf_partition_t **ptr_array, *part;
+	struct part_record *part_ptr;
+	char *conf_name;
+	int count, i, rc;
+
+	/* Re-parse the file. Everything outside of the partition
+	 * definitions is verified unchanged, so reloading the parser
+	 * tables in place is safe. */
+	conf_name = xstrdup(slurmctld_conf.slurm_conf);
+	rc = slurm_conf_reinit(conf_name);
+	xfree(conf_name);
+	if (rc != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	count = slurm_conf_partition_array(&ptr_array);
+	if (count != list_count(part_list))
+		return SLURM_ERROR;
+	for (i = 0; i < count; i++) {
+		part = ptr_array[i];
+		part_ptr = list_find_first(part_list, &list_find_part,
+					   part->name);
+		if (!part_ptr)
+			return SLURM_ERROR;
+		if (xstrcmp(part->nodes, part_ptr->nodes))
+			return SLURM_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		part = ptr_array[i];
+		part_ptr = list_find_first(part_list, &list_find_part,
+					   part->name);
+		_reset_partitionline_fields(part_ptr);
+		_set_partitionline_fields(part_ptr, part);
+	}
+	_sync_part_prio();
+	load_part_uid_allow_list(1);
+	last_part_update = time(NULL);
+	slurmctld_conf.last_update = time(NULL);
+	info("%s: applied differential update to %d partitions",
+	     __func__, count);
+	return SLURM_SUCCESS;
+}
+
+/*
+ * read_slurm_conf_diff - differential form of read_slurm_conf() for
+ *	reconfigure requests. When only partition definitions changed
+ *	(the common one line configuration push) the changes are applied
+ *	to the live records without rebuilding the node and partition
+ *	tables; when nothing changed the rebuild is skipped entirely.
+ *	Anything else falls through to read_slurm_conf().
+ * IN recover/reconfig - see read_slurm_conf()
+ * RET SLURM_SUCCESS if no error, otherwise an error code
+ */
+extern int read_slurm_conf_diff(int recover, bool reconfig)
+{
+	uint64_t base_hash = 0, part_hash = 0;
+	bool has_include = false;
+
+	if (conf_hash_valid && reconfig &&
+	    (_hash_config_sections(&base_hash, &part_hash, &has_include) ==
+	     SLURM_SUCCESS) &&
+	    !has_include && (base_hash == conf_base_hash)) {
+		if (part_hash == conf_part_hash) {
+			info("%s: configuration file unchanged, "
+			     "skipping table rebuild", __func__);
+			return SLURM_SUCCESS;
+		}
+		if (_apply_partition_diff() == SLURM_SUCCESS) {
+			conf_part_hash = part_hash;
+			return SLURM_SUCCESS;
+		}
+		debug("%s: partition diff not applicable, "
+		      "performing full rebuild", __func__);
+	}
+
+	return read_slurm_conf(recover, reconfig);
+}
+
 /*
  * read_slurm_conf - load the slurm configuration from the configured file.
  * read_slurm_conf can be called more than once if so desired.
@@ -1005,6 +1233,9 @@ int read_slurm_conf(int recover, bool reconfig)
 		_reorder_nodes_by_name();
 
 	rehash_node();
+	ctld_numa_init();
+	ctld_numa_interleave(node_record_table_ptr,
+			     node_record_count * sizeof(struct node_record));
 	slurm_topo_build_config();
 	route_g_reconfigure();
 	if (reconfig)
@@ -1016,6 +1247,21 @@ int read_slurm_conf(int recover, bool reconfig)
 
 	_stat_slurm_dirs();
 
+	if (!reconfig && (recover > 0)) {
+		/* Warm the page cache with the state files while the
+		 * configuration below is processed */
+		pthread_attr_t thread_attr;
+		pthread_t preload_thread;
+		slurm_attr_init(&thread_attr);
+		if (pthread_attr_setdetachstate(&thread_attr,
+						PTHREAD_CREATE_DETACHED))
+			error("pthread_attr_setdetachstate error %m");
+		if (pthread_create(&preload_thread, &thread_attr,
+				   _preload_state_files, NULL))
+			error("pthread_create error %m");
+		slurm_attr_destroy(&thread_attr);
+	}
+
 	/*
 	 * Load the layouts configuration.
 	 * Only load it at init time, not during reconfiguration stages.
@@ -1181,6 +1427,18 @@ int read_slurm_conf(int recover, bool reconfig)
 			fatal("Failed to reconfigure mcs plugin");
 	}
 
+	/* Fingerprint the file just loaded so the next reconfigure can
+	 * classify its changes (see read_slurm_conf_diff()) */
+	if (!error_code) {
+		bool has_include = false;
+		conf_hash_valid =
+			(_hash_config_sections(&conf_base_hash,
+					       &conf_part_hash,
+					       &has_include) ==
+			 SLURM_SUCCESS) && !has_include;
+	} else
+		conf_hash_valid = false;
+
 	slurmctld_conf.last_update = time(NULL);
 	END_TIMER2("read_slurm_conf");
 	return error_code;
@@ -1275,6 +1533,9 @@ extern void build_feature_list_eq(void)
 
 	char *tmp_str, *token, *last = NULL;
 
+	/* Invalidate feature lookups compiled into job records */
+	node_feature_gen++;
+
 	FREE_NULL_LIST(active_feature_list);
 	FREE_NULL_LIST(avail_feature_list);
 	active_feature_list = list_create(_list_delete_feature);
@@ -1317,6 +1578,9 @@ extern void build_feature_list_ne(void)
 	char *tmp_str, *token, *last = NULL;
 	int i;
 
+	/* Invalidate feature lookups compiled into job records */
+	node_feature_gen++;
+
 	FREE_NULL_LIST(active_feature_list);
 	FREE_NULL_LIST(avail_feature_list);
 	active_feature_list = list_create(_list_delete_feature);
@@ -1358,6 +1622,9 @@ extern void update_feature_list(List feature_list, char *new_features,
 	ListIterator feature_iter;
 	char *tmp_str, *token, *last = NULL;
 
+	/* Invalidate feature lookups compiled into job records */
+	node_feature_gen++;
+
 	/* Clear these nodes from the feature_list record,
 	 * then restore as needed */
 	feature_iter = list_iterator_create(feature_list);
@@ -1477,6 +1744,7 @@ static int _restore_node_state(int recover,
 			old_node_ptr->node_hostname = NULL;
 			slurm_reset_alias(node_ptr->name, node_ptr->comm_name,
 					  node_ptr->node_hostname);
+			reset_node_addr_hashes();
 		}
 
 		node_ptr->last_response = old_node_ptr->last_response;
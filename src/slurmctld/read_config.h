@@ -64,6 +64,18 @@ extern void accounts_list_free(char ***accounts_array);
  */
 extern int read_slurm_conf(int recover, bool reconfig);
 
+/*
+ * read_slurm_conf_diff - differential form of read_slurm_conf() for
+ *	reconfigure requests. When only partition definitions changed the
+ *	changes are applied to the live records under the same locks
+ *	without rebuilding the node and partition tables; when nothing
+ *	changed the rebuild is skipped entirely. Anything else falls
+ *	through to read_slurm_conf().
+ * IN recover/reconfig - see read_slurm_conf()
+ * RET SLURM_SUCCESS if no error, otherwise an error code
+ */
+extern int read_slurm_conf_diff(int recover, bool reconfig);
+
 extern int dump_config_state_lite(void);
 extern int load_config_state_lite(void);
 
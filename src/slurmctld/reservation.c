@@ -40,6 +40,7 @@
 #include "config.h"
 
 #include <fcntl.h>
+#include <limits.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -96,6 +97,28 @@ List      resv_list = (List) NULL;
 uint32_t  resv_over_run;
 uint32_t  top_suffix = 0;
 
+/*
+ * Reservation interval index: reservations sorted by start time in an
+ * implicit interval tree (each array midpoint records the maximum end
+ * time within its subtree), so the candidates for a time window are
+ * found in O(log n + matches) rather than by scanning all of resv_list
+ * for every job tested. Entries are conservative: floating and periodic
+ * (DAILY/WEEKLY) reservations get no upper bound since their windows
+ * move, so a query can return false positives, which the callers filter
+ * with their exact tests, but never false negatives. The index is
+ * rebuilt lazily on the next query after any reservation change.
+ */
+typedef struct resv_interval {
+	time_t start;			/* earliest effective start time */
+	time_t end;			/* latest effective end time */
+	time_t max_end;			/* maximum end in implicit subtree */
+	slurmctld_resv_t *resv_ptr;
+} resv_interval_t;
+
+static resv_interval_t *resv_index = NULL;
+static int  resv_index_cnt = 0;
+static bool resv_index_dirty = true;
+
 #ifdef HAVE_BG
 uint32_t  cpu_mult = 0;
 uint32_t  cnodes_per_mp = 0;
@@ -170,6 +193,10 @@ static int  _post_resv_update(slurmctld_resv_t *resv_ptr,
 static int  _resize_resv(slurmctld_resv_t *resv_ptr, uint32_t node_cnt);
 static void _restore_resv(slurmctld_resv_t *dest_resv,
 			  slurmctld_resv_t *src_resv);
+static void _resv_index_build(void);
+static void _resv_index_invalidate(void);
+static int  _resv_index_query(time_t qstart, time_t qend,
+			      slurmctld_resv_t ***resv_array);
 static bool _resv_overlap(time_t start_time, time_t end_time,
 			  uint32_t flags, bitstr_t *node_bitmap,
 			  slurmctld_resv_t *this_resv_ptr);
@@ -418,6 +445,8 @@ static void _restore_resv(slurmctld_resv_t *dest_resv,
 	xfree(dest_resv->user_list);
 	dest_resv->user_list = src_resv->user_list;
 	src_resv->user_list = NULL;
+
+	_resv_index_invalidate();
 }
 
 static void _del_resv_rec(void *x)
@@ -1730,24 +1759,137 @@ static bool _job_overlap(time_t start_time, uint32_t flags,
  *	reservation
  * RET true if overlap
  */
+/* Flag the reservation interval index as stale, it will be rebuilt on
+ * the next query. Call after any change to resv_list membership or to a
+ * reservation's time window. */
+static void _resv_index_invalidate(void)
+{
+	resv_index_dirty = true;
+}
+
+static int _resv_index_cmp(const void *x, const void *y)
+{
+	const resv_interval_t *rec1 = x, *rec2 = y;
+
+	if (rec1->start < rec2->start)
+		return -1;
+	if (rec1->start > rec2->start)
+		return 1;
+	return 0;
+}
+
+/* Compute the subtree maximum end times over index range [lo, hi),
+ * the implicit tree is rooted at the midpoint of each range */
+static time_t _resv_index_max_end(int lo, int hi)
+{
+	int mid;
+	time_t max_end, child_end;
+
+	if (lo >= hi)
+		return 0;
+	mid = (lo + hi) / 2;
+	max_end = resv_index[mid].end;
+	child_end = _resv_index_max_end(lo, mid);
+	max_end = MAX(max_end, child_end);
+	child_end = _resv_index_max_end(mid + 1, hi);
+	max_end = MAX(max_end, child_end);
+	resv_index[mid].max_end = max_end;
+	return max_end;
+}
+
+static void _resv_index_build(void)
+{
+	ListIterator iter;
+	slurmctld_resv_t *resv_ptr;
+	resv_interval_t *rec;
+
+	xfree(resv_index);
+	resv_index_cnt = 0;
+	if (resv_list) {
+		resv_index = xmalloc(sizeof(resv_interval_t) *
+				     MAX(list_count(resv_list), 1));
+		iter = list_iterator_create(resv_list);
+		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+			rec = &resv_index[resv_index_cnt++];
+			rec->resv_ptr = resv_ptr;
+			rec->start = MIN(resv_ptr->start_time,
+					 resv_ptr->start_time_first);
+			if (resv_ptr->flags & RESERVE_FLAG_TIME_FLOAT)
+				rec->start = 0; /* relative to time now */
+			if (resv_ptr->flags & (RESERVE_FLAG_TIME_FLOAT |
+					       RESERVE_FLAG_DAILY |
+					       RESERVE_FLAG_WEEKLY))
+				rec->end = (time_t) LONG_MAX; /* moving */
+			else
+				rec->end = resv_ptr->end_time;
+		}
+		list_iterator_destroy(iter);
+		qsort(resv_index, resv_index_cnt, sizeof(resv_interval_t),
+		      _resv_index_cmp);
+		(void) _resv_index_max_end(0, resv_index_cnt);
+	}
+	resv_index_dirty = false;
+}
+
+/* Recursively gather reservations possibly active in [qstart, qend) */
+static void _resv_index_subtree(int lo, int hi, time_t qstart, time_t qend,
+				slurmctld_resv_t **matches, int *match_cnt)
+{
+	int mid;
+
+	if (lo >= hi)
+		return;
+	mid = (lo + hi) / 2;
+	if (resv_index[mid].max_end <= qstart)
+		return;	/* everything in this subtree ends too early */
+	_resv_index_subtree(lo, mid, qstart, qend, matches, match_cnt);
+	if (resv_index[mid].start >= qend)
+		return;	/* this and all later entries start too late */
+	if (resv_index[mid].end > qstart)
+		matches[(*match_cnt)++] = resv_index[mid].resv_ptr;
+	_resv_index_subtree(mid + 1, hi, qstart, qend, matches, match_cnt);
+}
+
+/*
+ * Find the reservations which may overlap the window [qstart, qend).
+ * OUT resv_array - xmalloc'd array of candidates, caller must xfree
+ * RET count of candidate reservations
+ */
+static int _resv_index_query(time_t qstart, time_t qend,
+			     slurmctld_resv_t ***resv_array)
+{
+	int match_cnt = 0;
+
+	if (resv_index_dirty)
+		_resv_index_build();
+	*resv_array = xmalloc(sizeof(slurmctld_resv_t *) *
+			      MAX(resv_index_cnt, 1));
+	_resv_index_subtree(0, resv_index_cnt, qstart, qend,
+			    *resv_array, &match_cnt);
+	return match_cnt;
+}
+
 static bool _resv_overlap(time_t start_time, time_t end_time,
 			  uint32_t flags, bitstr_t *node_bitmap,
 			  slurmctld_resv_t *this_resv_ptr)
 {
-	ListIterator iter;
-	slurmctld_resv_t *resv_ptr;
+	slurmctld_resv_t *resv_ptr, **resv_array = NULL;
 	bool rc = false;
-	int i, j;
-	time_t s_time1, s_time2, e_time1, e_time2;
+	int i, j, inx, resv_cnt;
+	time_t s_time1, s_time2, e_time1, e_time2, q_end;
 
 	if ((flags & RESERVE_FLAG_MAINT)   ||
 	    (flags & RESERVE_FLAG_OVERLAP) ||
 	    (!node_bitmap))
 		return rc;
 
-	iter = list_iterator_create(resv_list);
+	q_end = end_time;
+	if (flags & RESERVE_FLAG_DAILY)	/* look forward one week */
+		q_end += 7 * 24 * 60 * 60;
+	resv_cnt = _resv_index_query(start_time, q_end, &resv_array);
 
-	while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+	for (inx = 0; (inx < resv_cnt) && !rc; inx++) {
+		resv_ptr = resv_array[inx];
 		if (resv_ptr == this_resv_ptr)
 			continue;	/* skip self */
 		if (resv_ptr->node_bitmap == NULL)
@@ -1781,7 +1923,7 @@ static bool _resv_overlap(time_t start_time, time_t end_time,
 				break;
 		}
 	}
-	list_iterator_destroy(iter);
+	xfree(resv_array);
 
 	return rc;
 }
@@ -2400,6 +2542,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	_set_tres_cnt(resv_ptr, NULL);
 
 	list_append(resv_list, resv_ptr);
+	_resv_index_invalidate();
 	last_resv_update = now;
 	schedule_resv_save();
 
@@ -2420,6 +2563,9 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 extern void resv_fini(void)
 {
 	FREE_NULL_LIST(resv_list);
+	xfree(resv_index);
+	resv_index_cnt = 0;
+	resv_index_dirty = true;
 }
 
 /* Update an exiting resource reservation */
@@ -2454,6 +2600,8 @@ extern int update_resv(resv_desc_msg_t *resv_desc_ptr)
 
 	/* Make backup to restore state in case of failure */
 	resv_backup = _copy_resv(resv_ptr);
+	/* Times and flags may change below, or be restored on failure */
+	_resv_index_invalidate();
 
 	/* Process the request */
 	if (resv_desc_ptr->flags != NO_VAL) {
@@ -2880,6 +3028,7 @@ extern int delete_resv(reservation_name_msg_t *resv_desc_ptr)
 		rc = _post_resv_delete(resv_ptr);
 		_clear_job_resv(resv_ptr);
 		list_delete_item(iter);
+		_resv_index_invalidate();
 		break;
 	}
 	list_iterator_destroy(iter);
@@ -3104,6 +3253,7 @@ extern int dump_all_resv_state(void)
 	xfree(new_file);
 	unlock_state_files();
 
+	stream_state_file("resv_state", buffer);
 	free_buf(buffer);
 	END_TIMER2("dump_all_resv_state");
 	return 0;
@@ -3258,6 +3408,7 @@ static void _validate_all_reservations(void)
 			_post_resv_delete(resv_ptr);
 			_clear_job_resv(resv_ptr);
 			list_delete_item(iter);
+			_resv_index_invalidate();
 		} else {
 			_set_assoc_list(resv_ptr);
 			top_suffix = MAX(top_suffix, resv_ptr->resv_id);
@@ -3476,11 +3627,11 @@ static int _open_resv_state_file(char **state_file)
  */
 extern int load_all_resv_state(int recover)
 {
-	char *state_file, *data = NULL, *ver_str = NULL;
+	char *state_file, *ver_str = NULL;
 	time_t now;
-	uint32_t data_size = 0, uint32_tmp;
-	int data_allocated, data_read = 0, error_code = 0, state_fd;
-	Buf buffer;
+	uint32_t uint32_tmp;
+	int error_code = 0, state_fd;
+	Buf buffer = NULL;
 	slurmctld_resv_t *resv_ptr = NULL;
 	uint16_t protocol_version = (uint16_t) NO_VAL;
 
@@ -3495,6 +3646,7 @@ extern int load_all_resv_state(int recover)
 		list_flush(resv_list);
 	else
 		resv_list = list_create(_del_resv_rec);
+	_resv_index_invalidate();
 
 	/* read the file */
 	lock_state_files();
@@ -3504,31 +3656,16 @@ extern int load_all_resv_state(int recover)
 		     state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					BUF_SIZE);
-			if (data_read < 0) {
-				if  (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
-		close(state_fd);
+		(void) close(state_fd);
+		if (!(buffer = create_mmap_buf(state_file)))
+			error("Can not map reservation state file %s: %m",
+			      state_file);
 	}
 	xfree(state_file);
 	unlock_state_files();
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)	/* preserve the empty buffer unpack error path */
+		buffer = create_buf(NULL, 0);
 
 	safe_unpackstr_xmalloc( &ver_str, &uint32_tmp, buffer);
 	debug3("Version string in resv_state header is %s", ver_str);
@@ -3554,6 +3691,7 @@ extern int load_all_resv_state(int recover)
 			break;
 
 		list_append(resv_list, resv_ptr);
+		_resv_index_invalidate();
 		info("Recovered state of reservation %s", resv_ptr->name);
 	}
 
@@ -4836,12 +4974,11 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 			 bool move_time, bitstr_t **node_bitmap,
 			 bitstr_t **exc_core_bitmap, bool *resv_overlap)
 {
-	slurmctld_resv_t * resv_ptr, *res2_ptr;
+	slurmctld_resv_t * resv_ptr, *res2_ptr, **resv_array = NULL;
 	time_t job_start_time, job_end_time, lic_resv_time;
 	time_t start_relative, end_relative;
 	time_t now = time(NULL);
-	ListIterator iter;
-	int i, rc = SLURM_SUCCESS, rc2;
+	int i, inx, resv_cnt, rc = SLURM_SUCCESS, rc2;
 
 	job_start_time = *when;
 	job_end_time   = *when + _get_job_duration(job_ptr);
@@ -4891,8 +5028,10 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 
 		/* if there are any overlapping reservations, we need to
 		 * prevent the job from using those nodes (e.g. MAINT nodes) */
-		iter = list_iterator_create(resv_list);
-		while ((res2_ptr = (slurmctld_resv_t *) list_next(iter))) {
+		resv_cnt = _resv_index_query(job_start_time, job_end_time,
+					     &resv_array);
+		for (inx = 0; inx < resv_cnt; inx++) {
+			res2_ptr = resv_array[inx];
 			if ((resv_ptr->flags & RESERVE_FLAG_MAINT) ||
 			    ((resv_ptr->flags & RESERVE_FLAG_OVERLAP) &&
 			     !(res2_ptr->flags & RESERVE_FLAG_MAINT)) ||
@@ -4909,7 +5048,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 				bit_not(res2_ptr->node_bitmap);
 			}
 		}
-		list_iterator_destroy(iter);
+		xfree(resv_array);
 
 		if (slurmctld_conf.debug_flags & DEBUG_FLAG_RESERVATION) {
 			char *nodes = bitmap2node_name(*node_bitmap);
@@ -4953,11 +5092,13 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 
 	/* Job has no reservation, try to find time when this can
 	 * run and get it's required nodes (if any) */
+	resv_cnt = _resv_index_query(job_start_time, job_end_time,
+				     &resv_array);
 	for (i = 0; ; i++) {
 		lic_resv_time = (time_t) 0;
 
-		iter = list_iterator_create(resv_list);
-		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+		for (inx = 0; inx < resv_cnt; inx++) {
+			resv_ptr = resv_array[inx];
 			if (resv_ptr->flags & RESERVE_FLAG_TIME_FLOAT) {
 				start_relative = resv_ptr->start_time + now;
 				if (resv_ptr->duration == INFINITE)
@@ -5027,7 +5168,6 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 				}
 			}
 		}
-		list_iterator_destroy(iter);
 
 		if ((rc == SLURM_SUCCESS) && move_time) {
 			if (license_job_test(job_ptr, job_start_time)
@@ -5050,6 +5190,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 		FREE_NULL_BITMAP(*node_bitmap);
 		break;	/* Give up */
 	}
+	xfree(resv_array);
 
 	return rc;
 }
@@ -5163,6 +5304,7 @@ static void _advance_resv_time(slurmctld_resv_t *resv_ptr)
 		resv_ptr->start_time_prev = resv_ptr->start_time;
 		resv_ptr->start_time_first = resv_ptr->start_time;
 		_advance_time(&resv_ptr->end_time, day_cnt);
+		_resv_index_invalidate();
 		_post_resv_create(resv_ptr);
 		last_resv_update = time(NULL);
 		schedule_resv_save();
@@ -5324,6 +5466,7 @@ extern void fini_job_resv_check(void)
 			}
 			_clear_job_resv(resv_ptr);
 			list_delete_item(iter);
+			_resv_index_invalidate();
 			last_resv_update = now;
 			schedule_resv_save();
 		}
@@ -5402,6 +5545,9 @@ extern int set_node_maint_mode(bool reset_all)
 			resv_ptr->flags_set_node = false;
 			_set_nodes_flags(resv_ptr, now, flags);
 			last_node_update = now;
+			/* The reservation window ended, wake the scheduler
+			 * for the nodes it released */
+			queue_part_scheduler(resv_ptr->part_ptr);
 		}
 
 		if (reset_all)	/* Defer reservation prolog/epilog */
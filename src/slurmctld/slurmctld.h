@@ -230,6 +230,9 @@ typedef struct node_features {
 
 extern List active_feature_list;/* list of currently active node features */
 extern List avail_feature_list;	/* list of available node features */
+extern uint32_t node_feature_gen;/* incremented on any feature list change,
+				 * invalidates lookups compiled into the
+				 * job_feature_t records */
 
 /*****************************************************************************\
  *  NODE states and bitmaps
@@ -441,6 +444,12 @@ typedef struct job_feature {
 	char *name;			/* name of feature */
 	uint16_t count;			/* count of nodes with this feature */
 	uint8_t op_code;		/* separator, see FEATURE_OP_ above */
+	node_feature_t *active_feat_ptr;/* active_feature_list record with
+					 * this name, compiled on first use */
+	node_feature_t *avail_feat_ptr;	/* avail_feature_list record with
+					 * this name, compiled on first use */
+	uint32_t feat_gen;		/* node_feature_gen value when the
+					 * lookups above were compiled */
 } job_feature_t;
 
 /* job_details - specification of a job's constraints,
@@ -574,6 +583,8 @@ struct job_record {
 	uint32_t array_task_id;		/* task_id of a job array */
 	job_array_struct_t *array_recs;	/* job array details,
 					 * only in meta-job record */
+	uint8_t array_hash_flags;	/* membership in job array hash
+					 * tables, JOB_ARRAY_HASH_* */
 	uint32_t assoc_id;              /* used for accounting plugins */
 	void    *assoc_ptr;		/* job's assoc record ptr, it is
 					 * void* because of interdependencies
@@ -610,6 +621,10 @@ struct job_record {
 	uint64_t db_index;              /* used only for database
 					 * plugins */
 	uint32_t derived_ec;		/* highest exit code of all job steps */
+	uint32_t diff_crc;		/* hash of the last packed image of
+					 * this job, used to notice changes
+					 * for diff info responses */
+	time_t diff_time;		/* when diff_crc last changed */
 	struct job_details *details;	/* job details */
 	uint16_t direct_set_prio;	/* Priority set directly if
 					 * set the system will not
@@ -638,6 +653,8 @@ struct job_record {
 	struct job_record *job_next;	/* next entry with same hash index */
 	struct job_record *job_array_next_j; /* job array linked list by job_id */
 	struct job_record *job_array_next_t; /* job array linked list by task_id */
+	struct job_record *job_user_next; /* next entry with same user hash
+					 * index */
 	job_resources_t *job_resrcs;	/* details of allocated cores */
 	uint32_t job_state;		/* state of the job */
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
@@ -709,6 +726,9 @@ struct job_record {
 	struct slurmctld_resv *resv_ptr;/* reservation structure pointer */
 	uint32_t requid;	    	/* requester user ID */
 	char *resp_host;		/* host for srun communications */
+	uint64_t save_hash;		/* hash of this job's last state save
+					 * image, used to identify dirty jobs
+					 * for the delta journal, NO_PACK */
 	char *sched_nodes;		/* list of nodes scheduled for job */
 	dynamic_plugin_data_t *select_jobinfo;/* opaque data, BlueGene */
 	char **spank_job_env;		/* environment variables for job prolog
@@ -730,6 +750,10 @@ struct job_record {
 					 * scheduling cycle (state_reason is
 					 * cleared at start of cycle) */
 	List step_list;			/* list of job's steps */
+	uint16_t *steps_on_node;	/* count of active steps on each node
+					 * (node_record table index), NULL
+					 * until the first step starts,
+					 * maintained by step_mgr.c */
 	time_t suspend_time;		/* time job last suspended or resumed */
 	time_t time_last_active;	/* time of last job activity */
 	uint32_t time_limit;		/* time_limit minutes or INFINITE,
@@ -956,6 +980,30 @@ extern int job_limits_check(struct job_record **job_pptr, bool check_min_time);
  */
 extern void  delete_job_details (struct job_record *job_entry);
 
+/* Recycling pools for the fixed-size job and step record shells,
+ * maintained by job_mgr.c. Pool occupancy is reported by sdiag. */
+enum {
+	REC_POOL_JOB = 0,	/* struct job_record */
+	REC_POOL_DETAILS,	/* struct job_details */
+	REC_POOL_STEP,		/* struct step_record */
+	REC_POOL_COUNT
+};
+
+/* Get an empty (zero filled) record shell from the specified pool */
+extern void *rec_pool_get(int pool_id);
+
+/* Recycle or free an emptied record shell. All of its contents must
+ * already have been released. */
+extern void rec_pool_put(int pool_id, void *rec);
+
+/* Report record pool occupancy and hit counts for sdiag.
+ * Each array must have room for REC_POOL_COUNT entries. */
+extern void rec_pool_get_stats(uint32_t *occupancy, uint64_t *allocs,
+			       uint64_t *reuses);
+
+/* Clear the record pool counters (sdiag reset) */
+extern void rec_pool_reset_stats(void);
+
 /*
  * delete_partition - delete the specified partition (actually leave
  *	the entry, just flag it as defunct)
@@ -1217,6 +1265,16 @@ extern void job_array_post_sched(struct job_record *job_ptr);
  * RET - The new job record, which is the new META job record. */
 extern struct job_record *job_array_split(struct job_record *job_ptr);
 
+/* Split the pending tasks identified by task_bitmap out of a META job
+ * record into a new META job record of their own, without materializing
+ * an individual job record per task.
+ * IN job_ptr - META job record for a job array
+ * IN task_bitmap - pending tasks to move to the new record, must be a
+ *		    subset of job_ptr's pending task bitmap
+ * RET - The new META job record, holding the tasks in task_bitmap */
+extern struct job_record *job_array_split_meta(struct job_record *job_ptr,
+					       bitstr_t *task_bitmap);
+
 /* Record the start of one job array task */
 extern void job_array_start(struct job_record *job_ptr);
 
@@ -1268,6 +1326,13 @@ extern uint64_t job_get_tres_mem(uint32_t pn_min_memory,
 extern bool job_epilog_complete(uint32_t job_id, char *node_name,
 		uint32_t return_code);
 
+/*
+ * job_epilog_complete_ptr - as job_epilog_complete, but with the job record
+ *	already looked up (NULL if no matching job record exists)
+ */
+extern bool job_epilog_complete_ptr(struct job_record *job_ptr,
+		char *node_name, uint32_t return_code);
+
 /*
  * job_end_time - Process JOB_END_TIME
  * IN time_req_msg - job end time request
@@ -1619,6 +1684,17 @@ int list_compare_config (void *config_entry1, void *config_entry2);
  */
 extern int list_find_feature(void *feature_entry, void *key);
 
+/*
+ * find_job_node_feature - return the node feature record matching a job
+ *	feature record, using the lookup compiled into the job feature
+ *	record when still current
+ * IN job_feat_ptr - feature record from some job's feature_list
+ * IN feature_list - avail_feature_list or active_feature_list
+ * RET the matching node feature record or NULL if none
+ */
+extern node_feature_t *find_job_node_feature(job_feature_t *job_feat_ptr,
+					     List feature_list);
+
 /*
  * list_find_part - find an entry in the partition list, see common/list.h
  *	for documentation
@@ -1657,6 +1733,15 @@ extern int load_last_job_id( void );
  */
 extern void load_part_uid_allow_list ( int force );
 
+/*
+ * precache_group_members - resolve and cache the members of every group
+ *	referenced by a partition AllowGroups list, so that a subsequent
+ *	load_part_uid_allow_list() call made with locks held is serviced
+ *	from the warm cache rather than blocking on NSS lookups
+ * NOTE: Acquires its own partition lock, call with no locks set
+ */
+extern void precache_group_members(void);
+
 /*
  * load_all_part_state - load the partition state from file, recover from
  *	slurmctld restart. execute this after loading the configuration
@@ -1739,6 +1824,8 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter_msg - if set, pack only the jobs matching the filters
+ *	carried in the request message
  * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
@@ -1747,6 +1834,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			  job_info_request_msg_t *filter_msg,
 			  uint16_t protocol_version);
 
 /*
@@ -1863,6 +1951,10 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid, char *node_name,
 			   uint16_t protocol_version);
 
+/* part_any_hidden - report if any partition currently has its hidden flag
+ * set, either by configuration or by a preceding part_filter_set() call */
+extern bool part_any_hidden(void);
+
 /* part_filter_clear - Clear the partition's hidden flag based upon a user's
  * group access. This must follow a call to part_filter_set() */
 extern void part_filter_clear(void);
@@ -1931,6 +2023,11 @@ extern void qos_list_build(char *qos, bitstr_t **qos_bits);
 /* Request that the job scheduler execute soon (typically within seconds) */
 extern void queue_job_scheduler(void);
 
+/* Request that the job scheduler promptly evaluate the queue of the given
+ * partition in response to a job completion, node state change or
+ * reservation expiry event (NULL partition requests a full queue pass) */
+extern void queue_part_scheduler(struct part_record *part_ptr);
+
 /*
  * rehash_jobs - Create or rebuild the job hash table.
  * NOTE: run lock_slurmctld before entry: Read config, write job
@@ -2135,6 +2232,13 @@ extern slurm_step_layout_t *step_layout_create(struct step_record *step_ptr,
  */
 extern void step_list_purge(struct job_record *job_ptr);
 
+/*
+ * step_node_usage_rebuild - Rebuild a job's per-node count of active steps
+ *	from its step list, used after recovering job state from disk
+ * IN job_ptr - pointer to job table entry
+ */
+extern void step_node_usage_rebuild(struct job_record *job_ptr);
+
 /*
  * step_epilog_complete - note completion of epilog on some node and
  *	release it's switch windows if appropriate. can perform partition
@@ -51,15 +51,146 @@
 
 #define SRUN_LAUNCH_MSG 0
 
+/* Exponential backoff bounds (seconds) applied to srun/salloc
+ * destinations which fail to accept a message. See
+ * srun_comm_note_failure() below. */
+#define SRUN_COMM_BACKOFF_MIN	1
+#define SRUN_COMM_BACKOFF_MAX	64
+
+/* Time after which an idle backoff record is discarded (seconds) */
+#define SRUN_COMM_BACKOFF_PURGE	3600
+
+typedef struct srun_failure {
+	uint32_t ip_addr;	/* destination IP, network byte order */
+	uint16_t port;		/* destination port, network byte order */
+	uint16_t backoff;	/* current backoff interval, seconds */
+	time_t until;		/* suppress messages until this time */
+} srun_failure_t;
+
+static List srun_failure_list = NULL;
+static pthread_mutex_t srun_failure_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _srun_failure_del(void *x)
+{
+	xfree(x);
+}
+
+/* Locate the backoff record for a destination, purging stale records
+ * along the way. Caller must hold srun_failure_mutex. */
+static srun_failure_t *_find_srun_failure(slurm_addr_t *addr, time_t now)
+{
+	ListIterator iter;
+	srun_failure_t *fail_ptr, *match = NULL;
+
+	if (!srun_failure_list)
+		return NULL;
+	iter = list_iterator_create(srun_failure_list);
+	while ((fail_ptr = (srun_failure_t *) list_next(iter))) {
+		if ((fail_ptr->ip_addr == addr->sin_addr.s_addr) &&
+		    (fail_ptr->port    == addr->sin_port)) {
+			match = fail_ptr;
+		} else if ((fail_ptr->until + SRUN_COMM_BACKOFF_PURGE) < now) {
+			list_delete_item(iter);
+		}
+	}
+	list_iterator_destroy(iter);
+	return match;
+}
+
+/*
+ * srun_comm_note_failure - record that a message to some srun/salloc
+ *	process could not be delivered. Subsequent messages to that
+ *	address are dropped for an exponentially growing interval so
+ *	that a wedged or defunct client does not consume agent
+ *	resources on every job state change.
+ * IN addr - destination address of the failed message
+ */
+extern void srun_comm_note_failure(slurm_addr_t *addr)
+{
+	srun_failure_t *fail_ptr;
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&srun_failure_mutex);
+	if (!srun_failure_list)
+		srun_failure_list = list_create(_srun_failure_del);
+	fail_ptr = _find_srun_failure(addr, now);
+	if (fail_ptr) {
+		if (now >= fail_ptr->until) {
+			fail_ptr->backoff = MIN(fail_ptr->backoff * 2,
+						SRUN_COMM_BACKOFF_MAX);
+		}
+	} else {
+		fail_ptr = xmalloc(sizeof(srun_failure_t));
+		fail_ptr->ip_addr = addr->sin_addr.s_addr;
+		fail_ptr->port    = addr->sin_port;
+		fail_ptr->backoff = SRUN_COMM_BACKOFF_MIN;
+		list_append(srun_failure_list, fail_ptr);
+	}
+	fail_ptr->until = now + fail_ptr->backoff;
+	slurm_mutex_unlock(&srun_failure_mutex);
+}
+
+/*
+ * srun_comm_note_success - record that a message to some srun/salloc
+ *	process was delivered, clearing any backoff for that address
+ * IN addr - destination address of the delivered message
+ */
+extern void srun_comm_note_success(slurm_addr_t *addr)
+{
+	ListIterator iter;
+	srun_failure_t *fail_ptr;
+
+	slurm_mutex_lock(&srun_failure_mutex);
+	if (srun_failure_list) {
+		iter = list_iterator_create(srun_failure_list);
+		while ((fail_ptr = (srun_failure_t *) list_next(iter))) {
+			if ((fail_ptr->ip_addr == addr->sin_addr.s_addr) &&
+			    (fail_ptr->port    == addr->sin_port)) {
+				list_delete_item(iter);
+				break;
+			}
+		}
+		list_iterator_destroy(iter);
+	}
+	slurm_mutex_unlock(&srun_failure_mutex);
+}
+
+/* Test if messages to this address are currently suppressed */
+static bool _srun_in_backoff(slurm_addr_t *addr)
+{
+	srun_failure_t *fail_ptr;
+	time_t now = time(NULL);
+	bool suppress = false;
+
+	slurm_mutex_lock(&srun_failure_mutex);
+	fail_ptr = _find_srun_failure(addr, now);
+	if (fail_ptr && (now < fail_ptr->until))
+		suppress = true;
+	slurm_mutex_unlock(&srun_failure_mutex);
+	return suppress;
+}
+
 /* Launch the srun request. Note that retry is always zero since
  * we don't want to clog the system up with messages destined for
- * defunct srun processes
+ * defunct srun processes. For the same reason, destinations in an
+ * active backoff window (see srun_comm_note_failure) have their
+ * messages dropped here rather than queued.
  */
 static void _srun_agent_launch(slurm_addr_t *addr, char *host,
 			       slurm_msg_type_t type, void *msg_args,
 			       uint16_t protocol_version)
 {
-	agent_arg_t *agent_args = xmalloc(sizeof(agent_arg_t));
+	agent_arg_t *agent_args;
+
+	if (_srun_in_backoff(addr)) {
+		debug2("%s: msg_type %u to unresponsive srun on host %s "
+		       "dropped", __func__, type, host);
+		slurm_free_msg_data(type, msg_args);
+		xfree(addr);
+		return;
+	}
+
+	agent_args = xmalloc(sizeof(agent_arg_t));
 
 	agent_args->node_count = 1;
 	agent_args->retry      = 0;
@@ -230,6 +361,8 @@ extern void srun_ping (void)
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
 	slurm_addr_t * addr;
+	slurm_addr_t *ping_dests = NULL;
+	int ping_dest_cnt = 0, ping_dest_size = 0, i;
 	time_t now = time(NULL);
 	time_t old = now - (slurmctld_conf.inactive_limit / 3) +
 			   slurmctld_conf.msg_timeout + 1;
@@ -250,6 +383,26 @@ extern void srun_ping (void)
 			addr = xmalloc(sizeof(struct sockaddr_in));
 			slurm_set_addr(addr, job_ptr->other_port,
 				job_ptr->resp_host);
+			/* A multiplexed srun services all its pending
+			 * allocations over one port, so one ping per
+			 * destination is sufficient. The response
+			 * refreshes every allocation on that channel,
+			 * see srun_response(). */
+			for (i = 0; i < ping_dest_cnt; i++) {
+				if (!memcmp(&ping_dests[i], addr,
+					    sizeof(slurm_addr_t)))
+					break;
+			}
+			if (i < ping_dest_cnt) {
+				xfree(addr);
+				continue;
+			}
+			if (ping_dest_cnt >= ping_dest_size) {
+				ping_dest_size += 64;
+				xrealloc(ping_dests, ping_dest_size *
+					 sizeof(slurm_addr_t));
+			}
+			ping_dests[ping_dest_cnt++] = *addr;
 			msg_arg = xmalloc(sizeof(srun_ping_msg_t));
 			msg_arg->job_id  = job_ptr->job_id;
 			msg_arg->step_id = NO_VAL;
@@ -260,6 +413,7 @@ extern void srun_ping (void)
 	}
 
 	list_iterator_destroy(job_iterator);
+	xfree(ping_dests);
 }
 
 /*
@@ -559,9 +713,27 @@ extern void srun_exec(struct step_record *step_ptr, char **argv)
 extern void srun_response(uint32_t job_id, uint32_t step_id)
 {
 	struct job_record  *job_ptr = find_job_record (job_id);
+	struct job_record  *job_scan_ptr;
+	ListIterator job_iterator;
 	time_t now = time(NULL);
 
 	if (job_ptr == NULL)
 		return;
 	job_ptr->time_last_active = now;
+
+	/* A multiplexed srun services all its pending allocations over
+	 * one response port and srun_ping() sends one ping per
+	 * destination, so a reply on that channel vouches for every
+	 * allocation sharing it */
+	if (!job_ptr->other_port || !job_ptr->resp_host)
+		return;
+	job_iterator = list_iterator_create(job_list);
+	while ((job_scan_ptr = (struct job_record *)
+			list_next(job_iterator))) {
+		if (IS_JOB_RUNNING(job_scan_ptr) &&
+		    (job_scan_ptr->other_port == job_ptr->other_port) &&
+		    !xstrcmp(job_scan_ptr->resp_host, job_ptr->resp_host))
+			job_scan_ptr->time_last_active = now;
+	}
+	list_iterator_destroy(job_iterator);
 }
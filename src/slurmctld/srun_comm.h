@@ -51,6 +51,21 @@
  */
 extern void srun_allocate (uint32_t job_id);
 
+/*
+ * srun_comm_note_failure - record that a message to some srun/salloc
+ *	process could not be delivered, triggering exponential backoff
+ *	of further messages to that address
+ * IN addr - destination address of the failed message
+ */
+extern void srun_comm_note_failure(slurm_addr_t *addr);
+
+/*
+ * srun_comm_note_success - record that a message to some srun/salloc
+ *	process was delivered, clearing any backoff for that address
+ * IN addr - destination address of the delivered message
+ */
+extern void srun_comm_note_success(slurm_addr_t *addr);
+
 /*
  * srun_allocate_abort - notify srun of a resource allocation failure
  * IN job_id - id of the job allocated resource
@@ -46,6 +46,7 @@
 #include <pthread.h>
 
 #include "src/common/macros.h"
+#include "src/common/slurm_protocol_api.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/slurmctld.h"
@@ -94,6 +95,43 @@ extern int fsync_and_close(int fd, char *file_type)
 	return rc;
 }
 
+/* Stream a completed state save buffer to the backup controller so it can
+ * maintain a hot replica of the state files and avoid reloading them from
+ * StateSaveLocation on takeover. Sends are best effort, if one is lost the
+ * backup falls back upon whatever StateSaveLocation holds as before.
+ * file_name IN - state file base name (e.g. "job_state")
+ * buffer IN - the serialized state, as written to the state save file */
+extern void stream_state_file(char *file_name, Buf buffer)
+{
+	slurm_msg_t req;
+	ctld_state_stream_msg_t msg;
+	int rc;
+
+	if (slurmctld_primary == 0)
+		return;		/* we are the hot replica */
+	if ((slurmctld_conf.backup_addr == NULL) ||
+	    (slurmctld_conf.backup_addr[0] == '\0'))
+		return;		/* no backup controller configured */
+
+	slurm_msg_t_init(&req);
+	slurm_set_addr(&req.address, slurmctld_conf.slurmctld_port,
+		       slurmctld_conf.backup_addr);
+	req.msg_type = REQUEST_CTLD_STATE_STREAM;
+	msg.file_name = file_name;
+	msg.data_size = get_buf_offset(buffer);
+	msg.data = get_buf_data(buffer);
+	req.data = &msg;
+
+	if (slurm_send_recv_rc_msg_only_one(&req, &rc,
+					    (CONTROL_TIMEOUT * 1000)) < 0) {
+		debug2("stream_state_file: send of %s to backup failed: %m",
+		       file_name);
+	} else if (rc != SLURM_SUCCESS) {
+		debug2("stream_state_file: backup did not accept %s: %s",
+		       file_name, slurm_strerror(rc));
+	}
+}
+
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void)
 {
@@ -40,11 +40,18 @@
 #ifndef _SLURMCTLD_STATE_SAVE_H
 #define _SLURMCTLD_STATE_SAVE_H
 
+#include "src/common/pack.h"
+
 /* fsync() and close() a file,
  * Execute fsync() and close() multiple times if necessary and log failures
  * RET 0 on success or -1 on error */
 extern int fsync_and_close(int fd, char *file_type);
 
+/* Stream a completed state save buffer to the backup controller so it can
+ * maintain a hot replica of the state files. No-op unless this is the
+ * primary controller and a backup controller is configured */
+extern void stream_state_file(char *file_name, Buf buffer);
+
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void);
 
@@ -175,7 +175,7 @@ static struct step_record * _create_step_record(struct job_record *job_ptr,
 		return NULL;
 	}
 
-	step_ptr = (struct step_record *) xmalloc(sizeof(struct step_record));
+	step_ptr = (struct step_record *) rec_pool_get(REC_POOL_STEP);
 
 	last_job_update = time(NULL);
 	step_ptr->job_ptr    = job_ptr;
@@ -193,6 +193,66 @@ static struct step_record * _create_step_record(struct job_record *job_ptr,
 	return step_ptr;
 }
 
+/* Adjust the job's persistent per-node count of active steps as a step
+ * starts (incr=1) or is purged (incr=-1). This summary spares
+ * _pick_step_nodes() from replaying the whole step list on every step
+ * launch. Only steps which made it into the job's step list with a
+ * state of at least JOB_RUNNING are counted; see also
+ * step_node_usage_rebuild(). */
+static void _step_node_usage(struct step_record *step_ptr, int incr)
+{
+	struct job_record *job_ptr = step_ptr->job_ptr;
+	int i_node, i_first, i_last;
+
+	if (!step_ptr->step_node_bitmap)
+		return;
+	if (!job_ptr->steps_on_node) {
+		if (incr < 0)
+			return;
+		job_ptr->steps_on_node = xmalloc(sizeof(uint16_t) *
+						 node_record_count);
+	}
+	i_first = bit_ffs(step_ptr->step_node_bitmap);
+	if (i_first == -1)
+		return;
+	i_last = bit_fls(step_ptr->step_node_bitmap);
+	i_last = MIN(i_last, node_record_count - 1);
+	for (i_node = i_first; i_node <= i_last; i_node++) {
+		if (!bit_test(step_ptr->step_node_bitmap, i_node))
+			continue;
+		if (incr > 0) {
+			job_ptr->steps_on_node[i_node]++;
+		} else if (job_ptr->steps_on_node[i_node]) {
+			job_ptr->steps_on_node[i_node]--;
+		} else {
+			error("%s: step count underflow for job %u node %d",
+			      __func__, job_ptr->job_id, i_node);
+		}
+	}
+}
+
+/*
+ * step_node_usage_rebuild - Rebuild a job's per-node count of active steps
+ *	from its step list, used after recovering job state from disk
+ * IN job_ptr - pointer to job table entry
+ */
+extern void step_node_usage_rebuild(struct job_record *job_ptr)
+{
+	ListIterator step_iterator;
+	struct step_record *step_ptr;
+
+	xfree(job_ptr->steps_on_node);
+	if (!job_ptr->step_list)
+		return;
+	step_iterator = list_iterator_create(job_ptr->step_list);
+	while ((step_ptr = (struct step_record *) list_next(step_iterator))) {
+		if (step_ptr->state < JOB_RUNNING)
+			continue;
+		_step_node_usage(step_ptr, 1);
+	}
+	list_iterator_destroy(step_iterator);
+}
+
 /* The step with a state of PENDING is used as a placeholder for a host and
  * port that can be used to wake a pending srun as soon another step ends */
 static void _build_pending_step(struct job_record *job_ptr,
@@ -302,6 +362,8 @@ extern void step_list_purge(struct job_record *job_ptr)
 /* _free_step_rec - delete a step record's data structures */
 static void _free_step_rec(struct step_record *step_ptr)
 {
+	if (step_ptr->job_ptr && (step_ptr->state >= JOB_RUNNING))
+		_step_node_usage(step_ptr, -1);
 /* FIXME: If job step record is preserved after completion,
  * the switch_g_job_step_complete() must be called upon completion
  * and not upon record purging. Presently both events occur
@@ -334,7 +396,7 @@ static void _free_step_rec(struct step_record *step_ptr)
 	xfree(step_ptr->tres_fmt_alloc_str);
 	xfree(step_ptr->ext_sensors);
 	step_ptr->job_ptr = NULL;
-	xfree(step_ptr);
+	rec_pool_put(REC_POOL_STEP, step_ptr);
 }
 
 /*
@@ -1416,22 +1478,32 @@ _pick_step_nodes (struct job_record  *job_ptr,
 		FREE_NULL_BITMAP (relative_nodes);
 	} else {
 		nodes_idle = bit_alloc (bit_size (nodes_avail) );
-		step_iterator = list_iterator_create(job_ptr->step_list);
-		while ((step_p = (struct step_record *)
-			list_next(step_iterator))) {
-			if (step_p->state < JOB_RUNNING)
-				continue;
-			bit_or(nodes_idle, step_p->step_node_bitmap);
-			if (slurmctld_conf.debug_flags & DEBUG_FLAG_STEPS) {
+		/* Read the job's persistent per-node step counts rather
+		 * than replaying the entire step list, whose length grows
+		 * with every concurrent step */
+		if (job_ptr->steps_on_node) {
+			i = MIN(node_record_count, bit_size(nodes_idle));
+			for (node_inx = 0; node_inx < i; node_inx++) {
+				if (job_ptr->steps_on_node[node_inx])
+					bit_set(nodes_idle, node_inx);
+			}
+		}
+		if (slurmctld_conf.debug_flags & DEBUG_FLAG_STEPS) {
+			step_iterator =
+				list_iterator_create(job_ptr->step_list);
+			while ((step_p = (struct step_record *)
+				list_next(step_iterator))) {
 				char *temp;
+				if (step_p->state < JOB_RUNNING)
+					continue;
 				temp = bitmap2node_name(step_p->
 							step_node_bitmap);
 				info("step %u.%u has nodes %s",
 				     job_ptr->job_id, step_p->step_id, temp);
 				xfree(temp);
 			}
+			list_iterator_destroy (step_iterator);
 		}
-		list_iterator_destroy (step_iterator);
 		bit_not(nodes_idle);
 		bit_and(nodes_idle, nodes_avail);
 	}
@@ -2405,6 +2477,7 @@ step_create(job_step_create_request_msg_t *step_specs,
 			step_node_list, step_specs->node_list);
 	}
 	step_ptr->step_node_bitmap = nodeset;
+	_step_node_usage(step_ptr, 1);
 
 	switch (step_specs->task_dist & SLURM_DIST_NODESOCKMASK) {
 	case SLURM_DIST_CYCLIC:
@@ -4386,6 +4459,7 @@ extern struct step_record *build_extern_step(struct job_record *job_ptr)
 	if (job_ptr->node_bitmap)
 		step_ptr->step_node_bitmap =
 			bit_copy(job_ptr->node_bitmap);
+	_step_node_usage(step_ptr, 1);
 	step_ptr->time_last_active = time(NULL);
 	step_set_alloc_tres(step_ptr, 1, false, false);
 
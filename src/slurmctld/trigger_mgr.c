@@ -92,6 +92,14 @@ static bool trigger_pri_dbd_res_op = false;
 static bool trigger_pri_db_fail = false;
 static bool trigger_pri_db_res_op = false;
 
+/* Set when a node or front end state transition has been published
+ * since the last trigger_process() pass. When clear, the per-trigger
+ * event tests are skipped entirely (except for the time based idle
+ * node triggers), so the periodic pass costs nothing unless actual
+ * events arrived. */
+static bool trigger_node_event_pending = false;
+static bool trigger_front_end_event_pending = false;
+
 /* Current trigger pull states (saved and restored) */
 uint8_t ctld_failure = 0;
 uint8_t bu_ctld_failure = 0;
@@ -512,6 +520,7 @@ extern void trigger_front_end_down(front_end_record_t *front_end_ptr)
 	if (trigger_down_front_end_bitmap == NULL)
 		trigger_down_front_end_bitmap = bit_alloc(front_end_node_cnt);
 	bit_set(trigger_down_front_end_bitmap, inx);
+	trigger_front_end_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -523,6 +532,7 @@ extern void trigger_front_end_up(front_end_record_t *front_end_ptr)
 	if (trigger_up_front_end_bitmap == NULL)
 		trigger_up_front_end_bitmap = bit_alloc(front_end_node_cnt);
 	bit_set(trigger_up_front_end_bitmap, inx);
+	trigger_front_end_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -534,6 +544,7 @@ extern void trigger_node_down(struct node_record *node_ptr)
 	if (trigger_down_nodes_bitmap == NULL)
 		trigger_down_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_down_nodes_bitmap, inx);
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -545,6 +556,7 @@ extern void trigger_node_drained(struct node_record *node_ptr)
 	if (trigger_drained_nodes_bitmap == NULL)
 		trigger_drained_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_drained_nodes_bitmap, inx);
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -556,6 +568,7 @@ extern void trigger_node_failing(struct node_record *node_ptr)
 	if (trigger_fail_nodes_bitmap == NULL)
 		trigger_fail_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_fail_nodes_bitmap, inx);
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -568,6 +581,7 @@ extern void trigger_node_up(struct node_record *node_ptr)
 	if (trigger_up_nodes_bitmap == NULL)
 		trigger_up_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_up_nodes_bitmap, inx);
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -593,6 +607,7 @@ extern void trigger_reconfig(void)
 	if (trigger_up_nodes_bitmap)
 		trigger_up_nodes_bitmap = bit_realloc(
 			trigger_up_nodes_bitmap, node_record_count);
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 extern void trigger_primary_ctld_fail(void)
@@ -692,6 +707,7 @@ extern void trigger_block_error(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_block_err = true;
+	trigger_node_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -884,6 +900,7 @@ extern int trigger_state_save(void)
 	xfree(reg_file);
 	xfree(new_file);
 	unlock_state_files();
+	stream_state_file("trigger_state", buffer);
 	free_buf(buffer);
 	return error_code;
 }
@@ -921,12 +938,10 @@ static int _open_resv_state_file(char **state_file)
 
 extern void trigger_state_restore(void)
 {
-	int data_allocated, data_read = 0;
-	uint32_t data_size = 0;
 	uint16_t protocol_version = (uint16_t) NO_VAL;
 	int state_fd, trigger_cnt = 0;
-	char *data = NULL, *state_file;
-	Buf buffer;
+	char *state_file;
+	Buf buffer = NULL;
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
@@ -937,31 +952,16 @@ extern void trigger_state_restore(void)
 	if (state_fd < 0) {
 		info("No trigger state file (%s) to recover", state_file);
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
-		close(state_fd);
+		(void) close(state_fd);
+		if (!(buffer = create_mmap_buf(state_file)))
+			error("Can not map trigger state file %s: %m",
+			      state_file);
 	}
 	xfree(state_file);
 	unlock_state_files();
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)	/* preserve the empty buffer unpack error path */
+		buffer = create_buf(NULL, 0);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	if (ver_str && !xstrcmp(ver_str, TRIGGER_STATE_VERSION))
 		safe_unpack16(&protocol_version, buffer);
@@ -1603,6 +1603,8 @@ static void _clear_event_triggers(void)
 	trigger_pri_dbd_res_op = false;
 	trigger_pri_db_fail = false;
 	trigger_pri_db_res_op = false;
+	trigger_node_event_pending = false;
+	trigger_front_end_event_pending = false;
 }
 
 /* Make a copy of a trigger and pre-pend it on our list */
@@ -1653,8 +1655,14 @@ extern void trigger_process(void)
 				_trigger_other_event(trig_in, now);
 			else if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
 				_trigger_job_event(trig_in, now);
-			else if (trig_in->res_type == TRIGGER_RES_TYPE_NODE)
-				_trigger_node_event(trig_in, now);
+			else if (trig_in->res_type ==
+				 TRIGGER_RES_TYPE_NODE) {
+				/* Without pending node events only the
+				 * time based idle test can fire */
+				if (trigger_node_event_pending ||
+				    (trig_in->trig_type & TRIGGER_TYPE_IDLE))
+					_trigger_node_event(trig_in, now);
+			}
 			else if (trig_in->res_type ==
 				 TRIGGER_RES_TYPE_SLURMCTLD)
 				_trigger_slurmctld_event(trig_in, now);
@@ -1665,8 +1673,11 @@ extern void trigger_process(void)
 				 TRIGGER_RES_TYPE_DATABASE)
 			 	_trigger_database_event(trig_in, now);
 			else if (trig_in->res_type ==
-				 TRIGGER_RES_TYPE_FRONT_END)
-			 	_trigger_front_end_event(trig_in, now);
+				 TRIGGER_RES_TYPE_FRONT_END) {
+				if (trigger_front_end_event_pending)
+					_trigger_front_end_event(trig_in,
+								 now);
+			}
 		}
 		if ((trig_in->state == 1) &&
 		    (trig_in->trig_time <= now)) {
@@ -60,12 +60,19 @@
 
 /* internal functions */
 size_t _file_getsize(int fd);
-int _file_read_uint32s(char* file_path, uint32_t** pvalues, int* pnb);
-int _file_write_uint32s(char* file_path, uint32_t* values, int nb);
-int _file_read_uint64s(char* file_path, uint64_t** pvalues, int* pnb);
-int _file_write_uint64s(char* file_path, uint64_t* values, int nb);
-int _file_read_content(char* file_path, char** content, size_t *csize);
-int _file_write_content(char* file_path, char* content, size_t csize);
+int _file_read_uint32s(int dirfd, char* file_path, uint32_t** pvalues,
+		       int* pnb);
+int _file_write_uint32s(int dirfd, char* file_path, uint32_t* values, int nb);
+int _file_read_uint64s(int dirfd, char* file_path, uint64_t** pvalues,
+		       int* pnb);
+int _file_write_uint64s(int dirfd, char* file_path, uint64_t* values, int nb);
+int _file_read_content(int dirfd, char* file_path, char** content,
+		       size_t *csize);
+int _file_write_content(int dirfd, char* file_path, char* content,
+			size_t csize);
+static int _ns_dirfd(xcgroup_ns_t* cgns);
+static int _cg_build_param_path(xcgroup_t* cg, char* param, char* file_path,
+				int* dirfd);
 
 
 /*
@@ -92,6 +99,7 @@ int xcgroup_ns_create(slurm_cgroup_conf_t *conf,
 	cgns->subsystems = xstrdup(subsys);
 	cgns->notify_prog = xstrdup_printf("%s/release_%s",
 					   conf->cgroup_release_agent, subsys);
+	cgns->mnt_dirfd = -1;
 
 	/* check that freezer cgroup namespace is available */
 	if (!xcgroup_ns_is_available(cgns)) {
@@ -121,6 +129,10 @@ clean:
  */
 void xcgroup_ns_destroy(xcgroup_ns_t* cgns)
 {
+	if (cgns->mnt_dirfd >= 0) {
+		close(cgns->mnt_dirfd);
+		cgns->mnt_dirfd = -1;
+	}
 	xfree(cgns->mnt_point);
 	xfree(cgns->mnt_args);
 	xfree(cgns->subsystems);
@@ -305,7 +317,7 @@ int xcgroup_ns_find_by_pid(xcgroup_ns_t* cgns, xcgroup_t* cg, pid_t pid)
 	 * multiple lines of the form :
 	 * num_mask:subsystems:relative_path
 	 */
-	fstatus = _file_read_content(file_path, &buf, &fsize);
+	fstatus = _file_read_content(AT_FDCWD, file_path, &buf, &fsize);
 	if (fstatus == XCGROUP_SUCCESS) {
 		fstatus = XCGROUP_ERROR;
 		p = buf;
@@ -346,6 +358,64 @@ int xcgroup_ns_load(slurm_cgroup_conf_t *conf, xcgroup_ns_t *cgns, char *subsys)
 	cgns->subsystems = xstrdup(subsys);
 	cgns->notify_prog = xstrdup_printf("%s/release_%s",
 					   conf->cgroup_release_agent, subsys);
+	cgns->mnt_dirfd = -1;
+	return XCGROUP_SUCCESS;
+}
+
+/*
+ * get the cached directory fd of a cgroup namespace mount point,
+ * opening it on first use
+ *
+ * returned values:
+ *  - fd of the mount point directory
+ *  - -1 if the mount point can not be opened
+ */
+static int _ns_dirfd(xcgroup_ns_t* cgns)
+{
+	if (cgns->mnt_dirfd < 0)
+		cgns->mnt_dirfd = open(cgns->mnt_point,
+				       O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	return cgns->mnt_dirfd;
+}
+
+/*
+ * build the path of a cgroup parameter file
+ *
+ * when the cgroup namespace has a usable mount point directory fd, the
+ * returned path is relative to that fd, letting the caller use the *at()
+ * syscalls and sparing the kernel a full mount point path traversal per
+ * parameter access. Otherwise the absolute path is returned with dirfd
+ * set to AT_FDCWD.
+ *
+ * returned values:
+ *  - XCGROUP_ERROR
+ *  - XCGROUP_SUCCESS
+ */
+static int _cg_build_param_path(xcgroup_t* cg, char* param, char* file_path,
+				int* dirfd)
+{
+	char* name = cg->name;
+	int fd = -1;
+
+	if (cg->ns)
+		fd = _ns_dirfd(cg->ns);
+	if (fd < 0) {
+		*dirfd = AT_FDCWD;
+		if (snprintf(file_path, PATH_MAX, "%s/%s", cg->path, param)
+		    >= PATH_MAX)
+			return XCGROUP_ERROR;
+		return XCGROUP_SUCCESS;
+	}
+
+	*dirfd = fd;
+	while (*name == '/')
+		name++;
+	if (*name == '\0') {
+		if (snprintf(file_path, PATH_MAX, "%s", param) >= PATH_MAX)
+			return XCGROUP_ERROR;
+	} else if (snprintf(file_path, PATH_MAX, "%s/%s", name, param)
+		   >= PATH_MAX)
+		return XCGROUP_ERROR;
 	return XCGROUP_SUCCESS;
 }
 
@@ -461,6 +531,13 @@ int xcgroup_instantiate(xcgroup_t* cg)
 			umask(omask);
 			return fstatus;
 		}
+		/* hierarchy levels shared by the steps of a job (user and
+		 * job cgroups) are instantiated again at each step launch.
+		 * Their ownership and notify_on_release flag were already
+		 * set when they were created, so skip the now redundant
+		 * chown and parameter write. */
+		umask(omask);
+		return XCGROUP_SUCCESS;
 	}
 	umask(omask);
 
@@ -560,7 +637,7 @@ int xcgroup_add_pids(xcgroup_t* cg, pid_t* pids, int npids)
 	int fstatus = XCGROUP_ERROR;
 	char* path = _cgroup_procs_writable_path(cg);
 
-	fstatus = _file_write_uint32s(path, (uint32_t*)pids, npids);
+	fstatus = _file_write_uint32s(AT_FDCWD, path, (uint32_t*)pids, npids);
 	if (fstatus != XCGROUP_SUCCESS)
 		debug2("%s: unable to add pids to '%s'", __func__, cg->path);
 
@@ -580,7 +657,7 @@ int xcgroup_get_pids(xcgroup_t* cg, pid_t **pids, int *npids)
 
 	path = _cgroup_procs_readable_path(cg);
 
-	fstatus = _file_read_uint32s(path, (uint32_t**)pids, npids);
+	fstatus = _file_read_uint32s(AT_FDCWD, path, (uint32_t**)pids, npids);
 	if (fstatus != XCGROUP_SUCCESS)
 		debug2("%s: unable to get pids of '%s'", __func__, cg->path);
 
@@ -597,6 +674,7 @@ int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 	char* value;
 	char* p;
 	char* next;
+	int dirfd;
 
 	params = (char*) xstrdup(parameters);
 
@@ -613,13 +691,13 @@ int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 		if (value != NULL) {
 			*value='\0';
 			value++;
-			if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, p)
-			     >= PATH_MAX) {
+			if (_cg_build_param_path(cg, p, file_path, &dirfd)
+			     != XCGROUP_SUCCESS) {
 				debug2("unable to build filepath for '%s' and"
 				       " parameter '%s' : %m", cpath, p);
 				goto next_loop;
 			}
-			fstatus = _file_write_content(file_path, value,
+			fstatus = _file_write_content(dirfd, file_path, value,
 						      strlen(value));
 			if (fstatus != XCGROUP_SUCCESS)
 				debug2("%s: unable to set parameter '%s' to "
@@ -644,14 +722,17 @@ int xcgroup_set_param(xcgroup_t* cg, char* param, char* content)
 	int fstatus = XCGROUP_ERROR;
 	char file_path[PATH_MAX];
 	char* cpath = cg->path;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 		return fstatus;
 	}
 
-	fstatus = _file_write_content(file_path, content, strlen(content));
+	fstatus = _file_write_content(dirfd, file_path, content,
+				      strlen(content));
 	if (fstatus != XCGROUP_SUCCESS)
 		debug2("%s: unable to set parameter '%s' to '%s' for '%s'",
 			__func__, param, content, cpath);
@@ -667,12 +748,14 @@ int xcgroup_get_param(xcgroup_t* cg, char* param, char **content, size_t *csize)
 	int fstatus = XCGROUP_ERROR;
 	char file_path[PATH_MAX];
 	char* cpath = cg->path;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 	} else {
-		fstatus = _file_read_content(file_path, content, csize);
+		fstatus = _file_read_content(dirfd, file_path, content, csize);
 		if (fstatus != XCGROUP_SUCCESS)
 			debug2("%s: unable to get parameter '%s' for '%s'",
 				__func__, param, cpath);
@@ -685,14 +768,16 @@ int xcgroup_set_uint32_param(xcgroup_t* cg, char* param, uint32_t value)
 	int fstatus = XCGROUP_ERROR;
 	char file_path[PATH_MAX];
 	char* cpath = cg->path;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 		return fstatus;
 	}
 
-	fstatus = _file_write_uint32s(file_path, &value, 1);
+	fstatus = _file_write_uint32s(dirfd, file_path, &value, 1);
 	if (fstatus != XCGROUP_SUCCESS)
 		debug2("%s: unable to set parameter '%s' to '%u' for '%s'",
 			__func__, param, value, cpath);
@@ -710,12 +795,14 @@ int xcgroup_get_uint32_param(xcgroup_t* cg, char* param, uint32_t* value)
 	char* cpath = cg->path;
 	uint32_t* values;
 	int vnb;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 	} else {
-		fstatus = _file_read_uint32s(file_path, &values, &vnb);
+		fstatus = _file_read_uint32s(dirfd, file_path, &values, &vnb);
 		if (fstatus != XCGROUP_SUCCESS) {
 			debug2("%s: unable to get parameter '%s' for '%s'",
 				__func__, param, cpath);
@@ -736,14 +823,16 @@ int xcgroup_set_uint64_param(xcgroup_t* cg, char* param, uint64_t value)
 	int fstatus = XCGROUP_ERROR;
 	char file_path[PATH_MAX];
 	char* cpath = cg->path;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 		return fstatus;
 	}
 
-	fstatus = _file_write_uint64s(file_path, &value, 1);
+	fstatus = _file_write_uint64s(dirfd, file_path, &value, 1);
 	if (fstatus != XCGROUP_SUCCESS)
 		debug2("%s: unable to set parameter '%s' to '%"PRIu64"' for "
 			"'%s'", __func__, param, value, cpath);
@@ -761,13 +850,15 @@ int xcgroup_get_uint64_param(xcgroup_t* cg, char* param, uint64_t* value)
 	char* cpath = cg->path;
 	uint64_t* values;
 	int vnb;
+	int dirfd;
 
-	if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, param) >= PATH_MAX) {
+	if (_cg_build_param_path(cg, param, file_path, &dirfd)
+	    != XCGROUP_SUCCESS) {
 		debug2("unable to build filepath for '%s' and"
 		       " parameter '%s' : %m", cpath, param);
 	}
 	else {
-		fstatus = _file_read_uint64s(file_path, &values, &vnb);
+		fstatus = _file_read_uint64s(dirfd, file_path, &values, &vnb);
 		if (fstatus != XCGROUP_SUCCESS) {
 			debug2("%s: unable to get parameter '%s' for '%s'",
 				__func__, param, cpath);
@@ -859,7 +950,7 @@ size_t _file_getsize(int fd)
 		return fsize;
 }
 
-int _file_write_uint64s(char* file_path, uint64_t* values, int nb)
+int _file_write_uint64s(int dirfd, char* file_path, uint64_t* values, int nb)
 {
 	int fstatus;
 	int rc;
@@ -869,7 +960,7 @@ int _file_write_uint64s(char* file_path, uint64_t* values, int nb)
 	int i;
 
 	/* open file for writing */
-	fd = open(file_path, O_WRONLY, 0700);
+	fd = openat(dirfd, file_path, O_WRONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for writing : %m",
 			__func__, file_path);
@@ -909,7 +1000,8 @@ int _file_write_uint64s(char* file_path, uint64_t* values, int nb)
 	return fstatus;
 }
 
-int _file_read_uint64s(char* file_path, uint64_t** pvalues, int* pnb)
+int _file_read_uint64s(int dirfd, char* file_path, uint64_t** pvalues,
+		       int* pnb)
 {
 	int rc;
 	int fd;
@@ -926,7 +1018,7 @@ int _file_read_uint64s(char* file_path, uint64_t** pvalues, int* pnb)
 		return XCGROUP_ERROR;
 
 	/* open file for reading */
-	fd = open(file_path, O_RDONLY, 0700);
+	fd = openat(dirfd, file_path, O_RDONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for reading : %m",
 			__func__, file_path);
@@ -981,7 +1073,7 @@ int _file_read_uint64s(char* file_path, uint64_t** pvalues, int* pnb)
 	return XCGROUP_SUCCESS;
 }
 
-int _file_write_uint32s(char* file_path, uint32_t* values, int nb)
+int _file_write_uint32s(int dirfd, char* file_path, uint32_t* values, int nb)
 {
 	int fstatus;
 	int rc;
@@ -991,7 +1083,7 @@ int _file_write_uint32s(char* file_path, uint32_t* values, int nb)
 	int i;
 
 	/* open file for writing */
-	fd = open(file_path, O_WRONLY, 0700);
+	fd = openat(dirfd, file_path, O_WRONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for writing : %m",
 			__func__, file_path);
@@ -1031,7 +1123,8 @@ int _file_write_uint32s(char* file_path, uint32_t* values, int nb)
 	return fstatus;
 }
 
-int _file_read_uint32s(char* file_path, uint32_t** pvalues, int* pnb)
+int _file_read_uint32s(int dirfd, char* file_path, uint32_t** pvalues,
+		       int* pnb)
 {
 	int rc;
 	int fd;
@@ -1048,7 +1141,7 @@ int _file_read_uint32s(char* file_path, uint32_t** pvalues, int* pnb)
 		return XCGROUP_ERROR;
 
 	/* open file for reading */
-	fd = open(file_path, O_RDONLY, 0700);
+	fd = openat(dirfd, file_path, O_RDONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for reading : %m",
 			__func__, file_path);
@@ -1102,14 +1195,15 @@ int _file_read_uint32s(char* file_path, uint32_t** pvalues, int* pnb)
 	return XCGROUP_SUCCESS;
 }
 
-int _file_write_content(char* file_path, char* content, size_t csize)
+int _file_write_content(int dirfd, char* file_path, char* content,
+			size_t csize)
 {
 	int fstatus;
 	int rc;
 	int fd;
 
 	/* open file for writing */
-	fd = open(file_path, O_WRONLY, 0700);
+	fd = openat(dirfd, file_path, O_WRONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for writing : %m",
 			__func__, file_path);
@@ -1135,7 +1229,8 @@ int _file_write_content(char* file_path, char* content, size_t csize)
 	return fstatus;
 }
 
-int _file_read_content(char* file_path, char** content, size_t *csize)
+int _file_read_content(int dirfd, char* file_path, char** content,
+		       size_t *csize)
 {
 	int fstatus;
 	int rc;
@@ -1151,7 +1246,7 @@ int _file_read_content(char* file_path, char** content, size_t *csize)
 		return fstatus;
 
 	/* open file for reading */
-	fd = open(file_path, O_RDONLY, 0700);
+	fd = openat(dirfd, file_path, O_RDONLY, 0700);
 	if (fd < 0) {
 		debug2("%s: unable to open '%s' for reading : %m",
 			__func__, file_path);
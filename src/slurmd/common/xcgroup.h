@@ -63,6 +63,11 @@ typedef struct xcgroup_ns {
 
 	char* notify_prog;/* prog to use with notify on release action */
 
+	int   mnt_dirfd;  /* cached fd of the mount point directory, opened
+			   * lazily and used with the *at() syscalls to spare
+			   * a full path traversal per attribute access
+			   * (-1 while not opened) */
+
 } xcgroup_ns_t;
 
 typedef struct xcgroup {
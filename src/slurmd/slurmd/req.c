@@ -233,6 +233,7 @@ static void _remove_job_running_prolog(uint32_t job_id);
 static int  _match_jobid(void *s0, void *s1);
 static void _wait_for_job_running_prolog(uint32_t job_id);
 static bool _requeue_setup_env_fail(void);
+static void _stepd_pool_fill(void);
 
 /*
  *  List of threads waiting for jobs to complete
@@ -252,6 +253,19 @@ static pthread_mutex_t fini_mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint32_t fini_job_id[FINI_JOB_CNT];
 static int next_fini_job_inx = 0;
 
+/* Pool of preforked slurmstepd processes parked in _init_from_slurmd()
+ * waiting for their job setup, so interactive step launch does not pay
+ * for exec and plugin initialization. Sized with
+ * LaunchParameters=stepd_pool_size=#, disabled by default. */
+#define STEPD_POOL_MAX 16
+typedef struct {
+	int to_stepd;		/* write job setup to the parked stepd  */
+	int to_slurmd;		/* read the stepd return code           */
+} stepd_pool_entry_t;
+static pthread_mutex_t stepd_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stepd_pool_entry_t stepd_pool[STEPD_POOL_MAX];
+static int stepd_pool_cnt = 0;
+
 /* NUM_PARALLEL_SUSP_JOBS controls the number of jobs that can be suspended or
  * resumed at one time. */
 #define NUM_PARALLEL_SUSP_JOBS 64
@@ -275,14 +289,31 @@ static pthread_cond_t  file_bcast_cond  = PTHREAD_COND_INITIALIZER;
 static int fb_read_lock = 0, fb_write_wait_lock = 0, fb_write_lock = 0;
 static List file_bcast_list = NULL;
 
+/* Content hashes of files previously written by sbcast so a repeated
+ * transfer of identical contents can be skipped without rehashing the
+ * file on every launch */
+#define FILE_BCAST_CACHE_SIZE 64
+typedef struct file_bcast_cache {
+	char *fname;		/* destination file name */
+	uint64_t digest;	/* content hash of the file */
+	uint64_t file_size;	/* file size when hashed */
+	time_t mtime;		/* file mtime when hashed */
+	uid_t uid;		/* owner of the file */
+} file_bcast_cache_t;
+static pthread_mutex_t file_bcast_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List file_bcast_cache_list = NULL;
+
 void
 slurmd_req(slurm_msg_t *msg)
 {
 	int rc;
 
 	if (msg == NULL) {
-		if (startup == 0)
+		if (startup == 0) {
 			startup = time(NULL);
+			/* Prime the preforked slurmstepd pool */
+			_stepd_pool_fill();
+		}
 		FREE_NULL_LIST(waiters);
 		slurm_mutex_lock(&job_limits_mutex);
 		if (job_limits_list) {
@@ -475,7 +506,8 @@ static int _send_slurmd_conf_lite (int fd, slurmd_conf_t *cf)
 static int
 _send_slurmstepd_init(int fd, int type, void *req,
 		      slurm_addr_t *cli, slurm_addr_t *self,
-		      hostset_t step_hset, uint16_t protocol_version)
+		      hostset_t step_hset, uint16_t protocol_version,
+		      int prolog_pending)
 {
 	int len = 0;
 	Buf buffer = NULL;
@@ -577,6 +609,11 @@ _send_slurmstepd_init(int fd, int type, void *req,
 	safe_write(fd, &max_depth, sizeof(int));
 	safe_write(fd, &parent_addr, sizeof(slurm_addr_t));
 
+	/* nonzero if the job prolog is still running and a separate
+	 * notification with its return code will follow through the
+	 * step's message socket */
+	safe_write(fd, &prolog_pending, sizeof(int));
+
 	/* send conf over to slurmstepd */
 	if (_send_slurmd_conf_lite(fd, conf) < 0)
 		goto rwfail;
@@ -725,14 +762,287 @@ rwfail:
  * becomes the slurmstepd process, so the slurmstepd's parent process
  * will be init, not slurmd.
  */
+static int
+_stepd_pool_limit(void)
+{
+	static int pool_size = -1;
+
+	if (pool_size == -1) {
+		char *launch_params = slurm_get_launch_params();
+		char *tmp_ptr;
+
+		pool_size = 0;
+#if (SLURMSTEPD_MEMCHECK == 0)
+		/* The memcheck wrappers build a per-step argv, so the
+		 * pool is only usable in a normal build. */
+		if (launch_params &&
+		    (tmp_ptr = strstr(launch_params, "stepd_pool_size="))) {
+			pool_size = atoi(tmp_ptr + 16);
+			if (pool_size < 0)
+				pool_size = 0;
+			else if (pool_size > STEPD_POOL_MAX)
+				pool_size = STEPD_POOL_MAX;
+		}
+#endif
+		xfree(launch_params);
+	}
+
+	return pool_size;
+}
+
+/* Fork and exec one slurmstepd which parks reading its job setup from
+ * the slurmd, and add its pipes to the pool. The stepd pays for exec
+ * and plugin initialization before any step arrives.
+ * Note: Call with stepd_pool_mutex locked. */
+static int
+_prespawn_slurmstepd(void)
+{
+	pid_t pid;
+	int to_stepd[2] = {-1, -1};
+	int to_slurmd[2] = {-1, -1};
+
+	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
+		error("%s: pipe failed: %m", __func__);
+		if (to_stepd[0] != -1) {
+			close(to_stepd[0]);
+			close(to_stepd[1]);
+		}
+		return SLURM_FAILURE;
+	}
+
+	if ((pid = fork()) < 0) {
+		error("%s: fork: %m", __func__);
+		close(to_stepd[0]);
+		close(to_stepd[1]);
+		close(to_slurmd[0]);
+		close(to_slurmd[1]);
+		return SLURM_FAILURE;
+	} else if (pid > 0) {
+		if (close(to_stepd[0]) < 0)
+			error("Unable to close read to_stepd in parent: %m");
+		if (close(to_slurmd[1]) < 0)
+			error("Unable to close write to_slurmd in parent: %m");
+
+		/* Reap child */
+		if (waitpid(pid, NULL, 0) < 0)
+			error("Unable to reap slurmd child process");
+
+		stepd_pool[stepd_pool_cnt].to_stepd  = to_stepd[1];
+		stepd_pool[stepd_pool_cnt].to_slurmd = to_slurmd[0];
+		stepd_pool_cnt++;
+		return SLURM_SUCCESS;
+	} else {
+		char *const argv[2] = { (char *)conf->stepd_loc, NULL};
+		int i;
+		int failed = 0;
+
+		/* inform slurmstepd about our config */
+		setenv("SLURM_CONF", conf->conffile, 1);
+
+		/*
+		 * Child forks and exits
+		 */
+		if (setsid() < 0) {
+			error("%s: setsid: %m", __func__);
+			failed = 1;
+		}
+		if ((pid = fork()) < 0) {
+			error("%s: Unable to fork grandchild: %m", __func__);
+			failed = 2;
+		} else if (pid > 0) { /* child */
+			exit(0);
+		}
+
+		/* Protect against open files without close on exec, as
+		 * in _forkexec_slurmstepd() below. */
+		for (i=3; i<256; i++) {
+			(void) fcntl(i, F_SETFD, FD_CLOEXEC);
+		}
+
+		/*
+		 * Grandchild exec's the slurmstepd
+		 */
+		if ((to_stepd[0] != conf->lfd)
+		    && (to_slurmd[1] != conf->lfd))
+			slurm_shutdown_msg_engine(conf->lfd);
+
+		if (close(to_stepd[1]) < 0)
+			error("close write to_stepd in grandchild: %m");
+		if (close(to_slurmd[0]) < 0)
+			error("close read to_slurmd in parent: %m");
+
+		(void) close(STDIN_FILENO); /* ignore return */
+		if (dup2(to_stepd[0], STDIN_FILENO) == -1) {
+			error("dup2 over STDIN_FILENO: %m");
+			exit(1);
+		}
+		fd_set_close_on_exec(to_stepd[0]);
+		(void) close(STDOUT_FILENO); /* ignore return */
+		if (dup2(to_slurmd[1], STDOUT_FILENO) == -1) {
+			error("dup2 over STDOUT_FILENO: %m");
+			exit(1);
+		}
+		fd_set_close_on_exec(to_slurmd[1]);
+		(void) close(STDERR_FILENO); /* ignore return */
+		if (dup2(devnull, STDERR_FILENO) == -1) {
+			error("dup2 /dev/null to STDERR_FILENO: %m");
+			exit(1);
+		}
+		fd_set_noclose_on_exec(STDERR_FILENO);
+		log_fini();
+		if (!failed) {
+			if (conf->chos_loc && !access(conf->chos_loc, X_OK))
+				execvp(conf->chos_loc, argv);
+			else
+				execvp(argv[0], argv);
+			error("exec of slurmstepd failed: %m");
+		}
+		exit(2);
+	}
+}
+
+/* Take the pipes of a parked slurmstepd out of the pool.
+ * Returns false when the pool is empty or disabled. */
+static bool
+_stepd_pool_get(int *to_stepd, int *to_slurmd)
+{
+	bool found = false;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (stepd_pool_cnt > 0) {
+		stepd_pool_cnt--;
+		*to_stepd  = stepd_pool[stepd_pool_cnt].to_stepd;
+		*to_slurmd = stepd_pool[stepd_pool_cnt].to_slurmd;
+		found = true;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return found;
+}
+
+/* Replenish the pool up to its configured size. Called at startup and
+ * after each launch which consumed a pool entry. */
+static void
+_stepd_pool_fill(void)
+{
+	int limit = _stepd_pool_limit();
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	while (stepd_pool_cnt < limit) {
+		if (_prespawn_slurmstepd() != SLURM_SUCCESS)
+			break;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+/* Wait for the slurmstepd return code after the job setup has been
+ * sent, then acknowledge it. Used for both freshly forked and pool
+ * slurmstepd processes. */
+static int
+_wait_slurmstepd_init(int to_stepd, int to_slurmd)
+{
+	int rc = SLURM_SUCCESS;
+	/* If running under valgrind/memcheck, this pipe doesn't work
+	 * correctly so just skip it. */
+#if (SLURMSTEPD_MEMCHECK == 0)
+	int i;
+	time_t start_time = time(NULL);
+
+	i = read(to_slurmd, &rc, sizeof(int));
+	if (i < 0) {
+		error("%s: Can not read return code from slurmstepd "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_FAILURE;
+	} else if (i != sizeof(int)) {
+		error("%s: slurmstepd failed to send return code "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_FAILURE;
+	} else {
+		int delta_time = time(NULL) - start_time;
+		int cc;
+		if (delta_time > 5) {
+			info("Warning: slurmstepd startup took %d sec, "
+			     "possible file system problem or full "
+			     "memory", delta_time);
+		}
+		if (rc != SLURM_SUCCESS)
+			error("slurmstepd return code %d", rc);
+
+		cc = SLURM_SUCCESS;
+		cc = write(to_stepd, &cc, sizeof(int));
+		if (cc != sizeof(int)) {
+			error("%s: failed to send ack to stepd %d: %m",
+			      __func__, cc);
+		}
+	}
+#endif
+	return rc;
+}
+
+/* Launch a job step through a preforked slurmstepd when one is parked.
+ * Returns true with *rc_ptr set when the pool handled the launch. On
+ * false the caller falls back to a fresh fork/exec, covering both an
+ * empty pool and a parked stepd which died while waiting. */
+static bool
+_stepd_pool_run(uint16_t type, void *req, slurm_addr_t *cli,
+		slurm_addr_t *self, const hostset_t step_hset,
+		uint16_t protocol_version, int prolog_pending, int *rc_ptr)
+{
+	int to_stepd = -1, to_slurmd = -1, rc;
+
+	if (!_stepd_pool_get(&to_stepd, &to_slurmd))
+		return false;
+
+	if (_add_starting_step(type, req)) {
+		error("%s failed in _add_starting_step: %m", __func__);
+		close(to_stepd);
+		close(to_slurmd);
+		*rc_ptr = SLURM_FAILURE;
+		return true;
+	}
+
+	rc = _send_slurmstepd_init(to_stepd, type, req, cli, self,
+				   step_hset, protocol_version,
+				   prolog_pending);
+	if (rc != 0) {
+		/* The parked stepd probably died while waiting; it
+		 * never saw this step, so a fresh fork/exec is safe. */
+		error("Unable to init preforked slurmstepd, "
+		      "falling back to fork/exec");
+		if (_remove_starting_step(type, req))
+			error("Error cleaning up starting_step list");
+		close(to_stepd);
+		close(to_slurmd);
+		_stepd_pool_fill();
+		return false;
+	}
+
+	rc = _wait_slurmstepd_init(to_stepd, to_slurmd);
+
+	if (_remove_starting_step(type, req))
+		error("Error cleaning up starting_step list");
+	close(to_stepd);
+	close(to_slurmd);
+	_stepd_pool_fill();
+
+	*rc_ptr = rc;
+	return true;
+}
+
 static int
 _forkexec_slurmstepd(uint16_t type, void *req,
 		     slurm_addr_t *cli, slurm_addr_t *self,
-		     const hostset_t step_hset, uint16_t protocol_version)
+		     const hostset_t step_hset, uint16_t protocol_version,
+		     int prolog_pending)
 {
 	pid_t pid;
 	int to_stepd[2] = {-1, -1};
 	int to_slurmd[2] = {-1, -1};
+	int pool_rc;
+
+	if (_stepd_pool_run(type, req, cli, self, step_hset,
+			    protocol_version, prolog_pending, &pool_rc))
+		return pool_rc;
 
 	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
 		error("_forkexec_slurmstepd pipe failed: %m");
@@ -754,10 +1064,6 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 		return SLURM_FAILURE;
 	} else if (pid > 0) {
 		int rc = SLURM_SUCCESS;
-#if (SLURMSTEPD_MEMCHECK == 0)
-		int i;
-		time_t start_time = time(NULL);
-#endif
 		/*
 		 * Parent sends initialization data to the slurmstepd
 		 * over the to_stepd pipe, and waits for the return code
@@ -771,42 +1077,13 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
 						req, cli, self,
 						step_hset,
-						protocol_version)) != 0) {
+						protocol_version,
+						prolog_pending)) != 0) {
 			error("Unable to init slurmstepd");
 			goto done;
 		}
 
-		/* If running under valgrind/memcheck, this pipe doesn't work
-		 * correctly so just skip it. */
-#if (SLURMSTEPD_MEMCHECK == 0)
-		i = read(to_slurmd[0], &rc, sizeof(int));
-		if (i < 0) {
-			error("%s: Can not read return code from slurmstepd "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_FAILURE;
-		} else if (i != sizeof(int)) {
-			error("%s: slurmstepd failed to send return code "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_FAILURE;
-		} else {
-			int delta_time = time(NULL) - start_time;
-			int cc;
-			if (delta_time > 5) {
-				info("Warning: slurmstepd startup took %d sec, "
-				     "possible file system problem or full "
-				     "memory", delta_time);
-			}
-			if (rc != SLURM_SUCCESS)
-				error("slurmstepd return code %d", rc);
-
-			cc = SLURM_SUCCESS;
-			cc = write(to_stepd[1], &cc, sizeof(int));
-			if (cc != sizeof(int)) {
-				error("%s: failed to send ack to stepd %d: %m",
-				      __func__, cc);
-			}
-		}
-#endif
+		rc = _wait_slurmstepd_init(to_stepd[1], to_slurmd[0]);
 	done:
 		if (_remove_starting_step(type, req))
 			error("Error cleaning up starting_step list");
@@ -818,6 +1095,7 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 			error("close write to_stepd in parent: %m");
 		if (close(to_slurmd[0]) < 0)
 			error("close read to_slurmd in parent: %m");
+		_stepd_pool_fill();
 		return rc;
 	} else {
 #if (SLURMSTEPD_MEMCHECK == 1)
@@ -1207,6 +1485,44 @@ _check_job_credential(launch_tasks_request_msg_t *req, uid_t uid,
 }
 
 
+/* Argument for running the job prolog in a pthread while the
+ * slurmstepd is launched and brings up its I/O connections */
+typedef struct prolog_thread_arg {
+	job_env_t job_env;
+	slurm_cred_t *cred;
+	int rc;
+} prolog_thread_arg_t;
+
+static void *_prolog_thread(void *x)
+{
+	prolog_thread_arg_t *arg = (prolog_thread_arg_t *) x;
+
+	arg->rc = _run_prolog(&arg->job_env, arg->cred);
+	return NULL;
+}
+
+/* Report the prolog's return code to a slurmstepd which was launched
+ * while the prolog was still running on this node */
+static void _notify_stepd_prolog_fini(uint32_t job_id, uint32_t step_id,
+				      int prolog_rc)
+{
+	int fd;
+	uint16_t protocol_version;
+
+	fd = stepd_connect(conf->spooldir, conf->node_name,
+			   job_id, step_id, &protocol_version);
+	if (fd == -1) {
+		/* step may have failed to start or already exited */
+		debug2("%s: unable to connect to step %u.%u",
+		       __func__, job_id, step_id);
+		return;
+	}
+	if (stepd_prolog_fini(fd, protocol_version, prolog_rc) < 0)
+		error("%s: notify of step %u.%u failed: %m",
+		      __func__, job_id, step_id);
+	close(fd);
+}
+
 static void
 _rpc_launch_tasks(slurm_msg_t *msg)
 {
@@ -1218,6 +1534,10 @@ _rpc_launch_tasks(slurm_msg_t *msg)
 	bool     super_user = false;
 #ifndef HAVE_FRONT_END
 	bool     first_job_run;
+	bool     prolog_spawned = false, prolog_pending = false;
+	pthread_t prolog_tid = (pthread_t) 0;
+	pthread_attr_t prolog_attr;
+	prolog_thread_arg_t prolog_arg;
 #endif
 	slurm_addr_t self;
 	slurm_addr_t *cli = &msg->orig_addr;
@@ -1269,9 +1589,6 @@ _rpc_launch_tasks(slurm_msg_t *msg)
 
 #ifndef HAVE_FRONT_END
 	if (first_job_run) {
-		int rc;
-		job_env_t job_env;
-
 		slurm_cred_insert_jobid(conf->vctx, req->job_id);
 		_add_job_running_prolog(req->job_id);
 		slurm_mutex_unlock(&prolog_mutex);
@@ -1279,43 +1596,56 @@ _rpc_launch_tasks(slurm_msg_t *msg)
 		if (container_g_create(req->job_id))
 			error("container_g_create(%u): %m", req->job_id);
 
-		memset(&job_env, 0, sizeof(job_env_t));
-
-		job_env.jobid = req->job_id;
-		job_env.step_id = req->job_step_id;
-		job_env.node_list = req->complete_nodelist;
-		job_env.partition = req->partition;
-		job_env.spank_job_env = req->spank_job_env;
-		job_env.spank_job_env_size = req->spank_job_env_size;
-		job_env.uid = req->uid;
-		job_env.user_name = req->user_name;
-		rc =  _run_prolog(&job_env, req->cred);
-		if (rc) {
-			int term_sig, exit_status;
-			if (WIFSIGNALED(rc)) {
-				exit_status = 0;
-				term_sig    = WTERMSIG(rc);
-			} else {
-				exit_status = WEXITSTATUS(rc);
-				term_sig    = 0;
+		memset(&prolog_arg, 0, sizeof(prolog_arg));
+
+		prolog_arg.job_env.jobid = req->job_id;
+		prolog_arg.job_env.step_id = req->job_step_id;
+		prolog_arg.job_env.node_list = req->complete_nodelist;
+		prolog_arg.job_env.partition = req->partition;
+		prolog_arg.job_env.spank_job_env = req->spank_job_env;
+		prolog_arg.job_env.spank_job_env_size =
+			req->spank_job_env_size;
+		prolog_arg.job_env.uid = req->uid;
+		prolog_arg.job_env.user_name = req->user_name;
+		prolog_arg.cred = req->cred;
+
+		/* Run the prolog while the slurmstepd is forked and
+		 * brings up its I/O connections back to srun. The stepd
+		 * defers spawning tasks until it is told the prolog's
+		 * return code. */
+		slurm_attr_init(&prolog_attr);
+		if (pthread_create(&prolog_tid, &prolog_attr,
+				   _prolog_thread, &prolog_arg)) {
+			error("pthread_create prolog: %m");
+			prolog_arg.rc = _run_prolog(&prolog_arg.job_env,
+						    req->cred);
+		} else
+			prolog_spawned = true;
+		slurm_attr_destroy(&prolog_attr);
+		prolog_pending = true;
+
+		if (!prolog_spawned) {
+			/* thread creation failed, the prolog already ran
+			 * in-line above */
+			if (prolog_arg.rc) {
+				errnum = ESLURMD_PROLOG_FAILED;
+				goto done;
 			}
-			error("[job %u] prolog failed status=%d:%d",
-			      req->job_id, exit_status, term_sig);
-			errnum = ESLURMD_PROLOG_FAILED;
-			goto done;
-		}
-		/* Since the job could have been killed while the prolog was
-		 * running, test if the credential has since been revoked
-		 * and exit as needed. */
-		if (slurm_cred_revoked(conf->vctx, req->cred)) {
-			info("Job %u already killed, do not launch step %u.%u",
-			     req->job_id, req->job_id, req->job_step_id);
-			errnum = ESLURMD_CREDENTIAL_REVOKED;
-			goto done;
+			if (slurm_cred_revoked(conf->vctx, req->cred)) {
+				info("Job %u already killed, do not launch "
+				     "step %u.%u", req->job_id, req->job_id,
+				     req->job_step_id);
+				errnum = ESLURMD_CREDENTIAL_REVOKED;
+				goto done;
+			}
+			prolog_pending = false;
 		}
 	} else {
 		slurm_mutex_unlock(&prolog_mutex);
-		_wait_for_job_running_prolog(req->job_id);
+		/* If the prolog launched at allocation time (e.g.
+		 * PrologFlags=Alloc) is still running, overlap it with
+		 * the stepd launch instead of blocking here. */
+		prolog_pending = (_prolog_is_running(req->job_id) != 0);
 	}
 #endif
 
@@ -1350,8 +1680,49 @@ _rpc_launch_tasks(slurm_msg_t *msg)
 
 	debug3("_rpc_launch_tasks: call to _forkexec_slurmstepd");
 	errnum = _forkexec_slurmstepd(LAUNCH_TASKS, (void *)req, cli, &self,
-				      step_hset, msg->protocol_version);
+				      step_hset, msg->protocol_version,
+#ifndef HAVE_FRONT_END
+				      prolog_pending ? 1 :
+#endif
+				      0);
 	debug3("_rpc_launch_tasks: return from _forkexec_slurmstepd");
+
+#ifndef HAVE_FRONT_END
+	if (prolog_spawned) {
+		int rc;
+
+		pthread_join(prolog_tid, NULL);
+		prolog_spawned = false;
+		rc = prolog_arg.rc;
+		if (rc) {
+			int term_sig, exit_status;
+			if (WIFSIGNALED(rc)) {
+				exit_status = 0;
+				term_sig    = WTERMSIG(rc);
+			} else {
+				exit_status = WEXITSTATUS(rc);
+				term_sig    = 0;
+			}
+			error("[job %u] prolog failed status=%d:%d",
+			      req->job_id, exit_status, term_sig);
+			errnum = ESLURMD_PROLOG_FAILED;
+		} else if (slurm_cred_revoked(conf->vctx, req->cred)) {
+			/* Since the job could have been killed while the
+			 * prolog was running, test if the credential has
+			 * since been revoked and exit as needed. */
+			info("Job %u already killed, do not launch step %u.%u",
+			     req->job_id, req->job_id, req->job_step_id);
+			errnum = ESLURMD_CREDENTIAL_REVOKED;
+		}
+	} else if (prolog_pending)
+		_wait_for_job_running_prolog(req->job_id);
+
+	if (prolog_pending)
+		_notify_stepd_prolog_fini(req->job_id, req->job_step_id,
+					  (errnum == SLURM_SUCCESS) ?
+					  SLURM_SUCCESS :
+					  ESLURMD_PROLOG_FAILED);
+#endif
 	_launch_complete_add(req->job_id);
 
     done:
@@ -1767,7 +2138,7 @@ static void _spawn_prolog_stepd(slurm_msg_t *msg)
 		debug3("%s: call to _forkexec_slurmstepd", __func__);
 		(void) _forkexec_slurmstepd(
 			LAUNCH_TASKS, (void *)launch_req, cli,
-			&self, step_hset, msg->protocol_version);
+			&self, step_hset, msg->protocol_version, 0);
 		debug3("%s: return from _forkexec_slurmstepd", __func__);
 		if (step_hset)
 			hostset_destroy(step_hset);
@@ -1846,6 +2217,15 @@ static void _rpc_prolog(slurm_msg_t *msg)
 		job_env.resv_id = select_g_select_jobinfo_xstrdup(
 			req->select_jobinfo, SELECT_PRINT_RESV_ID);
 #endif
+		/* pre-stage the user's group list at allocation time so
+		 * the subsequent task launch does not pay for the lookup */
+		if (req->user_name) {
+			gids_t *gids;
+			if ((gids = _gids_cache_lookup(req->user_name,
+						       (gid_t) req->gid)))
+				_dealloc_gids(gids);
+		}
+
 		rc = _run_prolog(&job_env, req->cred);
 
 		if (rc) {
@@ -2015,7 +2395,7 @@ _rpc_batch_job(slurm_msg_t *msg, bool new_msg)
 
 	debug3("_rpc_batch_job: call to _forkexec_slurmstepd");
 	rc = _forkexec_slurmstepd(LAUNCH_BATCH_JOB, (void *)req, cli, NULL,
-				  (hostset_t)NULL, SLURM_PROTOCOL_VERSION);
+				  (hostset_t)NULL, SLURM_PROTOCOL_VERSION, 0);
 	debug3("_rpc_batch_job: return from _forkexec_slurmstepd: %d", rc);
 
 	slurm_mutex_unlock(&launch_mutex);
@@ -2145,10 +2525,50 @@ no_job:
 	}
 }
 
+/* Send a REQUEST_COMPLETE_BATCH_SCRIPT for a job which could not be
+ * launched. When message aggregation is configured the message joins the
+ * current window so a launch failure affecting many nodes (e.g. a bad
+ * prolog) does not translate into one RPC per node. */
+static int
+_send_launch_fail_comp_msg(uint32_t job_id, uint32_t slurm_rc)
+{
+	int rc = 0;
+
+	if (conf->msg_aggr_window_msgs > 1) {
+		slurm_msg_t *req_msg = xmalloc_nz(sizeof(slurm_msg_t));
+		complete_batch_script_msg_t *comp_msg =
+			xmalloc(sizeof(complete_batch_script_msg_t));
+
+		comp_msg->job_id = job_id;
+		comp_msg->job_rc = INFINITE;
+		comp_msg->slurm_rc = slurm_rc;
+		comp_msg->node_name = xstrdup(conf->node_name);
+		comp_msg->jobacct = NULL; /* unused */
+		slurm_msg_t_init(req_msg);
+		req_msg->msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
+		req_msg->data = comp_msg;
+
+		msg_aggr_add_msg(req_msg, 1, NULL);
+		return SLURM_SUCCESS;
+	} else {
+		complete_batch_script_msg_t comp_msg;
+		slurm_msg_t resp_msg;
+
+		slurm_msg_t_init(&resp_msg);
+		comp_msg.job_id = job_id;
+		comp_msg.job_rc = INFINITE;
+		comp_msg.slurm_rc = slurm_rc;
+		comp_msg.node_name = conf->node_name;
+		comp_msg.jobacct = NULL; /* unused */
+		resp_msg.msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
+		resp_msg.data = &comp_msg;
+		return slurm_send_recv_controller_rc_msg(&resp_msg, &rc);
+	}
+}
+
 static int
 _launch_job_fail(uint32_t job_id, uint32_t slurm_rc)
 {
-	complete_batch_script_msg_t comp_msg;
 	struct requeue_msg req_msg;
 	slurm_msg_t resp_msg;
 	int rc = 0, rpc_rc;
@@ -2164,41 +2584,25 @@ _launch_job_fail(uint32_t job_id, uint32_t slurm_rc)
 		config_update = conf->last_update;
 	}
 
-	slurm_msg_t_init(&resp_msg);
+	if (slurm_rc == ESLURMD_CREDENTIAL_REVOKED)
+		return _send_launch_fail_comp_msg(job_id, slurm_rc);
 
-	if (slurm_rc == ESLURMD_CREDENTIAL_REVOKED) {
-		comp_msg.job_id = job_id;
-		comp_msg.job_rc = INFINITE;
-		comp_msg.slurm_rc = slurm_rc;
-		comp_msg.node_name = conf->node_name;
-		comp_msg.jobacct = NULL; /* unused */
-		resp_msg.msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
-		resp_msg.data = &comp_msg;
+	slurm_msg_t_init(&resp_msg);
+	req_msg.job_id = job_id;
+	req_msg.job_id_str = NULL;
+	if (requeue_no_hold) {
+		req_msg.state = JOB_PENDING;
 	} else {
-		req_msg.job_id = job_id;
-		req_msg.job_id_str = NULL;
-		if (requeue_no_hold) {
-			req_msg.state = JOB_PENDING;
-		} else {
-			req_msg.state = (JOB_REQUEUE_HOLD|JOB_LAUNCH_FAILED);
-		}
-		resp_msg.msg_type = REQUEST_JOB_REQUEUE;
-		resp_msg.data = &req_msg;
+		req_msg.state = (JOB_REQUEUE_HOLD|JOB_LAUNCH_FAILED);
 	}
+	resp_msg.msg_type = REQUEST_JOB_REQUEUE;
+	resp_msg.data = &req_msg;
 
 	rpc_rc = slurm_send_recv_controller_rc_msg(&resp_msg, &rc);
-	if ((resp_msg.msg_type == REQUEST_JOB_REQUEUE) &&
-	    (rc == ESLURM_DISABLED)) {
+	if (rc == ESLURM_DISABLED) {
 		info("Could not launch job %u and not able to requeue it, "
 		     "cancelling job", job_id);
-		comp_msg.job_id = job_id;
-		comp_msg.job_rc = INFINITE;
-		comp_msg.slurm_rc = slurm_rc;
-		comp_msg.node_name = conf->node_name;
-		comp_msg.jobacct = NULL; /* unused */
-		resp_msg.msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
-		resp_msg.data = &comp_msg;
-		rpc_rc = slurm_send_recv_controller_rc_msg(&resp_msg, &rc);
+		rpc_rc = _send_launch_fail_comp_msg(job_id, slurm_rc);
 	}
 
 	return rpc_rc;
@@ -2212,6 +2616,25 @@ _abort_step(uint32_t job_id, uint32_t step_id)
 	slurm_msg_t_init(&resp_msg);
 	int rc, rc2;
 
+	if (conf->msg_aggr_window_msgs > 1) {
+		slurm_msg_t *req_msg = xmalloc_nz(sizeof(slurm_msg_t));
+		step_complete_msg_t *req =
+			xmalloc(sizeof(step_complete_msg_t));
+
+		req->job_id      = job_id;
+		req->job_step_id = step_id;
+		req->range_first = 0;
+		req->range_last  = 0;
+		req->step_rc     = 1;
+		req->jobacct     = jobacctinfo_create(NULL);
+		slurm_msg_t_init(req_msg);
+		req_msg->msg_type = REQUEST_STEP_COMPLETE;
+		req_msg->data = req;
+
+		msg_aggr_add_msg(req_msg, 1, NULL);
+		return SLURM_SUCCESS;
+	}
+
 	resp.job_id       = job_id;
 	resp.job_step_id  = step_id;
 	resp.range_first  = 0;
@@ -3122,6 +3545,7 @@ _rpc_stat_jobacct(slurm_msg_t *msg)
 	job_step_id_msg_t *req = (job_step_id_msg_t *)msg->data;
 	slurm_msg_t        resp_msg;
 	job_step_stat_t *resp = NULL;
+	stepd_stats_t stats;
 	int fd;
 	uid_t req_uid, uid;
 	uint16_t protocol_version;
@@ -3131,6 +3555,55 @@ _rpc_stat_jobacct(slurm_msg_t *msg)
 	   so only root or SlurmUser is allowed here */
 	req_uid = g_slurm_auth_get_uid(msg->auth_cred, conf->auth_info);
 
+	/* Recent stepds export their statistics through shared memory,
+	 * letting us answer without a round trip into the stepd. */
+	if (stepd_stats_read(conf->spooldir, conf->node_name, req->job_id,
+			     req->step_id, &stats) == SLURM_SUCCESS) {
+		struct jobacctinfo *jobacct;
+
+		if ((req_uid != stats.uid) &&
+		    (!_slurm_authorized_user(req_uid))) {
+			error("stat_jobacct from uid %ld for job %u "
+			      "owned by uid %ld",
+			      (long) req_uid, req->job_id, (long) stats.uid);
+			if (msg->conn_fd >= 0) {
+				slurm_send_rc_msg(msg, ESLURM_USER_ID_MISSING);
+				return ESLURM_USER_ID_MISSING;
+			}
+		}
+
+		resp = xmalloc(sizeof(job_step_stat_t));
+		resp->step_pids = xmalloc(sizeof(job_step_pids_t));
+		resp->step_pids->node_name = xstrdup(conf->node_name);
+		resp->return_code = SLURM_SUCCESS;
+		resp->num_tasks = stats.num_tasks;
+		jobacct = jobacctinfo_create(NULL);
+		memcpy(jobacct, stats.jobacct, sizeof(struct jobacctinfo));
+		/* The embedded step pointers belong to the stepd */
+		jobacct->id.job = NULL;
+		jobacct->max_vsize_id.job = NULL;
+		jobacct->max_rss_id.job = NULL;
+		jobacct->max_pages_id.job = NULL;
+		jobacct->min_cpu_id.job = NULL;
+		jobacct->max_disk_read_id.job = NULL;
+		jobacct->max_disk_write_id.job = NULL;
+		resp->jobacct = jobacct;
+		resp->step_pids->pid_cnt = stats.pid_cnt;
+		if (stats.pid_cnt) {
+			resp->step_pids->pid =
+				xmalloc(sizeof(pid_t) * stats.pid_cnt);
+			memcpy(resp->step_pids->pid, stats.pid,
+			       sizeof(pid_t) * stats.pid_cnt);
+		}
+
+		slurm_msg_t_copy(&resp_msg, msg);
+		resp_msg.msg_type = RESPONSE_JOB_STEP_STAT;
+		resp_msg.data     = resp;
+		slurm_send_node_msg(msg->conn_fd, &resp_msg);
+		slurm_free_job_step_stat(resp);
+		return SLURM_SUCCESS;
+	}
+
 	fd = stepd_connect(conf->spooldir, conf->node_name,
 			   req->job_id, req->step_id, &protocol_version);
 	if (fd == -1) {
@@ -3651,16 +4124,122 @@ static void _file_bcast_cleanup(void)
 	_fb_wrunlock();
 }
 
+static void _free_file_bcast_cache_t(file_bcast_cache_t *cache)
+{
+	xfree(cache->fname);
+	xfree(cache);
+}
+
+static int _bcast_cache_find(void *x, void *key)
+{
+	file_bcast_cache_t *cache = (file_bcast_cache_t *) x;
+
+	return (xstrcmp(cache->fname, (char *) key) == 0);
+}
+
+/* Record the content hash of a file written by sbcast. The oldest entry
+ * is dropped once the cache is full.
+ * Caller must NOT hold file_bcast_cache_mutex */
+static void _bcast_cache_note(char *fname, uid_t uid, uint64_t digest,
+			      struct stat *st)
+{
+	file_bcast_cache_t *cache;
+
+	slurm_mutex_lock(&file_bcast_cache_mutex);
+	cache = list_find_first(file_bcast_cache_list, _bcast_cache_find,
+				fname);
+	if (!cache) {
+		if (list_count(file_bcast_cache_list) >=
+		    FILE_BCAST_CACHE_SIZE) {
+			cache = list_pop(file_bcast_cache_list);
+			_free_file_bcast_cache_t(cache);
+		}
+		cache = xmalloc(sizeof(file_bcast_cache_t));
+		cache->fname = xstrdup(fname);
+		list_append(file_bcast_cache_list, cache);
+	}
+	cache->uid = uid;
+	cache->digest = digest;
+	cache->file_size = st->st_size;
+	cache->mtime = st->st_mtime;
+	slurm_mutex_unlock(&file_bcast_cache_mutex);
+}
+
+/* Hash a file as stored on this node. Only regular files owned by the
+ * requesting user are considered, symlinks are never followed. */
+static int _bcast_hash_file(char *fname, uid_t uid, struct stat *st,
+			    uint64_t *digest)
+{
+	char buf[64 * 1024];
+	uint64_t file_digest;
+	int fd, inx;
+
+	fd = open(fname, O_RDONLY | O_NOFOLLOW);
+	if (fd < 0)
+		return SLURM_ERROR;
+	if (fstat(fd, st) || !S_ISREG(st->st_mode) || (st->st_uid != uid)) {
+		close(fd);
+		return SLURM_ERROR;
+	}
+
+	file_digest = bcast_hash_init();
+	while ((inx = read(fd, buf, sizeof(buf))) > 0)
+		file_digest = bcast_hash_update(file_digest, buf, inx);
+	close(fd);
+	if (inx < 0)
+		return SLURM_ERROR;
+
+	*digest = file_digest;
+	return SLURM_SUCCESS;
+}
+
+/* Test if the destination file already holds the advertised contents.
+ * Cached digests are only trusted while the file's size and mtime are
+ * unchanged, anything else forces a fresh hash of the file. */
+static bool _bcast_file_cached(file_bcast_msg_t *req, uid_t uid)
+{
+	file_bcast_cache_t *cache;
+	struct stat st;
+	uint64_t digest;
+	bool hit;
+
+	if (stat(req->fname, &st) || !S_ISREG(st.st_mode) ||
+	    (st.st_size != req->file_size))
+		return false;
+
+	slurm_mutex_lock(&file_bcast_cache_mutex);
+	cache = list_find_first(file_bcast_cache_list, _bcast_cache_find,
+				req->fname);
+	if (cache && (cache->uid == uid) &&
+	    (cache->file_size == st.st_size) &&
+	    (cache->mtime == st.st_mtime)) {
+		hit = (cache->digest == req->digest);
+		slurm_mutex_unlock(&file_bcast_cache_mutex);
+		return hit;
+	}
+	slurm_mutex_unlock(&file_bcast_cache_mutex);
+
+	/* no valid cache entry, hash the file once and remember it */
+	if (_bcast_hash_file(req->fname, uid, &st, &digest))
+		return false;
+	_bcast_cache_note(req->fname, uid, digest, &st);
+
+	return (digest == req->digest);
+}
+
 void file_bcast_init(void)
 {
 	/* skip locks during slurmd init */
 	file_bcast_list = list_create((ListDelF) _free_file_bcast_info_t);
+	file_bcast_cache_list =
+		list_create((ListDelF) _free_file_bcast_cache_t);
 }
 
 void file_bcast_purge(void)
 {
 	_fb_wrlock();
 	list_destroy(file_bcast_list);
+	FREE_NULL_LIST(file_bcast_cache_list);
 	/* destroying list before exit, no need to unlock */
 }
 
@@ -3700,6 +4279,16 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 		      key.uid, key.job_id, key.fname, req->block_no);
 	}
 
+	/* skip the transfer when a cached copy with identical contents
+	 * is already present on this node */
+	if ((req->block_no == 1) && req->digest &&
+	    _bcast_file_cached(req, key.uid)) {
+		info("sbcast req_uid=%u job_id=%u fname=%s: "
+		     "cached copy matches, transfer skipped",
+		     key.uid, key.job_id, key.fname);
+		return ESLURMD_BCAST_FILE_ALREADY_CACHED;
+	}
+
 	/* first block must register the file and open fd/mmap */
 	if (req->block_no == 1) {
 		if ((rc = _file_bcast_register_file(msg, &key)))
@@ -3724,8 +4313,17 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 
 	offset = 0;
 	while (req->block_len - offset) {
-		inx = write(file_info->fd, &req->block[offset],
-			    (req->block_len - offset));
+		if (msg->protocol_version >= SLURM_16_05_PROTOCOL_VERSION) {
+			/* The sender may keep several blocks in flight,
+			 * so position each write explicitly rather than
+			 * relying upon the arrival order */
+			inx = pwrite(file_info->fd, &req->block[offset],
+				     (req->block_len - offset),
+				     (off_t) (req->block_offset + offset));
+		} else {
+			inx = write(file_info->fd, &req->block[offset],
+				    (req->block_len - offset));
+		}
 		if (inx == -1) {
 			if ((errno == EINTR) || (errno == EAGAIN))
 				continue;
@@ -3760,7 +4358,15 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 	_fb_rdunlock();
 
 	if (req->last_block) {
+		struct stat st;
+
 		_file_bcast_close_file(&key);
+		/* remember the sender's hash of the complete file so the
+		 * next launch of the same contents skips the transfer */
+		if (req->digest && (stat(key.fname, &st) == 0) &&
+		    S_ISREG(st.st_mode))
+			_bcast_cache_note(key.fname, key.uid, req->digest,
+					  &st);
 	}
 	return SLURM_SUCCESS;
 }
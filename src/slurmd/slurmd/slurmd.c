@@ -120,6 +120,10 @@
 
 #define MAX_THREADS		256
 
+/* How long (msec) a persistent connection may sit idle between RPCs
+ * before we give up on it and close the descriptor */
+#define PERSIST_IDLE_TIMEOUT	(60 * 60 * 1000)
+
 #define _free_and_set(__dst, __src) \
 	xfree(__dst); __dst = __src
 
@@ -160,6 +164,9 @@ static sig_atomic_t _shutdown = 0;
 static sig_atomic_t _reconfig = 0;
 static pthread_t msg_pthread = (pthread_t) 0;
 static time_t sent_reg_time = (time_t) 0;
+static uint32_t reg_config_digest = 0;	/* digest of the static config from
+					 * our last full registration which
+					 * the controller accepted */
 
 static void      _atfork_final(void);
 static void      _atfork_prepare(void);
@@ -190,6 +197,8 @@ static void     *_registration_engine(void *arg);
 static void      _resource_spec_fini(void);
 static int       _resource_spec_init(void);
 static int       _restore_cred_state(slurm_cred_ctx_t ctx);
+static bool      _restore_hwprobe_state(void);
+static void      _save_hwprobe_state(void);
 static void      _select_spec_cores(void);
 static void     *_service_connection(void *);
 static void      _set_msg_aggr_params(void);
@@ -584,6 +593,7 @@ _service_connection(void *arg)
 	conn_t *con = (conn_t *) arg;
 	slurm_msg_t *msg = xmalloc(sizeof(slurm_msg_t));
 	int rc = SLURM_SUCCESS;
+	bool persist = false;
 
 	debug3("in the service_connection");
 	slurm_msg_t_init(msg);
@@ -598,8 +608,36 @@ _service_connection(void *arg)
 	}
 	debug2("got this type of message %d", msg->msg_type);
 
-	if (msg->msg_type != MESSAGE_COMPOSITE)
-		slurmd_req(msg);
+	while (1) {
+		if (msg->msg_type == REQUEST_PERSIST_INIT) {
+			/* The peer (e.g. the slurmctld agent) will reuse
+			 * this connection for subsequent RPCs */
+			persist = true;
+			slurm_send_rc_msg(msg, SLURM_SUCCESS);
+		} else if (msg->msg_type == REQUEST_PERSIST_FINI) {
+			slurm_send_rc_msg(msg, SLURM_SUCCESS);
+			break;
+		} else if (msg->msg_type != MESSAGE_COMPOSITE)
+			slurmd_req(msg);
+
+		/* Some RPC handlers hand the descriptor off to another
+		 * thread and clear conn_fd, in which case the connection
+		 * is no longer ours to service */
+		if (!persist || (msg->conn_fd < 0))
+			break;
+
+		slurm_free_msg(msg);
+		msg = xmalloc(sizeof(slurm_msg_t));
+		slurm_msg_t_init(msg);
+		if (slurm_receive_msg_and_forward(con->fd, con->cli_addr, msg,
+						  PERSIST_IDLE_TIMEOUT)
+		    != SLURM_SUCCESS) {
+			/* Peer closed the channel or left it idle too long */
+			debug2("persistent connection %d closed", con->fd);
+			break;
+		}
+		debug2("got this type of message %d", msg->msg_type);
+	}
 
 cleanup:
 	if ((msg->conn_fd >= 0) && slurm_close(msg->conn_fd) < 0)
@@ -640,7 +678,15 @@ send_registration_msg(uint32_t status, bool startup)
 		if (slurm_send_recv_controller_rc_msg(&req, &rc) < 0) {
 			error("Unable to register: %m");
 			ret_val = SLURM_FAILURE;
-		}
+		} else if (rc == ESLURM_NODE_REG_DIGEST_MISMATCH) {
+			/* The controller has no (or a stale) record of our
+			 * static configuration, send the full version */
+			debug("Controller requested a full node registration");
+			reg_config_digest = 0;
+			slurm_free_node_registration_status_msg(msg);
+			return send_registration_msg(status, startup);
+		} else if (!msg->delta && (rc == SLURM_SUCCESS))
+			reg_config_digest = msg->config_digest;
 		slurm_free_node_registration_status_msg(msg);
 	}
 
@@ -650,6 +696,52 @@ send_registration_msg(uint32_t status, bool startup)
 	return ret_val;
 }
 
+/* FNV-1a, used to detect changes in the static node configuration */
+static uint32_t _digest_data(uint32_t digest, const void *data, int len)
+{
+	const unsigned char *p = data;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		digest ^= p[i];
+		digest *= 16777619;
+	}
+	return digest;
+}
+
+static uint32_t _digest_str(uint32_t digest, const char *str)
+{
+	if (str)
+		digest = _digest_data(digest, str, strlen(str) + 1);
+	return digest;
+}
+
+/* Digest of the static portion of a registration message, letting the
+ * controller detect configuration changes without the full payload */
+static uint32_t _config_digest(slurm_node_registration_status_msg_t *msg)
+{
+	uint32_t digest = 2166136261U;
+
+	digest = _digest_data(digest, &msg->cpus, sizeof(msg->cpus));
+	digest = _digest_data(digest, &msg->boards, sizeof(msg->boards));
+	digest = _digest_data(digest, &msg->sockets, sizeof(msg->sockets));
+	digest = _digest_data(digest, &msg->cores, sizeof(msg->cores));
+	digest = _digest_data(digest, &msg->threads, sizeof(msg->threads));
+	digest = _digest_data(digest, &msg->real_memory,
+			      sizeof(msg->real_memory));
+	digest = _digest_data(digest, &msg->tmp_disk, sizeof(msg->tmp_disk));
+	digest = _digest_str(digest, msg->cpu_spec_list);
+	digest = _digest_str(digest, msg->arch);
+	digest = _digest_str(digest, msg->os);
+	digest = _digest_str(digest, msg->features_avail);
+	digest = _digest_str(digest, msg->features_active);
+	if (msg->gres_info)
+		digest = _digest_data(digest, get_buf_data(msg->gres_info),
+				      get_buf_offset(msg->gres_info));
+
+	return digest;
+}
+
 static void
 _fill_registration_msg(slurm_node_registration_status_msg_t *msg)
 {
@@ -776,6 +868,30 @@ _fill_registration_msg(slurm_node_registration_status_msg_t *msg)
 		msg->energy = acct_gather_energy_alloc(1);
 	acct_gather_energy_g_get_data(ENERGY_DATA_NODE_ENERGY, msg->energy);
 
+	msg->config_digest = _config_digest(msg);
+#ifndef HAVE_FRONT_END
+	/* When the static configuration matches the last full registration
+	 * accepted by the controller, strip it from the message and send
+	 * only the digest plus dynamic state.  The controller requests a
+	 * full registration with ESLURM_NODE_REG_DIGEST_MISMATCH when its
+	 * record of this node is missing or stale.  That response can not
+	 * be seen with message aggregation, so deltas are only used on the
+	 * direct path. */
+	if (!msg->startup && (conf->msg_aggr_window_msgs <= 1) &&
+	    reg_config_digest && (msg->config_digest == reg_config_digest)) {
+		msg->delta = 1;
+		xfree(msg->arch);
+		xfree(msg->os);
+		xfree(msg->cpu_spec_list);
+		xfree(msg->features_avail);
+		xfree(msg->features_active);
+		if (msg->gres_info) {
+			free_buf(msg->gres_info);
+			msg->gres_info = NULL;
+		}
+	}
+#endif
+
 	msg->timestamp = time(NULL);
 
 	return;
@@ -806,6 +922,7 @@ _read_config(void)
 	char *path_pubkey = NULL;
 	slurm_ctl_conf_t *cf = NULL;
 	int cc;
+	bool hwprobe_cached = false;
 
 #ifndef HAVE_FRONT_END
 	bool cr_flag = false, gang_flag = false;
@@ -883,13 +1000,16 @@ _read_config(void)
 	_update_logging();
 	_update_nice();
 
-	get_cpuinfo(&conf->actual_cpus,
-		    &conf->actual_boards,
-	            &conf->actual_sockets,
-	            &conf->actual_cores,
-	            &conf->actual_threads,
-	            &conf->block_map_size,
-	            &conf->block_map, &conf->block_map_inv);
+	hwprobe_cached = _restore_hwprobe_state();
+	if (!hwprobe_cached) {
+		get_cpuinfo(&conf->actual_cpus,
+			    &conf->actual_boards,
+			    &conf->actual_sockets,
+			    &conf->actual_cores,
+			    &conf->actual_threads,
+			    &conf->block_map_size,
+			    &conf->block_map, &conf->block_map_inv);
+	}
 #ifdef HAVE_FRONT_END
 	/*
 	 * When running with multiple frontends, the slurmd S:C:T values are not
@@ -1039,6 +1159,9 @@ _read_config(void)
 
 	slurm_mutex_unlock(&conf->config_mutex);
 	slurm_conf_unlock();
+
+	if (!hwprobe_cached)
+		_save_hwprobe_state();
 }
 
 static void
@@ -1468,12 +1591,30 @@ _stepd_cleanup_batch_dirs(const char *directory, const char *nodename)
 	closedir(dp);
 }
 
+static int      _gres_init_rc = SLURM_SUCCESS;
+static uint32_t _gres_init_cpu_cnt = 0;
+
+/* Load the GRES plugins and enumerate this node's generic resources.
+ * Run in a separate thread since device (e.g. GPU) enumeration can take
+ * seconds and is independent of the other plugin initializations. */
+static void *
+_gres_init_thread(void *arg)
+{
+	if ((gres_plugin_init() != SLURM_SUCCESS) ||
+	    (gres_plugin_node_config_load(_gres_init_cpu_cnt, conf->node_name,
+					  NULL) != SLURM_SUCCESS))
+		_gres_init_rc = SLURM_FAILURE;
+	return NULL;
+}
+
 static int
 _slurmd_init(void)
 {
 	struct rlimit rlim;
 	struct stat stat_buf;
 	uint32_t cpu_cnt;
+	pthread_attr_t attr;
+	pthread_t gres_tid = 0;
 
 	/*
 	 * Process commandline arguments first, since one option may be
@@ -1504,12 +1645,26 @@ _slurmd_init(void)
 
 	cpu_cnt = MAX(conf->conf_cpus, conf->block_map_size);
 
-	if ((gres_plugin_init() != SLURM_SUCCESS) ||
-	    (gres_plugin_node_config_load(cpu_cnt, conf->node_name, NULL)
-	     != SLURM_SUCCESS))
-		return SLURM_FAILURE;
-	if (slurm_topo_init() != SLURM_SUCCESS)
+	/*
+	 * GRES device enumeration can take several seconds per node, so
+	 * run it concurrently with the topology build and the plugin
+	 * initializations below. The thread is joined before anything
+	 * uses the GRES configuration (registration happens later).
+	 */
+	_gres_init_cpu_cnt = cpu_cnt;
+	slurm_attr_init(&attr);
+	if (pthread_create(&gres_tid, &attr, _gres_init_thread, NULL)) {
+		error("Unable to create GRES init thread: %m");
+		gres_tid = 0;
+		_gres_init_thread(NULL);	/* run serially */
+	}
+	slurm_attr_destroy(&attr);
+
+	if (slurm_topo_init() != SLURM_SUCCESS) {
+		if (gres_tid)
+			pthread_join(gres_tid, NULL);
 		return SLURM_FAILURE;
+	}
 
 	/*
 	 * Get and set slurmd topology information
@@ -1533,6 +1688,12 @@ _slurmd_init(void)
 
 	_print_conf();
 
+	/* The GRES configuration is needed from here on */
+	if (gres_tid)
+		pthread_join(gres_tid, NULL);
+	if (_gres_init_rc != SLURM_SUCCESS)
+		return SLURM_FAILURE;
+
 	if (slurm_proctrack_init() != SLURM_SUCCESS)
 		return SLURM_FAILURE;
 	if (slurmd_task_init() != SLURM_SUCCESS)
@@ -1789,6 +1950,183 @@ cleanup:
 	return error_code;
 }
 
+#define HWPROBE_STATE_VERSION	0x0001
+#define HWPROBE_BOOT_FUZZ	2	/* boot time slack in seconds */
+
+/* Return the time at which the system booted, or zero if unknown */
+static time_t _hwprobe_boot_time(void)
+{
+	uint32_t up_time = 0;
+
+	if (get_up_time(&up_time) || (up_time == 0))
+		return (time_t) 0;
+	return time(NULL) - (time_t) up_time;
+}
+
+/* Build a string identifying the hardware and kernel on which the
+ * probe results were collected, used to validate the cached state */
+static char *_hwprobe_signature(void)
+{
+	struct utsname name;
+	uint32_t real_memory = 1;
+	char *sig = NULL;
+
+	if (uname(&name) < 0)
+		return NULL;
+	(void) get_memory(&real_memory);
+	xstrfmtcat(sig, "%s %s %s %u",
+		   name.nodename, name.release, name.machine, real_memory);
+	return sig;
+}
+
+/*
+ * Restore the hardware configuration probed by a previous slurmd from
+ * SlurmdSpoolDir. The cached state is only used if the node has not
+ * rebooted since it was written and its hardware signature still
+ * matches, so a restarting slurmd can skip topology rediscovery and
+ * register with slurmctld immediately.
+ * RET true if the cached configuration was restored
+ */
+static bool
+_restore_hwprobe_state(void)
+{
+	char *file_name = NULL, *data = NULL;
+	char *sig = NULL, *sig_now = NULL;
+	uint32_t data_size = 0, size;
+	uint16_t version = 0;
+	time_t boot_time = (time_t) 0, now_boot;
+	int state_fd, data_allocated, data_read = 0, i;
+	bool restored = false;
+	Buf buffer = NULL;
+
+	if (conf->cleanstart || conf->boot_time)
+		return false;
+	if ((now_boot = _hwprobe_boot_time()) == (time_t) 0)
+		return false;
+
+	file_name = xstrdup(conf->spooldir);
+	xstrcat(file_name, "/hwprobe_state");
+	state_fd = open(file_name, O_RDONLY);
+	if (state_fd < 0)
+		goto cleanup;
+
+	data_allocated = 1024;
+	data = xmalloc(sizeof(char)*data_allocated);
+	while ((data_read = read(state_fd, &data[data_size], 1024)) == 1024) {
+		data_size += data_read;
+		data_allocated += 1024;
+		xrealloc(data, data_allocated);
+	}
+	data_size += data_read;
+	close(state_fd);
+	buffer = create_buf(data, data_size);
+
+	safe_unpack16(&version, buffer);
+	if (version != HWPROBE_STATE_VERSION) {
+		debug("Hardware probe state version mismatch, ignoring");
+		goto cleanup;
+	}
+	safe_unpack_time(&boot_time, buffer);
+	if ((boot_time > (now_boot + HWPROBE_BOOT_FUZZ)) ||
+	    (boot_time < (now_boot - HWPROBE_BOOT_FUZZ))) {
+		debug("Node rebooted, ignoring hardware probe state");
+		goto cleanup;
+	}
+	safe_unpackstr_xmalloc(&sig, &size, buffer);
+	sig_now = _hwprobe_signature();
+	if (!sig_now || xstrcmp(sig, sig_now)) {
+		debug("Hardware signature changed, ignoring probe state");
+		goto cleanup;
+	}
+
+	safe_unpack16(&conf->actual_cpus,    buffer);
+	safe_unpack16(&conf->actual_boards,  buffer);
+	safe_unpack16(&conf->actual_sockets, buffer);
+	safe_unpack16(&conf->actual_cores,   buffer);
+	safe_unpack16(&conf->actual_threads, buffer);
+	safe_unpack16(&conf->block_map_size, buffer);
+	if (conf->block_map_size) {
+		conf->block_map = xmalloc(conf->block_map_size *
+					  sizeof(uint16_t));
+		conf->block_map_inv = xmalloc(conf->block_map_size *
+					      sizeof(uint16_t));
+		for (i = 0; i < conf->block_map_size; i++)
+			safe_unpack16(&conf->block_map[i], buffer);
+		for (i = 0; i < conf->block_map_size; i++)
+			safe_unpack16(&conf->block_map_inv[i], buffer);
+	}
+	debug("Restored hardware configuration from %s", file_name);
+	restored = true;
+	goto cleanup;
+
+unpack_error:
+	debug("Incomplete hardware probe state file %s, ignoring", file_name);
+cleanup:
+	if (!restored) {
+		/* Discard any partially restored block maps */
+		xfree(conf->block_map);
+		xfree(conf->block_map_inv);
+	}
+	xfree(sig);
+	xfree(sig_now);
+	xfree(file_name);
+	if (buffer)
+		free_buf(buffer);
+	return restored;
+}
+
+/* Save the hardware configuration probed by get_cpuinfo() to
+ * SlurmdSpoolDir for reuse by the next slurmd restart */
+static void
+_save_hwprobe_state(void)
+{
+	char *file_name = NULL, *sig = NULL;
+	time_t boot_time;
+	int state_fd, i, rc;
+	Buf buffer = NULL;
+
+	if (conf->boot_time)	/* simulated reboot, uptime is fudged */
+		return;
+	if ((boot_time = _hwprobe_boot_time()) == (time_t) 0)
+		return;
+	if (!(sig = _hwprobe_signature()))
+		return;
+
+	buffer = init_buf(1024);
+	pack16(HWPROBE_STATE_VERSION, buffer);
+	pack_time(boot_time, buffer);
+	packstr(sig, buffer);
+	pack16(conf->actual_cpus,    buffer);
+	pack16(conf->actual_boards,  buffer);
+	pack16(conf->actual_sockets, buffer);
+	pack16(conf->actual_cores,   buffer);
+	pack16(conf->actual_threads, buffer);
+	pack16(conf->block_map_size, buffer);
+	for (i = 0; i < conf->block_map_size; i++)
+		pack16(conf->block_map[i], buffer);
+	for (i = 0; i < conf->block_map_size; i++)
+		pack16(conf->block_map_inv[i], buffer);
+
+	file_name = xstrdup(conf->spooldir);
+	xstrcat(file_name, "/hwprobe_state");
+	(void) unlink(file_name);
+	if ((state_fd = creat(file_name, 0600)) < 0) {
+		debug("creat(%s): %m", file_name);
+		goto cleanup;
+	}
+	rc = write(state_fd, get_buf_data(buffer), get_buf_offset(buffer));
+	if (rc != get_buf_offset(buffer)) {
+		error("write %s error %m", file_name);
+		(void) unlink(file_name);
+	}
+	close(state_fd);
+
+cleanup:
+	xfree(file_name);
+	xfree(sig);
+	free_buf(buffer);
+}
+
 static int _drain_node(char *reason)
 {
 	slurm_msg_t req_msg;
@@ -60,16 +60,36 @@ static void _batch_path_check(char **p, char **q, char **name,
 static char * _create_batch_fname(char *name, char *path,
 				  stepd_step_rec_t *job, int taskid);
 static char * _create_step_fname(char *name, char *path, stepd_step_rec_t *job,
-				 int taskid);
+				 int taskid, fname_template_t *tmpl);
 static void _step_path_check(char **p, char **q, char **name, unsigned int wid,
 			     bool double_p, stepd_step_rec_t *job, int taskid,
-			     int offset);
+			     int offset, fname_template_t *tmpl);
+static void _tmpl_add_seg(fname_template_t *tmpl, char **name, bool task_field,
+			  unsigned int wid);
 
 /*
  * Max zero-padding width
  */
 #define MAX_WIDTH 10
 
+/* One piece of a precompiled filename format: job-constant text built
+ * at compile time, optionally followed by the zero padded task id,
+ * which is the only field that differs between the tasks of a step. */
+struct fname_seg {
+	struct fname_seg *next;
+	char *literal;
+	bool task_field;
+	unsigned int wid;
+};
+
+struct fname_template {
+	char *format;		/* original format, for fallback renders */
+	int single_id;		/* >= 0 if format is a plain task number */
+	char *constant;		/* whole name, when no task field exists */
+	struct fname_seg *segs;	/* compiled segment chain */
+	struct fname_seg *tail;
+};
+
 /* Create an IO filename from job parameters and the filename format
  * sent from client
  */
@@ -107,13 +127,158 @@ fname_create(stepd_step_rec_t *job, const char *format, int taskid)
 	if (job->batch)
 		name = _create_batch_fname(name, orig, job, taskid);
 	else
-		name = _create_step_fname(name, orig, job, taskid);
+		name = _create_step_fname(name, orig, job, taskid, NULL);
 
 fini:
 	xfree(orig);
 	return name;
 }
 
+/* Append a compiled segment to a template, taking ownership of the
+ * literal text accumulated so far */
+static void _tmpl_add_seg(fname_template_t *tmpl, char **name, bool task_field,
+			  unsigned int wid)
+{
+	struct fname_seg *seg;
+
+	seg = xmalloc(sizeof(struct fname_seg));
+	seg->literal = *name;	/* may be NULL */
+	seg->task_field = task_field;
+	seg->wid = wid;
+	*name = NULL;
+
+	if (tmpl->tail)
+		tmpl->tail->next = seg;
+	else
+		tmpl->segs = seg;
+	tmpl->tail = seg;
+}
+
+/* Compile an IO filename format once per step, so the format string
+ * need not be re-scanned for every task.  All fields other than the
+ * task id are constant for the life of the job and are expanded here;
+ * fname_template_render() only concatenates the pieces.
+ *
+ * Returns NULL if format is NULL.
+ */
+fname_template_t *
+fname_template_create(stepd_step_rec_t *job, const char *format)
+{
+	fname_template_t *tmpl;
+	char *name = NULL;
+	char *orig;
+	char *esc;
+
+	if (format == NULL)
+		return NULL;
+
+	tmpl = xmalloc(sizeof(struct fname_template));
+	tmpl->format = xstrdup(format);
+	tmpl->single_id = fname_single_task_io(format);
+	if (tmpl->single_id >= 0) {
+		/* render decides between /dev/null and a real name */
+		return tmpl;
+	}
+
+	orig = xstrdup(format);
+	esc = is_path_escaped(orig);
+
+	/* If format doesn't specify an absolute pathname, use cwd */
+	if (orig[0] != '/') {
+		xstrcat(name, job->cwd);
+		if (esc) {
+			xstrcat(name, esc);
+			xfree(esc);
+			tmpl->constant = name;
+			xfree(orig);
+			return tmpl;
+		}
+		if (name[strlen(name)-1] != '/')
+			xstrcatchar(name, '/');
+	}
+
+	if (esc) {
+		/* escaped format, taken verbatim */
+		xfree(name);
+		tmpl->constant = esc;
+		xfree(orig);
+		return tmpl;
+	}
+
+	if (job->batch) {
+		/* batch steps launch a single task, nothing to gain;
+		 * render falls back to fname_create() */
+		xfree(name);
+		xfree(orig);
+		return tmpl;
+	}
+
+	name = _create_step_fname(name, orig, job, 0, tmpl);
+	if (tmpl->segs)
+		_tmpl_add_seg(tmpl, &name, false, 0);	/* trailing text */
+	else
+		tmpl->constant = name;
+	xfree(orig);
+
+	return tmpl;
+}
+
+/* Build one task's IO filename from a precompiled template */
+char *
+fname_template_render(fname_template_t *tmpl, stepd_step_rec_t *job,
+		      int taskid)
+{
+	struct fname_seg *seg;
+	char *name = NULL;
+
+	if (tmpl->single_id >= 0) {
+		if (taskid != tmpl->single_id)
+			return xstrdup("/dev/null");
+		return fname_create(job, tmpl->format, taskid);
+	}
+	if (tmpl->constant)
+		return xstrdup(tmpl->constant);
+	if (tmpl->segs == NULL) {
+		/* not compiled (batch step), re-scan the format */
+		return fname_create(job, tmpl->format, taskid);
+	}
+
+	for (seg = tmpl->segs; seg; seg = seg->next) {
+		if (seg->literal)
+			xstrcat(name, seg->literal);
+		if (seg->task_field)
+			xstrfmtcat(name, "%0*u", seg->wid, taskid);
+	}
+
+	return name;
+}
+
+/* Return the task id if the template is "single task only" IO,
+ * otherwise -1 */
+int
+fname_template_single_task_io(fname_template_t *tmpl)
+{
+	return tmpl->single_id;
+}
+
+void
+fname_template_destroy(fname_template_t *tmpl)
+{
+	struct fname_seg *seg, *next;
+
+	if (tmpl == NULL)
+		return;
+
+	for (seg = tmpl->segs; seg; seg = next) {
+		next = seg->next;
+		xfree(seg->literal);
+		xfree(seg);
+	}
+	xfree(tmpl->format);
+	xfree(tmpl->constant);
+	xfree(tmpl);
+}
+
 static char *_create_batch_fname(char *name, char *path, stepd_step_rec_t *job,
 				 int taskid)
 {
@@ -155,7 +320,7 @@ static char *_create_batch_fname(char *name, char *path, stepd_step_rec_t *job,
 }
 
 static char *_create_step_fname (char *name, char *path, stepd_step_rec_t *job,
-				 int taskid)
+				 int taskid, fname_template_t *tmpl)
 {
 
 	unsigned int wid   = 0;
@@ -185,7 +350,7 @@ static char *_create_step_fname (char *name, char *path, stepd_step_rec_t *job,
 
 			}
 			_step_path_check(&p, &q, &name, wid, double_p,
-					 job, taskid, str_offset);
+					 job, taskid, str_offset, tmpl);
 			wid = 0;
 		} else
 			p++;
@@ -206,7 +371,7 @@ static char *_create_step_fname (char *name, char *path, stepd_step_rec_t *job,
  */
 static void _step_path_check(char **p, char **q, char **name, unsigned int wid,
 			     bool double_p, stepd_step_rec_t *job, int taskid,
-			     int offset)
+			     int offset, fname_template_t *tmpl)
 {
 	switch (**p) {
 	case '%': /* This is in case there is a 3rd %, ie. %%% */
@@ -216,7 +381,10 @@ static void _step_path_check(char **p, char **q, char **name, unsigned int wid,
 	case 't':  /* '%t' => taskid         */
 		xmemcat(*name, *q, *p - offset);
 		if (!double_p) {
-			xstrfmtcat(*name, "%0*u", wid, taskid);
+			if (tmpl)
+				_tmpl_add_seg(tmpl, name, true, wid);
+			else
+				xstrfmtcat(*name, "%0*u", wid, taskid);
 			(*p)++;
 		}
 		*q = (*p)++;
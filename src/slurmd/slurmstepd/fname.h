@@ -42,9 +42,21 @@
 
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
 
+/* A filename format compiled once per step.  All job-constant fields
+ * are expanded at compile time; only the task id is substituted when a
+ * task's name is rendered. */
+typedef struct fname_template fname_template_t;
+
 char *fname_create(stepd_step_rec_t *job, const char *fmt, int taskid);
 int   fname_trunc_all(stepd_step_rec_t *job, const char *fmt);
 int   fname_single_task_io (const char *fmt);
 extern char *is_path_escaped(char *);
 
+fname_template_t *fname_template_create(stepd_step_rec_t *job,
+					const char *fmt);
+char *fname_template_render(fname_template_t *tmpl, stepd_step_rec_t *job,
+			    int taskid);
+int   fname_template_single_task_io(fname_template_t *tmpl);
+void  fname_template_destroy(fname_template_t *tmpl);
+
 #endif /* !_SLURMD_FNAME_H */
@@ -112,6 +112,12 @@ struct client_io_info {
 	int32_t out_remaining;
 	bool out_eof;
 
+	/* Credit-based flow control, granted by SLURM_IO_CREDIT messages
+	 * from the client.  Until the first grant arrives the stream is
+	 * uncontrolled and relies on TCP backpressure alone. */
+	bool credit_flow;
+	uint64_t send_credit;	/* payload bytes we may still send */
+
 	/* For clients that only write stdout or stderr, and/or only
 	   write for one task. -1 means accept output from any task. */
 	int  ltaskid_stdout, ltaskid_stderr;
@@ -205,6 +211,9 @@ static struct io_buf *_task_build_message(struct task_read_info *out,
 					  stepd_step_rec_t *job, cbuf_t cbuf);
 static void *_io_thr(void *arg);
 static void _route_msg_task_to_client(eio_obj_t *obj);
+static void _enqueue_msg_to_clients(struct task_read_info *out,
+				    struct io_buf *msg);
+static int  _task_read_direct(eio_obj_t *obj);
 static void _free_outgoing_msg(struct io_buf *msg, stepd_step_rec_t *job);
 static void _free_incoming_msg(struct io_buf *msg, stepd_step_rec_t *job);
 static void _free_all_outgoing_msgs(List msg_queue, stepd_step_rec_t *job);
@@ -287,6 +296,20 @@ _client_writable(eio_obj_t *obj)
 		debug5("  client->out.msg_queue queue length = %d",
 		       list_count(client->msg_queue));
 
+	/* A flow controlled stream that is out of send credit must hold
+	 * its data until the client drains what is already in flight
+	 * and grants more.  The backlog then fills the free buffer pool
+	 * and the task cbufs, and reading from the task pipes pauses
+	 * before anything overflows. */
+	if (client->credit_flow && (client->out_msg == NULL)) {
+		struct io_buf *msg = list_peek(client->msg_queue);
+		if (msg && ((uint64_t)(msg->length - io_hdr_packed_size()) >
+			    client->send_credit)) {
+			debug5("  false, out of send credit");
+			return false;
+		}
+	}
+
 	if (client->out_msg != NULL
 	    || !list_is_empty(client->msg_queue))
 		return true;
@@ -325,7 +348,8 @@ _client_read(eio_obj_t *obj, List objs)
 			return SLURM_SUCCESS;
 		}
 		debug5("client->header.length = %u", client->header.length);
-		if (client->header.length > MAX_MSG_LEN)
+		if ((client->header.type != SLURM_IO_CREDIT) &&
+		    (client->header.length > MAX_MSG_LEN))
 			error("Message length of %u exceeds maximum of %u",
 			      client->header.length, MAX_MSG_LEN);
 		client->in_remaining = client->header.length;
@@ -335,7 +359,18 @@ _client_read(eio_obj_t *obj, List objs)
 	/*
 	 * Read the body
 	 */
-	if (client->header.type == SLURM_IO_CONNECTION_TEST) {
+	if (client->header.type == SLURM_IO_CREDIT) {
+		/* Flow control grant, no message body follows.  The
+		 * length field carries the number of payload bytes the
+		 * client is prepared to accept. */
+		debug5("  got credit grant of %u bytes",
+		       client->header.length);
+		client->credit_flow = true;
+		client->send_credit += client->header.length;
+		list_enqueue(client->job->free_incoming, client->in_msg);
+		client->in_msg = NULL;
+		return SLURM_SUCCESS;
+	} else if (client->header.type == SLURM_IO_CONNECTION_TEST) {
 		if (client->header.length != 0) {
 			debug5("  error in _client_read: bad connection test");
 			list_enqueue(client->job->free_incoming, client->in_msg);
@@ -453,6 +488,14 @@ _client_write(eio_obj_t *obj, List objs)
 		debug5("  dequeue successful, client->out_msg->length = %d",
 			client->out_msg->length);
 		client->out_remaining = client->out_msg->length;
+		if (client->credit_flow) {
+			uint64_t payload = client->out_msg->length -
+				io_hdr_packed_size();
+			if (payload <= client->send_credit)
+				client->send_credit -= payload;
+			else
+				client->send_credit = 0;
+		}
 	}
 
 	debug5("  client->out_remaining = %d", client->out_remaining);
@@ -747,6 +790,73 @@ _task_readable(eio_obj_t *obj)
 	return false;
 }
 
+/*
+ * Read output directly from a task into a free outgoing message,
+ * skipping the intermediate cbuf copy. Only usable when line buffering
+ * is not requested and the task's cbuf has been drained, so message
+ * contents and ordering match the cbuf path exactly.
+ * Returns SLURM_ERROR when no outgoing message is free, in which case
+ * the caller falls back to the cbuf path for flow control.
+ */
+static int
+_task_read_direct(eio_obj_t *obj)
+{
+	struct task_read_info *out = (struct task_read_info *)obj->arg;
+	struct io_buf *msg;
+	struct slurm_io_header header;
+	Buf packbuf;
+	char *ptr;
+	int n;
+
+	if (!_outgoing_buf_free(out->job))
+		return SLURM_ERROR;
+	msg = list_dequeue(out->job->free_outgoing);
+
+	ptr = msg->data + io_hdr_packed_size();
+again:
+	if ((n = read(obj->fd, ptr, MAX_MSG_LEN)) < 0) {
+		if (errno == EINTR)
+			goto again;
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			list_enqueue(out->job->free_outgoing, msg);
+			debug5("_task_read_direct returned EAGAIN");
+			return SLURM_SUCCESS;
+		}
+		debug5("  error in _task_read_direct: %m");
+	}
+	if (n <= 0) {  /* got eof */
+		debug5("  got eof on task");
+		out->eof = true;
+		list_enqueue(out->job->free_outgoing, msg);
+		return SLURM_SUCCESS;
+	}
+
+	debug5("************************ %d bytes read directly from task %s",
+	       n, out->type == SLURM_IO_STDOUT ? "STDOUT" : "STDERR");
+
+	header.type = out->type;
+	header.ltaskid = out->ltaskid;
+	header.gtaskid = out->gtaskid;
+	header.length = n;
+
+	packbuf = create_buf(msg->data, io_hdr_packed_size());
+	if (!packbuf) {
+		fatal("Failure to allocate memory for a message header");
+		return SLURM_SUCCESS;	/* Fix for CLANG false positive error */
+	}
+	io_hdr_pack(&header, packbuf);
+	msg->length = io_hdr_packed_size() + header.length;
+	msg->ref_count = 0; /* make certain it is initialized */
+
+	/* free the Buf packbuf, but not the memory to which it points */
+	packbuf->head = NULL;	/* CLANG false positive bug here */
+	free_buf(packbuf);
+
+	_enqueue_msg_to_clients(out, msg);
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Read output (stdout or stderr) from a task into a cbuf.  The cbuf
  * allows whole lines to be packed into messages if line buffering
@@ -764,20 +874,28 @@ _task_read(eio_obj_t *obj, List objs)
 	debug4("Entering _task_read for obj %zx", (size_t)obj);
 	len = cbuf_free(out->buf);
 	if (len > 0 && !out->eof) {
+		/* Without line buffering the data needs no scanning for
+		 * line boundaries, so once the cbuf is drained we can read
+		 * from the task straight into an outgoing message. */
+		if (out->job->buffered_stdio ||
+		    (cbuf_used(out->buf) > 0) ||
+		    (_task_read_direct(obj) != SLURM_SUCCESS)) {
 again:
-		if ((rc = cbuf_write_from_fd(out->buf, obj->fd, len, NULL))
-		    < 0) {
-			if (errno == EINTR)
-				goto again;
-			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-				debug5("_task_read returned EAGAIN");
-				return SLURM_SUCCESS;
+			if ((rc = cbuf_write_from_fd(out->buf, obj->fd, len,
+						     NULL)) < 0) {
+				if (errno == EINTR)
+					goto again;
+				if ((errno == EAGAIN) ||
+				    (errno == EWOULDBLOCK)) {
+					debug5("_task_read returned EAGAIN");
+					return SLURM_SUCCESS;
+				}
+				debug5("  error in _task_read: %m");
+			}
+			if (rc <= 0) {  /* got eof */
+				debug5("  got eof on task");
+				out->eof = true;
 			}
-			debug5("  error in _task_read: %m");
-		}
-		if (rc <= 0) {  /* got eof */
-			debug5("  got eof on task");
-			out->eof = true;
 		}
 	}
 
@@ -1295,15 +1413,54 @@ _build_connection_okay_message(stepd_step_rec_t *job)
 
 
 
+/* Add an outgoing message to the msg_queue of all clients taking this
+ * task's stream, and to the outgoing message cache. */
 static void
-_route_msg_task_to_client(eio_obj_t *obj)
+_enqueue_msg_to_clients(struct task_read_info *out, struct io_buf *msg)
 {
-	struct task_read_info *out = (struct task_read_info *)obj->arg;
 	struct client_io_info *client;
-	struct io_buf *msg = NULL;
 	eio_obj_t *eio;
 	ListIterator clients;
 
+	/* Add message to the msg_queue of all clients */
+	clients = list_iterator_create(out->job->clients);
+	while ((eio = list_next(clients))) {
+		client = (struct client_io_info *)eio->arg;
+		if (client->out_eof == true)
+			continue;
+
+		/* Some clients only take certain I/O streams */
+		if (out->type==SLURM_IO_STDOUT) {
+			if (client->ltaskid_stdout != -1 &&
+			    client->ltaskid_stdout != out->ltaskid)
+				continue;
+		}
+		if (out->type==SLURM_IO_STDERR) {
+			if (client->ltaskid_stderr != -1 &&
+			    client->ltaskid_stderr != out->ltaskid)
+				continue;
+		}
+
+		debug5("======================== Enqueued message");
+		xassert(client->magic == CLIENT_IO_MAGIC);
+		if (list_enqueue(client->msg_queue, msg))
+			msg->ref_count++;
+	}
+	list_iterator_destroy(clients);
+
+	/* Update the outgoing message cache */
+	if (list_enqueue(out->job->outgoing_cache, msg)) {
+		msg->ref_count++;
+		_shrink_msg_cache(out->job->outgoing_cache, out->job);
+	}
+}
+
+static void
+_route_msg_task_to_client(eio_obj_t *obj)
+{
+	struct task_read_info *out = (struct task_read_info *)obj->arg;
+	struct io_buf *msg = NULL;
+
 	/* Pack task output into messages for transfer to a client */
 	while (cbuf_used(out->buf) > 0
 	       && _outgoing_buf_free(out->job)) {
@@ -1312,37 +1469,7 @@ _route_msg_task_to_client(eio_obj_t *obj)
 		if (msg == NULL)
 			return;
 
-		/* Add message to the msg_queue of all clients */
-		clients = list_iterator_create(out->job->clients);
-		while ((eio = list_next(clients))) {
-			client = (struct client_io_info *)eio->arg;
-			if (client->out_eof == true)
-				continue;
-
-			/* Some clients only take certain I/O streams */
-			if (out->type==SLURM_IO_STDOUT) {
-				if (client->ltaskid_stdout != -1 &&
-				    client->ltaskid_stdout != out->ltaskid)
-					continue;
-			}
-			if (out->type==SLURM_IO_STDERR) {
-				if (client->ltaskid_stderr != -1 &&
-				    client->ltaskid_stderr != out->ltaskid)
-					continue;
-			}
-
-			debug5("======================== Enqueued message");
-			xassert(client->magic == CLIENT_IO_MAGIC);
-			if (list_enqueue(client->msg_queue, msg))
-				msg->ref_count++;
-		}
-		list_iterator_destroy(clients);
-
-		/* Update the outgoing message cache */
-		if (list_enqueue(out->job->outgoing_cache, msg)) {
-			msg->ref_count++;
-			_shrink_msg_cache(out->job->outgoing_cache, out->job);
-		}
+		_enqueue_msg_to_clients(out, msg);
 	}
 }
 
@@ -1606,6 +1733,8 @@ io_initial_client_connect(srun_info_t *srun, stepd_step_rec_t *job,
 	client->labelio = false;
 	client->label_width = 0;
 	client->is_local_file = false;
+	client->credit_flow = false;
+	client->send_credit = 0;
 
 	obj = eio_obj_create(sock, &client_ops, (void *)client);
 	list_append(job->clients, (void *)obj);
@@ -1666,6 +1795,8 @@ io_client_connect(srun_info_t *srun, stepd_step_rec_t *job)
 	client->labelio = false;
 	client->label_width = 0;
 	client->is_local_file = false;
+	client->credit_flow = false;
+	client->send_credit = 0;
 
 	/* client object adds itself to job->clients in _client_writable */
 
@@ -41,6 +41,9 @@
 
 #include "config.h"
 
+#include <dirent.h>
+#include <inttypes.h>
+
 #if HAVE_SYS_PRCTL_H
 #  include <sys/prctl.h>
 #endif
@@ -81,10 +84,12 @@
 #include "src/common/node_select.h"
 #include "src/common/plugstack.h"
 #include "src/common/safeopen.h"
+#include "src/common/siphash.h"
 #include "src/common/slurm_acct_gather_profile.h"
 #include "src/common/slurm_cred.h"
 #include "src/common/slurm_jobacct_gather.h"
 #include "src/common/slurm_mpi.h"
+#include "src/common/stepd_api.h"
 #include "src/common/switch.h"
 #include "src/common/util-net.h"
 #include "src/common/xmalloc.h"
@@ -118,6 +123,14 @@
 
 #define RETRY_DELAY 15		/* retry every 15 seconds */
 #define MAX_RETRY   240		/* retry 240 times (one hour max) */
+#define SCRIPT_STORE_GC_AGE 300	/* unreferenced script lifetime (secs) */
+
+/* Task exit aggregation window: exits are collected for this long after
+ * the last one seen (capped overall) before a message is sent, so one
+ * ranged task exit message covers many tasks on a wide node */
+#define TASK_EXIT_AGG_POLL_USEC	  20000		/*  20 msec */
+#define TASK_EXIT_AGG_QUIET_USEC 100000		/* 100 msec */
+#define TASK_EXIT_AGG_MAX_USEC	1000000		/*   1 sec  */
 
 /*
  *  List of signals to block in this process
@@ -156,6 +169,15 @@ typedef struct kill_thread {
 	int       secs;
 } kill_thread_t;
 
+/* Prolog completion state. When the slurmstepd is launched while the
+ * job prolog is still running on this node, the slurmd reports the
+ * prolog's return code through the step's message socket and the task
+ * launch path blocks until it arrives. */
+static pthread_mutex_t prolog_state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  prolog_state_cond  = PTHREAD_COND_INITIALIZER;
+static bool prolog_pending = false;
+static int  prolog_rc = SLURM_SUCCESS;
+
 
 /*
  * Prototypes
@@ -201,6 +223,9 @@ static void _unblock_signals(void);
  */
 static char * _make_batch_dir(stepd_step_rec_t *job);
 static char * _make_batch_script(batch_job_launch_msg_t *msg, char *path);
+static void   _script_store_gc(char *store_dir);
+static char * _script_store_get(batch_job_launch_msg_t *msg);
+static bool   _script_store_same(char *path, char *script);
 static int    _send_complete_batch_script_msg(stepd_step_rec_t *job,
 					      int err, int status);
 
@@ -213,6 +238,61 @@ static int _initgroups(stepd_step_rec_t *job);
 
 static stepd_step_rec_t *reattach_job;
 
+/* Shared statistics file updated on every jobacct poll so that slurmd
+ * can answer sstat requests without contacting this stepd */
+static stepd_stats_t *step_stats = NULL;
+static stepd_step_rec_t *step_stats_job = NULL;
+
+static void _stats_poll_cb(void)
+{
+	stepd_step_rec_t *job = step_stats_job;
+	jobacctinfo_t *jobacct, *temp_jobacct;
+	uint32_t num_tasks = 0;
+	pid_t *pids = NULL;
+	int npids = 0;
+	int i;
+
+	if (!step_stats || !job)
+		return;
+
+	jobacct = jobacctinfo_create(NULL);
+	for (i = 0; i < job->node_tasks; i++) {
+		temp_jobacct = jobacct_gather_stat_task(job->task[i]->pid);
+		if (temp_jobacct) {
+			jobacctinfo_aggregate(jobacct, temp_jobacct);
+			jobacctinfo_destroy(temp_jobacct);
+			num_tasks++;
+		}
+	}
+	proctrack_g_get_pids(job->cont_id, &pids, &npids);
+
+	stepd_stats_update(step_stats, jobacct, num_tasks, pids, npids);
+
+	xfree(pids);
+	jobacctinfo_destroy(jobacct);
+}
+
+static void _stats_shm_create(stepd_step_rec_t *job)
+{
+	step_stats = stepd_stats_create(conf->spooldir, conf->node_name,
+					job->jobid, job->stepid, job->uid);
+	if (step_stats) {
+		step_stats_job = job;
+		jobacct_gather_set_poll_cb(_stats_poll_cb);
+	}
+}
+
+static void _stats_shm_destroy(stepd_step_rec_t *job)
+{
+	if (!step_stats)
+		return;
+	jobacct_gather_set_poll_cb(NULL);
+	step_stats_job = NULL;
+	stepd_stats_destroy(step_stats, conf->spooldir, conf->node_name,
+			    job->jobid, job->stepid);
+	step_stats = NULL;
+}
+
 /*
  * Launch an job step on the current node
  */
@@ -1098,6 +1178,44 @@ fail1:
 	return rc;
 }
 
+extern void
+mgr_prolog_pending_set(int pending)
+{
+	slurm_mutex_lock(&prolog_state_mutex);
+	prolog_pending = (pending != 0);
+	slurm_mutex_unlock(&prolog_state_mutex);
+}
+
+extern void
+mgr_prolog_fini(int rc)
+{
+	slurm_mutex_lock(&prolog_state_mutex);
+	prolog_rc = rc;
+	prolog_pending = false;
+	slurm_cond_broadcast(&prolog_state_cond);
+	slurm_mutex_unlock(&prolog_state_mutex);
+}
+
+/* Block until the job prolog has completed on this node and return its
+ * return code. Returns immediately if the prolog had already completed
+ * when this slurmstepd was launched. */
+static int
+_wait_for_prolog(stepd_step_rec_t *job)
+{
+	int rc;
+
+	slurm_mutex_lock(&prolog_state_mutex);
+	while (prolog_pending) {
+		debug2("step %u.%u waiting on prolog completion",
+		       job->jobid, job->stepid);
+		slurm_cond_wait(&prolog_state_cond, &prolog_state_mutex);
+	}
+	rc = prolog_rc;
+	slurm_mutex_unlock(&prolog_state_mutex);
+
+	return rc;
+}
+
 /*
  * Executes the functions of the slurmd job manager process,
  * which runs as root and performs shared memory and interconnect
@@ -1286,6 +1404,9 @@ job_manager(stepd_step_rec_t *job)
 	/* Attach slurmstepd to system cgroups, if configured */
 	attach_system_cgroup_pid(getpid());
 
+	/* Export current usage for sstat via shared memory */
+	_stats_shm_create(job);
+
 	/* if we are not polling then we need to make sure we get some
 	 * information here
 	 */
@@ -1395,6 +1516,8 @@ fail1:
 	if (!job->batch && core_spec_g_clear(job->cont_id))
 		error("core_spec_g_clear: %m");
 
+	_stats_shm_destroy(job);
+
 	xfree(ckpt_type);
 	return(rc);
 }
@@ -1653,6 +1776,16 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 		*io_initialized = true;
 	}
 
+	/* The job prolog may still be running on this node; the I/O
+	 * channel back to srun was brought up in parallel with it, but
+	 * no task may be spawned before the prolog completes */
+	if (_wait_for_prolog(job) != SLURM_SUCCESS) {
+		error("prolog failed, not launching tasks for step %u.%u",
+		      job->jobid, job->stepid);
+		rc = ESLURMD_PROLOG_FAILED;
+		goto fail2;
+	}
+
 	/*
 	 * Temporarily drop effective privileges
 	 */
@@ -2094,14 +2227,29 @@ _wait_for_all_tasks(stepd_step_rec_t *job)
 		if (rc != -1) {
 			i += rc;
 			if (i < tasks_left) {
-				/* To limit the amount of traffic back
-				 * we will sleep a bit to make sure we
-				 * have most if not all the tasks
-				 * completed before we return */
-				usleep(100000);	/* 100 msec */
-				rc = _wait_for_any_task(job, false);
-				if (rc != -1)
-					i += rc;
+				/* To limit the amount of traffic back we
+				 * aggregate exits over a short window and
+				 * send one message covering many task ids
+				 * rather than one message per task. The
+				 * window is extended while exits keep
+				 * arriving, up to a hard cap. */
+				int quiet_usec = 0, total_usec = 0;
+				while ((i < tasks_left) &&
+				       (quiet_usec <
+					TASK_EXIT_AGG_QUIET_USEC) &&
+				       (total_usec <
+					TASK_EXIT_AGG_MAX_USEC)) {
+					usleep(TASK_EXIT_AGG_POLL_USEC);
+					quiet_usec += TASK_EXIT_AGG_POLL_USEC;
+					total_usec += TASK_EXIT_AGG_POLL_USEC;
+					rc = _wait_for_any_task(job, false);
+					if (rc == -1)
+						break;
+					if (rc > 0) {
+						i += rc;
+						quiet_usec = 0;
+					}
+				}
 			}
 		}
 
@@ -2209,10 +2357,120 @@ error:
 	return NULL;
 }
 
+/* Remove content-addressed script files no longer referenced by any
+ * job batch directory (link count of one) which are old enough that no
+ * concurrent launch should be about to link them */
+static void _script_store_gc(char *store_dir)
+{
+	char path[MAXPATHLEN];
+	DIR *dirp;
+	struct dirent *de;
+	struct stat stat_buf;
+	time_t now = time(NULL);
+
+	if ((dirp = opendir(store_dir)) == NULL)
+		return;
+	while ((de = readdir(dirp))) {
+		if (strncmp(de->d_name, "script.", 7))
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", store_dir, de->d_name);
+		if (stat(path, &stat_buf) < 0)
+			continue;
+		if ((stat_buf.st_nlink <= 1) &&
+		    (difftime(now, stat_buf.st_mtime) >
+		     SCRIPT_STORE_GC_AGE))
+			(void) unlink(path);
+	}
+	closedir(dirp);
+}
+
+/* Test if the file at path holds exactly this script */
+static bool _script_store_same(char *path, char *script)
+{
+	char buf[4096];
+	size_t len, offset = 0, script_len = strlen(script);
+	FILE *fp;
+	bool match = true;
+
+	if ((fp = fopen(path, "r")) == NULL)
+		return false;
+	while ((len = fread(buf, 1, sizeof(buf), fp))) {
+		if (((offset + len) > script_len) ||
+		    memcmp(buf, script + offset, len)) {
+			match = false;
+			break;
+		}
+		offset += len;
+	}
+	if (offset != script_len)
+		match = false;
+	fclose(fp);
+	return match;
+}
+
+/* Get the content-addressed copy of this job's batch script in the
+ * spool directory script store, creating it if needed. Array tasks of
+ * one job submission carry identical scripts, so they all resolve to
+ * one file here keyed by submitting uid and script hash.
+ * RET file path which the caller must xfree, or NULL on any failure,
+ * in which case the caller should write a private copy as before */
+static char *_script_store_get(batch_job_launch_msg_t *msg)
+{
+	char store_dir[MAXPATHLEN], content[MAXPATHLEN], tmp[MAXPATHLEN];
+	uint64_t hash = siphash_str(msg->script);
+	struct stat stat_buf;
+	FILE *fp;
+
+	snprintf(store_dir, sizeof(store_dir), "%s/scripts", conf->spooldir);
+	if ((mkdir(store_dir, 0755) < 0) && (errno != EEXIST)) {
+		error("mkdir(%s): %m", store_dir);
+		return NULL;
+	}
+
+	snprintf(content, sizeof(content), "%s/script.%u.%016"PRIx64,
+		 store_dir, (uint32_t) msg->uid, hash);
+	if (stat(content, &stat_buf) == 0) {
+		/* Guard against a hash collision or truncated write */
+		if (!_script_store_same(content, msg->script))
+			return NULL;
+		return xstrdup(content);
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp.%d", content, (int) getpid());
+	if ((fp = safeopen(tmp, "w", SAFEOPEN_CREATE_ONLY)) == NULL) {
+		error("couldn't open `%s': %m", tmp);
+		return NULL;
+	}
+	if (fputs(msg->script, fp) < 0) {
+		(void) fclose(fp);
+		(void) unlink(tmp);
+		error("fputs: %m");
+		if (errno == ENOSPC)
+			_drain_node("SlurmdSpoolDir is full");
+		return NULL;
+	}
+	if (fclose(fp) < 0) {
+		(void) unlink(tmp);
+		error("fclose: %m");
+		return NULL;
+	}
+	if ((chown(tmp, (uid_t) msg->uid, (gid_t) -1) < 0) ||
+	    (chmod(tmp, 0500) < 0) ||
+	    (rename(tmp, content) < 0)) {
+		error("can not install %s: %m", content);
+		(void) unlink(tmp);
+		return NULL;
+	}
+	_script_store_gc(store_dir);
+
+	return xstrdup(content);
+}
+
 static char *
 _make_batch_script(batch_job_launch_msg_t *msg, char *path)
 {
 	FILE *fp = NULL;
+	char *content;
 	char  script[MAXPATHLEN];
 
 	if (msg->script == NULL) {
@@ -2222,6 +2480,20 @@ _make_batch_script(batch_job_launch_msg_t *msg, char *path)
 
 	snprintf(script, sizeof(script), "%s/%s", path, "slurm_script");
 
+	/* Link the content-addressed script copy into the job's batch
+	 * directory, so array task storms write each script to disk
+	 * only once per node. Fall through and write a private copy on
+	 * any failure. */
+	if ((content = _script_store_get(msg))) {
+		(void) unlink(script);
+		if (link(content, script) == 0) {
+			xfree(content);
+			return xstrdup(script);
+		}
+		debug("link(%s, %s): %m", content, script);
+		xfree(content);
+	}
+
 again:
 	if ((fp = safeopen(script, "w", SAFEOPEN_CREATE_ONLY)) == NULL) {
 		if ((errno != EEXIST) || (unlink(script) < 0))  {
@@ -78,6 +78,19 @@ void mgr_launch_batch_job_cleanup(stepd_step_rec_t *job, int rc);
  */
 int job_manager(stepd_step_rec_t *job);
 
+/*
+ * Record whether the job prolog was still running on this node when the
+ * slurmstepd was launched. When set, task spawn is deferred until the
+ * slurmd reports the prolog's return code through mgr_prolog_fini().
+ */
+void mgr_prolog_pending_set(int pending);
+
+/*
+ * Deliver the prolog's return code to the manager thread waiting in
+ * the task launch path.
+ */
+void mgr_prolog_fini(int prolog_rc);
+
 /*
  * Register passwd entries so that we do not need to call initgroups(2)
  * frequently.
@@ -59,26 +59,44 @@
 #define MAX_ARGC 128
 #define _DEBUG   0
 
+/* One line of the configuration file.  The rank specifications are
+ * expanded into the table's rank index at parse time, so only the
+ * argument text is kept here. */
+typedef struct mpmd_line {
+	struct mpmd_line *next;
+	char *args;		/* command and argument portion of the line */
+	int line_num;
+} mpmd_line_t;
+
+struct mpmd_table {
+	int ntasks;
+	mpmd_line_t *lines;	/* all parsed lines, for ownership */
+	mpmd_line_t **rank_line; /* line matching each rank, may be NULL */
+	int *rank_offset;	/* rank's offset within its range spec */
+};
+
 /*
- * Test if the specified rank is included in the supplied task range
- * IN rank    - this task's rank
- * IN spec    - a line from the configuration file
- * OUT offset - the task's offset within rank range of the configuration file
- * RET 1 if within range, 0 otherwise
+ * Expand one rank specification into the table, assigning "line" to
+ * every rank it names that has not already been claimed by an earlier
+ * line.  The offset recorded for a rank is its position within the
+ * specification, for "%o" substitution.
  */
-static int
-_in_range(int rank, char* spec, int *offset)
+static void
+_expand_range_spec(struct mpmd_table *table, mpmd_line_t *mline, char *spec)
 {
 	char* range;
 	char* p;
 	char* upper;
-	int high_num, low_num, passed = 0;
-
-	xassert(offset);
+	int high_num, low_num, rank, passed = 0;
 
 	if (spec[0] == '*' && spec[1] == '\0') {
-		*offset = rank;
-		return 1;
+		for (rank = 0; rank < table->ntasks; rank++) {
+			if (table->rank_line[rank])
+				continue;
+			table->rank_line[rank] = mline;
+			table->rank_offset[rank] = rank;
+		}
+		return;
 	}
 
 	for (range = strtok (spec, ","); range != NULL;
@@ -87,9 +105,11 @@ _in_range(int rank, char* spec, int *offset)
 		while (*p != '\0' && isdigit (*p))
 			p ++;
 		if (*p == '\0') { /* single rank */
-			if (rank == atoi (range)) {
-				*offset = passed;
-				return 1;
+			rank = atoi (range);
+			if ((rank >= 0) && (rank < table->ntasks) &&
+			    !table->rank_line[rank]) {
+				table->rank_line[rank] = mline;
+				table->rank_offset[rank] = passed;
 			}
 			passed ++;
 
@@ -104,18 +124,22 @@ _in_range(int rank, char* spec, int *offset)
 			};
 			low_num  = atoi (range);
 			high_num = atoi (upper);
-			if ((rank >= low_num) && (rank <= high_num)) {
-				*offset = passed + (rank - low_num);
-				return 1;
-			} else
-				passed += (1 + high_num - low_num);
+			for (rank = MAX(low_num, 0);
+			     (rank <= high_num) && (rank < table->ntasks);
+			     rank++) {
+				if (table->rank_line[rank])
+					continue;
+				table->rank_line[rank] = mline;
+				table->rank_offset[rank] =
+					passed + (rank - low_num);
+			}
+			passed += (1 + high_num - low_num);
 
 		} else {
 			error ("Invalid task range specification (%s) ignored.",
 				range);
 		}
 	}
-	return 0;
 }
 
 /* substitute "%t" or "%o" in argument with task number or range offset */
@@ -138,42 +162,32 @@ _sub_expression(char *args_spec, int task_rank, int task_offset)
 }
 
 /*
- * FIXME - It would be nice to parse the multi-prog array just once
- *	to retrieve the argv arrays for each task on this node, rather
- *	than calling multi_prog_get_argv once for each task.
+ * Parse config_data (contents of the --multi-prog config file) once,
+ * resolving the rank range specifications up front. The first line
+ * matching a rank in file order wins.
+ *
+ * IN config_data - contents of the configuration file
+ * IN ntasks - total count of tasks in the job step
+ * RET the parsed table, or NULL for a malformed configuration.
+ *	Free with multi_prog_table_destroy()
  */
-extern int multi_prog_get_argv(char *config_data, char **prog_env,
-			       int task_rank, uint32_t *argc, char ***argv,
-			       int global_argc, char **global_argv)
+extern mpmd_table_t *multi_prog_table_create(char *config_data,
+					     uint32_t ntasks)
 {
-	char *line = NULL;
-	int i, line_num = 0;
-	int task_offset;
-	char *p = NULL, *s = NULL, *ptrptr = NULL;
-	char *rank_spec = NULL, *args_spec = NULL;
-	int prog_argc = 0;
-	char **prog_argv = NULL;
-	char *local_data = NULL;
+	struct mpmd_table *table;
+	mpmd_line_t *mline;
+	int line_num = 0;
+	char *line = NULL, *local_data = NULL, *ptrptr = NULL;
+	char *p = NULL, *rank_spec = NULL;
 
-	prog_argv = (char **)xmalloc(sizeof(char *) * MAX_ARGC);
-
-	if (task_rank < 0) {
-		error("Invalid task rank %d", task_rank);
-		*argc = 1;
-		*argv = prog_argv;
-		return -1;
-	}
+	table = xmalloc(sizeof(struct mpmd_table));
+	table->ntasks = ntasks;
+	table->rank_line = xmalloc(sizeof(mpmd_line_t *) * ntasks);
+	table->rank_offset = xmalloc(sizeof(int) * ntasks);
 
 	local_data = xstrdup(config_data);
-
-	line = strtok_r(local_data, "\n", &ptrptr);
-	while (line) {
-		if (line_num > 0)
-			line = strtok_r(NULL, "\n", &ptrptr);
-		if (line == NULL) {
-			error("No executable program specified for this task");
-			goto fail;
-		}
+	for (line = strtok_r(local_data, "\n", &ptrptr); line;
+	     line = strtok_r(NULL, "\n", &ptrptr)) {
 		line_num ++;
 		if (strlen (line) >= (BUF_SIZE - 1)) {
 			error ("Line %d of configuration file too long",
@@ -201,101 +215,163 @@ extern int multi_prog_get_argv(char *config_data, char **prog_env,
 		}
 		*p ++ = '\0';
 
-		if (!_in_range (task_rank, rank_spec, &task_offset))
-			continue;
-
 		/* skip all whitspace after the range spec */
 		while(*p != '\0' && isspace (*p))
 			p++;
 
-		args_spec = p;
-		while (*args_spec != '\0') {
-			/* Only simple quote and escape supported */
-			prog_argv[prog_argc ++] = args_spec;
-			if ((prog_argc + 1) >= MAX_ARGC) {
-				info("Exceeded multi-prog argc limit");
-				break;
-			}
-		CONT:	while (*args_spec != '\0' && *args_spec != '\\'
-			&&     *args_spec != '%'
-			&&     *args_spec != '\'' && !isspace (*args_spec)) {
-				args_spec ++;
-			}
-			if (*args_spec == '\0') {
-				/* the last argument */
-				break;
+		mline = xmalloc(sizeof(mpmd_line_t));
+		mline->args = xstrdup(p);
+		mline->line_num = line_num;
+		mline->next = table->lines;
+		table->lines = mline;
 
-			} else if (*args_spec == '%') {
-				_sub_expression(args_spec, task_rank,
-					task_offset);
-				args_spec ++;
-				goto CONT;
-
-			} else if (*args_spec == '\\') {
-				/* escape, just remove the backslash */
-				s = args_spec ++;
-				p = args_spec;
-				do {
-					*s ++ = *p;
-				} while (*p ++ != '\0');
-				goto CONT;
-
-			} else if (*args_spec == '\'') {
-				/* single quote,
-				 * preserve all characters quoted. */
-				p = args_spec + 1;
-				while (*p != '\0' && *p != '\'') {
-					/* remove quote */
-					*args_spec ++ = *p ++;
-				}
-				if (*p == '\0') {
-					/* closing quote not found */
-					error("Program arguments specification"
-						" format invalid: %s.",
-						prog_argv[prog_argc -1]);
-					goto fail;
-				}
-				p ++; /* skip closing quote */
-				s = args_spec;
-				do {
-					*s ++ = *p;
-				} while (*p ++ != '\0');
-				goto CONT;
-
-			} else {
-				/* space */
-				*args_spec ++ = '\0';
-				while (*args_spec != '\0'
-				&& isspace (*args_spec))
-					args_spec ++;
-			}
+		_expand_range_spec(table, mline, rank_spec);
+	}
+	xfree(local_data);
+	return table;
 
+fail:
+	xfree(local_data);
+	multi_prog_table_destroy(table);
+	return NULL;
+}
+
+/* Build the argv array for a single task from a parsed MPMD table.
+ *
+ * "task_rank" is the task's GLOBAL rank within the job step.
+ */
+extern int multi_prog_table_get_argv(mpmd_table_t *table, int task_rank,
+				     uint32_t *argc, char ***argv,
+				     int global_argc, char **global_argv)
+{
+	int i;
+	int task_offset;
+	char *p = NULL, *s = NULL;
+	char *args_spec = NULL;
+	int prog_argc = 0;
+	char **prog_argv = NULL;
+
+	prog_argv = (char **)xmalloc(sizeof(char *) * MAX_ARGC);
+
+	if ((task_rank < 0) || (table && (task_rank >= table->ntasks))) {
+		error("Invalid task rank %d", task_rank);
+		goto fail;
+	}
+	if (!table)	/* parse failure, already reported */
+		goto fail;
+	if (!table->rank_line[task_rank]) {
+		error("Program for task rank %d not specified.", task_rank);
+		goto fail;
+	}
+	task_offset = table->rank_offset[task_rank];
+
+	/* The parser below modifies the arguments in place and the "%t"
+	 * and "%o" expansions differ per task, so each task works on its
+	 * own copy. The argv entries point into this copy, which must
+	 * persist for the life of the task. */
+	args_spec = xmalloc(BUF_SIZE);
+	strcpy(args_spec, table->rank_line[task_rank]->args);
+
+	while (*args_spec != '\0') {
+		/* Only simple quote and escape supported */
+		prog_argv[prog_argc ++] = args_spec;
+		if ((prog_argc + 1) >= MAX_ARGC) {
+			info("Exceeded multi-prog argc limit");
+			break;
 		}
+	CONT:	while (*args_spec != '\0' && *args_spec != '\\'
+		&&     *args_spec != '%'
+		&&     *args_spec != '\'' && !isspace (*args_spec)) {
+			args_spec ++;
+		}
+		if (*args_spec == '\0') {
+			/* the last argument */
+			break;
 
-		for (i = 2; i < global_argc; i++) {
-			if ((prog_argc + 1) >= MAX_ARGC) {
-				info("Exceeded multi-prog argc limit");
-				break;
+		} else if (*args_spec == '%') {
+			_sub_expression(args_spec, task_rank,
+				task_offset);
+			args_spec ++;
+			goto CONT;
+
+		} else if (*args_spec == '\\') {
+			/* escape, just remove the backslash */
+			s = args_spec ++;
+			p = args_spec;
+			do {
+				*s ++ = *p;
+			} while (*p ++ != '\0');
+			goto CONT;
+
+		} else if (*args_spec == '\'') {
+			/* single quote,
+			 * preserve all characters quoted. */
+			p = args_spec + 1;
+			while (*p != '\0' && *p != '\'') {
+				/* remove quote */
+				*args_spec ++ = *p ++;
+			}
+			if (*p == '\0') {
+				/* closing quote not found */
+				error("Program arguments specification"
+					" format invalid: %s.",
+					prog_argv[prog_argc -1]);
+				goto fail;
 			}
-			prog_argv[prog_argc++] = xstrdup(global_argv[i]);
+			p ++; /* skip closing quote */
+			s = args_spec;
+			do {
+				*s ++ = *p;
+			} while (*p ++ != '\0');
+			goto CONT;
+
+		} else {
+			/* space */
+			*args_spec ++ = '\0';
+			while (*args_spec != '\0'
+			&& isspace (*args_spec))
+				args_spec ++;
 		}
-		prog_argv[prog_argc] = NULL;
 
-		*argc = prog_argc;
-		*argv = prog_argv;
-		/* FIXME - local_data is leaked */
-		return 0;
 	}
 
-	error("Program for task rank %d not specified.", task_rank);
+	for (i = 2; i < global_argc; i++) {
+		if ((prog_argc + 1) >= MAX_ARGC) {
+			info("Exceeded multi-prog argc limit");
+			break;
+		}
+		prog_argv[prog_argc++] = xstrdup(global_argv[i]);
+	}
+	prog_argv[prog_argc] = NULL;
+
+	*argc = prog_argc;
+	*argv = prog_argv;
+	return 0;
+
 fail:
-	xfree(local_data);
 	*argc = 1;
 	prog_argv[0] = NULL;
 	*argv = prog_argv;
 	return -1;
 }
 
+/* Free a table built by multi_prog_table_create() */
+extern void multi_prog_table_destroy(mpmd_table_t *table)
+{
+	mpmd_line_t *mline, *next;
+
+	if (!table)
+		return;
+	for (mline = table->lines; mline; mline = next) {
+		next = mline->next;
+		xfree(mline->args);
+		xfree(mline);
+	}
+	xfree(table->rank_line);
+	xfree(table->rank_offset);
+	xfree(table);
+}
+
 /*
  * Parse an MPMD file and determine count and layout of each task for use
  * with Cray systems. Builds the mpmd_set structure in the job record.
@@ -54,12 +54,29 @@ extern void multi_prog_parse(stepd_step_rec_t *job, uint32_t **gtid);
  * multi_prog_parse() and used for Cray system. */
 extern void mpmd_free(stepd_step_rec_t *job);
 
-/* Execute a single task based upon the config_data (contents of config_file)
- * and the environment variables supplied.
+/* MPMD configuration parsed once per step into a rank-indexed table */
+typedef struct mpmd_table mpmd_table_t;
+
+/* Parse config_data (contents of the --multi-prog config file) once,
+ * resolving the rank range specifications up front. The first line
+ * matching a rank in file order wins.
+ *
+ * IN config_data - contents of the configuration file
+ * IN ntasks - total count of tasks in the job step
+ * RET the parsed table, or NULL for a malformed configuration.
+ *	Free with multi_prog_table_destroy()
+ */
+extern mpmd_table_t *multi_prog_table_create(char *config_data,
+					     uint32_t ntasks);
+
+/* Build the argv array for a single task from a parsed MPMD table.
  *
  * "task_rank" is the task's GLOBAL rank within the job step.
  */
-extern int multi_prog_get_argv(char *config_data, char **prog_env,
-			       int task_rank, uint32_t *argc, char ***argv,
-			       int global_argc, char **global_argv);
+extern int multi_prog_table_get_argv(mpmd_table_t *table, int task_rank,
+				     uint32_t *argc, char ***argv,
+				     int global_argc, char **global_argv);
+
+/* Free a table built by multi_prog_table_create() */
+extern void multi_prog_table_destroy(mpmd_table_t *table);
 #endif /* !_SLURMD_MULTI_PROG_H */
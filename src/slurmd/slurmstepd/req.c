@@ -91,6 +91,7 @@ static int _handle_add_extern_pid_internal(stepd_step_rec_t *job, pid_t pid);
 static int _handle_add_extern_pid(int fd, stepd_step_rec_t *job);
 static int _handle_daemon_pid(int fd, stepd_step_rec_t *job);
 static int _handle_notify_job(int fd, stepd_step_rec_t *job, uid_t uid);
+static int _handle_prolog_fini(int fd, stepd_step_rec_t *job, uid_t uid);
 static int _handle_suspend(int fd, stepd_step_rec_t *job, uid_t uid);
 static int _handle_resume(int fd, stepd_step_rec_t *job, uid_t uid);
 static int _handle_terminate(int fd, stepd_step_rec_t *job, uid_t uid);
@@ -580,6 +581,10 @@ _handle_request(int fd, stepd_step_rec_t *job, uid_t uid, gid_t gid)
 		debug("Handling REQUEST_ADD_EXTERN_PID");
 		rc = _handle_add_extern_pid(fd, job);
 		break;
+	case REQUEST_STEP_PROLOG_FINI:
+		debug("Handling REQUEST_STEP_PROLOG_FINI");
+		rc = _handle_prolog_fini(fd, job, uid);
+		break;
 	default:
 		error("Unrecognized request: %d", req);
 		rc = SLURM_FAILURE;
@@ -1029,6 +1034,33 @@ rwfail:
 	return SLURM_FAILURE;
 }
 
+static int
+_handle_prolog_fini(int fd, stepd_step_rec_t *job, uid_t uid)
+{
+	int rc = SLURM_SUCCESS;
+	int prolog_rc;
+
+	safe_read(fd, &prolog_rc, sizeof(int));
+
+	debug3("_handle_prolog_fini for job %u.%u prolog_rc=%d",
+	       job->jobid, job->stepid, prolog_rc);
+
+	if (!_slurm_authorized_user(uid)) {
+		debug("prolog fini req from uid %ld for job %u.%u",
+		      (long)uid, job->jobid, job->stepid);
+		rc = EPERM;
+		goto done;
+	}
+	mgr_prolog_fini(prolog_rc);
+
+done:
+	/* Send the return code */
+	safe_write(fd, &rc, sizeof(int));
+	return SLURM_SUCCESS;
+rwfail:
+	return SLURM_FAILURE;
+}
+
 static int
 _handle_terminate(int fd, stepd_step_rec_t *job, uid_t uid)
 {
@@ -422,6 +422,7 @@ _init_from_slurmd(int sock, char **argv,
 	Buf buffer;
 	int step_type;
 	int len, proto;
+	int prolog_pending = 0;
 	slurm_addr_t *cli = NULL;
 	slurm_addr_t *self = NULL;
 	slurm_msg_t *msg = NULL;
@@ -449,6 +450,11 @@ _init_from_slurmd(int sock, char **argv,
 	step_complete.jobacct = jobacctinfo_create(NULL);
 	slurm_mutex_unlock(&step_complete.lock);
 
+	/* nonzero if the job prolog is still running and the slurmd will
+	 * report its return code once it completes */
+	safe_read(sock, &prolog_pending, sizeof(int));
+	mgr_prolog_pending_set(prolog_pending);
+
 	/* receive conf from slurmd */
 	if ((conf = read_slurmd_conf_lite (sock)) == NULL)
 		fatal("Failed to read conf from slurmd");
@@ -96,37 +96,37 @@ _batchfilename(stepd_step_rec_t *job, const char *name)
 }
 
 /*
- * Expand a stdio file name.
+ * Expand a stdio file name from its precompiled template.
  *
- * If "filename" is NULL it means that an eio object should be created
- * for that stdio file rather than a directly connecting it to a file.
+ * If "tmpl" is NULL the file name was NULL, which means that an eio
+ * object should be created for that stdio file rather than directly
+ * connecting it to a file.
  *
- * If the "filename" is a valid task number in string form and the
+ * If the file name is a valid task number in string form and the
  * number matches "taskid", then NULL is returned so that an eio
  * object will be used.  If is a valid number, but it does not match
  * "taskid", then the file descriptor will be connected to /dev/null.
  */
 static char *
-_expand_stdio_filename(char *filename, int gtaskid, stepd_step_rec_t *job)
+_expand_stdio_template(fname_template_t *tmpl, int gtaskid,
+		       stepd_step_rec_t *job)
 {
 	int id;
 
-	if (filename == NULL)
+	if (tmpl == NULL)
 		return NULL;
 
-	id = fname_single_task_io(filename);
-
-	if (id < 0)
-		return fname_create(job, filename, gtaskid);
-	if (id >= job->ntasks) {
-		error("Task ID in filename is invalid");
-		return NULL;
+	if ((id = fname_template_single_task_io(tmpl)) >= 0) {
+		if (id >= job->ntasks) {
+			error("Task ID in filename is invalid");
+			return NULL;
+		}
+		if (id == gtaskid)
+			return NULL;
+		return xstrdup("/dev/null");
 	}
 
-	if (id == gtaskid)
-		return NULL;
-	else
-		return xstrdup("/dev/null");
+	return fname_template_render(tmpl, job, gtaskid);
 }
 
 static void
@@ -135,6 +135,7 @@ _job_init_task_info(stepd_step_rec_t *job, uint32_t **gtid,
 {
 	int          i, node_id = job->nodeid;
 	char        *in, *out, *err;
+	fname_template_t *in_tmpl, *out_tmpl, *err_tmpl;
 
 	if (job->node_tasks == 0) {
 		error("User requested launch of zero tasks!");
@@ -163,10 +164,15 @@ _job_init_task_info(stepd_step_rec_t *job, uint32_t **gtid,
 		job->argv[0] = new_path;
 	}
 
+	/* Compile the filename formats once, then render them per task */
+	in_tmpl = fname_template_create(job, ifname);
+	out_tmpl = fname_template_create(job, ofname);
+	err_tmpl = fname_template_create(job, efname);
+
 	for (i = 0; i < job->node_tasks; i++) {
-		in = _expand_stdio_filename(ifname, gtid[node_id][i], job);
-		out = _expand_stdio_filename(ofname, gtid[node_id][i], job);
-		err = _expand_stdio_filename(efname, gtid[node_id][i], job);
+		in = _expand_stdio_template(in_tmpl, gtid[node_id][i], job);
+		out = _expand_stdio_template(out_tmpl, gtid[node_id][i], job);
+		err = _expand_stdio_template(err_tmpl, gtid[node_id][i], job);
 		job->task[i] = task_info_create(i, gtid[node_id][i], in, out,
 						err);
 		if (!job->multi_prog) {
@@ -175,18 +181,28 @@ _job_init_task_info(stepd_step_rec_t *job, uint32_t **gtid,
 		}
 	}
 
+	fname_template_destroy(in_tmpl);
+	fname_template_destroy(out_tmpl);
+	fname_template_destroy(err_tmpl);
+
 	if (job->multi_prog) {
+		mpmd_table_t *mpmd_table;
 		char *switch_type = slurm_get_switch_type();
 		if (!xstrcmp(switch_type, "switch/cray"))
 			multi_prog_parse(job, gtid);
 		xfree(switch_type);
+		/* Parse the MPMD configuration once, then build each
+		 * task's argv from the rank-indexed table */
+		mpmd_table = multi_prog_table_create(job->argv[1],
+						     job->ntasks);
 		for (i = 0; i < job->node_tasks; i++){
-			multi_prog_get_argv(job->argv[1], job->env,
-					    gtid[node_id][i],
-					    &job->task[i]->argc,
-					    &job->task[i]->argv,
-					    job->argc, job->argv);
+			multi_prog_table_get_argv(mpmd_table,
+						  gtid[node_id][i],
+						  &job->task[i]->argc,
+						  &job->task[i]->argv,
+						  job->argc, job->argv);
 		}
+		multi_prog_table_destroy(mpmd_table);
 	}
 }
 
@@ -198,6 +198,177 @@ static int   _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 static int   _step_start(slurmdbd_conn_t *slurmdbd_conn,
 			 Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 
+/*
+ * Read cache for the assoc/QOS/user table queries.  Controller restarts
+ * and "sacctmgr show" commands issue the same full table SELECTs over
+ * and over although the tables only change through add/modify/remove
+ * RPCs that all pass through proc_req() as well.  Remember the packed
+ * reply for each (RPC type, protocol version, uid, packed condition)
+ * tuple and serve repeats straight from memory; any RPC which may write
+ * one of those tables drops the whole cache.  Entries also age out so
+ * data changed outside of the RPC path (e.g. by a usage rollup) is
+ * never served for long.
+ */
+#define READ_CACHE_MAX_AGE 120	/* seconds an entry may be served */
+#define READ_CACHE_MAX_ENT 64	/* entries kept before eviction */
+
+typedef struct {
+	char *cluster;		/* cluster name on the connection */
+	char *cond;		/* packed condition bytes (the key) */
+	uint32_t cond_len;	/* length of the packed condition */
+	time_t created;
+	uint16_t msg_type;
+	Buf reply;		/* packed reply (the value) */
+	uint16_t rpc_version;
+	uint32_t uid;
+} read_cache_ent_t;
+
+static List read_cache_list = NULL;
+static pthread_mutex_t read_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _free_read_cache_ent(void *x)
+{
+	read_cache_ent_t *ent = (read_cache_ent_t *) x;
+
+	if (ent) {
+		xfree(ent->cluster);
+		xfree(ent->cond);
+		free_buf(ent->reply);
+		xfree(ent);
+	}
+}
+
+static int _find_read_cache_ent(void *x, void *key)
+{
+	read_cache_ent_t *ent = (read_cache_ent_t *) x;
+	read_cache_ent_t *probe = (read_cache_ent_t *) key;
+
+	return ((ent->msg_type == probe->msg_type) &&
+		(ent->rpc_version == probe->rpc_version) &&
+		(ent->uid == probe->uid) &&
+		!xstrcmp(ent->cluster, probe->cluster) &&
+		(ent->cond_len == probe->cond_len) &&
+		!memcmp(ent->cond, probe->cond, ent->cond_len));
+}
+
+/* Return true for the RPCs that may change a table the read cache is
+ * built from (assocs, QOS, users and the tables they join against). */
+static bool _read_cache_writes(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case DBD_ADD_ACCOUNTS:
+	case DBD_ADD_ACCOUNT_COORDS:
+	case DBD_ADD_ASSOCS:
+	case DBD_ADD_CLUSTERS:
+	case DBD_ADD_FEDERATIONS:
+	case DBD_ADD_QOS:
+	case DBD_ADD_RES:
+	case DBD_ADD_TRES:
+	case DBD_ADD_USERS:
+	case DBD_ADD_WCKEYS:
+	case DBD_ARCHIVE_LOAD:
+	case DBD_MODIFY_ACCOUNTS:
+	case DBD_MODIFY_ASSOCS:
+	case DBD_MODIFY_CLUSTERS:
+	case DBD_MODIFY_FEDERATIONS:
+	case DBD_MODIFY_QOS:
+	case DBD_MODIFY_RES:
+	case DBD_MODIFY_USERS:
+	case DBD_MODIFY_WCKEYS:
+	case DBD_REMOVE_ACCOUNTS:
+	case DBD_REMOVE_ACCOUNT_COORDS:
+	case DBD_REMOVE_ASSOCS:
+	case DBD_REMOVE_CLUSTERS:
+	case DBD_REMOVE_FEDERATIONS:
+	case DBD_REMOVE_QOS:
+	case DBD_REMOVE_RES:
+	case DBD_REMOVE_USERS:
+	case DBD_REMOVE_WCKEYS:
+	case DBD_ROLL_USAGE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void _read_cache_purge(void)
+{
+	slurm_mutex_lock(&read_cache_mutex);
+	if (read_cache_list)
+		list_flush(read_cache_list);
+	slurm_mutex_unlock(&read_cache_mutex);
+}
+
+/* Return a copy of the cached reply for this request or NULL.  The
+ * offset of in_buffer (positioned at the packed condition) is left
+ * untouched. */
+static Buf _read_cache_fetch(uint16_t msg_type, slurmdbd_conn_t *slurmdbd_conn,
+			     Buf in_buffer, uint32_t uid)
+{
+	read_cache_ent_t probe, *ent;
+	Buf reply = NULL;
+	uint32_t len;
+
+	probe.msg_type = msg_type;
+	probe.rpc_version = slurmdbd_conn->rpc_version;
+	probe.uid = uid;
+	probe.cluster = slurmdbd_conn->cluster_name;
+	probe.cond_len = remaining_buf(in_buffer);
+	probe.cond = get_buf_data(in_buffer) + get_buf_offset(in_buffer);
+
+	slurm_mutex_lock(&read_cache_mutex);
+	if (read_cache_list &&
+	    (ent = list_find_first(read_cache_list, _find_read_cache_ent,
+				   &probe))) {
+		if (difftime(time(NULL), ent->created) > READ_CACHE_MAX_AGE) {
+			list_delete_all(read_cache_list, _find_read_cache_ent,
+					&probe);
+		} else {
+			len = get_buf_offset(ent->reply);
+			reply = init_buf(len);
+			memcpy(get_buf_data(reply), get_buf_data(ent->reply),
+			       len);
+			set_buf_offset(reply, len);
+		}
+	}
+	slurm_mutex_unlock(&read_cache_mutex);
+
+	return reply;
+}
+
+/* Remember the reply just built for this request.  key_offset is the
+ * offset of the packed condition within in_buffer, recorded before the
+ * condition was unpacked. */
+static void _read_cache_store(uint16_t msg_type, slurmdbd_conn_t *slurmdbd_conn,
+			      Buf in_buffer, uint32_t key_offset,
+			      uint32_t uid, Buf reply)
+{
+	read_cache_ent_t *ent;
+	uint32_t len = get_buf_offset(reply);
+
+	ent = xmalloc(sizeof(read_cache_ent_t));
+	ent->msg_type = msg_type;
+	ent->rpc_version = slurmdbd_conn->rpc_version;
+	ent->uid = uid;
+	ent->cluster = xstrdup(slurmdbd_conn->cluster_name);
+	ent->cond_len = size_buf(in_buffer) - key_offset;
+	ent->cond = xmalloc(ent->cond_len);
+	memcpy(ent->cond, get_buf_data(in_buffer) + key_offset,
+	       ent->cond_len);
+	ent->created = time(NULL);
+	ent->reply = init_buf(len);
+	memcpy(get_buf_data(ent->reply), get_buf_data(reply), len);
+	set_buf_offset(ent->reply, len);
+
+	slurm_mutex_lock(&read_cache_mutex);
+	if (!read_cache_list)
+		read_cache_list = list_create(_free_read_cache_ent);
+	if (list_count(read_cache_list) >= READ_CACHE_MAX_ENT)
+		_free_read_cache_ent(list_pop(read_cache_list));
+	list_append(read_cache_list, ent);
+	slurm_mutex_unlock(&read_cache_mutex);
+}
+
 /* Process an incoming RPC
  * slurmdbd_conn IN/OUT - in will that the newsockfd set before
  *       calling and db_conn and rpc_version will be filled in with the init.
@@ -251,6 +422,11 @@ proc_req(slurmdbd_conn_t *slurmdbd_conn,
 		*out_buffer = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
 					      rc, comment, DBD_INIT);
 	} else {
+		/* Drop cached read replies before dispatching any RPC
+		 * that can change the underlying tables. */
+		if (_read_cache_writes(msg_type))
+			_read_cache_purge();
+
 		switch (msg_type) {
 		case DBD_ADD_ACCOUNTS:
 			rc = _add_accounts(slurmdbd_conn,
@@ -1288,8 +1464,15 @@ static int _get_assocs(slurmdbd_conn_t *slurmdbd_conn,
 	dbd_list_msg_t list_msg;
 	char *comment = NULL;
 	int rc = SLURM_SUCCESS;
+	uint32_t key_offset = get_buf_offset(in_buffer);
 
 	debug2("DBD_GET_ASSOCS: called");
+	if ((*out_buffer = _read_cache_fetch(DBD_GET_ASSOCS, slurmdbd_conn,
+					     in_buffer, *uid))) {
+		debug2("DBD_GET_ASSOCS: served from the read cache");
+		return SLURM_SUCCESS;
+	}
+
 	if (slurmdbd_unpack_cond_msg(&get_msg, slurmdbd_conn->rpc_version,
 				     DBD_GET_ASSOCS, in_buffer) !=
 	    SLURM_SUCCESS) {
@@ -1311,6 +1494,8 @@ static int _get_assocs(slurmdbd_conn_t *slurmdbd_conn,
 		pack16((uint16_t) DBD_GOT_ASSOCS, *out_buffer);
 		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
 				       DBD_GOT_ASSOCS, *out_buffer);
+		_read_cache_store(DBD_GET_ASSOCS, slurmdbd_conn, in_buffer,
+				  key_offset, *uid, *out_buffer);
 	} else {
 		*out_buffer = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
 					      errno, slurm_strerror(errno),
@@ -1603,8 +1788,15 @@ static int _get_qos(slurmdbd_conn_t *slurmdbd_conn,
 	dbd_list_msg_t list_msg;
 	char *comment = NULL;
 	int rc = SLURM_SUCCESS;
+	uint32_t key_offset = get_buf_offset(in_buffer);
 
 	debug2("DBD_GET_QOS: called");
+	if ((*out_buffer = _read_cache_fetch(DBD_GET_QOS, slurmdbd_conn,
+					     in_buffer, *uid))) {
+		debug2("DBD_GET_QOS: served from the read cache");
+		return SLURM_SUCCESS;
+	}
+
 	if (slurmdbd_unpack_cond_msg(&cond_msg, slurmdbd_conn->rpc_version,
 				     DBD_GET_QOS, in_buffer) !=
 	    SLURM_SUCCESS) {
@@ -1629,6 +1821,8 @@ static int _get_qos(slurmdbd_conn_t *slurmdbd_conn,
 		pack16((uint16_t) DBD_GOT_QOS, *out_buffer);
 		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
 				       DBD_GOT_QOS, *out_buffer);
+		_read_cache_store(DBD_GET_QOS, slurmdbd_conn, in_buffer,
+				  key_offset, *uid, *out_buffer);
 	} else {
 		*out_buffer = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
 					      errno, slurm_strerror(errno),
@@ -1798,9 +1992,16 @@ static int _get_users(slurmdbd_conn_t *slurmdbd_conn,
 	char *comment = NULL;
 	int rc = SLURM_SUCCESS;
 	slurmdb_user_cond_t * user_cond = NULL;
+	uint32_t key_offset = get_buf_offset(in_buffer);
 
 	debug2("DBD_GET_USERS: called");
 
+	if ((*out_buffer = _read_cache_fetch(DBD_GET_USERS, slurmdbd_conn,
+					     in_buffer, *uid))) {
+		debug2("DBD_GET_USERS: served from the read cache");
+		return SLURM_SUCCESS;
+	}
+
 	if (slurmdbd_unpack_cond_msg(&get_msg, slurmdbd_conn->rpc_version,
 				     DBD_GET_USERS, in_buffer) !=
 	    SLURM_SUCCESS) {
@@ -1837,6 +2038,8 @@ static int _get_users(slurmdbd_conn_t *slurmdbd_conn,
 		pack16((uint16_t) DBD_GOT_USERS, *out_buffer);
 		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
 				       DBD_GOT_USERS, *out_buffer);
+		_read_cache_store(DBD_GET_USERS, slurmdbd_conn, in_buffer,
+				  key_offset, *uid, *out_buffer);
 	} else {
 		*out_buffer = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
 					      errno, slurm_strerror(errno),
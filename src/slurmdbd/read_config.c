@@ -99,6 +99,8 @@ static void _clear_slurmdbd_conf(void)
 		slurmdbd_conf->debug_flags = 0;
 		slurmdbd_conf->debug_level = 0;
 		xfree(slurmdbd_conf->default_qos);
+		slurmdbd_conf->job_batch_interval = 0;
+		slurmdbd_conf->job_batch_size = 0;
 		xfree(slurmdbd_conf->log_file);
 		xfree(slurmdbd_conf->pid_file);
 		xfree(slurmdbd_conf->plugindir);
@@ -148,6 +150,8 @@ extern int read_slurmdbd_conf(void)
 		{"DebugFlags", S_P_STRING},
 		{"DebugLevel", S_P_STRING},
 		{"DefaultQOS", S_P_STRING},
+		{"JobBatchInterval", S_P_UINT16},
+		{"JobBatchSize", S_P_UINT16},
 		{"JobPurge", S_P_UINT32},
 		{"LogFile", S_P_STRING},
 		{"LogTimeFormat", S_P_STRING},
@@ -245,6 +249,15 @@ extern int read_slurmdbd_conf(void)
 		}
 
 		s_p_get_string(&slurmdbd_conf->default_qos, "DefaultQOS", tbl);
+
+		if (!s_p_get_uint16(&slurmdbd_conf->job_batch_interval,
+				    "JobBatchInterval", tbl))
+			slurmdbd_conf->job_batch_interval =
+				DEFAULT_JOB_BATCH_INTERVAL;
+		if (!s_p_get_uint16(&slurmdbd_conf->job_batch_size,
+				    "JobBatchSize", tbl) ||
+		    !slurmdbd_conf->job_batch_size)
+			slurmdbd_conf->job_batch_size = 1;
 		if (s_p_get_uint32(&slurmdbd_conf->purge_job,
 				   "JobPurge", tbl)) {
 			if (!slurmdbd_conf->purge_job)
@@ -566,6 +579,8 @@ extern void log_config(void)
 	xfree(tmp_ptr);
 	debug2("DebugLevel        = %u", slurmdbd_conf->debug_level);
 	debug2("DefaultQOS        = %s", slurmdbd_conf->default_qos);
+	debug2("JobBatchInterval  = %u", slurmdbd_conf->job_batch_interval);
+	debug2("JobBatchSize      = %u", slurmdbd_conf->job_batch_size);
 
 	debug2("LogFile           = %s", slurmdbd_conf->log_file);
 	debug2("MessageTimeout    = %u", slurmdbd_conf->msg_timeout);
@@ -743,6 +758,17 @@ extern List dump_config(void)
 	key_pair->value = xstrdup(slurmdbd_conf->default_qos);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("JobBatchInterval");
+	key_pair->value = xstrdup_printf(
+		"%u secs", slurmdbd_conf->job_batch_interval);
+	list_append(my_list, key_pair);
+
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("JobBatchSize");
+	key_pair->value = xstrdup_printf("%u", slurmdbd_conf->job_batch_size);
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("LogFile");
 	key_pair->value = xstrdup(slurmdbd_conf->log_file);
@@ -50,6 +50,7 @@
 //#define DEFAULT_SLURMDBD_JOB_PURGE	12
 #define DEFAULT_SLURMDBD_PIDFILE	"/var/run/slurmdbd.pid"
 #define DEFAULT_SLURMDBD_ARCHIVE_DIR	"/tmp"
+#define DEFAULT_JOB_BATCH_INTERVAL	5
 //#define DEFAULT_SLURMDBD_STEP_PURGE	1
 
 /* SlurmDBD configuration parameters */
@@ -72,6 +73,12 @@ typedef struct slurm_dbd_conf {
 	uint16_t	debug_level;	/* Debug level, default=3	*/
 	char *	 	default_qos;	/* default qos setting when
 					 * adding clusters              */
+	uint16_t	job_batch_interval; /* seconds a batched job/step
+					 * record may wait before being
+					 * flushed to the database      */
+	uint16_t	job_batch_size;	/* number of job/step records
+					 * coalesced into one query,
+					 * 1 disables batching          */
 	char *		log_file;	/* Log file			*/
 	uint16_t        log_fmt;        /* Log file timestamt format    */
 	uint16_t        msg_timeout;    /* message timeout		*/
@@ -44,8 +44,10 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "src/common/fd.h"
+#include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/slurm_protocol_api.h"
@@ -58,7 +60,10 @@
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/slurmdbd.h"
 
-#define MAX_THREAD_COUNT 100
+/* Size of the fixed pool of worker threads servicing incoming RPCs.
+ * Every connection beyond this count just waits in the kernel socket
+ * buffer instead of consuming a thread and its stack. */
+#define RPC_WORKER_COUNT 20
 
 /*
  *  Maximum message size. Messages larger than this value (in bytes)
@@ -66,51 +71,73 @@
  */
 #define MAX_MSG_SIZE     (16*1024*1024)
 
+/* Per-connection state kept by the RPC manager between requests.
+ * A connection is in exactly one place at any time: the poll set of
+ * rpc_mgr(), the work queue, or being serviced by one worker. This
+ * serializes requests per connection, and with the FIFO work queue it
+ * round-robins the workers over all busy connections (clusters) so no
+ * single chatty slurmctld can monopolize the pool. */
+typedef struct {
+	slurmdbd_conn_t *conn;
+	bool first;		/* no message processed on the socket yet */
+	uint32_t uid;		/* user who opened the connection */
+} rpc_conn_t;
+
 /* Local functions */
+static void   _close_connection(rpc_conn_t *rpc_conn);
 static bool   _fd_readable(int fd);
-static void   _free_server_thread(pthread_t my_tid);
+static void   _poll_add(rpc_conn_t *rpc_conn);
+static void   _rearm_connection(rpc_conn_t *rpc_conn);
+static void * _rpc_worker(void *arg);
 static int    _send_resp(int fd, Buf buffer);
-static void * _service_connection(void *arg);
+static int    _service_request(rpc_conn_t *rpc_conn);
 static void   _sig_handler(int signal);
 static int    _tot_wait (struct timeval *start_time);
-static int    _wait_for_server_thread(void);
-static void   _wait_for_thread_fini(void);
 
 /* Local variables */
-static pthread_t       master_thread_id = 0, slave_thread_id[MAX_THREAD_COUNT];
-static int             thread_count = 0;
-static pthread_mutex_t thread_count_lock = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t  thread_count_cond = PTHREAD_COND_INITIALIZER;
-
+static pthread_t       master_thread_id = 0;
+static pthread_t       worker_thread_id[RPC_WORKER_COUNT];
+static List            work_queue  = NULL;	/* readable connections */
+static List            rearm_queue = NULL;	/* serviced connections */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  queue_cond = PTHREAD_COND_INITIALIZER;
+static int             rearm_fd[2] = {-1, -1};	/* wake poll for re-arm */
+
+/* Poll set, accessed only from rpc_mgr() */
+static rpc_conn_t    **poll_conns = NULL;
+static int             poll_conn_cnt = 0, poll_conn_size = 0;
 
 /* Process incoming RPCs. Meant to execute as a pthread */
 extern void *rpc_mgr(void *no_data)
 {
-	pthread_attr_t thread_attr_rpc_req;
+	pthread_attr_t thread_attr;
+	struct pollfd *ufds = NULL;
+	int ufds_size = 0;
 	int sockfd, newsockfd;
-	int i, retry_cnt, sigarray[] = {SIGUSR1, 0};
+	int i, nfds, rc, sigarray[] = {SIGUSR1, 0};
 	slurm_addr_t cli_addr;
-	slurmdbd_conn_t *conn_arg = NULL;
+	rpc_conn_t *rpc_conn = NULL;
 
-	slurm_mutex_lock(&thread_count_lock);
+	slurm_mutex_lock(&queue_lock);
 	master_thread_id = pthread_self();
-	slurm_mutex_unlock(&thread_count_lock);
+	slurm_mutex_unlock(&queue_lock);
 
 	(void) pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 	(void) pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
 
-	/* threads to process individual RPC's are detached */
-	slurm_attr_init(&thread_attr_rpc_req);
-	if (pthread_attr_setdetachstate
-	    (&thread_attr_rpc_req, PTHREAD_CREATE_DETACHED))
-		fatal("pthread_attr_setdetachstate %m");
+	work_queue  = list_create(NULL);
+	rearm_queue = list_create(NULL);
+	if (pipe(rearm_fd) < 0)
+		fatal("pipe: %m");
+	fd_set_nonblocking(rearm_fd[0]);
+	fd_set_nonblocking(rearm_fd[1]);
 
 	/* initialize port for RPCs */
 	if ((sockfd = slurm_init_msg_engine_port(get_dbd_port()))
 	    == SLURM_SOCKET_ERROR)
 		fatal("slurm_init_msg_engine_port error %m");
 
-	/* Prepare to catch SIGUSR1 to interrupt accept().
+	/* Prepare to catch SIGUSR1 to interrupt poll().
 	 * This signal is generated by the slurmdbd signal
 	 * handler thread upon receipt of SIGABRT, SIGINT,
 	 * or SIGTERM. That thread does all processing of
@@ -118,10 +145,79 @@ extern void *rpc_mgr(void *no_data)
 	xsignal(SIGUSR1, _sig_handler);
 	xsignal_unblock(sigarray);
 
+	/* Spawn the worker pool after unblocking SIGUSR1 so the workers
+	 * inherit a signal mask allowing their I/O to be interrupted */
+	slurm_attr_init(&thread_attr);
+	for (i = 0; i < RPC_WORKER_COUNT; i++) {
+		slurm_mutex_lock(&queue_lock);
+		if (pthread_create(&worker_thread_id[i], &thread_attr,
+				   _rpc_worker, NULL))
+			fatal("pthread_create: %m");
+		slurm_mutex_unlock(&queue_lock);
+	}
+	slurm_attr_destroy(&thread_attr);
+
 	/*
-	 * Process incoming RPCs until told to shutdown
+	 * Watch all idle connections plus the listening socket and hand
+	 * readable connections to the worker pool until told to shutdown
 	 */
-	while ((i = _wait_for_server_thread()) >= 0) {
+	while (!shutdown_time) {
+		nfds = poll_conn_cnt + 2;
+		if (nfds > ufds_size) {
+			ufds_size = nfds;
+			xrealloc(ufds, ufds_size * sizeof(struct pollfd));
+		}
+		ufds[0].fd      = sockfd;
+		ufds[0].events  = POLLIN;
+		ufds[0].revents = 0;
+		ufds[1].fd      = rearm_fd[0];
+		ufds[1].events  = POLLIN;
+		ufds[1].revents = 0;
+		for (i = 0; i < poll_conn_cnt; i++) {
+			ufds[i+2].fd      = poll_conns[i]->conn->newsockfd;
+			ufds[i+2].events  = POLLIN;
+			ufds[i+2].revents = 0;
+		}
+
+		rc = poll(ufds, nfds, -1);
+		if (shutdown_time)
+			break;
+		if (rc < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			error("poll: %m");
+			break;
+		}
+
+		/* Queue connections with pending data (or errors, the
+		 * worker runs the close logic) for the worker pool.
+		 * Scan backwards so removing entry i only moves
+		 * entries already examined. */
+		for (i = poll_conn_cnt - 1; i >= 0; i--) {
+			if (ufds[i+2].revents == 0)
+				continue;
+			rpc_conn = poll_conns[i];
+			poll_conns[i] = poll_conns[--poll_conn_cnt];
+			slurm_mutex_lock(&queue_lock);
+			list_enqueue(work_queue, rpc_conn);
+			slurm_cond_signal(&queue_cond);
+			slurm_mutex_unlock(&queue_lock);
+		}
+
+		/* Return serviced connections to the poll set */
+		if (ufds[1].revents & POLLIN) {
+			char drain[64];
+			while (read(rearm_fd[0], drain, sizeof(drain)) > 0)
+				;
+			slurm_mutex_lock(&queue_lock);
+			while ((rpc_conn = list_dequeue(rearm_queue)))
+				_poll_add(rpc_conn);
+			slurm_mutex_unlock(&queue_lock);
+		}
+
+		if ((ufds[0].revents & POLLIN) == 0)
+			continue;
+
 		/*
 		 * accept needed for stream implementation is a no-op in
 		 * message implementation that just passes sockfd to newsockfd
@@ -129,132 +225,203 @@ extern void *rpc_mgr(void *no_data)
 		if ((newsockfd = slurm_accept_msg_conn(sockfd,
 						       &cli_addr)) ==
 		    SLURM_SOCKET_ERROR) {
-			_free_server_thread((pthread_t) 0);
 			if (errno != EINTR)
 				error("slurm_accept_msg_conn: %m");
 			continue;
 		}
 		fd_set_nonblocking(newsockfd);
 
-		conn_arg = xmalloc(sizeof(slurmdbd_conn_t));
-		conn_arg->newsockfd = newsockfd;
-		slurm_get_ip_str(&cli_addr, &conn_arg->orig_port,
-				 conn_arg->ip, sizeof(conn_arg->ip));
-		retry_cnt = 0;
-		while (pthread_create(&slave_thread_id[i],
-				      &thread_attr_rpc_req,
-				      _service_connection,
-				      (void *) conn_arg)) {
-			if (retry_cnt > 0) {
-				error("pthread_create failure, "
-				      "aborting RPC: %m");
-				close(newsockfd);
-				break;
-			}
-			error("pthread_create failure: %m");
-			retry_cnt++;
-			usleep(1000);	/* retry in 1 msec */
-		}
+		rpc_conn = xmalloc(sizeof(rpc_conn_t));
+		rpc_conn->conn = xmalloc(sizeof(slurmdbd_conn_t));
+		rpc_conn->conn->newsockfd = newsockfd;
+		rpc_conn->first = true;
+		rpc_conn->uid = NO_VAL;
+		slurm_get_ip_str(&cli_addr, &rpc_conn->conn->orig_port,
+				 rpc_conn->conn->ip,
+				 sizeof(rpc_conn->conn->ip));
+		debug2("Opened connection %d from %s", newsockfd,
+		       rpc_conn->conn->ip);
+		_poll_add(rpc_conn);
 	}
 
 	debug3("rpc_mgr shutting down");
-	slurm_attr_destroy(&thread_attr_rpc_req);
 	(void) slurm_shutdown_msg_engine(sockfd);
-	_wait_for_thread_fini();
+
+	/* The workers drain the work queue, failing each request since
+	 * shutdown_time is set, then exit */
+	slurm_mutex_lock(&queue_lock);
+	slurm_cond_broadcast(&queue_cond);
+	slurm_mutex_unlock(&queue_lock);
+	for (i = 0; i < RPC_WORKER_COUNT; i++)
+		pthread_join(worker_thread_id[i], NULL);
+
+	/* Commit and close the connections nobody was servicing */
+	for (i = 0; i < poll_conn_cnt; i++)
+		_close_connection(poll_conns[i]);
+	poll_conn_cnt = 0;
+	while ((rpc_conn = list_dequeue(work_queue)))
+		_close_connection(rpc_conn);
+	while ((rpc_conn = list_dequeue(rearm_queue)))
+		_close_connection(rpc_conn);
+	FREE_NULL_LIST(work_queue);
+	FREE_NULL_LIST(rearm_queue);
+	xfree(poll_conns);
+	poll_conn_size = 0;
+	xfree(ufds);
+	close(rearm_fd[0]);
+	close(rearm_fd[1]);
+
 	pthread_exit((void *) 0);
 	return NULL;
 }
 
-/* Wake up the RPC manager and all spawned threads so they can exit */
+/* Wake up the RPC manager and all worker threads so they can exit */
 extern void rpc_mgr_wake(void)
 {
 	int i;
 
-	slurm_mutex_lock(&thread_count_lock);
+	slurm_mutex_lock(&queue_lock);
 	if (master_thread_id)
 		pthread_kill(master_thread_id, SIGUSR1);
-	for (i=0; i<MAX_THREAD_COUNT; i++) {
-		if (slave_thread_id[i])
-			pthread_kill(slave_thread_id[i], SIGUSR1);
+	for (i=0; i<RPC_WORKER_COUNT; i++) {
+		if (worker_thread_id[i])
+			pthread_kill(worker_thread_id[i], SIGUSR1);
 	}
-	slurm_mutex_unlock(&thread_count_lock);
+	slurm_cond_broadcast(&queue_cond);
+	slurm_mutex_unlock(&queue_lock);
 }
 
-static void * _service_connection(void *arg)
+/* Grow the poll set with another idle connection */
+static void _poll_add(rpc_conn_t *rpc_conn)
 {
-	slurmdbd_conn_t *conn = (slurmdbd_conn_t *) arg;
-	uint32_t nw_size = 0, msg_size = 0, uid = NO_VAL;
+	if (poll_conn_cnt >= poll_conn_size) {
+		poll_conn_size += 16;
+		xrealloc(poll_conns, poll_conn_size * sizeof(rpc_conn_t *));
+	}
+	poll_conns[poll_conn_cnt++] = rpc_conn;
+}
+
+/* Hand a serviced connection back to the RPC manager's poll set */
+static void _rearm_connection(rpc_conn_t *rpc_conn)
+{
+	char byte = 0;
+
+	slurm_mutex_lock(&queue_lock);
+	list_enqueue(rearm_queue, rpc_conn);
+	slurm_mutex_unlock(&queue_lock);
+	if ((write(rearm_fd[1], &byte, 1) < 0) && (errno != EAGAIN)) {
+		/* EAGAIN means the pipe is full, so a wakeup is
+		 * already pending and the entry will be seen */
+		error("write to rpc_mgr re-arm pipe: %m");
+	}
+}
+
+/* Worker pool thread, services one request at a time off any connection */
+static void * _rpc_worker(void *arg)
+{
+	rpc_conn_t *rpc_conn;
+
+	while (1) {
+		slurm_mutex_lock(&queue_lock);
+		while (!shutdown_time && (list_count(work_queue) == 0))
+			slurm_cond_wait(&queue_cond, &queue_lock);
+		rpc_conn = list_dequeue(work_queue);
+		slurm_mutex_unlock(&queue_lock);
+		if (!rpc_conn)	/* shutdown and the queue is drained */
+			break;
+
+		if (_service_request(rpc_conn) == SLURM_SUCCESS)
+			_rearm_connection(rpc_conn);
+		else
+			_close_connection(rpc_conn);
+	}
+	return NULL;
+}
+
+/* Read and process a single message from a connection with pending data,
+ * RET SLURM_SUCCESS if the connection should be kept open */
+static int _service_request(rpc_conn_t *rpc_conn)
+{
+	slurmdbd_conn_t *conn = rpc_conn->conn;
+	uint32_t nw_size = 0, msg_size = 0;
 	char *msg = NULL;
 	ssize_t msg_read = 0, offset = 0;
-	bool fini = false, first = true;
+	bool fini = false;
 	Buf buffer = NULL;
 	int rc = SLURM_SUCCESS;
 
-	debug2("Opened connection %d from %s", conn->newsockfd, conn->ip);
+	if (!_fd_readable(conn->newsockfd))
+		return SLURM_ERROR;	/* problem with this socket */
+	msg_read = read(conn->newsockfd, &nw_size, sizeof(nw_size));
+	if (msg_read == 0)	/* EOF */
+		return SLURM_ERROR;
+	if (msg_read != sizeof(nw_size)) {
+		error("Could not read msg_size from "
+		      "connection %d(%s) uid(%d)",
+		      conn->newsockfd, conn->ip, rpc_conn->uid);
+		return SLURM_ERROR;
+	}
+	msg_size = ntohl(nw_size);
+	if ((msg_size < 2) || (msg_size > MAX_MSG_SIZE)) {
+		error("Invalid msg_size (%u) from "
+		      "connection %d(%s) uid(%d)",
+		      msg_size, conn->newsockfd, conn->ip, rpc_conn->uid);
+		return SLURM_ERROR;
+	}
 
-	while (!fini) {
+	msg = xmalloc(msg_size);
+	offset = 0;
+	while (msg_size > offset) {
 		if (!_fd_readable(conn->newsockfd))
 			break;		/* problem with this socket */
-		msg_read = read(conn->newsockfd, &nw_size, sizeof(nw_size));
-		if (msg_read == 0)	/* EOF */
-			break;
-		if (msg_read != sizeof(nw_size)) {
-			error("Could not read msg_size from "
-			      "connection %d(%s) uid(%d)",
-			      conn->newsockfd, conn->ip, uid);
+		msg_read = read(conn->newsockfd, (msg + offset),
+				(msg_size - offset));
+		if (msg_read <= 0) {
+			error("read(%d): %m", conn->newsockfd);
 			break;
 		}
-		msg_size = ntohl(nw_size);
-		if ((msg_size < 2) || (msg_size > MAX_MSG_SIZE)) {
-			error("Invalid msg_size (%u) from "
+		offset += msg_read;
+	}
+	if (msg_size == offset) {
+		rc = proc_req(conn, msg, msg_size, rpc_conn->first,
+			      &buffer, &rpc_conn->uid);
+		rpc_conn->first = false;
+		if (rc != SLURM_SUCCESS && rc != ACCOUNTING_FIRST_REG) {
+			error("Processing last message from "
 			      "connection %d(%s) uid(%d)",
-			      msg_size, conn->newsockfd, conn->ip, uid);
-			break;
-		}
-
-		msg = xmalloc(msg_size);
-		offset = 0;
-		while (msg_size > offset) {
-			if (!_fd_readable(conn->newsockfd))
-				break;		/* problem with this socket */
-			msg_read = read(conn->newsockfd, (msg + offset),
-					(msg_size - offset));
-			if (msg_read <= 0) {
-				error("read(%d): %m", conn->newsockfd);
-				break;
-			}
-			offset += msg_read;
-		}
-		if (msg_size == offset) {
-			rc = proc_req(
-				conn, msg, msg_size, first, &buffer, &uid);
-			first = false;
-			if (rc != SLURM_SUCCESS && rc != ACCOUNTING_FIRST_REG) {
-				error("Processing last message from "
-				      "connection %d(%s) uid(%d)",
-				      conn->newsockfd, conn->ip, uid);
-				if (rc == ESLURM_ACCESS_DENIED
-				    || rc == SLURM_PROTOCOL_VERSION_ERROR)
-					fini = true;
-			}
-		} else {
-			buffer = make_dbd_rc_msg(conn->rpc_version,
-						 SLURM_ERROR, "Bad offset", 0);
-			fini = true;
+			      conn->newsockfd, conn->ip, rpc_conn->uid);
+			if (rc == ESLURM_ACCESS_DENIED
+			    || rc == SLURM_PROTOCOL_VERSION_ERROR)
+				fini = true;
 		}
+	} else {
+		buffer = make_dbd_rc_msg(conn->rpc_version,
+					 SLURM_ERROR, "Bad offset", 0);
+		fini = true;
+	}
 
-		if (_send_resp(conn->newsockfd, buffer) != SLURM_SUCCESS) {
-			/* This is only an issue on persistent connections, and
-			 * really isn't that big of a deal as the slurmctld
-			 * will just send the message again. */
-			if (conn->ctld_port)
-				debug("Problem sending response to "
-				      "connection %d(%s) uid(%d)",
-				      conn->newsockfd, conn->ip, uid);
-			fini = true;
-		}
-		xfree(msg);
+	if (_send_resp(conn->newsockfd, buffer) != SLURM_SUCCESS) {
+		/* This is only an issue on persistent connections, and
+		 * really isn't that big of a deal as the slurmctld
+		 * will just send the message again. */
+		if (conn->ctld_port)
+			debug("Problem sending response to "
+			      "connection %d(%s) uid(%d)",
+			      conn->newsockfd, conn->ip, rpc_conn->uid);
+		fini = true;
 	}
+	xfree(msg);
+
+	if (fini)
+		return SLURM_ERROR;
+	return SLURM_SUCCESS;
+}
+
+/* Drop a connection, unregistering its cluster and committing its
+ * pending database work */
+static void _close_connection(rpc_conn_t *rpc_conn)
+{
+	slurmdbd_conn_t *conn = rpc_conn->conn;
 
 	if (conn->ctld_port) {
 		if (!shutdown_time) {
@@ -291,13 +458,13 @@ static void * _service_connection(void *arg)
 	if (slurm_close(conn->newsockfd) < 0)
 		error("close(%d): %m(%s)",  conn->newsockfd, conn->ip);
 	else
-		debug2("Closed connection %d uid(%d)", conn->newsockfd, uid);
+		debug2("Closed connection %d uid(%d)", conn->newsockfd,
+		       rpc_conn->uid);
 
 	xfree(conn->tres_str);
 	xfree(conn->cluster_name);
 	xfree(conn);
-	_free_server_thread(pthread_self());
-	return NULL;
+	xfree(rpc_conn);
 }
 
 /* Return a buffer containing a DBD_RC (return code) message
@@ -463,134 +630,6 @@ extern bool fd_writeable(int fd)
 	return true;
 }
 
-/* Increment thread_count and don't return until its value is no larger
- *	than MAX_THREAD_COUNT,
- * RET index of free index in slave_pthread_id or -1 to exit */
-static int _wait_for_server_thread(void)
-{
-	bool print_it = true;
-	int i, rc = -1;
-
-	slurm_mutex_lock(&thread_count_lock);
-	while (1) {
-		if (shutdown_time)
-			break;
-
-		if (thread_count < MAX_THREAD_COUNT) {
-			thread_count++;
-			for (i=0; i<MAX_THREAD_COUNT; i++) {
-				if (slave_thread_id[i])
-					continue;
-				rc = i;
-				break;
-			}
-			if (rc == -1) {
-				/* thread_count and slave_thread_id
-				 * out of sync */
-				fatal("No free slave_thread_id");
-			}
-			break;
-		} else {
-			/* wait for state change and retry,
-			 * just a delay and not an error.
-			 * This can happen when the epilog completes
-			 * on a bunch of nodes at the same time, which
-			 * can easily happen for highly parallel jobs. */
-			if (print_it) {
-				static time_t last_print_time = 0;
-				time_t now = time(NULL);
-				if (difftime(now, last_print_time) > 2) {
-					verbose("thread_count over "
-						"limit (%d), waiting",
-						thread_count);
-					last_print_time = now;
-				}
-				print_it = false;
-			}
-			slurm_cond_wait(&thread_count_cond, &thread_count_lock);
-		}
-	}
-	slurm_mutex_unlock(&thread_count_lock);
-	return rc;
-}
-
-/* my_tid IN - Thread ID of spawned thread, 0 if no thread spawned */
-static void _free_server_thread(pthread_t my_tid)
-{
-	int i;
-
-	slurm_mutex_lock(&thread_count_lock);
-	if (thread_count > 0)
-		thread_count--;
-	else
-		error("thread_count underflow");
-
-	if (my_tid) {
-		for (i=0; i<MAX_THREAD_COUNT; i++) {
-			if (slave_thread_id[i] != my_tid)
-				continue;
-			slave_thread_id[i] = (pthread_t) 0;
-			break;
-		}
-		if (i >= MAX_THREAD_COUNT)
-			error("Could not find slave_thread_id");
-	}
-
-	slurm_cond_broadcast(&thread_count_cond);
-	slurm_mutex_unlock(&thread_count_lock);
-}
-
-/* Wait for all RPC handler threads to exit.
- * After one second, start sending SIGKILL to the threads. */
-static void _wait_for_thread_fini(void)
-{
-	int j;
-
-	if (thread_count == 0)
-		return;
-	usleep(500000);	/* Give the threads 500 msec to clean up */
-
-	/* Interupt any hung I/O */
-	slurm_mutex_lock(&thread_count_lock);
-	for (j=0; j<MAX_THREAD_COUNT; j++) {
-		if (slave_thread_id[j] == 0)
-			continue;
-		pthread_kill(slave_thread_id[j], SIGUSR1);
-	}
-	slurm_mutex_unlock(&thread_count_lock);
-
-	/* Can't send SIGKILL to threads as it goes to the process. Since this
-	 * is called only when the rpc_mgr is quitting, just let the threads die
-	 * by the dbd dying.  If it's the backup and it's giving up control, let
-	 * the threads finish. thread_count will be decremented when the thread
-	 * finishes -- even if the rpc_mgr is gone.
-	 */
-	/*usleep(100000); */	/* Give the threads 100 msec to clean up */
-	/*
-	for (i=0; ; i++) {
-		if (thread_count == 0)
-			return;
-
-		slurm_mutex_lock(&thread_count_lock);
-		for (j=0; j<MAX_THREAD_COUNT; j++) {
-			if (slave_thread_id[j] == 0)
-				continue;
-			info("rpc_mgr sending SIGKILL to thread %lu",
-			     (unsigned long) slave_thread_id[j]);
-			if (pthread_kill(slave_thread_id[j], SIGKILL)) {
-				slave_thread_id[j] = 0;
-				if (thread_count > 0)
-					thread_count--;
-				else
-					error("thread_count underflow");
-			}
-		}
-		slurm_mutex_unlock(&thread_count_lock);
-		sleep(1);
-	}
-	*/
-}
-
 static void _sig_handler(int signal)
 {
 }
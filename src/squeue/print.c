@@ -71,6 +71,53 @@ static int	_print_str(char *str, int width, bool right, bool cut_output);
 
 static partition_info_msg_t *part_info_msg = NULL;
 
+/* The format list is compiled once into a flat op array so printing a
+ * row walks plain memory rather than creating a list iterator per row */
+static job_format_t  *compiled_job_format  = NULL;
+static int compiled_job_format_cnt  = 0;
+static List compiled_job_format_list  = NULL;
+static step_format_t *compiled_step_format = NULL;
+static int compiled_step_format_cnt = 0;
+static List compiled_step_format_list = NULL;
+
+static void _compile_job_format(List list)
+{
+	ListIterator iter;
+	job_format_t *current;
+	int inx = 0;
+
+	if (compiled_job_format_list == list)
+		return;
+	xfree(compiled_job_format);
+	compiled_job_format_cnt = list_count(list);
+	compiled_job_format = xmalloc(sizeof(job_format_t) *
+				      compiled_job_format_cnt);
+	iter = list_iterator_create(list);
+	while ((current = (job_format_t *) list_next(iter)))
+		compiled_job_format[inx++] = *current;
+	list_iterator_destroy(iter);
+	compiled_job_format_list = list;
+}
+
+static void _compile_step_format(List list)
+{
+	ListIterator iter;
+	step_format_t *current;
+	int inx = 0;
+
+	if (compiled_step_format_list == list)
+		return;
+	xfree(compiled_step_format);
+	compiled_step_format_cnt = list_count(list);
+	compiled_step_format = xmalloc(sizeof(step_format_t) *
+				       compiled_step_format_cnt);
+	iter = list_iterator_create(list);
+	while ((current = (step_format_t *) list_next(iter)))
+		compiled_step_format[inx++] = *current;
+	list_iterator_destroy(iter);
+	compiled_step_format_list = list;
+}
+
 /*****************************************************************************
  * Global Print Functions
  *****************************************************************************/
@@ -400,22 +447,18 @@ int _print_time(time_t t, int level, int width, bool right)
  *****************************************************************************/
 static int _print_one_job_from_format(job_info_t * job, List list)
 {
-	ListIterator iter = list_iterator_create(list);
 	job_format_t *current;
-	int total_width = 0;
+	int inx;
 
-	while ((current = (job_format_t *) list_next(iter)) != NULL) {
+	_compile_job_format(list);
+	for (inx = 0; inx < compiled_job_format_cnt; inx++) {
+		current = &compiled_job_format[inx];
 		if (current->
 		    function(job, current->width, current->right_justify,
 			     current->suffix)
 		    != SLURM_SUCCESS)
 			return SLURM_ERROR;
-		if (current->width)
-			total_width += (current->width + 1);
-		else
-			total_width += 10;
 	}
-	list_iterator_destroy(iter);
 
 	printf("\n");
 	return SLURM_SUCCESS;
@@ -1974,32 +2017,19 @@ int _print_job_mcs_label(job_info_t * job, int width,
  *****************************************************************************/
 int print_step_from_format(job_step_info_t * job_step, List list)
 {
-	ListIterator i = list_iterator_create(list);
 	step_format_t *current;
-	int total_width = 0;
+	int inx;
 
-	while ((current = (step_format_t *) list_next(i)) != NULL) {
+	_compile_step_format(list);
+	for (inx = 0; inx < compiled_step_format_cnt; inx++) {
+		current = &compiled_step_format[inx];
 		if (current->
 		    function(job_step, current->width,
 			     current->right_justify, current->suffix)
 		    != SLURM_SUCCESS)
 			return SLURM_ERROR;
-		if (current->width)
-			total_width += current->width;
-		else
-			total_width += 10;
 	}
-	list_iterator_destroy(i);
 	printf("\n");
-#if 0
-	if (job_step == NULL) {
-		int inx;
-		/* one-origin for no trailing space */
-		for (inx=1; inx<total_width; inx++)
-			printf("-");
-		printf("\n");
-	}
-#endif
 	return SLURM_SUCCESS;
 }
 
@@ -171,10 +171,56 @@ _print_job ( bool clear_old )
 	job_info_msg_t *new_job_ptr;
 	int error_code;
 	uint16_t show_flags = 0;
+	uint32_t *filter_job_ids = NULL, *filter_states = NULL;
+	uint32_t *filter_users = NULL;
+	uint32_t filter_job_cnt = 0, filter_state_cnt = 0, filter_user_cnt = 0;
+	char *filter_parts = NULL;
+	ListIterator iterator;
 
 	if (params.all_flag || (params.job_list && list_count(params.job_list)))
 		show_flags |= SHOW_ALL;
 
+	/* Hand the simple filters to the controller so it only packs
+	 * the matching jobs.  The full filtering of whatever comes
+	 * back still happens in _filter_job(). */
+	if (params.job_list && list_count(params.job_list)) {
+		squeue_job_step_t *job_step_id;
+		filter_job_ids = xmalloc(sizeof(uint32_t) *
+					 list_count(params.job_list));
+		iterator = list_iterator_create(params.job_list);
+		while ((job_step_id = list_next(iterator)))
+			filter_job_ids[filter_job_cnt++] =
+				job_step_id->job_id;
+		list_iterator_destroy(iterator);
+	}
+	if (params.state_list && list_count(params.state_list)) {
+		uint32_t *state_id;
+		filter_states = xmalloc(sizeof(uint32_t) *
+					list_count(params.state_list));
+		iterator = list_iterator_create(params.state_list);
+		while ((state_id = list_next(iterator)))
+			filter_states[filter_state_cnt++] = *state_id;
+		list_iterator_destroy(iterator);
+	}
+	if (params.user_list && list_count(params.user_list)) {
+		uint32_t *user;
+		filter_users = xmalloc(sizeof(uint32_t) *
+				       list_count(params.user_list));
+		iterator = list_iterator_create(params.user_list);
+		while ((user = list_next(iterator)))
+			filter_users[filter_user_cnt++] = *user;
+		list_iterator_destroy(iterator);
+	}
+	if (params.part_list && list_count(params.part_list)) {
+		char *part;
+		iterator = list_iterator_create(params.part_list);
+		while ((part = list_next(iterator))) {
+			xstrfmtcat(filter_parts, "%s%s",
+				   filter_parts ? "," : "", part);
+		}
+		list_iterator_destroy(iterator);
+	}
+
 	/* We require detail data when CPUs are requested */
 	if (params.format && strstr(params.format, "C"))
 		show_flags |= SHOW_DETAIL;
@@ -191,9 +237,13 @@ _print_job ( bool clear_old )
 							 params.user_id,
 							 show_flags);
 		} else {
-			error_code = slurm_load_jobs(
+			error_code = slurm_load_jobs_filtered(
 				old_job_ptr->last_update,
-				&new_job_ptr, show_flags);
+				&new_job_ptr, show_flags,
+				filter_job_ids, filter_job_cnt,
+				filter_parts,
+				filter_states, filter_state_cnt,
+				filter_users, filter_user_cnt);
 		}
 		if (error_code ==  SLURM_SUCCESS)
 			slurm_free_job_info_msg( old_job_ptr );
@@ -208,9 +258,16 @@ _print_job ( bool clear_old )
 		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
 						 show_flags);
 	} else {
-		error_code = slurm_load_jobs((time_t) NULL, &new_job_ptr,
-					     show_flags);
+		error_code = slurm_load_jobs_filtered(
+			(time_t) NULL, &new_job_ptr, show_flags,
+			filter_job_ids, filter_job_cnt, filter_parts,
+			filter_states, filter_state_cnt,
+			filter_users, filter_user_cnt);
 	}
+	xfree(filter_job_ids);
+	xfree(filter_parts);
+	xfree(filter_states);
+	xfree(filter_users);
 
 	if (error_code) {
 		slurm_perror ("slurm_load_jobs error");
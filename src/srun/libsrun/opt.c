@@ -198,6 +198,7 @@
 #define LONG_OPT_ACCEL_BIND      0x161
 #define LONG_OPT_MCS_LABEL       0x165
 #define LONG_OPT_DEADLINE        0x166
+#define LONG_OPT_BCAST_LIBS      0x167
 
 extern char **environ;
 
@@ -453,6 +454,7 @@ static void _opt_default(void)
 	opt.export_env = NULL;
 	opt.bcast_flag = false;
 	opt.bcast_file = NULL;
+	opt.bcast_libs = NULL;
 	opt.no_kill = false;
 	opt.kill_bad_exit = NO_VAL;
 
@@ -565,6 +567,7 @@ env_vars_t env_vars[] = {
 {"SLURM_ACCOUNT",       OPT_STRING,     &opt.account,       NULL             },
 {"SLURM_ACCTG_FREQ",    OPT_STRING,     &opt.acctg_freq,    NULL             },
 {"SLURM_BCAST",         OPT_BCAST,      NULL,               NULL             },
+{"SLURM_BCAST_LIBS",    OPT_STRING,     &opt.bcast_libs,    NULL             },
 {"SLURM_BLRTS_IMAGE",   OPT_STRING,     &opt.blrtsimage,    NULL             },
 {"SLURM_BURST_BUFFER",  OPT_STRING,     &opt.burst_buffer,  NULL             },
 {"SLURM_CHECKPOINT",    OPT_STRING,     &opt.ckpt_interval_str, NULL         },
@@ -935,6 +938,7 @@ static void _set_options(const int argc, char **argv)
 		{"bb",               required_argument, 0, LONG_OPT_BURST_BUFFER_SPEC},
 		{"bbf",              required_argument, 0, LONG_OPT_BURST_BUFFER_FILE},
 		{"bcast",            optional_argument, 0, LONG_OPT_BCAST},
+		{"bcast-libs",       required_argument, 0, LONG_OPT_BCAST_LIBS},
 		{"begin",            required_argument, 0, LONG_OPT_BEGIN},
 		{"blrts-image",      required_argument, 0, LONG_OPT_BLRTS_IMAGE},
 		{"checkpoint",       required_argument, 0, LONG_OPT_CHECKPOINT},
@@ -1304,6 +1308,11 @@ static void _set_options(const int argc, char **argv)
 			}
 			opt.bcast_flag = true;
                         break;
+                case LONG_OPT_BCAST_LIBS:
+			xfree(opt.bcast_libs);
+			opt.bcast_libs = xstrdup(optarg);
+			opt.bcast_flag = true;
+                        break;
                 case LONG_OPT_CPU_BIND:
 			if (slurm_verify_cpu_bind(optarg, &opt.cpu_bind,
 						  &opt.cpu_bind_type))
@@ -1907,6 +1916,8 @@ static void _opt_args(int argc, char **argv)
 	}
 #else
 	(void) launch_g_handle_multi_prog_verify(command_pos);
+	if (opt.bcast_libs)	/* library staging implies --bcast */
+		opt.bcast_flag = true;
 	if (test_exec || opt.bcast_flag) {
 		if ((fullpath = search_path(opt.cwd, opt.argv[command_pos],
 					    false, X_OK, true))) {
@@ -2550,6 +2561,8 @@ static void _opt_list(void)
 		info("bcast          : %s", opt.bcast_file);
 	else
 		info("bcast          : %s", tf_(opt.bcast_flag));
+	if (opt.bcast_libs)
+		info("bcast-libs     : %s", opt.bcast_libs);
 	info("qos            : %s", opt.qos);
 	if (opt.shared != (uint16_t) NO_VAL)
 		info("oversubscribe  : %u", opt.shared);
@@ -2721,7 +2734,8 @@ static void _usage(void)
 "            [--switches=max-switches{@max-time-to-wait}] [--reboot]\n"
 "            [--core-spec=cores] [--thread-spec=threads]\n"
 "            [--bb=burst_buffer_spec] [--bbf=burst_buffer_file]\n"
-"            [--bcast=<dest_path>] [--compress[=library]]\n"
+"            [--bcast=<dest_path>] [--bcast-libs=<files>]\n"
+"            [--compress[=library]]\n"
 "            [--acctg-freq=<datatype>=<interval>]\n"
 "            [-w hosts...] [-x hosts...] executable [args...]\n");
 
@@ -2743,6 +2757,8 @@ static void _help(void)
 "      --bb=<spec>             burst buffer specifications\n"
 "      --bbf=<file_name>       burst buffer specification file\n"
 "      --bcast=<dest_path>     Copy executable file to compute nodes\n"
+"      --bcast-libs=<files>    Copy listed libraries to compute nodes along\n"
+"                              with the executable (comma separated)\n"
 "      --begin=time            defer job until HH:MM MM/DD/YY\n"
 "  -c, --cpus-per-task=ncpus   number of cpus required per task\n"
 "      --checkpoint=time       job step checkpoint interval\n"
@@ -113,6 +113,8 @@ typedef struct srun_options {
 	uint16_t compress;	/* --compress (for --bcast option) */
 	char *bcast_file;	/* --bcast, copy executable to compute nodes */
 	bool bcast_flag;	/* --bcast, copy executable to compute nodes */
+	char *bcast_libs;	/* --bcast-libs, comma separated libraries to
+				 * stage along with the executable */
 	int  resv_port_cnt;	/* --resv_ports			*/
 	char *partition;	/* --partition=n,   -p n   	*/
 	enum task_dist_states
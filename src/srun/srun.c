@@ -278,6 +278,7 @@ relaunch:
 static int _file_bcast(void)
 {
 	struct bcast_parameters *params;
+	char *dst_dir, *sep, *libs, *tok, *save_ptr = NULL, *ld_path;
 	int rc;
 
 	if ((opt.argc == 0) || (opt.argv[0] == NULL)) {
@@ -290,8 +291,11 @@ static int _file_bcast(void)
 	if (opt.bcast_file) {
 		params->dst_fname = xstrdup(opt.bcast_file);
 	} else {
-		xstrfmtcat(params->dst_fname, "%s/slurm_bcast_%u.%u",
-			   opt.cwd, job->jobid, job->stepid);
+		/* name the destination after the executable rather than
+		 * the step so that repeated launches of the same binary
+		 * hit the file cache on the compute nodes */
+		xstrfmtcat(params->dst_fname, "%s/slurm_bcast_%u_%s",
+			   opt.cwd, job->jobid, xbasename(opt.argv[0]));
 	}
 	params->fanout = 0;
 	params->job_id = job->jobid;
@@ -303,11 +307,45 @@ static int _file_bcast(void)
 	params->verbose = 0;
 
 	rc = bcast_file(params);
-	if (rc == SLURM_SUCCESS) {
-		xfree(opt.argv[0]);
-		opt.argv[0] = params->dst_fname;
-	} else {
+	if (rc != SLURM_SUCCESS) {
 		xfree(params->dst_fname);
+		xfree(params);
+		return rc;
+	}
+	xfree(opt.argv[0]);
+	opt.argv[0] = params->dst_fname;
+	params->dst_fname = NULL;
+
+	/* stage any requested libraries next to the executable and point
+	 * the runtime linker at them */
+	if (opt.bcast_libs) {
+		dst_dir = xstrdup(opt.argv[0]);
+		if ((sep = strrchr(dst_dir, '/'))) {
+			sep[0] = '\0';
+		} else {
+			xfree(dst_dir);
+			dst_dir = xstrdup(opt.cwd);
+		}
+		libs = xstrdup(opt.bcast_libs);
+		tok = strtok_r(libs, ",", &save_ptr);
+		while (tok && (rc == SLURM_SUCCESS)) {
+			params->src_fname = tok;
+			xstrfmtcat(params->dst_fname, "%s/%s", dst_dir,
+				   xbasename(tok));
+			rc = bcast_file(params);
+			xfree(params->dst_fname);
+			tok = strtok_r(NULL, ",", &save_ptr);
+		}
+		params->src_fname = NULL;
+		if (rc == SLURM_SUCCESS) {
+			if ((ld_path = getenv("LD_LIBRARY_PATH")))
+				setenvfs("LD_LIBRARY_PATH=%s:%s", dst_dir,
+					 ld_path);
+			else
+				setenvfs("LD_LIBRARY_PATH=%s", dst_dir);
+		}
+		xfree(libs);
+		xfree(dst_dir);
 	}
 	xfree(params);
 
@@ -80,6 +80,41 @@ typedef struct {
 
 GStaticMutex blinking_mutex = G_STATIC_MUTEX_INIT;
 
+/* The node to table position mapping only depends on the node count,
+ * the configured grid dimensions and the topology mode.  Remember what
+ * the current table layout was built from so refresh cycles can skip
+ * the relayout (which repositions every button widget) until one of
+ * those inputs actually changes. */
+static int grid_layout_node_cnt = -1;
+static int grid_layout_width = -1;
+static int grid_layout_hori = -1;
+static int grid_layout_vert = -1;
+static bool grid_layout_topological = false;
+
+static bool _grid_mode_topological(void)
+{
+	return (default_sview_config.grid_topological &&
+		(g_topo_info_msg_ptr != NULL));
+}
+
+static bool _grid_layout_current(int node_cnt)
+{
+	return ((grid_layout_node_cnt == node_cnt) &&
+		(grid_layout_width == working_sview_config.grid_x_width) &&
+		(grid_layout_hori == working_sview_config.grid_hori) &&
+		(grid_layout_vert == working_sview_config.grid_vert) &&
+		(grid_layout_topological == _grid_mode_topological()));
+}
+
+static void _grid_layout_save(int node_cnt)
+{
+	grid_layout_node_cnt = node_cnt;
+	grid_layout_width = working_sview_config.grid_x_width;
+	grid_layout_hori = working_sview_config.grid_hori;
+	grid_layout_vert = working_sview_config.grid_vert;
+	grid_layout_topological = _grid_mode_topological();
+}
+
 static gboolean _mouseover_node(GtkWidget *widget, GdkEventButton *event,
 				grid_button_t *grid_button)
 {
@@ -1241,7 +1276,9 @@ extern void set_grid_used(List button_list, int start, int end,
 			    || (grid_button->inx > end))
 				continue;
 		grid_button->used = used;
-		if (reset_highlight)
+		if (reset_highlight &&
+		    (GTK_WIDGET_STATE(grid_button->button)
+		     != GTK_STATE_NORMAL))
 			gtk_widget_set_state(grid_button->button,
 					     GTK_STATE_NORMAL);
 
@@ -1529,6 +1566,13 @@ extern int update_grid_table(GtkTable *table, List button_list, List node_list)
 		return SLURM_ERROR;
 	}
 
+	/* If nothing the layout depends upon changed since the table
+	 * was last built there is no point repositioning every button;
+	 * the node states are refreshed in place by sview_init_grid()
+	 * and change_grid_color(). */
+	if (_grid_layout_current(list_count(node_list)))
+		return SLURM_SUCCESS;
+
 	if (_init_button_processor(&button_processor, list_count(node_list))
 	    != SLURM_SUCCESS)
 		return SLURM_ERROR;
@@ -1575,6 +1619,8 @@ extern int update_grid_table(GtkTable *table, List button_list, List node_list)
 		inx++;
 	}
 	rc = _add_button_to_list(NULL, &button_processor);
+	if (rc == SLURM_SUCCESS)
+		_grid_layout_save(list_count(node_list));
 
 	/* This is needed to get the correct width of the grid window.
 	 * If it is not given then we get a really narrow window. */
@@ -1642,10 +1688,12 @@ extern int setup_grid_table(GtkTable *table, List button_list, List node_list)
 	gtk_table_resize(table, button_processor.table_y,
 			 working_sview_config.grid_x_width);
 
-	if (default_sview_config.grid_topological && g_topo_info_msg_ptr)
+	if (_grid_mode_topological())
 		rc = _grid_table_by_switch(&button_processor, node_list);
 	else
 		rc = _grid_table_by_list(&button_processor, node_list);
+	if (rc == SLURM_SUCCESS)
+		_grid_layout_save(list_count(node_list));
 
 	list_sort(button_list, (ListCmpF) _sort_button_inx);
 
@@ -1684,8 +1732,13 @@ extern void sview_init_grid(bool reset_highlight)
 			if (grid_button->inx != i)
 				continue;
 			grid_button->state = node_ptr->node_state;
-			gtk_widget_set_state(grid_button->button,
-					     GTK_STATE_NORMAL);
+			/* Only touch the widget if it is not already
+			 * in the normal state; poking every button
+			 * forces a redraw of the whole grid. */
+			if (GTK_WIDGET_STATE(grid_button->button)
+			    != GTK_STATE_NORMAL)
+				gtk_widget_set_state(grid_button->button,
+						     GTK_STATE_NORMAL);
 			grid_button->used = false;
 			break;
 		}
@@ -62,6 +62,8 @@ typedef struct {
 	int node_cnt;
 	char *nodes;
 	int pos;
+	bool row_changed;
+	uint32_t row_sig;
 	bool small_block;
 	List step_list;
 	hostlist_t task_hl;
@@ -575,6 +577,100 @@ static void _job_info_free(sview_job_info_t *sview_job_info)
 	}
 }
 
+static void _sig_str(uint32_t *sig, char *str)
+{
+	while (str && *str)
+		*sig = (*sig ^ (uint8_t) *(str++)) * 16777619;
+}
+
+static void _sig_num(uint32_t *sig, uint64_t num)
+{
+	int i;
+
+	for (i = 0; i < sizeof(num); i++)
+		*sig = (*sig ^ (uint8_t) (num >> (i * 8))) * 16777619;
+}
+
+/* Build a signature of the displayed fields of a job record so
+ * unchanged rows can be left alone on refresh. Rows of jobs that are
+ * running or suspended are always rewritten since their run time
+ * changes every tick, so fields only shown for them may be omitted. */
+static uint32_t _job_record_sig(job_info_t *job_ptr)
+{
+	uint32_t sig = 2166136261u;
+
+	_sig_str(&sig, job_ptr->account);
+	_sig_str(&sig, job_ptr->alloc_node);
+	_sig_num(&sig, job_ptr->alloc_sid);
+	_sig_num(&sig, job_ptr->array_job_id);
+	_sig_num(&sig, job_ptr->array_task_id);
+	_sig_str(&sig, job_ptr->array_task_str);
+	_sig_num(&sig, job_ptr->batch_flag);
+	_sig_str(&sig, job_ptr->batch_host);
+	_sig_str(&sig, job_ptr->burst_buffer);
+	_sig_str(&sig, job_ptr->command);
+	_sig_str(&sig, job_ptr->comment);
+	_sig_num(&sig, job_ptr->contiguous);
+	_sig_num(&sig, job_ptr->core_spec);
+	_sig_num(&sig, job_ptr->cpus_per_task);
+	_sig_num(&sig, job_ptr->deadline);
+	_sig_str(&sig, job_ptr->dependency);
+	_sig_num(&sig, job_ptr->derived_ec);
+	_sig_num(&sig, job_ptr->eligible_time);
+	_sig_num(&sig, job_ptr->end_time);
+	_sig_str(&sig, job_ptr->exc_nodes);
+	_sig_num(&sig, job_ptr->exit_code);
+	_sig_str(&sig, job_ptr->features);
+	_sig_str(&sig, job_ptr->gres);
+	_sig_num(&sig, job_ptr->group_id);
+	_sig_num(&sig, job_ptr->job_state);
+	_sig_str(&sig, job_ptr->licenses);
+	_sig_num(&sig, job_ptr->max_cpus);
+	_sig_num(&sig, job_ptr->max_nodes);
+	_sig_str(&sig, job_ptr->name);
+	_sig_str(&sig, job_ptr->network);
+	_sig_num(&sig, job_ptr->nice);
+	_sig_str(&sig, job_ptr->nodes);
+	_sig_num(&sig, job_ptr->num_cpus);
+	_sig_num(&sig, job_ptr->num_nodes);
+	_sig_num(&sig, job_ptr->num_tasks);
+	_sig_str(&sig, job_ptr->partition);
+	_sig_num(&sig, job_ptr->pn_min_cpus);
+	_sig_num(&sig, job_ptr->pn_min_memory);
+	_sig_num(&sig, job_ptr->pn_min_tmp_disk);
+	_sig_num(&sig, job_ptr->preempt_time);
+	_sig_num(&sig, job_ptr->pre_sus_time);
+	_sig_num(&sig, job_ptr->priority);
+	_sig_str(&sig, job_ptr->qos);
+	_sig_num(&sig, job_ptr->reboot);
+	_sig_str(&sig, job_ptr->req_nodes);
+	_sig_num(&sig, job_ptr->req_switch);
+	_sig_num(&sig, job_ptr->requeue);
+	_sig_num(&sig, job_ptr->resize_time);
+	_sig_num(&sig, job_ptr->restart_cnt);
+	_sig_str(&sig, job_ptr->resv_name);
+	_sig_str(&sig, job_ptr->sched_nodes);
+	_sig_num(&sig, job_ptr->shared);
+	_sig_num(&sig, job_ptr->start_time);
+	_sig_str(&sig, job_ptr->state_desc);
+	_sig_num(&sig, job_ptr->state_reason);
+	_sig_str(&sig, job_ptr->std_err);
+	_sig_str(&sig, job_ptr->std_in);
+	_sig_str(&sig, job_ptr->std_out);
+	_sig_num(&sig, job_ptr->submit_time);
+	_sig_num(&sig, job_ptr->suspend_time);
+	_sig_num(&sig, job_ptr->time_limit);
+	_sig_num(&sig, job_ptr->time_min);
+	_sig_str(&sig, job_ptr->tres_alloc_str);
+	_sig_str(&sig, job_ptr->tres_req_str);
+	_sig_num(&sig, job_ptr->user_id);
+	_sig_num(&sig, job_ptr->wait4switch);
+	_sig_str(&sig, job_ptr->wckey);
+	_sig_str(&sig, job_ptr->work_dir);
+
+	return sig;
+}
+
 static void _job_info_list_del(void *object)
 {
 	sview_job_info_t *sview_job_info = (sview_job_info_t *)object;
@@ -3099,7 +3195,22 @@ static void _update_info_job(List info_list,
 				sview_job_info->iter_set = false;
 			}
 		}
-		if (sview_job_info->iter_set)
+		if (sview_job_info->iter_set &&
+		    !sview_job_info->row_changed &&
+		    !IS_JOB_RUNNING(job_ptr) &&
+		    !IS_JOB_SUSPENDED(job_ptr) &&
+		    !IS_JOB_COMPLETING(job_ptr) &&
+		    (job_ptr->array_task_id == NO_VAL) &&
+		    !job_ptr->array_task_str) {
+			/* Nothing the user can see changed and no run
+			 * time is ticking, so leave the row alone and
+			 * just keep it off the removal list. Array
+			 * records are always rewritten since their
+			 * displayed task lists aggregate siblings. */
+			gtk_tree_store_set(GTK_TREE_STORE(model),
+					   &sview_job_info->iter_ptr,
+					   SORTID_UPDATED, 1, -1);
+		} else if (sview_job_info->iter_set)
 			_update_job_record(sview_job_info,
 					   GTK_TREE_STORE(model), NULL, true,
 					   false);
@@ -3164,6 +3275,7 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 	static job_info_msg_t *last_job_info_ptr = NULL;
 	static job_step_info_response_msg_t *last_step_info_ptr = NULL;
 	int i = 0, j = 0;
+	uint32_t i_sig;
 	sview_job_info_t *sview_job_info_ptr = NULL;
 	job_info_t *job_ptr = NULL;
 	job_step_info_t *step_ptr = NULL;
@@ -3217,6 +3329,14 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 		sview_job_info_ptr->job_ptr = job_ptr;
 		sview_job_info_ptr->job_id = job_ptr->job_id;
 
+		/* notice unchanged records so their rows can be left
+		 * alone. A fresh record has row_sig of zero and is
+		 * always treated as changed. */
+		i_sig = _job_record_sig(job_ptr);
+		sview_job_info_ptr->row_changed =
+			(i_sig != sview_job_info_ptr->row_sig);
+		sview_job_info_ptr->row_sig = i_sig;
+
 		if (job_ptr->array_task_str ||
 		    (job_ptr->array_task_id != NO_VAL)) {
 			char task_str[64];
@@ -3570,6 +3690,50 @@ extern void refresh_job(GtkAction *action, gpointer user_data)
 	specific_info_job(popup_win);
 }
 
+static job_info_msg_t *g_job_staging_ptr = NULL;
+static job_step_info_response_msg_t *g_step_staging_ptr = NULL;
+static pthread_mutex_t g_staging_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Load new job and step info into a staging snapshot without touching
+ * the buffers the display is built from. Called from the page thread
+ * before it takes the gdk lock, so the RPCs do not freeze the GUI.
+ * get_new_info_job() and get_new_info_job_step() swap the snapshot in
+ * under the gdk lock.
+ */
+extern void prefetch_info_job(void)
+{
+	job_info_msg_t *new_job_ptr = NULL;
+	job_step_info_response_msg_t *new_step_ptr = NULL;
+	uint16_t show_flags = 0;
+	time_t last_update = 0;
+
+	if (working_sview_config.show_hidden)
+		show_flags |= SHOW_ALL;
+
+	slurm_mutex_lock(&g_staging_lock);
+	if (g_job_staging_ptr || g_step_staging_ptr) {
+		/* previous snapshot not consumed yet */
+		slurm_mutex_unlock(&g_staging_lock);
+		return;
+	}
+	if (g_job_info_ptr)
+		last_update = g_job_info_ptr->last_update;
+	slurm_mutex_unlock(&g_staging_lock);
+
+	if (slurm_load_jobs(last_update, &new_job_ptr, show_flags)
+	    != SLURM_SUCCESS)
+		new_job_ptr = NULL;
+	if (slurm_get_job_steps((time_t) NULL, NO_VAL, NO_VAL,
+				&new_step_ptr, SHOW_ALL) != SLURM_SUCCESS)
+		new_step_ptr = NULL;
+
+	slurm_mutex_lock(&g_staging_lock);
+	g_job_staging_ptr = new_job_ptr;
+	g_step_staging_ptr = new_step_ptr;
+	slurm_mutex_unlock(&g_staging_lock);
+}
+
 extern int get_new_info_job(job_info_msg_t **info_ptr,
 			    int force)
 {
@@ -3581,6 +3745,17 @@ extern int get_new_info_job(job_info_msg_t **info_ptr,
 	static bool changed = 0;
 	static uint16_t last_flags = 0;
 
+	slurm_mutex_lock(&g_staging_lock);
+	if (g_job_staging_ptr) {
+		/* swap in the snapshot loaded by prefetch_info_job() */
+		slurm_free_job_info_msg(g_job_info_ptr);
+		g_job_info_ptr = g_job_staging_ptr;
+		g_job_staging_ptr = NULL;
+		changed = 1;
+		last = now;
+	}
+	slurm_mutex_unlock(&g_staging_lock);
+
 	if (g_job_info_ptr && !force
 	    && ((now - last) < working_sview_config.refresh_delay)) {
 		if (*info_ptr != g_job_info_ptr)
@@ -3635,6 +3810,17 @@ extern int get_new_info_job_step(job_step_info_response_msg_t **info_ptr,
 	static time_t last;
 	static bool changed = 0;
 
+	slurm_mutex_lock(&g_staging_lock);
+	if (g_step_staging_ptr) {
+		/* swap in the snapshot loaded by prefetch_info_job() */
+		slurm_free_job_step_info_response_msg(g_step_info_ptr);
+		g_step_info_ptr = g_step_staging_ptr;
+		g_step_staging_ptr = NULL;
+		changed = 1;
+		last = now;
+	}
+	slurm_mutex_unlock(&g_staging_lock);
+
 	if (g_step_info_ptr && !force
 	    && ((now - last) < working_sview_config.refresh_delay)) {
 		if (*info_ptr != g_step_info_ptr)
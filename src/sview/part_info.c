@@ -2183,6 +2183,43 @@ extern bool visible_part(char* part_name)
 	return rc;
 }
 
+static partition_info_msg_t *g_part_staging_ptr = NULL;
+static pthread_mutex_t g_part_staging_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Load new partition info into a staging snapshot without touching the
+ * buffer the display is built from. Called from the page thread before
+ * it takes the gdk lock, so the RPC does not freeze the GUI.
+ * get_new_info_part() swaps the snapshot in under the gdk lock.
+ */
+extern void prefetch_info_part(void)
+{
+	partition_info_msg_t *new_part_ptr = NULL;
+	uint16_t show_flags = 0;
+	time_t last_update = 0;
+
+	if (working_sview_config.show_hidden)
+		show_flags |= SHOW_ALL;
+
+	slurm_mutex_lock(&g_part_staging_lock);
+	if (g_part_staging_ptr) {
+		/* previous snapshot not consumed yet */
+		slurm_mutex_unlock(&g_part_staging_lock);
+		return;
+	}
+	if (g_part_info_ptr)
+		last_update = g_part_info_ptr->last_update;
+	slurm_mutex_unlock(&g_part_staging_lock);
+
+	if (slurm_load_partitions(last_update, &new_part_ptr, show_flags)
+	    != SLURM_SUCCESS)
+		new_part_ptr = NULL;
+
+	slurm_mutex_lock(&g_part_staging_lock);
+	g_part_staging_ptr = new_part_ptr;
+	slurm_mutex_unlock(&g_part_staging_lock);
+}
+
 extern int get_new_info_part(partition_info_msg_t **part_ptr, int force)
 {
 	static partition_info_msg_t *new_part_ptr = NULL;
@@ -2193,6 +2230,17 @@ extern int get_new_info_part(partition_info_msg_t **part_ptr, int force)
 	static bool changed = 0;
 	static uint16_t last_flags = 0;
 
+	slurm_mutex_lock(&g_part_staging_lock);
+	if (g_part_staging_ptr) {
+		/* swap in the snapshot loaded by prefetch_info_part() */
+		slurm_free_partition_info_msg(g_part_info_ptr);
+		g_part_info_ptr = g_part_staging_ptr;
+		g_part_staging_ptr = NULL;
+		changed = 1;
+		last = now;
+	}
+	slurm_mutex_unlock(&g_part_staging_lock);
+
 	if (g_part_info_ptr && !force
 	    && ((now - last) < working_sview_config.refresh_delay)) {
 		if (*part_ptr != g_part_info_ptr)
@@ -208,6 +208,13 @@ void *_page_thr(void *arg)
 		START_TIMER;
 #endif
 //		g_mutex_lock(sview_mutex);
+		/* pull fresh data into a staging snapshot outside of
+		 * the display lock so the GUI stays responsive during
+		 * the RPCs */
+		if (display_data->id == JOB_PAGE)
+			prefetch_info_job();
+		else if (display_data->id == PART_PAGE)
+			prefetch_info_part();
 		gdk_threads_enter();
 		sview_init_grid(reset_highlight);
 		reset_highlight=false;
@@ -413,6 +413,7 @@ extern void admin_edit_part(GtkCellRendererText *cell,
 			    const char *path_string,
 			    const char *new_text,
 			    gpointer data);
+extern void prefetch_info_part(void);
 extern int get_new_info_part(partition_info_msg_t **part_ptr, int force);
 extern void get_info_part(GtkTable *table, display_data_t *display_data);
 extern void specific_info_part(popup_info_t *popup_win);
@@ -478,6 +479,7 @@ extern void admin_edit_job(GtkCellRendererText *cell,
 			   const char *path_string,
 			   const char *new_text,
 			   gpointer data);
+extern void prefetch_info_job(void);
 extern int get_new_info_job(job_info_msg_t **info_ptr, int force);
 extern int get_new_info_job_step(job_step_info_response_msg_t **info_ptr,
 				 int force);
@@ -0,0 +1,168 @@
+/*****************************************************************************\
+ *  test12.9.prog.c - Calibrated workload for the jobacct_gather overhead
+ *  benchmark (regression test12.9).
+ *  Usage: test12.9.prog <run_secs> <mem_kb> <file_kb> <file_name>
+ *
+ *  Runs fixed-size CPU work chunks against a resident memory buffer for
+ *  run_secs seconds, mixing in periodic file I/O, and reports per chunk
+ *  wall time statistics. Sampling activity by the jobacct_gather plugin
+ *  shows up as lengthened chunks, so the max/p99/stddev figures measure
+ *  the jitter injected into the workload.
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHUNK_TARGET_USEC 10000		/* ~10 msec of work per chunk */
+#define IO_CHUNK_PERIOD   64		/* file I/O once per 64 chunks */
+
+static char *mem_buf;
+static long long mem_bytes;
+
+static long long _usec_now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((long long) tv.tv_sec * 1000000) + tv.tv_usec;
+}
+
+/* One unit of CPU/memory work: walk the buffer a page at a time mixing
+ * the contents into a checksum so the loop can not be optimized away */
+static unsigned long long _work_unit(unsigned long long cksum)
+{
+	long long i;
+
+	for (i = 0; i < mem_bytes; i += 4096) {
+		cksum = (cksum * 6364136223846793005ULL) + 1442695040888963407ULL;
+		cksum ^= (unsigned char) mem_buf[i];
+		mem_buf[i] = (char) cksum;
+	}
+	return cksum;
+}
+
+static int _cmp_ll(const void *x, const void *y)
+{
+	long long a = *(const long long *) x;
+	long long b = *(const long long *) y;
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int run_secs, file_kb, fd, i;
+	long long mem_kb;
+	long long start, now, t0, t1, units_per_chunk = 1;
+	long long *chunk_usec, nchunks = 0, max_chunks;
+	long long sum = 0, sum_sq = 0, var;
+	unsigned long long cksum = 0;
+	char *file_name, *io_buf = NULL, *job_id;
+
+	if (argc != 5) {
+		fprintf(stderr,
+			"Usage: %s <run_secs> <mem_kb> <file_kb> <file_name>\n",
+			argv[0]);
+		exit(1);
+	}
+	run_secs  = atoi(argv[1]);
+	mem_kb    = atoll(argv[2]);
+	file_kb   = atoi(argv[3]);
+	file_name = argv[4];
+
+	mem_bytes = mem_kb * 1024;
+	mem_buf = malloc(mem_bytes);
+	if (!mem_buf) {
+		fprintf(stderr, "malloc of %lld KB failed\n", mem_kb);
+		exit(1);
+	}
+	memset(mem_buf, 1, mem_bytes);
+	if (file_kb > 0) {
+		io_buf = malloc(file_kb * 1024);
+		memset(io_buf, 2, file_kb * 1024);
+	}
+
+	/* Calibrate how many work units fill one chunk */
+	t0 = _usec_now();
+	cksum = _work_unit(cksum);
+	t1 = _usec_now();
+	if (t1 > t0)
+		units_per_chunk = (CHUNK_TARGET_USEC / (t1 - t0)) + 1;
+
+	max_chunks = ((long long) run_secs * 1000000 / CHUNK_TARGET_USEC) +
+		     1000;
+	chunk_usec = malloc(max_chunks * sizeof(long long));
+	if (!chunk_usec) {
+		fprintf(stderr, "malloc of chunk array failed\n");
+		exit(1);
+	}
+
+	start = _usec_now();
+	do {
+		t0 = _usec_now();
+		for (i = 0; i < units_per_chunk; i++)
+			cksum = _work_unit(cksum);
+		now = _usec_now();
+		if (nchunks < max_chunks)
+			chunk_usec[nchunks++] = now - t0;
+
+		if (io_buf && ((nchunks % IO_CHUNK_PERIOD) == 0)) {
+			fd = open(file_name, O_CREAT | O_WRONLY | O_TRUNC,
+				  0600);
+			if (fd >= 0) {
+				if (write(fd, io_buf, file_kb * 1024) < 0)
+					fprintf(stderr, "write failed\n");
+				close(fd);
+			}
+		}
+	} while ((now - start) < ((long long) run_secs * 1000000));
+
+	for (i = 0; i < nchunks; i++) {
+		sum += chunk_usec[i];
+		sum_sq += chunk_usec[i] * chunk_usec[i];
+	}
+	qsort(chunk_usec, nchunks, sizeof(long long), _cmp_ll);
+	var = (sum_sq / nchunks) - ((sum / nchunks) * (sum / nchunks));
+	if (var < 0)
+		var = 0;
+
+	job_id = getenv("SLURM_JOB_ID");
+	if (!job_id)
+		job_id = getenv("SLURM_JOBID");
+	printf("JOBID=%s CHUNKS=%lld MEAN_USEC=%lld MIN_USEC=%lld "
+	       "MAX_USEC=%lld P99_USEC=%lld VAR_USEC2=%lld CKSUM=%llx\n",
+	       job_id ? job_id : "0", nchunks, sum / nchunks, chunk_usec[0],
+	       chunk_usec[nchunks - 1], chunk_usec[(nchunks * 99) / 100],
+	       var, cksum);
+
+	if (io_buf)
+		unlink(file_name);
+	exit(0);
+}
@@ -0,0 +1,386 @@
+/*****************************************************************************\
+ *  common-bench.c - microbenchmarks for hot-path src/common primitives
+ *****************************************************************************
+ *  Measures bitstring, hostlist, pack, list and xhash operations and
+ *  reports stable per-operation timings (best of several repetitions).
+ *  Build and run with "make bench". Not part of the correctness test
+ *  suite, the output is informational only and the exit code is 0
+ *  whenever the benchmarks complete.
+\*****************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "slurm/slurm.h"
+
+#include "src/common/bitstring.h"
+#include "src/common/hostlist.h"
+#include "src/common/list.h"
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xhash.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+/* Repetitions per benchmark, the best (minimum) time is reported to
+ * filter out scheduling noise */
+#define BENCH_REPS 3
+
+static double cycles_per_ns = 0.0;
+
+static uint64_t _time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint64_t _rdtsc(void)
+{
+	unsigned int lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
+/* Estimate the TSC rate so results can also be reported in cycles */
+static void _calibrate_tsc(void)
+{
+	uint64_t t0 = _time_ns(), t1;
+	uint64_t c0 = _rdtsc(), c1;
+
+	do {
+		t1 = _time_ns();
+	} while ((t1 - t0) < 100000000);	/* 100 msec */
+	c1 = _rdtsc();
+	cycles_per_ns = (double) (c1 - c0) / (double) (t1 - t0);
+}
+#else
+static void _calibrate_tsc(void)
+{
+	cycles_per_ns = 0.0;
+}
+#endif
+
+static void _report(const char *name, uint64_t ops, uint64_t best_ns)
+{
+	double ns_per_op = (double) best_ns / (double) ops;
+
+	if (cycles_per_ns > 0.0) {
+		printf("%-44s %12.1f ns/op %12.1f cycles/op\n",
+		       name, ns_per_op, ns_per_op * cycles_per_ns);
+	} else
+		printf("%-44s %12.1f ns/op\n", name, ns_per_op);
+}
+
+static void _bench_bitstring_size(int bits, int iters)
+{
+	bitstr_t *ba = bit_alloc(bits);
+	bitstr_t *bb = bit_alloc(bits);
+	uint64_t t0, best;
+	char name[64];
+	int i, rep;
+
+	for (i = 0; i < bits; i += 3)
+		bit_set(ba, i);
+	for (i = 0; i < bits; i += 5)
+		bit_set(bb, i);
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++)
+			(void) bit_set_count(ba);
+		best = MIN(best, _time_ns() - t0);
+	}
+	snprintf(name, sizeof(name), "bit_set_count (%d bits)", bits);
+	_report(name, iters, best);
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++)
+			bit_and(ba, bb);
+		best = MIN(best, _time_ns() - t0);
+	}
+	snprintf(name, sizeof(name), "bit_and (%d bits)", bits);
+	_report(name, iters, best);
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < bits; i++)
+			bit_set(ba, i);
+		best = MIN(best, _time_ns() - t0);
+	}
+	snprintf(name, sizeof(name), "bit_set (%d bits, per bit)", bits);
+	_report(name, bits, best);
+
+	FREE_NULL_BITMAP(ba);
+	FREE_NULL_BITMAP(bb);
+}
+
+static void _bench_bitstring(void)
+{
+	_bench_bitstring_size(1024,    200000);
+	_bench_bitstring_size(65536,    20000);
+	_bench_bitstring_size(1048576,   2000);
+}
+
+static void _bench_hostlist(void)
+{
+	const char *ranged = "rack[0-7]node[000-499]";	/* 4000 hosts */
+	hostlist_t hl;
+	uint64_t t0, best;
+	char *str;
+	int i, rep, iters = 500;
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			hl = hostlist_create(ranged);
+			hostlist_destroy(hl);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("hostlist_create/destroy (4000 hosts)", iters, best);
+
+	hl = hostlist_create(ranged);
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			str = hostlist_ranged_string_xmalloc(hl);
+			xfree(str);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("hostlist_ranged_string (4000 hosts)", iters, best);
+	hostlist_destroy(hl);
+}
+
+static void _bench_pack_primitives(void)
+{
+	Buf buffer = init_buf(BUF_SIZE);
+	uint64_t t0, best;
+	int i, j, rep, iters = 2000, per_iter = 1000;
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			set_buf_offset(buffer, 0);
+			for (j = 0; j < per_iter; j++)
+				pack32((uint32_t) j, buffer);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("pack32", (uint64_t) iters * per_iter, best);
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			set_buf_offset(buffer, 0);
+			for (j = 0; j < per_iter; j++) {
+				packstr("0123456789012345678901234567890123456789012345678901234567890123",
+					buffer);
+			}
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("packstr (64 bytes)", (uint64_t) iters * per_iter, best);
+	free_buf(buffer);
+}
+
+/* NOTE: job_desc and node_info serialization routes through the select
+ * plugin layer, which a standalone benchmark binary can not assume is
+ * installed. A step create request exercises the same packstr/pack32
+ * message composition without any plugin dependency. */
+static void _bench_pack_step_create(void)
+{
+	job_step_create_request_msg_t req;
+	slurm_msg_t pack_msg_s, unpack_msg_s;
+	Buf buffer = init_buf(BUF_SIZE);
+	uint64_t t0, best;
+	int i, rep, iters = 20000;
+
+	/* Representative step launch request */
+	memset(&req, 0, sizeof(req));
+	req.job_id	= 123456;
+	req.user_id	= 1000;
+	req.min_nodes	= 16;
+	req.max_nodes	= 16;
+	req.cpu_count	= 256;
+	req.num_tasks	= 256;
+	req.time_limit	= 60;
+	req.name	= "bench_step";
+	req.network	= "network_spec";
+	req.node_list	= "rack[0-7]node[000-499]";
+	req.ckpt_dir	= "/var/spool/checkpoint";
+	req.features	= "haswell&bigmem";
+	req.gres	= "gpu:4";
+
+	slurm_msg_t_init(&pack_msg_s);
+	pack_msg_s.msg_type = REQUEST_JOB_STEP_CREATE;
+	pack_msg_s.protocol_version = SLURM_PROTOCOL_VERSION;
+	pack_msg_s.data = &req;
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			set_buf_offset(buffer, 0);
+			pack_msg(&pack_msg_s, buffer);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("pack_msg (step create request)", iters, best);
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < iters; i++) {
+			set_buf_offset(buffer, 0);
+			slurm_msg_t_init(&unpack_msg_s);
+			unpack_msg_s.msg_type = REQUEST_JOB_STEP_CREATE;
+			unpack_msg_s.protocol_version = SLURM_PROTOCOL_VERSION;
+			if (unpack_msg(&unpack_msg_s, buffer) !=
+			    SLURM_SUCCESS) {
+				fprintf(stderr, "unpack_msg failed\n");
+				exit(1);
+			}
+			slurm_free_job_step_create_request_msg(
+				unpack_msg_s.data);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("unpack_msg+free (step create request)", iters, best);
+	free_buf(buffer);
+}
+
+static void _bench_list(void)
+{
+	List l;
+	ListIterator iter;
+	uint64_t t0, best, count;
+	static int dummy[10];
+	void *item;
+	int i, rep, reps = 200, elems = 10000;
+
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < reps; i++) {
+			int j;
+			l = list_create(NULL);
+			for (j = 0; j < elems; j++)
+				list_append(l, &dummy[j % 10]);
+			list_destroy(l);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("list_append (per element)",
+		(uint64_t) reps * elems, best);
+
+	l = list_create(NULL);
+	for (i = 0; i < elems * 10; i++)
+		list_append(l, &dummy[i % 10]);
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		count = 0;
+		for (i = 0; i < reps; i++) {
+			iter = list_iterator_create(l);
+			while ((item = list_next(iter)))
+				count++;
+			list_iterator_destroy(iter);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("list_next (per element)", count, best);
+	list_destroy(l);
+}
+
+typedef struct bench_item {
+	char id[32];
+} bench_item_t;
+
+static const char *_bench_item_id(void *x)
+{
+	return ((bench_item_t *) x)->id;
+}
+
+static void _bench_xhash(void)
+{
+	xhash_t *ht;
+	bench_item_t *items;
+	uint64_t t0, best;
+	int i, rep, reps, nitems = 100000;
+
+	items = xmalloc(sizeof(bench_item_t) * nitems);
+	for (i = 0; i < nitems; i++)
+		snprintf(items[i].id, sizeof(items[i].id), "item%08d", i);
+
+	reps = 10;
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < reps; i++) {
+			int j;
+			ht = xhash_init(_bench_item_id, NULL, NULL, 0);
+			for (j = 0; j < nitems; j++)
+				xhash_add(ht, &items[j]);
+			xhash_free(ht);
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("xhash_add (100000 items, per item)",
+		(uint64_t) reps * nitems, best);
+
+	ht = xhash_init(_bench_item_id, NULL, NULL, 0);
+	for (i = 0; i < nitems; i++)
+		xhash_add(ht, &items[i]);
+	reps = 50;
+	best = (uint64_t) -1;
+	for (rep = 0; rep < BENCH_REPS; rep++) {
+		t0 = _time_ns();
+		for (i = 0; i < reps; i++) {
+			int j;
+			for (j = 0; j < nitems; j++) {
+				if (!xhash_get(ht, items[j].id)) {
+					fprintf(stderr, "xhash_get failed\n");
+					exit(1);
+				}
+			}
+		}
+		best = MIN(best, _time_ns() - t0);
+	}
+	_report("xhash_get (100000 items, per lookup)",
+		(uint64_t) reps * nitems, best);
+	xhash_free(ht);
+	xfree(items);
+}
+
+int main(int argc, char *argv[])
+{
+	_calibrate_tsc();
+	if (cycles_per_ns > 0.0)
+		printf("TSC rate: %.3f GHz\n\n", cycles_per_ns);
+
+	_bench_bitstring();
+	_bench_hostlist();
+	_bench_pack_primitives();
+	_bench_pack_step_create();
+	_bench_list();
+	_bench_xhash();
+
+	return 0;
+}
@@ -235,6 +235,57 @@ START_TEST(test_walk)
 }
 END_TEST
 
+START_TEST(test_open_addressing)
+{
+	xhash_t* ht = NULL;
+	char buffer[255];
+	int i;
+
+	/* reserve far less than the item count to exercise growth */
+	ht = xhash_init(hashable_identify, NULL, NULL, 8);
+	fail_unless(ht != NULL, "hash table was not allocated");
+	for (i = 0; i < g_hashableslen; ++i) {
+		g_hashables[i].id[0] = 0;
+		g_hashables[i].idn = i;
+		fail_unless(xhash_add(ht, g_hashables + i) != NULL,
+				"xhash_add failed");
+	}
+	fail_unless(xhash_count(ht) == g_hashableslen, "bad count");
+	fail_unless(xhash_get(ht, "bad") == NULL, "invalid case not null");
+	for (i = 0; i < g_hashableslen; ++i) {
+		snprintf(buffer, sizeof(buffer), "%d", i);
+		fail_unless(xhash_get(ht, buffer) == (g_hashables + i),
+				"bad hashable item returned");
+	}
+
+	/* deletion must not break probe chains of remaining items */
+	for (i = 0; i < g_hashableslen; i += 2) {
+		snprintf(buffer, sizeof(buffer), "%d", i);
+		xhash_delete(ht, buffer);
+	}
+	fail_unless(xhash_count(ht) == (g_hashableslen / 2), "bad count");
+	for (i = 0; i < g_hashableslen; ++i) {
+		snprintf(buffer, sizeof(buffer), "%d", i);
+		if (i % 2)
+			fail_unless(xhash_get(ht, buffer) ==
+					(g_hashables + i),
+					"bad hashable item returned");
+		else
+			fail_unless(xhash_get(ht, buffer) == NULL,
+					"item not deleted");
+	}
+
+	/* reserving must keep existing items findable */
+	xhash_reserve(ht, 4 * g_hashableslen);
+	for (i = 1; i < g_hashableslen; i += 2) {
+		snprintf(buffer, sizeof(buffer), "%d", i);
+		fail_unless(xhash_get(ht, buffer) == (g_hashables + i),
+				"bad hashable item returned");
+	}
+	xhash_free(ht);
+}
+END_TEST
+
 /*****************************************************************************
  * TEST SUITE                                                                *
  ****************************************************************************/
@@ -250,6 +301,7 @@ Suite* xhash_suite(void)
 	tcase_add_test(tc_core, test_delete);
 	tcase_add_test(tc_core, test_count);
 	tcase_add_test(tc_core, test_walk);
+	tcase_add_test(tc_core, test_open_addressing);
 	suite_add_tcase(s, tc_core);
 	return s;
 }